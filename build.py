@@ -203,6 +203,11 @@ CTX.INPUT['common'] = """
  RecoveryProtoMessageBuilder.cpp
  DefaultTupleSerializer.cpp
  StringRef.cpp
+ BlockAllocator.cpp
+ CompactingPool.cpp
+ CompactingStringPool.cpp
+ CompactingStringStorage.cpp
+ ThreadLocalPool.cpp
 """
 
 CTX.INPUT['execution'] = """
@@ -266,6 +271,7 @@ CTX.INPUT['indexes'] = """
  arrayuniqueindex.cpp
  tableindex.cpp
  tableindexfactory.cpp
+ indexkey.cpp
  IndexStats.cpp
 """
 
@@ -273,9 +279,14 @@ CTX.INPUT['storage'] = """
  constraintutil.cpp
  CopyOnWriteContext.cpp
  CopyOnWriteIterator.cpp
+ BlockCopyOnWriteIterator.cpp
  ConstraintFailureException.cpp
  MaterializedViewMetadata.cpp
  mmap_persistenttable.cpp
+ PaxMinipages.cpp
+ PaxScanIterator.cpp
+ ZoneMaps.cpp
+ ZoneMapScanIterator.cpp
  persistenttable.cpp
  PersistentTableStats.cpp
  PersistentTableUndoDeleteAction.cpp
@@ -292,6 +303,7 @@ CTX.INPUT['storage'] = """
  TupleStreamWrapper.cpp
  RecoveryContext.cpp
  ReadWriteTracker.cpp
+ ScanFilter.cpp
 """
 
 CTX.INPUT['stats'] = """
@@ -338,6 +350,9 @@ CTX.TESTS['common'] = """
  nvalue_test
  tupleschema_test
  tabletuple_test
+ blockallocator_test
+ compactingstringstorage_test
+ mmapmemorymanager_test
 """
 
 CTX.TESTS['execution'] = """
@@ -349,6 +364,7 @@ CTX.TESTS['expressions'] = """
 """
 
 CTX.TESTS['indexes'] = """
+ compact_index_test
  index_allocatortracker_test
  index_key_test
  index_multikey_test
@@ -361,10 +377,13 @@ CTX.TESTS['storage'] = """
  constraint_test
  filter_test
  mmap_persistent_table_test
+ pax_scan_test
+ zone_map_test
  persistent_table_log_test
  serialize_test
  StreamedTable_test
  table_and_indexes_test
+ table_iterator_test
  table_test
  tabletuple_export_test
  TupleStreamWrapper_test
@@ -403,11 +422,15 @@ if CTX.ANTICACHE_BUILD:
     if CTX.ANTICACHE_DRAM:
         CTX.CPPFLAGS += " -DANTICACHE_DRAM"
 
-    if CTX.ANTICACHE_TIMESTAMPS:
-        CTX.CPPFLAGS += " -DANTICACHE_TIMESTAMPS"
+    # CLOCK replaces both the timestamps and the LRU chain
+    if CTX.ANTICACHE_CLOCK:
+        CTX.CPPFLAGS += " -DANTICACHE_CLOCK"
+    else:
+        if CTX.ANTICACHE_TIMESTAMPS:
+            CTX.CPPFLAGS += " -DANTICACHE_TIMESTAMPS"
 
-    if CTX.ANTICACHE_TIMESTAMPS_PRIME:
-        CTX.CPPFLAGS += " -DANTICACHE_TIMESTAMPS_PRIME"
+        if CTX.ANTICACHE_TIMESTAMPS_PRIME:
+            CTX.CPPFLAGS += " -DANTICACHE_TIMESTAMPS_PRIME"
 
     # Bring in berkeleydb library
     CTX.SYSTEM_DIRS.append(os.path.join(CTX.OUTPUT_PREFIX, 'berkeleydb'))
@@ -424,7 +447,11 @@ if CTX.ANTICACHE_BUILD:
         AntiCacheDB.cpp
         BerkeleyAntiCacheDB.cpp
         NVMAntiCacheDB.cpp
+        LogAntiCacheDB.cpp
         AntiCacheEvictionManager.cpp
+        AntiCacheBlockWriter.cpp
+        AntiCacheBlockReader.cpp
+        AntiCacheCodec.cpp
         EvictionIterator.cpp
         EvictedTable.cpp
     """
@@ -433,6 +460,10 @@ if CTX.ANTICACHE_BUILD:
         anticachedb_test
         berkeleydb_test
         anticache_eviction_manager_test
+        anticache_block_writer_test
+        anticache_codec_test
+        anticache_block_reader_test
+        anticache_log_db_test
     """
 
 ###############################################################################
@@ -48,6 +48,7 @@ class BuildContext:
         self.ARIES= False
         self.ANTICACHE_TIMESTAMPS = True
         self.ANTICACHE_TIMESTAMPS_PRIME = True
+        self.ANTICACHE_CLOCK = False
 
         for arg in [x.strip().upper() for x in args]:
             if arg in ["DEBUG", "RELEASE", "MEMCHECK", "MEMCHECK_NOFREELIST"]:
@@ -95,6 +96,10 @@ class BuildContext:
                 parts = arg.split("=")
                 if len(parts) > 1 and not parts[1].startswith("${"):
                     self.ANTICACHE_TIMESTAMPS_PRIME = bool(parts[1])
+            if arg.startswith("ANTICACHE_CLOCK="):
+                parts = arg.split("=")
+                if len(parts) > 1 and not parts[1].startswith("${"):
+                    self.ANTICACHE_CLOCK = (parts[1] == "TRUE")
                 
             if arg.startswith("LOG_LEVEL="):
                 parts = arg.split("=")
@@ -0,0 +1,125 @@
+/* Copyright (C) 2014 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "anticache/AntiCacheBlockReader.h"
+#include "anticache/AntiCacheDB.h"
+#include "common/FatalException.hpp"
+#include "common/debuglog.h"
+
+namespace voltdb {
+
+AntiCacheBlockReader::AntiCacheBlockReader(int numThreads) :
+    m_batch(NULL), m_next(0), m_done(0), m_shutdown(false),
+    m_batches(0), m_blocksFetched(0) {
+
+    pthread_mutex_init(&m_lock, NULL);
+    pthread_cond_init(&m_submitted, NULL);
+    pthread_cond_init(&m_finished, NULL);
+    for (int i = 0; i < numThreads; i++) {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, AntiCacheBlockReader::run, this) != 0) {
+            throwFatalException("Failed to start anti-cache block reader %d", i);
+        }
+        m_threads.push_back(thread);
+    }
+}
+
+AntiCacheBlockReader::~AntiCacheBlockReader() {
+    pthread_mutex_lock(&m_lock);
+    m_shutdown = true;
+    pthread_cond_broadcast(&m_submitted);
+    pthread_mutex_unlock(&m_lock);
+    for (size_t i = 0; i < m_threads.size(); i++) {
+        pthread_join(m_threads[i], NULL);
+    }
+
+    pthread_cond_destroy(&m_finished);
+    pthread_cond_destroy(&m_submitted);
+    pthread_mutex_destroy(&m_lock);
+}
+
+void* AntiCacheBlockReader::run(void *reader) {
+    static_cast<AntiCacheBlockReader*>(reader)->readBlocks();
+    return NULL;
+}
+
+void AntiCacheBlockReader::fetchBlocks(std::vector<Request> &requests) {
+    if (requests.empty()) {
+        return;
+    }
+    VOLT_DEBUG("Fetching a batch of %d evicted blocks", (int)requests.size());
+
+    pthread_mutex_lock(&m_lock);
+    m_batch = &requests;
+    m_next = 0;
+    m_done = 0;
+    m_batches++;
+    m_blocksFetched += requests.size();
+    pthread_cond_broadcast(&m_submitted);
+    while (m_next < m_batch->size()) {
+        fetchNext();
+    }
+    while (m_done < m_batch->size()) {
+        pthread_cond_wait(&m_finished, &m_lock);
+    }
+    m_batch = NULL;
+    pthread_mutex_unlock(&m_lock);
+}
+
+void AntiCacheBlockReader::readBlocks() {
+    pthread_mutex_lock(&m_lock);
+    while (true) {
+        while (!m_shutdown && (m_batch == NULL || m_next >= m_batch->size())) {
+            pthread_cond_wait(&m_submitted, &m_lock);
+        }
+        if (m_shutdown) {
+            break;
+        }
+        fetchNext();
+    }
+    pthread_mutex_unlock(&m_lock);
+}
+
+// called with m_lock held, which is released while the block is read
+void AntiCacheBlockReader::fetchNext() {
+    Request &request = (*m_batch)[m_next++];
+    pthread_mutex_unlock(&m_lock);
+
+    request.block = NULL;
+    request.storedSize = 0;
+    try {
+        request.block = request.antiCacheDB->fetchBlock(request.blockId, &request.storedSize);
+    } catch (...) {
+        // the caller reads the block again on its own thread, which raises the error there
+        VOLT_DEBUG("Failed to fetch evicted block %u", request.blockId);
+    }
+
+    pthread_mutex_lock(&m_lock);
+    if (++m_done == m_batch->size()) {
+        pthread_cond_broadcast(&m_finished);
+    }
+}
+
+}
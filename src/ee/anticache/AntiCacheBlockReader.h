@@ -0,0 +1,99 @@
+/* Copyright (C) 2014 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef HSTOREANTICACHEBLOCKREADER_H
+#define HSTOREANTICACHEBLOCKREADER_H
+
+#include <vector>
+#include <stdint.h>
+#include <pthread.h>
+
+namespace voltdb {
+
+class AntiCacheDB;
+class AntiCacheBlock;
+
+/**
+ * Pool of threads that fetch a batch of evicted blocks at once. When a
+ * transaction is restarted after touching evicted tuples, all of its
+ * blocks are read in one round instead of one after the other. The
+ * workers only call AntiCacheDB::fetchBlock, so the caller has to keep
+ * every other user of the databases out while a batch is fetched, and
+ * update the databases for the fetched blocks afterwards.
+ */
+class AntiCacheBlockReader {
+    public:
+        struct Request {
+            AntiCacheDB *antiCacheDB;
+            uint32_t blockId;
+            // set by fetchBlocks, block is NULL if the block could not be read
+            AntiCacheBlock *block;
+            long storedSize;
+        };
+
+        AntiCacheBlockReader(int numThreads);
+        ~AntiCacheBlockReader();
+
+        /**
+         * Fetch the blocks of all requests and return once every one of them
+         * is done. The calling thread fetches blocks as well.
+         */
+        void fetchBlocks(std::vector<Request> &requests);
+
+        inline int getNumThreads() const {
+            return (int)m_threads.size();
+        }
+
+        /**
+         * Number of batches and blocks fetched so far
+         */
+        inline int64_t getBatches() const {
+            return m_batches;
+        }
+        inline int64_t getBlocksFetched() const {
+            return m_blocksFetched;
+        }
+
+    private:
+        static void* run(void *reader);
+        void readBlocks();
+        void fetchNext();
+
+        std::vector<pthread_t> m_threads;
+        std::vector<Request> *m_batch;
+        size_t m_next;
+        size_t m_done;
+        bool m_shutdown;
+        int64_t m_batches;
+        int64_t m_blocksFetched;
+
+        pthread_mutex_t m_lock;
+        pthread_cond_t m_submitted;
+        pthread_cond_t m_finished;
+};
+
+}
+
+#endif
@@ -0,0 +1,244 @@
+/* Copyright (C) 2014 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "anticache/AntiCacheBlockWriter.h"
+#include "anticache/AntiCacheDB.h"
+#include "common/FatalException.hpp"
+#include "common/debuglog.h"
+
+namespace voltdb {
+
+AntiCacheBlockWriter::AntiCacheBlockWriter(int maxPendingBlocks) :
+    m_maxPendingBlocks(maxPendingBlocks > 0 ? maxPendingBlocks : 1),
+    m_busy(false), m_shutdown(false), m_stalls(0) {
+
+    pthread_mutex_init(&m_lock, NULL);
+    pthread_cond_init(&m_queued, NULL);
+    pthread_cond_init(&m_written, NULL);
+    pthread_mutex_init(&m_dbLock, NULL);
+    if (pthread_create(&m_thread, NULL, AntiCacheBlockWriter::run, this) != 0) {
+        throwFatalException("Failed to start the anti-cache block writer");
+    }
+}
+
+AntiCacheBlockWriter::~AntiCacheBlockWriter() {
+    // the worker writes out whatever is still queued before it exits
+    pthread_mutex_lock(&m_lock);
+    m_shutdown = true;
+    pthread_cond_signal(&m_queued);
+    pthread_mutex_unlock(&m_lock);
+    pthread_join(m_thread, NULL);
+
+    try {
+        retryFailedWrites();
+    } catch (...) {
+        VOLT_ERROR("Dropping %d evicted blocks that could not be written", (int)m_failed.size());
+    }
+    for (std::deque<PendingBlock>::iterator it = m_failed.begin(); it != m_failed.end(); ++it) {
+        delete [] it->data;
+    }
+
+    pthread_mutex_destroy(&m_dbLock);
+    pthread_cond_destroy(&m_written);
+    pthread_cond_destroy(&m_queued);
+    pthread_mutex_destroy(&m_lock);
+}
+
+void* AntiCacheBlockWriter::run(void *writer) {
+    static_cast<AntiCacheBlockWriter*>(writer)->writeBlocks();
+    return NULL;
+}
+
+void AntiCacheBlockWriter::enqueue(AntiCacheDB *antiCacheDB, const std::string &tableName, uint32_t blockId,
+                                   int tupleCount, char *data, long size) {
+    PendingBlock block;
+    block.antiCacheDB = antiCacheDB;
+    block.tableName = tableName;
+    block.blockId = blockId;
+    block.tupleCount = tupleCount;
+    block.data = data;
+    block.size = size;
+
+    pthread_mutex_lock(&m_lock);
+    if ((int)m_queue.size() >= m_maxPendingBlocks) {
+        m_stalls++;
+        VOLT_DEBUG("Anti-cache block writer is full, waiting to queue block %u", blockId);
+        while ((int)m_queue.size() >= m_maxPendingBlocks) {
+            pthread_cond_wait(&m_written, &m_lock);
+        }
+    }
+    m_queue.push_back(block);
+    pthread_cond_signal(&m_queued);
+    pthread_mutex_unlock(&m_lock);
+
+    retryFailedWrites();
+}
+
+void AntiCacheBlockWriter::waitForBlock(AntiCacheDB *antiCacheDB, uint32_t blockId) {
+    pthread_mutex_lock(&m_lock);
+    bool pending = true;
+    while (pending) {
+        pending = false;
+        for (std::deque<PendingBlock>::const_iterator it = m_queue.begin(); it != m_queue.end(); ++it) {
+            if (it->antiCacheDB == antiCacheDB && it->blockId == blockId) {
+                pending = true;
+                break;
+            }
+        }
+        if (pending) {
+            VOLT_DEBUG("Waiting for block %u to be written", blockId);
+            pthread_cond_wait(&m_written, &m_lock);
+        }
+    }
+    pthread_mutex_unlock(&m_lock);
+
+    retryFailedWrites();
+}
+
+void AntiCacheBlockWriter::drain() {
+    pthread_mutex_lock(&m_lock);
+    while (!m_queue.empty() || m_busy) {
+        pthread_cond_wait(&m_written, &m_lock);
+    }
+    pthread_mutex_unlock(&m_lock);
+
+    retryFailedWrites();
+}
+
+void AntiCacheBlockWriter::lockDBs() {
+    pthread_mutex_lock(&m_dbLock);
+}
+
+void AntiCacheBlockWriter::unlockDBs() {
+    pthread_mutex_unlock(&m_dbLock);
+}
+
+int AntiCacheBlockWriter::getPendingBlocks() {
+    pthread_mutex_lock(&m_lock);
+    int pending = (int)(m_queue.size() + m_failed.size());
+    pthread_mutex_unlock(&m_lock);
+    return pending;
+}
+
+void AntiCacheBlockWriter::retryFailedWrites() {
+    pthread_mutex_lock(&m_lock);
+    std::deque<PendingBlock> failed;
+    std::set<AntiCacheDB*> unflushed;
+    failed.swap(m_failed);
+    unflushed.swap(m_failedFlushes);
+    pthread_mutex_unlock(&m_lock);
+    if (failed.empty() && unflushed.empty()) {
+        return;
+    }
+
+    lockDBs();
+    try {
+        while (!failed.empty()) {
+            PendingBlock &block = failed.front();
+            VOLT_INFO("Writing evicted block %u of table '%s' again", block.blockId, block.tableName.c_str());
+            block.antiCacheDB->writeBlock(block.tableName, block.blockId, block.tupleCount,
+                                          block.data, block.size, block.tupleCount);
+            unflushed.insert(block.antiCacheDB);
+            delete [] block.data;
+            failed.pop_front();
+        }
+        while (!unflushed.empty()) {
+            (*unflushed.begin())->flushBlocks();
+            unflushed.erase(unflushed.begin());
+        }
+    } catch (...) {
+        unlockDBs();
+        // whatever is left is tried again on the next call
+        pthread_mutex_lock(&m_lock);
+        m_failed.insert(m_failed.begin(), failed.begin(), failed.end());
+        m_failedFlushes.insert(unflushed.begin(), unflushed.end());
+        pthread_mutex_unlock(&m_lock);
+        throw;
+    }
+    unlockDBs();
+}
+
+void AntiCacheBlockWriter::writeBlocks() {
+    pthread_mutex_lock(&m_lock);
+    while (true) {
+        while (m_queue.empty() && !m_shutdown) {
+            pthread_cond_wait(&m_queued, &m_lock);
+        }
+        if (m_queue.empty()) {
+            break;
+        }
+        // the block stays queued until it is written, so that readers wait for it
+        m_busy = true;
+        PendingBlock block = m_queue.front();
+        pthread_mutex_unlock(&m_lock);
+
+        bool written = true;
+        pthread_mutex_lock(&m_dbLock);
+        try {
+            block.antiCacheDB->writeBlock(block.tableName, block.blockId, block.tupleCount,
+                                          block.data, block.size, block.tupleCount);
+        } catch (...) {
+            written = false;
+        }
+        pthread_mutex_unlock(&m_dbLock);
+
+        pthread_mutex_lock(&m_lock);
+        m_queue.pop_front();
+        if (written) {
+            delete [] block.data;
+            m_unflushed.insert(block.antiCacheDB);
+        } else {
+            // the tuples of the block are only in its buffer now
+            VOLT_WARN("Failed to write evicted block %u of table '%s' to AntiCacheDB %d",
+                      block.blockId, block.tableName.c_str(), (int)block.antiCacheDB->getACID());
+            m_failed.push_back(block);
+        }
+
+        // flush once the queue runs dry, as often as an eviction round did
+        if (m_queue.empty()) {
+            std::set<AntiCacheDB*> unflushed;
+            std::set<AntiCacheDB*> failedFlushes;
+            unflushed.swap(m_unflushed);
+            pthread_mutex_unlock(&m_lock);
+            pthread_mutex_lock(&m_dbLock);
+            for (std::set<AntiCacheDB*>::iterator it = unflushed.begin(); it != unflushed.end(); ++it) {
+                try {
+                    (*it)->flushBlocks();
+                } catch (...) {
+                    VOLT_WARN("Failed to flush AntiCacheDB %d", (int)(*it)->getACID());
+                    failedFlushes.insert(*it);
+                }
+            }
+            pthread_mutex_unlock(&m_dbLock);
+            pthread_mutex_lock(&m_lock);
+            m_failedFlushes.insert(failedFlushes.begin(), failedFlushes.end());
+        }
+        m_busy = false;
+        pthread_cond_broadcast(&m_written);
+    }
+    pthread_mutex_unlock(&m_lock);
+}
+
+}
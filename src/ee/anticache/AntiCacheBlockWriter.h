@@ -0,0 +1,146 @@
+/* Copyright (C) 2014 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef HSTOREANTICACHEBLOCKWRITER_H
+#define HSTOREANTICACHEBLOCKWRITER_H
+
+#include <deque>
+#include <set>
+#include <string>
+#include <stdint.h>
+#include <pthread.h>
+
+namespace voltdb {
+
+class AntiCacheDB;
+
+/**
+ * Background writer for evicted blocks. The eviction manager serializes
+ * the tuples of a block on the execution thread and hands the buffer off
+ * here, and a worker thread writes it to its AntiCacheDB. The queue is
+ * bounded: once maxPendingBlocks are waiting, the execution thread stalls
+ * until one is written. The AntiCacheDBs are not thread-safe, so every
+ * other call into them has to hold the DB lock while the writer exists.
+ *
+ * A block the worker fails to write is kept, and written again on the
+ * execution thread by the next enqueue(), waitForBlock() or drain(), which
+ * also flush again a DB whose flush failed. If that fails too, the
+ * exception of the AntiCacheDB is thrown to the caller and the block is
+ * kept for the next try.
+ */
+class AntiCacheBlockWriter {
+    public:
+        AntiCacheBlockWriter(int maxPendingBlocks);
+        ~AntiCacheBlockWriter();
+
+        /**
+         * Queue a serialized block. The writer takes over the buffer, which
+         * has to be allocated with new[]. This and the waiting methods must
+         * not be called while holding the DB lock.
+         */
+        void enqueue(AntiCacheDB *antiCacheDB, const std::string &tableName, uint32_t blockId,
+                     int tupleCount, char *data, long size);
+
+        /**
+         * Wait until the given block is in its AntiCacheDB, if it was queued.
+         */
+        void waitForBlock(AntiCacheDB *antiCacheDB, uint32_t blockId);
+
+        /**
+         * Wait until every queued block is written and flushed. The eviction
+         * manager calls this before an eviction returns, as the tuples of
+         * its blocks are no longer in memory.
+         */
+        void drain();
+
+        void lockDBs();
+        void unlockDBs();
+
+        int getPendingBlocks();
+
+        inline int getMaxPendingBlocks() const {
+            return m_maxPendingBlocks;
+        }
+
+        /**
+         * Number of times the execution thread waited for a free queue slot
+         */
+        inline int64_t getStalls() const {
+            return m_stalls;
+        }
+
+        /**
+         * Holds the DB lock of a writer for a scope, if there is a writer.
+         */
+        class DBLock {
+            public:
+                DBLock(AntiCacheBlockWriter *writer) : m_writer(writer) {
+                    if (m_writer != NULL) {
+                        m_writer->lockDBs();
+                    }
+                }
+                ~DBLock() {
+                    if (m_writer != NULL) {
+                        m_writer->unlockDBs();
+                    }
+                }
+            private:
+                AntiCacheBlockWriter *m_writer;
+        };
+
+    private:
+        struct PendingBlock {
+            AntiCacheDB *antiCacheDB;
+            std::string tableName;
+            uint32_t blockId;
+            int tupleCount;
+            char *data;
+            long size;
+        };
+
+        static void* run(void *writer);
+        void writeBlocks();
+        void retryFailedWrites();
+
+        const int m_maxPendingBlocks;
+        std::deque<PendingBlock> m_queue;
+        std::set<AntiCacheDB*> m_unflushed;
+        // blocks and flushes the worker failed at, for the execution thread
+        std::deque<PendingBlock> m_failed;
+        std::set<AntiCacheDB*> m_failedFlushes;
+        bool m_busy;
+        bool m_shutdown;
+        int64_t m_stalls;
+
+        pthread_t m_thread;
+        pthread_mutex_t m_lock;
+        pthread_cond_t m_queued;
+        pthread_cond_t m_written;
+        pthread_mutex_t m_dbLock;
+};
+
+}
+
+#endif
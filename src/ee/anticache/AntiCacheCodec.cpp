@@ -0,0 +1,208 @@
+/* Copyright (C) 2014 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "anticache/AntiCacheCodec.h"
+
+#include <cstring>
+#include <vector>
+
+namespace voltdb {
+
+namespace {
+
+const int MIN_MATCH = 4;
+const long MAX_OFFSET = 65535;
+const int HASH_BITS = 14;
+const long DICTIONARY_SAMPLE = 512;
+
+inline uint32_t read32(const unsigned char *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint32_t hash32(uint32_t v) {
+    return (v * 2654435761U) >> (32 - HASH_BITS);
+}
+
+inline unsigned char* writeLength(unsigned char *out, long length) {
+    while (length >= 255) {
+        *out++ = 255;
+        length -= 255;
+    }
+    *out++ = static_cast<unsigned char>(length);
+    return out;
+}
+
+inline bool readLength(const unsigned char *&in, const unsigned char *end, long &length) {
+    unsigned char b;
+    do {
+        if (in >= end) {
+            return false;
+        }
+        b = *in++;
+        length += b;
+    } while (b == 255);
+    return true;
+}
+
+unsigned char* writeSequence(unsigned char *out, const unsigned char *literals, long literalLength,
+                             long offset, long matchLength) {
+    const long matchCode = matchLength > 0 ? matchLength - MIN_MATCH : 0;
+    unsigned char *token = out++;
+    *token = static_cast<unsigned char>(((literalLength < 15 ? literalLength : 15) << 4) |
+                                        (matchCode < 15 ? matchCode : 15));
+    if (literalLength >= 15) {
+        out = writeLength(out, literalLength - 15);
+    }
+    memcpy(out, literals, literalLength);
+    out += literalLength;
+    if (matchLength > 0) {
+        *out++ = static_cast<unsigned char>(offset & 0xff);
+        *out++ = static_cast<unsigned char>(offset >> 8);
+        if (matchCode >= 15) {
+            out = writeLength(out, matchCode - 15);
+        }
+    }
+    return out;
+}
+
+}
+
+long AntiCacheCodec::compress(const char *src, long size, char *dst,
+                              const char *dict, long dictSize) {
+    // matches may reach back into the dictionary, so both are laid out as one history
+    std::vector<unsigned char> history(dictSize + size);
+    if (dictSize > 0) {
+        memcpy(&history[0], dict, dictSize);
+    }
+    if (size > 0) {
+        memcpy(&history[dictSize], src, size);
+    }
+    const unsigned char *in = history.empty() ? NULL : &history[0];
+    const long end = dictSize + size;
+
+    std::vector<long> table(1 << HASH_BITS, -1);
+    for (long p = 0; p + MIN_MATCH <= dictSize; p++) {
+        table[hash32(read32(in + p))] = p;
+    }
+
+    unsigned char *out = reinterpret_cast<unsigned char*>(dst);
+    long anchor = dictSize;
+    long p = dictSize;
+    while (p + MIN_MATCH <= end) {
+        const uint32_t h = hash32(read32(in + p));
+        const long candidate = table[h];
+        table[h] = p;
+        if (candidate < 0 || p - candidate > MAX_OFFSET || read32(in + candidate) != read32(in + p)) {
+            p++;
+            continue;
+        }
+        long length = MIN_MATCH;
+        while (p + length < end && in[candidate + length] == in[p + length]) {
+            length++;
+        }
+        out = writeSequence(out, in + anchor, p - anchor, p - candidate, length);
+        p += length;
+        anchor = p;
+        if (p - 2 >= dictSize && p - 2 + MIN_MATCH <= end) {
+            table[hash32(read32(in + p - 2))] = p - 2;
+        }
+    }
+    out = writeSequence(out, in + anchor, end - anchor, 0, 0);
+    return static_cast<long>(out - reinterpret_cast<unsigned char*>(dst));
+}
+
+bool AntiCacheCodec::decompress(const char *src, long size, char *dst, long rawSize,
+                                const char *dict, long dictSize) {
+    const unsigned char *in = reinterpret_cast<const unsigned char*>(src);
+    const unsigned char *inEnd = in + size;
+    unsigned char *out = reinterpret_cast<unsigned char*>(dst);
+    const unsigned char *history = reinterpret_cast<const unsigned char*>(dict);
+    long produced = 0;
+
+    while (in < inEnd) {
+        const unsigned char token = *in++;
+        long literalLength = token >> 4;
+        if (literalLength == 15 && !readLength(in, inEnd, literalLength)) {
+            return false;
+        }
+        if (literalLength > inEnd - in || literalLength > rawSize - produced) {
+            return false;
+        }
+        memcpy(out + produced, in, literalLength);
+        in += literalLength;
+        produced += literalLength;
+        if (in == inEnd) {
+            break;
+        }
+
+        if (inEnd - in < 2) {
+            return false;
+        }
+        const long offset = in[0] | (static_cast<long>(in[1]) << 8);
+        in += 2;
+        long matchLength = token & 0x0f;
+        if (matchLength == 15 && !readLength(in, inEnd, matchLength)) {
+            return false;
+        }
+        matchLength += MIN_MATCH;
+        if (offset == 0 || offset > produced + dictSize || matchLength > rawSize - produced) {
+            return false;
+        }
+        if (offset <= produced) {
+            // byte by byte, as the match may overlap its own output
+            const unsigned char *from = out + produced - offset;
+            for (long i = 0; i < matchLength; i++) {
+                out[produced + i] = from[i];
+            }
+        } else {
+            for (long i = 0; i < matchLength; i++) {
+                const long from = produced + i - offset;
+                out[produced + i] = from < 0 ? history[dictSize + from] : out[from];
+            }
+        }
+        produced += matchLength;
+    }
+    return produced == rawSize;
+}
+
+std::string AntiCacheCodec::trainDictionary(const char *data, long size) {
+    if (size <= MAX_DICTIONARY_SIZE) {
+        return std::string(data, size);
+    }
+    // samples spread evenly over the block, so that the dictionary holds
+    // the values of many tuples rather than of the first ones only
+    const long samples = MAX_DICTIONARY_SIZE / DICTIONARY_SAMPLE;
+    const long stride = size / samples;
+    std::string dictionary;
+    dictionary.reserve(MAX_DICTIONARY_SIZE);
+    for (long i = 0; i < samples; i++) {
+        dictionary.append(data + i * stride, DICTIONARY_SAMPLE);
+    }
+    return dictionary;
+}
+
+}
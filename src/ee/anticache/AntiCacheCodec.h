@@ -0,0 +1,74 @@
+/* Copyright (C) 2014 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef HSTOREANTICACHECODEC_H
+#define HSTOREANTICACHECODEC_H
+
+#include <string>
+#include <stdint.h>
+
+namespace voltdb {
+
+/**
+ * Byte-oriented LZ77 codec for evicted blocks. The output is a run of
+ * sequences, each a token byte with a literal length and a match length
+ * nibble, the literals, and a two byte offset of the match. Optionally a
+ * dictionary is used as the history that comes before the first byte, so
+ * that the first tuples of a block already find matches.
+ */
+class AntiCacheCodec {
+    public:
+        /**
+         * Largest compressed size of size bytes
+         */
+        static inline long maxCompressedSize(long size) {
+            return size + size / 255 + 16;
+        }
+
+        /**
+         * Compress size bytes into dst, which has to hold maxCompressedSize(size)
+         * bytes. Returns the compressed size.
+         */
+        static long compress(const char *src, long size, char *dst,
+                             const char *dict, long dictSize);
+
+        /**
+         * Decompress into exactly rawSize bytes with the dictionary that the
+         * data was compressed with. Returns false if the data is corrupt.
+         */
+        static bool decompress(const char *src, long size, char *dst, long rawSize,
+                               const char *dict, long dictSize);
+
+        /**
+         * Build a dictionary from samples spread over a block of a table
+         */
+        static std::string trainDictionary(const char *data, long size);
+
+        static const long MAX_DICTIONARY_SIZE = 32768;
+};
+
+}
+
+#endif
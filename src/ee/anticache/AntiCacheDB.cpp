@@ -26,15 +26,19 @@
 #include "anticache/AntiCacheDB.h"
 #include "anticache/UnknownBlockAccessException.h"
 #include "anticache/AntiCacheStats.h"
+#include "anticache/AntiCacheCodec.h"
 #include "common/debuglog.h"
 #include "common/FatalException.hpp"
 #include "common/executorcontext.hpp"
+#include "boost/scoped_array.hpp"
 #include <fcntl.h>
 #include <unistd.h>
 #include <errno.h>
 #include <sys/mman.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
 
 using namespace std;
 
@@ -48,6 +52,53 @@ AntiCacheBlock::AntiCacheBlock(uint32_t blockId) {
         m_blockId = blockId;
 
   }
+
+char* AntiCacheBlock::releaseData() {
+    char *data = new char[m_size];
+    memcpy(data, m_block, m_size);
+    return data;
+}
+
+/**
+ * Header in front of every block that is written with a codec
+ */
+struct AntiCacheCodecHeader {
+    uint8_t codec;
+    uint8_t pad[3];
+    int32_t rawSize;
+};
+
+/**
+ * A block decoded from the block that the database read back in
+ */
+class DecodedAntiCacheBlock : public AntiCacheBlock {
+    public:
+        DecodedAntiCacheBlock(AntiCacheBlock *stored, char *data, long size) :
+            AntiCacheBlock(stored->getBlockId()) {
+            m_payload.blockId = m_blockId;
+            m_payload.tableName = stored->getTableName();
+            m_payload.data = data;
+            m_payload.size = size;
+            m_block = data;
+            m_buf = data;
+            m_size = static_cast<int32_t>(size);
+            m_blockType = stored->getBlockType();
+        }
+        ~DecodedAntiCacheBlock() {
+            delete [] m_buf;
+        }
+        char* releaseData() {
+            char *data = m_buf;
+            m_buf = NULL;
+            return data;
+        }
+};
+
+static inline int64_t elapsedMicros(const timeval &start) {
+    timeval end;
+    gettimeofday(&end, NULL);
+    return (int64_t)(end.tv_sec - start.tv_sec) * 1000000 + (end.tv_usec - start.tv_usec);
+}
    
 AntiCacheDB::AntiCacheDB(ExecutorContext *ctx, std::string db_dir, long blockSize, long maxSize) :
     m_executorContext(ctx),
@@ -55,7 +106,12 @@ AntiCacheDB::AntiCacheDB(ExecutorContext *ctx, std::string db_dir, long blockSiz
     m_nextBlockId(0),
     m_blockSize(blockSize),
     m_totalBlocks(0),
-    m_block_merge(1)
+    m_block_merge(1),
+    m_codec(ANTICACHE_CODEC_NONE),
+    m_codecRawBytes(0),
+    m_codecStoredBytes(0),
+    m_codecCompressTime(0),
+    m_codecDecompressTime(0)
     { 
         // MJG: TODO: HACK: Come up with a better way to make a maxsize when one isn't given
         if (maxSize == -1) {
@@ -86,6 +142,121 @@ AntiCacheDB::~AntiCacheDB() {
     evictedTupleInBlock.clear();
 }
 
+void AntiCacheDB::writeBlock(const std::string tableName,
+                             uint32_t blockId,
+                             const int tupleCount,
+                             const char* data,
+                             const long size,
+                             const int evictedTupleCount) {
+    if (m_codec == ANTICACHE_CODEC_NONE) {
+        storeBlock(tableName, blockId, tupleCount, data, size, evictedTupleCount);
+        return;
+    }
+
+    timeval start;
+    gettimeofday(&start, NULL);
+
+    const char *dict = NULL;
+    long dictSize = 0;
+    if (m_codec == ANTICACHE_CODEC_LZ_DICT) {
+        std::map<std::string, std::string>::iterator it = m_codecDictionaries.find(tableName);
+        if (it == m_codecDictionaries.end()) {
+            it = m_codecDictionaries.insert(
+                std::make_pair(tableName, AntiCacheCodec::trainDictionary(data, size))).first;
+        }
+        dict = it->second.data();
+        dictSize = static_cast<long>(it->second.size());
+    }
+
+    AntiCacheCodecHeader header;
+    memset(&header, 0, sizeof(header));
+    header.codec = static_cast<uint8_t>(m_codec);
+    header.rawSize = static_cast<int32_t>(size);
+
+    boost::scoped_array<char> buf(new char[sizeof(header) + AntiCacheCodec::maxCompressedSize(size)]);
+    long storedSize = AntiCacheCodec::compress(data, size, buf.get() + sizeof(header), dict, dictSize);
+    if (storedSize >= size) {
+        // not worth decompressing, store the block as it is
+        header.codec = static_cast<uint8_t>(ANTICACHE_CODEC_NONE);
+        memcpy(buf.get() + sizeof(header), data, size);
+        storedSize = size;
+    }
+    memcpy(buf.get(), &header, sizeof(header));
+    storedSize += sizeof(header);
+    m_codecCompressTime += elapsedMicros(start);
+    m_codecRawBytes += size;
+    m_codecStoredBytes += storedSize;
+
+    VOLT_DEBUG("Encoded block #%u of table %s [raw=%ld / stored=%ld]",
+               blockId, tableName.c_str(), size, storedSize);
+    storeBlock(tableName, blockId, tupleCount, buf.get(), storedSize, evictedTupleCount);
+}
+
+AntiCacheBlock* AntiCacheDB::readBlock(uint32_t blockId, bool isMigrate) {
+    long storedSize;
+    AntiCacheBlock *block = fetchBlock(blockId, &storedSize);
+    unevictBlock(blockId, storedSize, isMigrate);
+    return block;
+}
+
+AntiCacheBlock* AntiCacheDB::fetchBlock(uint32_t blockId, long *storedSize) {
+    AntiCacheBlock *stored = loadBlock(blockId);
+    *storedSize = stored->getSize();
+    if (m_codec == ANTICACHE_CODEC_NONE) {
+        return stored;
+    }
+
+    timeval start;
+    gettimeofday(&start, NULL);
+
+    AntiCacheCodecHeader header;
+    if (stored->getSize() < (long)sizeof(header)) {
+        delete stored;
+        throwFatalException("Anti-cache block #%u is too short for its codec header", blockId);
+    }
+    memcpy(&header, stored->getData(), sizeof(header));
+    const char *src = stored->getData() + sizeof(header);
+    long srcSize = stored->getSize() - sizeof(header);
+
+    const char *dict = NULL;
+    long dictSize = 0;
+    if (header.codec == ANTICACHE_CODEC_LZ_DICT) {
+        std::map<std::string, std::string>::iterator it = m_codecDictionaries.find(stored->getTableName());
+        if (it == m_codecDictionaries.end()) {
+            std::string tableName = stored->getTableName();
+            delete stored;
+            throwFatalException("No codec dictionary for anti-cache block #%u of table %s",
+                                blockId, tableName.c_str());
+        }
+        dict = it->second.data();
+        dictSize = static_cast<long>(it->second.size());
+    }
+
+    char *data = new char[header.rawSize > 0 ? header.rawSize : 1];
+    bool valid = header.rawSize >= 0;
+    if (valid && header.codec == ANTICACHE_CODEC_NONE) {
+        valid = srcSize == header.rawSize;
+        if (valid) {
+            memcpy(data, src, srcSize);
+        }
+    } else if (valid && header.codec <= ANTICACHE_CODEC_LZ_DICT) {
+        valid = AntiCacheCodec::decompress(src, srcSize, data, header.rawSize, dict, dictSize);
+    } else {
+        valid = false;
+    }
+    if (!valid) {
+        delete [] data;
+        delete stored;
+        throwFatalException("Failed to decode anti-cache block #%u [codec=%d]", blockId, (int)header.codec);
+    }
+
+    AntiCacheBlock *block = new DecodedAntiCacheBlock(stored, data, header.rawSize);
+    delete stored;
+    // blocks of a batch are decoded by several threads
+    __sync_fetch_and_add(&m_codecDecompressTime, elapsedMicros(start));
+    return block;
+}
+
 AntiCacheBlock* AntiCacheDB::getLRUBlock() {
     uint32_t lru_block_id;
     AntiCacheBlock* lru_block;
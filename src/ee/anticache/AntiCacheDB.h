@@ -84,6 +84,12 @@ class AntiCacheBlock {
         inline AntiCacheDBType getBlockType() const {
             return m_blockType;
         }
+
+        /**
+         * Hand over the data of the block as a buffer allocated with new[].
+         * Blocks that own such a buffer give it away without a copy.
+         */
+        virtual char* releaseData();
     
     protected:
         // Why is this private/protected?
@@ -105,17 +111,37 @@ class AntiCacheDB {
         virtual ~AntiCacheDB();
 
         /**
-         * Write a block of serialized tuples out to the anti-cache database
+         * Write a block of serialized tuples out to the anti-cache database,
+         * encoded with the codec of the database
+         */
+        void writeBlock(const std::string tableName,
+                        uint32_t blockId,
+                        const int tupleCount,
+                        const char* data,
+                        const long size, const int evictedTupleCount);
+        /**
+         * Read a block and return its decoded contents
          */
-        virtual void writeBlock(const std::string tableName,
-                                uint32_t blockId,
-                                const int tupleCount,
-                                const char* data,
-                                const long size, const int evictedTupleCount) = 0;
+        AntiCacheBlock* readBlock(uint32_t blockId, bool isMigrate);
+
         /**
-         * Read a block and return its contents
+         * Read and decode a block without updating the database, so that a
+         * batch of blocks can be fetched from several threads at once while
+         * nothing else uses the database. storedSize is set to the size the
+         * block takes up in the database, which unevictBlock needs.
          */
-        virtual AntiCacheBlock* readBlock(uint32_t blockId, bool isMigrate) = 0;
+        AntiCacheBlock* fetchBlock(uint32_t blockId, long *storedSize);
+
+        /**
+         * Update the stats and the LRU of the database for a fetched block,
+         * and remove it if it is migrated or merged as a whole
+         */
+        virtual void unevictBlock(uint32_t blockId, long storedSize, bool isMigrate) = 0;
+
+        /**
+         * Hint that the given blocks are about to be fetched
+         */
+        virtual void prefetchBlocks(const std::vector<uint32_t> &blockIds) {}
 
         virtual bool validateBlock(uint32_t blockId) = 0;
 
@@ -315,6 +341,35 @@ class AntiCacheDB {
             return evictedTupleInBlock[blockId];
         }
 
+        /**
+         * Set the codec that blocks are written with. This has to be done
+         * before the first block is written.
+         */
+        inline void setCodec(AntiCacheCodecType codec) {
+            m_codec = codec;
+        }
+
+        inline AntiCacheCodecType getCodec() const {
+            return m_codec;
+        }
+
+        /*
+         * bytes handed to and stored by the codec, and the microseconds
+         * spent compressing and decompressing
+         */
+        inline int64_t getCodecRawBytes() const {
+            return m_codecRawBytes;
+        }
+        inline int64_t getCodecStoredBytes() const {
+            return m_codecStoredBytes;
+        }
+        inline int64_t getCodecCompressTime() const {
+            return m_codecCompressTime;
+        }
+        inline int64_t getCodecDecompressTime() const {
+            return m_codecDecompressTime;
+        }
+
     protected:
         ExecutorContext *m_executorContext;
         string m_dbDir;
@@ -353,11 +408,31 @@ class AntiCacheDB {
 
         std::deque<uint32_t> m_block_lru;
 
+        AntiCacheCodecType m_codec;
+        // dictionaries of the tables for ANTICACHE_CODEC_LZ_DICT, kept in memory
+        // only as the database does not outlive the EE
+        std::map<std::string, std::string> m_codecDictionaries;
+        int64_t m_codecRawBytes;
+        int64_t m_codecStoredBytes;
+        int64_t m_codecCompressTime;
+        int64_t m_codecDecompressTime;
+
         /*
          * DB specific method of shutting down the database on destructor call
          */
         virtual void shutdownDB() = 0;
 
+        /**
+         * DB specific methods to store and load a block as it is. loadBlock
+         * must not change the database.
+         */
+        virtual void storeBlock(const std::string tableName,
+                                uint32_t blockId,
+                                const int tupleCount,
+                                const char* data,
+                                const long size, const int evictedTupleCount) = 0;
+        virtual AntiCacheBlock* loadBlock(uint32_t blockId) = 0;
+
         
 }; // CLASS
 
@@ -40,6 +40,8 @@
 #include "anticache/FullBackingStoreException.h"
 #include "anticache/AntiCacheDB.h"
 #include "anticache/BerkeleyAntiCacheDB.h"
+#include "anticache/AntiCacheBlockWriter.h"
+#include "anticache/AntiCacheBlockReader.h"
 
 #include <string>
 #include <vector>
@@ -87,6 +89,8 @@ AntiCacheEvictionManager::AntiCacheEvictionManager(const VoltDBEngine *engine) {
     m_blockable_accesses = true;
     m_numdbs = 0;
     m_migrate = false;
+    m_blockWriter = NULL;
+    m_blockReader = NULL;
 
 
     if (pthread_mutex_init(&lock, NULL) != 0) {
@@ -96,6 +100,9 @@ AntiCacheEvictionManager::AntiCacheEvictionManager(const VoltDBEngine *engine) {
 }
 
 AntiCacheEvictionManager::~AntiCacheEvictionManager() {
+    // queued blocks are written out before the AntiCacheDBs go away
+    delete m_blockWriter;
+    delete m_blockReader;
     delete m_evictResultTable;
     delete m_evicted_tuple;
     TupleSchema::freeTupleSchema(m_evicted_schema);
@@ -156,9 +163,9 @@ bool AntiCacheEvictionManager::updateUnevictedTuple(PersistentTable* table, Tabl
     if(table->getEvictedTable() == NULL || table->isBatchEvicted())  // no need to maintain chain for non-evictable tables or batch evicted tables
         return true;
 
-#ifndef ANTICACHE_TIMESTAMPS
+#if !defined(ANTICACHE_TIMESTAMPS) && !defined(ANTICACHE_CLOCK)
     int tuples_in_chain;
-    int current_tuple_id = table->getTupleID(tuple->address()); // scan blocks for this tuple
+    int current_tuple_id = table->getTupleID(tuple->address());
     
     if (current_tuple_id < 0)
         return false; 
@@ -187,6 +194,9 @@ bool AntiCacheEvictionManager::updateUnevictedTuple(PersistentTable* table, Tabl
     tuples_in_chain = table->getNumTuplesInEvictionChain(); 
     ++tuples_in_chain; 
     table->setNumTuplesInEvictionChain(tuples_in_chain); 
+#elif defined(ANTICACHE_CLOCK)
+    // unevicted tuples are the first ones the sweep hands back
+    tuple->setReferencedFalse();
 #else
     // set timestamp to the coldest
     tuple->setColdTimeStamp();
@@ -201,13 +211,13 @@ bool AntiCacheEvictionManager::updateTuple(PersistentTable* table, TableTuple* t
         return true; 
 
 
-#ifndef ANTICACHE_TIMESTAMPS
+#if !defined(ANTICACHE_TIMESTAMPS) && !defined(ANTICACHE_CLOCK)
     int SAMPLE_RATE = 100; // aLRU sampling rate
 
     int tuples_in_chain;
 
     uint32_t newest_tuple_id;
-    uint32_t update_tuple_id = table->getTupleID(tuple->address()); // scan blocks for this tuple
+    uint32_t update_tuple_id = table->getTupleID(tuple->address());
         
     // this is an update, so we have to remove the previous entry in the chain
     if (!is_insert) {
@@ -272,6 +282,13 @@ bool AntiCacheEvictionManager::updateTuple(PersistentTable* table, TableTuple* t
     ++tuples_in_chain; 
 
     table->setNumTuplesInEvictionChain(tuples_in_chain);
+#elif defined(ANTICACHE_CLOCK)
+    // an access only sets the reference bit, which the sweep of the next
+    // eviction clears. The bit is tested first so that hot tuples are not
+    // written again on every read.
+    if (!tuple->isReferenced()) {
+        tuple->setReferencedTrue();
+    }
 #else
     // set timestamp to the hotest
     TableTuple update_tuple(tuple->address(), table->m_schema);
@@ -281,7 +298,7 @@ bool AntiCacheEvictionManager::updateTuple(PersistentTable* table, TableTuple* t
     return true; 
 }
 
-#ifndef ANTICACHE_TIMESTAMPS
+#if !defined(ANTICACHE_TIMESTAMPS) && !defined(ANTICACHE_CLOCK)
 bool AntiCacheEvictionManager::removeTuple(PersistentTable* table, TableTuple* tuple) {
     int current_tuple_id = table->getTupleID(tuple->address());
     
@@ -553,6 +570,11 @@ bool AntiCacheEvictionManager::evictBlockToDisk(PersistentTable *table, const lo
         throwFatalException("Trying to evict block from table '%s' before its "\
                             "EvictedTable has been initialized", table->name().c_str());
     }
+    if (!table->canEvict()) {
+        VOLT_WARN("Not evicting from table '%s': an index key refers to its tuples",
+                  table->name().c_str());
+        return true;
+    }
     VOLT_DEBUG("Evicting a block of size %ld bytes from table '%s' with %d tuples",
                block_size, table->name().c_str(), (int)table->allocatedTupleCount());
     VOLT_DEBUG("%s Table Schema:\n%s",
@@ -569,28 +591,35 @@ bool AntiCacheEvictionManager::evictBlockToDisk(PersistentTable *table, const lo
     // Iterate through the table and pluck out tuples to put in our block
     TableTuple tuple(table->m_schema);
     EvictionIterator evict_itr(table);
-#ifdef ANTICACHE_TIMESTAMPS
+#if defined(ANTICACHE_TIMESTAMPS) || defined(ANTICACHE_CLOCK)
     evict_itr.reserve((int64_t)block_size * num_blocks);
 #endif
 
     for(int i = 0; i < num_blocks; i++)
     {
 
-        // get the AntiCacheDB instance from the executorContext
-        // For now use the single AntiCacheDB from PersistentTable but in the future, this 
-        // method to get the AntiCacheDB will have to choose which AntiCacheDB from to
-        // evict to
-        antiCacheDB = table->getAntiCacheDB(chooseDB(block_size, m_migrate));
-               
-        // get the LS28B and send that to the antiCacheDB
-        uint32_t _block_id = antiCacheDB->nextBlockId();
-
-        // find out whether this tier blocks and set a flag (bit 19)
-        // then shift 3b for the ACID (8 levels)
-        // then shift 28b for the tier-unique block id (TUID)
-        int32_t block_id = antiCacheDB->isBlocking();
-        block_id = (block_id | ((int32_t)antiCacheDB->getACID() << 1));
-        block_id = ((block_id << 28) | (int32_t)_block_id); 
+        prepareBlockWrite();
+        uint32_t _block_id;
+        int32_t block_id;
+        {
+            AntiCacheBlockWriter::DBLock dbLock(m_blockWriter);
+
+            // get the AntiCacheDB instance from the executorContext
+            // For now use the single AntiCacheDB from PersistentTable but in the future, this 
+            // method to get the AntiCacheDB will have to choose which AntiCacheDB from to
+            // evict to
+            antiCacheDB = table->getAntiCacheDB(chooseDB(block_size, m_migrate));
+
+            // get the LS28B and send that to the antiCacheDB
+            _block_id = antiCacheDB->nextBlockId();
+
+            // find out whether this tier blocks and set a flag (bit 19)
+            // then shift 3b for the ACID (8 levels)
+            // then shift 28b for the tier-unique block id (TUID)
+            block_id = antiCacheDB->isBlocking();
+            block_id = (block_id | ((int32_t)antiCacheDB->getACID() << 1));
+            block_id = ((block_id << 28) | (int32_t)_block_id); 
+        }
 
 
         // create a new evicted table tuple based on the schema for the source tuple
@@ -628,7 +657,7 @@ bool AntiCacheEvictionManager::evictBlockToDisk(PersistentTable *table, const lo
 
             //current_tuple_start_position = out.position();
 
-            #ifndef ANTICACHE_TIMESTAMPS
+            #if !defined(ANTICACHE_TIMESTAMPS) && !defined(ANTICACHE_CLOCK)
             // remove the tuple from the eviction chain
             removeTuple(table, &tuple);
             #endif
@@ -661,7 +690,6 @@ bool AntiCacheEvictionManager::evictBlockToDisk(PersistentTable *table, const lo
             //    printf("BIG SIZE: %d\n", block.getSerializedSize() - initSize - (int32_t)ValuePeeker::peekInteger(evicted_tuple.getNValue(1)));
 
             // At this point it's safe for us to delete this mofo
-            table->updateStringMemory(- ((int)tuple.getNonInlinedMemorySize()));
             tuple.freeObjectColumns(); // will return memory for uninlined strings to the heap
             table->deleteTupleStorage(tuple);
 
@@ -700,13 +728,18 @@ bool AntiCacheEvictionManager::evictBlockToDisk(PersistentTable *table, const lo
             // block.flush();
             //  antiCacheDB->writeBlock(block);
             VOLT_DEBUG("about to write block %x to acid %d", _block_id, antiCacheDB->getACID());
-            antiCacheDB->writeBlock(table->name(),
-                                    _block_id,
-                                    num_tuples_evicted,
-                                    blockdata,
-                                    blocksize,
-                                    num_tuples_evicted
-                                    );
+            if (m_blockWriter != NULL) {
+                m_blockWriter->enqueue(antiCacheDB, table->name(), _block_id,
+                                       num_tuples_evicted, blockdata, blocksize);
+            } else {
+                antiCacheDB->writeBlock(table->name(),
+                                        _block_id,
+                                        num_tuples_evicted,
+                                        blockdata,
+                                        blocksize,
+                                        num_tuples_evicted
+                                        );
+            }
             
             // MJG: We need to check whether we're reusing a blockID.
 
@@ -758,7 +791,11 @@ bool AntiCacheEvictionManager::evictBlockToDisk(PersistentTable *table, const lo
 
     }  // FOR
 
-    if (needs_flush) {
+    // the tuples of the blocks are gone from the table, so the eviction is
+    // not done before its blocks are durable or their failure is thrown
+    if (needs_flush && m_blockWriter != NULL) {
+        m_blockWriter->drain();
+    } else if (needs_flush) {
         #ifdef VOLT_INFO_ENABLED
         boost::timer timer;
         #endif
@@ -791,6 +828,11 @@ bool AntiCacheEvictionManager::evictBlockToDiskInBatch(PersistentTable *table, P
         throwFatalException("Trying to evict block from table '%s' before its "\
                             "EvictedTable has been initialized", table->name().c_str());
     }
+    if (!table->canEvict() || !childTable->canEvict()) {
+        VOLT_WARN("Not evicting from table '%s': an index key refers to its tuples "
+                  "or to those of '%s'", table->name().c_str(), childTable->name().c_str());
+        return true;
+    }
     //VOLT_INFO("Evicting a block of size %ld bytes from table '%s' with %d tuples",
     //           block_size, table->name().c_str(), (int)table->allocatedTupleCount());
  //   VOLT_DEBUG("%s Table Schema:\n%s",
@@ -800,6 +842,7 @@ bool AntiCacheEvictionManager::evictBlockToDiskInBatch(PersistentTable *table, P
     AntiCacheDB* antiCacheDB;
     int tuple_length = -1;
     bool needs_flush = false;
+    bool queued = false;
 
 
    // #ifdef VOLT_INFO_ENABLED
@@ -826,7 +869,7 @@ bool AntiCacheEvictionManager::evictBlockToDiskInBatch(PersistentTable *table, P
     EvictionIterator evict_itr(table);
     VOLT_DEBUG("here2!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!\n");
 
-#ifdef ANTICACHE_TIMESTAMPS
+#if defined(ANTICACHE_TIMESTAMPS) || defined(ANTICACHE_CLOCK)
     // TODO: what should I do with this?
     evict_itr.reserve((int64_t)block_size * num_blocks / 2);
 #endif
@@ -837,16 +880,22 @@ bool AntiCacheEvictionManager::evictBlockToDiskInBatch(PersistentTable *table, P
    //     this->printLRUChain(table, 4, true);
     //    VOLT_INFO("Printing child's LRU chain");
    //     this->printLRUChain(childTable, 4, true);
-        antiCacheDB = table->getAntiCacheDB(chooseDB(block_size, m_migrate));
-        // get a unique block id from the executorContext
-        antiCacheDB = table->getAntiCacheDB(chooseDB(block_size, m_migrate));
-        uint32_t _block_id = antiCacheDB->nextBlockId();
-        // find out whether this tier blocks and set a flag (bit 31)
-        // then shift 3b for the ACID (8 levels)
-        // then shift 28b for the tier-unique block id (TUID)
-        int32_t block_id = antiCacheDB->isBlocking();
-        block_id = block_id | ((int32_t)antiCacheDB->getACID() << 1);
-        block_id = ((block_id << 28) | (int32_t)_block_id); 
+        prepareBlockWrite();
+        uint32_t _block_id;
+        int32_t block_id;
+        {
+            AntiCacheBlockWriter::DBLock dbLock(m_blockWriter);
+            antiCacheDB = table->getAntiCacheDB(chooseDB(block_size, m_migrate));
+            // get a unique block id from the executorContext
+            antiCacheDB = table->getAntiCacheDB(chooseDB(block_size, m_migrate));
+            _block_id = antiCacheDB->nextBlockId();
+            // find out whether this tier blocks and set a flag (bit 31)
+            // then shift 3b for the ACID (8 levels)
+            // then shift 28b for the tier-unique block id (TUID)
+            block_id = antiCacheDB->isBlocking();
+            block_id = block_id | ((int32_t)antiCacheDB->getACID() << 1);
+            block_id = ((block_id << 28) | (int32_t)_block_id); 
+        }
 
         // create a new evicted table tuple based on the schema for the source tuple
         TableTuple evicted_tuple = evictedTable->tempTuple();
@@ -936,7 +985,7 @@ bool AntiCacheEvictionManager::evictBlockToDiskInBatch(PersistentTable *table, P
             }
             parentTuples++;
 
-#ifndef ANTICACHE_TIMESTAMPS
+#if !defined(ANTICACHE_TIMESTAMPS) && !defined(ANTICACHE_CLOCK)
             // remove the tuple from the eviction chain
             removeTuple(table, &tuple);
 #endif
@@ -1048,14 +1097,23 @@ bool AntiCacheEvictionManager::evictBlockToDiskInBatch(PersistentTable *table, P
             //          antiCacheDB->writeBlock(block);
 
 
-            antiCacheDB->writeBlock(table->name(),
-                    _block_id,
-                    num_tuples_evicted,
-                    block.getSerializedData(),
-                    block.getSerializedSize(),
-                    num_tuples_evicted
-                    );
-            needs_flush = true;
+            if (m_blockWriter != NULL) {
+                long blocksize = block.getSerializedSize();
+                char* blockdata = new char[blocksize];
+                memcpy(blockdata, block.getSerializedData(), blocksize);
+                m_blockWriter->enqueue(antiCacheDB, table->name(), _block_id,
+                                       num_tuples_evicted, blockdata, blocksize);
+                queued = true;
+            } else {
+                antiCacheDB->writeBlock(table->name(),
+                        _block_id,
+                        num_tuples_evicted,
+                        block.getSerializedData(),
+                        block.getSerializedSize(),
+                        num_tuples_evicted
+                        );
+                needs_flush = true;
+            }
 
 
             // store pointer to AntiCacheDB associated with this block
@@ -1107,6 +1165,10 @@ bool AntiCacheEvictionManager::evictBlockToDiskInBatch(PersistentTable *table, P
 
     }  // FOR
 
+    // as in evictBlockToDisk, wait for the queued blocks to be durable
+    if (queued) {
+        m_blockWriter->drain();
+    }
     if (needs_flush) {
         //     #ifdef VOLT_INFO_ENABLED
         //   boost::timer timer;
@@ -1183,6 +1245,95 @@ Table* AntiCacheEvictionManager::evictBlockInBatch(PersistentTable *table, Persi
 // }
     
 bool AntiCacheEvictionManager::readEvictedBlock(PersistentTable *table, int32_t block_id, int32_t tuple_offset) {
+    AntiCacheDB* antiCacheDB = m_db_lookup[(int16_t)((block_id & 0xE0000000) >> 29)];
+
+    // a block that is still queued in the writer is not in its AntiCacheDB yet
+    if (m_blockWriter != NULL) {
+        m_blockWriter->waitForBlock(antiCacheDB, (uint32_t)(block_id & 0x0FFFFFFF));
+    }
+    AntiCacheBlockWriter::DBLock dbLock(m_blockWriter);
+
+    AntiCacheBlock* fetched = NULL;
+    return unevictBlock(table, block_id, tuple_offset, fetched, 0);
+}
+
+/*
+ * Reads all the blocks that a transaction touched at once. The distinct
+ * blocks that are not unevicted yet are fetched by the reader threads,
+ * and then merged into the table in the order they were requested.
+ */
+bool AntiCacheEvictionManager::readEvictedBlocks(PersistentTable *table, int numBlocks,
+                                                 int32_t blockIds[], int32_t tupleOffsets[]) {
+    if (m_blockReader == NULL) {
+        bool finalResult = true;
+        for (int i = 0; i < numBlocks; i++) {
+            finalResult = readEvictedBlock(table, blockIds[i], tupleOffsets[i]) && finalResult;
+        }
+        return finalResult;
+    }
+
+    if (m_blockWriter != NULL) {
+        for (int i = 0; i < numBlocks; i++) {
+            m_blockWriter->waitForBlock(m_db_lookup[(int16_t)((blockIds[i] & 0xE0000000) >> 29)],
+                                        (uint32_t)(blockIds[i] & 0x0FFFFFFF));
+        }
+    }
+    AntiCacheBlockWriter::DBLock dbLock(m_blockWriter);
+
+    std::vector<AntiCacheBlockReader::Request> requests;
+    std::vector<int> requestOf(numBlocks, -1);
+    std::map<int32_t, int> requested;
+    std::map<AntiCacheDB*, std::vector<uint32_t> > prefetch;
+    for (int i = 0; i < numBlocks; i++) {
+        if (requested.find(blockIds[i]) != requested.end() || table->isAlreadyUnEvicted(blockIds[i])) {
+            continue;
+        }
+        AntiCacheBlockReader::Request request;
+        request.antiCacheDB = m_db_lookup[(int16_t)((blockIds[i] & 0xE0000000) >> 29)];
+        request.blockId = (uint32_t)(blockIds[i] & 0x0FFFFFFF);
+        request.block = NULL;
+        request.storedSize = 0;
+        if (!request.antiCacheDB->validateBlock(request.blockId)) {
+            continue;
+        }
+        requested[blockIds[i]] = requestOf[i] = (int)requests.size();
+        requests.push_back(request);
+        prefetch[request.antiCacheDB].push_back(request.blockId);
+    }
+    for (std::map<AntiCacheDB*, std::vector<uint32_t> >::iterator it = prefetch.begin(); it != prefetch.end(); ++it) {
+        it->first->prefetchBlocks(it->second);
+    }
+    m_blockReader->fetchBlocks(requests);
+
+    bool finalResult = true;
+    try {
+        for (int i = 0; i < numBlocks; i++) {
+            AntiCacheBlock* dummy = NULL;
+            AntiCacheBlockReader::Request* request = requestOf[i] >= 0 ? &requests[requestOf[i]] : NULL;
+            // a block that failed to be fetched is read again, which raises the error
+            finalResult = unevictBlock(table, blockIds[i], tupleOffsets[i],
+                                       request != NULL ? request->block : dummy,
+                                       request != NULL ? request->storedSize : 0) && finalResult;
+        }
+    } catch (...) {
+        for (size_t i = 0; i < requests.size(); i++) {
+            delete requests[i].block;
+        }
+        throw;
+    }
+    for (size_t i = 0; i < requests.size(); i++) {
+        delete requests[i].block;
+    }
+    return finalResult;
+}
+
+/*
+ * Merges a block into the table, reading it from its AntiCacheDB unless it
+ * was fetched already. A fetched block that is used is set to NULL. The
+ * caller holds the DB lock.
+ */
+bool AntiCacheEvictionManager::unevictBlock(PersistentTable *table, int32_t block_id, int32_t tuple_offset,
+                                            AntiCacheBlock *&fetched, long storedSize) {
 
     int already_unevicted = table->isAlreadyUnEvicted(block_id);
     if (already_unevicted && table->mergeStrategy()) { // this block has already been read
@@ -1253,19 +1404,26 @@ bool AntiCacheEvictionManager::readEvictedBlock(PersistentTable *table, int32_t
     try {
         VOLT_DEBUG("BLOCK %u %d - unevicted blocks size is %d - alreadyUevicted %d",
                    _block_id, block_id, static_cast<int>(table->unevictedBlocksSize()), already_unevicted);
-        AntiCacheBlock* value = antiCacheDB->readBlock(_block_id, 0);
+        AntiCacheBlock* value;
+        if (fetched != NULL) {
+            value = fetched;
+            fetched = NULL;
+            antiCacheDB->unevictBlock(_block_id, storedSize, 0);
+        } else {
+            value = antiCacheDB->readBlock(_block_id, 0);
+        }
 
-        // allocate the memory for this block
-        char* unevicted_tuples = new char[value->getSize()];
-        memcpy(unevicted_tuples, value->getData(), value->getSize());
+        // the table takes over the data of the block
+        long unevicted_size = value->getSize();
+        char* unevicted_tuples = value->releaseData();
         /*
         for (int i = 0; i < 200; i++) {
             printf( "%X", unevicted_tuples[i]);
         }
         cout << "\n";*/
         VOLT_INFO("***************** READ EVICTED BLOCK %d *****************", _block_id);
-        VOLT_INFO("Block Size = %d / Table = %s", value->getSize(), table->name().c_str());
-        ReferenceSerializeInput in(unevicted_tuples, value->getSize());
+        VOLT_INFO("Block Size = %ld / Table = %s", unevicted_size, table->name().c_str());
+        ReferenceSerializeInput in(unevicted_tuples, unevicted_size);
         
         // Read in all the block meta-data
         int num_tables = in.readInt();
@@ -1397,6 +1555,7 @@ int32_t AntiCacheEvictionManager::migrateBlock(int32_t block_id, AntiCacheDB* ds
     uint32_t _new_block_id = 0;
     int16_t new_acid;
     int32_t new_block_id = 0;
+    AntiCacheBlockWriter::DBLock dbLock(m_blockWriter);
 
     if (dstDB->getFreeBlocks() == 0) {
         VOLT_WARN("Our destination is full!");
@@ -1566,6 +1725,49 @@ int16_t AntiCacheEvictionManager::addAntiCacheDB(AntiCacheDB* acdb) {
 /*
  * Get a pointer to the AntiCacheDB identified by given ACID
  */
+void AntiCacheEvictionManager::setAsyncEviction(int maxPendingBlocks) {
+    delete m_blockWriter;
+    m_blockWriter = NULL;
+    if (maxPendingBlocks > 0) {
+        VOLT_INFO("Writing evicted blocks in the background with up to %d blocks queued", maxPendingBlocks);
+        m_blockWriter = new AntiCacheBlockWriter(maxPendingBlocks);
+    }
+}
+
+void AntiCacheEvictionManager::setAsyncUneviction(int numThreads) {
+    delete m_blockReader;
+    m_blockReader = NULL;
+    if (numThreads > 0) {
+        VOLT_INFO("Fetching evicted blocks in batches with %d reader threads", numThreads);
+        m_blockReader = new AntiCacheBlockReader(numThreads);
+    }
+}
+
+/*
+ * Blocks that are still queued in the writer are not counted by their
+ * AntiCacheDB yet. They are written out first if they could fill one of
+ * the databases, or if blocks may be migrated between levels.
+ */
+void AntiCacheEvictionManager::prepareBlockWrite() {
+    if (m_blockWriter == NULL) {
+        return;
+    }
+    int pending = m_blockWriter->getPendingBlocks();
+    if (pending == 0) {
+        return;
+    }
+    bool drain = m_migrate;
+    {
+        AntiCacheBlockWriter::DBLock dbLock(m_blockWriter);
+        for (int i = 0; i < m_numdbs && !drain; i++) {
+            drain = (m_db_lookup[i]->getFreeBlocks() <= pending);
+        }
+    }
+    if (drain) {
+        m_blockWriter->drain();
+    }
+}
+
 AntiCacheDB* AntiCacheEvictionManager::getAntiCacheDB(int acid) {
     if (acid >= m_numdbs) {
         VOLT_ERROR("invalid acid: %d/%d", acid, m_numdbs);
@@ -1600,7 +1802,7 @@ bool AntiCacheEvictionManager::mergeUnevictedTuples(PersistentTable *table) {
     TableTuple evicted_tuple = table->getEvictedTable()->tempTuple();
 
     //int active_tuple_count = (int)table->activeTupleCount();
-#ifndef ANTICACHE_TIMESTAMPS
+#if !defined(ANTICACHE_TIMESTAMPS) && !defined(ANTICACHE_CLOCK)
     //int tuples_in_eviction_chain = (int)table->getNumTuplesInEvictionChain();
 #endif
 
@@ -1646,6 +1848,7 @@ bool AntiCacheEvictionManager::mergeUnevictedTuples(PersistentTable *table) {
                 int64_t current_unevicted = tableInBlock->unevictTuple(&in, merge_tuple_offset, merge_tuple_offset, (bool)table->mergeStrategy());
                 bytes_unevicted += current_unevicted;
                 if (current_unevicted == 0) {
+                    AntiCacheBlockWriter::DBLock dbLock(m_blockWriter);
                     antiCacheDB->removeSingleTupleStats(_block_id, -1);
                     //printf("Add back: %u %u\n", ACID, _block_id);
                 }
@@ -1738,7 +1941,7 @@ bool AntiCacheEvictionManager::mergeUnevictedTuples(PersistentTable *table) {
     VOLT_DEBUG("unevicted blocks size %d", static_cast<int>(table->unevictedBlocksSize()));
 
     //VOLT_ERROR("Active Tuple Count: %d -- %d", (int)active_tuple_count, (int)table->activeTupleCount());
-#ifndef ANTICACHE_TIMESTAMPS
+#if !defined(ANTICACHE_TIMESTAMPS) && !defined(ANTICACHE_CLOCK)
     VOLT_INFO("Tuples in Eviction Chain: %d -- %d", (int)tuples_in_eviction_chain, (int)table->getNumTuplesInEvictionChain());
 #endif
 
@@ -1932,8 +2135,7 @@ bool AntiCacheEvictionManager::blockingMerge() {
     return false;
 }     
 
-#ifndef ANTICACHE_TIMESTAMPS
-
+#if !defined(ANTICACHE_TIMESTAMPS) && !defined(ANTICACHE_CLOCK)
 // -----------------------------------------
 // Debugging Unility Methods
 // -----------------------------------------
@@ -47,6 +47,8 @@ namespace voltdb {
 class Table;
 class PersistentTable;
 class EvictionIterator;    
+class AntiCacheBlockWriter;
+class AntiCacheBlockReader;
     
 class AntiCacheEvictionManager {
         
@@ -65,6 +67,7 @@ public:
     // Table* readBlocks(PersistentTable *table, int numBlocks, int16_t blockIds[], int32_t tuple_offsets[]);
     bool mergeUnevictedTuples(PersistentTable *table);
     bool readEvictedBlock(PersistentTable *table, int32_t block_id, int32_t tuple_offset);
+    bool readEvictedBlocks(PersistentTable *table, int numBlocks, int32_t blockIds[], int32_t tupleOffsets[]);
     //int numTuplesInEvictionList(); 
 
     int chooseDB();
@@ -77,6 +80,24 @@ public:
     int16_t addAntiCacheDB(AntiCacheDB* acdb);
     AntiCacheDB* getAntiCacheDB(int acid);
 
+    /**
+     * Write evicted blocks from a background thread with up to the given
+     * number of blocks queued. Zero writes them on the execution thread.
+     */
+    void setAsyncEviction(int maxPendingBlocks);
+    inline AntiCacheBlockWriter* getBlockWriter() const {
+        return m_blockWriter;
+    }
+
+    /**
+     * Fetch the blocks that a transaction needs in one batch with the given
+     * number of reader threads. Zero reads them one after the other.
+     */
+    void setAsyncUneviction(int numThreads);
+    inline AntiCacheBlockReader* getBlockReader() const {
+        return m_blockReader;
+    }
+
     // -----------------------------------------
     // Evicted Access Tracking Methods
     // -----------------------------------------
@@ -108,7 +129,11 @@ public:
 
 protected:
     void initEvictResultTable();
+    void prepareBlockWrite();
     
+    bool unevictBlock(PersistentTable *table, int32_t block_id, int32_t tuple_offset,
+                      AntiCacheBlock *&fetched, long storedSize);
+
     bool removeTupleSingleLinkedList(PersistentTable* table, uint32_t removal_id);
     bool removeTupleDoubleLinkedList(PersistentTable* table, TableTuple* tuple_to_remove, uint32_t removal_id);
     
@@ -143,6 +168,11 @@ protected:
     // encountering a full AntiCacheDB. As of now, it is set to tru when 
     // m_numdbs > 1;
     bool m_migrate;
+
+    // writes evicted blocks in the background, NULL when eviction is synchronous
+    AntiCacheBlockWriter *m_blockWriter;
+    // fetches the blocks of a transaction in one batch, NULL when they are read one by one
+    AntiCacheBlockReader *m_blockReader;
     //std::map<int16_t, AntiCacheDB*> m_db_lookup_table;
 
 
@@ -49,6 +49,13 @@ vector<string> AntiCacheStats::generateAntiCacheStatsColumnNames() {
     columnNames.push_back("ANTICACHE_BYTES_STORED");
     columnNames.push_back("ANTICACHE_BLOCKS_FREE");
     columnNames.push_back("ANTICACHE_BYTES_FREE");
+
+    columnNames.push_back("ANTICACHE_CODEC");
+    columnNames.push_back("ANTICACHE_CODEC_RAW_BYTES");
+    columnNames.push_back("ANTICACHE_CODEC_STORED_BYTES");
+    columnNames.push_back("ANTICACHE_COMPRESSION_RATIO");
+    columnNames.push_back("ANTICACHE_CODEC_COMPRESS_TIME");
+    columnNames.push_back("ANTICACHE_CODEC_DECOMPRESS_TIME");
     
     return columnNames;
 }
@@ -133,6 +140,36 @@ void AntiCacheStats::populateAntiCacheStatsSchema(
     types.push_back(VALUE_TYPE_BIGINT); 
     columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT)); 
     allowNull.push_back(false);
+
+    //ANTICACHE_CODEC
+    types.push_back(VALUE_TYPE_INTEGER);
+    columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER));
+    allowNull.push_back(false);
+
+    //ANTICACHE_CODEC_RAW_BYTES
+    types.push_back(VALUE_TYPE_BIGINT);
+    columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+    allowNull.push_back(false);
+
+    //ANTICACHE_CODEC_STORED_BYTES
+    types.push_back(VALUE_TYPE_BIGINT);
+    columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+    allowNull.push_back(false);
+
+    //ANTICACHE_COMPRESSION_RATIO
+    types.push_back(VALUE_TYPE_DOUBLE);
+    columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_DOUBLE));
+    allowNull.push_back(false);
+
+    //ANTICACHE_CODEC_COMPRESS_TIME (microseconds)
+    types.push_back(VALUE_TYPE_BIGINT);
+    columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+    allowNull.push_back(false);
+
+    //ANTICACHE_CODEC_DECOMPRESS_TIME (microseconds)
+    types.push_back(VALUE_TYPE_BIGINT);
+    columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+    allowNull.push_back(false);
 }
 
 Table*
@@ -297,6 +334,28 @@ void AntiCacheStats::updateStatsTuple(TableTuple *tuple) {
     tuple->setNValue(
             StatsSource::m_columnName2Index["ANTICACHE_BYTES_FREE"],
             ValueFactory::getBigIntValue(m_currentFreeBytes));
+
+    int64_t codecRawBytes = acdb->getCodecRawBytes();
+    int64_t codecStoredBytes = acdb->getCodecStoredBytes();
+    tuple->setNValue(
+            StatsSource::m_columnName2Index["ANTICACHE_CODEC"],
+            ValueFactory::getIntegerValue(acdb->getCodec()));
+    tuple->setNValue(
+            StatsSource::m_columnName2Index["ANTICACHE_CODEC_RAW_BYTES"],
+            ValueFactory::getBigIntValue(codecRawBytes));
+    tuple->setNValue(
+            StatsSource::m_columnName2Index["ANTICACHE_CODEC_STORED_BYTES"],
+            ValueFactory::getBigIntValue(codecStoredBytes));
+    tuple->setNValue(
+            StatsSource::m_columnName2Index["ANTICACHE_COMPRESSION_RATIO"],
+            ValueFactory::getDoubleValue(codecStoredBytes > 0 ?
+                                         (double)codecRawBytes / (double)codecStoredBytes : 1.0));
+    tuple->setNValue(
+            StatsSource::m_columnName2Index["ANTICACHE_CODEC_COMPRESS_TIME"],
+            ValueFactory::getBigIntValue(acdb->getCodecCompressTime()));
+    tuple->setNValue(
+            StatsSource::m_columnName2Index["ANTICACHE_CODEC_DECOMPRESS_TIME"],
+            ValueFactory::getBigIntValue(acdb->getCodecDecompressTime()));
 }
 
 /**
@@ -83,9 +83,10 @@ void BerkeleyAntiCacheDB::initializeDB() {
         m_dbEnv = new DbEnv(0); 
         m_dbEnv->open(m_dbDir.c_str(), env_flags, 0); 
         VOLT_INFO("created BerkeleyDB: %s\n", m_dbDir.c_str());
-        // allocate and initialize new Berkeley DB instance
+        // allocate and initialize new Berkeley DB instance, free-threaded
+        // for the reader threads that fetch the blocks of a batch
         m_db = new Db(m_dbEnv, 0); 
-        m_db->open(NULL, ANTICACHE_DB_NAME, NULL, DB_HASH, DB_CREATE, 0); 
+        m_db->open(NULL, ANTICACHE_DB_NAME, NULL, DB_HASH, DB_CREATE | DB_THREAD, 0); 
 
     } catch (DbException &e) {
         VOLT_ERROR("Anti-Cache initialization error: %s", e.what());
@@ -123,14 +124,14 @@ BerkeleyAntiCacheDB::~BerkeleyAntiCacheDB() {
     shutdownDB();
 }
 
-void BerkeleyAntiCacheDB::writeBlock(const std::string tableName,
+void BerkeleyAntiCacheDB::storeBlock(const std::string tableName,
                              uint32_t blockId,
                              const int tupleCount,
                              const char* data,
                              const long size,
                              const int evictedTupleCount) {
 
-    //VOLT_ERROR("In BerkeleyDB:writeBlock");
+    //VOLT_ERROR("In BerkeleyDB:storeBlock");
 
     Dbt key;
     key.set_data(&blockId);
@@ -192,7 +193,7 @@ bool BerkeleyAntiCacheDB::validateBlock(uint32_t blockId) {
     return m_blockSet.find(blockId) != m_blockSet.end();
 }
 
-AntiCacheBlock* BerkeleyAntiCacheDB::readBlock(uint32_t blockId, bool isMigrate) {
+AntiCacheBlock* BerkeleyAntiCacheDB::loadBlock(uint32_t blockId) {
     Dbt key;
     key.set_data(&blockId);
     key.set_size(sizeof(blockId));
@@ -215,22 +216,28 @@ AntiCacheBlock* BerkeleyAntiCacheDB::readBlock(uint32_t blockId, bool isMigrate)
         assert(value.get_data() != NULL);
     }
     
-    AntiCacheBlock* block = new BerkeleyAntiCacheBlock(blockId, value);
-    
+    // the handle is opened with DB_THREAD and every get mallocs its own value,
+    // so the reader threads can fetch the blocks of a batch concurrently. No
+    // put runs meanwhile: the execution thread waits for the batch while
+    // holding the DB lock of the block writer.
+    return new BerkeleyAntiCacheBlock(blockId, value);
+}
+
+void BerkeleyAntiCacheDB::unevictBlock(uint32_t blockId, long storedSize, bool isMigrate) {
     m_blocksUnevicted++;
     if (isBlockMerge()) {
-        m_bytesUnevicted += static_cast<int32_t>( block->getSize());
+        m_bytesUnevicted += static_cast<int32_t>(storedSize);
         removeBlockLRU(blockId);
         m_blockSet.erase(blockId);
     } else {
         if (isMigrate) {
-            m_bytesUnevicted += static_cast<int32_t>((int64_t)block->getSize() - block->getSize() / tupleInBlock[blockId] *
+            m_bytesUnevicted += static_cast<int32_t>((int64_t)storedSize - storedSize / tupleInBlock[blockId] *
                     (tupleInBlock[blockId] - evictedTupleInBlock[blockId]));
             removeBlockLRU(blockId);
             m_blockSet.erase(blockId);
         }
         else {
-            m_bytesUnevicted += static_cast<int32_t>( block->getSize() / tupleInBlock[blockId]);
+            m_bytesUnevicted += static_cast<int32_t>(storedSize / tupleInBlock[blockId]);
             evictedTupleInBlock[blockId]--;
             m_blocksUnevicted--;
             if (rand() % 100 == 0) {
@@ -245,7 +252,6 @@ AntiCacheBlock* BerkeleyAntiCacheDB::readBlock(uint32_t blockId, bool isMigrate)
         VOLT_ERROR("LRU rm_block id: %d  and blockId %d not equal!", rm_block, blockId);
     }
  */
-    return (block);
 }
 
 void BerkeleyAntiCacheDB::flushBlocks() {
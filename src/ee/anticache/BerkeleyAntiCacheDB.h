@@ -88,20 +88,24 @@ class BerkeleyAntiCacheDB : public AntiCacheDB {
         }
         void initializeDB();
 
-        AntiCacheBlock* readBlock(uint32_t blockId, bool isMigrate);
-
         void shutdownDB();
 
         void flushBlocks();
 
-        void writeBlock(const std::string tableName,
+
+        bool validateBlock(uint32_t blockID);
+
+        void unevictBlock(uint32_t blockId, long storedSize, bool isMigrate);
+
+    protected:
+        void storeBlock(const std::string tableName,
                         uint32_t blockID,
                         const int tupleCount,
                         const char* data,
                         const long size,
                         const int evictedTupleCount);
 
-        bool validateBlock(uint32_t blockID);
+        AntiCacheBlock* loadBlock(uint32_t blockId);
 
     private:
         DbEnv* m_dbEnv;
@@ -48,6 +48,9 @@ class EvictedTable : public PersistentTable {
     protected:
         
         EvictedTable(ExecutorContext *ctx);
+
+        // the indexes of the evicted tables' parents point at these tuples
+        bool canCompact() const { return false; }
     
     };
 }
@@ -46,6 +46,8 @@
 
 #include "anticache/EvictionIterator.h"
 #include "storage/persistenttable.h"
+#include <algorithm>
+#include <vector>
 
 // that's the factor indicate how many times the number of the tuple we'll sample comparing to we request
 #define RANDOM_SCALE 4
@@ -67,8 +69,92 @@ EvictionIterator::EvictionIterator(Table *t)
     current_tuple_id = 0;
     current_tuple = new TableTuple(table->schema());
     is_first = true; 
+#if defined(ANTICACHE_TIMESTAMPS) || defined(ANTICACHE_CLOCK)
+    candidates = NULL;
+    m_size = 0;
+#endif
 }
 
+#ifdef ANTICACHE_CLOCK
+/**
+ * Sweep the clock hand of the table over its blocks until enough tuples are
+ * picked for an eviction of the given amount of bytes. A tuple whose reference
+ * bit is set gets a second chance: the bit is cleared and the hand moves on.
+ * If a whole revolution does not find enough tuples, the second chance tuples
+ * are taken in the order the hand passed them.
+ */
+void EvictionIterator::reserve(int64_t amount) {
+    VOLT_DEBUG("amount: %ld\n", amount);
+
+    PersistentTable* ptable = static_cast<PersistentTable*>(table);
+    int tuple_size = ptable->m_schema->tupleLength() + TUPLE_HEADER_SIZE;
+    int active_tuple = (int)ptable->activeTupleCount();
+    int evict_num = 0;
+    uint32_t used_tuple = static_cast<uint32_t>(ptable->usedTupleCount());
+    uint32_t block_size = ptable->m_tuplesPerBlock;
+
+    if (active_tuple)
+        evict_num = (int)(amount / (tuple_size + ptable->nonInlinedMemorySize() / active_tuple));
+    else
+        evict_num = (int)(amount / tuple_size);
+
+    if (evict_num > active_tuple)
+        evict_num = active_tuple;
+
+    m_size = 0;
+    current_tuple_id = 0;
+    candidates = new EvictionTuple[evict_num];
+    std::vector<char*> second_chance;
+
+    uint32_t start = ptable->m_clockHand < used_tuple ? ptable->m_clockHand : 0;
+    uint32_t pos = start;
+    bool wrapped = false;
+    while (m_size < evict_num) {
+        uint32_t end = wrapped ? start : used_tuple;
+        if (pos >= end) {
+            if (wrapped)
+                break;
+            wrapped = true;
+            pos = 0;
+            continue;
+        }
+
+        // skip the free slots of the block with its occupancy bits
+        uint32_t block = pos / block_size;
+        uint32_t block_end = std::min((block + 1) * block_size, end);
+        uint32_t slot = ptable->nextOccupiedSlot(block, pos % block_size);
+        if (block * block_size + slot >= block_end) {
+            pos = block_end;
+            continue;
+        }
+        pos = block * block_size + slot + 1;
+
+        char *addr = ptable->m_data[block] + slot * tuple_size;
+        current_tuple->move(addr);
+        if (!current_tuple->isActive() || current_tuple->isEvicted())
+            continue;
+
+        if (current_tuple->isReferenced()) {
+            current_tuple->setReferencedFalse();
+            if ((int)second_chance.size() < evict_num)
+                second_chance.push_back(addr);
+            continue;
+        }
+        candidates[m_size].setTuple(0, addr);
+        m_size++;
+    }
+    ptable->m_clockHand = pos;
+
+    for (size_t i = 0; i < second_chance.size() && m_size < evict_num; i++) {
+        candidates[m_size].setTuple(0, second_chance[i]);
+        m_size++;
+    }
+
+    VOLT_INFO("CLOCK picked %d of %d tuples to evict [second chance=%lu]",
+              m_size, evict_num, (long unsigned int)second_chance.size());
+}
+#endif
+
 #ifdef ANTICACHE_TIMESTAMPS
 /**
  * Reserve some tuples when an eviction requested.
@@ -200,7 +286,10 @@ void EvictionIterator::reserve(int64_t amount) {
                 location_size = (int)(used_tuple - block_location * block_size);
             else
                 location_size = block_size;
-            addr += (rand() % location_size) * tuple_size;
+            int slot = rand() % location_size;
+            if (ptable->nextOccupiedSlot(block_location, slot) != static_cast<uint32_t>(slot))
+                continue;
+            addr += slot * tuple_size;
 
             current_tuple->move(addr);
 
@@ -221,20 +310,21 @@ void EvictionIterator::reserve(int64_t amount) {
                 location_size = (int)(ptable->usedTupleCount() - i * block_size);
             else
                 location_size = block_size;
-            for (int j = 0; j < location_size; j++) {
-                current_tuple->move(addr);
+            // only the slots whose occupancy bit is set can hold a tuple
+            for (uint32_t j = ptable->nextOccupiedSlot(i, 0);
+                 j < static_cast<uint32_t>(location_size);
+                 j = ptable->nextOccupiedSlot(i, j + 1)) {
+                char *current_addr = addr + j * tuple_size;
+                current_tuple->move(current_addr);
 
                 if (!current_tuple->isActive() || current_tuple->isEvicted()) {
-                    addr += tuple_size;
                     continue;
                 }
 
-                VOLT_TRACE("Flip addr: %p\n", addr);
+                VOLT_TRACE("Flip addr: %p\n", current_addr);
 
-                candidates[m_size].setTuple(current_tuple->getTimeStamp(), addr);
+                candidates[m_size].setTuple(current_tuple->getTimeStamp(), current_addr);
                 m_size++;
-
-                addr += tuple_size;
             }
         }
     }
@@ -247,7 +337,7 @@ void EvictionIterator::reserve(int64_t amount) {
 
 EvictionIterator::~EvictionIterator()
 {
-#ifdef ANTICACHE_TIMESTAMPS
+#if defined(ANTICACHE_TIMESTAMPS) || defined(ANTICACHE_CLOCK)
     delete[] candidates;
 #endif
     delete current_tuple;
@@ -263,7 +353,7 @@ bool EvictionIterator::hasNext()
     if(ptable->usedTupleCount() == 0)
         return false; 
 
-#ifndef ANTICACHE_TIMESTAMPS
+#if !defined(ANTICACHE_TIMESTAMPS) && !defined(ANTICACHE_CLOCK)
     if(current_tuple_id == ptable->getNewestTupleID())
         return false;
     if(ptable->getNumTuplesInEvictionChain() == 0) { // there are no tuples in the chain
@@ -280,7 +370,7 @@ bool EvictionIterator::hasNext()
 
 bool EvictionIterator::next(TableTuple &tuple)
 {    
-#ifndef ANTICACHE_TIMESTAMPS
+#if !defined(ANTICACHE_TIMESTAMPS) && !defined(ANTICACHE_CLOCK)
     PersistentTable* ptable = static_cast<PersistentTable*>(table);
 
     if(current_tuple_id == ptable->getNewestTupleID()) // we've already returned the last tuple in the chain
@@ -311,6 +401,10 @@ bool EvictionIterator::next(TableTuple &tuple)
     tuple.move(current_tuple->address()); 
 
     VOLT_DEBUG("current_tuple_id = %d", current_tuple_id);
+#elif defined(ANTICACHE_CLOCK)
+    // the sweep passes every slot once, so there are no duplicates
+    tuple.move(candidates[current_tuple_id].m_addr);
+    current_tuple_id++;
 #else
     tuple.move(candidates[current_tuple_id].m_addr);
     current_tuple_id++;
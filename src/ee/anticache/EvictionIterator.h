@@ -63,7 +63,7 @@ public:
     
     bool hasNext(); 
     bool next(TableTuple &out);
-#ifdef ANTICACHE_TIMESTAMPS
+#if defined(ANTICACHE_TIMESTAMPS) || defined(ANTICACHE_CLOCK)
     void reserve(int64_t amount);
 #endif
 
@@ -90,7 +90,7 @@ private:
     uint32_t current_tuple_id;
     TableTuple* current_tuple;
     bool is_first; 
-#ifdef ANTICACHE_TIMESTAMPS
+#if defined(ANTICACHE_TIMESTAMPS) || defined(ANTICACHE_CLOCK)
     EvictionTuple *candidates;
     int32_t m_size;
 #endif
@@ -0,0 +1,590 @@
+/* Copyright (C) 2014 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "anticache/LogAntiCacheDB.h"
+#include "anticache/UnknownBlockAccessException.h"
+#include "anticache/FullBackingStoreException.h"
+#include "common/debuglog.h"
+#include "common/FatalException.hpp"
+#include "common/executorcontext.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <sstream>
+#include <vector>
+
+using namespace std;
+
+namespace voltdb {
+
+static const uint32_t LOG_RECORD_MAGIC = 0x4c4f4742;
+
+LogAntiCacheBlock::LogAntiCacheBlock(uint32_t blockId, const std::string &tableName, char* data, long size) :
+    AntiCacheBlock(blockId) {
+
+    m_block = data;
+
+    payload p;
+    p.tableName = tableName;
+    p.blockId = blockId;
+    p.data = m_block;
+    p.size = size;
+
+    m_payload = p;
+    m_size = static_cast<int32_t>(size);
+    m_blockType = ANTICACHEDB_LOG;
+
+    VOLT_INFO("LogAntiCacheBlock #%u from table: %s [size=%d / payload=%ld]",
+              blockId, m_payload.tableName.c_str(), m_size, m_payload.size);
+}
+
+LogAntiCacheBlock::~LogAntiCacheBlock() {
+    delete [] m_block;
+}
+
+char* LogAntiCacheBlock::releaseData() {
+    char *data = m_block;
+    m_block = NULL;
+    return data;
+}
+
+LogAntiCacheDB::LogAntiCacheDB(ExecutorContext *ctx, std::string db_dir, long blockSize, long maxSize) :
+    AntiCacheDB(ctx, db_dir, blockSize, maxSize),
+    m_directIO(true),
+    m_nextSegmentId(0),
+    m_activeSegment(NULL),
+    m_logBytes(0),
+    m_buffer(NULL),
+    m_bufferCapacity(0),
+    m_bufferUsed(0),
+    m_bufferOffset(0),
+    m_segmentsCompacted(0),
+    m_bytesCompacted(0),
+    m_compactionRequested(false),
+    m_shutdown(false) {
+
+    m_dbType = ANTICACHEDB_LOG;
+    pthread_mutex_init(&m_lock, NULL);
+    pthread_cond_init(&m_compact, NULL);
+    initializeDB();
+}
+
+LogAntiCacheDB::~LogAntiCacheDB() {
+    shutdownDB();
+    pthread_cond_destroy(&m_compact);
+    pthread_mutex_destroy(&m_lock);
+}
+
+void LogAntiCacheDB::initializeDB() {
+    int partition_id;
+    // if there is no executor context, assume this is a test and let it go
+    if (!m_executorContext) {
+        VOLT_WARN("LogAntiCacheDB has no executor context. If this is an EE test, don't worry\n");
+        partition_id = 0;
+    } else {
+        partition_id = (int)m_executorContext->getPartitionId();
+    }
+    std::ostringstream prefix;
+    prefix << m_dbDir << "/anticache-log-" << partition_id << "-";
+    m_segmentPrefix = prefix.str();
+
+    // a segment holds a sixteenth of the database, but at least a few full blocks
+    long recordSize = alignedSize((long)sizeof(RecordHeader) + m_blockSize + 256);
+    m_segmentSize = m_maxDBSize / 16;
+    if (m_segmentSize > MAX_SEGMENT_SIZE) {
+        m_segmentSize = MAX_SEGMENT_SIZE;
+    }
+    if (m_segmentSize < 4 * recordSize) {
+        m_segmentSize = 4 * recordSize;
+    }
+    m_segmentSize = alignedSize(m_segmentSize);
+
+    pthread_mutex_lock(&m_lock);
+    reserveBuffer(LOG_WRITE_SIZE);
+    m_activeSegment = openSegment();
+    pthread_mutex_unlock(&m_lock);
+    VOLT_INFO("Created log anti-cache database %s* [segmentSize=%ld / directIO=%d]",
+              m_segmentPrefix.c_str(), m_segmentSize, (int)m_directIO);
+
+    if (pthread_create(&m_compactor, NULL, LogAntiCacheDB::run, this) != 0) {
+        throwFatalException("Failed to start the compaction thread of anti-cache database %s",
+                            m_dbDir.c_str());
+    }
+}
+
+void LogAntiCacheDB::shutdownDB() {
+    pthread_mutex_lock(&m_lock);
+    if (m_shutdown) {
+        pthread_mutex_unlock(&m_lock);
+        return;
+    }
+    m_shutdown = true;
+    pthread_cond_signal(&m_compact);
+    pthread_mutex_unlock(&m_lock);
+    pthread_join(m_compactor, NULL);
+
+    // the blocks do not outlive the EE, so the segments are removed
+    pthread_mutex_lock(&m_lock);
+    while (!m_segments.empty()) {
+        deleteSegment(m_segments.begin()->second);
+    }
+    m_activeSegment = NULL;
+    m_blockMap.clear();
+    free(m_buffer);
+    m_buffer = NULL;
+    pthread_mutex_unlock(&m_lock);
+}
+
+LogAntiCacheDB::Segment* LogAntiCacheDB::openSegment() {
+    std::ostringstream path;
+    path << m_segmentPrefix << m_nextSegmentId;
+
+    int flags = O_RDWR | O_CREAT | O_TRUNC;
+    int fd = -1;
+    if (m_directIO) {
+        fd = open(path.str().c_str(), flags | O_DIRECT, 0644);
+        if (fd < 0 && errno == EINVAL) {
+            // e.g. tmpfs does not support O_DIRECT
+            VOLT_WARN("O_DIRECT is not supported for %s, using buffered I/O", path.str().c_str());
+            m_directIO = false;
+        }
+    }
+    if (!m_directIO) {
+        fd = open(path.str().c_str(), flags, 0644);
+    }
+    if (fd < 0) {
+        VOLT_ERROR("Failed to open anti-cache log segment %s: %s", path.str().c_str(), strerror(errno));
+        throwFatalException("Failed to open anti-cache log segment %s: %s", path.str().c_str(), strerror(errno));
+    }
+
+    Segment *segment = new Segment();
+    segment->id = m_nextSegmentId++;
+    segment->fd = fd;
+    segment->path = path.str();
+    segment->written = 0;
+    segment->liveBytes = 0;
+    segment->readers = 0;
+    segment->sealed = false;
+    m_segments[segment->id] = segment;
+    VOLT_DEBUG("Opened anti-cache log segment %s", segment->path.c_str());
+    return segment;
+}
+
+void LogAntiCacheDB::deleteSegment(Segment *segment) {
+    VOLT_DEBUG("Deleting anti-cache log segment %s [written=%ld]", segment->path.c_str(), segment->written);
+    close(segment->fd);
+    unlink(segment->path.c_str());
+    m_logBytes -= segment->written;
+    m_segments.erase(segment->id);
+    delete segment;
+}
+
+void LogAntiCacheDB::reserveBuffer(long size) {
+    if (size <= m_bufferCapacity) {
+        return;
+    }
+    void *buffer;
+    if (posix_memalign(&buffer, LOG_ALIGNMENT, size) != 0) {
+        throwFatalException("Failed to allocate a %ld byte anti-cache log buffer", size);
+    }
+    if (m_bufferUsed > 0) {
+        memcpy(buffer, m_buffer, m_bufferUsed);
+    }
+    free(m_buffer);
+    m_buffer = static_cast<char*>(buffer);
+    m_bufferCapacity = size;
+}
+
+void LogAntiCacheDB::flushBuffer() {
+    long written = 0;
+    while (written < m_bufferUsed) {
+        ssize_t ret = pwrite(m_activeSegment->fd, m_buffer + written, m_bufferUsed - written,
+                             m_bufferOffset + written);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            VOLT_ERROR("Failed to write anti-cache log segment %s: %s",
+                       m_activeSegment->path.c_str(), strerror(errno));
+            throwFatalException("Failed to write anti-cache log segment %s: %s",
+                                m_activeSegment->path.c_str(), strerror(errno));
+        }
+        written += ret;
+    }
+    m_bufferOffset += m_bufferUsed;
+    m_bufferUsed = 0;
+}
+
+LogAntiCacheDB::Location LogAntiCacheDB::appendRecord(const char *record, long recordSize) {
+    // a full segment is sealed, and the log goes on in a new one
+    if (m_activeSegment->written > 0 && m_activeSegment->written + recordSize > m_segmentSize) {
+        flushBuffer();
+        if (fdatasync(m_activeSegment->fd) != 0) {
+            VOLT_WARN("Failed to sync anti-cache log segment %s: %s",
+                      m_activeSegment->path.c_str(), strerror(errno));
+        }
+        m_activeSegment->sealed = true;
+        m_activeSegment = openSegment();
+        m_bufferOffset = 0;
+    }
+    if (m_bufferUsed + recordSize > m_bufferCapacity) {
+        flushBuffer();
+        reserveBuffer(recordSize);
+    }
+    memcpy(m_buffer + m_bufferUsed, record, recordSize);
+    m_bufferUsed += recordSize;
+
+    Location location;
+    location.segment = m_activeSegment;
+    location.offset = m_activeSegment->written;
+    location.recordSize = recordSize;
+    m_activeSegment->written += recordSize;
+    m_activeSegment->liveBytes += recordSize;
+    m_logBytes += recordSize;
+    return location;
+}
+
+char* LogAntiCacheDB::readRecord(Segment *segment, long offset, long recordSize) {
+    void *record;
+    if (posix_memalign(&record, LOG_ALIGNMENT, recordSize) != 0) {
+        throwFatalException("Failed to allocate a %ld byte anti-cache log record", recordSize);
+    }
+    long done = 0;
+    while (done < recordSize) {
+        ssize_t ret = pread(segment->fd, static_cast<char*>(record) + done, recordSize - done, offset + done);
+        if (ret <= 0) {
+            if (ret < 0 && errno == EINTR) {
+                continue;
+            }
+            free(record);
+            throwFatalException("Failed to read %ld bytes at %ld of anti-cache log segment %s: %s",
+                                recordSize, offset, segment->path.c_str(),
+                                ret < 0 ? strerror(errno) : "end of file");
+        }
+        done += ret;
+    }
+    return static_cast<char*>(record);
+}
+
+void LogAntiCacheDB::storeBlock(const std::string tableName,
+                                uint32_t blockId,
+                                const int tupleCount,
+                                const char* data,
+                                const long size,
+                                const int evictedTupleCount) {
+
+    RecordHeader header;
+    header.magic = LOG_RECORD_MAGIC;
+    header.blockId = blockId;
+    header.tableNameSize = static_cast<int32_t>(tableName.size());
+    header.dataSize = static_cast<int32_t>(size);
+    long recordSize = alignedSize((long)sizeof(header) + (long)tableName.size() + size);
+
+    if (getLogBytes() + recordSize > m_maxDBSize) {
+        // dead space may be all that is in the way
+        compactSegments();
+        if (getLogBytes() + recordSize > m_maxDBSize) {
+            VOLT_WARN("No free space in ACID %d for blockid %u with blocksize %ld",
+                    m_ACID, blockId, size);
+            throw FullBackingStoreException(((int32_t)m_ACID << 16) & blockId, 0);
+        }
+    }
+
+    char *record = new char[recordSize];
+    memcpy(record, &header, sizeof(header));
+    memcpy(record + sizeof(header), tableName.data(), tableName.size());
+    memcpy(record + sizeof(header) + tableName.size(), data, size);
+    long used = (long)sizeof(header) + (long)tableName.size() + size;
+    memset(record + used, 0, recordSize - used);
+
+    pthread_mutex_lock(&m_lock);
+    try {
+        Location location = appendRecord(record, recordSize);
+        location.segment->blockIds.insert(blockId);
+        m_blockMap[blockId] = location;
+    } catch (...) {
+        pthread_mutex_unlock(&m_lock);
+        delete [] record;
+        throw;
+    }
+    pthread_mutex_unlock(&m_lock);
+    delete [] record;
+
+    VOLT_DEBUG("Writing out a block #%u to the anti-cache log [tuples=%d / size=%ld]",
+               blockId, tupleCount, size);
+
+    tupleInBlock[blockId] = tupleCount;
+    evictedTupleInBlock[blockId] = evictedTupleCount;
+    blockSize[blockId] = size;
+    m_blocksEvicted++;
+    if (!isBlockMerge()) {
+        m_bytesEvicted += static_cast<int32_t>((int64_t)size * evictedTupleCount / tupleCount);
+    }
+    else {
+        m_bytesEvicted += static_cast<int32_t>(size);
+    }
+    pushBlockLRU(blockId);
+}
+
+bool LogAntiCacheDB::validateBlock(uint32_t blockId) {
+    pthread_mutex_lock(&m_lock);
+    bool valid = m_blockMap.find(blockId) != m_blockMap.end();
+    pthread_mutex_unlock(&m_lock);
+    return valid;
+}
+
+AntiCacheBlock* LogAntiCacheDB::loadBlock(uint32_t blockId) {
+    pthread_mutex_lock(&m_lock);
+    std::map<uint32_t, Location>::const_iterator itr = m_blockMap.find(blockId);
+    if (itr == m_blockMap.end()) {
+        pthread_mutex_unlock(&m_lock);
+        VOLT_ERROR("Invalid anti-cache blockId '%u'", blockId);
+        throw UnknownBlockAccessException(blockId);
+    }
+    Location location = itr->second;
+
+    char *record;
+    if (location.segment == m_activeSegment && location.offset >= m_bufferOffset) {
+        // the block has not been written out yet
+        record = new char[location.recordSize];
+        memcpy(record, m_buffer + (location.offset - m_bufferOffset), location.recordSize);
+        pthread_mutex_unlock(&m_lock);
+    } else {
+        location.segment->readers++;
+        pthread_mutex_unlock(&m_lock);
+        char *aligned = NULL;
+        try {
+            aligned = readRecord(location.segment, location.offset, location.recordSize);
+        } catch (...) {
+            pthread_mutex_lock(&m_lock);
+            location.segment->readers--;
+            pthread_mutex_unlock(&m_lock);
+            throw;
+        }
+        pthread_mutex_lock(&m_lock);
+        location.segment->readers--;
+        pthread_mutex_unlock(&m_lock);
+        record = new char[location.recordSize];
+        memcpy(record, aligned, location.recordSize);
+        free(aligned);
+    }
+
+    RecordHeader header;
+    memcpy(&header, record, sizeof(header));
+    if (header.magic != LOG_RECORD_MAGIC || header.blockId != blockId || header.tableNameSize < 0 ||
+        header.dataSize < 0 || (long)sizeof(header) + header.tableNameSize + header.dataSize > location.recordSize) {
+        delete [] record;
+        throwFatalException("Corrupt record for block %u in the anti-cache log", blockId);
+    }
+    std::string tableName(record + sizeof(header), header.tableNameSize);
+    char *data = new char[header.dataSize];
+    memcpy(data, record + sizeof(header) + header.tableNameSize, header.dataSize);
+    delete [] record;
+
+    VOLT_DEBUG("Reading log block: ID = %u, segment = %d, offset = %ld, size = %d",
+               blockId, location.segment->id, location.offset, header.dataSize);
+    return new LogAntiCacheBlock(blockId, tableName, data, header.dataSize);
+}
+
+void LogAntiCacheDB::unevictBlock(uint32_t blockId, long storedSize, bool isMigrate) {
+    bool remove = isBlockMerge() || isMigrate;
+    m_blocksUnevicted++;
+    if (isBlockMerge()) {
+        m_bytesUnevicted += static_cast<int32_t>(storedSize);
+        removeBlockLRU(blockId);
+    } else {
+        if (isMigrate) {
+            m_bytesUnevicted += static_cast<int32_t>((int64_t)storedSize - storedSize / tupleInBlock[blockId] *
+                    (tupleInBlock[blockId] - evictedTupleInBlock[blockId]));
+            removeBlockLRU(blockId);
+        }
+        else {
+            m_bytesUnevicted += static_cast<int32_t>(storedSize / tupleInBlock[blockId]);
+            evictedTupleInBlock[blockId]--;
+            m_blocksUnevicted--;
+            if (rand() % 100 == 0) {
+                removeBlockLRU(blockId);
+                pushBlockLRU(blockId); // update block LRU
+            }
+        }
+    }
+    if (!remove) {
+        return;
+    }
+
+    // the record becomes dead space, to be reclaimed with its segment
+    pthread_mutex_lock(&m_lock);
+    std::map<uint32_t, Location>::iterator itr = m_blockMap.find(blockId);
+    if (itr != m_blockMap.end()) {
+        Segment *segment = itr->second.segment;
+        segment->liveBytes -= itr->second.recordSize;
+        segment->blockIds.erase(blockId);
+        m_blockMap.erase(itr);
+        if (segment->sealed && segment->liveBytes * 2 < segment->written) {
+            m_compactionRequested = true;
+            pthread_cond_signal(&m_compact);
+        }
+    }
+    pthread_mutex_unlock(&m_lock);
+}
+
+void LogAntiCacheDB::flushBlocks() {
+    pthread_mutex_lock(&m_lock);
+    try {
+        flushBuffer();
+    } catch (...) {
+        pthread_mutex_unlock(&m_lock);
+        throw;
+    }
+    if (fdatasync(m_activeSegment->fd) != 0) {
+        VOLT_WARN("Failed to sync anti-cache log segment %s: %s",
+                  m_activeSegment->path.c_str(), strerror(errno));
+    }
+    pthread_mutex_unlock(&m_lock);
+}
+
+int LogAntiCacheDB::compactSegments() {
+    int reclaimed = 0;
+    pthread_mutex_lock(&m_lock);
+    try {
+        std::vector<int> victims;
+        for (std::map<int, Segment*>::iterator it = m_segments.begin(); it != m_segments.end(); ++it) {
+            if (it->second->sealed && it->second->liveBytes * 2 < it->second->written) {
+                victims.push_back(it->first);
+            }
+        }
+
+        for (size_t i = 0; i < victims.size(); i++) {
+            // another compaction may have deleted it while the lock was released
+            std::map<int, Segment*>::iterator found = m_segments.find(victims[i]);
+            if (found == m_segments.end()) {
+                continue;
+            }
+            Segment *victim = found->second;
+            std::vector<std::pair<uint32_t, Location> > live;
+            for (std::set<uint32_t>::iterator it = victim->blockIds.begin(); it != victim->blockIds.end(); ++it) {
+                live.push_back(std::make_pair(*it, m_blockMap[*it]));
+            }
+
+            // the live records are read without the lock, the segment stays as long as it is read
+            std::vector<char*> records(live.size(), (char*)NULL);
+            victim->readers++;
+            pthread_mutex_unlock(&m_lock);
+            try {
+                for (size_t j = 0; j < live.size(); j++) {
+                    records[j] = readRecord(victim, live[j].second.offset, live[j].second.recordSize);
+                }
+            } catch (...) {
+                for (size_t j = 0; j < records.size(); j++) {
+                    free(records[j]);
+                }
+                pthread_mutex_lock(&m_lock);
+                victim->readers--;
+                throw;
+            }
+            pthread_mutex_lock(&m_lock);
+            victim->readers--;
+
+            for (size_t j = 0; j < live.size(); j++) {
+                std::map<uint32_t, Location>::iterator itr = m_blockMap.find(live[j].first);
+                // skip blocks that were unevicted in the meantime
+                if (itr != m_blockMap.end() && itr->second.segment == victim &&
+                    itr->second.offset == live[j].second.offset) {
+                    Location location = appendRecord(records[j], live[j].second.recordSize);
+                    location.segment->blockIds.insert(live[j].first);
+                    victim->blockIds.erase(live[j].first);
+                    victim->liveBytes -= live[j].second.recordSize;
+                    itr->second = location;
+                    m_bytesCompacted += location.recordSize;
+                }
+                free(records[j]);
+            }
+
+            if (victim->blockIds.empty() && victim->readers == 0) {
+                deleteSegment(victim);
+                m_segmentsCompacted++;
+                reclaimed++;
+            }
+        }
+        if (reclaimed > 0) {
+            flushBuffer();
+        }
+    } catch (...) {
+        pthread_mutex_unlock(&m_lock);
+        throw;
+    }
+    pthread_mutex_unlock(&m_lock);
+
+    if (reclaimed > 0) {
+        VOLT_DEBUG("Compacted %d anti-cache log segments", reclaimed);
+    }
+    return reclaimed;
+}
+
+int LogAntiCacheDB::getNumSegments() {
+    pthread_mutex_lock(&m_lock);
+    int segments = (int)m_segments.size();
+    pthread_mutex_unlock(&m_lock);
+    return segments;
+}
+
+int64_t LogAntiCacheDB::getLogBytes() {
+    pthread_mutex_lock(&m_lock);
+    int64_t bytes = m_logBytes;
+    pthread_mutex_unlock(&m_lock);
+    return bytes;
+}
+
+void* LogAntiCacheDB::run(void *db) {
+    static_cast<LogAntiCacheDB*>(db)->compactInBackground();
+    return NULL;
+}
+
+void LogAntiCacheDB::compactInBackground() {
+    pthread_mutex_lock(&m_lock);
+    while (true) {
+        while (!m_compactionRequested && !m_shutdown) {
+            pthread_cond_wait(&m_compact, &m_lock);
+        }
+        if (m_shutdown) {
+            break;
+        }
+        m_compactionRequested = false;
+        pthread_mutex_unlock(&m_lock);
+        try {
+            compactSegments();
+        } catch (...) {
+            // the space stays dead, and a full log is reported when a block is stored
+            VOLT_ERROR("Failed to compact the anti-cache log in %s", m_dbDir.c_str());
+        }
+        pthread_mutex_lock(&m_lock);
+    }
+    pthread_mutex_unlock(&m_lock);
+}
+
+}
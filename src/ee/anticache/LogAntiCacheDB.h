@@ -0,0 +1,209 @@
+/* Copyright (C) 2014 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef LOGHSTOREANTICACHE_H
+#define LOGHSTOREANTICACHE_H
+
+#include "common/types.h"
+#include "common/debuglog.h"
+#include "anticache/AntiCacheDB.h"
+
+#include <map>
+#include <set>
+#include <string>
+#include <pthread.h>
+
+using namespace std;
+
+namespace voltdb {
+
+class ExecutorContext;
+class AntiCacheDB;
+
+class LogAntiCacheBlock : public AntiCacheBlock {
+    friend class LogAntiCacheDB;
+
+    public:
+        ~LogAntiCacheBlock();
+
+        char* releaseData();
+
+    private:
+        LogAntiCacheBlock(uint32_t blockId, const std::string &tableName, char* data, long size);
+}; // CLASS
+
+/**
+ * AntiCacheDB that appends blocks to a log of segment files. Blocks are
+ * gathered in an aligned write buffer and written with large sequential
+ * O_DIRECT writes, and an in-memory map points every block id at its
+ * segment and offset. Unevicted blocks leave dead space behind, which a
+ * background thread reclaims by copying the live blocks of a mostly dead
+ * segment to the head of the log and deleting the segment.
+ */
+class LogAntiCacheDB : public AntiCacheDB {
+    public:
+        LogAntiCacheDB(ExecutorContext *ctx, std::string db_dir, long blockSize, long maxSize);
+        ~LogAntiCacheDB();
+
+        void initializeDB();
+
+        inline uint32_t nextBlockId() {
+            return (++m_nextBlockId);
+        }
+
+        void shutdownDB();
+
+        void flushBlocks();
+
+        bool validateBlock(uint32_t blockId);
+
+        void unevictBlock(uint32_t blockId, long storedSize, bool isMigrate);
+
+        /**
+         * Copy the live blocks out of the sealed segments that are mostly
+         * dead and delete those segments. This is what the background thread
+         * runs. Returns the number of segments deleted.
+         */
+        int compactSegments();
+
+        int getNumSegments();
+
+        /**
+         * Bytes taken up by the segment files, dead records included
+         */
+        int64_t getLogBytes();
+
+        inline long getSegmentSize() const {
+            return m_segmentSize;
+        }
+
+        inline bool isDirectIO() const {
+            return m_directIO;
+        }
+
+        /*
+         * segments deleted and bytes copied by compaction
+         */
+        inline int64_t getSegmentsCompacted() const {
+            return m_segmentsCompacted;
+        }
+        inline int64_t getBytesCompacted() const {
+            return m_bytesCompacted;
+        }
+
+        /**
+         * Alignment of the records and of every read and write
+         */
+        static const long LOG_ALIGNMENT = 4096;
+        /**
+         * Size of the write buffer, and so of most writes
+         */
+        static const long LOG_WRITE_SIZE = 1048576;
+        static const long MAX_SEGMENT_SIZE = 67108864;
+
+    protected:
+        void storeBlock(const std::string tableName,
+                        uint32_t blockId,
+                        const int tupleCount,
+                        const char* data,
+                        const long size,
+                        const int evictedTupleCount);
+
+        AntiCacheBlock* loadBlock(uint32_t blockId);
+
+    private:
+        struct Segment {
+            int id;
+            int fd;
+            std::string path;
+            // bytes appended to the segment, and those of blocks still in it
+            long written;
+            long liveBytes;
+            std::set<uint32_t> blockIds;
+            // threads reading from the file, which keep it from being deleted
+            int readers;
+            bool sealed;
+        };
+
+        struct Location {
+            Segment *segment;
+            long offset;
+            long recordSize;
+        };
+
+        /**
+         * Record header in front of the table name and the data of a block
+         */
+        struct RecordHeader {
+            uint32_t magic;
+            uint32_t blockId;
+            int32_t tableNameSize;
+            int32_t dataSize;
+        };
+
+        static inline long alignedSize(long size) {
+            return (size + LOG_ALIGNMENT - 1) / LOG_ALIGNMENT * LOG_ALIGNMENT;
+        }
+
+        static void* run(void *db);
+        void compactInBackground();
+
+        // the methods below are called with m_lock held
+        Segment* openSegment();
+        void deleteSegment(Segment *segment);
+        void flushBuffer();
+        Location appendRecord(const char *record, long recordSize);
+        void reserveBuffer(long size);
+
+        // called without the lock, on a segment whose reader count is held up
+        char* readRecord(Segment *segment, long offset, long recordSize);
+
+        std::string m_segmentPrefix;
+        long m_segmentSize;
+        bool m_directIO;
+        int m_nextSegmentId;
+        std::map<int, Segment*> m_segments;
+        Segment *m_activeSegment;
+        int64_t m_logBytes;
+        std::map<uint32_t, Location> m_blockMap;
+
+        // the unwritten tail of the active segment, starting at m_bufferOffset
+        char *m_buffer;
+        long m_bufferCapacity;
+        long m_bufferUsed;
+        long m_bufferOffset;
+
+        int64_t m_segmentsCompacted;
+        int64_t m_bytesCompacted;
+
+        pthread_t m_compactor;
+        bool m_compactionRequested;
+        bool m_shutdown;
+        pthread_mutex_t m_lock;
+        pthread_cond_t m_compact;
+};
+
+}
+#endif
@@ -36,29 +36,17 @@
 #include <sys/mman.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <algorithm>
 
 using namespace std;
 
 namespace voltdb {
 
-NVMAntiCacheBlock::NVMAntiCacheBlock(uint32_t blockId, char* block, long size) :
+NVMAntiCacheBlock::NVMAntiCacheBlock(uint32_t blockId, const std::string &tableName, char* data, long size) :
     AntiCacheBlock(blockId) {
 
-    /* m_block = block;
-    m_size = size;
-    m_blockType = ANTICACHEDB_NVM;
-    */
-    char* buffer = block;
-    std::string tableName = buffer;
-    
-    block = buffer + tableName.size() + 1;
-    size -= tableName.size() + 1;
-
-
-    m_block = new char[size];
-    memcpy(m_block, block, size);
-
-    delete [] buffer;
+    m_block = data;
 
     payload p;
     p.tableName = tableName;
@@ -80,6 +68,12 @@ NVMAntiCacheBlock::~NVMAntiCacheBlock() {
     delete [] m_block;
 }
 
+char* NVMAntiCacheBlock::releaseData() {
+    char *data = m_block;
+    m_block = NULL;
+    return data;
+}
+
 NVMAntiCacheDB::NVMAntiCacheDB(ExecutorContext *ctx, std::string db_dir, long blockSize, long maxSize) :
     AntiCacheDB(ctx, db_dir, blockSize, maxSize) {
 
@@ -190,7 +184,7 @@ void NVMAntiCacheDB::flushBlocks() {
     //MJG TODO: Do we need a sync() or something?
 }
 
-void NVMAntiCacheDB::writeBlock(const std::string tableName,
+void NVMAntiCacheDB::storeBlock(const std::string tableName,
                                 uint32_t blockId,
                                 const int tupleCount,
                                 const char* data,
@@ -244,9 +238,9 @@ bool NVMAntiCacheDB::validateBlock(uint32_t blockId) {
         return 1;
 }
 
-AntiCacheBlock* NVMAntiCacheDB::readBlock(uint32_t blockId, bool isMigrate) {
+AntiCacheBlock* NVMAntiCacheDB::loadBlock(uint32_t blockId) {
     
-    std::map<uint32_t, std::pair<uint32_t, int32_t> >::iterator itr; 
+    std::map<uint32_t, std::pair<uint32_t, int32_t> >::const_iterator itr; 
     itr = m_blockMap.find(blockId); 
   
     if (itr == m_blockMap.end()) {
@@ -260,13 +254,28 @@ AntiCacheBlock* NVMAntiCacheDB::readBlock(uint32_t blockId, bool isMigrate) {
     uint32_t blockIndex = itr->second.first; 
     int blockSize = itr->second.second;
    
+    // the block is the table name followed by the data, which is copied out once
     char* block_ptr = getNVMBlock(blockIndex);
-    char* block = new char[blockSize];
-    memcpy(block, block_ptr, blockSize); 
+    std::string tableName(block_ptr);
+    long size = blockSize - (long)tableName.size() - 1;
+    char* data = new char[size];
+    memcpy(data, block_ptr + tableName.size() + 1, size); 
 
-    VOLT_DEBUG("Reading NVM block: ID = %u, index = %u, size = %d, isMigrate = %d, data = %s", blockId, blockIndex, blockSize, isMigrate, block);
+    VOLT_DEBUG("Reading NVM block: ID = %u, index = %u, size = %d", blockId, blockIndex, blockSize);
     
-    AntiCacheBlock* anticache_block = new NVMAntiCacheBlock(blockId, block, blockSize);
+    return new NVMAntiCacheBlock(blockId, tableName, data, size);
+}
+
+void NVMAntiCacheDB::unevictBlock(uint32_t blockId, long storedSize, bool isMigrate) {
+    std::map<uint32_t, std::pair<uint32_t, int32_t> >::iterator itr; 
+    itr = m_blockMap.find(blockId); 
+    if (itr == m_blockMap.end()) {
+        throw UnknownBlockAccessException(blockId);
+    }
+
+    // the stats count the table name along with the data, as when the block was written
+    uint32_t blockIndex = itr->second.first; 
+    int blockSize = itr->second.second;
 
     if (this->isBlockMerge()) {
         freeNVMBlock(blockIndex); 
@@ -301,7 +310,36 @@ AntiCacheBlock* NVMAntiCacheDB::readBlock(uint32_t blockId, bool isMigrate) {
             }
         }
     }
-    return (anticache_block);
+}
+
+void NVMAntiCacheDB::prefetchBlocks(const std::vector<uint32_t> &blockIds) {
+    #ifndef ANTICACHE_DRAM
+    // blocks in adjacent slots are paged in with a single hint
+    std::vector<uint32_t> indexes;
+    for (std::vector<uint32_t>::const_iterator it = blockIds.begin(); it != blockIds.end(); ++it) {
+        std::map<uint32_t, std::pair<uint32_t, int32_t> >::const_iterator itr = m_blockMap.find(*it);
+        if (itr != m_blockMap.end()) {
+            indexes.push_back(itr->second.first);
+        }
+    }
+    std::sort(indexes.begin(), indexes.end());
+
+    const uintptr_t pageSize = (uintptr_t)sysconf(_SC_PAGESIZE);
+    size_t i = 0;
+    while (i < indexes.size()) {
+        size_t j = i + 1;
+        while (j < indexes.size() && indexes[j] <= indexes[j - 1] + 1) {
+            j++;
+        }
+        uintptr_t start = (uintptr_t)getNVMBlock(indexes[i]) & ~(pageSize - 1);
+        uintptr_t end = std::min((uintptr_t)getNVMBlock(indexes[j - 1]) + m_blockSize,
+                                 (uintptr_t)m_NVMBlocks + m_maxDBSize);
+        if (madvise((void*)start, end - start, MADV_WILLNEED) != 0) {
+            VOLT_DEBUG("madvise of NVM blocks %u-%u failed: %s", indexes[i], indexes[j - 1], strerror(errno));
+        }
+        i = j;
+    }
+    #endif
 }
 
 char* NVMAntiCacheDB::getNVMBlock(uint32_t index) {
@@ -44,8 +44,10 @@ class NVMAntiCacheBlock : public AntiCacheBlock {
     public:
         ~NVMAntiCacheBlock();
 
+        char* releaseData();
+
     private:
-        NVMAntiCacheBlock(uint32_t blockId, char* block, long size);
+        NVMAntiCacheBlock(uint32_t blockId, const std::string &tableName, char* data, long size);
         //std::string m_tableName;
 }; // CLASS
 
@@ -62,20 +64,26 @@ class NVMAntiCacheDB : public AntiCacheDB {
            
         }
 
-        AntiCacheBlock* readBlock(uint32_t blockId, bool isMigrate);
-
         void shutdownDB();
 
         void flushBlocks();
 
-        void writeBlock(const std::string tableName,
+
+        bool validateBlock(uint32_t blockId);
+
+        void unevictBlock(uint32_t blockId, long storedSize, bool isMigrate);
+
+        void prefetchBlocks(const std::vector<uint32_t> &blockIds);
+
+    protected:
+        void storeBlock(const std::string tableName,
                         uint32_t blockId,
                         const int tupleCount,
                         const char* data,
                         const long size,
                         const int evictedTupleCount);
 
-        bool validateBlock(uint32_t blockId);
+        AntiCacheBlock* loadBlock(uint32_t blockId);
 
     private:
         /**
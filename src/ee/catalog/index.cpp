@@ -35,6 +35,12 @@ Index::Index(Catalog *catalog, CatalogType *parent, const string &path, const st
     m_fields["unique"] = value;
     m_fields["type"] = value;
     m_childCollections["columns"] = &m_columns;
+    m_fields["mergeratio"] = value;
+    m_fields["mergethreshold"] = value;
+    m_fields["mergememory"] = value;
+    m_fields["mergeinterval"] = value;
+    m_fields["bloombits"] = value;
+    m_fields["bloomhashes"] = value;
 }
 
 Index::~Index() {
@@ -50,6 +56,12 @@ Index::~Index() {
 void Index::update() {
     m_unique = m_fields["unique"].intValue;
     m_type = m_fields["type"].intValue;
+    m_mergeratio = m_fields["mergeratio"].intValue;
+    m_mergethreshold = m_fields["mergethreshold"].intValue;
+    m_mergememory = m_fields["mergememory"].intValue;
+    m_mergeinterval = m_fields["mergeinterval"].intValue;
+    m_bloombits = m_fields["bloombits"].intValue;
+    m_bloomhashes = m_fields["bloomhashes"].intValue;
 }
 
 CatalogType * Index::addChild(const std::string &collectionName, const std::string &childName) {
@@ -88,3 +100,27 @@ const CatalogMap<ColumnRef> & Index::columns() const {
     return m_columns;
 }
 
+int32_t Index::mergeratio() const {
+    return m_mergeratio;
+}
+
+int32_t Index::mergethreshold() const {
+    return m_mergethreshold;
+}
+
+int32_t Index::mergememory() const {
+    return m_mergememory;
+}
+
+int32_t Index::mergeinterval() const {
+    return m_mergeinterval;
+}
+
+int32_t Index::bloombits() const {
+    return m_bloombits;
+}
+
+int32_t Index::bloomhashes() const {
+    return m_bloomhashes;
+}
+
@@ -41,6 +41,12 @@ protected:
     bool m_unique;
     int32_t m_type;
     CatalogMap<ColumnRef> m_columns;
+    int32_t m_mergeratio;
+    int32_t m_mergethreshold;
+    int32_t m_mergememory;
+    int32_t m_mergeinterval;
+    int32_t m_bloombits;
+    int32_t m_bloomhashes;
 
     virtual void update();
 
@@ -57,6 +63,18 @@ public:
     int32_t type() const;
     /** GETTER: Columns referenced by the index */
     const CatalogMap<ColumnRef> & columns() const;
+    /** GETTER: Merge the dynamic stage of a compact index once it is 1/ratio of the static stage (0 for the default, -1 to disable) */
+    int32_t mergeratio() const;
+    /** GETTER: Smallest dynamic stage (in entries) merged by the ratio trigger (0 for the default) */
+    int32_t mergethreshold() const;
+    /** GETTER: Merge the dynamic stage of a compact index once its entries take this many KB (0 to disable) */
+    int32_t mergememory() const;
+    /** GETTER: Merge a non-empty dynamic stage of a compact index at least every this many milliseconds (0 to disable) */
+    int32_t mergeinterval() const;
+    /** GETTER: Bloom filter bits per key over the dynamic stage of a compact index (0 for the default) */
+    int32_t bloombits() const;
+    /** GETTER: Bloom filter hash functions over the dynamic stage of a compact index (0 for the default) */
+    int32_t bloomhashes() const;
 };
 
 } // namespace catalog
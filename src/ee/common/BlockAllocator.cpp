@@ -0,0 +1,247 @@
+/* Copyright (C) 2014 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "common/BlockAllocator.h"
+#include "common/debuglog.h"
+
+#include <new>
+#include <cassert>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/mman.h>
+#ifdef LINUX
+#include <sched.h>
+#include <sys/syscall.h>
+#endif
+
+namespace voltdb {
+
+static const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+// MPOL_PREFERRED of <numaif.h>, mbind is called directly to not link libnuma
+static const int NUMA_POLICY_PREFERRED = 1;
+
+/**
+ * The memory node of the only core the calling thread may run on,
+ * -1 if the thread is not pinned to a single core.
+ */
+static int pinnedNumaNode() {
+#if defined(LINUX) && defined(SYS_getcpu) && defined(SYS_mbind)
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    if (sched_getaffinity(0, sizeof(cpus), &cpus) != 0 || CPU_COUNT(&cpus) != 1) {
+        return -1;
+    }
+    unsigned int cpu = 0;
+    unsigned int node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, NULL) != 0) {
+        return -1;
+    }
+    return (int)node;
+#else
+    return -1;
+#endif
+}
+
+BlockAllocator::BlockAllocator()
+    : m_hugePages(false), m_bindNumaNode(false), m_cacheLimit(0),
+      m_numaNode(-1),
+      m_hugePageBlocks(0), m_cacheHits(0)
+{
+}
+
+BlockAllocator::~BlockAllocator() {
+    trim();
+}
+
+void BlockAllocator::configure(bool hugePages, bool bindNumaNode, int cacheBlocks) {
+    VOLT_DEBUG("Block allocator: huge pages %d, NUMA binding %d, cache %d blocks",
+               hugePages, bindNumaNode, cacheBlocks);
+    trim();
+    m_hugePages = hugePages;
+    m_bindNumaNode = bindNumaNode;
+    m_cacheLimit = cacheBlocks > 0 ? (size_t)cacheBlocks : 0;
+    m_numaNode = -1;
+}
+
+/**
+ * Blocks are mapped in whole pages. The length only depends on the size
+ * of the block, so a block is unmapped correctly whatever the settings
+ * were when it was allocated.
+ */
+size_t BlockAllocator::mappedLength(size_t bytes) const {
+    const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    return (bytes + page - 1) / page * page;
+}
+
+char* BlockAllocator::allocate(size_t bytes) {
+#ifdef MEMCHECK
+    return new char[bytes];
+#else
+    const size_t length = mappedLength(bytes);
+    for (size_t i = m_cache.size(); i > 0; i--) {
+        if (m_cache[i - 1].second == length) {
+            char *block = m_cache[i - 1].first;
+            m_cache.erase(m_cache.begin() + (i - 1));
+            m_cacheHits++;
+            return block;
+        }
+    }
+
+    // huge pages only back blocks that fill them, not the small temp table blocks
+    const bool hugePages = m_hugePages && length % HUGE_PAGE_SIZE == 0;
+    char *block = NULL;
+#ifdef MAP_HUGETLB
+    if (hugePages) {
+        void *memory = mmap(NULL, length, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (memory != MAP_FAILED) {
+            block = static_cast<char*>(memory);
+            m_hugePageBlocks++;
+        }
+    }
+#endif
+    if (block == NULL) {
+        // no reserved huge page left, ask for transparent ones
+        block = mapAligned(length, hugePages ? HUGE_PAGE_SIZE : 0);
+#ifdef MADV_HUGEPAGE
+        if (hugePages) {
+            (void)madvise(block, length, MADV_HUGEPAGE);
+        }
+#endif
+    }
+    // before the block is touched, which is when its pages are placed
+    bind(block, length);
+    return block;
+#endif
+}
+
+void BlockAllocator::release(char *block, size_t bytes) {
+    assert(block != NULL);
+#ifdef MEMCHECK
+    (void)bytes;
+    delete[] block;
+#else
+    const size_t length = mappedLength(bytes);
+    if (m_cache.size() < m_cacheLimit) {
+        m_cache.push_back(std::make_pair(block, length));
+    } else {
+        unmap(block, length);
+    }
+#endif
+}
+
+void BlockAllocator::advise(char *block, size_t bytes) {
+#ifdef MEMCHECK
+    (void)block;
+    (void)bytes;
+#else
+    const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    if ((size_t)block % page != 0) {
+        return;
+    }
+#ifdef MADV_HUGEPAGE
+    if (m_hugePages) {
+        (void)madvise(block, mappedLength(bytes), MADV_HUGEPAGE);
+    }
+#endif
+    bind(block, mappedLength(bytes));
+#endif
+}
+
+void BlockAllocator::trim() {
+    for (size_t i = 0; i < m_cache.size(); i++) {
+        unmap(m_cache[i].first, m_cache[i].second);
+    }
+    m_cache.clear();
+}
+
+/**
+ * Maps anonymous memory starting on a multiple of the alignment, which
+ * transparent huge pages need, by mapping more and unmapping the excess.
+ */
+char* BlockAllocator::mapAligned(size_t length, size_t alignment) {
+    const size_t extra = alignment;
+    void *memory = mmap(NULL, length + extra, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        VOLT_ERROR("Failed to map a block of %ld bytes: errno %d", (long)length, errno);
+        throw std::bad_alloc();
+    }
+    char *start = static_cast<char*>(memory);
+    if (extra == 0) {
+        return start;
+    }
+
+    char *aligned = start + (alignment - (size_t)start % alignment) % alignment;
+    if (aligned > start) {
+        (void)munmap(start, (size_t)(aligned - start));
+    }
+    char *end = aligned + length;
+    if (end < start + length + extra) {
+        (void)munmap(end, (size_t)(start + length + extra - end));
+    }
+    return aligned;
+}
+
+void BlockAllocator::bind(char *block, size_t length) {
+    if (!m_bindNumaNode) {
+        return;
+    }
+    if (m_numaNode < 0) {
+        // the catalog is loaded before the partition thread runs and pins itself
+        m_numaNode = pinnedNumaNode();
+        if (m_numaNode >= 0) {
+            VOLT_DEBUG("Block allocator: binding blocks to NUMA node %d", m_numaNode);
+        }
+    }
+    if (m_numaNode < 0 || m_numaNode >= (int)(sizeof(unsigned long) * 8)) {
+        return;
+    }
+#if defined(LINUX) && defined(SYS_mbind)
+    // preferred rather than strict, so a full node spills over instead of failing
+    unsigned long nodeMask = 1UL << m_numaNode;
+    if (syscall(SYS_mbind, block, length, NUMA_POLICY_PREFERRED,
+                &nodeMask, sizeof(nodeMask) * 8 + 1, 0) != 0) {
+        VOLT_DEBUG("Block allocator: mbind failed with errno %d", errno);
+    }
+#else
+    (void)block;
+    (void)length;
+#endif
+}
+
+void BlockAllocator::unmap(char *block, size_t length) {
+#ifdef MEMCHECK
+    (void)length;
+    delete[] block;
+#else
+    if (munmap(block, length) != 0) {
+        VOLT_ERROR("Failed to unmap a block of %ld bytes: errno %d", (long)length, errno);
+    }
+#endif
+}
+
+}
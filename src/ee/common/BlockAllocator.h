@@ -0,0 +1,107 @@
+/* Copyright (C) 2014 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef HSTOREBLOCKALLOCATOR_H
+#define HSTOREBLOCKALLOCATOR_H
+
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <stdint.h>
+
+namespace voltdb {
+
+/**
+ * Hands out the memory for the tuple blocks of tables. Every partition has
+ * its own allocator in its ExecutorContext, so all the blocks of a
+ * partition follow one configuration:
+ *
+ * - With huge pages, a block is mapped with MAP_HUGETLB from the reserved
+ *   huge page pool, and when that pool is empty, mapped on a 2 MB boundary
+ *   with transparent huge pages requested through madvise.
+ * - With NUMA binding, the blocks prefer the memory node of the core the
+ *   partition thread is pinned to (site.cpu_affinity_one_partition_per_core).
+ *   Blocks allocated before the thread is pinned to a single core are not
+ *   bound.
+ * - Released blocks are kept in a small cache and handed out again before
+ *   new memory is mapped, so that a temp table filling and emptying a block
+ *   on every query does not map and unmap it each time.
+ *
+ * An allocator is used by the thread of its partition only, it takes no
+ * locks. Tables outside of a partition have no allocator and use new[].
+ * Memcheck builds allocate with new[] so that valgrind can track blocks.
+ */
+class BlockAllocator {
+public:
+    BlockAllocator();
+    ~BlockAllocator();
+
+    void configure(bool hugePages, bool bindNumaNode, int cacheBlocks);
+
+    char* allocate(size_t bytes);
+    void release(char *block, size_t bytes);
+
+    /**
+     * Applies the huge page and NUMA settings to memory the caller mapped
+     * itself, such as the file-backed blocks of MMAP tables. Both are hints
+     * to the kernel and are ignored where the mapping does not support them.
+     */
+    void advise(char *block, size_t bytes);
+
+    /** Drops the cached blocks. */
+    void trim();
+
+    inline bool hugePagesEnabled() const { return m_hugePages; }
+    inline int cachedBlocks() const { return (int)m_cache.size(); }
+    inline int64_t hugePageBlocks() const { return m_hugePageBlocks; }
+    inline int64_t cacheHits() const { return m_cacheHits; }
+
+private:
+    // no copy, no assignment
+    BlockAllocator(BlockAllocator const&);
+    BlockAllocator& operator=(BlockAllocator const&);
+
+    size_t mappedLength(size_t bytes) const;
+    char* mapAligned(size_t length, size_t alignment);
+    void bind(char *block, size_t length);
+    void unmap(char *block, size_t length);
+
+    bool m_hugePages;
+    bool m_bindNumaNode;
+    size_t m_cacheLimit;
+
+    // the node of the pinned core, -1 until the thread is pinned
+    int m_numaNode;
+
+    // released blocks with their mapped length
+    std::vector<std::pair<char*, size_t> > m_cache;
+
+    int64_t m_hugePageBlocks;
+    int64_t m_cacheHits;
+};
+
+}
+
+#endif
@@ -0,0 +1,71 @@
+/* Copyright (C) 2014 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "common/CompactingPool.h"
+
+#include <cassert>
+#include <cstring>
+
+namespace voltdb {
+
+CompactingPool::CompactingPool(std::size_t elementSize, std::size_t bufferSize)
+    : m_elementSize(elementSize),
+      m_elementsPerBuffer(bufferSize > elementSize ? bufferSize / elementSize : 1),
+      m_count(0)
+{
+}
+
+CompactingPool::~CompactingPool() {
+    for (std::size_t i = 0; i < m_buffers.size(); i++) {
+        delete[] m_buffers[i];
+    }
+}
+
+void* CompactingPool::malloc() {
+    if (m_count == m_buffers.size() * m_elementsPerBuffer) {
+        m_buffers.push_back(new char[m_elementsPerBuffer * m_elementSize]);
+    }
+    return elementAt(m_count++);
+}
+
+bool CompactingPool::free(void *element) {
+    assert(m_count > 0);
+    char *last = elementAt(m_count - 1);
+    const bool moved = (last != element);
+    if (moved) {
+        ::memcpy(element, last, m_elementSize);
+    }
+    m_count--;
+
+    // keep one empty buffer around so that a pool that grows and shrinks
+    // around a buffer boundary does not allocate a buffer every time
+    while (m_buffers.size() >= 2 && m_count <= (m_buffers.size() - 2) * m_elementsPerBuffer) {
+        delete[] m_buffers.back();
+        m_buffers.pop_back();
+    }
+    return moved;
+}
+
+}
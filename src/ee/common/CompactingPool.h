@@ -0,0 +1,80 @@
+/* Copyright (C) 2014 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef HSTORECOMPACTINGPOOL_H
+#define HSTORECOMPACTINGPOOL_H
+
+#include <vector>
+#include <cstddef>
+
+namespace voltdb {
+
+/**
+ * A pool of fixed-size elements that are kept densely packed: a new
+ * element is taken from the end of the used range, and a freed element
+ * is filled with the last element of the pool. Memory is handed out in
+ * buffers of many elements, and a buffer is given back once the used
+ * range no longer reaches into it. Since elements move, the owner of
+ * every element must be told its new location when free() moves one.
+ */
+class CompactingPool {
+public:
+    CompactingPool(std::size_t elementSize, std::size_t bufferSize);
+    ~CompactingPool();
+
+    void* malloc();
+
+    /**
+     * Frees the element. Returns true if the last element of the pool was
+     * moved into its place, in which case the element now holds the moved
+     * data and its owner must be updated.
+     */
+    bool free(void *element);
+
+    inline std::size_t getElementSize() const { return m_elementSize; }
+    inline std::size_t getElementCount() const { return m_count; }
+    inline std::size_t getBytesAllocated() const {
+        return m_buffers.size() * m_elementsPerBuffer * m_elementSize;
+    }
+
+private:
+    // no copy, no assignment
+    CompactingPool(CompactingPool const&);
+    CompactingPool& operator=(CompactingPool const&);
+
+    inline char* elementAt(std::size_t index) const {
+        return m_buffers[index / m_elementsPerBuffer] +
+            (index % m_elementsPerBuffer) * m_elementSize;
+    }
+
+    const std::size_t m_elementSize;
+    const std::size_t m_elementsPerBuffer;
+    std::vector<char*> m_buffers;
+    std::size_t m_count;
+};
+
+}
+
+#endif
@@ -0,0 +1,110 @@
+/* Copyright (C) 2014 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "common/CompactingStringStorage.h"
+#include "common/StringRef.h"
+
+#include <new>
+
+namespace voltdb {
+
+// the smallest class holds the back pointer and a short string
+static const std::size_t MIN_STRING_CLASS = 16;
+
+static const std::size_t STRING_BUFFER_SIZE = 64 * 1024;
+
+/**
+ * The size class of a string of length bytes and the index of the class.
+ * The classes go 16, 24, 32, 48, 64, 96, ..., wasting at most a third of
+ * a string.
+ */
+static std::size_t sizeClass(std::size_t length, std::size_t *index) {
+    std::size_t power = MIN_STRING_CLASS;
+    *index = 0;
+    while (true) {
+        if (length <= power) {
+            return power;
+        }
+        if (length <= power + power / 2) {
+            *index += 1;
+            return power + power / 2;
+        }
+        power *= 2;
+        *index += 2;
+    }
+}
+
+CompactingStringStorage::CompactingStringStorage()
+    : m_refPool(sizeof(StringRef)), m_stringCount(0)
+{
+}
+
+CompactingStringStorage::~CompactingStringStorage() {
+    for (std::size_t i = 0; i < m_pools.size(); i++) {
+        delete m_pools[i];
+    }
+}
+
+CompactingStringPool* CompactingStringStorage::poolFor(std::size_t length) {
+    std::size_t index;
+    const std::size_t classSize = sizeClass(length, &index);
+    if (index >= m_pools.size()) {
+        m_pools.resize(index + 1, NULL);
+    }
+    if (m_pools[index] == NULL) {
+        m_pools[index] = new CompactingStringPool(classSize, STRING_BUFFER_SIZE);
+    }
+    return m_pools[index];
+}
+
+StringRef* CompactingStringStorage::create(std::size_t size) {
+    const std::size_t length = size + sizeof(StringRef*);
+    char *string = poolFor(length)->malloc();
+    void *memory = m_refPool.malloc();
+    if (memory == NULL) {
+        throw std::bad_alloc();
+    }
+    m_stringCount++;
+    return new (memory) StringRef(length, this, string);
+}
+
+void CompactingStringStorage::destroy(StringRef *sref) {
+    poolFor(sref->m_size)->free(sref->m_stringPtr);
+    sref->~StringRef();
+    m_refPool.free(sref);
+    m_stringCount--;
+}
+
+std::size_t CompactingStringStorage::getBytesAllocated() const {
+    std::size_t bytes = m_stringCount * sizeof(StringRef);
+    for (std::size_t i = 0; i < m_pools.size(); i++) {
+        if (m_pools[i] != NULL) {
+            bytes += m_pools[i]->getBytesAllocated();
+        }
+    }
+    return bytes;
+}
+
+}
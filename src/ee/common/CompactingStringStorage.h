@@ -0,0 +1,76 @@
+/* Copyright (C) 2014 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef HSTORECOMPACTINGSTRINGSTORAGE_H
+#define HSTORECOMPACTINGSTRINGSTORAGE_H
+
+#include "common/CompactingStringPool.h"
+
+#include "boost/pool/pool.hpp"
+
+#include <vector>
+#include <cstddef>
+
+namespace voltdb {
+
+class StringRef;
+
+/**
+ * The memory of the uninlined strings of one persistent table. Strings
+ * are grouped into size classes, powers of two and the midpoints between
+ * them, and each class is a CompactingStringPool, so allocating a string
+ * takes the next slot of its class and freeing one moves the last string
+ * of the class into the hole. The StringRef objects themselves never move,
+ * since tuples point to them, and come from a free list.
+ */
+class CompactingStringStorage {
+public:
+    CompactingStringStorage();
+    ~CompactingStringStorage();
+
+    /** A StringRef to a string of size bytes, see StringRef::create() */
+    StringRef* create(std::size_t size);
+    void destroy(StringRef *sref);
+
+    /** Bytes held for strings, including the StringRefs */
+    std::size_t getBytesAllocated() const;
+
+    inline std::size_t getStringCount() const { return m_stringCount; }
+
+private:
+    // no copy, no assignment
+    CompactingStringStorage(CompactingStringStorage const&);
+    CompactingStringStorage& operator=(CompactingStringStorage const&);
+
+    CompactingStringPool* poolFor(std::size_t length);
+
+    std::vector<CompactingStringPool*> m_pools;
+    boost::pool<> m_refPool;
+    std::size_t m_stringCount;
+};
+
+}
+
+#endif
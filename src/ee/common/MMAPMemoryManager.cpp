@@ -41,40 +41,56 @@
 
    pthread_mutex_t MMAPMemoryManager::m_mutex = PTHREAD_MUTEX_INITIALIZER;
 
-   const unsigned int DEFAULT_MMAP_SIZE = 256 * 1024 * 1024;
+   pthread_mutex_t MMAPMemoryManager::m_syncMutex = PTHREAD_MUTEX_INITIALIZER;
+   pthread_cond_t MMAPMemoryManager::m_syncCond = PTHREAD_COND_INITIALIZER;
+   std::deque<MMAPMemoryManager*> MMAPMemoryManager::m_syncQueue;
+   bool MMAPMemoryManager::m_syncerStarted = false;
+
+   const size_t MMAPMemoryManager::DEFAULT_SEGMENT_SIZE;
+   const size_t MMAPMemoryManager::npos;
+
+   static int adviceOf(MMAPAccessPattern pattern) {
+     switch (pattern) {
+     case MMAP_ACCESS_SEQUENTIAL:
+       return MADV_SEQUENTIAL;
+     case MMAP_ACCESS_RANDOM:
+       return MADV_RANDOM;
+     default:
+       return MADV_NORMAL;
+     }
+   }
 
    MMAPMemoryManager::MMAPMemoryManager()
-   : m_size(DEFAULT_MMAP_SIZE), m_allocated(0),
-   m_persistent(false), m_index(0)
+   : m_segmentSize(DEFAULT_SEGMENT_SIZE), m_offset(0), m_mapped(0), m_allocated(0),
+   m_persistent(false), m_fd(-1), m_accessPattern(MMAP_ACCESS_NORMAL), m_index(0),
+   m_syncQueued(false), m_syncing(false), m_syncListener(NULL), m_syncToken(0)
    {
-     init();
+     init(0);
    }
 
 
-   MMAPMemoryManager::MMAPMemoryManager(size_t size, const std::string fileName, bool persistent)
-   : m_size(size), m_allocated(0),
-   m_fileName(fileName), m_persistent(persistent), m_index(0)
+   MMAPMemoryManager::MMAPMemoryManager(size_t segmentSize, const std::string fileName, bool persistent,
+                                        size_t reopenBytes)
+   : m_segmentSize(segmentSize), m_offset(0), m_mapped(0), m_allocated(0),
+   m_fileName(fileName), m_persistent(persistent), m_fd(-1), m_accessPattern(MMAP_ACCESS_NORMAL), m_index(0),
+   m_syncQueued(false), m_syncing(false), m_syncListener(NULL), m_syncToken(0)
    {
-     init();
+     init(persistent ? reopenBytes : 0);
    }
 
-   void MMAPMemoryManager::init() {
-
-     // Allocate a big chunk which will be split into smaller chunks later
-     if(m_persistent == false){
-       // Not backed by a file
-       m_base = mmap(NULL, m_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+   void MMAPMemoryManager::init(size_t reopenBytes) {
 
-       if (m_base == MAP_FAILED) {
-	 VOLT_ERROR("MMAP : initialization error : mmap failed");
-	 throwFatalException("MMAP : initialization error : mmap failed");
-       }
+     // Segments are mapped at page-aligned file offsets
+     const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+     if (m_segmentSize == 0) {
+       m_segmentSize = DEFAULT_SEGMENT_SIZE;
      }
-     else{
+     m_segmentSize = (m_segmentSize + page - 1) / page * page;
+
+     if(m_persistent){
        // Backed by a file
 
-       int MMAP_fd, ret;
-       std::string MMAP_Dir, MMAP_file_name;
+       std::string MMAP_file_name;
 
        if(m_fileName.empty()){
 	 VOLT_ERROR("MMAP : initialization error : empty fileName.");
@@ -87,38 +103,84 @@
 
        VOLT_WARN("MMAP : MMAP_file_name :: %s ", MMAP_file_name.c_str());
 
-       MMAP_fd = open(MMAP_file_name.c_str(), O_RDWR|O_CREAT, S_IRUSR|S_IWUSR|S_IRGRP );
-       if (MMAP_fd < 0) {
+       // Kept open to extend the file for later segments
+       m_fd = open(MMAP_file_name.c_str(), O_RDWR|O_CREAT, S_IRUSR|S_IWUSR|S_IRGRP );
+       if (m_fd < 0) {
 	 VOLT_ERROR("MMAP : initialization error : open failed.");
 	 throwFatalException("MMAP : initialization error : open failed");
        }
+     }
 
-       ret = ftruncate(MMAP_fd, m_size) ;
-       if(ret < 0){
-	 VOLT_ERROR("MMAP : initialization error : ftruncate failed");
-	 throwFatalException("MMAP : initialization error : ftruncate failed");
+     size_t firstSegment = m_segmentSize;
+     if (m_persistent && reopenBytes > 0) {
+       // The first segment covers the whole file, whose content is kept
+       struct stat st;
+       if (fstat(m_fd, &st) != 0 || (size_t)st.st_size < reopenBytes) {
+	 VOLT_ERROR("MMAP : reopen error : %s is shorter than %lu bytes", m_fileName.c_str(), (unsigned long)reopenBytes);
+	 throwFatalException("MMAP : reopen error : file too short");
        }
+       firstSegment = std::max(firstSegment, (size_t)st.st_size);
+     }
+     else if (m_persistent && ftruncate(m_fd, 0) < 0) {
+       // Drop what an earlier run left behind
+       VOLT_ERROR("MMAP : initialization error : ftruncate failed");
+       throwFatalException("MMAP : initialization error : ftruncate failed");
+     }
+
+     // Map the first segment which will be split into smaller chunks later
+     addSegment(firstSegment);
+     m_offset = reopenBytes;
+     m_allocated = reopenBytes;
+
+     assert(m_segments.size() == 1);
+   }
 
-       m_base = mmap(NULL, m_size, PROT_READ | PROT_WRITE, MAP_SHARED , MMAP_fd, 0);
+   void MMAPMemoryManager::addSegment(size_t minSize) {
+     const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+     size_t size = std::max(m_segmentSize, (minSize + page - 1) / page * page);
+     void *base = NULL;
 
-       if (m_base == MAP_FAILED) {
-	 VOLT_ERROR("MMAP : initialization error : mmap failed");
-	 throwFatalException("MMAP : initialization error : mmap failed");
+     if(m_persistent == false){
+       // Not backed by a file
+       base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+     }
+     else{
+       if(ftruncate(m_fd, (off_t)(m_mapped + size)) < 0){
+	 VOLT_ERROR("MMAP : segment error : ftruncate failed");
+	 throwFatalException("MMAP : segment error : ftruncate failed");
        }
+       base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, (off_t)m_mapped);
+     }
+
+     if (base == MAP_FAILED) {
+       VOLT_ERROR("MMAP : segment error : mmap failed");
+       throwFatalException("MMAP : segment error : mmap failed");
+     }
 
-       // Can close file since mmap adds a reference to file implicitly
-       close(MMAP_fd);
+     if (m_accessPattern != MMAP_ACCESS_NORMAL) {
+       (void)madvise(base, size, adviceOf(m_accessPattern));
      }
 
-     //VOLT_TRACE("Init m_base      : %p ",m_base);
-     //VOLT_TRACE("Init m_allocated : %ld ",m_allocated);
+     VOLT_DEBUG("MMAP : segment %d at %p size %lu", (int)m_segments.size(), base, (unsigned long)size);
 
-     assert(m_base != NULL);
-     assert(m_allocated == 0);
+     m_segments.push_back(std::make_pair(static_cast<char*>(base), size));
+     m_mapped += size;
+     m_offset = 0;
    }
 
    MMAPMemoryManager::~MMAPMemoryManager() {
 
+     // A queued sync is dropped, a running one has to finish first
+     pthread_mutex_lock(&m_syncMutex);
+     if (m_syncQueued) {
+       m_syncQueue.erase(std::find(m_syncQueue.begin(), m_syncQueue.end(), this));
+       m_syncQueued = false;
+     }
+     while (m_syncing) {
+       pthread_cond_wait(&m_syncCond, &m_syncMutex);
+     }
+     pthread_mutex_unlock(&m_syncMutex);
+
      if (pthread_mutex_lock(&m_mutex)) {
        VOLT_ERROR("Failed to lock mutex in MMAPMemoryManager::~MemoryManager()\n");
        throwFatalException("Failed to lock mutex.");
@@ -126,16 +188,21 @@
 
      int ret;
 
-     if (m_base != NULL) {
-       ret = munmap(m_base, m_size);
+     for (size_t i = 0; i < m_segments.size(); i++) {
+       ret = munmap(m_segments[i].first, m_segments[i].second);
 
        if(ret != 0){
 	 VOLT_ERROR("MUNMAP : initialization error.");
 	 throwFatalException("MUNMAP : initialization error.");
        }
      }
+     m_segments.clear();
+
+     if (m_fd >= 0) {
+       close(m_fd);
+       m_fd = -1;
+     }
 
-     m_base = NULL;
      m_allocated = 0;
 
      if (pthread_mutex_unlock(&m_mutex)) {
@@ -153,24 +220,20 @@
 
      void *memory = NULL;
 
-     if (m_base == NULL) {
-       init();
+     /** Grow by a new segment, the rest of the last one is left unused **/
+     if(m_offset + chunkSize > m_segments.back().second){
+       addSegment(chunkSize);
      }
 
      /** Update METADATA map and do the allocation **/
-     m_metadata.push_back(std::make_pair(m_allocated, chunkSize));
+     m_metadata.push_back(std::make_pair(m_mapped - m_segments.back().second + m_offset, chunkSize));
      m_index += 1;
 
-     /** Not an issue since we are mmap'ing **/
-     if(m_allocated + chunkSize > m_size){
-       VOLT_ERROR("No more memory available in MMAP'ed file");
-       throwFatalException("No more memory available in MMAP'ed file.");
-     }
-
-     memory = reinterpret_cast<char*> ((char*) m_base + m_allocated);
+     memory = reinterpret_cast<char*> (m_segments.back().first + m_offset);
 
-     VOLT_WARN("Allocated chunk at : %p ",memory);
+     VOLT_DEBUG("Allocated chunk at : %p ",memory);
 
+     m_offset += chunkSize;
      m_allocated += chunkSize;
 
      if (pthread_mutex_unlock(&m_mutex)) {
@@ -208,12 +271,63 @@
      }
    }
 
+   size_t MMAPMemoryManager::fileOffsetOf(const void *memory) const {
+     const char *address = static_cast<const char*>(memory);
+     size_t offset = 0;
+     for (size_t i = 0; i < m_segments.size(); i++) {
+       if (address >= m_segments[i].first && address < m_segments[i].first + m_segments[i].second) {
+	 return offset + (size_t)(address - m_segments[i].first);
+       }
+       offset += m_segments[i].second;
+     }
+     return npos;
+   }
+
+   char* MMAPMemoryManager::addressAt(size_t fileOffset, size_t bytes) const {
+     size_t offset = 0;
+     for (size_t i = 0; i < m_segments.size(); i++) {
+       if (fileOffset < offset + m_segments[i].second) {
+	 if (fileOffset + bytes > offset + m_segments[i].second) {
+	   return NULL;
+	 }
+	 return m_segments[i].first + (fileOffset - offset);
+       }
+       offset += m_segments[i].second;
+     }
+     return NULL;
+   }
+
+   void MMAPMemoryManager::setAccessPattern(MMAPAccessPattern pattern) {
+     pthread_mutex_lock(&m_mutex);
+     m_accessPattern = pattern;
+     for (size_t i = 0; i < m_segments.size(); i++) {
+       (void)madvise(m_segments[i].first, m_segments[i].second, adviceOf(pattern));
+     }
+     pthread_mutex_unlock(&m_mutex);
+   }
+
+   /** Only syncs the used part of every segment **/
+   bool MMAPMemoryManager::syncSegments(int flags){
+     // the segments are never unmapped while the manager lives, so a copy
+     // taken under the lock can be synced without holding it
+     pthread_mutex_lock(&m_mutex);
+     vector<pair<char*,size_t> > segments(m_segments);
+     if (!segments.empty()) {
+       segments.back().second = m_offset;
+     }
+     pthread_mutex_unlock(&m_mutex);
+
+     for (size_t i = 0; i < segments.size(); i++) {
+       if (segments[i].second > 0 && msync(segments[i].first, segments[i].second, flags) < 0) {
+	 return false;
+       }
+     }
+     return true;
+   }
 
    /** ASYNC m_sync **/
    void MMAPMemoryManager::async(){
-     /** Only sync till m_allocated **/
-     int ret = msync(m_base, m_allocated, MS_ASYNC);
-     if(ret<0){
+     if(!syncSegments(MS_ASYNC)){
        VOLT_ERROR("msync failed with error.");
        throwFatalException("Failed to msync.");
      }
@@ -221,14 +335,69 @@
 
    /** SYNC m_sync **/
    void MMAPMemoryManager::sync(){
-     /** Only sync till m_allocated **/
-     int ret = msync(m_base, m_allocated, MS_SYNC);
-     if(ret<0){
+     if(!syncSegments(MS_SYNC)){
        VOLT_ERROR("msync failed with error.");
        throwFatalException("Failed to msync.");
      }
    }
 
+   void MMAPMemoryManager::syncInBackground(MMAPSyncListener *listener, int64_t token){
+     pthread_mutex_lock(&m_syncMutex);
+     if (!m_syncerStarted) {
+       pthread_t syncer;
+       if (pthread_create(&syncer, NULL, syncerMain, NULL) != 0) {
+	 pthread_mutex_unlock(&m_syncMutex);
+	 VOLT_ERROR("Failed to start the MMAP syncer thread.");
+	 throwFatalException("Failed to start the MMAP syncer thread.");
+       }
+       pthread_detach(syncer);
+       m_syncerStarted = true;
+     }
+     m_syncListener = listener;
+     m_syncToken = token;
+     if (!m_syncQueued) {
+       m_syncQueued = true;
+       m_syncQueue.push_back(this);
+       pthread_cond_broadcast(&m_syncCond);
+     }
+     pthread_mutex_unlock(&m_syncMutex);
+   }
+
+   void MMAPMemoryManager::waitForSync(){
+     pthread_mutex_lock(&m_syncMutex);
+     while (m_syncQueued || m_syncing) {
+       pthread_cond_wait(&m_syncCond, &m_syncMutex);
+     }
+     pthread_mutex_unlock(&m_syncMutex);
+   }
+
+   /** Syncs the queued managers one at a time, for the life of the process **/
+   void* MMAPMemoryManager::syncerMain(void*){
+     pthread_mutex_lock(&m_syncMutex);
+     while (true) {
+       while (m_syncQueue.empty()) {
+	 pthread_cond_wait(&m_syncCond, &m_syncMutex);
+       }
+       MMAPMemoryManager *manager = m_syncQueue.front();
+       m_syncQueue.pop_front();
+       manager->m_syncQueued = false;
+       manager->m_syncing = true;
+       MMAPSyncListener *listener = manager->m_syncListener;
+       const int64_t token = manager->m_syncToken;
+       pthread_mutex_unlock(&m_syncMutex);
+
+       if (!manager->syncSegments(MS_SYNC)) {
+	 VOLT_ERROR("Background msync of %s failed.", manager->m_fileName.c_str());
+       }
+       else if (listener != NULL) {
+	 listener->synced(token);
+       }
+
+       pthread_mutex_lock(&m_syncMutex);
+       manager->m_syncing = false;
+       pthread_cond_broadcast(&m_syncCond);
+     }
+     return NULL;
+   }
 
  }
- 
@@ -35,15 +35,43 @@
 #include <map>
 #include <utility>
 #include <algorithm>
+#include <deque>
+#include <vector>
 
 using namespace std;
 
 namespace voltdb {
-  
+
+    /** How the pages of a mapping are expected to be touched, passed to madvise */
+    enum MMAPAccessPattern {
+        MMAP_ACCESS_NORMAL,
+        MMAP_ACCESS_SEQUENTIAL,
+        MMAP_ACCESS_RANDOM
+    };
+
+    /** Told on the background syncer thread when a requested sync has finished */
+    class MMAPSyncListener {
+    public:
+        virtual ~MMAPSyncListener() {}
+        virtual void synced(int64_t token) = 0;
+    };
+
+    /**
+     * Hands out chunks of memory from mmap'ed segments, backed by a file
+     * when persistent. When a chunk does not fit in what is left of the
+     * last segment, a new segment of the configured size is mapped (from
+     * the next range of the file, which is extended first), so handed out
+     * chunks never move and the storage grows without bound.
+     *
+     * A persistent manager starts from an empty file, unless it is asked to
+     * reopen the first reopenBytes of the file as they are, in which case
+     * the whole existing file is mapped and allocation continues after them.
+     */
     class MMAPMemoryManager {
     public:
 	MMAPMemoryManager();
-        MMAPMemoryManager(size_t size, const std::string fileName, bool persistent);
+        MMAPMemoryManager(size_t segmentSize, const std::string fileName, bool persistent,
+                          size_t reopenBytes = 0);
 
         ~MMAPMemoryManager();
 
@@ -67,26 +95,75 @@ namespace voltdb {
         void sync();
         void async();
 
+        /**
+         * Queues a synchronous msync of all segments on the background
+         * syncer thread and returns. A sync that is already queued for this
+         * manager absorbs the request, so writes are batched until the
+         * syncer gets to it. The listener, if any, is told with the token
+         * of the latest request once the sync has finished.
+         */
+        void syncInBackground(MMAPSyncListener *listener = NULL, int64_t token = 0);
+
+        /** Waits until no background sync of this manager is queued or running */
+        void waitForSync();
+
+        /** Applies the madvise hint to all segments, and to the ones mapped later */
+        void setAccessPattern(MMAPAccessPattern pattern);
+
+        inline size_t getSegmentCount() const { return m_segments.size(); }
+        inline size_t getMappedSize() const { return m_mapped; }
+        inline size_t getAllocatedSize() const { return m_allocated; }
+
+        /** Offset in the file of the handed out memory, or npos */
+        size_t fileOffsetOf(const void *memory) const;
+
+        /** The mapped memory of the bytes at the file offset, NULL if they are not mapped in one piece */
+        char* addressAt(size_t fileOffset, size_t bytes) const;
+
+        static const size_t npos = static_cast<size_t>(-1);
+
+        static const size_t DEFAULT_SEGMENT_SIZE = 256 * 1024 * 1024;
+
     private:
-        void init();
-        
-        // Base Ptr to allocated memory
-        void *m_base;
+        void init(size_t reopenBytes);
+        void addSegment(size_t minSize);
+        bool syncSegments(int flags);
+
+        static void* syncerMain(void *arg);
+
+        // Mapped segments :: (Base, Size), in file order
+        vector<pair<char*,size_t> > m_segments;
 
         // Bookkeeping
-        size_t m_size;
+        size_t m_segmentSize;
+        size_t m_offset;        // used bytes of the last segment
+        size_t m_mapped;
         size_t m_allocated;
 
 	// For persistent Map
         std::string m_fileName;
         bool m_persistent;
-        
+        int m_fd;
+
+        MMAPAccessPattern m_accessPattern;
+
         // METADATA :: (Offset, Size)
         vector<pair<size_t,size_t> > m_metadata;
         size_t m_index;
 
+        // background sync state, guarded by m_syncMutex
+        bool m_syncQueued;
+        bool m_syncing;
+        MMAPSyncListener *m_syncListener;
+        int64_t m_syncToken;
+
         static pthread_mutex_t m_mutex;
 
+        static pthread_mutex_t m_syncMutex;
+        static pthread_cond_t m_syncCond;
+        static std::deque<MMAPMemoryManager*> m_syncQueue;
+        static bool m_syncerStarted;
+
     };
 
 }
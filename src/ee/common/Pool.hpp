@@ -112,7 +112,7 @@ namespace voltdb {
                 m_chunks.push_back(Chunk(allocationSize, storage));
             }
             else{
-                /** MMAP Pool Allocation **/
+                /** MMAP Pool Allocation, the file grows by a chunk at a time **/
                 VOLT_WARN("MMAP Pool Storage Request :: %d %d ",static_cast<int>(m_allocationSize), static_cast<int>(m_maxChunkCount));
 
                 m_pool_manager = new MMAPMemoryManager(m_allocationSize, m_name+"_Pool", true); // backed by a file
@@ -253,7 +253,7 @@ namespace voltdb {
                  */
                 if (numChunks > m_maxChunkCount) {
                     for (std::size_t ii = m_maxChunkCount; ii < numChunks; ii++) {
-                        if(m_enableMMAP){
+                        if(m_enableMMAP == false){
                             delete []m_chunks[ii].m_chunkData;
                         }
                         /**
@@ -86,13 +86,11 @@ namespace voltdb{
 
                     VOLT_WARN("Persistent : %d", (int)m_persistent);
 
-                    const unsigned int DEFAULT_MMAP_SIZE = 256 * 1024 * 1024;
-
                     if(!m_manager){
                         if(m_persistent)
-                            m_manager = new MMAPMemoryManager(DEFAULT_MMAP_SIZE, m_fileName, true);
+                            m_manager = new MMAPMemoryManager(MMAPMemoryManager::DEFAULT_SEGMENT_SIZE, m_fileName, true);
                         else
-                            m_manager = new MMAPMemoryManager(DEFAULT_MMAP_SIZE, m_fileName, false);
+                            m_manager = new MMAPMemoryManager(MMAPMemoryManager::DEFAULT_SEGMENT_SIZE, m_fileName, false);
                     }
 
                     VOLT_WARN("Init m_manager : %p", m_manager);
@@ -18,6 +18,8 @@
 #include "StringRef.h"
 
 #include "Pool.hpp"
+#include "ThreadLocalPool.h"
+#include "CompactingStringStorage.h"
 
 using namespace voltdb;
 using namespace std;
@@ -31,6 +33,10 @@ StringRef::create(size_t size, Pool* dataPool)
         retval =
             new(dataPool->allocate(sizeof(StringRef))) StringRef(size, dataPool);
     }
+    else if (CompactingStringStorage* storage = ThreadLocalPool::getStringPool())
+    {
+        retval = storage->create(size);
+    }
     else
     {
         retval = new StringRef(size);
@@ -41,13 +47,21 @@ StringRef::create(size_t size, Pool* dataPool)
 void
 StringRef::destroy(StringRef* sref)
 {
-    delete sref;
+    if (sref->m_storage != NULL)
+    {
+        sref->m_storage->destroy(sref);
+    }
+    else
+    {
+        delete sref;
+    }
 }
 
 StringRef::StringRef(size_t size)
 {
     m_size = size + sizeof(StringRef*);
     m_tempPool = false;
+    m_storage = NULL;
     m_stringPtr = new char[m_size];
     //printf("m_stringPtr: %p\n", m_stringPtr);
     setBackPtr();
@@ -56,14 +70,24 @@ StringRef::StringRef(size_t size)
 StringRef::StringRef(std::size_t size, Pool* dataPool)
 {
     m_tempPool = true;
+    m_storage = NULL;
     m_stringPtr =
         reinterpret_cast<char*>(dataPool->allocate(size + sizeof(StringRef*)));
     setBackPtr();
 }
 
+StringRef::StringRef(std::size_t length, CompactingStringStorage* storage, char* stringPtr)
+{
+    m_size = length;
+    m_tempPool = false;
+    m_storage = storage;
+    m_stringPtr = stringPtr;
+    setBackPtr();
+}
+
 StringRef::~StringRef()
 {
-    if (!m_tempPool)
+    if (!m_tempPool && m_storage == NULL)
     {
         delete[] m_stringPtr;
     }
@@ -23,6 +23,7 @@
 namespace voltdb
 {
     class Pool;
+    class CompactingStringStorage;
 
     /// An object to use in lieu of raw char* pointers for strings
     /// which are not inlined into tuple storage.  This provides a
@@ -33,13 +34,16 @@ namespace voltdb
     {
     public:
         friend class CompactingStringPool;
+        friend class CompactingStringStorage;
         /// Create and return a new StringRef object which points to an
         /// allocated memory block of the requested size.  The caller
         /// may provide an optional Pool from which the memory (and
         /// the memory for the StringRef object itself) will be
         /// allocated, intended for temporary strings.  If no Pool
         /// object is provided, the StringRef and the string memory will be
-        /// allocated out of the ThreadLocalPool.
+        /// allocated out of the string pool of the ThreadLocalPool, which
+        /// is the storage of the persistent table copying strings into its
+        /// tuples, or from the heap when there is none.
         static StringRef* create(std::size_t size,
                                  Pool* dataPool = NULL);
 
@@ -47,7 +51,8 @@ namespace voltdb
         /// any, allocated from pools to store the object.
         /// sref must have been allocated and returned by a call to
         /// StringRef::create() and must not have been created in a
-        /// temporary Pool
+        /// temporary Pool. The memory goes back to where it came from,
+        /// whichever thread or table is current.
         static void destroy(StringRef* sref);
 
         char* get();
@@ -56,6 +61,7 @@ namespace voltdb
     private:
         StringRef(std::size_t size);
         StringRef(std::size_t size, Pool* dataPool);
+        StringRef(std::size_t length, CompactingStringStorage* storage, char* stringPtr);
         ~StringRef();
 
         /// Callback used via the back-pointer in order to update the
@@ -66,6 +72,8 @@ namespace voltdb
 
         std::size_t m_size;
         bool m_tempPool;
+        // the storage of the string, NULL for heap and temp Pool strings
+        CompactingStringStorage* m_storage;
         char* m_stringPtr;
     };
 }
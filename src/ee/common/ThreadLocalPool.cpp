@@ -0,0 +1,67 @@
+/* Copyright (C) 2014 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "ThreadLocalPool.h"
+
+#include <pthread.h>
+
+/**
+ * Thread local key for storing the string pool of the current thread.
+ */
+static pthread_key_t m_stringPoolKey;
+static pthread_once_t m_stringPoolKeyOnce = PTHREAD_ONCE_INIT;
+
+namespace voltdb {
+
+static void createThreadLocalKey() {
+    (void)pthread_key_create(&m_stringPoolKey, NULL);
+}
+
+CompactingStringStorage* ThreadLocalPool::getStringPool() {
+#ifdef MEMCHECK
+    // strings stay on the heap so that valgrind can track them
+    return NULL;
+#else
+    (void)pthread_once(&m_stringPoolKeyOnce, createThreadLocalKey);
+    return static_cast<CompactingStringStorage*>(pthread_getspecific(m_stringPoolKey));
+#endif
+}
+
+void ThreadLocalPool::setStringPool(CompactingStringStorage *storage) {
+    (void)pthread_once(&m_stringPoolKeyOnce, createThreadLocalKey);
+    pthread_setspecific(m_stringPoolKey, static_cast<const void *>(storage));
+}
+
+ThreadLocalPool::Scope::Scope(CompactingStringStorage *storage)
+    : m_previous(ThreadLocalPool::getStringPool())
+{
+    ThreadLocalPool::setStringPool(storage);
+}
+
+ThreadLocalPool::Scope::~Scope() {
+    ThreadLocalPool::setStringPool(m_previous);
+}
+
+}
@@ -20,49 +20,39 @@
 
 #include "CompactingStringStorage.h"
 
-#include "boost/pool/pool.hpp"
-#include "boost/shared_ptr.hpp"
-
 namespace voltdb {
 
-struct voltdb_pool_allocator_new_delete
-{
-  typedef std::size_t size_type;
-  typedef std::ptrdiff_t difference_type;
-
-  static char * malloc(const size_type bytes);
-  static void free(char * const block);
-};
-
 /**
- * A wrapper around a set of pools that are local to the current thread.
- * An instance of the thread local pool must be maintained somewhere in the thread to ensure initialization
- * and destruction of the thread local pools. Creating multiple instances is fine, it is reference counted. The thread local
- * instance of pools will be freed once the last ThreadLocalPool reference in the thread is destructed.
+ * Pools that are local to the current thread. The string pool is where
+ * StringRef::create() takes uninlined strings from when it is given no
+ * temp Pool. It is only set while a persistent table copies strings into
+ * its tuples, through a Scope, so that the strings land in the table's
+ * own storage; otherwise strings come from the heap.
  */
 class ThreadLocalPool {
 public:
-    ThreadLocalPool();
-    ~ThreadLocalPool();
-
-    static void initialize();
+    class Scope;
+    friend class Scope;
 
     /**
-     * Retrieve a pool that allocates approximately sized chunks of memory. Provides pools that
-     * are powers of two and powers of two + the previous power of two.
+     * Makes a string storage the string pool of the current thread until
+     * the end of the scope. Scopes nest, and a NULL storage sends strings
+     * to the heap within an outer scope.
      */
-    static boost::shared_ptr<boost::pool<voltdb_pool_allocator_new_delete> > get(std::size_t size);
-
-    /**
-     * Retrieve a pool that allocate chunks that are exactly the requested size. Only creates
-     * pools up to 1 megabyte + 4 bytes.
-     */
-    static boost::shared_ptr<boost::pool<voltdb_pool_allocator_new_delete> > getExact(std::size_t size);
-
-    static std::size_t getPoolAllocationSize();
+    class Scope {
+    public:
+        explicit Scope(CompactingStringStorage *storage);
+        ~Scope();
+    private:
+        Scope(Scope const&);
+        Scope& operator=(Scope const&);
+        CompactingStringStorage *m_previous;
+    };
 
     static CompactingStringStorage* getStringPool();
 
+private:
+    static void setStringPool(CompactingStringStorage *storage);
 };
 }
 
@@ -41,6 +41,14 @@ namespace voltdb
          */
         void clear();
 
+        /**
+         * True if no undo quantum is outstanding, i.e. no transaction
+         * can roll back to tuple addresses it has seen.
+         */
+        inline bool isEmpty() const {
+            return m_undoQuantums.empty();
+        }
+
         inline UndoQuantum* generateUndoQuantum(int64_t nextUndoToken) {
             VOLT_TRACE("Generating token %ld / lastUndo:%ld / lastRelease:%ld / undoQuantums:%ld",
                        (long int)nextUndoToken, (long int)m_lastUndoToken, (long int)m_lastReleaseToken, (long int)m_undoQuantums.size());
@@ -20,12 +20,15 @@
 
 #include "Topend.h"
 #include "common/UndoQuantum.h"
+#include "common/BlockAllocator.h"
+#include "common/MMAPMemoryManager.h"
 #include "storage/ReadWriteTracker.h"
 
 #ifdef ANTICACHE
 #include "anticache/AntiCacheDB.h"
 #include "anticache/BerkeleyAntiCacheDB.h"
 #include "anticache/NVMAntiCacheDB.h"
+#include "anticache/LogAntiCacheDB.h"
 #include "anticache/AntiCacheEvictionManager.h"
 #include "execution/VoltDBEngine.h"
 #define MAX_LEVELS 5
@@ -119,6 +122,10 @@ namespace voltdb {
         inline int64_t getMMAPSyncFrequency() const {
             return (m_MMAPSyncFrequency);
         }
+
+        inline MMAPAccessPattern getMMAPAccessPattern() const {
+            return (m_MMAPAccessPattern);
+        }
         #endif
 
         inline std::string getDBDir() const {
@@ -131,6 +138,11 @@ namespace voltdb {
             return (m_MMAPEnabled);
         }
 
+        /** The allocator of the tuple blocks of this partition's tables */
+        inline BlockAllocator* getBlockAllocator() {
+            return (&m_blockAllocator);
+        }
+
         //----------------------------------------------------------------------
 
         // not always known at initial construction
@@ -267,6 +279,8 @@ namespace voltdb {
             } else if (dbType == ANTICACHEDB_NVM) {
                 m_antiCacheDB[m_levels] = new NVMAntiCacheDB(this, dbDir, blockSize, maxSize);
                 //m_antiCacheEvictionManager->addAntiCacheDB(new NVMAntiCacheDB(this, dbDir, blockSize, maxSize));
+            } else if (dbType == ANTICACHEDB_LOG) {
+                m_antiCacheDB[m_levels] = new LogAntiCacheDB(this, dbDir, blockSize, maxSize);
             } else {
                 VOLT_ERROR("Invalid AntiCacheDBType: %d! Aborting...", (int)dbType);
                 assert(m_antiCacheEnabled == false);
@@ -287,13 +301,16 @@ namespace voltdb {
         /**
          * Enable the mmap storage feature in the EE.
          * The input parameter is the directory where our disk-based storage
-         * will write out mmap'ed files for this partition
+         * will write out mmap'ed files for this partition. The files grow
+         * in segments of mapSize bytes.
          */
-        void enableMMAP(std::string &dbDir, long mapSize, uint64_t syncFrequency) {
+        void enableMMAP(std::string &dbDir, long mapSize, uint64_t syncFrequency,
+                        MMAPAccessPattern accessPattern = MMAP_ACCESS_NORMAL) {
             assert(m_MMAPEnabled == false);
             m_MMAPDir = dbDir;
             m_MMAPSize = mapSize;
             m_MMAPSyncFrequency = syncFrequency;
+            m_MMAPAccessPattern = accessPattern;
 
             m_MMAPEnabled = true;
         }
@@ -362,6 +379,7 @@ namespace voltdb {
         #ifdef STORAGE_MMAP
         long m_MMAPSize;
         int64_t m_MMAPSyncFrequency;
+        MMAPAccessPattern m_MMAPAccessPattern;
         #endif
 
         #ifdef ARIES
@@ -372,6 +390,8 @@ namespace voltdb {
         bool m_trackingEnabled;
         ReadWriteTrackerManager *m_trackingManager;
 
+        BlockAllocator m_blockAllocator;
+
     public:
         int64_t m_lastCommittedTxnId;
         int64_t m_lastTickTime;
@@ -84,10 +84,20 @@ namespace voltdb {
  |  flags (1 byte)  |  time stamp (4 bytes) | tuple data  |
  ----------------------------------------------------------
 
+ (e). Anti-Caching with CLOCK (the reference bit is one of the flags)
+ -----------------------------------
+ |  flags (1 byte)  |  tuple data  |
+ -----------------------------------
+
  */
 
 #ifdef ANTICACHE
-    #ifdef ANTICACHE_TIMESTAMPS
+    #if defined(ANTICACHE_CLOCK) && defined(ANTICACHE_TIMESTAMPS)
+        #error "ANTICACHE_CLOCK and ANTICACHE_TIMESTAMPS cannot be used together"
+    #endif
+    #ifdef ANTICACHE_CLOCK
+        #define TUPLE_HEADER_SIZE 1
+    #elif defined(ANTICACHE_TIMESTAMPS)
     	#define TUPLE_HEADER_SIZE 5
 	#else
     	#ifdef ANTICACHE_REVERSIBLE_LRU
@@ -104,6 +114,7 @@ namespace voltdb {
 #define DIRTY_MASK 2
 #define MIGRATED_MASK 4
 #define EVICTED_MASK 8
+#define REFERENCED_MASK 16
 
 class TableColumn;
 
@@ -113,6 +124,7 @@ class TableTuple {
     friend class TempTable;
     friend class EvictedTable;
     friend class PersistentTable;
+    friend class MMAP_PersistentTable;
     friend class PersistentTableUndoDeleteAction;
     friend class PersistentTableUndoUpdateAction;
     friend class CopyOnWriteIterator;
@@ -291,7 +303,20 @@ public:
     }
     
 #ifdef ANTICACHE
-	#ifndef ANTICACHE_TIMESTAMPS
+	#ifdef ANTICACHE_CLOCK
+        inline bool isReferenced() const {
+            return (*(reinterpret_cast<const char*> (m_data)) & REFERENCED_MASK) == 0 ? false : true;
+        }
+
+        inline void setReferencedTrue() {
+            *(reinterpret_cast<char*> (m_data)) |= static_cast<char>(REFERENCED_MASK);
+        }
+
+        inline void setReferencedFalse() {
+            *(reinterpret_cast<char*> (m_data)) &= static_cast<char>(~REFERENCED_MASK);
+        }
+
+	#elif !defined(ANTICACHE_TIMESTAMPS)
     	inline uint32_t getNextTupleInChain() {
         	uint32_t tuple_id = 0;
 	        memcpy(&tuple_id, m_data+TUPLE_HEADER_SIZE-4, 4);
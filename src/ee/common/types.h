@@ -361,7 +361,29 @@ enum AntiCacheDBType {
     /*
      * NVM file-based store
      */
-    ANTICACHEDB_NVM = 2
+    ANTICACHEDB_NVM = 2,
+    /*
+     * Log-structured segment files written with O_DIRECT
+     */
+    ANTICACHEDB_LOG = 3
+};
+
+// -----------------------------------------------------------------
+// AntiCacheDB Block Codecs
+// -----------------------------------------------------------------
+enum AntiCacheCodecType {
+    /*
+     * Blocks are stored as serialized
+     */
+    ANTICACHE_CODEC_NONE = 0,
+    /*
+     * LZ77 compression of every block on its own
+     */
+    ANTICACHE_CODEC_LZ = 1,
+    /*
+     * LZ77 compression with a dictionary trained on the first block of a table
+     */
+    ANTICACHE_CODEC_LZ_DICT = 2
 };
 
 // ------------------------------------------------------------------
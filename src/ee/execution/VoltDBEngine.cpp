@@ -95,6 +95,7 @@
 #include "indexes/tableindex.h"
 #include "storage/constraintutil.h"
 #include "storage/persistenttable.h"
+#include "storage/mmap_persistenttable.h"
 #include "storage/MaterializedViewMetadata.h"
 #include "storage/StreamBlock.h"
 #include "storage/TableCatalogDelegate.hpp"
@@ -142,6 +143,8 @@ VoltDBEngine::VoltDBEngine(Topend *topend, LogProxy *logProxy) :
 
     m_ariesWriteOffset = 0;
     m_isRecovering = false;
+    m_MMAPUnsyncedCommits = 0;
+    m_MMAPLastCommit = -1;
     // m_logManager.setAriesProxyEngine(this);
 }
 
@@ -191,6 +194,11 @@ VoltDBEngine::~VoltDBEngine() {
         delete m_currentUndoQuantum;
     }
 
+#ifdef STORAGE_MMAP
+    // a clean shutdown leaves the files of the tables ready to reattach
+    checkpointMMAPTables();
+#endif
+
     // Clear the undo log before deleting the persistent tables so
     // that the persistent table schema are still around so we can
     // actually find the memory that has been allocated to non-inlined
@@ -570,6 +578,10 @@ bool VoltDBEngine::loadCatalog(const string &catalogPayload) {
         return false;
     }
 
+#ifdef STORAGE_MMAP
+    reattachMMAPTables();
+#endif
+
     // load up all the materialized views
     initMaterializedViews(true);
 
@@ -817,6 +829,29 @@ bool VoltDBEngine::rebuildTableCollections() {
             m_tables[catTable->relativeIndex()] = tcd->getTable();
             m_tablesByName[tcd->getTable()->name()] = tcd->getTable();
 
+            if (m_paxTableNames.count(tcd->getTable()->name()) > 0) {
+                PersistentTable *persistentTable = dynamic_cast<PersistentTable*>(tcd->getTable());
+                if (persistentTable != NULL) {
+                    persistentTable->setPaxLayout(true);
+                }
+            }
+
+            if (m_blockCopyOnWriteTableNames.count(tcd->getTable()->name()) > 0) {
+                PersistentTable *persistentTable = dynamic_cast<PersistentTable*>(tcd->getTable());
+                if (persistentTable != NULL) {
+                    persistentTable->setCopyOnWriteMode(COPY_ON_WRITE_BLOCKS);
+                }
+            }
+
+            std::map<std::string, std::vector<std::string> >::const_iterator zoneMapColumns =
+                m_zoneMapColumns.find(tcd->getTable()->name());
+            if (zoneMapColumns != m_zoneMapColumns.end()) {
+                PersistentTable *persistentTable = dynamic_cast<PersistentTable*>(tcd->getTable());
+                if (persistentTable != NULL) {
+                    persistentTable->setZoneMapColumns(zoneMapColumns->second);
+                }
+            }
+
             getStatsManager().registerStatsSource(
                     STATISTICS_SELECTOR_TYPE_TABLE, catTable->relativeIndex(),
                     tcd->getTable()->getTableStats());
@@ -1168,6 +1203,26 @@ void VoltDBEngine::tick(int64_t timeInMillis, int64_t lastCommittedTxnId) {
     BOOST_FOREACH (TablePair table, m_exportingTables){
     table.second->flushOldTuples(timeInMillis);
 }
+
+    // use the idle time to advance incremental index merges
+    typedef pair<int32_t, Table*> TableIdPair;
+    BOOST_FOREACH (TableIdPair table, m_tables) {
+        vector<TableIndex*> indexes = table.second->allIndexes();
+        for (int i = 0; i < indexes.size(); ++i) {
+            indexes[i]->mergeStep(timeInMillis);
+        }
+    }
+
+    // and to give back the blocks emptied by deletes, as long as no
+    // transaction can roll back to the tuples' current addresses
+    if (m_undoLog.isEmpty()) {
+        BOOST_FOREACH (TableIdPair table, m_tables) {
+            PersistentTable *persistentTable = dynamic_cast<PersistentTable*>(table.second);
+            if (persistentTable != NULL) {
+                persistentTable->compact(COMPACTION_TUPLES_PER_TICK);
+            }
+        }
+    }
 }
 
 /** For now, bring the Export system to a steady state with no buffers with content */
@@ -2031,6 +2086,26 @@ void VoltDBEngine::antiCacheAddDB(std::string dbDir, AntiCacheDBType dbType, boo
     m_executorContext->addAntiCacheDB(dbDir, blockSize, dbType, blocking, maxSize, blockMerge);
 }
 
+void VoltDBEngine::antiCacheAsyncEvictionInitialize(int maxPendingBlocks) const {
+    VOLT_INFO("Writing evicted blocks in the background at Partition %d: maxPendingBlocks=%d",
+            m_partitionId, maxPendingBlocks);
+    m_executorContext->getAntiCacheEvictionManager()->setAsyncEviction(maxPendingBlocks);
+}
+
+void VoltDBEngine::antiCacheAsyncReadInitialize(int numThreads) const {
+    VOLT_INFO("Fetching evicted blocks in batches at Partition %d: numThreads=%d",
+            m_partitionId, numThreads);
+    m_executorContext->getAntiCacheEvictionManager()->setAsyncUneviction(numThreads);
+}
+
+void VoltDBEngine::antiCacheCodecInitialize(AntiCacheCodecType codec) const {
+    VOLT_INFO("Compressing evicted blocks at Partition %d: codec=%d", m_partitionId, codec);
+    AntiCacheEvictionManager *eviction_manager = m_executorContext->getAntiCacheEvictionManager();
+    for (int i = 0; i < eviction_manager->getNumAntiCacheDBs(); i++) {
+        eviction_manager->getAntiCacheDB(i)->setCodec(codec);
+    }
+}
+
 int VoltDBEngine::antiCacheReadBlocks(int32_t tableId, int numBlocks, int32_t blockIds[], int32_t tupleOffsets[]) {
     int retval = ENGINE_ERRORCODE_SUCCESS;
 
@@ -2059,22 +2134,34 @@ int VoltDBEngine::antiCacheReadBlocks(int32_t tableId, int numBlocks, int32_t bl
     AntiCacheEvictionManager* eviction_manager = m_executorContext->getAntiCacheEvictionManager();
     //std::map <int32_t, set <int32_t> > filter;
     try {
-        for (int i = 0; i < numBlocks; i++) {
-            VOLT_TRACE("inengine: %d", i);
-            /*
-            if (filter.find(blockIds[i]) != filter.end())
-                if (filter[blockIds[i]].find(tupleOffsets[i]) != filter[blockIds[i]].end()) {
-                    VOLT_WARN("skipping %d %d", blockIds[i], tupleOffsets[i]);
-                    continue;
-                }
-
-            (filter[blockIds[i]]).insert(tupleOffsets[i]);
-            */
-            VOLT_DEBUG("reading %d %d", blockIds[i], tupleOffsets[i]);
+        if (eviction_manager->getBlockReader() != NULL) {
+            // all the blocks are fetched in one batch
             pthread_mutex_lock(&(eviction_manager->lock));
-            finalResult = eviction_manager->readEvictedBlock(table, blockIds[i], tupleOffsets[i]) && finalResult;
+            try {
+                finalResult = eviction_manager->readEvictedBlocks(table, numBlocks, blockIds, tupleOffsets);
+            } catch (...) {
+                pthread_mutex_unlock(&(eviction_manager->lock));
+                throw;
+            }
             pthread_mutex_unlock(&(eviction_manager->lock));
-        } // FOR
+        } else {
+            for (int i = 0; i < numBlocks; i++) {
+                VOLT_TRACE("inengine: %d", i);
+                /*
+                if (filter.find(blockIds[i]) != filter.end())
+                    if (filter[blockIds[i]].find(tupleOffsets[i]) != filter[blockIds[i]].end()) {
+                        VOLT_WARN("skipping %d %d", blockIds[i], tupleOffsets[i]);
+                        continue;
+                    }
+
+                (filter[blockIds[i]]).insert(tupleOffsets[i]);
+                */
+                VOLT_DEBUG("reading %d %d", blockIds[i], tupleOffsets[i]);
+                pthread_mutex_lock(&(eviction_manager->lock));
+                finalResult = eviction_manager->readEvictedBlock(table, blockIds[i], tupleOffsets[i]) && finalResult;
+                pthread_mutex_unlock(&(eviction_manager->lock));
+            } // FOR
+        }
 
     } catch (SerializableEEException &e) {
         VOLT_ERROR("antiCacheReadBlocks: Failed to read %d evicted blocks for table '%s'\n%s",
@@ -2189,26 +2276,169 @@ void VoltDBEngine::antiCacheResetEvictedTupleTracker() {
 }
 
 #else
-void VoltDBEngine::antiCacheInitialize(std::string dbDir, AntiCacheDBType dbType,
-        long blockSize, long maxSize) const {
+void VoltDBEngine::antiCacheInitialize(std::string dbDir, AntiCacheDBType dbType, bool blocking,
+        long blockSize, long maxSize, bool blockMerge) const {
     // FIX :: Dummy call if ANTICACHE is not defined
     //VOLT_ERROR("Anti-Cache feature was not enable when compiling the EE");
 }
 #endif
 
+// -------------------------------------------------
+// STORAGE BLOCK FUNCTIONS
+// -------------------------------------------------
+
+void VoltDBEngine::blockAllocatorInitialize(bool hugePages, bool numaBind, int cacheBlocks) {
+    VOLT_INFO("Configuring tuple blocks at Partition %d: hugePages=%d / numaBind=%d / cacheBlocks=%d",
+            m_partitionId, hugePages, numaBind, cacheBlocks);
+    m_executorContext->getBlockAllocator()->configure(hugePages, numaBind, cacheBlocks);
+}
+
+void VoltDBEngine::paxTablesInitialize(std::string tableNames) {
+    VOLT_INFO("Tables with the PAX layout at Partition %d: %s", m_partitionId, tableNames.c_str());
+    std::stringstream names(tableNames);
+    std::string name;
+    while (std::getline(names, name, ',')) {
+        if (!name.empty()) {
+            m_paxTableNames.insert(name);
+        }
+    }
+}
+
+void VoltDBEngine::zoneMapsInitialize(std::string columnNames) {
+    VOLT_INFO("Columns with zone maps at Partition %d: %s", m_partitionId, columnNames.c_str());
+    std::stringstream names(columnNames);
+    std::string name;
+    while (std::getline(names, name, ',')) {
+        const size_t dot = name.find('.');
+        if (dot == std::string::npos || dot == 0 || dot + 1 == name.size()) {
+            VOLT_WARN("Ignoring zone map column '%s', expected TABLE.COLUMN", name.c_str());
+            continue;
+        }
+        m_zoneMapColumns[name.substr(0, dot)].push_back(name.substr(dot + 1));
+    }
+}
+
+void VoltDBEngine::blockCopyOnWriteTablesInitialize(std::string tableNames) {
+    VOLT_INFO("Tables with block copy on write snapshots at Partition %d: %s", m_partitionId, tableNames.c_str());
+    std::stringstream names(tableNames);
+    std::string name;
+    while (std::getline(names, name, ',')) {
+        if (!name.empty()) {
+            m_blockCopyOnWriteTableNames.insert(name);
+        }
+    }
+}
+
 // -------------------------------------------------
 // STORAGE MMAP FUNCTIONS
 // -------------------------------------------------
 
 #ifdef STORAGE_MMAP
-void VoltDBEngine::MMAPInitialize(std::string dbDir, long mapSize, long syncFrequency) const {
-    VOLT_INFO("Enabling Storage MMAP Feature at Partition %d: dir=%s / blockSize=%ld / syncFrequency=%ld ",
-            m_partitionId, dbDir.c_str(), mapSize, syncFrequency);
-    m_executorContext->enableMMAP(dbDir, mapSize, syncFrequency);
+void VoltDBEngine::MMAPInitialize(std::string dbDir, long mapSize, long syncFrequency,
+        std::string accessPattern) {
+    MMAPAccessPattern pattern = MMAP_ACCESS_NORMAL;
+    if (accessPattern == "SEQUENTIAL") {
+        pattern = MMAP_ACCESS_SEQUENTIAL;
+    } else if (accessPattern == "RANDOM") {
+        pattern = MMAP_ACCESS_RANDOM;
+    } else if (!accessPattern.empty() && accessPattern != "NORMAL") {
+        VOLT_WARN("Unknown MMAP access pattern '%s', using NORMAL", accessPattern.c_str());
+    }
+
+    VOLT_INFO("Enabling Storage MMAP Feature at Partition %d: dir=%s / segmentSize=%ld / syncFrequency=%ld / access=%s",
+            m_partitionId, dbDir.c_str(), mapSize, syncFrequency, accessPattern.c_str());
+    m_executorContext->enableMMAP(dbDir, mapSize, syncFrequency, pattern);
+}
+
+/*
+ * Group commit : every syncFrequency commits the mmap'ed files of all
+ * tables are handed to the background syncer, which batches the writes
+ * of the commits that come in while it is busy. When no transaction is
+ * outstanding, the files of the tables are checkpointed as of the commit
+ * once they are synced, so that a restart can reattach them.
+ */
+void VoltDBEngine::syncMMAPTablesOnCommit(int64_t undoToken) {
+    m_MMAPLastCommit = undoToken;
+    if (!m_executorContext->isMMAPEnabled() ||
+        ++m_MMAPUnsyncedCommits < m_executorContext->getMMAPSyncFrequency()) {
+        return;
+    }
+    VOLT_DEBUG("Syncing MMAP tables at undo token: %ld", undoToken);
+    m_MMAPUnsyncedCommits = 0;
+    const bool committed = m_undoLog.isEmpty();
+
+    for (std::map<int32_t, Table*>::iterator m_tables_itr = m_tables.begin() ; m_tables_itr != m_tables.end() ; ++m_tables_itr){
+        Table* table = m_tables_itr->second;
+        if (table == NULL)
+            continue;
+
+        MMAP_PersistentTable* mmapTable = dynamic_cast<MMAP_PersistentTable*>(table);
+        if (mmapTable != NULL && committed) {
+            mmapTable->requestCheckpoint(undoToken);
+        } else {
+            MMAPMemoryManager* m_data_manager = table->getDataManager();
+            if(m_data_manager != NULL)
+                m_data_manager->syncInBackground();
+        }
+
+        Pool* pool = table->getPool();
+        if(pool != NULL && pool->getPoolManager() != NULL)
+            pool->getPoolManager()->syncInBackground();
+    }
+}
+
+/*
+ * Reattaches the files of the tables of the previous run, if every table
+ * that left tuples behind has a checkpoint. Otherwise the tables are left
+ * empty, to be loaded through recovery, as mixing reattached tables with
+ * replayed ones would not be consistent. With ARIES the whole log is
+ * replayed on startup, so the tables have to start out empty.
+ */
+void VoltDBEngine::reattachMMAPTables() {
+    if (!m_executorContext->isMMAPEnabled()) {
+        return;
+    }
+    if (isARIESEnabled()) {
+        VOLT_INFO("Not reattaching MMAP tables at partition %d: the ARIES log is replayed instead",
+                  m_partitionId);
+        return;
+    }
+    std::vector<MMAP_PersistentTable*> tables;
+    for (std::map<int32_t, Table*>::iterator m_tables_itr = m_tables.begin() ; m_tables_itr != m_tables.end() ; ++m_tables_itr){
+        MMAP_PersistentTable* table = dynamic_cast<MMAP_PersistentTable*>(m_tables_itr->second);
+        if (table == NULL || !table->hasDataFile())
+            continue;
+        if (!table->canReattach()) {
+            VOLT_INFO("Not reattaching MMAP tables at partition %d: table %s has no usable checkpoint",
+                      m_partitionId, table->name().c_str());
+            return;
+        }
+        tables.push_back(table);
+    }
+
+    for (size_t i = 0; i < tables.size(); i++) {
+        if (!tables[i]->reattach()) {
+            throwFatalException("Failed to reattach MMAP table %s", tables[i]->name().c_str());
+        }
+        VOLT_INFO("Reattached MMAP table %s at partition %d with %d tuples from epoch %ld",
+                  tables[i]->name().c_str(), m_partitionId, (int)tables[i]->activeTupleCount(),
+                  (long)tables[i]->getCheckpointEpoch());
+    }
+}
+
+void VoltDBEngine::checkpointMMAPTables() {
+    if (!m_executorContext->isMMAPEnabled() || !m_undoLog.isEmpty()) {
+        return;
+    }
+    for (std::map<int32_t, Table*>::iterator m_tables_itr = m_tables.begin() ; m_tables_itr != m_tables.end() ; ++m_tables_itr){
+        MMAP_PersistentTable* table = dynamic_cast<MMAP_PersistentTable*>(m_tables_itr->second);
+        if (table != NULL)
+            table->checkpoint(m_MMAPLastCommit);
+    }
 }
 #else
 void VoltDBEngine::MMAPInitialize(std::string dbDir, long blockSize,
-        long syncFrequency) const {
+        long syncFrequency, std::string accessPattern) {
     VOLT_ERROR("Storage MMAP feature was not enabled when compiling the EE");
 }
 #endif
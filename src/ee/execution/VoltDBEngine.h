@@ -83,6 +83,7 @@
 
 #define MAX_BATCH_COUNT 1000
 #define MAX_PARAM_COUNT 1000 // or whatever
+#define COMPACTION_TUPLES_PER_TICK 10000 // per table
 
 namespace boost {
 template <typename T> class shared_ptr;
@@ -299,6 +300,9 @@ class __attribute__((visibility("default"))) VoltDBEngine {
 
         #ifdef ANTICACHE
         void antiCacheAddDB(std::string dbDir, AntiCacheDBType dbType, bool blocking, long blockSize, long maxSize, bool blockMerge) const;
+        void antiCacheAsyncEvictionInitialize(int maxPendingBlocks) const;
+        void antiCacheAsyncReadInitialize(int numThreads) const;
+        void antiCacheCodecInitialize(AntiCacheCodecType codec) const;
 
         int antiCacheReadBlocks(int32_t tableId, int numBlocks, int32_t blockIds[], int32_t tupleOffsets[]);
         int antiCacheEvictBlock(int32_t tableId, long blockSize, int numBlocks);
@@ -307,10 +311,19 @@ class __attribute__((visibility("default"))) VoltDBEngine {
         void antiCacheResetEvictedTupleTracker();
         #endif
 
+        // -------------------------------------------------
+        // STORAGE BLOCKS
+        // -------------------------------------------------
+        void blockAllocatorInitialize(bool hugePages, bool numaBind, int cacheBlocks);
+        void paxTablesInitialize(std::string tableNames);
+        void zoneMapsInitialize(std::string columnNames);
+        void blockCopyOnWriteTablesInitialize(std::string tableNames);
+
         // -------------------------------------------------
         // STORAGE MMAP
         // -------------------------------------------------
-        void MMAPInitialize(std::string dbDir, long mapSize, long syncFrequency ) const;
+        void MMAPInitialize(std::string dbDir, long mapSize, long syncFrequency,
+                            std::string accessPattern);
 
 
         // ARIES
@@ -407,6 +420,11 @@ class __attribute__((visibility("default"))) VoltDBEngine {
         }
 
         inline void releaseUndoToken(int64_t undoToken);
+#ifdef STORAGE_MMAP
+        void syncMMAPTablesOnCommit(int64_t undoToken);
+        void reattachMMAPTables();
+        void checkpointMMAPTables();
+#endif
 
         inline void undoUndoToken(int64_t undoToken) {
             if (m_currentUndoQuantum != NULL && m_currentUndoQuantum->isDummy()) {
@@ -556,6 +574,25 @@ class __attribute__((visibility("default"))) VoltDBEngine {
          */
         std::map<int32_t, Table*> m_snapshottingTables;
 
+        /*
+         * Names of the persistent tables that keep column minipages of
+         * their blocks. Applied whenever the table collections are rebuilt.
+         */
+        std::set<std::string> m_paxTableNames;
+
+        /*
+         * The columns of each persistent table that keep per-block min/max
+         * summaries. Applied whenever the table collections are rebuilt.
+         */
+        std::map<std::string, std::vector<std::string> > m_zoneMapColumns;
+
+        /*
+         * Names of the persistent tables whose snapshots copy whole blocks
+         * on their first write. Applied whenever the table collections are
+         * rebuilt.
+         */
+        std::set<std::string> m_blockCopyOnWriteTableNames;
+
         /*
          * Map of catalog ids to exporting tables.
          */
@@ -610,6 +647,9 @@ class __attribute__((visibility("default"))) VoltDBEngine {
 
         bool m_isRecovering;    // are we currently recovering?
 
+        int64_t m_MMAPUnsyncedCommits;  // commits since the last background msync
+        int64_t m_MMAPLastCommit;       // undo token of the last commit, the checkpoint epoch
+
         int64_t m_batchFragmentIdsContainer[MAX_BATCH_COUNT];
         /** PAVLO **/
         int32_t m_batchInputDepIdsContainer[MAX_BATCH_COUNT];
@@ -686,41 +726,16 @@ void VoltDBEngine::releaseUndoToken(int64_t undoToken){
     return;
   }
 
-#ifdef STORAGE_MMAP
-  if(m_executorContext->isMMAPEnabled()){    
-      for (std::map<int32_t, Table*>::iterator m_tables_itr = m_tables.begin() ; m_tables_itr != m_tables.end() ; ++m_tables_itr){
-          Table* table = m_tables_itr->second;
-
-          // Fix Group Commit Interval       
-          int64_t m_groupCommitInterval = m_executorContext->getMMAPSyncFrequency() ;
-          VOLT_WARN("Sync Frequency: %ld", m_groupCommitInterval);
-
-          if(m_currentUndoQuantum != NULL && m_currentUndoQuantum->getUndoToken() % m_groupCommitInterval == 0){
-              VOLT_WARN("Undo Token: %ld", m_currentUndoQuantum->getUndoToken());
-
-              if(table != NULL){
-                  //VOLT_WARN("Syncing Table %s",table->name().c_str());      
-                  /*Pool* pool = table->getPool();
-                  if(pool != NULL)
-                      MMAPMemoryManager* m_pool_manager = pool->getPoolManager();
-                  if(m_pool_manager != NULL)
-                      m_pool_manager->sync();*/
-
-                  MMAPMemoryManager* m_data_manager = table->getDataManager();
-                  if(m_data_manager != NULL)
-                      m_data_manager->sync();
-              }
-          }
-      }
-  }
-#endif
-
   if (m_currentUndoQuantum != NULL && m_currentUndoQuantum->getUndoToken() == undoToken) {
       m_currentUndoQuantum = NULL;    
   }
 
   VOLT_TRACE("Committing Buffer Token %ld at partition %d", undoToken, m_partitionId);
   m_undoLog.release(undoToken);
+
+#ifdef STORAGE_MMAP
+  syncMMAPTablesOnCommit(undoToken);
+#endif
 }
 
 
@@ -134,6 +134,9 @@ bool AbstractExecutor::init(VoltDBEngine *engine, const catalog::Database* catal
     }
     Table *tmp_output_table_base = abstract_node->getOutputTable();
     this->tmp_output_table = dynamic_cast<TempTable*>(tmp_output_table_base);
+    if (this->tmp_output_table) {
+        this->tmp_output_table->setBlockAllocator(executor_context->getBlockAllocator());
+    }
 
     // determines whether the output table should be cleared or not.
     // specific executor might not need (and must not do) clearing.
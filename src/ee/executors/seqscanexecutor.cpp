@@ -58,6 +58,9 @@
 #include "storage/temptable.h"
 #include "storage/tablefactory.h"
 #include "storage/tableiterator.h"
+#include "storage/PaxScanIterator.h"
+#include "storage/ZoneMapScanIterator.h"
+#include "boost/scoped_ptr.hpp"
 
 #ifdef ANTICACHE
 #include "anticache/AntiCacheEvictionManager.h"
@@ -212,9 +215,31 @@ bool SeqScanExecutor::p_execute(const NValueArray &params, ReadWriteTracker *tra
                        predicate->debug(true).c_str());
         }
 
+        // OPTIMIZATION: PAX LAYOUT
+        // If the table keeps column minipages, the predicate is evaluated
+        // by a scan over the minipages and only the matching tuples come
+        // out of it. Read/write set tracking has to see every tuple.
+        //
+        // OPTIMIZATION: ZONE MAPS
+        // Otherwise, if the table keeps per-block min/max summaries, the
+        // blocks that cannot hold a match are skipped and the predicate is
+        // evaluated on the tuples of the others.
+        boost::scoped_ptr<TupleIterator> blockIterator;
+        bool predicateApplied = false;
+        if (predicate != NULL && tracker == NULL) {
+            if (target_table->paxMinipages() != NULL) {
+                blockIterator.reset(new PaxScanIterator(target_table, predicate));
+                predicateApplied = true;
+            } else if (target_table->zoneMaps() != NULL) {
+                blockIterator.reset(new ZoneMapScanIterator(target_table, predicate));
+            }
+        }
+
         int tuple_ctr = 0;
-        while (iterator.next(tuple)) {
-            target_table->updateTupleAccessCount();
+        while (blockIterator ? blockIterator->next(tuple) : iterator.next(tuple)) {
+            if (!predicateApplied) {
+                target_table->updateTupleAccessCount();
+            }
             
             // Read/Write Set Tracking
             if (tracker != NULL) {
@@ -232,7 +257,7 @@ bool SeqScanExecutor::p_execute(const NValueArray &params, ReadWriteTracker *tra
             //
             // For each tuple we need to evaluate it against our predicate
             //
-            if (predicate == NULL || predicate->eval(&tuple, NULL).isTrue()) {
+            if (predicateApplied || predicate == NULL || predicate->eval(&tuple, NULL).isTrue()) {
                 //
                 // Nested Projection
                 // Project (or replace) values from input tuple
@@ -47,6 +47,7 @@
 #define BINARYTREEMULTIMAPINDEX_H_
 
 #include <map>
+#include <algorithm>
 #include <iostream>
 #include "indexes/tableindex.h"
 #include "common/tabletuple.h"
@@ -87,6 +88,20 @@ public:
         return addEntryPrivate(tuple, m_tmp1);
     }
 
+    size_t addEntries(const std::vector<TableTuple> &tuples)
+    {
+        // sort the batch once, the skip list is then built in key order
+        std::vector<std::pair<KeyType, const void*> > entries;
+        entries.reserve(tuples.size());
+        for (std::vector<TableTuple>::const_iterator i = tuples.begin(); i != tuples.end(); ++i) {
+            m_tmp1.setFromTuple(&*i, column_indices_, m_keySchema);
+            entries.push_back(std::pair<KeyType, const void*>(m_tmp1, i->address()));
+        }
+        std::stable_sort(entries.begin(), entries.end(), m_entries->value_comp());
+        m_inserts += static_cast<int>(entries.size());
+        return m_entries->insert_sorted(entries.begin(), entries.end());
+    }
+
     bool deleteEntry(const TableTuple *tuple)
     {
         m_tmp1.setFromTuple(tuple, column_indices_, m_keySchema);
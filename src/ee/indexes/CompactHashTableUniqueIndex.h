@@ -0,0 +1,227 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2010 VoltDB Inc.
+ *
+ * This file contains original code and/or modifications of original code.
+ * Any modifications made by VoltDB Inc. are licensed under the following
+ * terms and conditions:
+ *
+ * VoltDB is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * VoltDB is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Copyright (C) 2008 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef COMPACTHASHTABLEUNIQUEINDEX_H_
+#define COMPACTHASHTABLEUNIQUEINDEX_H_
+
+#include <iostream>
+#include "slp/hash_map_compact.h"
+#include "indexes/tableindex.h"
+
+namespace voltdb {
+
+/**
+ * Index implemented as a dual-stage Hash Table Unique Map: a small
+ * boost::unordered_map in front of a dense static hash table that is
+ * rebuilt when the merge policy of the index says so.
+ * @see TableIndex
+ */
+template<typename KeyType, class KeyHasher, class KeyEqualityChecker>
+class CompactHashTableUniqueIndex : public TableIndex {
+    friend class TableIndexFactory;
+
+    typedef h_index::AllocatorTracker<pair<const KeyType, const void*> > AllocatorType;
+    typedef cmu::hash_map_compact<KeyType, const void*, KeyHasher, KeyEqualityChecker, AllocatorType> MapType;
+
+public:
+
+    ~CompactHashTableUniqueIndex() {
+        delete m_entries;
+        delete m_allocator;
+    };
+
+    bool addEntry(const TableTuple *tuple) {
+        m_tmp1.setFromTuple(tuple, column_indices_, m_keySchema);
+        return addEntryPrivate(tuple, m_tmp1);
+    }
+
+    size_t addEntries(const std::vector<TableTuple> &tuples) {
+        // a large batch becomes the static stage in one rebuild
+        std::vector<std::pair<KeyType, const void*> > entries;
+        entries.reserve(tuples.size());
+        for (std::vector<TableTuple>::const_iterator i = tuples.begin(); i != tuples.end(); ++i) {
+            m_tmp1.setFromTuple(&*i, column_indices_, m_keySchema);
+            entries.push_back(std::pair<KeyType, const void*>(m_tmp1, i->address()));
+        }
+        m_inserts += static_cast<int>(entries.size());
+        return m_entries->insert_bulk(entries.begin(), entries.end());
+    }
+
+    bool deleteEntry(const TableTuple *tuple) {
+        m_tmp1.setFromTuple(tuple, column_indices_, m_keySchema);
+        return deleteEntryPrivate(m_tmp1);
+    }
+
+    bool replaceEntry(const TableTuple *oldTupleValue, const TableTuple* newTupleValue) {
+        // this can probably be optimized
+        m_tmp1.setFromTuple(oldTupleValue, column_indices_, m_keySchema);
+        m_tmp2.setFromTuple(newTupleValue, column_indices_, m_keySchema);
+
+        if (m_eq(m_tmp1, m_tmp2)) return true; // no update is needed for this index
+
+        bool deleted = deleteEntryPrivate(m_tmp1);
+        bool inserted = addEntryPrivate(newTupleValue, m_tmp2);
+        --m_deletes;
+        --m_inserts;
+        ++m_updates;
+        return (deleted && inserted);
+    }
+
+    bool setEntryToNewAddress(const TableTuple *tuple, const void* address, const void *oldAddress) {
+        // set the key from the tuple
+        m_tmp1.setFromTuple(tuple, column_indices_, m_keySchema);
+        ++m_updates;
+
+        // a static entry is only marked deleted, the new one goes to the dynamic stage
+        bool deleted = m_entries->erase_one(m_tmp1);
+        bool inserted = m_entries->insert(m_tmp1, address);
+        return (inserted & deleted);
+    }
+
+    bool checkForIndexChange(const TableTuple *lhs, const TableTuple *rhs) {
+        m_tmp1.setFromTuple(lhs, column_indices_, m_keySchema);
+        m_tmp2.setFromTuple(rhs, column_indices_, m_keySchema);
+        return !(m_eq(m_tmp1, m_tmp2));
+    }
+    bool exists(const TableTuple* values) {
+        ++m_lookups;
+        m_tmp1.setFromTuple(values, column_indices_, m_keySchema);
+        return m_entries->exists(m_tmp1);
+    }
+    bool moveToKey(const TableTuple *searchKey) {
+        m_tmp1.setFromKey(searchKey);
+        return moveToKey(m_tmp1);
+    }
+    bool moveToTuple(const TableTuple *searchTuple) {
+        m_tmp1.setFromTuple(searchTuple, column_indices_, m_keySchema);
+        return moveToKey(m_tmp1);
+    }
+    TableTuple nextValueAtKey() {
+        TableTuple retval = m_match;
+        m_match.move(NULL);
+        return retval;
+    }
+
+    virtual void ensureCapacity(uint32_t capacity) {
+        m_entries->reserve(capacity);
+    }
+
+    bool mergeStep(int64_t timeInMillis) {
+        if (m_entries->merge_due(static_cast<uint64_t>(timeInMillis))) {
+            m_entries->merge_dtos();
+        }
+        return false;
+    }
+
+    std::string getMergePolicyDescription() const {
+        return IndexMergePolicy::debug(m_entries->get_merge_policy());
+    }
+
+    int64_t getMergeCount() const {
+        return static_cast<int64_t>(m_entries->merge_count());
+    }
+
+    size_t getSize() const { return m_entries->size(); }
+    int64_t getMemoryEstimate() const {
+        // both stages allocate through the tracker
+        return m_memoryEstimate;
+    }
+    std::string getTypeName() const { return "CompactHashTableUniqueIndex"; };
+
+    // print out info about lookup usage
+    virtual void printReport() {
+        std::cout << "  Loadfactor: " << m_entries->load_factor() << std::endl;
+        std::cout << "  Static: " << m_entries->static_size() << " entries, "
+                  << m_entries->static_memory_size() << " bytes" << std::endl;
+    }
+
+protected:
+    CompactHashTableUniqueIndex(const TableIndexScheme &scheme) :
+        TableIndex(scheme),
+        m_eq(m_keySchema)
+    {
+        m_match = TableTuple(m_tupleSchema);
+
+        m_allocator = new AllocatorType(&m_memoryEstimate);
+        m_entries = new MapType(KeyHasher(m_keySchema), KeyEqualityChecker(m_keySchema), *m_allocator);
+        m_entries->set_merge_policy(scheme.mergePolicy.skipListPolicy(0));
+    }
+
+    inline bool addEntryPrivate(const TableTuple *tuple, const KeyType &key) {
+        ++m_inserts;
+        return m_entries->insert(key, tuple->address());
+    }
+
+    inline bool deleteEntryPrivate(const KeyType &key) {
+        ++m_deletes;
+        return m_entries->erase_one(key);
+    }
+
+    bool moveToKey(const KeyType &key) {
+        ++m_lookups;
+        typename MapType::const_range range = m_entries->find(key);
+        if (range.is_end()) {
+            m_match.move(NULL);
+            return false;
+        }
+        m_match.move(const_cast<void*>(range.data()));
+        return m_match.address() != NULL;
+    }
+
+    MapType *m_entries;
+    AllocatorType *m_allocator;
+    KeyType m_tmp1;
+    KeyType m_tmp2;
+
+    // iteration stuff
+    TableTuple m_match;
+
+    // comparison stuff
+    KeyEqualityChecker m_eq;
+};
+
+}
+
+#endif // COMPACTHASHTABLEUNIQUEINDEX_H_
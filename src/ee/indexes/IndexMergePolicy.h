@@ -0,0 +1,83 @@
+/* Copyright (C) 2014 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef HSTOREINDEXMERGEPOLICY_H
+#define HSTOREINDEXMERGEPOLICY_H
+
+#include <string>
+#include <sstream>
+#include <stdint.h>
+#include "slp/skiplist_merge_policy.h"
+
+namespace voltdb {
+
+/**
+ * When a compact (two-stage) index merges its dynamic stage into its
+ * static stage, as set on the catalog Index. Zero fields keep the
+ * defaults of the index structure.
+ */
+struct IndexMergePolicy {
+    IndexMergePolicy()
+        : ratio(0), threshold(0), memoryKB(0), intervalMillis(0),
+          bloomBits(0), bloomHashes(0) {}
+
+    int32_t ratio;          // -1 disables the ratio trigger
+    int32_t threshold;
+    int32_t memoryKB;
+    int32_t intervalMillis;
+    int32_t bloomBits;
+    int32_t bloomHashes;
+
+    /**
+     * The skip list policy for this index, merging incrementally
+     * mergeStep leaf nodes at a time.
+     */
+    cmu::merge_policy skipListPolicy(size_t mergeStep) const {
+        cmu::merge_policy policy;
+        if (ratio != 0) policy.ratio = ratio > 0 ? static_cast<size_t>(ratio) : 0;
+        if (threshold > 0) policy.threshold = static_cast<size_t>(threshold);
+        if (memoryKB > 0) policy.memory_budget = static_cast<size_t>(memoryKB) * 1024;
+        if (intervalMillis > 0) policy.interval_ms = static_cast<uint64_t>(intervalMillis);
+        if (bloomBits > 0) policy.bits_per_key = static_cast<size_t>(bloomBits);
+        if (bloomHashes > 0) policy.k = static_cast<size_t>(bloomHashes);
+        policy.step = mergeStep;
+        return policy;
+    }
+
+    static std::string debug(const cmu::merge_policy &policy) {
+        std::ostringstream buffer;
+        buffer << "ratio=" << policy.ratio
+               << " threshold=" << policy.threshold
+               << " memory=" << (policy.memory_budget / 1024) << "KB"
+               << " interval=" << policy.interval_ms << "ms"
+               << " step=" << policy.step
+               << " bloom=" << policy.bits_per_key << "x" << policy.k;
+        return buffer.str();
+    }
+};
+
+}
+
+#endif
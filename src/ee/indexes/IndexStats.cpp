@@ -38,6 +38,11 @@ vector<string> IndexStats::generateIndexStatsColumnNames() {
     columnNames.push_back("IS_UNIQUE");
     columnNames.push_back("ENTRY_COUNT");
     columnNames.push_back("MEMORY_ESTIMATE");
+    columnNames.push_back("MERGE_POLICY");
+    columnNames.push_back("MERGE_COUNT");
+    columnNames.push_back("BLOOM_SKIPS");
+    columnNames.push_back("BLOOM_HITS");
+    columnNames.push_back("BLOOM_FALSE_POSITIVES");
 
     return columnNames;
 }
@@ -77,6 +82,31 @@ void IndexStats::populateIndexStatsSchema(
     types.push_back(VALUE_TYPE_INTEGER);
     columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER));
     allowNull.push_back(false);
+
+    // merge policy
+    types.push_back(VALUE_TYPE_VARCHAR);
+    columnLengths.push_back(4096);
+    allowNull.push_back(false);
+
+    // merge count
+    types.push_back(VALUE_TYPE_BIGINT);
+    columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+    allowNull.push_back(false);
+
+    // bloom filter skips
+    types.push_back(VALUE_TYPE_BIGINT);
+    columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+    allowNull.push_back(false);
+
+    // bloom filter hits
+    types.push_back(VALUE_TYPE_BIGINT);
+    columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+    allowNull.push_back(false);
+
+    // bloom filter false positives
+    types.push_back(VALUE_TYPE_BIGINT);
+    columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+    allowNull.push_back(false);
 }
 
 Table*
@@ -110,7 +140,8 @@ IndexStats::generateEmptyIndexStatsTable()
  */
 IndexStats::IndexStats(TableIndex* index)
     : StatsSource(), m_index(index), m_isUnique(0),
-      m_lastTupleCount(0), m_lastMemEstimate(0)
+      m_lastTupleCount(0), m_lastMemEstimate(0), m_lastMergeCount(0),
+      m_lastBloomSkips(0), m_lastBloomHits(0), m_lastBloomFalsePositives(0)
 {
 }
 
@@ -138,6 +169,7 @@ void IndexStats::configure(
     m_tableName = ValueFactory::getStringValue(tableName);
     m_indexType = ValueFactory::getStringValue(m_index->getTypeName());
     m_isUnique = static_cast<int8_t>(m_index->isUniqueIndex() ? 1 : 0);
+    m_mergePolicy = ValueFactory::getStringValue(m_index->getMergePolicyDescription());
 }
 
 /**
@@ -159,6 +191,10 @@ void IndexStats::updateStatsTuple(TableTuple *tuple) {
     tuple->setNValue( StatsSource::m_columnName2Index["INDEX_TYPE"], m_indexType);
     int64_t count = static_cast<int64_t>(m_index->getSize());
     int64_t mem_estimate_kb = m_index->getMemoryEstimate() / 1024;
+    int64_t merges = m_index->getMergeCount();
+    int64_t bloomSkips = m_index->getBloomFilterSkips();
+    int64_t bloomHits = m_index->getBloomFilterHits();
+    int64_t bloomFalsePositives = m_index->getBloomFilterFalsePositives();
 
     // round up the memory estimate so it won't get zero when really small
     if (mem_estimate_kb * 1024 < m_index->getMemoryEstimate()) mem_estimate_kb++;
@@ -168,6 +204,14 @@ void IndexStats::updateStatsTuple(TableTuple *tuple) {
         m_lastTupleCount = static_cast<int64_t>(m_index->getSize());
         mem_estimate_kb = mem_estimate_kb - (m_lastMemEstimate / 1024);
         m_lastMemEstimate = m_index->getMemoryEstimate();
+        merges = merges - m_lastMergeCount;
+        m_lastMergeCount = m_index->getMergeCount();
+        bloomSkips = bloomSkips - m_lastBloomSkips;
+        m_lastBloomSkips = m_index->getBloomFilterSkips();
+        bloomHits = bloomHits - m_lastBloomHits;
+        m_lastBloomHits = m_index->getBloomFilterHits();
+        bloomFalsePositives = bloomFalsePositives - m_lastBloomFalsePositives;
+        m_lastBloomFalsePositives = m_index->getBloomFilterFalsePositives();
     }
 
     if (mem_estimate_kb > INT32_MAX)
@@ -183,6 +227,15 @@ void IndexStats::updateStatsTuple(TableTuple *tuple) {
     tuple->setNValue(StatsSource::m_columnName2Index["MEMORY_ESTIMATE"],
                      ValueFactory::
                      getIntegerValue(static_cast<int32_t>(mem_estimate_kb)));
+    tuple->setNValue(StatsSource::m_columnName2Index["MERGE_POLICY"], m_mergePolicy);
+    tuple->setNValue(StatsSource::m_columnName2Index["MERGE_COUNT"],
+                     ValueFactory::getBigIntValue(merges));
+    tuple->setNValue(StatsSource::m_columnName2Index["BLOOM_SKIPS"],
+                     ValueFactory::getBigIntValue(bloomSkips));
+    tuple->setNValue(StatsSource::m_columnName2Index["BLOOM_HITS"],
+                     ValueFactory::getBigIntValue(bloomHits));
+    tuple->setNValue(StatsSource::m_columnName2Index["BLOOM_FALSE_POSITIVES"],
+                     ValueFactory::getBigIntValue(bloomFalsePositives));
 }
 
 /**
@@ -201,4 +254,5 @@ IndexStats::~IndexStats() {
     m_indexName.free();
     m_indexType.free();
     m_tableName.free();
+    m_mergePolicy.free();
 }
@@ -104,11 +104,16 @@ private:
     voltdb::NValue m_indexName;
     voltdb::NValue m_tableName;
     voltdb::NValue m_indexType;
+    voltdb::NValue m_mergePolicy;
 
     int8_t m_isUnique;
 
     int64_t m_lastTupleCount;
     int64_t m_lastMemEstimate;
+    int64_t m_lastMergeCount;
+    int64_t m_lastBloomSkips;
+    int64_t m_lastBloomHits;
+    int64_t m_lastBloomFalsePositives;
 };
 
 }
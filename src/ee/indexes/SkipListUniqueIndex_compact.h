@@ -48,11 +48,17 @@
 
 //#include <map>
 #include "slp/skiplist_map_compact.h"
+#include <algorithm>
 #include <iostream>
 #include "common/debuglog.h"
 #include "common/tabletuple.h"
 #include "indexes/tableindex.h"
 
+// leaf nodes of the static stage rebuilt per insert while a merge is running
+#define INDEX_MERGE_STEP 4
+// leaf nodes of the static stage rebuilt per VoltDBEngine::tick()
+#define INDEX_IDLE_MERGE_STEP 1024
+
 namespace voltdb {
 
 /**
@@ -81,6 +87,21 @@ public:
         return addEntryPrivate(tuple, m_tmp1);
     }
 
+    size_t addEntries(const std::vector<TableTuple> &tuples)
+    {
+        // sort the batch once, it then becomes the static stage together
+        // with the entries already there in one pass
+        std::vector<std::pair<KeyType, const void*> > entries;
+        entries.reserve(tuples.size());
+        for (std::vector<TableTuple>::const_iterator i = tuples.begin(); i != tuples.end(); ++i) {
+            m_tmp1.setFromTuple(&*i, column_indices_, m_keySchema);
+            entries.push_back(std::pair<KeyType, const void*>(m_tmp1, i->address()));
+        }
+        std::stable_sort(entries.begin(), entries.end(), m_entries->value_comp());
+        m_inserts += static_cast<int>(entries.size());
+        return m_entries->insert_sorted(entries.begin(), entries.end());
+    }
+
     bool deleteEntry(const TableTuple* tuple)
     {
         m_tmp1.setFromTuple(tuple, column_indices_, m_keySchema);
@@ -129,7 +150,7 @@ public:
     {
         ++m_lookups;
         m_tmp1.setFromTuple(values, column_indices_, m_keySchema);
-        return (m_entries->find(m_tmp1) != m_entries->end());
+        return m_entries->exists(m_tmp1);
     }
 
     bool moveToKey(const TableTuple* searchKey)
@@ -241,6 +262,39 @@ public:
         return !m_match.isNullTuple();
     }
 
+    bool mergeStep(int64_t timeInMillis)
+    {
+        if (m_entries->merge_due(static_cast<uint64_t>(timeInMillis))) {
+            m_entries->merge_begin();
+        }
+        return m_entries->merge_step(INDEX_IDLE_MERGE_STEP);
+    }
+
+    std::string getMergePolicyDescription() const
+    {
+        return IndexMergePolicy::debug(m_entries->get_merge_policy());
+    }
+
+    int64_t getMergeCount() const
+    {
+        return static_cast<int64_t>(m_entries->merge_count());
+    }
+
+    int64_t getBloomFilterSkips() const
+    {
+        return static_cast<int64_t>(m_entries->bloomfilter_skips());
+    }
+
+    int64_t getBloomFilterHits() const
+    {
+        return static_cast<int64_t>(m_entries->bloomfilter_hits());
+    }
+
+    int64_t getBloomFilterFalsePositives() const
+    {
+        return static_cast<int64_t>(m_entries->bloomfilter_false_positives());
+    }
+
     size_t getSize() const { return m_entries->size(); }
     int64_t getMemoryEstimate() const {
         /** Debug code
@@ -281,6 +335,7 @@ protected:
         m_match = TableTuple(m_tupleSchema);
         m_allocator = new AllocatorType(&m_memoryEstimate);
         m_entries = new MapType(KeyComparator(m_keySchema), (*m_allocator));
+        m_entries->set_merge_policy(scheme.mergePolicy.skipListPolicy(INDEX_MERGE_STEP));
     }
 
     inline bool addEntryPrivate(const TableTuple* tuple, const KeyType &key)
@@ -0,0 +1,341 @@
+/* This file is part of VoltDB.
+ * Copyright (C) 2008-2010 VoltDB Inc.
+ *
+ * This file contains original code and/or modifications of original code.
+ * Any modifications made by VoltDB Inc. are licensed under the following
+ * terms and conditions:
+ *
+ * VoltDB is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * VoltDB is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with VoltDB.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* Copyright (C) 2008 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include "indexes/indexkey.h"
+#include "common/StringRef.h"
+
+using namespace voltdb;
+
+namespace {
+
+inline uint64_t hashWord(uint64_t h, uint64_t w) {
+    h = (h ^ w) * 0x9e3779b97f4a7c15ULL;
+    return h ^ (h >> 32);
+}
+
+inline uint64_t hashBytes(uint64_t h, const char *data, size_t length) {
+    const char *limit = data + length;
+    while (data + 8 <= limit) {
+        uint64_t w;
+        ::memcpy(&w, data, sizeof(w));
+        h = hashWord(h, w);
+        data += 8;
+    }
+    if (data < limit) {
+        uint64_t w = 0;
+        ::memcpy(&w, data, static_cast<size_t>(limit - data));
+        h = hashWord(h, w);
+    }
+    return h;
+}
+
+/*
+ * The length preceded storage of a string or varbinary, as NValue writes
+ * it: NULL if the value is null, otherwise the value bytes and their
+ * length.
+ */
+inline const char *objectValue(const char *location, int32_t &length) {
+    if (location == NULL || (location[0] & OBJECT_NULL_BIT) != 0) {
+        length = 0;
+        return NULL;
+    }
+    if ((location[0] & OBJECT_CONTINUATION_BIT) != 0) {
+        length = static_cast<int32_t>(((static_cast<uint32_t>(location[0]) & 0x3f) << 24) |
+                                      (static_cast<uint32_t>(static_cast<unsigned char>(location[1])) << 16) |
+                                      (static_cast<uint32_t>(static_cast<unsigned char>(location[2])) << 8) |
+                                      static_cast<uint32_t>(static_cast<unsigned char>(location[3])));
+        return location + LONG_OBJECT_LENGTHLENGTH;
+    }
+    length = location[0] & OBJECT_MAX_LENGTH_SHORT_LENGTH;
+    return location + SHORT_OBJECT_LENGTHLENGTH;
+}
+
+inline const char *refLocation(const char *slot) {
+    const StringRef *sref;
+    ::memcpy(&sref, slot, sizeof(sref));
+    return sref == NULL ? NULL : sref->get();
+}
+
+/*
+ * Orders two fixed-size values the way NValue::compare() does: equal,
+ * greater or else less, so that a NaN double is less than anything.
+ */
+template <typename T>
+inline int compareSlots(const char *lslot, const char *rslot) {
+    T lvalue, rvalue;
+    ::memcpy(static_cast<void*>(&lvalue), lslot, sizeof(T));
+    ::memcpy(static_cast<void*>(&rvalue), rslot, sizeof(T));
+    if (lvalue == rvalue) {
+        return 0;
+    }
+    return lvalue > rvalue ? 1 : -1;
+}
+
+// NValue compares varchars with strncmp, so only the bytes up to a NUL count
+inline size_t varcharHashLength(const char *value, int32_t length) {
+    const void *nul = ::memchr(value, 0, static_cast<size_t>(length));
+    return nul == NULL ? static_cast<size_t>(length) : static_cast<size_t>(static_cast<const char*>(nul) - value);
+}
+
+}
+
+GenericKeyPlan::GenericKeyPlan(const TupleSchema *keySchema, int columnCount) {
+    const int schemaColumnCount = keySchema->columnCount();
+    if (columnCount < 0 || columnCount > schemaColumnCount) {
+        columnCount = schemaColumnCount;
+    }
+    for (int i = 0; i < columnCount; i++) {
+        Step step;
+        step.offset = keySchema->columnOffset(i);
+        step.length = (i + 1 < schemaColumnCount ? keySchema->columnOffset(i + 1) : keySchema->tupleLength()) - step.offset;
+        const bool inlined = keySchema->columnIsInlined(i);
+        switch (keySchema->columnType(i)) {
+          case VALUE_TYPE_TINYINT:
+            step.type = STEP_TINYINT;
+            break;
+          case VALUE_TYPE_SMALLINT:
+            step.type = STEP_SMALLINT;
+            break;
+          case VALUE_TYPE_INTEGER:
+            step.type = STEP_INTEGER;
+            break;
+          case VALUE_TYPE_BIGINT:
+          case VALUE_TYPE_TIMESTAMP:
+            step.type = STEP_BIGINT;
+            break;
+          case VALUE_TYPE_DECIMAL:
+            step.type = STEP_DECIMAL;
+            break;
+          case VALUE_TYPE_DOUBLE:
+            step.type = STEP_DOUBLE;
+            break;
+          case VALUE_TYPE_VARCHAR:
+            step.type = inlined ? STEP_INLINED_VARCHAR : STEP_VARCHAR_REF;
+            break;
+          case VALUE_TYPE_VARBINARY:
+            step.type = inlined ? STEP_INLINED_VARBINARY : STEP_VARBINARY_REF;
+            break;
+          default:
+            throwFatalException("Unsupported GenericKey column type %d", static_cast<int>(keySchema->columnType(i)));
+        }
+        m_columns.push_back(step);
+
+        // equal integers and decimals have equal bytes
+        if (step.type == STEP_TINYINT || step.type == STEP_SMALLINT || step.type == STEP_INTEGER ||
+            step.type == STEP_BIGINT || step.type == STEP_DECIMAL) {
+            step.type = STEP_BYTES;
+        }
+        if (step.type == STEP_BYTES && !m_steps.empty() && m_steps.back().type == STEP_BYTES &&
+            m_steps.back().offset + m_steps.back().length == step.offset) {
+            m_steps.back().length += step.length;
+        } else {
+            m_steps.push_back(step);
+        }
+    }
+}
+
+uint64_t GenericKeyPlan::hash(const char *key) const {
+    uint64_t h = 0;
+    for (std::vector<Step>::const_iterator step = m_steps.begin(); step != m_steps.end(); ++step) {
+        const char *slot = key + step->offset;
+        switch (step->type) {
+          case STEP_BYTES:
+          case STEP_TINYINT:
+          case STEP_SMALLINT:
+          case STEP_INTEGER:
+          case STEP_BIGINT:
+          case STEP_DECIMAL:
+            h = hashBytes(h, slot, step->length);
+            break;
+          case STEP_DOUBLE: {
+            double value;
+            ::memcpy(&value, slot, sizeof(value));
+            if (value == 0.0) {
+                value = 0.0;    // -0.0 equals 0.0
+            }
+            h = hashBytes(h, reinterpret_cast<const char*>(&value), sizeof(value));
+            break;
+          }
+          case STEP_INLINED_VARCHAR:
+          case STEP_VARCHAR_REF: {
+            int32_t length;
+            const char *value = objectValue(step->type == STEP_VARCHAR_REF ? refLocation(slot) : slot, length);
+            if (value == NULL) {
+                h = hashWord(h, ~0ULL);
+            } else {
+                h = hashWord(h, static_cast<uint64_t>(length));
+                h = hashBytes(h, value, varcharHashLength(value, length));
+            }
+            break;
+          }
+          case STEP_INLINED_VARBINARY:
+          case STEP_VARBINARY_REF: {
+            int32_t length;
+            const char *value = objectValue(step->type == STEP_VARBINARY_REF ? refLocation(slot) : slot, length);
+            if (value == NULL) {
+                h = hashWord(h, ~0ULL);
+            } else {
+                h = hashWord(h, static_cast<uint64_t>(length));
+                h = hashBytes(h, value, static_cast<size_t>(length));
+            }
+            break;
+          }
+        }
+    }
+    return cmu::bloom_mix64(h);
+}
+
+bool GenericKeyPlan::equals(const char *lhs, const char *rhs) const {
+    for (std::vector<Step>::const_iterator step = m_steps.begin(); step != m_steps.end(); ++step) {
+        const char *lslot = lhs + step->offset;
+        const char *rslot = rhs + step->offset;
+        switch (step->type) {
+          case STEP_BYTES:
+          case STEP_TINYINT:
+          case STEP_SMALLINT:
+          case STEP_INTEGER:
+          case STEP_BIGINT:
+          case STEP_DECIMAL:
+            if (::memcmp(lslot, rslot, step->length) != 0) {
+                return false;
+            }
+            break;
+          case STEP_DOUBLE: {
+            double lvalue, rvalue;
+            ::memcpy(&lvalue, lslot, sizeof(lvalue));
+            ::memcpy(&rvalue, rslot, sizeof(rvalue));
+            if (!(lvalue == rvalue)) {
+                return false;
+            }
+            break;
+          }
+          case STEP_INLINED_VARCHAR:
+          case STEP_INLINED_VARBINARY:
+          case STEP_VARCHAR_REF:
+          case STEP_VARBINARY_REF: {
+            const bool ref = (step->type == STEP_VARCHAR_REF || step->type == STEP_VARBINARY_REF);
+            int32_t llength, rlength;
+            const char *lvalue = objectValue(ref ? refLocation(lslot) : lslot, llength);
+            const char *rvalue = objectValue(ref ? refLocation(rslot) : rslot, rlength);
+            if (lvalue == NULL || rvalue == NULL) {
+                if (lvalue != rvalue) {
+                    return false;
+                }
+            } else if (llength != rlength) {
+                return false;
+            } else if (step->type == STEP_INLINED_VARCHAR || step->type == STEP_VARCHAR_REF) {
+                if (::strncmp(lvalue, rvalue, static_cast<size_t>(llength)) != 0) {
+                    return false;
+                }
+            } else if (::memcmp(lvalue, rvalue, static_cast<size_t>(llength)) != 0) {
+                return false;
+            }
+            break;
+          }
+        }
+    }
+    return true;
+}
+
+int GenericKeyPlan::compare(const char *lhs, const char *rhs) const {
+    for (std::vector<Step>::const_iterator step = m_columns.begin(); step != m_columns.end(); ++step) {
+        const char *lslot = lhs + step->offset;
+        const char *rslot = rhs + step->offset;
+        int diff = 0;
+        switch (step->type) {
+          case STEP_TINYINT:
+            diff = compareSlots<int8_t>(lslot, rslot);
+            break;
+          case STEP_SMALLINT:
+            diff = compareSlots<int16_t>(lslot, rslot);
+            break;
+          case STEP_INTEGER:
+            diff = compareSlots<int32_t>(lslot, rslot);
+            break;
+          case STEP_BIGINT:
+            diff = compareSlots<int64_t>(lslot, rslot);
+            break;
+          case STEP_DECIMAL:
+            diff = compareSlots<TTInt>(lslot, rslot);
+            break;
+          case STEP_DOUBLE:
+            diff = compareSlots<double>(lslot, rslot);
+            break;
+          case STEP_BYTES:
+            diff = ::memcmp(lslot, rslot, step->length);
+            break;
+          case STEP_INLINED_VARCHAR:
+          case STEP_INLINED_VARBINARY:
+          case STEP_VARCHAR_REF:
+          case STEP_VARBINARY_REF: {
+            const bool ref = (step->type == STEP_VARCHAR_REF || step->type == STEP_VARBINARY_REF);
+            int32_t llength, rlength;
+            const char *lvalue = objectValue(ref ? refLocation(lslot) : lslot, llength);
+            const char *rvalue = objectValue(ref ? refLocation(rslot) : rslot, rlength);
+            if (lvalue == NULL || rvalue == NULL) {
+                // NULL sorts first
+                diff = (lvalue != NULL) - (rvalue != NULL);
+                break;
+            }
+            const size_t common = static_cast<size_t>(std::min(llength, rlength));
+            if (step->type == STEP_INLINED_VARCHAR || step->type == STEP_VARCHAR_REF) {
+                diff = ::strncmp(lvalue, rvalue, common);
+            } else {
+                diff = ::memcmp(lvalue, rvalue, common);
+            }
+            if (diff == 0) {
+                diff = (llength > rlength) - (llength < rlength);
+            }
+            break;
+          }
+        }
+        if (diff != 0) {
+            return diff;
+        }
+    }
+    return 0;
+}
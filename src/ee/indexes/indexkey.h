@@ -50,11 +50,15 @@
 #include "common/tabletuple.h"
 
 #include "boost/array.hpp"
+#include "boost/shared_ptr.hpp"
 #include "boost/unordered_map.hpp"
+#include "slp/bloomfilter.h"
+#include "slp/skiplist_map_packed.h"
 
 #include <cassert>
 #include <iostream>
 #include <sstream>
+#include <vector>
 
 namespace voltdb {
 
@@ -368,6 +372,54 @@ struct IntsHasher : std::unary_function<IntsKey<keySize>, std::size_t>
     }
 };
 
+/**
+ * The columns of a GenericKey as its key schema lays them out, compiled
+ * once per index. Hashing, equality and ordering read the key bytes
+ * column by column from the plan instead of wrapping the keys in
+ * TableTuples and going through NValue; for hashing and equality
+ * neighbouring integer columns are handled as one run of bytes. Only the
+ * bytes that hold the value count, so the padding after an inlined
+ * string and the address of an uninlined one do not change the hash.
+ */
+class GenericKeyPlan {
+public:
+    // plans the first columnCount columns of the key, all of them if -1
+    explicit GenericKeyPlan(const TupleSchema *keySchema, int columnCount = -1);
+
+    // 64-bit hash of the key data, consistent with equals()
+    uint64_t hash(const char *key) const;
+
+    // true if the keys are equal as NValue::compare() sees them
+    bool equals(const char *lhs, const char *rhs) const;
+
+    // <0, 0 or >0 as TableTuple::compare() orders the keys
+    int compare(const char *lhs, const char *rhs) const;
+
+private:
+    enum StepType {
+        STEP_BYTES,             // integers, timestamps and decimals
+        STEP_TINYINT,
+        STEP_SMALLINT,
+        STEP_INTEGER,
+        STEP_BIGINT,            // and timestamps
+        STEP_DECIMAL,
+        STEP_DOUBLE,
+        STEP_INLINED_VARCHAR,
+        STEP_INLINED_VARBINARY,
+        STEP_VARCHAR_REF,       // a StringRef*
+        STEP_VARBINARY_REF
+    };
+
+    struct Step {
+        StepType type;
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    std::vector<Step> m_steps;      // hash() and equals()
+    std::vector<Step> m_columns;    // compare(), one step per column
+};
+
 /**
  * Key object for indexes of mixed types.
  * Using TableTuple to store columns.
@@ -402,17 +454,14 @@ template <std::size_t keySize>
 class GenericComparator {
 public:
     /** Type information passed to the constuctor as it's not in the key itself */
-    GenericComparator(TupleSchema *keySchema) : m_schema(keySchema) {}
+    GenericComparator(TupleSchema *keySchema) : m_schema(keySchema), m_plan(new GenericKeyPlan(keySchema)) {}
 
     inline bool operator()(const GenericKey<keySize> &lhs, const GenericKey<keySize> &rhs) const {
-        TableTuple lhTuple(m_schema); lhTuple.moveToReadOnlyTuple(reinterpret_cast<const void*>(&lhs));
-        TableTuple rhTuple(m_schema); rhTuple.moveToReadOnlyTuple(reinterpret_cast<const void*>(&rhs));
-        // lexographical compare could be faster for fixed N
-        int diff = lhTuple.compare(rhTuple);
-        return diff < 0;
+        return m_plan->compare(lhs.data, rhs.data) < 0;
     }
 
     TupleSchema *m_schema;
+    boost::shared_ptr<const GenericKeyPlan> m_plan;
 };
 
 /**
@@ -422,34 +471,34 @@ template <std::size_t keySize>
 class GenericEqualityChecker {
 public:
     /** Type information passed to the constuctor as it's not in the key itself */
-    GenericEqualityChecker(TupleSchema *keySchema) : m_schema(keySchema) {}
+    GenericEqualityChecker(TupleSchema *keySchema) : m_schema(keySchema), m_plan(new GenericKeyPlan(keySchema)) {}
 
     inline bool operator()(const GenericKey<keySize> &lhs, const GenericKey<keySize> &rhs) const {
-        TableTuple lhTuple(m_schema); lhTuple.moveToReadOnlyTuple(reinterpret_cast<const void*>(&lhs));
-        TableTuple rhTuple(m_schema); rhTuple.moveToReadOnlyTuple(reinterpret_cast<const void*>(&rhs));
-        return lhTuple.equalsNoSchemaCheck(rhTuple);
+        return m_plan->equals(lhs.data, rhs.data);
     }
 
     TupleSchema *m_schema;
+    boost::shared_ptr<const GenericKeyPlan> m_plan;
 };
 
 /**
- * Hash function object for an array of SlimValues
+ * Hash function object for GenericKey, hashes the key bytes through the
+ * plan compiled from the key schema.
  */
 template <std::size_t keySize>
 struct GenericHasher : std::unary_function<GenericKey<keySize>, std::size_t>
 {
     /** Type information passed to the constuctor as it's not in the key itself */
-    GenericHasher(TupleSchema *keySchema) : m_schema(keySchema) {}
+    GenericHasher(TupleSchema *keySchema) : m_schema(keySchema), m_plan(new GenericKeyPlan(keySchema)) {}
 
     /** Generate a 64-bit number for the key value */
     inline size_t operator()(GenericKey<keySize> const &p) const
     {
-        TableTuple pTuple(m_schema); pTuple.moveToReadOnlyTuple(reinterpret_cast<const void*>(&p));
-        return pTuple.hashCode();
+        return static_cast<size_t>(m_plan->hash(p.data));
     }
 
     TupleSchema *m_schema;
+    boost::shared_ptr<const GenericKeyPlan> m_plan;
 };
 
 
@@ -595,5 +644,202 @@ public:
     TupleSchema *m_schema;
 };
 
+
+/*
+ * Number of leading key columns that fit whole into the first prefixSize
+ * bytes of a key-schema tuple.
+ */
+inline int prefixColumnCount(const TupleSchema *keySchema, std::size_t prefixSize) {
+    const int columnCount = keySchema->columnCount();
+    for (int ii = 0; ii < columnCount; ii++) {
+        const uint32_t end = ii + 1 < columnCount ? keySchema->columnOffset(ii + 1) : keySchema->tupleLength();
+        if (end > prefixSize) {
+            return ii;
+        }
+    }
+    return columnCount;
+}
+
+/**
+ * Key object for keys too wide for GenericKey. The leading key columns
+ * that fit into prefixSize bytes are copied inline, laid out as in a
+ * GenericKey, and the rest of the key is read from the tuple the key was
+ * set from, like TupleKey does, only when two keys tie on the prefix.
+ * An entry costs prefixSize plus three pointers instead of the whole key.
+ *
+ * Like the uninlined strings of a GenericKey, the entries reference the
+ * indexed tuples, which must stay in place while they are indexed.
+ */
+template <std::size_t prefixSize>
+class PrefixTupleKey {
+public:
+    inline PrefixTupleKey() : m_columnIndices(NULL), m_keyTuple(NULL), m_keyTupleSchema(NULL) {}
+
+    // Set a key from a key-schema tuple.
+    inline void setFromKey(const TableTuple *tuple) {
+        assert(tuple);
+        assert(tuple->getSchema()->tupleLength() >= prefixSize);
+        ::memcpy(prefix, tuple->address() + TUPLE_HEADER_SIZE, prefixSize);
+        m_columnIndices = NULL;
+        m_keyTuple = tuple->address();
+        m_keyTupleSchema = tuple->getSchema();
+    }
+
+    // Set a key from a table-schema tuple.
+    inline void setFromTuple(const TableTuple *tuple, const int *indices, const TupleSchema *keySchema) {
+        assert(tuple);
+        assert(indices);
+        TableTuple keyTuple(keySchema);
+        keyTuple.moveNoHeader(reinterpret_cast<void*>(prefix));
+        const int prefixColumns = prefixColumnCount(keySchema, prefixSize);
+        for (int ii = 0; ii < prefixColumns; ii++) {
+            keyTuple.setNValue(ii, tuple->getNValue(indices[ii]));
+        }
+        m_columnIndices = indices;
+        m_keyTuple = tuple->address();
+        m_keyTupleSchema = tuple->getSchema();
+    }
+
+    // The indexColumn'th key column, read from the tuple.
+    inline NValue getColumnValue(int indexColumn) const {
+        TableTuple keyTuple(m_keyTuple, m_keyTupleSchema);
+        return keyTuple.getNValue(m_columnIndices == NULL ? indexColumn : m_columnIndices[indexColumn]);
+    }
+
+    char prefix[prefixSize];
+
+  private:
+    // TableIndex owns this array - NULL if set from a key-schema tuple
+    const int *m_columnIndices;
+    char *m_keyTuple;
+    const TupleSchema *m_keyTupleSchema;
+};
+
+/**
+ * Orders PrefixTupleKeys through the plan of the prefix columns, and
+ * compares the other columns from the tuples on a tie.
+ */
+template <std::size_t prefixSize>
+class PrefixTupleKeyComparator {
+public:
+    PrefixTupleKeyComparator(TupleSchema *keySchema)
+        : m_schema(keySchema), m_prefixColumns(prefixColumnCount(keySchema, prefixSize)),
+          m_plan(new GenericKeyPlan(keySchema, m_prefixColumns)) {}
+
+    // <0, 0 or >0 as TableTuple::compare() orders the keys
+    inline int compare(const PrefixTupleKey<prefixSize> &lhs, const PrefixTupleKey<prefixSize> &rhs) const {
+        int diff = m_plan->compare(lhs.prefix, rhs.prefix);
+        for (int ii = m_prefixColumns; diff == 0 && ii < m_schema->columnCount(); ii++) {
+            diff = lhs.getColumnValue(ii).compare(rhs.getColumnValue(ii));
+        }
+        return diff;
+    }
+
+    inline bool operator()(const PrefixTupleKey<prefixSize> &lhs, const PrefixTupleKey<prefixSize> &rhs) const {
+        return compare(lhs, rhs) < 0;
+    }
+
+    TupleSchema *m_schema;
+    int m_prefixColumns;
+    boost::shared_ptr<const GenericKeyPlan> m_plan;
+};
+
+template <std::size_t prefixSize>
+class PrefixTupleKeyEqualityChecker {
+public:
+    PrefixTupleKeyEqualityChecker(TupleSchema *keySchema) : m_comparator(keySchema) {}
+
+    inline bool operator()(const PrefixTupleKey<prefixSize> &lhs, const PrefixTupleKey<prefixSize> &rhs) const {
+        return m_comparator.compare(lhs, rhs) == 0;
+    }
+
+    PrefixTupleKeyComparator<prefixSize> m_comparator;
+};
+
+}
+
+namespace cmu {
+
+/**
+ * Bloom filter hash for the dynamic stage of compact indexes on IntsKey.
+ * Mixes the packed uint64_t words directly instead of hashing the key
+ * byte by byte.
+ */
+template <std::size_t keySize>
+struct bloom_hash<voltdb::IntsKey<keySize> >
+{
+    inline uint64_t operator()(const voltdb::IntsKey<keySize> &key) const
+    {
+        uint64_t h = 0;
+        for (std::size_t ii = 0; ii < keySize; ii++) {
+            h = (h ^ key.data[ii]) * 0x9e3779b97f4a7c15ULL;
+        }
+        return bloom_mix64(h);
+    }
+};
+
+/**
+ * Bloom filter hash for the dynamic stage of compact indexes on
+ * GenericKey. The raw key bytes hold padding and StringRef addresses that
+ * differ between equal keys, so the key is hashed through the plan of its
+ * key schema instead.
+ */
+template <std::size_t keySize>
+struct bloom_key_hash<voltdb::GenericKey<keySize>, voltdb::GenericComparator<keySize> >
+{
+    explicit bloom_key_hash(const voltdb::GenericComparator<keySize> &comparator)
+        : m_plan(new voltdb::GenericKeyPlan(comparator.m_schema)) {}
+
+    inline uint64_t operator()(const voltdb::GenericKey<keySize> &key) const
+    {
+        return m_plan->hash(key.data);
+    }
+
+    boost::shared_ptr<const voltdb::GenericKeyPlan> m_plan;
+};
+
+/**
+ * Bloom filter hash for the dynamic stage of compact indexes on
+ * PrefixTupleKey, hashes the prefix columns only.
+ */
+template <std::size_t prefixSize>
+struct bloom_key_hash<voltdb::PrefixTupleKey<prefixSize>, voltdb::PrefixTupleKeyComparator<prefixSize> >
+{
+    explicit bloom_key_hash(const voltdb::PrefixTupleKeyComparator<prefixSize> &comparator)
+        : m_plan(comparator.m_plan) {}
+
+    inline uint64_t operator()(const voltdb::PrefixTupleKey<prefixSize> &key) const
+    {
+        return m_plan->hash(key.prefix);
+    }
+
+    boost::shared_ptr<const voltdb::GenericKeyPlan> m_plan;
+};
+
+/**
+ * Byte image of IntsKey in the packed static stage of compact indexes.
+ * The packed words are written most significant byte first, so that
+ * neighbouring keys share a long prefix to front code.
+ */
+template <std::size_t keySize>
+struct packed_key_codec<voltdb::IntsKey<keySize> >
+{
+    static const size_t size = keySize * sizeof(uint64_t);
+
+    static inline void encode(const voltdb::IntsKey<keySize> &key, unsigned char *bytes)
+    {
+        for (std::size_t ii = 0; ii < keySize; ii++) {
+            packed_store_be64(key.data[ii], bytes + ii * sizeof(uint64_t));
+        }
+    }
+
+    static inline void decode(const unsigned char *bytes, voltdb::IntsKey<keySize> &key)
+    {
+        for (std::size_t ii = 0; ii < keySize; ii++) {
+            key.data[ii] = packed_load_be64(bytes + ii * sizeof(uint64_t));
+        }
+    }
+};
+
 }
 #endif // INDEXKEY_H
@@ -55,6 +55,7 @@ TableIndex::TableIndex(const TableIndexScheme &scheme) : m_scheme(scheme), m_sta
     column_types_vector_ = scheme.columnTypes;
     colCount_ = (int)column_indices_vector_.size();
     is_unique_index_ = scheme.unique;
+    m_keysReferenceTuples = false;
     m_tupleSchema = scheme.tupleSchema;
     assert(column_types_vector_.size() == column_indices_vector_.size());
     column_indices_ = new int[colCount_];
@@ -83,6 +84,17 @@ TableIndex::~TableIndex()
     voltdb::TupleSchema::freeTupleSchema(m_keySchema);
 }
 
+size_t TableIndex::addEntries(const std::vector<TableTuple> &tuples)
+{
+    size_t added = 0;
+    for (std::vector<TableTuple>::const_iterator i = tuples.begin(); i != tuples.end(); ++i) {
+        if (addEntry(&*i)) {
+            added++;
+        }
+    }
+    return added;
+}
+
 IndexStats* TableIndex::getIndexStats() {
     return &m_stats;
 }
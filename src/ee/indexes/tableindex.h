@@ -56,6 +56,7 @@
 #include "common/tabletuple.h"
 #include "common/TupleSchema.h"
 #include "indexes/IndexStats.h"
+#include "indexes/IndexMergePolicy.h"
 #include "indexes/allocatortracker.h"
 
 namespace voltdb {
@@ -83,6 +84,7 @@ struct TableIndexScheme {
     bool intsOnly;
     TupleSchema *tupleSchema;
     TupleSchema *keySchema;
+    IndexMergePolicy mergePolicy;
 
 public:
     void setTree() {
@@ -132,6 +134,15 @@ public:
      */
     virtual bool addEntry(const TableTuple *tuple) = 0;
 
+    /**
+     * adds the entries of a batch of tuples, as addEntry() on each of
+     * them would. Indexes that keep their entries in key order or in a
+     * static stage build them from the whole batch at once, which is
+     * what table loads and recovery use. Returns the number of tuples
+     * added; a unique index skips those whose key it holds already.
+     */
+    virtual size_t addEntries(const std::vector<TableTuple> &tuples);
+
     /**
      * removes the index entry linked to given value (and tuple
      * pointer, if it's non-unique index).
@@ -280,6 +291,16 @@ public:
         return is_unique_index_;
     }
 
+    /**
+     * True if the entries of this index read part of their key from the
+     * indexed tuple instead of keeping a copy (keys too wide for
+     * GenericKey). Such an entry cannot be found once its tuple has been
+     * changed in place, so PersistentTable drops it before the change.
+     */
+    inline bool keysReferenceTuples() const {
+        return m_keysReferenceTuples;
+    }
+
     virtual size_t getSize() const = 0;
 
     // Return the amount of memory we think is allocated for this
@@ -311,6 +332,34 @@ public:
 
     virtual void ensureCapacity(uint32_t capacity) {}
 
+    /**
+     * Spend a bounded amount of work on a deferred merge of the index's
+     * internal stages, e.g. the static stage rebuild of compact indexes,
+     * and start the merges that are due by the time-based merge policy.
+     * Called from VoltDBEngine::tick() while the partition is idle.
+     *
+     * @return true if the merge still has work left.
+     */
+    virtual bool mergeStep(int64_t timeInMillis) { return false; }
+
+    /**
+     * The effective merge policy of compact indexes, empty for the
+     * indexes that have no internal stages.
+     */
+    virtual std::string getMergePolicyDescription() const { return ""; }
+
+    // number of merges of the internal stages done so far
+    virtual int64_t getMergeCount() const { return 0; }
+
+    /**
+     * Point lookups of compact indexes that the bloom filter over the
+     * dynamic stage kept out of that stage, that found the key there, and
+     * that searched it in vain (false positives of the filter).
+     */
+    virtual int64_t getBloomFilterSkips() const { return 0; }
+    virtual int64_t getBloomFilterHits() const { return 0; }
+    virtual int64_t getBloomFilterFalsePositives() const { return 0; }
+
     // print out info about lookup usage
     virtual void printReport();
 
@@ -334,6 +383,7 @@ protected:
     ValueType* column_types_;
     int colCount_;
     bool is_unique_index_;
+    bool m_keysReferenceTuples;
     int* column_indices_;
 
     // counters
@@ -55,6 +55,14 @@
 #include "indexes/BinaryTreeMultiMapIndex.h"
 #include "indexes/HashTableUniqueIndex.h"
 #include "indexes/HashTableMultiMapIndex.h"
+#include "indexes/CompactHashTableUniqueIndex.h"
+#include "indexes/CompactHashTableMultiMapIndex.h"
+
+// HASH_TABLE_INDEX builds the dual-stage compact hash indexes; point these
+// at HashTableUniqueIndex and HashTableMultiMapIndex for the plain
+// boost::unordered ones
+#define HASH_UNIQUE_INDEX CompactHashTableUniqueIndex
+#define HASH_MULTIMAP_INDEX CompactHashTableMultiMapIndex
 
 namespace voltdb {
 
@@ -117,13 +125,13 @@ namespace voltdb {
         
         if ((ints_only) && (type == HASH_TABLE_INDEX) && (unique)) {
             if (keySize <= sizeof(uint64_t)) {
-                return new HashTableUniqueIndex<IntsKey<1>, IntsHasher<1>, IntsEqualityChecker<1> >(schemeCopy);
+                return new HASH_UNIQUE_INDEX<IntsKey<1>, IntsHasher<1>, IntsEqualityChecker<1> >(schemeCopy);
             } else if (keySize <= sizeof(int64_t) * 2) {
-                return new HashTableUniqueIndex<IntsKey<2>, IntsHasher<2>, IntsEqualityChecker<2> >(schemeCopy);
+                return new HASH_UNIQUE_INDEX<IntsKey<2>, IntsHasher<2>, IntsEqualityChecker<2> >(schemeCopy);
             } else if (keySize <= sizeof(int64_t) * 3) {
-                return new HashTableUniqueIndex<IntsKey<3>, IntsHasher<3>, IntsEqualityChecker<3> >(schemeCopy);
+                return new HASH_UNIQUE_INDEX<IntsKey<3>, IntsHasher<3>, IntsEqualityChecker<3> >(schemeCopy);
             } else if (keySize <= sizeof(int64_t) * 4) {
-                return new HashTableUniqueIndex<IntsKey<4>, IntsHasher<4>, IntsEqualityChecker<4> >(schemeCopy);
+                return new HASH_UNIQUE_INDEX<IntsKey<4>, IntsHasher<4>, IntsEqualityChecker<4> >(schemeCopy);
             } else {
                 throwFatalException( "We currently only support hash index on unique integer keys of size 32 bytes or smaller..." );
             }
@@ -131,25 +139,94 @@ namespace voltdb {
         
         if ((ints_only) && (type == HASH_TABLE_INDEX) && (!unique)) {
             if (keySize <= sizeof(uint64_t)) {
-                return new HashTableMultiMapIndex<IntsKey<1>, IntsHasher<1>, IntsEqualityChecker<1> >(schemeCopy);
+                return new HASH_MULTIMAP_INDEX<IntsKey<1>, IntsHasher<1>, IntsEqualityChecker<1> >(schemeCopy);
             } else if (keySize <= sizeof(int64_t) * 2) {
-                return new HashTableMultiMapIndex<IntsKey<2>, IntsHasher<2>, IntsEqualityChecker<2> >(schemeCopy);
+                return new HASH_MULTIMAP_INDEX<IntsKey<2>, IntsHasher<2>, IntsEqualityChecker<2> >(schemeCopy);
             } else if (keySize <= sizeof(int64_t) * 3) {
-                return new HashTableMultiMapIndex<IntsKey<3>, IntsHasher<3>, IntsEqualityChecker<3> >(schemeCopy);
+                return new HASH_MULTIMAP_INDEX<IntsKey<3>, IntsHasher<3>, IntsEqualityChecker<3> >(schemeCopy);
             } else if (keySize <= sizeof(int64_t) * 4) {
-                return new HashTableMultiMapIndex<IntsKey<4>, IntsHasher<4>, IntsEqualityChecker<4> >(schemeCopy);
+                return new HASH_MULTIMAP_INDEX<IntsKey<4>, IntsHasher<4>, IntsEqualityChecker<4> >(schemeCopy);
             } else {
                 throwFatalException( "We currently only support hash index on non-unique integer keys of size 32 bytes of smaller..." );
             }
         }
         
-        if (/*(type == BALANCED_TREE_INDEX) &&*/ (unique)) {
+        // keys too wide for GenericKey keep their leading columns inline
+        // and read the rest from the indexed tuple, the tables of these
+        // indexes are not evicted (see PersistentTable::canEvict())
+        if (keySize > 512) {
             if (type == HASH_TABLE_INDEX) {
                 VOLT_INFO("Producing a tree index for %s: "
-                          "hash index not currently supported for this index key.\n",
+                          "hash index not supported for keys over 512 bytes.\n",
                           scheme.name.c_str());
             }
-            
+            TableIndex *index;
+            if (unique) {
+                index = new BinaryTreeUniqueIndex<PrefixTupleKey<64>, PrefixTupleKeyComparator<64>, PrefixTupleKeyEqualityChecker<64> >(schemeCopy);
+            } else {
+                index = new BinaryTreeMultiMapIndex<PrefixTupleKey<64>, PrefixTupleKeyComparator<64>, PrefixTupleKeyEqualityChecker<64> >(schemeCopy);
+            }
+            index->m_keysReferenceTuples = true;
+            return index;
+        }
+        
+        if ((type == HASH_TABLE_INDEX) && (unique)) {
+            if (keySize <= 4) {
+                return new HASH_UNIQUE_INDEX<GenericKey<4>, GenericHasher<4>, GenericEqualityChecker<4> >(schemeCopy);
+            } else if (keySize <= 8) {
+                return new HASH_UNIQUE_INDEX<GenericKey<8>, GenericHasher<8>, GenericEqualityChecker<8> >(schemeCopy);
+            } else if (keySize <= 12) {
+                return new HASH_UNIQUE_INDEX<GenericKey<12>, GenericHasher<12>, GenericEqualityChecker<12> >(schemeCopy);
+            } else if (keySize <= 16) {
+                return new HASH_UNIQUE_INDEX<GenericKey<16>, GenericHasher<16>, GenericEqualityChecker<16> >(schemeCopy);
+            } else if (keySize <= 24) {
+                return new HASH_UNIQUE_INDEX<GenericKey<24>, GenericHasher<24>, GenericEqualityChecker<24> >(schemeCopy);
+            } else if (keySize <= 32) {
+                return new HASH_UNIQUE_INDEX<GenericKey<32>, GenericHasher<32>, GenericEqualityChecker<32> >(schemeCopy);
+            } else if (keySize <= 48) {
+                return new HASH_UNIQUE_INDEX<GenericKey<48>, GenericHasher<48>, GenericEqualityChecker<48> >(schemeCopy);
+            } else if (keySize <= 64) {
+                return new HASH_UNIQUE_INDEX<GenericKey<64>, GenericHasher<64>, GenericEqualityChecker<64> >(schemeCopy);
+            } else if (keySize <= 96) {
+                return new HASH_UNIQUE_INDEX<GenericKey<96>, GenericHasher<96>, GenericEqualityChecker<96> >(schemeCopy);
+            } else if (keySize <= 128) {
+                return new HASH_UNIQUE_INDEX<GenericKey<128>, GenericHasher<128>, GenericEqualityChecker<128> >(schemeCopy);
+            } else if (keySize <= 256) {
+                return new HASH_UNIQUE_INDEX<GenericKey<256>, GenericHasher<256>, GenericEqualityChecker<256> >(schemeCopy);
+            } else {
+                return new HASH_UNIQUE_INDEX<GenericKey<512>, GenericHasher<512>, GenericEqualityChecker<512> >(schemeCopy);
+            }
+        }
+        
+        if ((type == HASH_TABLE_INDEX) && (!unique)) {
+            if (keySize <= 4) {
+                return new HASH_MULTIMAP_INDEX<GenericKey<4>, GenericHasher<4>, GenericEqualityChecker<4> >(schemeCopy);
+            } else if (keySize <= 8) {
+                return new HASH_MULTIMAP_INDEX<GenericKey<8>, GenericHasher<8>, GenericEqualityChecker<8> >(schemeCopy);
+            } else if (keySize <= 12) {
+                return new HASH_MULTIMAP_INDEX<GenericKey<12>, GenericHasher<12>, GenericEqualityChecker<12> >(schemeCopy);
+            } else if (keySize <= 16) {
+                return new HASH_MULTIMAP_INDEX<GenericKey<16>, GenericHasher<16>, GenericEqualityChecker<16> >(schemeCopy);
+            } else if (keySize <= 24) {
+                return new HASH_MULTIMAP_INDEX<GenericKey<24>, GenericHasher<24>, GenericEqualityChecker<24> >(schemeCopy);
+            } else if (keySize <= 32) {
+                return new HASH_MULTIMAP_INDEX<GenericKey<32>, GenericHasher<32>, GenericEqualityChecker<32> >(schemeCopy);
+            } else if (keySize <= 48) {
+                return new HASH_MULTIMAP_INDEX<GenericKey<48>, GenericHasher<48>, GenericEqualityChecker<48> >(schemeCopy);
+            } else if (keySize <= 64) {
+                return new HASH_MULTIMAP_INDEX<GenericKey<64>, GenericHasher<64>, GenericEqualityChecker<64> >(schemeCopy);
+            } else if (keySize <= 96) {
+                return new HASH_MULTIMAP_INDEX<GenericKey<96>, GenericHasher<96>, GenericEqualityChecker<96> >(schemeCopy);
+            } else if (keySize <= 128) {
+                return new HASH_MULTIMAP_INDEX<GenericKey<128>, GenericHasher<128>, GenericEqualityChecker<128> >(schemeCopy);
+            } else if (keySize <= 256) {
+                return new HASH_MULTIMAP_INDEX<GenericKey<256>, GenericHasher<256>, GenericEqualityChecker<256> >(schemeCopy);
+            } else {
+                return new HASH_MULTIMAP_INDEX<GenericKey<512>, GenericHasher<512>, GenericEqualityChecker<512> >(schemeCopy);
+            }
+        }
+        
+        if (/*(type == BALANCED_TREE_INDEX) &&*/ (unique)) {
             if (keySize <= 4) {
                 return new BinaryTreeUniqueIndex<GenericKey<4>, GenericComparator<4>, GenericEqualityChecker<4> >(schemeCopy);
             } else if (keySize <= 8) {
@@ -172,22 +249,12 @@ namespace voltdb {
                 return new BinaryTreeUniqueIndex<GenericKey<128>, GenericComparator<128>, GenericEqualityChecker<128> >(schemeCopy);
             } else if (keySize <= 256) {
                 return new BinaryTreeUniqueIndex<GenericKey<256>, GenericComparator<256>, GenericEqualityChecker<256> >(schemeCopy);
-            } else if (keySize <= 512) {
-                return new BinaryTreeUniqueIndex<GenericKey<512>, GenericComparator<512>, GenericEqualityChecker<512> >(schemeCopy);
             } else {
-                throwFatalException( "We currently only support keys of up to 512 bytes when anti-caching is enabled..." );
-                
-                //return new BinaryTreeUniqueIndex<TupleKey, TupleKeyComparator, TupleKeyEqualityChecker>(schemeCopy);
+                return new BinaryTreeUniqueIndex<GenericKey<512>, GenericComparator<512>, GenericEqualityChecker<512> >(schemeCopy);
             }
         }
         
         if (/*(type == BALANCED_TREE_INDEX) &&*/ (!unique)) {
-            if (type == HASH_TABLE_INDEX) {
-                VOLT_INFO("Producing a tree index for %s: "
-                          "hash index not currently supported for this index key.\n",
-                          scheme.name.c_str());
-            }
-            
             if (keySize <= 4) {
                 return new BinaryTreeMultiMapIndex<GenericKey<4>, GenericComparator<4>, GenericEqualityChecker<4> >(schemeCopy);
             } else if (keySize <= 8) {
@@ -210,39 +277,11 @@ namespace voltdb {
                 return new BinaryTreeMultiMapIndex<GenericKey<128>, GenericComparator<128>, GenericEqualityChecker<128> >(schemeCopy);
             } else if (keySize <= 256) {
                 return new BinaryTreeMultiMapIndex<GenericKey<256>, GenericComparator<256>, GenericEqualityChecker<256> >(schemeCopy);
-            } else if (keySize <= 512) {
-                return new BinaryTreeMultiMapIndex<GenericKey<512>, GenericComparator<512>, GenericEqualityChecker<512> >(schemeCopy);
             } else {
-                throwFatalException( "We currently only support keys of up to 512 bytes when anti-caching is enabled..." );
-                
-                //return new BinaryTreeMultiMapIndex<TupleKey, TupleKeyComparator, TupleKeyEqualityChecker>(schemeCopy);
+                return new BinaryTreeMultiMapIndex<GenericKey<512>, GenericComparator<512>, GenericEqualityChecker<512> >(schemeCopy);
             }
         }
         
-        /*if ((type == HASH_TABLE_INDEX) && (unique)) {
-         switch (colCount) {
-         case 1: return new HashTableUniqueIndex<GenericKey<1>, GenericHasher<1>, GenericEqualityChecker<1> >(schemeCopy);
-         case 2: return new HashTableUniqueIndex<GenericKey<2>, GenericHasher<2>, GenericEqualityChecker<2> >(schemeCopy);
-         case 3: return new HashTableUniqueIndex<GenericKey<3>, GenericHasher<3>, GenericEqualityChecker<3> >(schemeCopy);
-         case 4: return new HashTableUniqueIndex<GenericKey<4>, GenericHasher<4>, GenericEqualityChecker<4> >(schemeCopy);
-         case 5: return new HashTableUniqueIndex<GenericKey<5>, GenericHasher<5>, GenericEqualityChecker<5> >(schemeCopy);
-         case 6: return new HashTableUniqueIndex<GenericKey<6>, GenericHasher<6>, GenericEqualityChecker<6> >(schemeCopy);
-         default: throwFatalException( "We currently only support up to 6 column generic hash indexes..." );
-         }
-         }
-         
-         if ((type == HASH_TABLE_INDEX) && (!unique)) {
-         switch (colCount) {
-         case 1: return new HashTableMultiMapIndex<GenericKey<1>, GenericHasher<1>, GenericEqualityChecker<1> >(schemeCopy);
-         case 2: return new HashTableMultiMapIndex<GenericKey<2>, GenericHasher<2>, GenericEqualityChecker<2> >(schemeCopy);
-         case 3: return new HashTableMultiMapIndex<GenericKey<3>, GenericHasher<3>, GenericEqualityChecker<3> >(schemeCopy);
-         case 4: return new HashTableMultiMapIndex<GenericKey<4>, GenericHasher<4>, GenericEqualityChecker<4> >(schemeCopy);
-         case 5: return new HashTableMultiMapIndex<GenericKey<5>, GenericHasher<5>, GenericEqualityChecker<5> >(schemeCopy);
-         case 6: return new HashTableMultiMapIndex<GenericKey<6>, GenericHasher<6>, GenericEqualityChecker<6> >(schemeCopy);
-         default: throwFatalException( "We currently only support up to 6 column generic hash indexes..." );
-         }
-         }*/
-        
         throwFatalException("Unsupported index scheme..." );
         return NULL;
     }
@@ -0,0 +1,132 @@
+/* Copyright (C) 2014 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cassert>
+#include <cstring>
+#include "storage/BlockCopyOnWriteIterator.h"
+#include "storage/table.h"
+#include "common/Pool.hpp"
+
+namespace voltdb {
+
+BlockCopyOnWriteIterator::BlockCopyOnWriteIterator(Table *table, Pool *pool) :
+        m_table(table), m_blocks(table->m_data), m_copies(m_blocks.size(), static_cast<char*>(NULL)),
+        m_pool(pool), m_blockIndex(0), m_slot(0),
+        m_tupleLength(table->m_tupleLength), m_tuplesPerBlock(table->m_tuplesPerBlock),
+        m_words(table->m_occupancyWords), m_blocksCopied(0)
+{
+    assert(table->m_trackOccupancy);
+}
+
+BlockCopyOnWriteIterator::~BlockCopyOnWriteIterator() {
+    for (uint32_t i = 0; i < m_copies.size(); i++) {
+        releaseCopy(i);
+    }
+}
+
+void BlockCopyOnWriteIterator::beforeWrite(int blockIndex, const char *address, bool newTuple) {
+    const uint32_t block = static_cast<uint32_t>(blockIndex);
+    if (block < m_blockIndex || m_copies[block] != NULL) {
+        return;
+    }
+
+    // the block is as it was when the snapshot started, but for the slot
+    // an insert has just taken
+    const size_t bytes = static_cast<size_t>(m_tupleLength) * m_tuplesPerBlock;
+    char *copy = new char[bytes];
+    ::memcpy(copy, m_blocks[block], bytes);
+    m_copies[block] = copy;
+    m_blocksCopied++;
+
+    if (m_copyOccupancy.empty()) {
+        m_copyOccupancy.resize(m_blocks.size() * static_cast<size_t>(m_words), 0);
+    }
+    uint64_t *words = &m_copyOccupancy[block * static_cast<size_t>(m_words)];
+    if (block < m_table->m_liveCounts.size()) {
+        ::memcpy(words, &m_table->m_occupancy[block * static_cast<size_t>(m_words)], m_words * sizeof(uint64_t));
+    }
+    if (newTuple) {
+        const uint32_t slot = static_cast<uint32_t>((address - m_blocks[block]) / m_tupleLength);
+        words[slot >> 6] &= ~(static_cast<uint64_t>(1) << (slot & 63));
+    }
+
+    // the strings of the live tuples may be freed by the writes to come
+    if (m_table->schema()->getUninlinedObjectColumnCount() > 0) {
+        TableTuple source(m_table->schema());
+        TableTuple target(m_table->schema());
+        for (uint32_t slot = nextCopiedSlot(block, 0); slot < m_tuplesPerBlock; slot = nextCopiedSlot(block, slot + 1)) {
+            source.move(m_blocks[block] + static_cast<size_t>(slot) * m_tupleLength);
+            target.move(copy + static_cast<size_t>(slot) * m_tupleLength);
+            target.copyForPersistentInsert(source, m_pool);
+        }
+    }
+}
+
+uint32_t BlockCopyOnWriteIterator::nextCopiedSlot(uint32_t blockIndex, uint32_t slot) const {
+    if (slot >= m_tuplesPerBlock) {
+        return m_tuplesPerBlock;
+    }
+    const uint64_t *words = &m_copyOccupancy[blockIndex * static_cast<size_t>(m_words)];
+    uint32_t w = slot >> 6;
+    uint64_t bits = words[w] & (~static_cast<uint64_t>(0) << (slot & 63));
+    while (bits == 0) {
+        if (++w == m_words) {
+            return m_tuplesPerBlock;
+        }
+        bits = words[w];
+    }
+    return (w << 6) + static_cast<uint32_t>(__builtin_ctzll(bits));
+}
+
+void BlockCopyOnWriteIterator::releaseCopy(uint32_t blockIndex) {
+    delete[] m_copies[blockIndex];
+    m_copies[blockIndex] = NULL;
+}
+
+/**
+ * Walks the occupied slots of every block, in its copy if it has one.
+ * Blocks that were never written to are read in place, the occupancy
+ * bits of the table still describe them as of the start of the snapshot.
+ */
+bool BlockCopyOnWriteIterator::next(TableTuple &out) {
+    while (m_blockIndex < m_blocks.size()) {
+        const char *copy = m_copies[m_blockIndex];
+        const uint32_t slot = copy != NULL ? nextCopiedSlot(m_blockIndex, m_slot)
+                                           : m_table->nextOccupiedSlot(m_blockIndex, m_slot);
+        if (slot == m_tuplesPerBlock) {
+            releaseCopy(m_blockIndex);
+            m_blockIndex++;
+            m_slot = 0;
+            continue;
+        }
+        m_slot = slot + 1;
+        out.move(const_cast<char*>(copy != NULL ? copy : m_blocks[m_blockIndex]) +
+                 static_cast<size_t>(slot) * m_tupleLength);
+        return true;
+    }
+    return false;
+}
+
+}
@@ -0,0 +1,94 @@
+/* Copyright (C) 2014 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef HSTOREBLOCKCOPYONWRITEITERATOR_H
+#define HSTOREBLOCKCOPYONWRITEITERATOR_H
+
+#include <vector>
+#include <stdint.h>
+#include "common/tabletuple.h"
+#include "storage/TupleIterator.h"
+
+namespace voltdb {
+class Table;
+class Pool;
+
+/**
+ * Snapshot scan of the blocks a table had when the snapshot started,
+ * for the block mode of CopyOnWriteContext. Instead of backing up each
+ * tuple on its first update or delete, the first write to a block the
+ * scan has not got past yet copies the whole block, with its occupancy
+ * bits and the uninlined strings of its tuples, and the scan reads that
+ * copy instead. Any later write to the block costs a single check, and
+ * a copy is dropped as soon as the scan leaves it.
+ */
+class BlockCopyOnWriteIterator : public TupleIterator {
+public:
+    BlockCopyOnWriteIterator(Table *table, Pool *pool);
+
+    /**
+     * Called before a tuple of the block at blockIndex (in the block
+     * directory as of the start of the snapshot) is written to. With
+     * newTuple set, the tuple was just placed in a free slot by an insert.
+     */
+    void beforeWrite(int blockIndex, const char *address, bool newTuple);
+
+    bool next(TableTuple &out);
+
+    /** Number of blocks copied so far */
+    size_t getBlocksCopied() const { return m_blocksCopied; }
+
+    virtual ~BlockCopyOnWriteIterator();
+
+private:
+    uint32_t nextCopiedSlot(uint32_t blockIndex, uint32_t slot) const;
+    void releaseCopy(uint32_t blockIndex);
+
+    Table *m_table;
+
+    /** Blocks of the table as of the start of the snapshot */
+    const std::vector<char*> m_blocks;
+
+    /** Copy of each block written to before the scan got past it, or NULL */
+    std::vector<char*> m_copies;
+
+    /** Occupancy bits of the copies, m_words per block */
+    std::vector<uint64_t> m_copyOccupancy;
+
+    /** Memory pool for the strings of the copied tuples */
+    Pool *m_pool;
+
+    uint32_t m_blockIndex;
+    uint32_t m_slot;
+
+    const uint32_t m_tupleLength;
+    const uint32_t m_tuplesPerBlock;
+    const uint32_t m_words;
+    size_t m_blocksCopied;
+};
+
+}
+
+#endif /* HSTOREBLOCKCOPYONWRITEITERATOR_H */
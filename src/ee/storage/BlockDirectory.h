@@ -0,0 +1,123 @@
+/* Copyright (C) 2014 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#ifndef HSTOREBLOCKDIRECTORY_H
+#define HSTOREBLOCKDIRECTORY_H
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cstddef>
+
+namespace voltdb {
+
+/**
+ * The tuple blocks of a table sorted by their address, to find the block
+ * holding a tuple with a binary search instead of a scan over all blocks.
+ * Every entry pairs the address of a block with the index of the block
+ * in the table's block list. A Table keeps one up to date as it allocates
+ * and frees blocks; a CopyOnWriteContext takes a copy of it to know the
+ * blocks that existed when the snapshot started.
+ */
+class BlockDirectory {
+public:
+    typedef std::pair<char*, int> Block;
+
+    BlockDirectory() : m_blockLength(0) {}
+
+    /**
+     * Bytes of a block that hold tuples. Addresses in the rest of the
+     * allocation are not part of any block.
+     */
+    void setBlockLength(size_t blockLength) {
+        m_blockLength = blockLength;
+    }
+
+    void add(char *block, int index) {
+        std::vector<Block>::iterator i =
+            std::lower_bound(m_blocks.begin(), m_blocks.end(), Block(block, index), blockBefore);
+        m_blocks.insert(i, Block(block, index));
+    }
+
+    /**
+     * Forget a freed block. Returns false if the block was not here.
+     */
+    bool remove(const char *block) {
+        const size_t i = lookup(block);
+        if (i == m_blocks.size() || m_blocks[i].first != block) {
+            return false;
+        }
+        m_blocks.erase(m_blocks.begin() + i);
+        return true;
+    }
+
+    void clear() {
+        m_blocks.clear();
+    }
+
+    size_t size() const {
+        return m_blocks.size();
+    }
+
+    /**
+     * The index of the block that holds the address, -1 if none does.
+     * The start of the block is stored in blockStart if it is not NULL.
+     */
+    int find(const char *address, const char **blockStart = NULL) const {
+        const size_t i = lookup(address);
+        if (i == m_blocks.size() || address >= m_blocks[i].first + m_blockLength) {
+            return -1;
+        }
+        if (blockStart != NULL) {
+            *blockStart = m_blocks[i].first;
+        }
+        return m_blocks[i].second;
+    }
+
+private:
+    static bool blockBefore(const Block &a, const Block &b) {
+        return a.first < b.first;
+    }
+
+    // position of the last block starting at or before the address,
+    // size() if there is none
+    size_t lookup(const char *address) const {
+        std::vector<Block>::const_iterator i =
+            std::upper_bound(m_blocks.begin(), m_blocks.end(),
+                             Block(const_cast<char*>(address), 0), blockBefore);
+        if (i == m_blocks.begin()) {
+            return m_blocks.size();
+        }
+        return (i - m_blocks.begin()) - 1;
+    }
+
+    std::vector<Block> m_blocks;
+    size_t m_blockLength;
+};
+
+}
+
+#endif
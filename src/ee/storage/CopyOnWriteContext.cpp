@@ -18,6 +18,7 @@
 #include "storage/temptable.h"
 #include "storage/tablefactory.h"
 #include "storage/CopyOnWriteIterator.h"
+#include "storage/BlockCopyOnWriteIterator.h"
 #include "storage/tableiterator.h"
 #include "common/FatalException.hpp"
 #include <algorithm>
@@ -25,67 +26,30 @@
 #include <boost/crc.hpp>
 #include "common/tabletuple.h"
 
-/**
- * Matches the allocations size in persistenttable.cpp. It's a terrible idea to cut and paste
- * it, but if they become inconsistent the memcheck build will catch it.
- */
-#ifndef MEMCHECK
-#define TABLE_BLOCKSIZE 2097152
-#endif
-
-
 namespace voltdb {
 
-// These next two methods here do some Ariel-foo that probably merits a comment.
-#ifdef MEMCHECK
-bool pairAddressToPairAddressComparator(const BlockPair a, const BlockPair b) {
-    return a.pair.first + a.tupleLength < b.pair.first;
-}
-// Created this simple comparitor to compare addresses of BlockPairs for sorting
-bool simplePairAddressToPairAddressComparator(const BlockPair a, const BlockPair b) {
-        return a.pair.first < b.pair.first;
-}
-#else
-bool pairAddressToPairAddressComparator(const BlockPair a, const BlockPair b) {
-    return a.first + TABLE_BLOCKSIZE < b.first;
-}
-// Created this simple comparitor to compare addresses of BlockPairs for sorting
-bool simplePairAddressToPairAddressComparator(const BlockPair a, const BlockPair b) {
-        return a.first < b.first;
-}
-#endif
-
-CopyOnWriteContext::CopyOnWriteContext(Table *table, TupleSerializer *serializer, int32_t partitionId) :
-             m_table(table),
-             m_backedUpTuples(TableFactory::getCopiedTempTable(table->databaseId(), "COW of " + table->name(), table, NULL)),
-             m_serializer(serializer), m_pool(2097152, 320), m_blocks(m_table->m_data.size()),
-             m_iterator(new CopyOnWriteIterator(table)),
+CopyOnWriteContext::CopyOnWriteContext(Table *table, TupleSerializer *serializer, int32_t partitionId,
+                                       CopyOnWriteMode mode) :
+             m_table(table), m_mode(mode),
+             m_backedUpTuples(mode == COPY_ON_WRITE_TUPLES ?
+                              TableFactory::getCopiedTempTable(table->databaseId(), "COW of " + table->name(), table, NULL) :
+                              NULL),
+             m_serializer(serializer), m_pool(2097152, 320), m_blocks(table->m_blockDirectory),
              m_maxTupleLength(serializer->getMaxSerializedTupleSize(table->schema())),
              m_tuple(table->schema()), m_finishedTableScan(false), m_partitionId(partitionId),
              m_tuplesSerialized(0) {
-    for (int ii = 0; ii < table->m_data.size(); ii++) {
-#ifdef MEMCHECK
-        BlockPair p;
-        p.pair =  std::pair<char*, int>(table->m_data[ii], ii);
-        p.tupleLength = table->tempTuple().tupleLength();
-#else
-        const BlockPair p(table->m_data[ii], ii);
-#endif
-        m_blocks[ii] = p;
-    }
-    std::sort( m_blocks.begin(), m_blocks.end(), simplePairAddressToPairAddressComparator);
-#ifdef DEBUG
-#ifndef MEMCHECK
-    for (int ii = 0; ii < m_blocks.size() - 1; ii++) {
-        assert(m_blocks[ii].first < m_blocks[ii + 1].first);
+    if (mode == COPY_ON_WRITE_BLOCKS) {
+        m_iterator.reset(new BlockCopyOnWriteIterator(table, &m_pool));
+    } else {
+        m_iterator.reset(new CopyOnWriteIterator(table));
     }
-#endif
-#endif
-#ifdef MEMCHECK
-    for (int ii = 0; ii < m_blocks.size() - 1; ii++) {
-        assert(m_blocks[ii].pair.first < m_blocks[ii + 1].pair.first);
+}
+
+size_t CopyOnWriteContext::getCopyCount() const {
+    if (m_mode == COPY_ON_WRITE_BLOCKS) {
+        return static_cast<BlockCopyOnWriteIterator*>(m_iterator.get())->getBlocksCopied();
     }
-#endif
+    return static_cast<size_t>(m_backedUpTuples->activeTupleCount());
 }
 
 bool CopyOnWriteContext::serializeMore(ReferenceSerializeOutput *out) {
@@ -116,7 +80,8 @@ bool CopyOnWriteContext::serializeMore(ReferenceSerializeOutput *out) {
          * the temp table with the tuples that were backed up
          */
         if (!hadMore) {
-            if (m_finishedTableScan) {
+            if (m_finishedTableScan || m_backedUpTuples == NULL) {
+                m_finishedTableScan = true;
                 out->writeInt(rowsSerialized);
                 crc.process_bytes(out->data() + out->position() - 4, 4);
                 out->writeIntAt(crcPosition, crc.checksum());
@@ -147,6 +112,21 @@ bool CopyOnWriteContext::serializeMore(ReferenceSerializeOutput *out) {
 }
 
 void CopyOnWriteContext::markTupleDirty(TableTuple tuple, bool newTuple) {
+    /**
+     * In block mode the dirty flags are not used, only the first write to a
+     * block that is still to be scanned has to copy it.
+     */
+    if (m_mode == COPY_ON_WRITE_BLOCKS) {
+        if (!m_finishedTableScan) {
+            const int blockIndex = m_blocks.find(tuple.address());
+            if (blockIndex >= 0) {
+                static_cast<BlockCopyOnWriteIterator*>(m_iterator.get())->beforeWrite(blockIndex, tuple.address(), newTuple);
+            }
+        }
+        tuple.setDirtyFalse();
+        return;
+    }
+
     /**
      * If this an update or a delete of a tuple that is already dirty then no further action is
      * required.
@@ -168,30 +148,8 @@ void CopyOnWriteContext::markTupleDirty(TableTuple tuple, bool newTuple) {
      * Find out which block the address is contained in.
      */
     char *address = tuple.address();
-#ifdef MEMCHECK
-        BlockPair compP;
-        compP.pair =  std::pair<char*, int>(address, 0);
-        compP.tupleLength = tuple.tupleLength();
-#else
-    const BlockPair compP(address, 0);
-#endif
-    BlockPairVectorI i =
-            std::lower_bound(m_blocks.begin(), m_blocks.end(), compP, pairAddressToPairAddressComparator);
-    if (i == m_blocks.end()) {
-        tuple.setDirtyFalse();
-        return;
-    }
-#ifdef MEMCHECK
-    const char *blockStartAddress = (*i).pair.first;
-    const int blockIndex = (*i).pair.second;
-    const char *blockEndAddress = blockStartAddress + tuple.tupleLength();
-#else
-    const char *blockStartAddress = (*i).first;
-    const int blockIndex = (*i).second;
-    const char *blockEndAddress = blockStartAddress + TABLE_BLOCKSIZE;
-#endif
-
-    if (address >= blockEndAddress || address < blockStartAddress) {
+    const int blockIndex = m_blocks.find(address);
+    if (blockIndex < 0) {
         /**
          * Tuple is in a block allocated after the start of COW
          */
@@ -21,34 +21,35 @@
 #include <utility>
 #include "common/TupleSerializer.h"
 #include "storage/table.h"
+#include "storage/BlockDirectory.h"
 #include "common/Pool.hpp"
 #include "common/tabletuple.h"
 #include "boost/scoped_ptr.hpp"
 
 namespace voltdb {
 
-#ifdef MEMCHECK
-typedef struct {
-    std::pair<char*, int> pair;
-    int tupleLength;
-} BlockPair;
-#else
-typedef std::pair<char*, int> BlockPair;
-#endif
-typedef std::vector<BlockPair> BlockPairVector;
-typedef BlockPairVector::iterator BlockPairVectorI;
-
 class TupleIterator;
 class TempTable;
 class ReferenceSerializeOut;
 
+/**
+ * How a snapshot keeps the tuples it has not serialized yet from changing under it
+ */
+enum CopyOnWriteMode {
+    /** back up each tuple on its first update or delete, see CopyOnWriteIterator */
+    COPY_ON_WRITE_TUPLES,
+    /** copy a whole block on its first write, see BlockCopyOnWriteIterator */
+    COPY_ON_WRITE_BLOCKS
+};
+
 class CopyOnWriteContext {
 public:
     /**
      * Construct a copy on write context for the specified table that will serialize tuples
      * using the provided serializer
      */
-    CopyOnWriteContext(Table *m_table, TupleSerializer *m_serializer, int32_t partitionId);
+    CopyOnWriteContext(Table *m_table, TupleSerializer *m_serializer, int32_t partitionId,
+                       CopyOnWriteMode mode = COPY_ON_WRITE_TUPLES);
 
     /**
      * Serialize tuples to the provided output until no more tuples can be serialized. Returns true
@@ -65,6 +66,16 @@ public:
      */
     void markTupleDirty(TableTuple tuple, bool newTuple);
 
+    CopyOnWriteMode getMode() const {
+        return m_mode;
+    }
+
+    /**
+     * Number of tuples backed up (tuple mode) or blocks copied (block
+     * mode) because they were written to before being serialized
+     */
+    size_t getCopyCount() const;
+
     virtual ~CopyOnWriteContext();
 
 private:
@@ -73,8 +84,10 @@ private:
      */
     Table *m_table;
 
+    const CopyOnWriteMode m_mode;
+
     /**
-     * Temp table for copies of tuples that were dirtied.
+     * Temp table for copies of tuples that were dirtied, in tuple mode only.
      */
     boost::scoped_ptr<TempTable> m_backedUpTuples;
 
@@ -89,10 +102,10 @@ private:
     Pool m_pool;
 
     /**
-     * Copied and sorted tuple blocks that can be binary searched in order to find out. The pair
-     * contains the block address as well as the original index of the block.
+     * Copy of the table's block directory as of the start of the snapshot, to find
+     * out which block holds a tuple and whether it existed when the snapshot started.
      */
-    BlockPairVector m_blocks;
+    BlockDirectory m_blocks;
 
     /**
      * Iterator over the table via a CopyOnWriteIterator or an iterator over
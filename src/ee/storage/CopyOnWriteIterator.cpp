@@ -24,23 +24,33 @@ CopyOnWriteIterator::CopyOnWriteIterator(Table *table) :
         m_tupleLength(table->m_tupleLength),
         m_location(m_blocks[0] - m_tupleLength), m_activeTupleCount(table->m_tupleCount),
         m_foundTuples(0),
-        m_blockLength(m_tupleLength * table->m_tuplesPerBlock), m_didFirstIteration(false) {
+        m_blockLength(m_tupleLength * table->m_tuplesPerBlock),
+        m_tuplesPerBlock(table->m_tuplesPerBlock), m_didFirstIteration(false) {
 
 }
 
 /**
  * Iterate through the table blocks until all the active tuples have been found. Skip dirty tuples
- * and mark them as clean so that they can be copied during the next snapshot.
+ * and mark them as clean so that they can be copied during the next snapshot. Only the slots
+ * whose occupancy bit is set are looked at, the others hold no tuple to copy.
  */
 bool CopyOnWriteIterator::next(TableTuple &out) {
+    assert(m_table->m_trackOccupancy);
     while (m_foundTuples < m_activeTupleCount) {
-        m_location = m_location + m_tupleLength;
-        const long int delta = m_location - m_blocks[m_blockIndex];
-        if (m_didFirstIteration && delta >= m_blockLength) {
-            m_location = m_blocks[++m_blockIndex];
-        } else {
-            m_didFirstIteration = true;
+        uint32_t slot = 0;
+        if (m_didFirstIteration) {
+            slot = static_cast<uint32_t>((m_location - m_blocks[m_blockIndex]) / m_tupleLength) + 1;
+        }
+        m_didFirstIteration = true;
+        slot = m_table->nextOccupiedSlot(m_blockIndex, slot);
+        if (slot == m_tuplesPerBlock) {
+            if (m_blockIndex + 1 >= m_blocks.size()) {
+                break;
+            }
+            m_location = m_blocks[++m_blockIndex] - m_tupleLength;
+            continue;
         }
+        m_location = m_blocks[m_blockIndex] + static_cast<size_t>(slot) * m_tupleLength;
         assert(m_location < m_blocks[m_blockIndex] + m_blockLength);
         assert (out.sizeInValues() == m_table->columnCount());
         out.move(m_location);
@@ -60,19 +70,19 @@ bool CopyOnWriteIterator::next(TableTuple &out) {
 }
 
 void CopyOnWriteIterator::cleanBlocksAfterLastFound() {
-    m_location = m_location + m_tupleLength;
+    TableTuple tuple(m_table->schema());
+    uint32_t slot = static_cast<uint32_t>((m_location - m_blocks[m_blockIndex]) / m_tupleLength) + 1;
     while (true) {
-        long int delta = m_location - m_blocks[m_blockIndex];
-        TableTuple tuple(m_table->schema());
-        while (delta < m_blockLength) {
-            tuple.move(m_location);
+        slot = m_table->nextOccupiedSlot(m_blockIndex, slot);
+        while (slot < m_tuplesPerBlock) {
+            tuple.move(m_blocks[m_blockIndex] + static_cast<size_t>(slot) * m_tupleLength);
             tuple.setDirtyFalse();
-            m_location = m_location + m_tupleLength;
-            delta = m_location - m_blocks[m_blockIndex];
+            slot = m_table->nextOccupiedSlot(m_blockIndex, slot + 1);
         }
         m_blockIndex++;
         if (m_blockIndex < m_blocks.size()) {
             m_location = m_blocks[m_blockIndex];
+            slot = 0;
         } else {
             break;
         }
@@ -101,6 +101,11 @@ private:
      */
     const size_t m_blockLength;
 
+    /**
+     * Number of tuple slots in a block
+     */
+    const uint32_t m_tuplesPerBlock;
+
     bool m_didFirstIteration;
 
     /**
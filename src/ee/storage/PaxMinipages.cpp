@@ -0,0 +1,140 @@
+/* Copyright (C) 2014 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cstring>
+#include <algorithm>
+#include "storage/PaxMinipages.h"
+#include "storage/table.h"
+#include "common/tabletuple.h"
+#include "common/NValue.hpp"
+
+namespace voltdb {
+
+// minipages start on a cache line
+static inline size_t alignMinipage(size_t length) {
+    return (length + 63) & ~static_cast<size_t>(63);
+}
+
+PaxMinipages::PaxMinipages(const Table *table)
+    : m_table(table), m_offsets(table->columnCount(), -1),
+      m_copyLength(0), m_bytesAllocated(0)
+{
+    const TupleSchema *schema = table->schema();
+    const uint32_t slots = table->m_tuplesPerBlock;
+
+    // the live flags come first
+    size_t offset = alignMinipage(slots);
+    for (int column = 0; column < table->columnCount(); column++) {
+        const ValueType type = schema->columnType(column);
+        switch (type) {
+            case VALUE_TYPE_TINYINT:
+            case VALUE_TYPE_SMALLINT:
+            case VALUE_TYPE_INTEGER:
+            case VALUE_TYPE_BIGINT:
+            case VALUE_TYPE_TIMESTAMP:
+            case VALUE_TYPE_DOUBLE: {
+                const uint32_t width = static_cast<uint32_t>(NValue::getTupleStorageSize(type));
+                m_offsets[column] = static_cast<int>(offset);
+                m_columns.push_back(column);
+                m_widths.push_back(width);
+                m_rowOffsets.push_back(TUPLE_HEADER_SIZE + schema->columnOffset(column));
+                offset += alignMinipage(static_cast<size_t>(slots) * width);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+    m_copyLength = offset;
+}
+
+PaxMinipages::~PaxMinipages() {
+    invalidateAll();
+}
+
+const char* PaxMinipages::block(uint32_t blockIndex, uint32_t *slotCount) {
+    const char *rows = m_table->m_data[blockIndex];
+    const uint32_t perBlock = m_table->m_tuplesPerBlock;
+    const uint32_t first = blockIndex * perBlock;
+    const uint32_t used = m_table->m_usedTuples;
+    const uint32_t slots = (rows == NULL || used <= first) ? 0 : std::min(perBlock, used - first);
+
+    if (blockIndex >= m_copies.size()) {
+        m_copies.resize(blockIndex + 1, NULL);
+        m_sources.resize(blockIndex + 1, NULL);
+        m_slotCounts.resize(blockIndex + 1, 0);
+    }
+    *slotCount = slots;
+    if (slots == 0) {
+        return m_copies[blockIndex];
+    }
+
+    // a block freed and allocated again, or one that handed out more
+    // slots since, has to be copied again as well
+    if (m_sources[blockIndex] != rows || m_slotCounts[blockIndex] != slots) {
+        if (m_copies[blockIndex] == NULL) {
+            m_copies[blockIndex] = new char[m_copyLength];
+            m_bytesAllocated += m_copyLength;
+        }
+        copyBlock(rows, slots, m_copies[blockIndex]);
+        m_sources[blockIndex] = rows;
+        m_slotCounts[blockIndex] = slots;
+    }
+    return m_copies[blockIndex];
+}
+
+void PaxMinipages::copyBlock(const char *rows, uint32_t slotCount, char *copy) const {
+    const uint32_t tupleLength = m_table->m_tupleLength;
+    const size_t columnCount = m_columns.size();
+    TableTuple tuple(m_table->schema());
+    for (uint32_t slot = 0; slot < slotCount; slot++) {
+        const char *row = rows + static_cast<size_t>(slot) * tupleLength;
+        tuple.move(const_cast<char*>(row));
+        copy[slot] = tuple.isActive() ? 1 : 0;
+        for (size_t i = 0; i < columnCount; i++) {
+            ::memcpy(copy + m_offsets[m_columns[i]] + static_cast<size_t>(slot) * m_widths[i],
+                     row + m_rowOffsets[i], m_widths[i]);
+        }
+    }
+}
+
+void PaxMinipages::invalidate(const char *tupleAddress) {
+    const int blockIndex = m_table->m_blockDirectory.find(tupleAddress);
+    if (blockIndex >= 0 && static_cast<size_t>(blockIndex) < m_sources.size()) {
+        m_sources[blockIndex] = NULL;
+    }
+}
+
+void PaxMinipages::invalidateAll() {
+    for (size_t i = 0; i < m_copies.size(); i++) {
+        delete[] m_copies[i];
+    }
+    m_copies.clear();
+    m_sources.clear();
+    m_slotCounts.clear();
+    m_bytesAllocated = 0;
+}
+
+}
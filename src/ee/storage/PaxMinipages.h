@@ -0,0 +1,107 @@
+/* Copyright (C) 2014 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef HSTOREPAXMINIPAGES_H
+#define HSTOREPAXMINIPAGES_H
+
+#include <vector>
+#include <cstddef>
+#include <stdint.h>
+
+namespace voltdb {
+
+class Table;
+
+/**
+ * The PAX layout of the tuple blocks of a table. The tuples stay in their
+ * rows, where indexes, undo actions and the anti-cache point at them, and
+ * every block gets a copy laid out column by column: a byte per slot that
+ * is 1 if the slot holds a live tuple, followed by a minipage for every
+ * fixed width numeric column with the column's values for all slots of
+ * the block. Scans that read a few columns of many tuples go through the
+ * minipages instead of pulling every row through the cache.
+ *
+ * A block is copied when it is first asked for and again after any of
+ * its tuples was inserted, updated or deleted, so the layout pays off for
+ * read-mostly tables that are scanned much more often than written.
+ */
+class PaxMinipages {
+public:
+    explicit PaxMinipages(const Table *table);
+    ~PaxMinipages();
+
+    /**
+     * Where the minipage of the column starts in a block's copy, -1 for
+     * columns that have none.
+     */
+    inline int minipageOffset(int column) const {
+        return m_offsets[column];
+    }
+
+    /**
+     * The copy of a block, taken again from the rows if it is stale. The
+     * number of slots the block has handed out is stored in slotCount,
+     * the live flags and the minipages are valid for that many slots.
+     */
+    const char* block(uint32_t blockIndex, uint32_t *slotCount);
+
+    /**
+     * The block holding the tuple changed.
+     */
+    void invalidate(const char *tupleAddress);
+
+    /**
+     * The blocks of the table changed, every copy is dropped.
+     */
+    void invalidateAll();
+
+    size_t getBytesAllocated() const {
+        return m_bytesAllocated;
+    }
+
+private:
+    void copyBlock(const char *rows, uint32_t slotCount, char *copy) const;
+
+    const Table *m_table;
+    std::vector<int> m_offsets;
+
+    // the columns that have a minipage, their width and where they are in a row
+    std::vector<int> m_columns;
+    std::vector<uint32_t> m_widths;
+    std::vector<uint32_t> m_rowOffsets;
+
+    size_t m_copyLength;
+    size_t m_bytesAllocated;
+
+    // per block: the copy, the row block it was taken from (NULL while it
+    // is stale) and the number of slots it was taken for
+    std::vector<char*> m_copies;
+    std::vector<const char*> m_sources;
+    std::vector<uint32_t> m_slotCounts;
+};
+
+}
+
+#endif
@@ -0,0 +1,261 @@
+/* Copyright (C) 2014 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cassert>
+#include <cstring>
+#include <functional>
+#include "storage/PaxScanIterator.h"
+#include "storage/PaxMinipages.h"
+#include "storage/table.h"
+#include "common/ValuePeeker.hpp"
+#include "expressions/abstractexpression.h"
+
+namespace voltdb {
+
+// Nulls of the narrower integer types are cast to the BIGINT null before
+// NValue::compare() looks at them, the minipage loops do the same
+template <typename T> struct IntegerNull;
+template <> struct IntegerNull<int8_t> { static const int64_t value = INT8_NULL; };
+template <> struct IntegerNull<int16_t> { static const int64_t value = INT16_NULL; };
+template <> struct IntegerNull<int32_t> { static const int64_t value = INT32_NULL; };
+template <> struct IntegerNull<int64_t> { static const int64_t value = INT64_NULL; };
+
+template <typename T, typename Compare>
+static void filterIntegers(const char *minipage, uint32_t count, int64_t value, char *selected) {
+    const T *values = reinterpret_cast<const T*>(minipage);
+    const Compare compare = Compare();
+    for (uint32_t i = 0; i < count; i++) {
+        const int64_t v = values[i] == IntegerNull<T>::value ? INT64_NULL : values[i];
+        selected[i] = static_cast<char>(selected[i] & compare(v, value));
+    }
+}
+
+template <typename T>
+static void filterIntegers(const char *minipage, uint32_t count, ExpressionType op,
+                           int64_t value, char *selected) {
+    switch (op) {
+        case EXPRESSION_TYPE_COMPARE_EQUAL:
+            filterIntegers<T, std::equal_to<int64_t> >(minipage, count, value, selected);
+            break;
+        case EXPRESSION_TYPE_COMPARE_NOTEQUAL:
+            filterIntegers<T, std::not_equal_to<int64_t> >(minipage, count, value, selected);
+            break;
+        case EXPRESSION_TYPE_COMPARE_LESSTHAN:
+            filterIntegers<T, std::less<int64_t> >(minipage, count, value, selected);
+            break;
+        case EXPRESSION_TYPE_COMPARE_GREATERTHAN:
+            filterIntegers<T, std::greater<int64_t> >(minipage, count, value, selected);
+            break;
+        case EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO:
+            filterIntegers<T, std::less_equal<int64_t> >(minipage, count, value, selected);
+            break;
+        case EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO:
+            filterIntegers<T, std::greater_equal<int64_t> >(minipage, count, value, selected);
+            break;
+        default:
+            assert(false);
+    }
+}
+
+// NValue::compareDoubleValue() decides equal, then greater, else less
+struct DoubleLess {
+    bool operator()(double a, double b) const { return !(a == b) && !(a > b); }
+};
+struct DoubleLessEqual {
+    bool operator()(double a, double b) const { return !(a > b) || a == b; }
+};
+struct DoubleGreaterEqual {
+    bool operator()(double a, double b) const { return a == b || a > b; }
+};
+
+template <typename Compare>
+static void filterDoubles(const char *minipage, uint32_t count, double value, char *selected) {
+    const double *values = reinterpret_cast<const double*>(minipage);
+    const Compare compare = Compare();
+    for (uint32_t i = 0; i < count; i++) {
+        selected[i] = static_cast<char>(selected[i] & compare(values[i], value));
+    }
+}
+
+static void filterDoubles(const char *minipage, uint32_t count, ExpressionType op,
+                          double value, char *selected) {
+    switch (op) {
+        case EXPRESSION_TYPE_COMPARE_EQUAL:
+            filterDoubles<std::equal_to<double> >(minipage, count, value, selected);
+            break;
+        case EXPRESSION_TYPE_COMPARE_NOTEQUAL:
+            filterDoubles<std::not_equal_to<double> >(minipage, count, value, selected);
+            break;
+        case EXPRESSION_TYPE_COMPARE_LESSTHAN:
+            filterDoubles<DoubleLess>(minipage, count, value, selected);
+            break;
+        case EXPRESSION_TYPE_COMPARE_GREATERTHAN:
+            filterDoubles<std::greater<double> >(minipage, count, value, selected);
+            break;
+        case EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO:
+            filterDoubles<DoubleLessEqual>(minipage, count, value, selected);
+            break;
+        case EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO:
+            filterDoubles<DoubleGreaterEqual>(minipage, count, value, selected);
+            break;
+        default:
+            assert(false);
+    }
+}
+
+static bool isInteger(ValueType type) {
+    switch (type) {
+        case VALUE_TYPE_TINYINT:
+        case VALUE_TYPE_SMALLINT:
+        case VALUE_TYPE_INTEGER:
+        case VALUE_TYPE_BIGINT:
+        case VALUE_TYPE_TIMESTAMP:
+            return true;
+        default:
+            return false;
+    }
+}
+
+PaxScanIterator::PaxScanIterator(Table *table, const AbstractExpression *predicate)
+    : m_table(table), m_minipages(table->paxMinipages()), m_filter(predicate),
+      m_others(m_filter.others()),
+      m_blockIndex(0), m_blockCount(static_cast<uint32_t>(table->allocatedBlockCount())),
+      m_slot(0), m_slotCount(0), m_rows(NULL), m_selected(table->m_tuplesPerBlock)
+{
+    assert(m_minipages != NULL);
+    const TupleSchema *schema = table->schema();
+    const std::vector<ColumnComparison> &comparisons = m_filter.comparisons();
+    for (size_t i = 0; i < comparisons.size(); i++) {
+        const ColumnComparison &comparison = comparisons[i];
+        const int offset = m_minipages->minipageOffset(comparison.column);
+        const ValueType columnType = schema->columnType(comparison.column);
+        const ValueType valueType = ValuePeeker::peekValueType(comparison.value);
+
+        // the same integer comparison either way round, but NaNs make the
+        // double one depend on which side the value is
+        MinipageComparison minipage;
+        minipage.offset = offset;
+        minipage.type = columnType;
+        minipage.op = comparison.op;
+        minipage.integer = 0;
+        minipage.real = 0;
+        if (offset >= 0 && isInteger(columnType) && isInteger(valueType)) {
+            minipage.integer = ValuePeeker::peekAsBigInt(comparison.value);
+            m_minipageComparisons.push_back(minipage);
+        } else if (offset >= 0 && columnType == VALUE_TYPE_DOUBLE &&
+                   valueType == VALUE_TYPE_DOUBLE && !comparison.valueOnLeft) {
+            minipage.real = ValuePeeker::peekDouble(comparison.value);
+            m_minipageComparisons.push_back(minipage);
+        } else {
+            m_others.push_back(comparison.expression);
+        }
+    }
+    if (table->zoneMaps() != NULL) {
+        m_zoneComparisons = table->zoneMaps()->comparisons(m_filter);
+    }
+}
+
+void PaxScanIterator::filterBlock(const char *minipages) {
+    char *selected = &m_selected[0];
+    ::memcpy(selected, minipages, m_slotCount);
+    for (size_t i = 0; i < m_minipageComparisons.size(); i++) {
+        const MinipageComparison &comparison = m_minipageComparisons[i];
+        const char *minipage = minipages + comparison.offset;
+        switch (comparison.type) {
+            case VALUE_TYPE_TINYINT:
+                filterIntegers<int8_t>(minipage, m_slotCount, comparison.op, comparison.integer, selected);
+                break;
+            case VALUE_TYPE_SMALLINT:
+                filterIntegers<int16_t>(minipage, m_slotCount, comparison.op, comparison.integer, selected);
+                break;
+            case VALUE_TYPE_INTEGER:
+                filterIntegers<int32_t>(minipage, m_slotCount, comparison.op, comparison.integer, selected);
+                break;
+            case VALUE_TYPE_BIGINT:
+            case VALUE_TYPE_TIMESTAMP:
+                filterIntegers<int64_t>(minipage, m_slotCount, comparison.op, comparison.integer, selected);
+                break;
+            case VALUE_TYPE_DOUBLE:
+                filterDoubles(minipage, m_slotCount, comparison.op, comparison.real, selected);
+                break;
+            default:
+                assert(false);
+        }
+    }
+}
+
+bool PaxScanIterator::nextBlock() {
+    while (m_blockIndex < m_blockCount) {
+        const uint32_t blockIndex = m_blockIndex++;
+        const ZoneMaps *zoneMaps = m_table->zoneMaps();
+        if (zoneMaps != NULL && !zoneMaps->mayMatch(blockIndex, m_zoneComparisons)) {
+            continue;
+        }
+        const char *minipages = m_minipages->block(blockIndex, &m_slotCount);
+        if (m_slotCount == 0) {
+            continue;
+        }
+        m_rows = m_table->m_data[blockIndex];
+        m_slot = 0;
+        filterBlock(minipages);
+
+        // every live tuple was looked at, as a TableIterator would have
+        uint32_t live = 0;
+        for (uint32_t i = 0; i < m_slotCount; i++) {
+            live += static_cast<uint32_t>(minipages[i]);
+        }
+        m_table->updateTupleAccessCount(live);
+        return true;
+    }
+    return false;
+}
+
+bool PaxScanIterator::matchesOthers(const TableTuple &tuple) const {
+    for (size_t i = 0; i < m_others.size(); i++) {
+        if (!m_others[i]->eval(&tuple, NULL).isTrue()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool PaxScanIterator::next(TableTuple &out) {
+    while (true) {
+        while (m_slot < m_slotCount) {
+            const uint32_t slot = m_slot++;
+            if (m_selected[slot]) {
+                out.move(m_rows + static_cast<size_t>(slot) * m_table->m_tupleLength);
+                if (matchesOthers(out)) {
+                    return true;
+                }
+            }
+        }
+        if (!nextBlock()) {
+            return false;
+        }
+    }
+}
+
+}
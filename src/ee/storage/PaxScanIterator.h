@@ -0,0 +1,93 @@
+/* Copyright (C) 2014 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef HSTOREPAXSCANITERATOR_H
+#define HSTOREPAXSCANITERATOR_H
+
+#include <vector>
+#include "common/tabletuple.h"
+#include "storage/ScanFilter.h"
+#include "storage/ZoneMaps.h"
+#include "storage/TupleIterator.h"
+
+namespace voltdb {
+
+class Table;
+class PaxMinipages;
+
+/**
+ * Scans a table that has the PAX layout and hands out the tuples that
+ * match a predicate, in the order a TableIterator visits them. For every
+ * block, the comparisons of a fixed width numeric column with a value are
+ * evaluated over the column's minipage in tight loops, starting from the
+ * block's live flags. Only the rows of the tuples that pass all of them
+ * are read, to evaluate the rest of the predicate. If the table also has
+ * zone maps, the blocks they rule out are not looked at.
+ */
+class PaxScanIterator : public TupleIterator {
+public:
+    /**
+     * The table must have its PAX layout enabled. The predicate must have
+     * had its parameters substituted and must outlive the iterator.
+     */
+    PaxScanIterator(Table *table, const AbstractExpression *predicate);
+
+    bool next(TableTuple &out);
+
+private:
+    // a comparison evaluated over a minipage
+    struct MinipageComparison {
+        int offset;
+        ValueType type;
+        ExpressionType op;
+        int64_t integer;
+        double real;
+    };
+
+    bool nextBlock();
+    void filterBlock(const char *minipages);
+    bool matchesOthers(const TableTuple &tuple) const;
+
+    Table *m_table;
+    PaxMinipages *m_minipages;
+    ScanFilter m_filter;
+    std::vector<MinipageComparison> m_minipageComparisons;
+    // the rest of the predicate, evaluated on the rows
+    std::vector<const AbstractExpression*> m_others;
+    // the comparisons that can skip whole blocks, if the table has zone maps
+    std::vector<ZoneComparison> m_zoneComparisons;
+
+    // the block being scanned and the slots in it that passed the minipages
+    uint32_t m_blockIndex;
+    uint32_t m_blockCount;
+    uint32_t m_slot;
+    uint32_t m_slotCount;
+    char *m_rows;
+    std::vector<char> m_selected;
+};
+
+}
+
+#endif
@@ -0,0 +1,106 @@
+/* Copyright (C) 2014 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "storage/ScanFilter.h"
+#include "expressions/abstractexpression.h"
+#include "expressions/tuplevalueexpression.h"
+
+namespace voltdb {
+
+// the operator that gives the same result with its operands swapped
+static ExpressionType swapOperands(ExpressionType op) {
+    switch (op) {
+        case EXPRESSION_TYPE_COMPARE_LESSTHAN:
+            return EXPRESSION_TYPE_COMPARE_GREATERTHAN;
+        case EXPRESSION_TYPE_COMPARE_GREATERTHAN:
+            return EXPRESSION_TYPE_COMPARE_LESSTHAN;
+        case EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO:
+            return EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO;
+        case EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO:
+            return EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO;
+        default:
+            return op;
+    }
+}
+
+ScanFilter::ScanFilter(const AbstractExpression *predicate) {
+    if (predicate != NULL) {
+        split(predicate);
+    }
+}
+
+bool ScanFilter::isValue(const AbstractExpression *expression) const {
+    return expression->getExpressionType() == EXPRESSION_TYPE_VALUE_CONSTANT ||
+           expression->getExpressionType() == EXPRESSION_TYPE_VALUE_PARAMETER;
+}
+
+void ScanFilter::split(const AbstractExpression *expression) {
+    const ExpressionType type = expression->getExpressionType();
+    if (type == EXPRESSION_TYPE_CONJUNCTION_AND) {
+        split(expression->getLeft());
+        split(expression->getRight());
+        return;
+    }
+
+    switch (type) {
+        case EXPRESSION_TYPE_COMPARE_EQUAL:
+        case EXPRESSION_TYPE_COMPARE_NOTEQUAL:
+        case EXPRESSION_TYPE_COMPARE_LESSTHAN:
+        case EXPRESSION_TYPE_COMPARE_GREATERTHAN:
+        case EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO:
+        case EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO: {
+            const AbstractExpression *left = expression->getLeft();
+            const AbstractExpression *right = expression->getRight();
+            const TupleValueExpressionMarker *column = NULL;
+            const AbstractExpression *value = NULL;
+            bool valueOnLeft = false;
+            if (left->getExpressionType() == EXPRESSION_TYPE_VALUE_TUPLE && isValue(right)) {
+                column = dynamic_cast<const TupleValueExpressionMarker*>(left);
+                value = right;
+            } else if (right->getExpressionType() == EXPRESSION_TYPE_VALUE_TUPLE && isValue(left)) {
+                column = dynamic_cast<const TupleValueExpressionMarker*>(right);
+                value = left;
+                valueOnLeft = true;
+            }
+            if (column != NULL) {
+                ColumnComparison comparison;
+                comparison.expression = expression;
+                comparison.column = column->getColumnId();
+                comparison.op = valueOnLeft ? swapOperands(type) : type;
+                // constants and parameters do not look at the tuple
+                comparison.value = value->eval(NULL, NULL);
+                comparison.valueOnLeft = valueOnLeft;
+                m_comparisons.push_back(comparison);
+                return;
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    m_others.push_back(expression);
+}
+
+}
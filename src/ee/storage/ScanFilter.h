@@ -0,0 +1,87 @@
+/* Copyright (C) 2014 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef HSTORESCANFILTER_H
+#define HSTORESCANFILTER_H
+
+#include <vector>
+#include "common/types.h"
+#include "common/NValue.hpp"
+
+namespace voltdb {
+
+class AbstractExpression;
+class TableTuple;
+
+/**
+ * A conjunct of a scan predicate that compares a column of the scanned
+ * tuple with a value that stays the same for the whole scan, a constant
+ * or a parameter that was already substituted.
+ */
+struct ColumnComparison {
+    // the comparison itself, to evaluate it on a tuple
+    const AbstractExpression *expression;
+    int column;
+    // the comparison operator as if the column was on the left
+    ExpressionType op;
+    NValue value;
+    // whether the predicate was written with the value on the left
+    bool valueOnLeft;
+};
+
+/**
+ * Splits a scan predicate into its AND-ed conjuncts. The comparisons of a
+ * column with a value are picked out so that a scan can test them on
+ * something cheaper than the tuple, everything else is kept as it is.
+ * A tuple matches the predicate if it matches all comparisons and all
+ * other conjuncts.
+ */
+class ScanFilter {
+public:
+    /**
+     * The predicate must have had its parameters substituted and must
+     * outlive the filter.
+     */
+    explicit ScanFilter(const AbstractExpression *predicate);
+
+    const std::vector<ColumnComparison>& comparisons() const {
+        return m_comparisons;
+    }
+
+    const std::vector<const AbstractExpression*>& others() const {
+        return m_others;
+    }
+
+private:
+    void split(const AbstractExpression *expression);
+    bool isValue(const AbstractExpression *expression) const;
+
+    std::vector<ColumnComparison> m_comparisons;
+    std::vector<const AbstractExpression*> m_others;
+};
+
+}
+
+#endif
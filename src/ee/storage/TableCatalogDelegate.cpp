@@ -163,6 +163,12 @@ TableCatalogDelegate::init(ExecutorContext *executorContext,
                                       catalog_index->unique(),
                                       isIntsOnly,
                                       schema);
+        index_scheme.mergePolicy.ratio = catalog_index->mergeratio();
+        index_scheme.mergePolicy.threshold = catalog_index->mergethreshold();
+        index_scheme.mergePolicy.memoryKB = catalog_index->mergememory();
+        index_scheme.mergePolicy.intervalMillis = catalog_index->mergeinterval();
+        index_scheme.mergePolicy.bloomBits = catalog_index->bloombits();
+        index_scheme.mergePolicy.bloomHashes = catalog_index->bloomhashes();
         index_map[catalog_index->name()] = index_scheme;
     }
 
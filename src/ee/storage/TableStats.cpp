@@ -38,6 +38,7 @@ vector<string> TableStats::generateTableStatsColumnNames() {
     columnNames.push_back("TUPLE_DATA_MEMORY");
     columnNames.push_back("STRING_DATA_MEMORY");
     columnNames.push_back("INDEX_MEMORY");
+    columnNames.push_back("TUPLE_RECLAIMED_MEMORY");
     
     #ifdef ANTICACHE
     // ACTIVE
@@ -72,6 +73,7 @@ void TableStats::populateTableStatsSchema(
     types.push_back(VALUE_TYPE_INTEGER); columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER)); allowNull.push_back(false);
     types.push_back(VALUE_TYPE_INTEGER); columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER)); allowNull.push_back(false);
     types.push_back(VALUE_TYPE_INTEGER); columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER)); allowNull.push_back(false);
+    types.push_back(VALUE_TYPE_INTEGER); columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER)); allowNull.push_back(false);
     
     #ifdef ANTICACHE
     // ANTICACHE_TUPLES_EVICTED
@@ -153,7 +155,7 @@ TableStats::generateEmptyTableStatsTable()
 TableStats::TableStats(Table* table)
     : StatsSource(), m_table(table), m_lastTupleCount(0), m_lastTupleAccessCount(0),
       m_lastAllocatedTupleMemory(0), m_lastOccupiedTupleMemory(0),
-      m_lastStringDataMemory(0), m_lastIndexMemory(0)
+      m_lastStringDataMemory(0), m_lastIndexMemory(0), m_lastReclaimedTupleMemory(0)
 {
     #ifdef ANTICACHE
     m_lastTuplesEvicted = 0;
@@ -223,6 +225,9 @@ void TableStats::updateStatsTuple(TableTuple *tuple) {
 
     index_mem_kb = index_mem / 1024;
 
+    // freed by compaction, so no longer part of the allocated memory
+    int64_t reclaimed_tuple_mem_kb = m_table->reclaimedTupleMemory() / 1024;
+
     #ifdef ANTICACHE
     int32_t tuplesEvicted = m_table->getTuplesEvicted();
     int32_t blocksEvicted = m_table->getBlocksEvicted();
@@ -256,6 +261,9 @@ void TableStats::updateStatsTuple(TableTuple *tuple) {
         index_mem_kb =
             index_mem_kb - m_lastIndexMemory / 1024;
         m_lastIndexMemory = index_mem;
+        reclaimed_tuple_mem_kb =
+            reclaimed_tuple_mem_kb - (m_lastReclaimedTupleMemory / 1024);
+        m_lastReclaimedTupleMemory = m_table->reclaimedTupleMemory();
         
         #ifdef ANTICACHE
         
@@ -307,6 +315,10 @@ void TableStats::updateStatsTuple(TableTuple *tuple) {
     {
         index_mem_kb = -1;
     }
+    if (reclaimed_tuple_mem_kb > INT32_MAX)
+    {
+        reclaimed_tuple_mem_kb = -1;
+    }
 
     tuple->setNValue(
             StatsSource::m_columnName2Index["TUPLE_COUNT"],
@@ -327,6 +339,9 @@ void TableStats::updateStatsTuple(TableTuple *tuple) {
     tuple->setNValue( StatsSource::m_columnName2Index["INDEX_MEMORY"],
                       ValueFactory::
                       getIntegerValue(static_cast<int32_t>(index_mem_kb)));
+    tuple->setNValue( StatsSource::m_columnName2Index["TUPLE_RECLAIMED_MEMORY"],
+                      ValueFactory::
+                      getIntegerValue(static_cast<int32_t>(reclaimed_tuple_mem_kb)));
     
     #ifdef ANTICACHE
     tuple->setNValue( StatsSource::m_columnName2Index["ANTICACHE_TUPLES_EVICTED"],
@@ -0,0 +1,87 @@
+/* Copyright (C) 2014 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include "storage/ZoneMapScanIterator.h"
+#include "storage/table.h"
+
+namespace voltdb {
+
+ZoneMapScanIterator::ZoneMapScanIterator(const Table *table, const AbstractExpression *predicate)
+    : m_table(table), m_zoneMaps(table->zoneMaps()),
+      m_blockIndex(0), m_blockCount(static_cast<uint32_t>(table->allocatedBlockCount())),
+      m_slot(0), m_slotCount(0), m_rows(NULL),
+      m_activeTuples(static_cast<uint32_t>(table->activeTupleCount())), m_seenTuples(0)
+{
+    assert(m_zoneMaps != NULL);
+    assert(table->m_trackOccupancy);
+    m_comparisons = m_zoneMaps->comparisons(ScanFilter(predicate));
+}
+
+bool ZoneMapScanIterator::nextBlock() {
+    const uint32_t perBlock = m_table->m_tuplesPerBlock;
+    const uint32_t used = m_table->m_usedTuples;
+    while (m_blockIndex < m_blockCount && m_seenTuples < m_activeTuples) {
+        const uint32_t blockIndex = m_blockIndex++;
+        const uint32_t first = blockIndex * perBlock;
+        m_rows = m_table->m_data[blockIndex];
+        if (m_rows == NULL || used <= first) {
+            continue;
+        }
+        if (!m_zoneMaps->mayMatch(blockIndex, m_comparisons)) {
+            m_seenTuples += m_zoneMaps->liveCount(blockIndex);
+            continue;
+        }
+        m_slot = 0;
+        m_slotCount = std::min(perBlock, used - first);
+        return true;
+    }
+    return false;
+}
+
+bool ZoneMapScanIterator::next(TableTuple &out) {
+    const uint32_t tupleLength = m_table->m_tupleLength;
+    while (true) {
+        while (m_slot < m_slotCount && m_seenTuples < m_activeTuples) {
+            const uint32_t slot = m_table->nextOccupiedSlot(m_blockIndex - 1, m_slot);
+            if (slot >= m_slotCount) {
+                break;
+            }
+            m_slot = slot + 1;
+            out.move(m_rows + static_cast<size_t>(slot) * tupleLength);
+            if (out.isActive()) {
+                ++m_seenTuples;
+                return true;
+            }
+        }
+        m_slotCount = 0;
+        if (!nextBlock()) {
+            return false;
+        }
+    }
+}
+
+}
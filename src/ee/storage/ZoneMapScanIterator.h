@@ -0,0 +1,77 @@
+/* Copyright (C) 2014 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef HSTOREZONEMAPSCANITERATOR_H
+#define HSTOREZONEMAPSCANITERATOR_H
+
+#include <vector>
+#include "common/tabletuple.h"
+#include "storage/ScanFilter.h"
+#include "storage/ZoneMaps.h"
+#include "storage/TupleIterator.h"
+
+namespace voltdb {
+
+class Table;
+
+/**
+ * Scans a table that has zone maps and hands out the live tuples of the
+ * blocks that might hold a match of the predicate, in the order a
+ * TableIterator visits them. Within a block, only the slots set in the
+ * table's occupancy bitmap are looked at. The predicate still has to be evaluated on
+ * every tuple that comes out.
+ */
+class ZoneMapScanIterator : public TupleIterator {
+public:
+    /**
+     * The table must have zone maps. The predicate must have had its
+     * parameters substituted and must outlive the iterator.
+     */
+    ZoneMapScanIterator(const Table *table, const AbstractExpression *predicate);
+
+    bool next(TableTuple &out);
+
+private:
+    bool nextBlock();
+
+    const Table *m_table;
+    const ZoneMaps *m_zoneMaps;
+    std::vector<ZoneComparison> m_comparisons;
+
+    // the block being scanned
+    uint32_t m_blockIndex;
+    uint32_t m_blockCount;
+    uint32_t m_slot;
+    uint32_t m_slotCount;
+    char *m_rows;
+
+    // live tuples handed out or skipped along with their blocks
+    uint32_t m_activeTuples;
+    uint32_t m_seenTuples;
+};
+
+}
+
+#endif
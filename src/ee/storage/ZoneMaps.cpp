@@ -0,0 +1,233 @@
+/* Copyright (C) 2014 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cassert>
+#include <cstring>
+#include "storage/ZoneMaps.h"
+#include "storage/ScanFilter.h"
+#include "storage/table.h"
+#include "storage/tableiterator.h"
+#include "common/tabletuple.h"
+#include "common/ValuePeeker.hpp"
+
+namespace voltdb {
+
+static bool isInteger(ValueType type) {
+    switch (type) {
+        case VALUE_TYPE_TINYINT:
+        case VALUE_TYPE_SMALLINT:
+        case VALUE_TYPE_INTEGER:
+        case VALUE_TYPE_BIGINT:
+        case VALUE_TYPE_TIMESTAMP:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// NValue::compare() sees a null integer as the BIGINT null, the smallest value
+static bool satisfies(int64_t v, ExpressionType op, int64_t value) {
+    switch (op) {
+        case EXPRESSION_TYPE_COMPARE_EQUAL:
+            return v == value;
+        case EXPRESSION_TYPE_COMPARE_NOTEQUAL:
+            return v != value;
+        case EXPRESSION_TYPE_COMPARE_LESSTHAN:
+            return v < value;
+        case EXPRESSION_TYPE_COMPARE_GREATERTHAN:
+            return v > value;
+        case EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO:
+            return v <= value;
+        case EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO:
+            return v >= value;
+        default:
+            return true;
+    }
+}
+
+// whether some v in [min, max] satisfies it
+static bool rangeSatisfies(int64_t min, int64_t max, ExpressionType op, int64_t value) {
+    switch (op) {
+        case EXPRESSION_TYPE_COMPARE_EQUAL:
+            return min <= value && value <= max;
+        case EXPRESSION_TYPE_COMPARE_NOTEQUAL:
+            return min != max || min != value;
+        case EXPRESSION_TYPE_COMPARE_LESSTHAN:
+        case EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO:
+            return satisfies(min, op, value);
+        case EXPRESSION_TYPE_COMPARE_GREATERTHAN:
+        case EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO:
+            return satisfies(max, op, value);
+        default:
+            return true;
+    }
+}
+
+ZoneMaps::ZoneMaps(const Table *table, const std::vector<int> &columns)
+    : m_table(table), m_columns(columns)
+{
+    const TupleSchema *schema = table->schema();
+    for (size_t i = 0; i < m_columns.size(); i++) {
+        const ValueType type = schema->columnType(m_columns[i]);
+        assert(isInteger(type));
+        m_types.push_back(type);
+        m_rowOffsets.push_back(TUPLE_HEADER_SIZE + schema->columnOffset(m_columns[i]));
+    }
+    rebuild();
+}
+
+int64_t ZoneMaps::valueAt(const char *tupleAddress, size_t i) const {
+    const char *data = tupleAddress + m_rowOffsets[i];
+    switch (m_types[i]) {
+        case VALUE_TYPE_TINYINT: {
+            const int8_t v = *reinterpret_cast<const int8_t*>(data);
+            return v == INT8_NULL ? INT64_NULL : v;
+        }
+        case VALUE_TYPE_SMALLINT: {
+            const int16_t v = *reinterpret_cast<const int16_t*>(data);
+            return v == INT16_NULL ? INT64_NULL : v;
+        }
+        case VALUE_TYPE_INTEGER: {
+            const int32_t v = *reinterpret_cast<const int32_t*>(data);
+            return v == INT32_NULL ? INT64_NULL : v;
+        }
+        default:
+            return *reinterpret_cast<const int64_t*>(data);
+    }
+}
+
+int ZoneMaps::blockOf(const TableTuple &tuple) {
+    const int blockIndex = m_table->m_blockDirectory.find(tuple.address());
+    assert(blockIndex >= 0);
+    if (blockIndex >= 0 && static_cast<size_t>(blockIndex) >= m_liveCounts.size()) {
+        const size_t blocks = blockIndex + 1;
+        const size_t first = m_liveCounts.size();
+        m_liveCounts.resize(blocks, 0);
+        m_zones.resize(blocks * m_columns.size());
+        for (size_t b = first; b < blocks; b++) {
+            clearBlock(static_cast<uint32_t>(b));
+        }
+    }
+    return blockIndex;
+}
+
+void ZoneMaps::clearBlock(uint32_t blockIndex) {
+    Zone *zones = &m_zones[blockIndex * m_columns.size()];
+    for (size_t i = 0; i < m_columns.size(); i++) {
+        zones[i].min = INT64_MAX;
+        zones[i].max = INT64_MIN;
+        zones[i].nullCount = 0;
+    }
+}
+
+void ZoneMaps::insert(const TableTuple &tuple) {
+    const int blockIndex = blockOf(tuple);
+    if (blockIndex < 0) {
+        return;
+    }
+    Zone *zones = &m_zones[blockIndex * m_columns.size()];
+    for (size_t i = 0; i < m_columns.size(); i++) {
+        const int64_t v = valueAt(tuple.address(), i);
+        if (v == INT64_NULL) {
+            zones[i].nullCount++;
+        } else {
+            if (v < zones[i].min) zones[i].min = v;
+            if (v > zones[i].max) zones[i].max = v;
+        }
+    }
+    m_liveCounts[blockIndex]++;
+}
+
+void ZoneMaps::remove(const TableTuple &tuple) {
+    const int blockIndex = blockOf(tuple);
+    if (blockIndex < 0) {
+        return;
+    }
+    assert(m_liveCounts[blockIndex] > 0);
+    if (--m_liveCounts[blockIndex] == 0) {
+        clearBlock(blockIndex);
+        return;
+    }
+    Zone *zones = &m_zones[blockIndex * m_columns.size()];
+    for (size_t i = 0; i < m_columns.size(); i++) {
+        if (valueAt(tuple.address(), i) == INT64_NULL) {
+            assert(zones[i].nullCount > 0);
+            zones[i].nullCount--;
+        }
+    }
+}
+
+void ZoneMaps::rebuild() {
+    m_zones.clear();
+    m_liveCounts.clear();
+    TableIterator iterator(m_table);
+    TableTuple tuple(m_table->schema());
+    while (iterator.next(tuple)) {
+        insert(tuple);
+    }
+}
+
+std::vector<ZoneComparison> ZoneMaps::comparisons(const ScanFilter &filter) const {
+    std::vector<ZoneComparison> result;
+    const std::vector<ColumnComparison> &columnComparisons = filter.comparisons();
+    for (size_t c = 0; c < columnComparisons.size(); c++) {
+        const ColumnComparison &comparison = columnComparisons[c];
+        if (!isInteger(ValuePeeker::peekValueType(comparison.value)) || comparison.value.isNull()) {
+            continue;
+        }
+        for (size_t i = 0; i < m_columns.size(); i++) {
+            if (m_columns[i] == comparison.column) {
+                ZoneComparison zone;
+                zone.summary = static_cast<int>(i);
+                zone.op = comparison.op;
+                zone.value = ValuePeeker::peekAsBigInt(comparison.value);
+                result.push_back(zone);
+                break;
+            }
+        }
+    }
+    return result;
+}
+
+bool ZoneMaps::mayMatch(uint32_t blockIndex, const std::vector<ZoneComparison> &comparisons) const {
+    if (liveCount(blockIndex) == 0) {
+        return false;
+    }
+    const Zone *zones = &m_zones[blockIndex * m_columns.size()];
+    for (size_t c = 0; c < comparisons.size(); c++) {
+        const ZoneComparison &comparison = comparisons[c];
+        const Zone &zone = zones[comparison.summary];
+        const bool values = zone.min <= zone.max &&
+            rangeSatisfies(zone.min, zone.max, comparison.op, comparison.value);
+        const bool nulls = zone.nullCount > 0 &&
+            satisfies(INT64_NULL, comparison.op, comparison.value);
+        if (!values && !nulls) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
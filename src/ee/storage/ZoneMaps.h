@@ -0,0 +1,138 @@
+/* Copyright (C) 2014 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef HSTOREZONEMAPS_H
+#define HSTOREZONEMAPS_H
+
+#include <vector>
+#include <cstddef>
+#include <stdint.h>
+#include "common/types.h"
+
+namespace voltdb {
+
+class Table;
+class TableTuple;
+class ScanFilter;
+
+/**
+ * A comparison of a column that has a zone map with an integer value,
+ * checked against the summaries of a block.
+ */
+struct ZoneComparison {
+    // the position of the column among the zone map columns
+    int summary;
+    // the comparison operator as if the column was on the left
+    ExpressionType op;
+    int64_t value;
+};
+
+/**
+ * Per-block summaries of a few integer columns of a table: the smallest
+ * and the largest value of the live tuples and how many of them are null.
+ * A scan skips the blocks whose summaries show that none of their tuples
+ * can satisfy a comparison of its predicate. Time ranges on columns that
+ * grow with every insert, like order or history dates, only have to look
+ * at the few blocks that were filled within the range.
+ *
+ * The summaries are kept up to date by the table on every insert, update
+ * and delete. A value that leaves a block does not narrow its range, so
+ * the range may be wider than the values it covers, until the block runs
+ * empty and starts over.
+ */
+class ZoneMaps {
+public:
+    /**
+     * Summaries of the given columns, which must be TINYINT, SMALLINT,
+     * INTEGER, BIGINT or TIMESTAMP. The tuples already in the table are
+     * summarized right away.
+     */
+    ZoneMaps(const Table *table, const std::vector<int> &columns);
+
+    inline const std::vector<int>& columns() const {
+        return m_columns;
+    }
+
+    /**
+     * The tuple was written to its slot and is live now.
+     */
+    void insert(const TableTuple &tuple);
+
+    /**
+     * The live tuple is about to be deleted or overwritten.
+     */
+    void remove(const TableTuple &tuple);
+
+    /**
+     * Summarizes all blocks again from their live tuples.
+     */
+    void rebuild();
+
+    /**
+     * The comparisons of the filter that the summaries can decide.
+     */
+    std::vector<ZoneComparison> comparisons(const ScanFilter &filter) const;
+
+    /**
+     * Whether any live tuple of the block might satisfy all comparisons.
+     */
+    bool mayMatch(uint32_t blockIndex, const std::vector<ZoneComparison> &comparisons) const;
+
+    /**
+     * How many live tuples the block holds.
+     */
+    inline uint32_t liveCount(uint32_t blockIndex) const {
+        return blockIndex < m_liveCounts.size() ? m_liveCounts[blockIndex] : 0;
+    }
+
+    size_t getBytesAllocated() const {
+        return m_zones.capacity() * sizeof(Zone) + m_liveCounts.capacity() * sizeof(uint32_t);
+    }
+
+private:
+    struct Zone {
+        // min > max while the block has no non-null value
+        int64_t min;
+        int64_t max;
+        uint32_t nullCount;
+    };
+
+    int blockOf(const TableTuple &tuple);
+    void clearBlock(uint32_t blockIndex);
+    int64_t valueAt(const char *tupleAddress, size_t i) const;
+
+    const Table *m_table;
+    std::vector<int> m_columns;
+    std::vector<ValueType> m_types;
+    std::vector<uint32_t> m_rowOffsets;
+
+    // the summaries of block b are m_zones[b * m_columns.size()] and on
+    std::vector<Zone> m_zones;
+    std::vector<uint32_t> m_liveCounts;
+};
+
+}
+
+#endif
@@ -86,17 +86,417 @@
 #include "anticache/UnknownBlockAccessException.h"
 #endif
 
+#include <algorithm>
 #include <map>
 
 namespace voltdb {
   
+  namespace {
+    const uint32_t CHECKPOINT_MAGIC = 0x4d4d4150;    // "MMAP"
+    const uint32_t CHECKPOINT_VERSION = 1;
+
+    /**
+     * Header of the checkpoint file, followed by the file offset of every
+     * block. The checksum covers the header (with the checksum zero) and
+     * the offsets.
+     */
+    struct CheckpointHeader {
+      uint32_t magic;
+      uint32_t version;
+      int64_t epoch;
+      uint64_t schemaSignature;
+      uint32_t tupleLength;
+      uint32_t tuplesPerBlock;
+      uint64_t blockSize;
+      uint64_t blockCount;
+      uint64_t usedTuples;
+      uint64_t dataBytes;
+      uint64_t checksum;
+    };
+
+    inline uint64_t fnv(uint64_t hash, const void *data, size_t length) {
+      const unsigned char *bytes = static_cast<const unsigned char*>(data);
+      for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+      }
+      return hash;
+    }
+
+    const uint64_t FNV_OFFSET = 0xcbf29ce484222325ULL;
+
+    uint64_t checksumOf(const std::vector<char> &header) {
+      CheckpointHeader copy;
+      memcpy(&copy, &header[0], sizeof(copy));
+      copy.checksum = 0;
+      uint64_t hash = fnv(FNV_OFFSET, &copy, sizeof(copy));
+      return fnv(hash, &header[sizeof(copy)], header.size() - sizeof(copy));
+    }
+
+    void syncDirectory(const std::string &fileName) {
+      const std::string dir = fileName.substr(0, fileName.rfind('/') + 1);
+      int fd = open(dir.empty() ? "." : dir.c_str(), O_RDONLY);
+      if (fd >= 0) {
+        fsync(fd);
+        close(fd);
+      }
+    }
+
+    struct IndexBuild {
+      TableIndex *index;
+      const std::vector<TableTuple> *tuples;
+      bool failed;
+    };
+
+    void* buildIndex(void *arg) {
+      IndexBuild *build = static_cast<IndexBuild*>(arg);
+      try {
+        build->index->addEntries(*build->tuples);
+      } catch (...) {
+        build->failed = true;
+      }
+      return NULL;
+    }
+  }
+
   MMAP_PersistentTable::MMAP_PersistentTable(ExecutorContext *ctx, const std::string &name, bool exportEnabled) :
   PersistentTable(ctx,name,exportEnabled), // enable MMAP'ed pool
-  m_name(name)
+  m_name(name),
+  m_segmentSize(MMAPMemoryManager::DEFAULT_SEGMENT_SIZE),
+  m_accessPattern(MMAP_ACCESS_NORMAL),
+  m_writeGeneration(0),
+  m_pendingEpoch(-1),
+  m_checkpointEpoch(-1),
+  m_headerOnDisk(false)
   {
-    const unsigned int DEFAULT_MMAP_SIZE = 256*1024*1024;
+    #ifdef STORAGE_MMAP
+    // the file grows by segments of the configured size, at least a block each
+    if (ctx->getFileSize() > 0) {
+      m_segmentSize = std::max((size_t)ctx->getFileSize(), (size_t)m_tableAllocationTargetSize);
+    }
+    m_accessPattern = ctx->getMMAPAccessPattern();
+    #endif
+    pthread_mutex_init(&m_checkpointMutex, NULL);
+    // the data file is opened with the first block, or by reattach()
+  }
 
-    m_data_manager = new MMAPMemoryManager(DEFAULT_MMAP_SIZE, m_executorContext->getDBDir()+"/"+name+"_Data", true); // backed by a file
+  MMAP_PersistentTable::~MMAP_PersistentTable() {
+    // the syncer may still be about to report to this table
+    if (m_data_manager != NULL) {
+      m_data_manager->waitForSync();
+    }
+    pthread_mutex_destroy(&m_checkpointMutex);
+  }
+
+  // the manager maps <dataFileName>.nvm
+  std::string MMAP_PersistentTable::dataFileName() const {
+    return m_executorContext->getDBDir() + "/" + m_name + "_Data";
+  }
+
+  std::string MMAP_PersistentTable::headerFileName() const {
+    return dataFileName() + ".meta";
+  }
+
+  void MMAP_PersistentTable::openDataFile(size_t reopenBytes) {
+    assert(m_data_manager == NULL);
+    if (reopenBytes == 0) {
+      // a fresh file makes the checkpoint of the previous run stale
+      removeHeader();
+    }
+    m_data_manager = new MMAPMemoryManager(m_segmentSize, dataFileName(), true, reopenBytes); // backed by a file
+    m_data_manager->setAccessPattern(m_accessPattern);
+  }
+
+  uint64_t MMAP_PersistentTable::schemaSignature() const {
+    uint64_t hash = FNV_OFFSET;
+    for (int i = 0; i < m_schema->columnCount(); i++) {
+      const int32_t column[4] = { static_cast<int32_t>(m_schema->columnType(i)),
+                                  static_cast<int32_t>(m_schema->columnLength(i)),
+                                  m_schema->columnAllowNull(i) ? 1 : 0,
+                                  m_schema->columnIsInlined(i) ? 1 : 0 };
+      hash = fnv(hash, column, sizeof(column));
+    }
+    const uint32_t tupleLength = m_schema->tupleLength();
+    return fnv(hash, &tupleLength, sizeof(tupleLength));
+  }
+
+  void MMAP_PersistentTable::buildHeader(int64_t epoch, std::vector<char> &header) const {
+    header.assign(sizeof(CheckpointHeader) + m_data.size() * sizeof(uint64_t), 0);
+    CheckpointHeader h;
+    memset(&h, 0, sizeof(h));
+    h.magic = CHECKPOINT_MAGIC;
+    h.version = CHECKPOINT_VERSION;
+    h.epoch = epoch;
+    h.schemaSignature = schemaSignature();
+    h.tupleLength = m_tupleLength;
+    h.tuplesPerBlock = m_tuplesPerBlock;
+    h.blockSize = m_tableAllocationTargetSize;
+    h.blockCount = m_data.size();
+    h.usedTuples = m_usedTuples;
+
+    uint64_t *offsets = reinterpret_cast<uint64_t*>(&header[sizeof(h)]);
+    for (size_t i = 0; i < m_data.size(); i++) {
+      const size_t offset = m_data_manager->fileOffsetOf(m_data[i]);
+      assert(offset != MMAPMemoryManager::npos);
+      offsets[i] = offset;
+      h.dataBytes = std::max(h.dataBytes, static_cast<uint64_t>(offset + h.blockSize));
+    }
+    memcpy(&header[0], &h, sizeof(h));
+    h.checksum = checksumOf(header);
+    memcpy(&header[0], &h, sizeof(h));
+  }
+
+  bool MMAP_PersistentTable::writeHeader(const std::vector<char> &header) {
+    // written aside and renamed, so the header is either all there or not
+    const std::string fileName = headerFileName();
+    const std::string tmpName = fileName + ".tmp";
+    int fd = open(tmpName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+      VOLT_ERROR("MMAP : Failed to create checkpoint %s: %s", tmpName.c_str(), strerror(errno));
+      return false;
+    }
+    size_t written = 0;
+    while (written < header.size()) {
+      ssize_t ret = write(fd, &header[written], header.size() - written);
+      if (ret < 0 && errno == EINTR) {
+        continue;
+      }
+      if (ret <= 0) {
+        break;
+      }
+      written += static_cast<size_t>(ret);
+    }
+    const bool ok = written == header.size() && fsync(fd) == 0;
+    close(fd);
+    if (!ok || rename(tmpName.c_str(), fileName.c_str()) != 0) {
+      VOLT_ERROR("MMAP : Failed to write checkpoint %s: %s", fileName.c_str(), strerror(errno));
+      unlink(tmpName.c_str());
+      return false;
+    }
+    syncDirectory(fileName);
+    return true;
+  }
+
+  void MMAP_PersistentTable::removeHeader() {
+    const std::string fileName = headerFileName();
+    if (unlink(fileName.c_str()) == 0) {
+      syncDirectory(fileName);
+    }
+  }
+
+  void MMAP_PersistentTable::storageWriteStarted() {
+    m_storageCheckpointed = false;
+    pthread_mutex_lock(&m_checkpointMutex);
+    m_writeGeneration++;
+    m_pendingHeader.clear();
+    if (m_headerOnDisk) {
+      // the data file is about to differ from the checkpoint
+      removeHeader();
+      m_headerOnDisk = false;
+      m_checkpointEpoch = -1;
+    }
+    pthread_mutex_unlock(&m_checkpointMutex);
+  }
+
+  void MMAP_PersistentTable::requestCheckpoint(int64_t epoch) {
+    if (m_data_manager == NULL) {
+      return;
+    }
+    pthread_mutex_lock(&m_checkpointMutex);
+    const int64_t generation = m_writeGeneration;
+    if (!m_headerOnDisk) {
+      buildHeader(epoch, m_pendingHeader);
+      m_pendingEpoch = epoch;
+    }
+    pthread_mutex_unlock(&m_checkpointMutex);
+    m_storageCheckpointed = true;
+    m_data_manager->syncInBackground(this, generation);
+  }
+
+  void MMAP_PersistentTable::synced(int64_t token) {
+    pthread_mutex_lock(&m_checkpointMutex);
+    if (token == m_writeGeneration && !m_headerOnDisk && !m_pendingHeader.empty()) {
+      m_headerOnDisk = writeHeader(m_pendingHeader);
+      if (m_headerOnDisk) {
+        m_checkpointEpoch = m_pendingEpoch;
+      }
+      m_pendingHeader.clear();
+    }
+    pthread_mutex_unlock(&m_checkpointMutex);
+  }
+
+  void MMAP_PersistentTable::checkpoint(int64_t epoch) {
+    if (m_data_manager == NULL) {
+      return;
+    }
+    m_data_manager->waitForSync();
+    m_data_manager->sync();
+    pthread_mutex_lock(&m_checkpointMutex);
+    if (!m_headerOnDisk) {
+      buildHeader(epoch, m_pendingHeader);
+      m_headerOnDisk = writeHeader(m_pendingHeader);
+      if (m_headerOnDisk) {
+        m_checkpointEpoch = epoch;
+      }
+      m_pendingHeader.clear();
+    }
+    pthread_mutex_unlock(&m_checkpointMutex);
+    m_storageCheckpointed = true;
+  }
+
+  int64_t MMAP_PersistentTable::getCheckpointEpoch() {
+    pthread_mutex_lock(&m_checkpointMutex);
+    const int64_t epoch = m_checkpointEpoch;
+    pthread_mutex_unlock(&m_checkpointMutex);
+    return epoch;
+  }
+
+  bool MMAP_PersistentTable::readCheckpoint(std::vector<char> &header) const {
+    const std::string fileName = headerFileName();
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(CheckpointHeader)) {
+      header.resize(static_cast<size_t>(st.st_size));
+      if (pread(fd, &header[0], header.size(), 0) != (ssize_t)header.size()) {
+        header.clear();
+      }
+    }
+    close(fd);
+    if (header.empty()) {
+      VOLT_WARN("MMAP : Could not read checkpoint %s", fileName.c_str());
+      return false;
+    }
+
+    CheckpointHeader h;
+    memcpy(&h, &header[0], sizeof(h));
+    if (h.magic != CHECKPOINT_MAGIC || h.version != CHECKPOINT_VERSION ||
+        header.size() != sizeof(h) + h.blockCount * sizeof(uint64_t) ||
+        h.checksum != checksumOf(header)) {
+      VOLT_WARN("MMAP : Checkpoint %s is corrupt", fileName.c_str());
+      return false;
+    }
+    if (h.schemaSignature != schemaSignature() || h.tupleLength != m_tupleLength ||
+        h.tuplesPerBlock != m_tuplesPerBlock || h.blockSize != (uint64_t)m_tableAllocationTargetSize ||
+        h.usedTuples > h.blockCount * m_tuplesPerBlock) {
+      VOLT_WARN("MMAP : Checkpoint %s does not match the schema of table %s", fileName.c_str(), m_name.c_str());
+      return false;
+    }
+    const uint64_t *offsets = reinterpret_cast<const uint64_t*>(&header[sizeof(h)]);
+    for (uint64_t i = 0; i < h.blockCount; i++) {
+      if (offsets[i] + h.blockSize > h.dataBytes) {
+        VOLT_WARN("MMAP : Checkpoint %s is corrupt", fileName.c_str());
+        return false;
+      }
+    }
+    struct stat dataStat;
+    if (stat((dataFileName() + ".nvm").c_str(), &dataStat) != 0 || (uint64_t)dataStat.st_size < h.dataBytes) {
+      VOLT_WARN("MMAP : Data file of table %s is shorter than its checkpoint", m_name.c_str());
+      return false;
+    }
+    return true;
+  }
+
+  bool MMAP_PersistentTable::hasDataFile() const {
+    struct stat st;
+    return stat((dataFileName() + ".nvm").c_str(), &st) == 0 && st.st_size > 0;
+  }
+
+  bool MMAP_PersistentTable::isReattachable() const {
+    // uninlined strings live in the pool, whose pointers do not survive a
+    // restart, and evicted tuples live in the anti-cache
+    #ifdef ANTICACHE
+    if (m_executorContext->isAntiCacheEnabled()) {
+      return false;
+    }
+    #endif
+    return m_data_manager == NULL && m_usedTuples == 0 &&
+           m_schema->getUninlinedObjectColumnCount() == 0;
+  }
+
+  bool MMAP_PersistentTable::canReattach() const {
+    std::vector<char> header;
+    return isReattachable() && readCheckpoint(header);
+  }
+
+  bool MMAP_PersistentTable::reattach() {
+    std::vector<char> header;
+    if (!isReattachable() || !readCheckpoint(header)) {
+      return false;
+    }
+    CheckpointHeader h;
+    memcpy(&h, &header[0], sizeof(h));
+    const uint64_t *offsets = reinterpret_cast<const uint64_t*>(&header[sizeof(h)]);
+
+    openDataFile(static_cast<size_t>(h.dataBytes));
+    for (uint64_t i = 0; i < h.blockCount; i++) {
+      char *memory = m_data_manager->addressAt(static_cast<size_t>(offsets[i]), static_cast<size_t>(h.blockSize));
+      if (memory == NULL) {
+        throwFatalException("Failed to map block %ld of table %s", (long)i, m_name.c_str());
+      }
+      m_blockAllocator->advise(memory, static_cast<size_t>(h.blockSize));
+      m_data.push_back(memory);
+      m_blockDirectory.add(memory, (int)m_data.size() - 1);
+      m_allocatedTuples += m_tuplesPerBlock;
+    }
+
+    // the header of every used slot tells whether it holds a tuple
+    m_usedTuples = static_cast<uint32_t>(h.usedTuples);
+    std::vector<TableTuple> tuples;
+    TableTuple tuple(m_schema);
+    for (uint32_t i = 0; i < m_usedTuples; i++) {
+      tuple.move(dataPtrForTuple(i));
+      if (tuple.isActive()) {
+        tuple.setDirtyFalse();
+        markSlot(i, true);
+        tuples.push_back(tuple);
+      } else {
+        m_holeFreeTuples.push_back(tuple.address());
+      }
+    }
+    m_tupleCount = static_cast<uint32_t>(tuples.size());
+    if (m_zoneMaps != NULL) {
+      m_zoneMaps->rebuild();
+    }
+    if (m_paxMinipages != NULL) {
+      m_paxMinipages->invalidateAll();
+    }
+
+    // the indexes are independent of each other, so they are built side by side
+    std::vector<IndexBuild> builds(m_indexCount);
+    std::vector<pthread_t> threads(m_indexCount);
+    std::vector<bool> started(m_indexCount, false);
+    for (int i = 0; i < m_indexCount; i++) {
+      builds[i].index = m_indexes[i];
+      builds[i].tuples = &tuples;
+      builds[i].failed = false;
+      if (tuples.size() > 0 && m_indexCount > 1) {
+        started[i] = pthread_create(&threads[i], NULL, buildIndex, &builds[i]) == 0;
+      }
+      if (!started[i] && tuples.size() > 0) {
+        buildIndex(&builds[i]);
+      }
+    }
+    for (int i = 0; i < m_indexCount; i++) {
+      if (started[i]) {
+        pthread_join(threads[i], NULL);
+      }
+      if (builds[i].failed) {
+        throwFatalException("Failed to rebuild index %s of table %s",
+                            m_indexes[i]->getName().c_str(), m_name.c_str());
+      }
+    }
+
+    pthread_mutex_lock(&m_checkpointMutex);
+    m_headerOnDisk = true;
+    m_checkpointEpoch = h.epoch;
+    pthread_mutex_unlock(&m_checkpointMutex);
+    m_storageCheckpointed = true;
+
+    VOLT_INFO("MMAP : Reattached %d tuples of table %s from epoch %ld",
+              (int)m_tupleCount, m_name.c_str(), (long)h.epoch);
+    return true;
   }
 
   inline void MMAP_PersistentTable::allocateNextBlock() {
@@ -111,6 +511,9 @@ namespace voltdb {
     VOLT_WARN("MMAP : PId:: %d Table: %s  Bytes:: %d ",
 	       m_executorContext->getPartitionId(), this->name().c_str(), bytes);
 
+    if (m_data_manager == NULL) {
+      openDataFile(0);
+    }
     memory = (char*)m_data_manager->allocate(bytes);
     
     VOLT_WARN("MMAP : Table: %s :: Memory Pointer : %p ",
@@ -121,8 +524,12 @@ namespace voltdb {
       throwFatalException("Failed to map file.");
     }
 
+    // the block stays backed by the file, only the placement hints apply
+    m_blockAllocator->advise(memory, bytes);
+
     /** Push into m_data **/
     m_data.push_back(memory);
+    m_blockDirectory.add(memory, (int)m_data.size() - 1);
 
     m_allocatedTuples += m_tuplesPerBlock;
   }
@@ -54,6 +54,7 @@
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <errno.h>
+#include <pthread.h>
 #include <string>
 #include <map>
 #include <vector>
@@ -120,7 +121,7 @@ namespace voltdb {
    * value in data and adds an entry to UndoLog. We chose eager update
    * policy because we expect reverting rarely occurs.
    */
-  class MMAP_PersistentTable : public PersistentTable {
+  class MMAP_PersistentTable : public PersistentTable, public MMAPSyncListener {
     friend class TableFactory;
     friend class ExecutorContext;
 
@@ -129,14 +130,71 @@ namespace voltdb {
     MMAP_PersistentTable();
     MMAP_PersistentTable(MMAP_PersistentTable const&);
     MMAP_PersistentTable operator=(MMAP_PersistentTable const&);
-    
+
+    virtual ~MMAP_PersistentTable();
+
+    /**
+     * Checkpoints the data file as of the given epoch (the undo token of
+     * the last commit) once the background msync queued here finishes.
+     * The checkpoint is a small header file next to the data file that
+     * lists the blocks of the table; it is only written if no tuple was
+     * written to since this call, and removed by the first write after it.
+     */
+    void requestCheckpoint(int64_t epoch);
+
+    /** Same as requestCheckpoint(), but syncs and writes the header before returning */
+    void checkpoint(int64_t epoch);
+
+    /** True if the table is empty and the checkpoint on disk can be reattached */
+    bool canReattach() const;
+
+    /** True if a previous run left tuples in the data file of this table */
+    bool hasDataFile() const;
+
+    /**
+     * Maps the data file of the previous run back in as the blocks of this
+     * (empty) table if its checkpoint header matches the schema, and
+     * rebuilds the indexes from the tuples found in them. Returns false,
+     * leaving the table as it is, if there is nothing to reattach.
+     */
+    bool reattach();
+
+    /** Epoch of the checkpoint on disk, -1 if there is none */
+    int64_t getCheckpointEpoch();
+
+    void synced(int64_t token);
+
   protected:
     MMAP_PersistentTable(ExecutorContext *ctx, const std::string &name, bool exportEnabled);
 
     void allocateNextBlock();
 
-  private:  
-    const std::string m_name;    
+    void storageWriteStarted();
+
+  private:
+    void openDataFile(size_t reopenBytes);
+    bool isReattachable() const;
+    bool readCheckpoint(std::vector<char> &header) const;
+    void buildHeader(int64_t epoch, std::vector<char> &header) const;
+    bool writeHeader(const std::vector<char> &header);
+    void removeHeader();
+    uint64_t schemaSignature() const;
+    std::string dataFileName() const;
+    std::string headerFileName() const;
+
+    const std::string m_name;
+    size_t m_segmentSize;
+    MMAPAccessPattern m_accessPattern;
+
+    // checkpoint state, shared with the syncer thread through the mutex;
+    // every write bumps the generation so that a sync requested before it
+    // does not write the header
+    pthread_mutex_t m_checkpointMutex;
+    int64_t m_writeGeneration;
+    int64_t m_pendingEpoch;
+    int64_t m_checkpointEpoch;
+    std::vector<char> m_pendingHeader;
+    bool m_headerOnDisk;
 
   };
 
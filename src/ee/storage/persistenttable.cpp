@@ -43,9 +43,11 @@
  * OTHER DEALINGS IN THE SOFTWARE.
  */
 
+#include <algorithm>
 #include <sstream>
 #include <cassert>
 #include <cstdio>
+#include <cstring>
 
 #include "boost/scoped_ptr.hpp"
 #include "storage/persistenttable.h"
@@ -59,6 +61,7 @@
 #include "common/FatalException.hpp"
 #include "common/types.h"
 #include "common/Pool.hpp"
+#include "common/ThreadLocalPool.h"
 #include "common/RecoveryProtoMessage.h"
 #include "common/ValueFactory.hpp"
 #include "indexes/tableindex.h"
@@ -100,8 +103,10 @@ PersistentTable::PersistentTable(ExecutorContext *ctx, bool exportEnabled) :
     Table(TABLE_BLOCKSIZE,ctx->isMMAPEnabled()), m_executorContext(ctx), m_uniqueIndexes(NULL), m_uniqueIndexCount(0), m_allowNulls(NULL),
     m_indexes(NULL), m_indexCount(0), m_pkeyIndex(NULL), m_wrapper(NULL),
     m_tsSeqNo(0), stats_(this), m_exportEnabled(exportEnabled),
-    m_COWContext(NULL)
+    m_COWContext(NULL), m_COWMode(COPY_ON_WRITE_TUPLES), m_reclaimedTupleMemory(0)
 {
+    m_blockAllocator = ctx->getBlockAllocator();
+    m_trackOccupancy = true;
 
 #ifdef ANTICACHE
     m_evictedTable = NULL;
@@ -110,6 +115,9 @@ PersistentTable::PersistentTable(ExecutorContext *ctx, bool exportEnabled) :
     m_newestTupleID = 0;
     m_oldestTupleID = 0;
     m_numTuplesInEvictionChain = 0;
+#ifdef ANTICACHE_CLOCK
+    m_clockHand = 0;
+#endif
     m_blockMerge = ctx->isBlockMerge();
     m_batchEvicted = false;
 #endif
@@ -127,8 +135,10 @@ PersistentTable::PersistentTable(ExecutorContext *ctx, const std::string name, b
     Table(TABLE_BLOCKSIZE,ctx->isMMAPEnabled()), m_executorContext(ctx), m_uniqueIndexes(NULL), m_uniqueIndexCount(0), m_allowNulls(NULL),
     m_indexes(NULL), m_indexCount(0), m_pkeyIndex(NULL), m_wrapper(NULL),
     m_tsSeqNo(0), stats_(this), m_exportEnabled(exportEnabled),
-    m_COWContext(NULL)
+    m_COWContext(NULL), m_COWMode(COPY_ON_WRITE_TUPLES), m_reclaimedTupleMemory(0)
 {
+    m_blockAllocator = ctx->getBlockAllocator();
+    m_trackOccupancy = true;
 
 #ifdef ANTICACHE
     m_evictedTable = NULL;
@@ -137,6 +147,9 @@ PersistentTable::PersistentTable(ExecutorContext *ctx, const std::string name, b
     m_newestTupleID = 0;
     m_oldestTupleID = 0;
     m_numTuplesInEvictionChain = 0;
+#ifdef ANTICACHE_CLOCK
+    m_clockHand = 0;
+#endif
     m_blockMerge = ctx->isBlockMerge();
     m_batchEvicted = false;
 #endif
@@ -159,14 +172,18 @@ PersistentTable::PersistentTable(ExecutorContext *ctx, const std::string name, b
 }
 
 PersistentTable::~PersistentTable() {
-    // delete all tuples to free strings
+    // delete all tuples to free strings; the tuples of a file backed
+    // table are left as they are, for the next run to reattach them
     voltdb::TableIterator ti(this);
     voltdb::TableTuple tuple(m_schema);
+    const bool keepTuples = m_data_manager != NULL;
 
     while (ti.next(tuple)) {
         // indexes aren't released as they don't have ownership of strings
         tuple.freeObjectColumns();
-        tuple.setDeletedTrue();
+        if (!keepTuples) {
+            tuple.setDeletedTrue();
+        }
     }
 
     for (int i = 0; i < m_indexCount; ++i) {
@@ -208,6 +225,15 @@ voltdb::Table* PersistentTable::getEvictedTable() {
     return m_evictedTable; 
 }
 
+bool PersistentTable::canEvict() const {
+    for (int i = 0; i < m_indexCount; ++i) {
+        if (m_indexes[i]->keysReferenceTuples()) {
+            return false;
+        }
+    }
+    return true;
+}
+
 void PersistentTable::setBatchEvicted(bool batchEvicted) {
     VOLT_INFO("Marked batch evicted value as '%d' for table '%s'", batchEvicted, this->name().c_str());
     m_batchEvicted = batchEvicted;
@@ -446,13 +472,20 @@ int64_t PersistentTable::unevictTuple(ReferenceSerializeInput * in, int j, int m
         in->getRawPointer(merge_tuple_offset);
     }
         
-    bytesUnevicted = m_tmpTarget1.deserializeWithHeaderFrom(*in);
+    {
+        ThreadLocalPool::Scope strings(&m_stringStorage);
+        bytesUnevicted = m_tmpTarget1.deserializeWithHeaderFrom(*in);
+    }
+    if (m_zoneMaps != NULL) {
+        m_zoneMaps->insert(m_tmpTarget1);
+    }
 
     // Note, this goal of the section below is to get a tuple that points to the tuple in the EvictedTable and has the
     // schema of the evicted tuple. However, the lookup has to be done using the schema of the original (unevicted) version
     m_tmpTarget2 = lookupTuple(m_tmpTarget1);       // lookup the tuple in the table
     //printf("%d\n", m_tmpTarget2.isEvicted());
     if (!m_tmpTarget2.isEvicted()) {
+        m_tmpTarget1.freeObjectColumns();
         deleteTupleStorage(m_tmpTarget1);
         return 0;
     }
@@ -464,7 +497,6 @@ int64_t PersistentTable::unevictTuple(ReferenceSerializeInput * in, int j, int m
     // update the indexes to point to this newly unevicted tuple
     VOLT_TRACE("BEFORE: tuple.isEvicted() = %d", m_tmpTarget1.isEvicted());
     setEntryToNewAddressForAllIndexes(&m_tmpTarget1, m_tmpTarget1.address(), m_tmpTarget2.address());
-    updateStringMemory((int)m_tmpTarget1.getNonInlinedMemorySize());
 
     //deleteFromAllIndexes(&m_tmpTarget1);
     //insertTuple(m_tmpTarget1);
@@ -529,9 +561,15 @@ bool PersistentTable::insertTuple(TableTuple &source) {
     // Then copy the source into the target
     //
     /** Don't use MMAP pool **/
-    m_tmpTarget1.copyForPersistentInsert(source, NULL); // tuple in freelist must be already cleared
+    {
+        ThreadLocalPool::Scope strings(&m_stringStorage);
+        m_tmpTarget1.copyForPersistentInsert(source, NULL); // tuple in freelist must be already cleared
+    }
     m_tmpTarget1.setDeletedFalse();
     m_tmpTarget1.setEvictedFalse();
+    if (m_zoneMaps != NULL) {
+        m_zoneMaps->insert(m_tmpTarget1);
+    }
 
     /**
      * Inserts never "dirty" a tuple since the tuple is new, but...  The
@@ -561,11 +599,6 @@ bool PersistentTable::insertTuple(TableTuple &source) {
         elMark =
             appendToELBuffer(m_tmpTarget1, m_tsSeqNo++, TupleStreamWrapper::INSERT);
     }
-
-    if (m_schema->getUninlinedObjectColumnCount() != 0)
-    {
-        m_nonInlinedMemorySize += m_tmpTarget1.getNonInlinedMemorySize();
-    }
     /*
      * Create and register an undo action.
      */
@@ -624,6 +657,9 @@ void PersistentTable::insertTupleForUndo(TableTuple &source, size_t wrapperOffse
     // Then copy the source into the target
     m_tmpTarget1.copy(source);
     m_tmpTarget1.setDeletedFalse();
+    if (m_zoneMaps != NULL) {
+        m_zoneMaps->insert(m_tmpTarget1);
+    }
 
     /**
      * See the comments in insertTuple for why this has to be done. The same situation applies here
@@ -662,6 +698,17 @@ void PersistentTable::insertTupleForUndo(TableTuple &source, size_t wrapperOffse
  */
 bool PersistentTable::updateTuple(TableTuple &source, TableTuple &target, bool updatesIndexes) {
     size_t elMark = 0;
+    beforeStorageWrite();
+
+    /*
+     * The entries of indexes whose keys read the tuple are dropped before
+     * the tuple changes. They could not be restored if a unique
+     * constraint failed later on, so the constraints are checked first.
+     */
+    std::vector<TableIndex*> detached;
+    if (updatesIndexes) {
+        detachFromTupleKeyIndexes(target, source, detached);
+    }
 
     /*
      * Create and register an undo action and then use the copy of
@@ -679,12 +726,6 @@ bool PersistentTable::updateTuple(TableTuple &source, TableTuple &target, bool u
         m_COWContext->markTupleDirty(target, false);
     }
 
-    if (m_schema->getUninlinedObjectColumnCount() != 0)
-    {
-        m_nonInlinedMemorySize -= target.getNonInlinedMemorySize();
-        m_nonInlinedMemorySize += source.getNonInlinedMemorySize();
-    }
-
     source.setDeletedFalse();
     //Copy the dirty status that was set by markTupleDirty.
     if (target.isDirty()) {
@@ -694,7 +735,19 @@ bool PersistentTable::updateTuple(TableTuple &source, TableTuple &target, bool u
     }
 
     /** TODO : Not Using MMAP pool **/
-    target.copyForPersistentUpdate(source, NULL);
+    if (m_zoneMaps != NULL) {
+        m_zoneMaps->remove(target);
+    }
+    {
+        ThreadLocalPool::Scope strings(&m_stringStorage);
+        target.copyForPersistentUpdate(source, NULL);
+    }
+    if (m_paxMinipages != NULL) {
+        m_paxMinipages->invalidate(target.address());
+    }
+    if (m_zoneMaps != NULL) {
+        m_zoneMaps->insert(target);
+    }
 
     ptuua->setNewTuple(target, pool);
 
@@ -715,7 +768,7 @@ bool PersistentTable::updateTuple(TableTuple &source, TableTuple &target, bool u
         //If the CFE is thrown the Undo action should not attempt to revert the
         //indexes.
         ptuua->needToRevertIndexes();
-        updateFromAllIndexes(ptuua->getOldTuple(), target);
+        updateFromAllIndexes(ptuua->getOldTuple(), target, detached);
     }
 
     // if EL is enabled, append the tuple to the buffer
@@ -770,11 +823,7 @@ bool PersistentTable::updateTuple(TableTuple &source, TableTuple &target, bool u
  */
 void PersistentTable::updateTupleForUndo(TableTuple &source, TableTuple &target,
         bool revertIndexes, size_t wrapperOffset) {
-    if (m_schema->getUninlinedObjectColumnCount() != 0)
-    {
-        m_nonInlinedMemorySize -= target.getNonInlinedMemorySize();
-        m_nonInlinedMemorySize += source.getNonInlinedMemorySize();
-    }
+    beforeStorageWrite();
 
     //Need to back up the updated version of the tuple to provide to
     //the indexes when updating The indexes expect source's data Ptr
@@ -786,9 +835,28 @@ void PersistentTable::updateTupleForUndo(TableTuple &source, TableTuple &target,
     TableTuple targetBackup = tempTuple();
     targetBackup.copy(target);
 
+    std::vector<TableIndex*> detached;
+    if (revertIndexes) {
+        detachFromTupleKeyIndexes(target, source, detached);
+    }
+
+    // a block snapshot has to copy the block before it is reverted
+    if (m_COWContext.get() != NULL && m_COWContext->getMode() == COPY_ON_WRITE_BLOCKS) {
+        m_COWContext->markTupleDirty(target, false);
+    }
+
     bool dirty = target.isDirty();
     // this is the actual in-place revert to the old version
+    if (m_zoneMaps != NULL) {
+        m_zoneMaps->remove(target);
+    }
     target.copy(source);
+    if (m_paxMinipages != NULL) {
+        m_paxMinipages->invalidate(target.address());
+    }
+    if (m_zoneMaps != NULL) {
+        m_zoneMaps->insert(target);
+    }
     if (dirty) {
         target.setDirtyTrue();
     } else {
@@ -805,7 +873,7 @@ void PersistentTable::updateTupleForUndo(TableTuple &source, TableTuple &target,
                     targetBackup.debugNoHeader().c_str(),
                     target.debugNoHeader().c_str());
         }
-        updateFromAllIndexes(targetBackup, target);
+        updateFromAllIndexes(targetBackup, target, detached);
     }
 
     if (m_exportEnabled) {
@@ -821,7 +889,7 @@ bool PersistentTable::deleteTuple(TableTuple &target, bool deleteAllocatedString
     assert(&target != &m_tempTuple);
 
 #ifdef ANTICACHE
-#ifndef ANTICACHE_TIMESTAMPS
+#if !defined(ANTICACHE_TIMESTAMPS) && !defined(ANTICACHE_CLOCK)
     AntiCacheEvictionManager* eviction_manager = m_executorContext->getAntiCacheEvictionManager();
     eviction_manager->removeTuple(this, &target); 
 #endif
@@ -890,14 +958,13 @@ void PersistentTable::deleteTupleForUndo(voltdb::TableTuple &tupleCopy, size_t w
             m_wrapper->rollbackTo(wrapperOffset);
         }
 
+        if (m_COWContext.get() != NULL && m_COWContext->getMode() == COPY_ON_WRITE_BLOCKS) {
+            m_COWContext->markTupleDirty(target, false);
+        }
+
         // Just like insert, we want to remove this tuple from all of our indexes
         deleteFromAllIndexes(&target);
 
-        if (m_schema->getUninlinedObjectColumnCount() != 0)
-        {
-            m_nonInlinedMemorySize -= tupleCopy.getNonInlinedMemorySize();
-        }
-
         // Delete the strings/objects
         target.freeObjectColumns();
         deleteTupleStorage(target);
@@ -963,8 +1030,17 @@ void PersistentTable::deleteFromAllIndexes(TableTuple *tuple) {
     }
 }
 
-void PersistentTable::updateFromAllIndexes(TableTuple &targetTuple, const TableTuple &sourceTuple) {
+void PersistentTable::updateFromAllIndexes(TableTuple &targetTuple, const TableTuple &sourceTuple,
+                                           const std::vector<TableIndex*> &detached) {
     for (int i = m_indexCount - 1; i >= 0;--i) {
+        if (std::find(detached.begin(), detached.end(), m_indexes[i]) != detached.end()) {
+            // the old entry is gone already, see detachFromTupleKeyIndexes()
+            if (!m_indexes[i]->addEntry(&sourceTuple)) {
+                VOLT_ERROR("Failed to update indexes");
+                throwFatalException("Failed to update tuple in index");
+            }
+            continue;
+        }
         if (!m_indexes[i]->replaceEntry(&targetTuple, &sourceTuple)) {
             VOLT_ERROR("Failed to update indexes"); 
             throwFatalException("Failed to update tuple in index");
@@ -972,6 +1048,36 @@ void PersistentTable::updateFromAllIndexes(TableTuple &targetTuple, const TableT
     }
 }
 
+/*
+ * The entries of indexes whose keys read the tuple (see PrefixTupleKey)
+ * cannot be found anymore once the tuple changes in place. Drops the
+ * entry of target, which is still unchanged, from every such index whose
+ * key differs for source, and returns these indexes so that
+ * updateFromAllIndexes() adds the entry back after the change.
+ */
+void PersistentTable::detachFromTupleKeyIndexes(TableTuple &target, const TableTuple &source,
+                                                std::vector<TableIndex*> &detached) {
+    for (int i = m_indexCount - 1; i >= 0; --i) {
+        if (m_indexes[i]->keysReferenceTuples() &&
+            m_indexes[i]->checkForIndexChange(&target, &source)) {
+            detached.push_back(m_indexes[i]);
+        }
+    }
+    if (detached.empty()) {
+        return;
+    }
+    if (!tryUpdateOnAllIndexes(target, source)) {
+        throw ConstraintFailureException(this, target, source,
+                voltdb::CONSTRAINT_TYPE_UNIQUE);
+    }
+    for (std::vector<TableIndex*>::iterator i = detached.begin(); i != detached.end(); ++i) {
+        if (!(*i)->deleteEntry(&target)) {
+            VOLT_ERROR("Failed to update indexes");
+            throwFatalException("Failed to update tuple in index");
+        }
+    }
+}
+
 void PersistentTable::setEntryToNewAddressForAllIndexes(const TableTuple *tuple, const void* address, const void* oldAddress) {
     for (int i = m_indexCount - 1; i >= 0; --i) {
         VOLT_TRACE("Updating tuple address in index %s.%s [%s]",
@@ -986,6 +1092,139 @@ void PersistentTable::setEntryToNewAddressForAllIndexes(const TableTuple *tuple,
     }
 }
 
+bool PersistentTable::canCompact() const {
+    if (m_COWContext.get() != NULL || m_recoveryContext.get() != NULL) {
+        return false;
+    }
+    if (m_executorContext->isMMAPEnabled()) {
+        return false;
+    }
+    for (int i = 0; i < m_indexCount; ++i) {
+        if (m_indexes[i]->keysReferenceTuples()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#ifdef MEMCHECK_NOFREELIST
+int64_t PersistentTable::compact(int maxTuples) {
+    // every tuple has its own allocation, nothing to compact
+    return 0;
+}
+#else
+int64_t PersistentTable::compact(int maxTuples) {
+    // Only worth it once the free slots add up to a whole block,
+    // otherwise the last block would be emptied and refilled forever
+    const size_t freeSlots = m_data.size() * m_tuplesPerBlock - m_tupleCount;
+    if (freeSlots < m_tuplesPerBlock || !canCompact()) {
+        return 0;
+    }
+
+#ifdef ANTICACHE
+#if !defined(ANTICACHE_TIMESTAMPS) && !defined(ANTICACHE_CLOCK)
+    AntiCacheEvictionManager* eviction_manager = m_executorContext->getAntiCacheEvictionManager();
+#endif
+#endif
+
+    const uint32_t usedBefore = m_usedTuples;
+    int64_t reclaimed = 0;
+    int moved = 0;
+    TableTuple source(m_schema);
+    TableTuple target(m_schema);
+    while (true) {
+        // drop deleted tuples off the end of the used range
+        while (m_usedTuples > 0) {
+            source.move(dataPtrForTuple((int) m_usedTuples - 1));
+            if (source.isActive()) {
+                break;
+            }
+            --m_usedTuples;
+        }
+
+        // and free the blocks past it
+        while (!m_data.empty() && (m_data.size() - 1) * m_tuplesPerBlock >= m_usedTuples) {
+            m_blockDirectory.remove(m_data.back());
+            releaseBlockMemory(m_data.back(), m_tableAllocationTargetSize);
+            m_data.pop_back();
+#ifdef ANTICACHE_TIMESTAMPS_PRIME
+            m_evictPosition.pop_back();
+            m_stepPrime.pop_back();
+#endif
+            m_allocatedTuples -= m_tuplesPerBlock;
+            reclaimed += m_tableAllocationSize;
+        }
+        if (m_liveCounts.size() > m_data.size()) {
+            m_liveCounts.resize(m_data.size());
+            m_occupancy.resize(m_data.size() * static_cast<size_t>(m_occupancyWords));
+        }
+
+        if (moved >= maxTuples || m_usedTuples == m_tupleCount || m_holeFreeTuples.empty()) {
+            break;
+        }
+
+        // holes at or past the end of the used range are gone already
+        char *hole = m_holeFreeTuples.back();
+        m_holeFreeTuples.pop_back();
+        const int holeId = getTupleID(hole);
+        if (holeId < 0 || static_cast<uint32_t>(holeId) >= m_usedTuples) {
+            continue;
+        }
+
+        // move the last tuple into the hole, along with the ownership
+        // of its uninlined strings
+#ifdef ANTICACHE
+#if !defined(ANTICACHE_TIMESTAMPS) && !defined(ANTICACHE_CLOCK)
+        eviction_manager->removeTuple(this, &source);
+#endif
+#endif
+        target.move(hole);
+        ::memcpy(hole, source.address(), m_tupleLength);
+        setEntryToNewAddressForAllIndexes(&target, hole, source.address());
+        if (m_zoneMaps != NULL) {
+            m_zoneMaps->insert(target);
+            m_zoneMaps->remove(source);
+        }
+        source.setDeletedTrue();
+        markSlot(holeId, true);
+        markSlot(m_usedTuples - 1, false);
+        if (m_paxMinipages != NULL) {
+            m_paxMinipages->invalidate(hole);
+            m_paxMinipages->invalidate(source.address());
+        }
+        --m_usedTuples;
+#ifdef ANTICACHE
+#if !defined(ANTICACHE_TIMESTAMPS) && !defined(ANTICACHE_CLOCK)
+        eviction_manager->updateTuple(this, &target, true);
+#endif
+#endif
+        ++moved;
+    }
+
+    // forget the holes that are no longer below the end of the used range
+    if (m_usedTuples < usedBefore) {
+        std::vector<char*>::iterator kept = m_holeFreeTuples.begin();
+        for (std::vector<char*>::iterator i = m_holeFreeTuples.begin(); i != m_holeFreeTuples.end(); ++i) {
+            const int holeId = getTupleID(*i);
+            if (holeId >= 0 && static_cast<uint32_t>(holeId) < m_usedTuples) {
+                *kept++ = *i;
+            }
+        }
+        m_holeFreeTuples.erase(kept, m_holeFreeTuples.end());
+    }
+
+    // drop the copies of the freed blocks
+    if (m_paxMinipages != NULL && reclaimed > 0) {
+        m_paxMinipages->invalidateAll();
+    }
+
+    VOLT_DEBUG("Compacted table %s: moved %d tuples, freed %ld bytes",
+               m_name.c_str(), moved, (long int)reclaimed);
+    m_reclaimedTupleMemory += reclaimed;
+    return reclaimed;
+}
+#endif
+
 bool PersistentTable::tryInsertOnAllIndexes(TableTuple *tuple) {
     for (int i = m_indexCount - 1; i >= 0; --i) {
         FAIL_IF(!m_indexes[i]->addEntry(tuple)) {
@@ -1034,10 +1273,6 @@ void PersistentTable::addMaterializedView(MaterializedViewMetadata *view) {
     m_views.push_back(view);
 }
 
-void PersistentTable::updateStringMemory(int tupleStringMemorySize) {
-    m_nonInlinedMemorySize += tupleStringMemorySize;
-}
-
 
 // ------------------------------------------------------------------
 // UTILITY
@@ -1097,12 +1332,64 @@ std::vector<TableIndex*> PersistentTable::allIndexes() const {
     return retval;
 }
 
+void PersistentTable::setPaxLayout(bool enable) {
+    if (enable && m_paxMinipages == NULL) {
+        VOLT_INFO("Enabling the PAX layout for table %s", m_name.c_str());
+        m_paxMinipages = new PaxMinipages(this);
+    } else if (!enable) {
+        delete m_paxMinipages;
+        m_paxMinipages = NULL;
+    }
+}
+
+void PersistentTable::setZoneMapColumns(const std::vector<std::string> &columnNames) {
+    delete m_zoneMaps;
+    m_zoneMaps = NULL;
+    m_zoneMapColumnNames = columnNames;
+
+    std::vector<int> columns;
+    for (size_t i = 0; i < columnNames.size(); i++) {
+        const int column = columnIndex(columnNames[i]);
+        if (column < 0) {
+            VOLT_WARN("Table %s has no column %s for a zone map", m_name.c_str(), columnNames[i].c_str());
+            continue;
+        }
+        switch (m_schema->columnType(column)) {
+            case VALUE_TYPE_TINYINT:
+            case VALUE_TYPE_SMALLINT:
+            case VALUE_TYPE_INTEGER:
+            case VALUE_TYPE_BIGINT:
+            case VALUE_TYPE_TIMESTAMP:
+                columns.push_back(column);
+                break;
+            default:
+                VOLT_WARN("Column %s.%s is not an integer, it gets no zone map",
+                          m_name.c_str(), columnNames[i].c_str());
+                break;
+        }
+    }
+    if (!columns.empty()) {
+        VOLT_INFO("Enabling zone maps for %d columns of table %s", (int)columns.size(), m_name.c_str());
+        m_zoneMaps = new ZoneMaps(this, columns);
+    }
+}
+
 void PersistentTable::onSetColumns() {
     if (m_allowNulls != NULL) delete[] m_allowNulls;
     m_allowNulls = new bool[m_columnCount];
     for (int i = m_columnCount - 1; i >= 0; --i) {
         m_allowNulls[i] = m_schema->columnAllowNull(i);
     }
+
+    // the minipages follow the columns
+    if (m_paxMinipages != NULL) {
+        setPaxLayout(false);
+        setPaxLayout(true);
+    }
+    if (m_zoneMaps != NULL) {
+        std::vector<std::string> columnNames(m_zoneMapColumnNames);
+        setZoneMapColumns(columnNames);
+    }
 }
 
 /*
@@ -1128,12 +1415,6 @@ void PersistentTable::processLoadedTuple(bool allowExport, TableTuple &tuple) {
         appendToELBuffer(m_tmpTarget1, m_tsSeqNo++,
                 TupleStreamWrapper::INSERT);
     }
-
-    // Account for non-inlined memory allocated via bulk load or recovery
-    if (m_schema->getUninlinedObjectColumnCount() != 0)
-    {
-        m_nonInlinedMemorySize += tuple.getNonInlinedMemorySize();
-    }
 }
 
 /*
@@ -1142,13 +1423,18 @@ void PersistentTable::processLoadedTuple(bool allowExport, TableTuple &tuple) {
  */
 void PersistentTable::populateIndexes(int tupleCount) 
 {
-    // populate indexes. walk the contiguous memory in the inner loop.
+    if (m_indexCount == 0 || tupleCount == 0) {
+        return;
+    }
+
+    // hand the whole batch to every index, so that each of them can sort
+    // it or build its static stage once instead of per tuple
+    std::vector<TableTuple> tuples(tupleCount, TableTuple(m_schema));
+    for (int j = 0; j < tupleCount; ++j) {
+        tuples[j].move(dataPtrForTuple((int) m_usedTuples + j));
+    }
     for (int i = m_indexCount - 1; i >= 0;--i) {
-        TableIndex *index = m_indexes[i];
-        for (int j = 0; j < tupleCount; ++j) {
-            m_tmpTarget1.move(dataPtrForTuple((int) m_usedTuples + j));
-            index->addEntry(&m_tmpTarget1);
-        }
+        m_indexes[i]->addEntries(tuples);
     }
 }
 
@@ -1219,7 +1505,7 @@ bool PersistentTable::activateCopyOnWrite(TupleSerializer *serializer, int32_t p
     if (m_tupleCount == 0) {
         return false;
     }
-    m_COWContext.reset(new CopyOnWriteContext( this, serializer, partitionId));
+    m_COWContext.reset(new CopyOnWriteContext( this, serializer, partitionId, m_COWMode));
     return false;
 }
 
@@ -1235,6 +1521,9 @@ bool PersistentTable::serializeMore(ReferenceSerializeOutput *out) {
 
     const bool hasMore = m_COWContext->serializeMore(out);
     if (!hasMore) {
+        VOLT_DEBUG("Snapshot of table %s copied %ld %s written to while it ran", m_name.c_str(),
+                   (long)m_COWContext->getCopyCount(),
+                   m_COWContext->getMode() == COPY_ON_WRITE_BLOCKS ? "blocks" : "tuples");
         m_COWContext.reset(NULL);
     }
 
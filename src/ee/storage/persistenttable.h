@@ -63,6 +63,7 @@
 #include "common/valuevector.h"
 #include "common/tabletuple.h"
 #include "common/Pool.hpp"
+#include "common/CompactingStringStorage.h"
 #include "storage/table.h"
 #include "storage/TupleStreamWrapper.h"
 #include "storage/TableStats.h"
@@ -125,6 +126,7 @@ class PersistentTable : public Table {
     
 #ifdef ANTICACHE
     friend class AntiCacheEvictionManager;
+    friend class EvictionIterator;
     friend class IndexScanExecutor;
 #endif
 
@@ -215,6 +217,16 @@ class PersistentTable : public Table {
      */
     bool activateCopyOnWrite(TupleSerializer *serializer, int32_t partitionId);
 
+    /**
+     * Whether the snapshots of this table back up the tuples written to
+     * while they run one by one (the default), or copy each block on its
+     * first write. Block copies make writes during a snapshot cheaper when
+     * they cluster in a few blocks. Takes effect with the next snapshot.
+     */
+    void setCopyOnWriteMode(CopyOnWriteMode mode) {
+        m_COWMode = mode;
+    }
+
     /**
      * Create a recovery stream for this table. Returns true if the table already has an active recovery stream
      */
@@ -271,6 +283,13 @@ class PersistentTable : public Table {
     #ifdef ANTICACHE
     void setEvictedTable(voltdb::Table *evictedTable);
     voltdb::Table* getEvictedTable();
+    /**
+     * Whether tuples of this table may be moved to the anti-cache. Not
+     * when an index keeps tuple pointers inside its keys (see
+     * TableIndex::keysReferenceTuples()), such a key would read the
+     * storage the eviction frees.
+     */
+    bool canEvict() const;
     // needed for LRU chain eviction
     void setNewestTupleID(uint32_t id); 
     void setOldestTupleID(uint32_t id); 
@@ -319,11 +338,64 @@ class PersistentTable : public Table {
 
     #endif
 
-    void updateStringMemory(int tupleStringMemorySize);
-    
     void setEntryToNewAddressForAllIndexes(const TableTuple *tuple, const void* address, const void* oldAddress);
 
+    // ------------------------------------------------------------------
+    // COMPACTION
+    // ------------------------------------------------------------------
+    /**
+     * Move up to maxTuples live tuples from the end of the table into
+     * the slots of deleted tuples, point the indexes at their new
+     * addresses and free the blocks at the end that this empties.
+     * Does nothing unless the free slots add up to at least a block.
+     * Must not run while a transaction may still hold tuple addresses,
+     * VoltDBEngine::tick() calls it once the undo log is empty.
+     *
+     * @return the number of bytes of tuple blocks freed.
+     */
+    int64_t compact(int maxTuples);
+
+    virtual int64_t reclaimedTupleMemory() const {
+        return m_reclaimedTupleMemory;
+    }
+
+    virtual int64_t nonInlinedMemorySize() const {
+        return (int64_t)m_stringStorage.getBytesAllocated();
+    }
+
+    virtual CompactingStringStorage* stringStorage() {
+        return &m_stringStorage;
+    }
+
+    // ------------------------------------------------------------------
+    // PAX LAYOUT
+    // ------------------------------------------------------------------
+    /**
+     * Keep column minipages of the tuple blocks for scans that filter or
+     * aggregate on a few numeric columns, see PaxMinipages. For read-mostly
+     * tables only, every write makes the scans copy its block again.
+     */
+    void setPaxLayout(bool enable);
+
+    // ------------------------------------------------------------------
+    // ZONE MAPS
+    // ------------------------------------------------------------------
+    /**
+     * Keep per-block min/max summaries of the named columns so that scans
+     * can skip blocks, see ZoneMaps. Columns that are not integers or
+     * timestamps are left out, an empty list drops the zone maps.
+     */
+    void setZoneMapColumns(const std::vector<std::string> &columnNames);
+
 protected:
+    /**
+     * Whether the tuples of this table may be moved by compact(). Not
+     * when something outside the table holds on to tuple addresses:
+     * snapshots and recovery streams in progress, indexes keeping
+     * tuple pointers inside their keys, or memory mapped blocks.
+     */
+    virtual bool canCompact() const;
+
     virtual void allocateNextBlock();
     
     size_t allocatedBlockCount() const {
@@ -335,7 +407,10 @@ protected:
     // ------------------------------------------------------------------
     void insertIntoAllIndexes(TableTuple *tuple);
     void deleteFromAllIndexes(TableTuple *tuple);
-    void updateFromAllIndexes(TableTuple &targetTuple, const TableTuple &sourceTuple);
+    void updateFromAllIndexes(TableTuple &targetTuple, const TableTuple &sourceTuple,
+                              const std::vector<TableIndex*> &detached = std::vector<TableIndex*>());
+    void detachFromTupleKeyIndexes(TableTuple &target, const TableTuple &source,
+                                   std::vector<TableIndex*> &detached);
 
     bool tryInsertOnAllIndexes(TableTuple *tuple);
     bool tryUpdateOnAllIndexes(TableTuple &targetTuple, const TableTuple &sourceTuple);
@@ -399,6 +474,11 @@ protected:
     
     int m_numTuplesInEvictionChain;
     
+    #ifdef ANTICACHE_CLOCK
+    // slot where the CLOCK sweep of the next eviction starts
+    uint32_t m_clockHand;
+    #endif
+
     bool m_blockMerge;
     bool m_batchEvicted;
 
@@ -422,9 +502,19 @@ protected:
     
     // Snapshot stuff
     boost::scoped_ptr<CopyOnWriteContext> m_COWContext;
+    CopyOnWriteMode m_COWMode;
 
     //Recovery stuff
     boost::scoped_ptr<RecoveryContext> m_recoveryContext;
+
+    // bytes of tuple blocks given back by compaction since startup
+    int64_t m_reclaimedTupleMemory;
+
+    // the uninlined strings of the tuples
+    CompactingStringStorage m_stringStorage;
+
+    // the columns with zone maps, by name so they survive a new schema
+    std::vector<std::string> m_zoneMapColumnNames;
 };
 
 inline TableTuple& PersistentTable::getTempTupleInlined(TableTuple &source) {
@@ -439,8 +529,9 @@ inline void PersistentTable::allocateNextBlock() {
 #else
     int bytes = m_tableAllocationTargetSize;
 #endif
-    char *memory = (char*)(new char[bytes]);
+    char *memory = allocateBlockMemory(bytes);
     m_data.push_back(memory);
+    m_blockDirectory.add(memory, (int)m_data.size() - 1);
 #ifdef ANTICACHE_TIMESTAMPS_PRIME
     m_evictPosition.push_back(0);
     m_stepPrime.push_back(-1);
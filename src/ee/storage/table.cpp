@@ -52,6 +52,7 @@
 #include "common/TupleSchema.h"
 #include "common/tabletuple.h"
 #include "common/Pool.hpp"
+#include "common/ThreadLocalPool.h"
 #include "common/FatalException.hpp"
 #include "indexes/tableindex.h"
 #include "storage/tableiterator.h"
@@ -71,7 +72,11 @@ Table::Table(int tableAllocationTargetSize) :
     m_columnCount(0),
     m_tuplesPerBlock(0),
     m_tupleLength(0),
-    m_nonInlinedMemorySize(0),
+    m_paxMinipages(NULL),
+    m_zoneMaps(NULL),
+    m_trackOccupancy(false),
+    m_occupancyWords(0),
+    m_storageCheckpointed(false),
     m_columnHeaderData(NULL),
     m_columnHeaderSize(-1),
     m_columnNames(NULL),
@@ -82,6 +87,7 @@ Table::Table(int tableAllocationTargetSize) :
     m_tempTableMemoryInBytes(NULL),
     m_pool(NULL),
     m_data_manager(NULL),
+    m_blockAllocator(NULL),
     m_refcount(0),
     m_enableMMAP(false)
 {
@@ -110,7 +116,11 @@ Table::Table(int tableAllocationTargetSize, bool enableMMAP) :
     m_columnCount(0),
     m_tuplesPerBlock(0),
     m_tupleLength(0),
-    m_nonInlinedMemorySize(0),
+    m_paxMinipages(NULL),
+    m_zoneMaps(NULL),
+    m_trackOccupancy(false),
+    m_occupancyWords(0),
+    m_storageCheckpointed(false),
     m_columnHeaderData(NULL),
     m_columnHeaderSize(-1),
     m_columnNames(NULL),
@@ -121,6 +131,7 @@ Table::Table(int tableAllocationTargetSize, bool enableMMAP) :
     m_tempTableMemoryInBytes(NULL),
     m_pool(NULL),
     m_data_manager(NULL),
+    m_blockAllocator(NULL),
     m_refcount(0),
     m_enableMMAP(enableMMAP)
 {
@@ -155,6 +166,11 @@ Table::~Table() {
     delete[] reinterpret_cast<char*>(m_tempTuple.m_data);
     m_tempTuple.m_data = NULL;
 
+    delete m_paxMinipages;
+    m_paxMinipages = NULL;
+    delete m_zoneMaps;
+    m_zoneMaps = NULL;
+
     /*
      * The memcheck build uses the heap to allocate each tuple in order to
      * detect errors while accessing tuples as well as tuples storage pointers
@@ -179,7 +195,7 @@ Table::~Table() {
     if(m_enableMMAP == false){
     // clear the tuple memory
     for (std::vector<char*>::iterator iter = m_data.begin(); iter != m_data.end(); ++iter)
-        delete[] reinterpret_cast<char*>(*iter);
+        releaseBlockMemory(*iter, m_tableAllocationTargetSize);
     }
 #endif
 
@@ -241,6 +257,10 @@ void Table::initializeWithColumns(TupleSchema *schema, const std::string* column
     } else {
         m_tableAllocationSize = m_tableAllocationTargetSize;
     }
+    m_blockDirectory.setBlockLength(m_tuplesPerBlock * m_tupleLength);
+    m_occupancyWords = (m_tuplesPerBlock + 63) / 64;
+    m_occupancy.clear();
+    m_liveCounts.clear();
 
     // note that any allocated memory in m_data is left alone
     // as is m_allocatedTuples
@@ -259,6 +279,8 @@ TableIterator Table::tableIterator() {
 }
 
 void Table::nextFreeTuple(TableTuple *tuple) {
+    beforeStorageWrite();
+
     // First check whether we have any in our list
     // In the memcheck it uses the heap instead of a free list to help Valgrind.
 #ifndef MEMCHECK_NOFREELIST
@@ -268,6 +290,12 @@ void Table::nextFreeTuple(TableTuple *tuple) {
         m_holeFreeTuples.pop_back();
         assert (m_columnCount == tuple->sizeInValues());
         tuple->move(ret);
+        if (m_paxMinipages != NULL) {
+            m_paxMinipages->invalidate(ret);
+        }
+        if (m_trackOccupancy) {
+            markSlot(getTupleID(ret), true);
+        }
         return;
     }
 #endif
@@ -282,6 +310,12 @@ void Table::nextFreeTuple(TableTuple *tuple) {
     assert (m_usedTuples < m_allocatedTuples);
     assert (m_columnCount == tuple->sizeInValues());
     tuple->move(dataPtrForTuple((int) m_usedTuples));
+    if (m_paxMinipages != NULL) {
+        m_paxMinipages->invalidate(tuple->address());
+    }
+    if (m_trackOccupancy) {
+        markSlot(m_usedTuples, true);
+    }
     ++m_usedTuples;
     //cout << "table::nextFreeTuple(" << reinterpret_cast<const void *>(this) << ") m_usedTuples == " << m_usedTuples << endl;
 }
@@ -533,18 +567,26 @@ void Table::loadTuplesFromNoHeader(bool allowExport,
                             Pool *stringPool) {
     int tupleCount = serialize_io.readInt();
     assert(tupleCount >= 0);
+    beforeStorageWrite();
 
     // allocate required data blocks first to make them alligned well
     while (tupleCount + m_usedTuples > m_allocatedTuples) {
         allocateNextBlock();
     }
 
+    ThreadLocalPool::Scope strings(stringStorage());
     for (int i = 0; i < tupleCount; ++i) {
         m_tmpTarget1.move(dataPtrForTuple((int) m_usedTuples + i));
+        if (m_trackOccupancy) {
+            markSlot(m_usedTuples + static_cast<uint32_t>(i), true);
+        }
         m_tmpTarget1.setDeletedFalse();
         m_tmpTarget1.setDirtyFalse();
         m_tmpTarget1.setEvictedFalse();
         m_tmpTarget1.deserializeFrom(serialize_io, stringPool);
+        if (m_zoneMaps != NULL) {
+            m_zoneMaps->insert(m_tmpTarget1);
+        }
 
         processLoadedTuple( allowExport, m_tmpTarget1);
         VOLT_TRACE("Loaded new tuple #%02d\n%s", i, m_tmpTarget1.debug(name()).c_str());
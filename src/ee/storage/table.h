@@ -57,6 +57,10 @@
 #include "common/Pool.hpp"
 #include "common/tabletuple.h"
 #include "common/MMAPMemoryManager.h"
+#include "common/BlockAllocator.h"
+#include "storage/BlockDirectory.h"
+#include "storage/PaxMinipages.h"
+#include "storage/ZoneMaps.h"
 #include "anticache/AntiCacheDB.h"
 
 namespace voltdb {
@@ -76,6 +80,7 @@ class TableStats;
 class StatsSource;
 class StreamBlock;
 class Topend;
+class CompactingStringStorage;
 
 const size_t COLUMN_DESCRIPTOR_SIZE = 1 + 4 + 4; // type, name offset, name length
 
@@ -109,11 +114,16 @@ class Table {
     friend class TableFactory;
     friend class TableIterator;
     friend class CopyOnWriteIterator;
+    friend class BlockCopyOnWriteIterator;
     friend class CopyOnWriteContext;
     friend class ExecutionEngine;
     friend class TableStats;
     friend class StatsSource;
     friend class EvictionIterator; 
+    friend class PaxMinipages;
+    friend class PaxScanIterator;
+    friend class ZoneMaps;
+    friend class ZoneMapScanIterator;
 
   private:
     // no default constructor, no copy
@@ -187,16 +197,33 @@ public:
     }
     
     virtual int64_t allocatedTupleMemory() const {
-        return allocatedBlockCount() * m_tableAllocationSize;
+        int64_t bytes = allocatedBlockCount() * m_tableAllocationSize;
+        if (m_paxMinipages != NULL) {
+            bytes += m_paxMinipages->getBytesAllocated();
+        }
+        if (m_zoneMaps != NULL) {
+            bytes += m_zoneMaps->getBytesAllocated();
+        }
+        return bytes;
     }
     
     int64_t occupiedTupleMemory() const {
         return m_tupleCount * m_tempTuple.tupleLength();
     }
     
-    // Only counts persistent table usage, currently
-    int64_t nonInlinedMemorySize() const {
-        return m_nonInlinedMemorySize;
+    // Bytes held for uninlined strings, persistent tables only
+    virtual int64_t nonInlinedMemorySize() const {
+        return 0;
+    }
+
+    // Where the uninlined strings of this table's tuples live, NULL for the heap
+    virtual CompactingStringStorage* stringStorage() {
+        return NULL;
+    }
+
+    // Bytes of tuple blocks freed by compaction, persistent tables only
+    virtual int64_t reclaimedTupleMemory() const {
+        return 0;
     }
     
     /**
@@ -209,6 +236,10 @@ public:
     inline void updateTupleAccessCount() {
         m_tupleAccesses++;
     }
+
+    inline void updateTupleAccessCount(uint32_t count) {
+        m_tupleAccesses += count;
+    }
     
     #ifdef ANTICACHE
     inline int32_t getTuplesEvicted() const { return (m_tuplesEvicted); }
@@ -226,7 +257,33 @@ public:
     virtual std::vector<AntiCacheDB*> allACDBs() const;
     #endif
     
-    int getTupleID(const char* tuple_address); 
+    int getTupleID(const char* tuple_address);
+
+    /**
+     * The column minipages of the blocks, NULL unless the table has the
+     * PAX layout.
+     */
+    inline PaxMinipages* paxMinipages() const {
+        return m_paxMinipages;
+    }
+
+    /**
+     * The per-block summaries of some integer columns, NULL unless the
+     * table keeps zone maps.
+     */
+    inline const ZoneMaps* zoneMaps() const {
+        return m_zoneMaps;
+    }
+
+    /**
+     * Takes the tuple blocks of this table from another allocator. A table
+     * that already holds blocks keeps releasing them to its allocator.
+     */
+    inline void setBlockAllocator(BlockAllocator *allocator) {
+        if (m_data.empty()) {
+            m_blockAllocator = allocator;
+        }
+    }
 
     // ------------------------------------------------------------------
     // COLUMNS
@@ -374,6 +431,30 @@ protected:
      */
     void deleteTupleStorage(TableTuple &tuple);
 
+    /**
+     * Sets or clears the occupancy bit of a slot. Only for tables that
+     * keep occupancy bitmaps.
+     */
+    void markSlot(uint32_t tupleId, bool occupied);
+
+    /**
+     * The first slot of the block, at or after the given one, whose
+     * occupancy bit is set. m_tuplesPerBlock if there is none. Only for
+     * tables that keep occupancy bitmaps.
+     */
+    uint32_t nextOccupiedSlot(uint32_t blockIndex, uint32_t slot) const;
+
+    /**
+     * Called before tuples are inserted, updated or deleted. Tables whose
+     * blocks are checkpointed for restart drop the checkpoint here.
+     */
+    inline void beforeStorageWrite() {
+        if (m_storageCheckpointed) {
+            storageWriteStarted();
+        }
+    }
+    virtual void storageWriteStarted() {}
+
     void initializeWithColumns(TupleSchema *schema, const std::string* columnNames, bool ownsTupleSchema);
     virtual void onSetColumns() {};
 
@@ -389,10 +470,27 @@ protected:
     uint32_t m_columnCount;
     uint32_t m_tuplesPerBlock;
     uint32_t m_tupleLength;
-    int64_t m_nonInlinedMemorySize;
     
     // pointers to chunks of data
     std::vector<char*> m_data;
+    // the same chunks sorted by address, to map tuple addresses to ids
+    BlockDirectory m_blockDirectory;
+    // a column by column copy of the same chunks, for tables with the PAX layout
+    PaxMinipages *m_paxMinipages;
+    // min/max summaries of the same chunks, for tables with zone maps
+    ZoneMaps *m_zoneMaps;
+
+    // For every chunk, a bit per slot that is set from the time the slot is
+    // handed out until its tuple is deleted, and the number of bits set.
+    // Iterators skip the slots and chunks without live tuples through them.
+    // Kept by persistent tables only, temp tables have no holes.
+    bool m_trackOccupancy;
+    uint32_t m_occupancyWords;
+    std::vector<uint64_t> m_occupancy;
+    std::vector<uint32_t> m_liveCounts;
+
+    // set while a checkpoint of the blocks is written or pending
+    bool m_storageCheckpointed;
 
     char *m_columnHeaderData;
     int32_t m_columnHeaderSize;
@@ -461,6 +559,27 @@ protected:
 
     /** MMAP Data Storage **/
     MMAPMemoryManager* m_data_manager;
+
+    /** Tuple block memory, the partition's allocator once the table belongs to one, NULL before **/
+    BlockAllocator* m_blockAllocator;
+
+    /**
+     * Tables outside of a partition, such as the temp tables of stats and
+     * tests, have no allocator and keep their blocks on new[] and delete[].
+     */
+    inline char* allocateBlockMemory(int bytes) {
+        if (m_blockAllocator != NULL) {
+            return m_blockAllocator->allocate(bytes);
+        }
+        return new char[bytes];
+    }
+    inline void releaseBlockMemory(char *block, int bytes) {
+        if (m_blockAllocator != NULL) {
+            m_blockAllocator->release(block, bytes);
+        } else {
+            delete[] block;
+        }
+    }
     
   private:
     int32_t m_refcount;
@@ -509,8 +628,9 @@ inline void Table::allocateNextBlock() {
 #else
     int bytes = m_tableAllocationTargetSize;
 #endif
-    char *memory = (char*)(new char[bytes]);
+    char *memory = allocateBlockMemory(bytes);
     m_data.push_back(memory);
+    m_blockDirectory.add(memory, (int)m_data.size() - 1);
 #ifdef ANTICACHE_TIMESTAMPS_PRIME
     m_evictPosition.push_back(0);
     m_stepPrime.push_back(-1);
@@ -531,47 +651,72 @@ inline void Table::allocateNextBlock() {
 }
     
 inline int Table::getTupleID(const char* tuple_address)
-{    
-    char* addr; 
-    int tuple_id = 0; 
-    
-    int tuple_size = m_schema->tupleLength() + TUPLE_HEADER_SIZE; 
-    long offset;
-    
-    for(int i = 0; i < m_data.size(); i++)  // iterate through blocks
-    {
-        addr = m_data[i]; 
-        
-        // tuple cannot be in this block, so increment id and skip to the next block
-        if((tuple_address < addr) || (tuple_address > (addr + (tuple_size*m_tuplesPerBlock)))
-           )
-        {
-            tuple_id += m_tuplesPerBlock; 
-            continue; 
+{
+    const char *block;
+    const int blockIndex = m_blockDirectory.find(tuple_address, &block);
+    if (blockIndex < 0) {
+        return -1; // no matching tuple was found
+    }
+
+    const long offset = (long)(tuple_address - block);
+    if (offset % m_tupleLength != 0) {
+        return -1;
+    }
+    return blockIndex * (int)m_tuplesPerBlock + (int)(offset / m_tupleLength);
+}
+
+inline void Table::markSlot(uint32_t tupleId, bool occupied) {
+    const uint32_t blockIndex = tupleId / m_tuplesPerBlock;
+    const uint32_t slot = tupleId % m_tuplesPerBlock;
+    if (blockIndex >= m_liveCounts.size()) {
+        if (!occupied) {
+            return;
         }
+        m_liveCounts.resize(blockIndex + 1, 0);
+        m_occupancy.resize((blockIndex + 1) * static_cast<size_t>(m_occupancyWords), 0);
+    }
+    uint64_t &word = m_occupancy[blockIndex * static_cast<size_t>(m_occupancyWords) + (slot >> 6)];
+    const uint64_t bit = static_cast<uint64_t>(1) << (slot & 63);
+    if (occupied && (word & bit) == 0) {
+        word |= bit;
+        ++m_liveCounts[blockIndex];
+    } else if (!occupied && (word & bit) != 0) {
+        word &= ~bit;
+        --m_liveCounts[blockIndex];
+    }
+}
 
-        offset = ((long)tuple_address - (long)addr) / tuple_size;
-        if (addr + offset * tuple_size == tuple_address)
-            return tuple_id + (int)offset;
-        
-        /*for(int j = 0; j < m_tuplesPerBlock; j++)  // iterate through tuples in a block
-        {
-            if(addr == tuple_address)
-            {
-                return tuple_id; 
-            }
-            
-            addr += tuple_size; // advance pointer to next tuple
-            tuple_id++; 
-        }*/
-        
+inline uint32_t Table::nextOccupiedSlot(uint32_t blockIndex, uint32_t slot) const {
+    if (blockIndex >= m_liveCounts.size() || m_liveCounts[blockIndex] == 0 || slot >= m_tuplesPerBlock) {
+        return m_tuplesPerBlock;
     }
-    
-    return -1; // no matching tuple was found
+    const uint64_t *words = &m_occupancy[blockIndex * static_cast<size_t>(m_occupancyWords)];
+    uint32_t w = slot >> 6;
+    uint64_t bits = words[w] & (~static_cast<uint64_t>(0) << (slot & 63));
+    while (bits == 0) {
+        if (++w == m_occupancyWords) {
+            return m_tuplesPerBlock;
+        }
+        bits = words[w];
+    }
+    return (w << 6) + static_cast<uint32_t>(__builtin_ctzll(bits));
 }
 
 #ifdef MEMCHECK_NOFREELIST
 inline void Table::deleteTupleStorage(TableTuple &tuple) {
+    beforeStorageWrite();
+    if (m_paxMinipages != NULL) {
+        m_paxMinipages->invalidate(tuple.address());
+    }
+    if (m_zoneMaps != NULL) {
+        m_zoneMaps->remove(tuple);
+    }
+    if (m_trackOccupancy) {
+        const int tupleId = getTupleID(tuple.address());
+        if (tupleId >= 0) {
+            markSlot(tupleId, false);
+        }
+    }
     m_tupleCount--;
     m_deletedTupleCount++;
     assert(m_deletedTuplePointers.find(tuple.address()) == m_deletedTuplePointers.end());
@@ -580,6 +725,7 @@ inline void Table::deleteTupleStorage(TableTuple &tuple) {
      * Delete the tuple so valgrind can catch future invalid access
      * and NULL out the reference in m_data so TableIterator can skip it.
      */
+    m_blockDirectory.remove(tuple.address());
     delete []tuple.address();
     for (std::vector<char*>::iterator iter = m_data.begin(); iter != m_data.end(); ++iter) {
         if (*iter == tuple.address()) {
@@ -592,6 +738,19 @@ inline void Table::deleteTupleStorage(TableTuple &tuple) {
 }
 #else
 inline void Table::deleteTupleStorage(TableTuple &tuple) {
+    beforeStorageWrite();
+    if (m_paxMinipages != NULL) {
+        m_paxMinipages->invalidate(tuple.address());
+    }
+    if (m_zoneMaps != NULL) {
+        m_zoneMaps->remove(tuple);
+    }
+    if (m_trackOccupancy) {
+        const int tupleId = getTupleID(tuple.address());
+        if (tupleId >= 0) {
+            markSlot(tupleId, false);
+        }
+    }
     tuple.setDeletedTrue(); // does NOT free strings
     tuple.setEvictedFalse();
 
@@ -82,6 +82,7 @@ public:
 private:
 
     bool continuationPredicate();
+    bool nextOccupied(TableTuple &out);
 
     /*
      * Configuration parameter that controls whether the table iterator
@@ -163,6 +164,11 @@ inline bool TableIterator::next(TableTuple &out) {
                    m_nestedIterator->m_table->name().c_str(), m_table->name().c_str());
     }
     
+    // tables with occupancy bitmaps only look at the slots that may be live
+    if (m_table->m_trackOccupancy) {
+        return nextOccupied(out);
+    }
+
     while (continuationPredicate()) {
         if (m_location % m_tuplesPerBlock == 0) {
 #ifdef MEMCHECK_NOFREELIST
@@ -198,6 +204,31 @@ inline bool TableIterator::next(TableTuple &out) {
     return false;
 }
 
+inline bool TableIterator::nextOccupied(TableTuple &out) {
+    const uint32_t usedTuples = m_table->m_usedTuples;
+    while (continuationPredicate() && m_location < usedTuples) {
+        const uint32_t blockIndex = m_location / m_tuplesPerBlock;
+        const uint32_t slot = m_table->nextOccupiedSlot(blockIndex, m_location % m_tuplesPerBlock);
+        if (slot == m_tuplesPerBlock) {
+            // nothing left in this block, or an empty block
+            m_location = (blockIndex + 1) * m_tuplesPerBlock;
+            continue;
+        }
+        m_location = blockIndex * m_tuplesPerBlock + slot;
+        m_dataPtr = m_table->m_data[blockIndex] + static_cast<size_t>(slot) * m_tupleLength;
+        assert (out.sizeInValues() == m_table->columnCount());
+        out.move(m_dataPtr);
+        ++m_location;
+
+        // the bit is set before the tuple is, check the tuple itself
+        if (out.isActive()) {
+            ++m_foundTuples;
+            return true;
+        }
+    }
+    return false;
+}
+
 inline int TableIterator::getLocation() const {
     return (m_useNested ? m_nestedIterator->getLocation() : m_location);
 }
@@ -188,6 +188,7 @@ inline void TempTable::deleteAllTuplesNonVirtual(bool freeAllocatedStrings) {
         //to correctly update the metadata kept in the memcheck build
         char* chunk = m_data.back();
         m_data.pop_back();
+        m_blockDirectory.remove(chunk);
         m_allocatedTuples -= m_tuplesPerBlock;
         // if keeping track of fragment temp memory, decrease it here
         if (m_tempTableMemoryInBytes)
@@ -201,21 +202,23 @@ inline void TempTable::deleteAllTuplesNonVirtual(bool freeAllocatedStrings) {
 #elif defined(MEMCHECK)
         char* chunk = m_data.back();
         m_data.pop_back();
+        m_blockDirectory.remove(chunk);
         m_allocatedTuples -= m_tuplesPerBlock;
         if (m_tempTableMemoryInBytes) {
             (*m_tempTableMemoryInBytes) -= (m_schema->tupleLength() + TUPLE_HEADER_SIZE);
         }
         assert(chunk != NULL);
-        delete[] chunk;
+        releaseBlockMemory(chunk, m_schema->tupleLength() + TUPLE_HEADER_SIZE);
 #else
         char* chunk = m_data.back();
         m_data.pop_back();
+        m_blockDirectory.remove(chunk);
         m_allocatedTuples -= m_tuplesPerBlock;
         // if keeping track of fragment temp memory, decrease it here
         if (m_tempTableMemoryInBytes)
             (*m_tempTableMemoryInBytes) -= m_tableAllocationTargetSize;
         assert(chunk != NULL);
-        delete[] chunk;
+        releaseBlockMemory(chunk, m_tableAllocationTargetSize);
 #endif
     }
 
@@ -1503,6 +1503,87 @@ SHAREDLIB_JNIEXPORT jint JNICALL Java_org_voltdb_jni_ExecutionEngine_nativeAntiC
     return org_voltdb_jni_ExecutionEngine_ERRORCODE_SUCCESS;
 }
 
+/**
+ * Starts writing evicted blocks from a background thread.
+ * This can only be called *after* the anti-cache has been enabled
+ * @param pointer the VoltDBEngine pointer
+ * @param maxPendingBlocks the number of blocks that can be queued before eviction stalls
+ * @return error code
+ */
+SHAREDLIB_JNIEXPORT jint JNICALL Java_org_voltdb_jni_ExecutionEngine_nativeAntiCacheAsyncEvictionInitialize (
+        JNIEnv *env,
+        jobject obj,
+        jlong engine_ptr,
+        jint maxPendingBlocks
+        ) {
+    VOLT_DEBUG("nativeAntiCacheAsyncEvictionInitialize() start");
+    VoltDBEngine *engine = castToEngine(engine_ptr);
+    Topend *topend = static_cast<JNITopend*>(engine->getTopend())->updateJNIEnv(env);
+    if (engine == NULL) {
+        return org_voltdb_jni_ExecutionEngine_ERRORCODE_ERROR;
+    }
+    try {
+        engine->antiCacheAsyncEvictionInitialize(static_cast<int>(maxPendingBlocks));
+    } catch (FatalException e) {
+        topend->crashVoltDB(e);
+    }
+    return org_voltdb_jni_ExecutionEngine_ERRORCODE_SUCCESS;
+}
+
+/**
+ * Starts the threads that fetch the evicted blocks of a transaction in one batch.
+ * This can only be called *after* the anti-cache has been enabled
+ * @param pointer the VoltDBEngine pointer
+ * @param numThreads the number of reader threads
+ * @return error code
+ */
+SHAREDLIB_JNIEXPORT jint JNICALL Java_org_voltdb_jni_ExecutionEngine_nativeAntiCacheAsyncReadInitialize (
+        JNIEnv *env,
+        jobject obj,
+        jlong engine_ptr,
+        jint numThreads
+        ) {
+    VOLT_DEBUG("nativeAntiCacheAsyncReadInitialize() start");
+    VoltDBEngine *engine = castToEngine(engine_ptr);
+    Topend *topend = static_cast<JNITopend*>(engine->getTopend())->updateJNIEnv(env);
+    if (engine == NULL) {
+        return org_voltdb_jni_ExecutionEngine_ERRORCODE_ERROR;
+    }
+    try {
+        engine->antiCacheAsyncReadInitialize(static_cast<int>(numThreads));
+    } catch (FatalException e) {
+        topend->crashVoltDB(e);
+    }
+    return org_voltdb_jni_ExecutionEngine_ERRORCODE_SUCCESS;
+}
+
+/**
+ * Sets the codec that evicted blocks are written with.
+ * This can only be called *after* the anti-cache has been enabled
+ * @param pointer the VoltDBEngine pointer
+ * @param codec the AntiCacheCodecType of the blocks
+ * @return error code
+ */
+SHAREDLIB_JNIEXPORT jint JNICALL Java_org_voltdb_jni_ExecutionEngine_nativeAntiCacheCodecInitialize (
+        JNIEnv *env,
+        jobject obj,
+        jlong engine_ptr,
+        jint codec
+        ) {
+    VOLT_DEBUG("nativeAntiCacheCodecInitialize() start");
+    VoltDBEngine *engine = castToEngine(engine_ptr);
+    Topend *topend = static_cast<JNITopend*>(engine->getTopend())->updateJNIEnv(env);
+    if (engine == NULL) {
+        return org_voltdb_jni_ExecutionEngine_ERRORCODE_ERROR;
+    }
+    try {
+        engine->antiCacheCodecInitialize(static_cast<AntiCacheCodecType>(codec));
+    } catch (FatalException e) {
+        topend->crashVoltDB(e);
+    }
+    return org_voltdb_jni_ExecutionEngine_ERRORCODE_SUCCESS;
+}
+
 SHAREDLIB_JNIEXPORT jint JNICALL Java_org_voltdb_jni_ExecutionEngine_nativeAntiCacheReadBlocks (
         JNIEnv *env,
         jobject obj,
@@ -1628,6 +1709,127 @@ SHAREDLIB_JNIEXPORT jint JNICALL Java_org_voltdb_jni_ExecutionEngine_nativeAntiC
 
 #endif
 
+/**
+ * Configures the allocation of the tuple blocks of this partition.
+ * This can only be called *before* the catalog has been initialized
+ * @param pointer the VoltDBEngine pointer
+ * @param hugePages whether to back blocks with huge pages
+ * @param numaBind whether to bind blocks to the NUMA node of the pinned core
+ * @param cacheBlocks the number of freed blocks kept for reuse
+ * @return error code
+ */
+SHAREDLIB_JNIEXPORT jint JNICALL Java_org_voltdb_jni_ExecutionEngine_nativeBlockAllocatorInitialize (
+        JNIEnv *env,
+        jobject obj,
+        jlong engine_ptr,
+        jboolean hugePages,
+        jboolean numaBind,
+        jint cacheBlocks) {
+
+    VOLT_DEBUG("nativeBlockAllocatorInitialize() start");
+    VoltDBEngine *engine = castToEngine(engine_ptr);
+    if (engine == NULL) {
+        return org_voltdb_jni_ExecutionEngine_ERRORCODE_ERROR;
+    }
+    Topend *topend = static_cast<JNITopend*>(engine->getTopend())->updateJNIEnv(env);
+    try {
+        engine->blockAllocatorInitialize(hugePages == JNI_TRUE, numaBind == JNI_TRUE, static_cast<int>(cacheBlocks));
+    } catch (FatalException e) {
+        topend->crashVoltDB(e);
+    }
+    return org_voltdb_jni_ExecutionEngine_ERRORCODE_SUCCESS;
+}
+
+/**
+ * Names the tables of this partition that keep their blocks in the PAX layout.
+ * This can only be called *before* the catalog has been initialized
+ * @param pointer the VoltDBEngine pointer
+ * @param tableNames comma separated table names
+ * @return error code
+ */
+SHAREDLIB_JNIEXPORT jint JNICALL Java_org_voltdb_jni_ExecutionEngine_nativePaxTablesInitialize (
+        JNIEnv *env,
+        jobject obj,
+        jlong engine_ptr,
+        jstring tableNames) {
+
+    VOLT_DEBUG("nativePaxTablesInitialize() start");
+    VoltDBEngine *engine = castToEngine(engine_ptr);
+    if (engine == NULL) {
+        return org_voltdb_jni_ExecutionEngine_ERRORCODE_ERROR;
+    }
+    Topend *topend = static_cast<JNITopend*>(engine->getTopend())->updateJNIEnv(env);
+    try {
+        const char *tableNamesChars = env->GetStringUTFChars(tableNames, NULL);
+        std::string tableNamesString(tableNamesChars);
+        env->ReleaseStringUTFChars(tableNames, tableNamesChars);
+        engine->paxTablesInitialize(tableNamesString);
+    } catch (FatalException e) {
+        topend->crashVoltDB(e);
+    }
+    return org_voltdb_jni_ExecutionEngine_ERRORCODE_SUCCESS;
+}
+
+/**
+ * Names the columns of the tables of this partition that keep zone maps.
+ * This can only be called *before* the catalog has been initialized
+ * @param pointer the VoltDBEngine pointer
+ * @param columnNames comma separated TABLE.COLUMN names
+ * @return error code
+ */
+SHAREDLIB_JNIEXPORT jint JNICALL Java_org_voltdb_jni_ExecutionEngine_nativeZoneMapsInitialize (
+        JNIEnv *env,
+        jobject obj,
+        jlong engine_ptr,
+        jstring columnNames) {
+
+    VOLT_DEBUG("nativeZoneMapsInitialize() start");
+    VoltDBEngine *engine = castToEngine(engine_ptr);
+    if (engine == NULL) {
+        return org_voltdb_jni_ExecutionEngine_ERRORCODE_ERROR;
+    }
+    Topend *topend = static_cast<JNITopend*>(engine->getTopend())->updateJNIEnv(env);
+    try {
+        const char *columnNamesChars = env->GetStringUTFChars(columnNames, NULL);
+        std::string columnNamesString(columnNamesChars);
+        env->ReleaseStringUTFChars(columnNames, columnNamesChars);
+        engine->zoneMapsInitialize(columnNamesString);
+    } catch (FatalException e) {
+        topend->crashVoltDB(e);
+    }
+    return org_voltdb_jni_ExecutionEngine_ERRORCODE_SUCCESS;
+}
+
+/**
+ * Names the tables of this partition whose snapshots copy whole blocks on their first write.
+ * This can only be called *before* the catalog has been initialized
+ * @param pointer the VoltDBEngine pointer
+ * @param tableNames comma separated table names
+ * @return error code
+ */
+SHAREDLIB_JNIEXPORT jint JNICALL Java_org_voltdb_jni_ExecutionEngine_nativeBlockCopyOnWriteTablesInitialize (
+        JNIEnv *env,
+        jobject obj,
+        jlong engine_ptr,
+        jstring tableNames) {
+
+    VOLT_DEBUG("nativeBlockCopyOnWriteTablesInitialize() start");
+    VoltDBEngine *engine = castToEngine(engine_ptr);
+    if (engine == NULL) {
+        return org_voltdb_jni_ExecutionEngine_ERRORCODE_ERROR;
+    }
+    Topend *topend = static_cast<JNITopend*>(engine->getTopend())->updateJNIEnv(env);
+    try {
+        const char *tableNamesChars = env->GetStringUTFChars(tableNames, NULL);
+        std::string tableNamesString(tableNamesChars);
+        env->ReleaseStringUTFChars(tableNames, tableNamesChars);
+        engine->blockCopyOnWriteTablesInitialize(tableNamesString);
+    } catch (FatalException e) {
+        topend->crashVoltDB(e);
+    }
+    return org_voltdb_jni_ExecutionEngine_ERRORCODE_SUCCESS;
+}
+
 #ifdef STORAGE_MMAP
 /**
  * Enables the storage mmap feature in the EE.
@@ -1635,6 +1837,9 @@ SHAREDLIB_JNIEXPORT jint JNICALL Java_org_voltdb_jni_ExecutionEngine_nativeAntiC
  * but *before* the catalog has been initialized
  * @param pointer the VoltDBEngine pointer
  * @param dbDir the directory where EE should store the mmap'ed files
+ * @param mapSize the size of the segments the mmap'ed files grow by
+ * @param syncFrequency the number of commits between background msyncs
+ * @param accessPattern NORMAL, SEQUENTIAL or RANDOM, the madvise hint of the table data
  * @return error code
  */
 SHAREDLIB_JNIEXPORT jint JNICALL Java_org_voltdb_jni_ExecutionEngine_nativeMMAPInitialize (
@@ -1643,7 +1848,8 @@ SHAREDLIB_JNIEXPORT jint JNICALL Java_org_voltdb_jni_ExecutionEngine_nativeMMAPI
         jlong engine_ptr,
         jstring dbDir,
         jlong mapSize,
-        jlong syncFrequency) {
+        jlong syncFrequency,
+        jstring accessPattern) {
 
     VOLT_DEBUG("nativeMMAPInitialize() start");
     VoltDBEngine *engine = castToEngine(engine_ptr);
@@ -1656,7 +1862,12 @@ SHAREDLIB_JNIEXPORT jint JNICALL Java_org_voltdb_jni_ExecutionEngine_nativeMMAPI
         std::string dbDirString(dbDirChars);
         env->ReleaseStringUTFChars(dbDir, dbDirChars);
 
-        engine->MMAPInitialize(dbDirString, static_cast<int64_t>(mapSize), static_cast<int64_t>(syncFrequency));
+        const char *accessPatternChars = env->GetStringUTFChars(accessPattern, NULL);
+        std::string accessPatternString(accessPatternChars);
+        env->ReleaseStringUTFChars(accessPattern, accessPatternChars);
+
+        engine->MMAPInitialize(dbDirString, static_cast<int64_t>(mapSize), static_cast<int64_t>(syncFrequency),
+                               accessPatternString);
     } catch (FatalException e) {
         topend->crashVoltDB(e);
     }
@@ -103,6 +103,7 @@ import org.voltdb.jni.ExecutionEngineJNI;
 import org.voltdb.jni.MockExecutionEngine;
 import org.voltdb.messaging.FastDeserializer;
 import org.voltdb.messaging.FastSerializer;
+import org.voltdb.types.AntiCacheCodecType;
 import org.voltdb.types.AntiCacheDBType;
 import org.voltdb.types.SpecExecSchedulerPolicyType;
 import org.voltdb.types.SpeculationConflictCheckerType;
@@ -855,6 +856,33 @@ public class PartitionExecutor implements Runnable, Configurable, Shutdownable {
                             }
                         }
                     }      
+                    AntiCacheCodecType codec = AntiCacheCodecType.get(hstore_conf.site.anticache_codec);
+                    if (codec != null && codec != AntiCacheCodecType.NONE) {
+                        eeTemp.antiCacheCodecInitialize(codec);
+                    }
+                    if (hstore_conf.site.anticache_async_eviction_blocks > 0) {
+                        eeTemp.antiCacheAsyncEvictionInitialize(hstore_conf.site.anticache_async_eviction_blocks);
+                    }
+                    if (hstore_conf.site.anticache_async_read_threads > 0) {
+                        eeTemp.antiCacheAsyncReadInitialize(hstore_conf.site.anticache_async_read_threads);
+                    }
+                }
+                
+                // Tuple block placement and reuse
+                eeTemp.blockAllocatorInitialize(hstore_conf.site.storage_hugepages,
+                                                hstore_conf.site.storage_numa_bind,
+                                                hstore_conf.site.storage_block_cache);
+                if (hstore_conf.site.storage_pax_tables != null &&
+                    hstore_conf.site.storage_pax_tables.isEmpty() == false) {
+                    eeTemp.paxTablesInitialize(hstore_conf.site.storage_pax_tables);
+                }
+                if (hstore_conf.site.storage_zone_map_columns != null &&
+                    hstore_conf.site.storage_zone_map_columns.isEmpty() == false) {
+                    eeTemp.zoneMapsInitialize(hstore_conf.site.storage_zone_map_columns);
+                }
+                if (hstore_conf.site.snapshot_block_cow_tables != null &&
+                    hstore_conf.site.snapshot_block_cow_tables.isEmpty() == false) {
+                    eeTemp.blockCopyOnWriteTablesInitialize(hstore_conf.site.snapshot_block_cow_tables);
                 }
                 
                 // Initialize STORAGE_MMAP
@@ -862,7 +890,8 @@ public class PartitionExecutor implements Runnable, Configurable, Shutdownable {
                     File dbFile = getMMAPDir(this);
                     long mapSize = hstore_conf.site.storage_mmap_file_size;
                     long syncFrequency = hstore_conf.site.storage_mmap_sync_frequency;
-                    eeTemp.MMAPInitialize(dbFile, mapSize, syncFrequency);
+                    String accessPattern = hstore_conf.site.storage_mmap_access;
+                    eeTemp.MMAPInitialize(dbFile, mapSize, syncFrequency, accessPattern);
                 }
                 
                 // Initialize ARIES
@@ -733,6 +733,27 @@ public final class HStoreConf {
                 experimental=true
         )
         public int anticache_blocks_per_eviction;
+
+        @ConfigProperty(
+                description="Maximum number of evicted blocks that are queued to be written to the " +
+                            "AntiCacheDB by a background thread of each partition. Eviction only " +
+                            "unlinks the tuples and serializes the blocks on the execution thread, and " +
+                            "stalls once this many blocks are waiting. Zero writes the blocks on the " +
+                            "execution thread as part of the eviction.",
+                defaultInt=0,
+                experimental=true
+        )
+        public int anticache_async_eviction_blocks;
+
+        @ConfigProperty(
+                description="Number of threads per partition that fetch the evicted blocks of a " +
+                            "restarted transaction from the AntiCacheDBs in one batch, instead of " +
+                            "reading them one after the other. Zero reads the blocks on the " +
+                            "execution thread.",
+                defaultInt=0,
+                experimental=true
+        )
+        public int anticache_async_read_threads;
         
         @ConfigProperty(
                 description="Policy specifying how to distribute eviction load over partitions and tables.",
@@ -757,6 +778,17 @@ public final class HStoreConf {
         )
         public String anticache_dbtype;
 
+        @ConfigProperty(
+                description="Codec that evicted blocks are compressed with before they are written " +
+                            "to the AntiCacheDBs. LZ compresses every block on its own, and LZ_DICT " +
+                            "additionally primes the compressor with a dictionary sampled from the " +
+                            "first evicted block of each table.",
+                defaultString="NONE",
+                experimental=true,
+                enumOptions="org.voltdb.types.AntiCacheCodecType"
+        )
+        public String anticache_codec;
+
         @ConfigProperty(
                 description="Top level database blocks for evictions",
                 defaultBoolean=false,
@@ -786,13 +818,79 @@ public final class HStoreConf {
             experimental=true
         )
         public boolean anticache_timestamps_prime;
+
+        @ConfigProperty(
+            description="Track tuple accesses with a CLOCK reference bit in the tuple header instead " +
+                        "of the LRU chain or the timestamps. Evictions sweep a hand over the blocks " +
+                        "of the table and pass over the tuples that were accessed since the last sweep. " +
+                        "This is compiled with ${site.anticache_build} set to true, and it takes " +
+                        "precedence over ${site.anticache_timestamps}.",
+            defaultBoolean=false,
+            experimental=true
+        )
+        public boolean anticache_clock;
+        
+        // ----------------------------------------------------------------------------
+        // Storage Block Options
+        // ----------------------------------------------------------------------------
+        
+        @ConfigProperty(
+            description="Back the 2MB tuple blocks of each partition with huge pages. The EE first takes " +
+                        "them from the reserved pool (vm.nr_hugepages) and then asks for transparent " +
+                        "huge pages.",
+            defaultBoolean=false,
+            experimental=true
+        )
+        public boolean storage_hugepages;
+        
+        @ConfigProperty(
+            description="Place the tuple blocks of each partition on the NUMA node of the CPU core that " +
+                        "its PartitionExecutor is pinned to. This only has an effect when " +
+                        "${site.cpu_affinity} and ${site.cpu_affinity_one_partition_per_core} are enabled.",
+            defaultBoolean=false,
+            experimental=true
+        )
+        public boolean storage_numa_bind;
+        
+        @ConfigProperty(
+            description="The number of freed tuple blocks that each partition keeps to reuse for new " +
+                        "blocks instead of returning them to the operating system.",
+            defaultInt=8,
+            experimental=true
+        )
+        public int storage_block_cache;
+        
+        @ConfigProperty(
+            description="Comma-separated list of tables that keep a column by column (PAX) copy of " +
+                        "their tuple blocks. Sequential scans on these tables evaluate comparisons of " +
+                        "numeric columns with constants or parameters over whole columns before they " +
+                        "look at any row. Every write to a block makes the next scan copy it again, so " +
+                        "this is only meant for read-mostly tables that are scanned a lot.",
+            defaultString="",
+            experimental=true
+        )
+        public String storage_pax_tables;
+        
+        @ConfigProperty(
+            description="Comma-separated list of TABLE.COLUMN names of integer or timestamp columns " +
+                        "that keep a min/max summary for every tuple block of their table. Sequential " +
+                        "scans skip the blocks whose summaries rule out a comparison of the column with " +
+                        "a constant or parameter. Meant for columns that grow with every insert, like " +
+                        "order or history dates, on tables that are scanned by time range.",
+            defaultString="",
+            experimental=true
+        )
+        public String storage_zone_map_columns;
         
         // ----------------------------------------------------------------------------
         // Storage MMAP Options
         // ----------------------------------------------------------------------------
         
         @ConfigProperty(
-            description="Use mmap to store database on local filesystem. ",
+            description="Use mmap to store database on local filesystem. " +
+                        "Tables whose columns are all inlined are checkpointed when their files are synced " +
+                        "with no transaction outstanding, and reattached from their files on restart " +
+                        "unless ${site.aries} is enabled, in which case the ARIES log is replayed into empty tables.",
             defaultBoolean=false,
             experimental=true
         )
@@ -807,12 +905,22 @@ public final class HStoreConf {
         public String storage_mmap_dir;
 
         @ConfigProperty(
-            description="The size (in bytes) for the mmap file objects on NVM device.",
+            description="The size (in bytes) for the mmap file objects on NVM device. " +
+                        "The file of a table grows by segments of this size as the table grows.",
             defaultLong=2097152, // 2MB
             experimental=true
         )
         public long storage_mmap_file_size;
         
+        @ConfigProperty(
+            description="How the mmap'ed table data is expected to be accessed, passed to madvise. " +
+                        "One of 'normal', 'sequential' (scan-heavy tables) or 'random' (point lookups). " +
+                        "This is only used if ${site.storage_mmap} is enabled.",
+            defaultString="normal",
+            experimental=true
+        )
+        public String storage_mmap_access;
+        
         @ConfigProperty(
             description="Reset the mmap directory for each partition when " +
                         "the HStoreSite is started.",
@@ -822,7 +930,8 @@ public final class HStoreConf {
         public boolean storage_mmap_reset;
         
         @ConfigProperty(
-            description="Frequency with which changes are synced via msync with memory",
+            description="Number of committed transactions after which the changes are synced " +
+                        "via msync with memory. The syncs run on a background thread.",
             defaultLong=100000,
             experimental=true
         )
@@ -896,6 +1005,16 @@ public final class HStoreConf {
             )
             public int snapshot_interval;
         
+        @ConfigProperty(
+                description="Comma-separated list of tables whose snapshots copy a whole tuple block on " +
+                            "the first write to it while the snapshot runs, instead of backing up every " +
+                            "updated or deleted tuple. Writes during a snapshot then cost one check per " +
+                            "block, which pays off for tables whose writes cluster in a few blocks.",
+                defaultString="",
+                experimental=true
+        )
+        public String snapshot_block_cow_tables;
+        
         // ----------------------------------------------------------------------------
         // MapReduce Options
         // ----------------------------------------------------------------------------
@@ -29,6 +29,12 @@ public class Index extends CatalogType {
     boolean m_unique;
     int m_type;
     CatalogMap<ColumnRef> m_columns;
+    int m_mergeratio;
+    int m_mergethreshold;
+    int m_mergememory;
+    int m_mergeinterval;
+    int m_bloombits;
+    int m_bloomhashes;
 
     void setBaseValues(Catalog catalog, CatalogType parent, String path, String name) {
         super.setBaseValues(catalog, parent, path, name);
@@ -36,11 +42,23 @@ public class Index extends CatalogType {
         m_fields.put("type", m_type);
         m_columns = new CatalogMap<ColumnRef>(catalog, this, path + "/" + "columns", ColumnRef.class);
         m_childCollections.put("columns", m_columns);
+        m_fields.put("mergeratio", m_mergeratio);
+        m_fields.put("mergethreshold", m_mergethreshold);
+        m_fields.put("mergememory", m_mergememory);
+        m_fields.put("mergeinterval", m_mergeinterval);
+        m_fields.put("bloombits", m_bloombits);
+        m_fields.put("bloomhashes", m_bloomhashes);
     }
 
     public void update() {
         m_unique = (Boolean) m_fields.get("unique");
         m_type = (Integer) m_fields.get("type");
+        m_mergeratio = (Integer) m_fields.get("mergeratio");
+        m_mergethreshold = (Integer) m_fields.get("mergethreshold");
+        m_mergememory = (Integer) m_fields.get("mergememory");
+        m_mergeinterval = (Integer) m_fields.get("mergeinterval");
+        m_bloombits = (Integer) m_fields.get("bloombits");
+        m_bloomhashes = (Integer) m_fields.get("bloomhashes");
     }
 
     /** GETTER: May the index contain duplicate keys? */
@@ -58,6 +76,36 @@ public class Index extends CatalogType {
         return m_columns;
     }
 
+    /** GETTER: Merge the dynamic stage of a compact index once it is 1/ratio of the static stage (0 for the default, -1 to disable) */
+    public int getMergeratio() {
+        return m_mergeratio;
+    }
+
+    /** GETTER: Smallest dynamic stage (in entries) merged by the ratio trigger (0 for the default) */
+    public int getMergethreshold() {
+        return m_mergethreshold;
+    }
+
+    /** GETTER: Merge the dynamic stage of a compact index once its entries take this many KB (0 to disable) */
+    public int getMergememory() {
+        return m_mergememory;
+    }
+
+    /** GETTER: Merge a non-empty dynamic stage of a compact index at least every this many milliseconds (0 to disable) */
+    public int getMergeinterval() {
+        return m_mergeinterval;
+    }
+
+    /** GETTER: Bloom filter bits per key over the dynamic stage of a compact index (0 for the default) */
+    public int getBloombits() {
+        return m_bloombits;
+    }
+
+    /** GETTER: Bloom filter hash functions over the dynamic stage of a compact index (0 for the default) */
+    public int getBloomhashes() {
+        return m_bloomhashes;
+    }
+
     /** SETTER: May the index contain duplicate keys? */
     public void setUnique(boolean value) {
         m_unique = value; m_fields.put("unique", value);
@@ -68,4 +116,34 @@ public class Index extends CatalogType {
         m_type = value; m_fields.put("type", value);
     }
 
+    /** SETTER: Merge the dynamic stage of a compact index once it is 1/ratio of the static stage (0 for the default, -1 to disable) */
+    public void setMergeratio(int value) {
+        m_mergeratio = value; m_fields.put("mergeratio", value);
+    }
+
+    /** SETTER: Smallest dynamic stage (in entries) merged by the ratio trigger (0 for the default) */
+    public void setMergethreshold(int value) {
+        m_mergethreshold = value; m_fields.put("mergethreshold", value);
+    }
+
+    /** SETTER: Merge the dynamic stage of a compact index once its entries take this many KB (0 to disable) */
+    public void setMergememory(int value) {
+        m_mergememory = value; m_fields.put("mergememory", value);
+    }
+
+    /** SETTER: Merge a non-empty dynamic stage of a compact index at least every this many milliseconds (0 to disable) */
+    public void setMergeinterval(int value) {
+        m_mergeinterval = value; m_fields.put("mergeinterval", value);
+    }
+
+    /** SETTER: Bloom filter bits per key over the dynamic stage of a compact index (0 for the default) */
+    public void setBloombits(int value) {
+        m_bloombits = value; m_fields.put("bloombits", value);
+    }
+
+    /** SETTER: Bloom filter hash functions over the dynamic stage of a compact index (0 for the default) */
+    public void setBloomhashes(int value) {
+        m_bloomhashes = value; m_fields.put("bloomhashes", value);
+    }
+
 }
@@ -74,6 +74,7 @@ import org.voltdb.compiler.projectfile.EvictablesType.Evictable;
 import org.voltdb.compiler.projectfile.ExportsType.Connector;
 import org.voltdb.compiler.projectfile.ExportsType.Connector.Tables;
 import org.voltdb.compiler.projectfile.GroupsType;
+import org.voltdb.compiler.projectfile.IndexmergepoliciesType.Indexmergepolicy;
 import org.voltdb.compiler.projectfile.ProceduresType;
 import org.voltdb.compiler.projectfile.ProjectType;
 import org.voltdb.compiler.projectfile.SchemasType;
@@ -856,6 +857,27 @@ public class VoltCompiler {
             } // FOR
         }
 
+        // Merge policies of compact indexes. A zero keeps the default of the engine
+        if (database.getIndexmergepolicies() != null) {
+            for (Indexmergepolicy p : database.getIndexmergepolicies().getIndexmergepolicy()) {
+                Table catalog_tbl = db.getTables().getIgnoreCase(p.getTable());
+                if (catalog_tbl == null) {
+                    throw new VoltCompilerException("Invalid index merge policy table name '" + p.getTable() + "'");
+                }
+                Index catalog_idx = catalog_tbl.getIndexes().getIgnoreCase(p.getIndex());
+                if (catalog_idx == null) {
+                    throw new VoltCompilerException("Invalid index merge policy index name '" + p.getIndex() +
+                                                    "' for table '" + catalog_tbl.getName() + "'");
+                }
+                catalog_idx.setMergeratio(p.getMergeratio());
+                catalog_idx.setMergethreshold(p.getMergethreshold());
+                catalog_idx.setMergememory(p.getMergememory());
+                catalog_idx.setMergeinterval(p.getMergeinterval());
+                catalog_idx.setBloombits(p.getBloombits());
+                catalog_idx.setBloomhashes(p.getBloomhashes());
+            } // FOR
+        }
+
         // add vertical partitions
         if (database.getVerticalpartitions() != null) {
             for (Verticalpartition vp : database.getVerticalpartitions().getVerticalpartition()) {
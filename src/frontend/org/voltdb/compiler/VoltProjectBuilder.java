@@ -221,6 +221,12 @@ public class VoltProjectBuilder {
     
     private final HashSet<String> m_batchEvictableTables = new HashSet<String>();
     
+    /**
+     * Index Merge Policies
+     * <TableName, IndexName> -> { mergeratio, mergethreshold, mergememory, mergeinterval, bloombits, bloomhashes }
+     */
+    private final LinkedHashMap<Pair<String, String>, int[]> m_indexMergePolicies = new LinkedHashMap<Pair<String, String>, int[]>();
+    
     /**
      * Prefetchable Queries
      * ProcedureName -> StatementName
@@ -490,6 +496,29 @@ public class VoltProjectBuilder {
         m_batchEvictableTables.add(tableName);
     }
 
+    // -------------------------------------------------------------------
+    // INDEX MERGE POLICIES
+    // -------------------------------------------------------------------
+    
+    /**
+     * Set when the dynamic stage of a compact index is merged into its
+     * static stage. A zero keeps the default of the engine.
+     * @param tableName
+     * @param indexName
+     * @param mergeRatio merge once the dynamic stage is 1/ratio of the static stage (-1 to disable)
+     * @param mergeThreshold smallest dynamic stage (in entries) merged by the ratio trigger
+     * @param mergeMemoryKB merge once the dynamic stage takes this many KB
+     * @param mergeIntervalMs merge a non-empty dynamic stage at least every this many milliseconds
+     * @param bloomBits bloom filter bits per key over the dynamic stage
+     * @param bloomHashes bloom filter hash functions over the dynamic stage
+     */
+    public void setIndexMergePolicy(String tableName, String indexName,
+                                    int mergeRatio, int mergeThreshold, int mergeMemoryKB, int mergeIntervalMs,
+                                    int bloomBits, int bloomHashes) {
+        m_indexMergePolicies.put(Pair.of(tableName, indexName),
+                                 new int[]{ mergeRatio, mergeThreshold, mergeMemoryKB, mergeIntervalMs, bloomBits, bloomHashes });
+    }
+
     // -------------------------------------------------------------------
     // DEFERRABLE STATEMENTS
     // -------------------------------------------------------------------
@@ -1104,6 +1133,22 @@ public class VoltProjectBuilder {
                 batchevictables.appendChild(table);
             }
         }        
+        // Index Merge Policies
+        if (m_indexMergePolicies.isEmpty() == false) {
+            final Element policies = doc.createElement("indexmergepolicies");
+            database.appendChild(policies);
+            
+            final String attrs[] = { "mergeratio", "mergethreshold", "mergememory", "mergeinterval", "bloombits", "bloomhashes" };
+            for (Entry<Pair<String, String>, int[]> e : m_indexMergePolicies.entrySet()) {
+                final Element policy = doc.createElement("indexmergepolicy");
+                policy.setAttribute("table", e.getKey().getFirst());
+                policy.setAttribute("index", e.getKey().getSecond());
+                for (int i = 0; i < attrs.length; i++) {
+                    policy.setAttribute(attrs[i], Integer.toString(e.getValue()[i]));
+                }
+                policies.appendChild(policy);
+            }
+        }
         // Vertical Partitions
         if (m_replicatedSecondaryIndexes.size() > 0) {
             // /project/database/partitions
@@ -32,6 +32,7 @@ import javax.xml.bind.annotation.XmlType;
  *         &lt;element name="partitions" type="{}partitionsType" minOccurs="0"/>
  *         &lt;element name="evictables" type="{}evictablesType" minOccurs="0"/>
  *         &lt;element name="batchevictables" type="{}evictablesType" minOccurs="0"/>
+ *         &lt;element name="indexmergepolicies" type="{}indexmergepoliciesType" minOccurs="0"/>
  *         &lt;element name="verticalpartitions" type="{}verticalpartitionsType" minOccurs="0"/>
  *         &lt;element name="classdependencies" type="{}classdependenciesType" minOccurs="0"/>
  *         &lt;element name="exports" type="{}exportsType" minOccurs="0"/>
@@ -61,6 +62,7 @@ public class DatabaseType {
     protected PartitionsType partitions;
     protected EvictablesType evictables;
     protected EvictablesType batchevictables;
+    protected IndexmergepoliciesType indexmergepolicies;
     protected VerticalpartitionsType verticalpartitions;
     protected ClassdependenciesType classdependencies;
     protected ExportsType exports;
@@ -238,6 +240,30 @@ public class DatabaseType {
         this.batchevictables = value;
     }
 
+    /**
+     * Gets the value of the indexmergepolicies property.
+     * 
+     * @return
+     *     possible object is
+     *     {@link IndexmergepoliciesType }
+     *     
+     */
+    public IndexmergepoliciesType getIndexmergepolicies() {
+        return indexmergepolicies;
+    }
+
+    /**
+     * Sets the value of the indexmergepolicies property.
+     * 
+     * @param value
+     *     allowed object is
+     *     {@link IndexmergepoliciesType }
+     *     
+     */
+    public void setIndexmergepolicies(IndexmergepoliciesType value) {
+        this.indexmergepolicies = value;
+    }
+
     /**
      * Gets the value of the verticalpartitions property.
      * 
@@ -0,0 +1,357 @@
+//
+// This file was generated by the JavaTM Architecture for XML Binding(JAXB) Reference Implementation, v2.2.4-2 
+// See <a href="http://java.sun.com/xml/jaxb">http://java.sun.com/xml/jaxb</a> 
+// Any modifications to this file will be lost upon recompilation of the source schema. 
+// Generated on: 2014.05.02 at 02:03:35 PM UTC 
+//
+
+
+package org.voltdb.compiler.projectfile;
+
+import java.util.ArrayList;
+import java.util.List;
+import javax.xml.bind.annotation.XmlAccessType;
+import javax.xml.bind.annotation.XmlAccessorType;
+import javax.xml.bind.annotation.XmlAttribute;
+import javax.xml.bind.annotation.XmlElement;
+import javax.xml.bind.annotation.XmlType;
+
+
+/**
+ * <p>Java class for indexmergepoliciesType complex type.
+ * 
+ * <p>The following schema fragment specifies the expected content contained within this class.
+ * 
+ * <pre>
+ * &lt;complexType name="indexmergepoliciesType">
+ *   &lt;complexContent>
+ *     &lt;restriction base="{http://www.w3.org/2001/XMLSchema}anyType">
+ *       &lt;sequence>
+ *         &lt;element name="indexmergepolicy" maxOccurs="unbounded">
+ *           &lt;complexType>
+ *             &lt;complexContent>
+ *               &lt;restriction base="{http://www.w3.org/2001/XMLSchema}anyType">
+ *                 &lt;attribute name="table" use="required" type="{http://www.w3.org/2001/XMLSchema}string" />
+ *                 &lt;attribute name="index" use="required" type="{http://www.w3.org/2001/XMLSchema}string" />
+ *                 &lt;attribute name="mergeratio" type="{http://www.w3.org/2001/XMLSchema}int" default="0" />
+ *                 &lt;attribute name="mergethreshold" type="{http://www.w3.org/2001/XMLSchema}int" default="0" />
+ *                 &lt;attribute name="mergememory" type="{http://www.w3.org/2001/XMLSchema}int" default="0" />
+ *                 &lt;attribute name="mergeinterval" type="{http://www.w3.org/2001/XMLSchema}int" default="0" />
+ *                 &lt;attribute name="bloombits" type="{http://www.w3.org/2001/XMLSchema}int" default="0" />
+ *                 &lt;attribute name="bloomhashes" type="{http://www.w3.org/2001/XMLSchema}int" default="0" />
+ *               &lt;/restriction>
+ *             &lt;/complexContent>
+ *           &lt;/complexType>
+ *         &lt;/element>
+ *       &lt;/sequence>
+ *     &lt;/restriction>
+ *   &lt;/complexContent>
+ * &lt;/complexType>
+ * </pre>
+ * 
+ * 
+ */
+@XmlAccessorType(XmlAccessType.FIELD)
+@XmlType(name = "indexmergepoliciesType", propOrder = {
+    "indexmergepolicy"
+})
+public class IndexmergepoliciesType {
+
+    @XmlElement(required = true)
+    protected List<IndexmergepoliciesType.Indexmergepolicy> indexmergepolicy;
+
+    /**
+     * Gets the value of the indexmergepolicy property.
+     * 
+     * <p>
+     * This accessor method returns a reference to the live list,
+     * not a snapshot. Therefore any modification you make to the
+     * returned list will be present inside the JAXB object.
+     * This is why there is not a <CODE>set</CODE> method for the indexmergepolicy property.
+     * 
+     * <p>
+     * For example, to add a new item, do as follows:
+     * <pre>
+     *    getIndexmergepolicy().add(newItem);
+     * </pre>
+     * 
+     * 
+     * <p>
+     * Objects of the following type(s) are allowed in the list
+     * {@link IndexmergepoliciesType.Indexmergepolicy }
+     * 
+     * 
+     */
+    public List<IndexmergepoliciesType.Indexmergepolicy> getIndexmergepolicy() {
+        if (indexmergepolicy == null) {
+            indexmergepolicy = new ArrayList<IndexmergepoliciesType.Indexmergepolicy>();
+        }
+        return this.indexmergepolicy;
+    }
+
+
+    /**
+     * <p>Java class for anonymous complex type.
+     * 
+     * <p>The following schema fragment specifies the expected content contained within this class.
+     * 
+     * <pre>
+     * &lt;complexType>
+     *   &lt;complexContent>
+     *     &lt;restriction base="{http://www.w3.org/2001/XMLSchema}anyType">
+     *       &lt;attribute name="table" use="required" type="{http://www.w3.org/2001/XMLSchema}string" />
+     *       &lt;attribute name="index" use="required" type="{http://www.w3.org/2001/XMLSchema}string" />
+     *       &lt;attribute name="mergeratio" type="{http://www.w3.org/2001/XMLSchema}int" default="0" />
+     *       &lt;attribute name="mergethreshold" type="{http://www.w3.org/2001/XMLSchema}int" default="0" />
+     *       &lt;attribute name="mergememory" type="{http://www.w3.org/2001/XMLSchema}int" default="0" />
+     *       &lt;attribute name="mergeinterval" type="{http://www.w3.org/2001/XMLSchema}int" default="0" />
+     *       &lt;attribute name="bloombits" type="{http://www.w3.org/2001/XMLSchema}int" default="0" />
+     *       &lt;attribute name="bloomhashes" type="{http://www.w3.org/2001/XMLSchema}int" default="0" />
+     *     &lt;/restriction>
+     *   &lt;/complexContent>
+     * &lt;/complexType>
+     * </pre>
+     * 
+     * 
+     */
+    @XmlAccessorType(XmlAccessType.FIELD)
+    @XmlType(name = "")
+    public static class Indexmergepolicy {
+
+        @XmlAttribute(name = "table", required = true)
+        protected String table;
+        @XmlAttribute(name = "index", required = true)
+        protected String index;
+        @XmlAttribute(name = "mergeratio")
+        protected Integer mergeratio;
+        @XmlAttribute(name = "mergethreshold")
+        protected Integer mergethreshold;
+        @XmlAttribute(name = "mergememory")
+        protected Integer mergememory;
+        @XmlAttribute(name = "mergeinterval")
+        protected Integer mergeinterval;
+        @XmlAttribute(name = "bloombits")
+        protected Integer bloombits;
+        @XmlAttribute(name = "bloomhashes")
+        protected Integer bloomhashes;
+
+
+        /**
+         * Gets the value of the table property.
+         * 
+         * @return
+         *     possible object is
+         *     {@link String }
+         *     
+         */
+        public String getTable() {
+            return table;
+        }
+
+        /**
+         * Sets the value of the table property.
+         * 
+         * @param value
+         *     allowed object is
+         *     {@link String }
+         *     
+         */
+        public void setTable(String value) {
+            this.table = value;
+        }
+
+        /**
+         * Gets the value of the index property.
+         * 
+         * @return
+         *     possible object is
+         *     {@link String }
+         *     
+         */
+        public String getIndex() {
+            return index;
+        }
+
+        /**
+         * Sets the value of the index property.
+         * 
+         * @param value
+         *     allowed object is
+         *     {@link String }
+         *     
+         */
+        public void setIndex(String value) {
+            this.index = value;
+        }
+
+        /**
+         * Gets the value of the mergeratio property.
+         * 
+         * @return
+         *     possible object is
+         *     {@link Integer }
+         *     
+         */
+        public int getMergeratio() {
+            if (mergeratio == null) {
+                return  0;
+            } else {
+                return mergeratio;
+            }
+        }
+
+        /**
+         * Sets the value of the mergeratio property.
+         * 
+         * @param value
+         *     allowed object is
+         *     {@link Integer }
+         *     
+         */
+        public void setMergeratio(Integer value) {
+            this.mergeratio = value;
+        }
+
+        /**
+         * Gets the value of the mergethreshold property.
+         * 
+         * @return
+         *     possible object is
+         *     {@link Integer }
+         *     
+         */
+        public int getMergethreshold() {
+            if (mergethreshold == null) {
+                return  0;
+            } else {
+                return mergethreshold;
+            }
+        }
+
+        /**
+         * Sets the value of the mergethreshold property.
+         * 
+         * @param value
+         *     allowed object is
+         *     {@link Integer }
+         *     
+         */
+        public void setMergethreshold(Integer value) {
+            this.mergethreshold = value;
+        }
+
+        /**
+         * Gets the value of the mergememory property.
+         * 
+         * @return
+         *     possible object is
+         *     {@link Integer }
+         *     
+         */
+        public int getMergememory() {
+            if (mergememory == null) {
+                return  0;
+            } else {
+                return mergememory;
+            }
+        }
+
+        /**
+         * Sets the value of the mergememory property.
+         * 
+         * @param value
+         *     allowed object is
+         *     {@link Integer }
+         *     
+         */
+        public void setMergememory(Integer value) {
+            this.mergememory = value;
+        }
+
+        /**
+         * Gets the value of the mergeinterval property.
+         * 
+         * @return
+         *     possible object is
+         *     {@link Integer }
+         *     
+         */
+        public int getMergeinterval() {
+            if (mergeinterval == null) {
+                return  0;
+            } else {
+                return mergeinterval;
+            }
+        }
+
+        /**
+         * Sets the value of the mergeinterval property.
+         * 
+         * @param value
+         *     allowed object is
+         *     {@link Integer }
+         *     
+         */
+        public void setMergeinterval(Integer value) {
+            this.mergeinterval = value;
+        }
+
+        /**
+         * Gets the value of the bloombits property.
+         * 
+         * @return
+         *     possible object is
+         *     {@link Integer }
+         *     
+         */
+        public int getBloombits() {
+            if (bloombits == null) {
+                return  0;
+            } else {
+                return bloombits;
+            }
+        }
+
+        /**
+         * Sets the value of the bloombits property.
+         * 
+         * @param value
+         *     allowed object is
+         *     {@link Integer }
+         *     
+         */
+        public void setBloombits(Integer value) {
+            this.bloombits = value;
+        }
+
+        /**
+         * Gets the value of the bloomhashes property.
+         * 
+         * @return
+         *     possible object is
+         *     {@link Integer }
+         *     
+         */
+        public int getBloomhashes() {
+            if (bloomhashes == null) {
+                return  0;
+            } else {
+                return bloomhashes;
+            }
+        }
+
+        /**
+         * Sets the value of the bloomhashes property.
+         * 
+         * @param value
+         *     allowed object is
+         *     {@link Integer }
+         *     
+         */
+        public void setBloomhashes(Integer value) {
+            this.bloomhashes = value;
+        }
+
+    }
+
+}
@@ -64,6 +64,14 @@ public class ObjectFactory {
         return new EvictablesType();
     }
 
+    /**
+     * Create an instance of {@link IndexmergepoliciesType }
+     * 
+     */
+    public IndexmergepoliciesType createIndexmergepoliciesType() {
+        return new IndexmergepoliciesType();
+    }
+
     /**
      * Create an instance of {@link ClassdependenciesType }
      * 
@@ -184,6 +192,14 @@ public class ObjectFactory {
         return new EvictablesType.Evictable();
     }
 
+    /**
+     * Create an instance of {@link IndexmergepoliciesType.Indexmergepolicy }
+     * 
+     */
+    public IndexmergepoliciesType.Indexmergepolicy createIndexmergepoliciesTypeIndexmergepolicy() {
+        return new IndexmergepoliciesType.Indexmergepolicy();
+    }
+
     /**
      * Create an instance of {@link ClassdependenciesType.Classdependency }
      * 
@@ -39,6 +39,7 @@ import org.voltdb.messaging.FastDeserializer;
 import org.voltdb.utils.DBBPool.BBContainer;
 import org.voltdb.utils.LogKeys;
 import org.voltdb.utils.VoltLoggerFactory;
+import org.voltdb.types.AntiCacheCodecType;
 import org.voltdb.types.AntiCacheDBType;
 
 import edu.brown.hstore.HStore;
@@ -815,6 +816,31 @@ public abstract class ExecutionEngine implements FastDeserializer.Deserializatio
      * @throws EEException
      */
     public abstract void antiCacheAddDB(File dbDir, AntiCacheDBType dbType, boolean blocking, long blockSize, long maxSize, boolean blockMerge) throws EEException;
+
+    /**
+     * Write evicted blocks to the AntiCacheDBs from a background thread.
+     * <B>NOTE:</B> This can only be invoked after antiCacheInitialize is invoked
+     * @param maxPendingBlocks The number of blocks that can be queued before eviction stalls
+     * @throws EEException
+     */
+    public abstract void antiCacheAsyncEvictionInitialize(int maxPendingBlocks) throws EEException;
+
+    /**
+     * Fetch the evicted blocks of a transaction in one batch with a pool of reader threads.
+     * <B>NOTE:</B> This can only be invoked after antiCacheInitialize is invoked
+     * @param numThreads The number of reader threads
+     * @throws EEException
+     */
+    public abstract void antiCacheAsyncReadInitialize(int numThreads) throws EEException;
+
+    /**
+     * Compress the blocks written to the AntiCacheDBs with the given codec.
+     * <B>NOTE:</B> This can only be invoked after antiCacheInitialize is invoked
+     * and before the first block is evicted
+     * @param codec
+     * @throws EEException
+     */
+    public abstract void antiCacheCodecInitialize(AntiCacheCodecType codec) throws EEException;
     
     /**
      * 
@@ -879,6 +905,30 @@ public abstract class ExecutionEngine implements FastDeserializer.Deserializatio
      * @return
      */
     protected native int nativeAntiCacheAddDB(long pointer, String dbDir, long blockSize, int dbtype, boolean blocking, long maxSize, boolean blockMerge);
+
+    /**
+     * Starts the background writer for evicted blocks
+     * @param pointer
+     * @param maxPendingBlocks
+     * @return
+     */
+    protected native int nativeAntiCacheAsyncEvictionInitialize(long pointer, int maxPendingBlocks);
+
+    /**
+     * Starts the reader threads for evicted blocks
+     * @param pointer
+     * @param numThreads
+     * @return
+     */
+    protected native int nativeAntiCacheAsyncReadInitialize(long pointer, int numThreads);
+
+    /**
+     * Sets the codec of the AntiCacheDBs
+     * @param pointer
+     * @param codec
+     * @return
+     */
+    protected native int nativeAntiCacheCodecInitialize(long pointer, int codec);
     
      /**
      * 
@@ -922,17 +972,55 @@ public abstract class ExecutionEngine implements FastDeserializer.Deserializatio
      */
     public native static long nativeGetRSS();    
     
+    // ----------------------------------------------------------------------------
+    // STORAGE BLOCKS
+    // ----------------------------------------------------------------------------
+    
+    public abstract void blockAllocatorInitialize(boolean hugePages, boolean numaBind, int cacheBlocks) throws EEException;
+    
+    /**
+     * Configures how the EE allocates the tuple blocks of this partition's tables.
+     * This must be called *before* the catalog has been loaded.
+     */
+    protected native int nativeBlockAllocatorInitialize(long pointer, boolean hugePages, boolean numaBind, int cacheBlocks);
+    
+    public abstract void paxTablesInitialize(String tableNames) throws EEException;
+    
+    /**
+     * Names the tables (comma-separated) that keep their blocks in the PAX layout.
+     * This must be called *before* the catalog has been loaded.
+     */
+    protected native int nativePaxTablesInitialize(long pointer, String tableNames);
+    
+    public abstract void zoneMapsInitialize(String columnNames) throws EEException;
+    
+    /**
+     * Names the columns (comma-separated TABLE.COLUMN) that keep per-block zone maps.
+     * This must be called *before* the catalog has been loaded.
+     */
+    protected native int nativeZoneMapsInitialize(long pointer, String columnNames);
+    
+    public abstract void blockCopyOnWriteTablesInitialize(String tableNames) throws EEException;
+    
+    /**
+     * Names the tables (comma-separated) whose snapshots copy whole blocks on their first write.
+     * This must be called *before* the catalog has been loaded.
+     */
+    protected native int nativeBlockCopyOnWriteTablesInitialize(long pointer, String tableNames);
+    
     // ----------------------------------------------------------------------------
     // STORAGE MMAP
     // ----------------------------------------------------------------------------
     
-    public abstract void MMAPInitialize(File dbDir, long mapSize, long syncFrequency) throws EEException;
+    public abstract void MMAPInitialize(File dbDir, long mapSize, long syncFrequency, String accessPattern) throws EEException;
     
     /**
      * Enables the mmap storage feature in the EE. The given database directory path
      * must be a unique location for this partition where the EE can store MMAP'ed files.
+     * The files grow in segments of mapSize bytes, and the access pattern (NORMAL,
+     * SEQUENTIAL or RANDOM) is passed to madvise for the table data.
      */
-    protected native int nativeMMAPInitialize(long pointer, String dbDir, long mapSize, long syncFrequency);
+    protected native int nativeMMAPInitialize(long pointer, String dbDir, long mapSize, long syncFrequency, String accessPattern);
 
     // ----------------------------------------------------------------------------
     // ARIES
@@ -49,6 +49,7 @@ import org.voltdb.messaging.FastDeserializer;
 import org.voltdb.messaging.FastSerializer;
 import org.voltdb.utils.DBBPool.BBContainer;
 import org.voltdb.utils.NotImplementedException;
+import org.voltdb.types.AntiCacheCodecType;
 import org.voltdb.types.AntiCacheDBType;
 
 import edu.brown.hstore.HStore;
@@ -1488,6 +1489,21 @@ public class ExecutionEngineIPC extends ExecutionEngine {
         throw new NotImplementedException("Anti-Caching is disabled for IPC ExecutionEngine");
     }
 
+    @Override
+    public void antiCacheAsyncEvictionInitialize(int maxPendingBlocks) throws EEException {
+        throw new NotImplementedException("Anti-Caching is disabled for IPC ExecutionEngine");
+    }
+
+    @Override
+    public void antiCacheAsyncReadInitialize(int numThreads) throws EEException {
+        throw new NotImplementedException("Anti-Caching is disabled for IPC ExecutionEngine");
+    }
+
+    @Override
+    public void antiCacheCodecInitialize(AntiCacheCodecType codec) throws EEException {
+        throw new NotImplementedException("Anti-Caching is disabled for IPC ExecutionEngine");
+    }
+
     @Override
     public void antiCacheReadBlocks(Table catalog_tbl, int[] block_ids, int[] tuple_offsets) {
         throw new NotImplementedException("Anti-Caching is disabled for IPC ExecutionEngine");
@@ -1511,7 +1527,27 @@ public class ExecutionEngineIPC extends ExecutionEngine {
 
     
     @Override
-    public void MMAPInitialize(File dbDir, long mapSize, long syncFrequency) throws EEException {
+    public void blockAllocatorInitialize(boolean hugePages, boolean numaBind, int cacheBlocks) throws EEException {
+        // the IPC ExecutionEngine keeps the default block allocation
+    }
+    
+    @Override
+    public void paxTablesInitialize(String tableNames) throws EEException {
+        // the IPC ExecutionEngine keeps the row layout for all tables
+    }
+    
+    @Override
+    public void zoneMapsInitialize(String columnNames) throws EEException {
+        // the IPC ExecutionEngine scans every block
+    }
+    
+    @Override
+    public void blockCopyOnWriteTablesInitialize(String tableNames) throws EEException {
+        // the IPC ExecutionEngine backs up tuples one by one during snapshots
+    }
+    
+    @Override
+    public void MMAPInitialize(File dbDir, long mapSize, long syncFrequency, String accessPattern) throws EEException {
         throw new NotImplementedException("Storage MMAP is disabled for IPC ExecutionEngine");
     }
     
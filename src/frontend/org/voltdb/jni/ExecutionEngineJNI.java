@@ -39,6 +39,7 @@ import org.voltdb.export.ExportProtoMessage;
 import org.voltdb.messaging.FastDeserializer;
 import org.voltdb.messaging.FastSerializer;
 import org.voltdb.messaging.FastSerializer.BufferGrowCallback;
+import org.voltdb.types.AntiCacheCodecType;
 import org.voltdb.types.AntiCacheDBType;
 import org.voltdb.utils.DBBPool.BBContainer;
 
@@ -801,6 +802,27 @@ public class ExecutionEngineJNI extends ExecutionEngine {
         checkErrorCode(errorCode);
     }
 
+    @Override
+    public void antiCacheAsyncEvictionInitialize(int maxPendingBlocks) throws EEException {
+        assert(m_anticache == true);
+        final int errorCode = nativeAntiCacheAsyncEvictionInitialize(this.pointer, maxPendingBlocks);
+        checkErrorCode(errorCode);
+    }
+
+    @Override
+    public void antiCacheAsyncReadInitialize(int numThreads) throws EEException {
+        assert(m_anticache == true);
+        final int errorCode = nativeAntiCacheAsyncReadInitialize(this.pointer, numThreads);
+        checkErrorCode(errorCode);
+    }
+
+    @Override
+    public void antiCacheCodecInitialize(AntiCacheCodecType codec) throws EEException {
+        assert(m_anticache == true);
+        final int errorCode = nativeAntiCacheCodecInitialize(this.pointer, codec.ordinal());
+        checkErrorCode(errorCode);
+    }
+
     
     @Override
     public void antiCacheReadBlocks(Table catalog_tbl, int[] block_ids, int[] tuple_offsets) {
@@ -878,17 +900,79 @@ public class ExecutionEngineJNI extends ExecutionEngine {
     }
 
     
+    /*
+     * STORAGE BLOCKS
+     */
+    
+    @Override
+    public void blockAllocatorInitialize(boolean hugePages, boolean numaBind, int cacheBlocks) throws EEException {
+        if (debug.val)
+            LOG.debug(String.format("Partition #%d block allocator: hugePages=%b numaBind=%b cacheBlocks=%d",
+                      this.executor.getPartitionId(), hugePages, numaBind, cacheBlocks));
+        final int errorCode = nativeBlockAllocatorInitialize(this.pointer, hugePages, numaBind, cacheBlocks);
+        checkErrorCode(errorCode);
+    }
+    
+    @Override
+    public void paxTablesInitialize(String tableNames) throws EEException {
+        StringBuilder names = new StringBuilder();
+        for (String name : tableNames.split(",")) {
+            name = name.trim().toUpperCase();
+            if (name.isEmpty()) continue;
+            if (names.length() > 0) names.append(",");
+            names.append(name);
+        }
+        if (debug.val)
+            LOG.debug(String.format("Partition #%d PAX tables: %s",
+                      this.executor.getPartitionId(), names));
+        final int errorCode = nativePaxTablesInitialize(this.pointer, names.toString());
+        checkErrorCode(errorCode);
+    }
+    
+    @Override
+    public void zoneMapsInitialize(String columnNames) throws EEException {
+        StringBuilder names = new StringBuilder();
+        for (String name : columnNames.split(",")) {
+            name = name.trim().toUpperCase();
+            if (name.isEmpty()) continue;
+            if (names.length() > 0) names.append(",");
+            names.append(name);
+        }
+        if (debug.val)
+            LOG.debug(String.format("Partition #%d zone map columns: %s",
+                      this.executor.getPartitionId(), names));
+        final int errorCode = nativeZoneMapsInitialize(this.pointer, names.toString());
+        checkErrorCode(errorCode);
+    }
+    
+    @Override
+    public void blockCopyOnWriteTablesInitialize(String tableNames) throws EEException {
+        StringBuilder names = new StringBuilder();
+        for (String name : tableNames.split(",")) {
+            name = name.trim().toUpperCase();
+            if (name.isEmpty()) continue;
+            if (names.length() > 0) names.append(",");
+            names.append(name);
+        }
+        if (debug.val)
+            LOG.debug(String.format("Partition #%d block copy on write tables: %s",
+                      this.executor.getPartitionId(), names));
+        final int errorCode = nativeBlockCopyOnWriteTablesInitialize(this.pointer, names.toString());
+        checkErrorCode(errorCode);
+    }
+    
     /*
      * MMAP STORAGE
      */
     
     @Override
-    public void MMAPInitialize(File dbDir, long mapSize, long syncFrequency) throws EEException {
+    public void MMAPInitialize(File dbDir, long mapSize, long syncFrequency, String accessPattern) throws EEException {
         
         LOG.info("Initializing storage mmap feature at partition " + this.executor.getPartitionId());
         LOG.info(String.format("Partition #%d MMAP Directory: %s",
                  this.executor.getPartitionId(), dbDir.getAbsolutePath()));
-        final int errorCode = nativeMMAPInitialize(this.pointer, dbDir.getAbsolutePath(), mapSize, syncFrequency);
+        final int errorCode = nativeMMAPInitialize(this.pointer, dbDir.getAbsolutePath(), mapSize, syncFrequency,
+                                                   (accessPattern == null ? "" : accessPattern.trim().toUpperCase()));
         checkErrorCode(errorCode);
         m_anticache = true;
     }
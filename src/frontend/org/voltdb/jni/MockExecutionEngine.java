@@ -31,6 +31,7 @@ import org.voltdb.exceptions.EEException;
 import org.voltdb.export.ExportProtoMessage;
 import org.voltdb.utils.NotImplementedException;
 import org.voltdb.utils.DBBPool.BBContainer;
+import org.voltdb.types.AntiCacheCodecType;
 import org.voltdb.types.AntiCacheDBType;
 
 public class MockExecutionEngine extends ExecutionEngine {
@@ -208,6 +209,18 @@ public class MockExecutionEngine extends ExecutionEngine {
     public void antiCacheAddDB(File dbFilePath, AntiCacheDBType dbType, boolean blocking, long blockSize, long maxSize, boolean blockMerge) throws EEException {
     }
 
+    @Override
+    public void antiCacheAsyncEvictionInitialize(int maxPendingBlocks) throws EEException {
+    }
+
+    @Override
+    public void antiCacheAsyncReadInitialize(int numThreads) throws EEException {
+    }
+
+    @Override
+    public void antiCacheCodecInitialize(AntiCacheCodecType codec) throws EEException {
+    }
+
     @Override
     public void antiCacheReadBlocks(Table catalog_tbl, int[] block_ids, int[] tuple_offsets) {
         // TODO Auto-generated method stub
@@ -233,7 +246,27 @@ public class MockExecutionEngine extends ExecutionEngine {
 
     
     @Override
-    public void MMAPInitialize(File dbDir, long mapSize, long syncFrequency) throws EEException {
+    public void blockAllocatorInitialize(boolean hugePages, boolean numaBind, int cacheBlocks) throws EEException {
+     // TODO Auto-generated method stub        
+    }
+    
+    @Override
+    public void paxTablesInitialize(String tableNames) throws EEException {
+     // TODO Auto-generated method stub        
+    }
+    
+    @Override
+    public void zoneMapsInitialize(String columnNames) throws EEException {
+     // TODO Auto-generated method stub        
+    }
+    
+    @Override
+    public void blockCopyOnWriteTablesInitialize(String tableNames) throws EEException {
+     // TODO Auto-generated method stub        
+    }
+    
+    @Override
+    public void MMAPInitialize(File dbDir, long mapSize, long syncFrequency, String accessPattern) throws EEException {
      // TODO Auto-generated method stub        
     }
     
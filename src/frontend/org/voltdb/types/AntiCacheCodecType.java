@@ -0,0 +1,44 @@
+package org.voltdb.types;
+
+import java.util.EnumSet;
+import java.util.HashMap;
+import java.util.Map;
+
+/**
+ * Codecs that evicted blocks are written to the AntiCacheDBs with
+ * (mirrors AntiCacheCodecType in the EE)
+ */
+public enum AntiCacheCodecType {
+    /**
+     * Blocks are written as serialized
+     */
+    NONE,
+    /**
+     * LZ77 compression of every block on its own
+     */
+    LZ,
+    /**
+     * LZ77 compression with a dictionary trained on the first block of a table
+     */
+    LZ_DICT
+    ;
+
+    private static final Map<String, AntiCacheCodecType> name_lookup = new HashMap<String, AntiCacheCodecType>();
+    static {
+        for (AntiCacheCodecType vt : EnumSet.allOf(AntiCacheCodecType.class)) {
+            name_lookup.put(vt.name().toLowerCase(), vt);
+        }
+    } // STATIC
+
+    public static AntiCacheCodecType get(int idx) {
+        AntiCacheCodecType values[] = AntiCacheCodecType.values();
+        if (idx < 0 || idx >= values.length) {
+            return(null);
+        }
+        return (values[idx]);
+    }
+
+    public static AntiCacheCodecType get(String name) {
+        return AntiCacheCodecType.name_lookup.get(name.toLowerCase());
+    }
+}
@@ -20,7 +20,11 @@ public enum AntiCacheDBType {
     /**
      * NVM file-based store
      */
-    NVM
+    NVM,
+    /**
+     * Log-structured segment files written with O_DIRECT
+     */
+    LOG
     ;
 
     private static final Map<String, AntiCacheDBType> name_lookup = new HashMap<String, AntiCacheDBType>();
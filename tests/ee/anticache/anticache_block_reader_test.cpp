@@ -0,0 +1,155 @@
+/* Copyright (C) 2014 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <string>
+#include <cstring>
+#include <vector>
+#include "harness.h"
+#include "anticache/AntiCacheDB.h"
+#include "anticache/AntiCacheBlockReader.h"
+#include "anticache/BerkeleyAntiCacheDB.h"
+#include "anticache/NVMAntiCacheDB.h"
+
+using namespace std;
+using namespace voltdb;
+using stupidunit::ChTempDir;
+
+#define BLOCK_SIZE 524288
+#define MAX_SIZE 1024000000
+
+/**
+ * AntiCacheBlockReader Tests
+ */
+class AntiCacheBlockReaderTest : public Test {
+public:
+    AntiCacheBlockReaderTest() {
+
+    };
+
+    static string payload(uint32_t blockId) {
+        string data;
+        for (int i = 0; i < 512; i++) {
+            data.append("Block ");
+            data.push_back(static_cast<char>('A' + blockId % 26));
+        }
+        return data;
+    }
+
+    static vector<AntiCacheBlockReader::Request> writeBlocks(AntiCacheDB *anticache, int numBlocks) {
+        vector<AntiCacheBlockReader::Request> requests;
+        for (int i = 0; i < numBlocks; i++) {
+            AntiCacheBlockReader::Request request;
+            request.antiCacheDB = anticache;
+            request.blockId = anticache->nextBlockId();
+            request.block = NULL;
+            request.storedSize = 0;
+            string data = payload(request.blockId);
+            anticache->writeBlock("FAKE", request.blockId, 1, data.c_str(),
+                                  static_cast<long>(data.size()) + 1, 1);
+            requests.push_back(request);
+        }
+        return requests;
+    }
+
+    void checkBlocks(AntiCacheDB *anticache, vector<AntiCacheBlockReader::Request> &requests) {
+        for (size_t i = 0; i < requests.size(); i++) {
+            AntiCacheBlock *block = requests[i].block;
+            ASSERT_TRUE(block != NULL);
+            ASSERT_EQ(block->getTableName(), string("FAKE"));
+            ASSERT_EQ(0, payload(requests[i].blockId).compare(block->getData()));
+            anticache->unevictBlock(requests[i].blockId, requests[i].storedSize, 1);
+            ASSERT_FALSE(anticache->validateBlock(requests[i].blockId));
+            delete block;
+        }
+        ASSERT_EQ(anticache->getNumBlocks(), 0);
+    }
+};
+
+TEST_F(AntiCacheBlockReaderTest, FetchesBerkeleyBatch) {
+    ChTempDir tempdir;
+    AntiCacheDB* anticache = new BerkeleyAntiCacheDB(NULL, ".", BLOCK_SIZE, MAX_SIZE);
+    AntiCacheBlockReader* reader = new AntiCacheBlockReader(4);
+
+    vector<AntiCacheBlockReader::Request> requests = writeBlocks(anticache, 32);
+    reader->fetchBlocks(requests);
+    ASSERT_EQ(1, reader->getBatches());
+    ASSERT_EQ(32, reader->getBlocksFetched());
+    // fetching does not change the database
+    ASSERT_EQ(anticache->getNumBlocks(), 32);
+    checkBlocks(anticache, requests);
+
+    delete reader;
+    delete anticache;
+}
+
+TEST_F(AntiCacheBlockReaderTest, FetchesCompressedNVMBatch) {
+    ChTempDir tempdir;
+    AntiCacheDB* anticache = new NVMAntiCacheDB(NULL, ".", BLOCK_SIZE, BLOCK_SIZE * 64);
+    anticache->setCodec(ANTICACHE_CODEC_LZ);
+    AntiCacheBlockReader* reader = new AntiCacheBlockReader(2);
+
+    vector<AntiCacheBlockReader::Request> requests = writeBlocks(anticache, 16);
+    vector<uint32_t> blockIds;
+    for (size_t i = 0; i < requests.size(); i++) {
+        blockIds.push_back(requests[i].blockId);
+    }
+    anticache->prefetchBlocks(blockIds);
+    reader->fetchBlocks(requests);
+
+    // the decoded data is handed over without a copy
+    char *data = requests[0].block->getData();
+    char *released = requests[0].block->releaseData();
+    ASSERT_TRUE(data == released);
+    ASSERT_EQ(0, payload(requests[0].blockId).compare(released));
+    delete [] released;
+    anticache->unevictBlock(requests[0].blockId, requests[0].storedSize, 1);
+    delete requests[0].block;
+    requests.erase(requests.begin());
+    checkBlocks(anticache, requests);
+
+    delete reader;
+    delete anticache;
+}
+
+TEST_F(AntiCacheBlockReaderTest, MissingBlocks) {
+    ChTempDir tempdir;
+    AntiCacheDB* anticache = new BerkeleyAntiCacheDB(NULL, ".", BLOCK_SIZE, MAX_SIZE);
+    // without threads the caller fetches the whole batch
+    AntiCacheBlockReader* reader = new AntiCacheBlockReader(0);
+
+    vector<AntiCacheBlockReader::Request> requests = writeBlocks(anticache, 2);
+    requests[1].blockId += 100;
+    reader->fetchBlocks(requests);
+    ASSERT_TRUE(requests[0].block != NULL);
+    ASSERT_TRUE(requests[1].block == NULL);
+    delete requests[0].block;
+
+    delete reader;
+    delete anticache;
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
@@ -0,0 +1,270 @@
+/* Copyright (C) 2014 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <string>
+#include <cstring>
+#include <unistd.h>
+#include <pthread.h>
+#include "harness.h"
+#include "common/FatalException.hpp"
+#include "anticache/AntiCacheDB.h"
+#include "anticache/AntiCacheBlockWriter.h"
+#include "anticache/BerkeleyAntiCacheDB.h"
+#include "anticache/FullBackingStoreException.h"
+#include "anticache/NVMAntiCacheDB.h"
+
+using namespace std;
+using namespace voltdb;
+using stupidunit::ChTempDir;
+
+#define BLOCK_SIZE 524288
+#define MAX_SIZE 1024000000
+
+/**
+ * AntiCacheBlockWriter Tests
+ */
+class AntiCacheBlockWriterTest : public Test {
+public:
+    AntiCacheBlockWriterTest() {
+
+    };
+
+    static char* blockData(const string &payload) {
+        char *data = new char[payload.size() + 1];
+        memcpy(data, payload.c_str(), payload.size() + 1);
+        return data;
+    }
+};
+
+struct EnqueueArgs {
+    AntiCacheBlockWriter *writer;
+    AntiCacheDB *anticache;
+    uint32_t blockId;
+};
+
+// an AntiCacheDB whose next writes of one block and next flushes fail
+class FlakyAntiCacheDB : public NVMAntiCacheDB {
+public:
+    FlakyAntiCacheDB(uint32_t failedBlockId, int failedWrites, int failedFlushes) :
+        NVMAntiCacheDB(NULL, ".", BLOCK_SIZE, BLOCK_SIZE*4),
+        m_failedBlockId(failedBlockId), m_failedWrites(failedWrites), m_failedFlushes(failedFlushes) {}
+
+    void flushBlocks() {
+        if (m_failedFlushes > 0) {
+            m_failedFlushes--;
+            throw FullBackingStoreException(0, getACID());
+        }
+        NVMAntiCacheDB::flushBlocks();
+    }
+
+protected:
+    void storeBlock(const std::string tableName, uint32_t blockId, const int tupleCount,
+                    const char* data, const long size, const int evictedTupleCount) {
+        if (blockId == m_failedBlockId && m_failedWrites > 0) {
+            m_failedWrites--;
+            throw FullBackingStoreException(blockId, getACID());
+        }
+        NVMAntiCacheDB::storeBlock(tableName, blockId, tupleCount, data, size, evictedTupleCount);
+    }
+
+private:
+    uint32_t m_failedBlockId;
+    int m_failedWrites;
+    int m_failedFlushes;
+};
+
+static void* enqueueBlock(void *argsPtr) {
+    EnqueueArgs *args = static_cast<EnqueueArgs*>(argsPtr);
+    args->writer->enqueue(args->anticache, "FAKE", args->blockId, 1,
+                          AntiCacheBlockWriterTest::blockData("Blocked"), 8);
+    return NULL;
+}
+
+TEST_F(AntiCacheBlockWriterTest, WritesQueuedBlocks) {
+    ChTempDir tempdir;
+    AntiCacheDB* anticache = new BerkeleyAntiCacheDB(NULL, ".", BLOCK_SIZE, MAX_SIZE);
+    AntiCacheBlockWriter* writer = new AntiCacheBlockWriter(4);
+
+    string tableName("FAKE");
+    string payload("Squirrels and Girls!");
+    uint32_t blockIds[20];
+    for (int i = 0; i < 20; i++) {
+        blockIds[i] = anticache->nextBlockId();
+        writer->enqueue(anticache, tableName, blockIds[i], 1,
+                        blockData(payload), static_cast<long>(payload.size()) + 1);
+        ASSERT_TRUE(writer->getPendingBlocks() <= 4);
+    }
+
+    // a block can be read as soon as it has been waited for
+    writer->waitForBlock(anticache, blockIds[19]);
+    writer->lockDBs();
+    ASSERT_TRUE(anticache->validateBlock(blockIds[19]));
+    AntiCacheBlock* block = anticache->readBlock(blockIds[19], 0);
+    ASSERT_EQ(block->getTableName(), tableName);
+    ASSERT_EQ(0, payload.compare(block->getData()));
+    delete block;
+    writer->unlockDBs();
+
+    writer->drain();
+    ASSERT_EQ(0, writer->getPendingBlocks());
+    for (int i = 0; i < 19; i++) {
+        ASSERT_TRUE(anticache->validateBlock(blockIds[i]));
+    }
+    ASSERT_EQ(anticache->getNumBlocks(), 19);
+
+    delete writer;
+    delete anticache;
+}
+
+TEST_F(AntiCacheBlockWriterTest, StallsWhenFull) {
+    ChTempDir tempdir;
+    AntiCacheDB* anticache = new BerkeleyAntiCacheDB(NULL, ".", BLOCK_SIZE, MAX_SIZE);
+    AntiCacheBlockWriter* writer = new AntiCacheBlockWriter(1);
+
+    // the worker cannot write while the DB lock is held, so the queue fills up
+    writer->lockDBs();
+    uint32_t first = anticache->nextBlockId();
+    writer->enqueue(anticache, "FAKE", first, 1, blockData("First"), 6);
+    ASSERT_EQ(1, writer->getPendingBlocks());
+    ASSERT_EQ(0, writer->getStalls());
+
+    EnqueueArgs args;
+    args.writer = writer;
+    args.anticache = anticache;
+    args.blockId = anticache->nextBlockId();
+    pthread_t thread;
+    ASSERT_EQ(0, pthread_create(&thread, NULL, enqueueBlock, &args));
+    for (int i = 0; i < 1000 && writer->getStalls() == 0; i++) {
+        usleep(1000);
+    }
+    ASSERT_EQ(1, writer->getStalls());
+    ASSERT_EQ(1, writer->getPendingBlocks());
+
+    writer->unlockDBs();
+    pthread_join(thread, NULL);
+    writer->drain();
+    ASSERT_TRUE(anticache->validateBlock(first));
+    ASSERT_TRUE(anticache->validateBlock(args.blockId));
+
+    delete writer;
+    delete anticache;
+}
+
+TEST_F(AntiCacheBlockWriterTest, ReportsFailedWrites) {
+    ChTempDir tempdir;
+    AntiCacheDB* anticache = new NVMAntiCacheDB(NULL, ".", BLOCK_SIZE, BLOCK_SIZE*2);
+    AntiCacheBlockWriter* writer = new AntiCacheBlockWriter(4);
+
+    // the third block does not fit, which surfaces on the execution thread
+    for (int i = 0; i < 3; i++) {
+        writer->enqueue(anticache, "FAKE", anticache->nextBlockId(), 1, blockData("Full"), 5);
+    }
+    bool failed = false;
+    try {
+        writer->drain();
+    } catch (FullBackingStoreException &e) {
+        failed = true;
+    }
+    ASSERT_TRUE(failed);
+    ASSERT_EQ(anticache->getNumBlocks(), 2);
+
+    // the block is kept, and fails again until there is room for it
+    ASSERT_EQ(1, writer->getPendingBlocks());
+    failed = false;
+    try {
+        writer->drain();
+    } catch (FullBackingStoreException &e) {
+        failed = true;
+    }
+    ASSERT_TRUE(failed);
+    ASSERT_EQ(1, writer->getPendingBlocks());
+
+    delete writer;
+    delete anticache;
+}
+
+TEST_F(AntiCacheBlockWriterTest, RetriesFailedWrites) {
+    ChTempDir tempdir;
+    AntiCacheDB* anticache = new FlakyAntiCacheDB(1, 2, 0);
+    AntiCacheBlockWriter* writer = new AntiCacheBlockWriter(4);
+
+    // the first block fails on the worker, and once more on the execution thread
+    uint32_t blockIds[3] = { 1, 2, 3 };
+    writer->lockDBs();
+    for (int i = 0; i < 3; i++) {
+        writer->enqueue(anticache, "FAKE", blockIds[i], 1, blockData("Retried"), 8);
+    }
+    writer->unlockDBs();
+    bool failed = false;
+    try {
+        writer->drain();
+    } catch (FullBackingStoreException &e) {
+        failed = true;
+    }
+    ASSERT_TRUE(failed);
+    ASSERT_EQ(1, writer->getPendingBlocks());
+    ASSERT_EQ(anticache->getNumBlocks(), 2);
+
+    // the next try writes it
+    writer->drain();
+    ASSERT_EQ(0, writer->getPendingBlocks());
+    for (int i = 0; i < 3; i++) {
+        ASSERT_TRUE(anticache->validateBlock(blockIds[i]));
+    }
+
+    delete writer;
+    delete anticache;
+}
+
+TEST_F(AntiCacheBlockWriterTest, ReportsFailedFlushes) {
+    ChTempDir tempdir;
+    AntiCacheDB* anticache = new FlakyAntiCacheDB(0, 0, 2);
+    AntiCacheBlockWriter* writer = new AntiCacheBlockWriter(4);
+
+    // the block is written, the flush after it fails on the worker and again
+    // on the execution thread
+    uint32_t blockId = anticache->nextBlockId();
+    writer->lockDBs();
+    writer->enqueue(anticache, "FAKE", blockId, 1, blockData("Flushed"), 8);
+    writer->unlockDBs();
+    bool failed = false;
+    try {
+        writer->drain();
+    } catch (FullBackingStoreException &e) {
+        failed = true;
+    }
+    ASSERT_TRUE(failed);
+    ASSERT_TRUE(anticache->validateBlock(blockId));
+
+    // the flush is tried again on the next call
+    writer->drain();
+
+    delete writer;
+    delete anticache;
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
@@ -0,0 +1,191 @@
+/* Copyright (C) 2014 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include "harness.h"
+#include "common/FatalException.hpp"
+#include "anticache/AntiCacheDB.h"
+#include "anticache/AntiCacheCodec.h"
+#include "anticache/BerkeleyAntiCacheDB.h"
+#include "anticache/NVMAntiCacheDB.h"
+
+using namespace std;
+using namespace voltdb;
+using stupidunit::ChTempDir;
+
+#define BLOCK_SIZE 524288
+#define MAX_SIZE 1024000000
+
+/**
+ * AntiCacheCodec Tests
+ */
+class AntiCacheCodecTest : public Test {
+public:
+    AntiCacheCodecTest() {
+
+    };
+
+    // serialized tuples of a table with a key, a few small integers and a name
+    static string tupleData(int numTuples, int firstKey) {
+        string data;
+        char tuple[64];
+        for (int i = 0; i < numTuples; i++) {
+            int key = firstKey + i;
+            memset(tuple, 0, sizeof(tuple));
+            snprintf(tuple, sizeof(tuple), "%08d|%d|%d|CUSTOMER_NAME_%d|BRONZE", key, key % 10, key % 7, key % 100);
+            data.append(tuple, sizeof(tuple));
+        }
+        return data;
+    }
+
+    static string randomData(long size) {
+        string data;
+        for (long i = 0; i < size; i++) {
+            data.push_back(static_cast<char>(rand() & 0xff));
+        }
+        return data;
+    }
+
+    static bool roundTrip(const string &data, const string &dict, long *compressedSize) {
+        char *dst = new char[AntiCacheCodec::maxCompressedSize(static_cast<long>(data.size()))];
+        long size = AntiCacheCodec::compress(data.data(), static_cast<long>(data.size()), dst,
+                                             dict.data(), static_cast<long>(dict.size()));
+        char *raw = new char[data.size() + 1];
+        bool valid = AntiCacheCodec::decompress(dst, size, raw, static_cast<long>(data.size()),
+                                                dict.data(), static_cast<long>(dict.size()));
+        valid = valid && memcmp(raw, data.data(), data.size()) == 0;
+        *compressedSize = size;
+        delete [] raw;
+        delete [] dst;
+        return valid;
+    }
+};
+
+TEST_F(AntiCacheCodecTest, RoundTrip) {
+    long size;
+    srand(7);
+
+    string tuples = tupleData(4096, 0);
+    ASSERT_TRUE(roundTrip(tuples, "", &size));
+    ASSERT_TRUE(size * 3 < static_cast<long>(tuples.size()));
+
+    string random = randomData(65536);
+    ASSERT_TRUE(roundTrip(random, "", &size));
+    ASSERT_TRUE(size <= AntiCacheCodec::maxCompressedSize(65536));
+
+    ASSERT_TRUE(roundTrip("", "", &size));
+    ASSERT_TRUE(roundTrip("abc", "", &size));
+    ASSERT_TRUE(roundTrip(string(100000, 'x'), "", &size));
+    ASSERT_TRUE(size < 1000);
+}
+
+TEST_F(AntiCacheCodecTest, Dictionary) {
+    long plainSize, dictSize;
+
+    // a small block of a table compresses better with the dictionary of its first block
+    string dict = AntiCacheCodec::trainDictionary(tupleData(2048, 0).data(), 2048 * 64);
+    ASSERT_TRUE(static_cast<long>(dict.size()) <= AntiCacheCodec::MAX_DICTIONARY_SIZE);
+    string tuples = tupleData(16, 100000);
+    ASSERT_TRUE(roundTrip(tuples, "", &plainSize));
+    ASSERT_TRUE(roundTrip(tuples, dict, &dictSize));
+    ASSERT_TRUE(dictSize < plainSize);
+}
+
+TEST_F(AntiCacheCodecTest, RejectsCorruptData) {
+    string tuples = tupleData(256, 0);
+    long rawSize = static_cast<long>(tuples.size());
+    char *dst = new char[AntiCacheCodec::maxCompressedSize(rawSize)];
+    long size = AntiCacheCodec::compress(tuples.data(), rawSize, dst, NULL, 0);
+    char *raw = new char[rawSize];
+
+    ASSERT_FALSE(AntiCacheCodec::decompress(dst, size / 2, raw, rawSize, NULL, 0));
+    ASSERT_FALSE(AntiCacheCodec::decompress(dst, size, raw, rawSize - 1, NULL, 0));
+    // offsets that point before the output without a dictionary
+    for (long i = 0; i < size; i++) {
+        dst[i] = static_cast<char>(0xff);
+    }
+    ASSERT_FALSE(AntiCacheCodec::decompress(dst, size, raw, rawSize, NULL, 0));
+
+    delete [] raw;
+    delete [] dst;
+}
+
+TEST_F(AntiCacheCodecTest, WritesCompressedBlocks) {
+    ChTempDir tempdir;
+    AntiCacheDB* anticache = new BerkeleyAntiCacheDB(NULL, ".", BLOCK_SIZE, MAX_SIZE);
+    anticache->setCodec(ANTICACHE_CODEC_LZ_DICT);
+
+    string tableName("FAKE");
+    string tuples = tupleData(2048, 0);
+    string random = randomData(4096);
+    uint32_t tuplesId = anticache->nextBlockId();
+    anticache->writeBlock(tableName, tuplesId, 2048, tuples.data(), static_cast<long>(tuples.size()), 2048);
+    uint32_t randomId = anticache->nextBlockId();
+    anticache->writeBlock(tableName, randomId, 64, random.data(), static_cast<long>(random.size()), 64);
+
+    ASSERT_EQ(anticache->getCodecRawBytes(), static_cast<int64_t>(tuples.size() + random.size()));
+    ASSERT_TRUE(anticache->getCodecStoredBytes() * 2 < anticache->getCodecRawBytes());
+
+    AntiCacheBlock* block = anticache->readBlock(tuplesId, 1);
+    ASSERT_EQ(block->getTableName(), tableName);
+    ASSERT_EQ(block->getSize(), static_cast<long>(tuples.size()));
+    ASSERT_EQ(0, memcmp(block->getData(), tuples.data(), tuples.size()));
+    delete block;
+
+    // incompressible blocks are stored as they are
+    block = anticache->readBlock(randomId, 1);
+    ASSERT_EQ(block->getSize(), static_cast<long>(random.size()));
+    ASSERT_EQ(0, memcmp(block->getData(), random.data(), random.size()));
+    delete block;
+
+    delete anticache;
+}
+
+TEST_F(AntiCacheCodecTest, WritesCompressedNVMBlocks) {
+    ChTempDir tempdir;
+    AntiCacheDB* anticache = new NVMAntiCacheDB(NULL, ".", BLOCK_SIZE, MAX_SIZE);
+    anticache->setCodec(ANTICACHE_CODEC_LZ);
+
+    string tableName("FAKE");
+    string tuples = tupleData(1024, 0);
+    uint32_t blockId = anticache->nextBlockId();
+    anticache->writeBlock(tableName, blockId, 1024, tuples.data(), static_cast<long>(tuples.size()), 1024);
+    ASSERT_TRUE(anticache->getCodecStoredBytes() * 2 < anticache->getCodecRawBytes());
+
+    AntiCacheBlock* block = anticache->readBlock(blockId, 1);
+    ASSERT_EQ(block->getTableName(), tableName);
+    ASSERT_EQ(block->getSize(), static_cast<long>(tuples.size()));
+    ASSERT_EQ(0, memcmp(block->getData(), tuples.data(), tuples.size()));
+    delete block;
+
+    delete anticache;
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
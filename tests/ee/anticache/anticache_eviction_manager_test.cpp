@@ -46,6 +46,7 @@
 #include "boost/scoped_ptr.hpp"
 
 #include "anticache/AntiCacheDB.h"
+#include "anticache/AntiCacheBlockWriter.h"
 
 #define BLOCK_SIZE 1024000
 #define MAX_SIZE 1024000000
@@ -107,7 +108,6 @@ public:
     ~AntiCacheEvictionManagerTest() {
         delete m_engine;
         //delete m_table;
-        voltdb::TupleSchema::freeTupleSchema(m_primaryKeyIndexSchema);
     }
     
     
@@ -137,8 +137,12 @@ public:
 //                                                                        m_primaryKeyIndexColumns,
 //                                                                        m_primaryKeyIndexSchemaTypes,
 //                                                                        true, false, m_tableSchema);
+        // every index frees its own key schema when the table is deleted
         primaryKeyIndexScheme.keySchema = m_primaryKeyIndexSchema;
-        secondaryIndexScheme.keySchema = m_primaryKeyIndexSchema;
+        secondaryIndexScheme.keySchema = voltdb::TupleSchema::createTupleSchema(m_primaryKeyIndexSchemaTypes,
+                                                                                m_primaryKeyIndexSchemaColumnSizes,
+                                                                                m_primaryKeyIndexSchemaAllowNull,
+                                                                                allowInlineStrings);
         std::vector<voltdb::TableIndexScheme> indexes;
         indexes.push_back(primaryKeyIndexScheme);
         indexes.push_back(secondaryIndexScheme);
@@ -306,7 +310,8 @@ TEST_F(AntiCacheEvictionManagerTest, FullBackingStore) {
     acem->addAntiCacheDB(berkeleydb);
 
     string tableName("TEST");
-    string payload("Test payload");
+    // the blocks are written with BLOCK_SIZE bytes of payload
+    string payload(BLOCK_SIZE, 'p');
 
 
     acdb = acem->getAntiCacheDB(acem->chooseDB(BLOCK_SIZE));
@@ -345,9 +350,221 @@ TEST_F(AntiCacheEvictionManagerTest, FullBackingStore) {
 }
 
 
+/**
+ * A table with 70 BIGINT columns, the primary key on the last one and, if
+ * wideIndex is set, an index on the first 66 columns (528 bytes). Keys
+ * that wide keep a pointer to the tuple (see PrefixTupleKey).
+ */
+static PersistentTable* createWideTable(VoltDBEngine *engine, string name, bool wideIndex) {
+    const int num_of_columns = 70;
+    const int indexWidth = 66;
+    string columnNames[num_of_columns];
+    char buffer[32];
+    for (int ctr = 0; ctr < num_of_columns; ctr++) {
+        snprintf(buffer, 32, "column%02d", ctr);
+        columnNames[ctr] = buffer;
+    }
+    vector<ValueType> columnTypes(num_of_columns, VALUE_TYPE_BIGINT);
+    vector<int32_t> columnLengths(num_of_columns, NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+    vector<bool> columnAllowNull(num_of_columns, false);
+    TupleSchema *schema = TupleSchema::createTupleSchema(columnTypes, columnLengths, columnAllowNull, true);
+
+    vector<int> pkeyColumns(1, num_of_columns - 1);
+    vector<ValueType> pkeyTypes(1, VALUE_TYPE_BIGINT);
+    TableIndexScheme pkey("pkey", BALANCED_TREE_INDEX, pkeyColumns, pkeyTypes, true, true, schema);
+    vector<TableIndexScheme> indexes;
+    if (wideIndex) {
+        vector<int> wideColumns;
+        for (int i = 0; i < indexWidth; i++) {
+            wideColumns.push_back(i);
+        }
+        vector<ValueType> wideTypes(indexWidth, VALUE_TYPE_BIGINT);
+        indexes.push_back(TableIndexScheme("wide", BALANCED_TREE_INDEX, wideColumns, wideTypes,
+                                           false, true, schema));
+    }
+    PersistentTable *table = dynamic_cast<PersistentTable*>(
+        TableFactory::getPersistentTable(0, engine->getExecutorContext(), name, schema,
+                                         columnNames, pkey, indexes, -1, false, false));
+
+    string evictedColumnNames[2] = { "BLOCK_ID", "TUPLE_OFFSET" };
+    table->setEvictedTable(TableFactory::getEvictedTable(0, engine->getExecutorContext(),
+                                                         name + "_EVICTED",
+                                                         TupleSchema::createEvictedTupleSchema(),
+                                                         &evictedColumnNames[0]));
+
+    TableTuple &tuple = table->tempTuple();
+    for (int64_t row = 0; row < 1000; row++) {
+        for (int i = 0; i < num_of_columns - 1; i++) {
+            tuple.setNValue(i, ValueFactory::getBigIntValue(row % 10));
+        }
+        tuple.setNValue(num_of_columns - 1, ValueFactory::getBigIntValue(row));
+        table->insertTuple(tuple);
+    }
+    return table;
+}
+
+/**
+ * Evicting a tuple frees its storage while the index entries are moved to
+ * the evicted tuple, an index key that reads the tuple would read freed
+ * memory. Tables with such an index are not evicted.
+ */
+TEST_F(AntiCacheEvictionManagerTest, EvictWideKeyTable) {
+    ChTempDir tempdir;
+    m_engine->antiCacheInitialize(tempdir.name(), ANTICACHEDB_NVM, false, BLOCK_SIZE, MAX_SIZE, true);
+    AntiCacheEvictionManager *acem = m_engine->getExecutorContext()->getAntiCacheEvictionManager();
+
+    // the same table without the wide index gets evicted
+    PersistentTable *narrow = createWideTable(m_engine, "NARROW", false);
+    acem->evictBlock(narrow, 64 * 1024, 1);
+    ASSERT_TRUE(narrow->getTuplesEvicted() > 0);
+    ASSERT_EQ(1000 - narrow->getTuplesEvicted(), narrow->activeTupleCount());
+
+    PersistentTable *wide = createWideTable(m_engine, "WIDE", true);
+    TableIndex *index = wide->index("wide");
+    ASSERT_TRUE(index->keysReferenceTuples());
+    Table *result = acem->evictBlock(wide, 64 * 1024, 1);
+    ASSERT_EQ(1, result->activeTupleCount());
+    ASSERT_EQ(0, wide->getTuplesEvicted());
+    ASSERT_EQ(0, wide->getBlocksEvicted());
+    ASSERT_EQ(1000, wide->activeTupleCount());
+
+    // every key of the wide index still finds its 100 tuples
+    const TupleSchema *keySchema = index->getKeySchema();
+    TableTuple searchkey(keySchema);
+    searchkey.move(new char[searchkey.tupleLength()]);
+    for (int64_t key = 0; key < 10; key++) {
+        for (int i = 0; i < keySchema->columnCount(); i++) {
+            searchkey.setNValue(i, ValueFactory::getBigIntValue(key));
+        }
+        ASSERT_TRUE(index->moveToKey(&searchkey));
+        int count = 0;
+        TableTuple tuple(wide->schema());
+        while (!(tuple = index->nextValueAtKey()).isNullTuple()) {
+            ASSERT_FALSE(tuple.isEvicted());
+            ASSERT_EQ(key, ValuePeeker::peekBigInt(tuple.getNValue(69)) % 10);
+            ++count;
+        }
+        ASSERT_EQ(100, count);
+    }
+    delete[] searchkey.address();
+
+    delete wide->getEvictedTable();
+    delete wide;
+    delete narrow->getEvictedTable();
+    delete narrow;
+}
+
+TEST_F(AntiCacheEvictionManagerTest, AsyncEvictionWritesItsBlocks) {
+    ChTempDir tempdir;
+    m_engine->antiCacheInitialize(tempdir.name(), ANTICACHEDB_NVM, false, BLOCK_SIZE, MAX_SIZE, true);
+    m_engine->antiCacheAsyncEvictionInitialize(4);
+    AntiCacheEvictionManager *acem = m_engine->getExecutorContext()->getAntiCacheEvictionManager();
+    AntiCacheBlockWriter *writer = acem->getBlockWriter();
+    ASSERT_TRUE(writer != NULL);
+
+    // the tuples are gone once the eviction returns, so are its blocks
+    PersistentTable *table = createWideTable(m_engine, "ASYNC", false);
+    acem->evictBlock(table, 64 * 1024, 3);
+    ASSERT_EQ(3, table->getBlocksEvicted());
+    ASSERT_EQ(0, writer->getPendingBlocks());
+    ASSERT_EQ(3, acem->getAntiCacheDB(0)->getNumBlocks());
+
+    delete table->getEvictedTable();
+    delete table;
+}
+
  
 
-#ifndef ANTICACHE_TIMESTAMPS
+#if defined(ANTICACHE_CLOCK)
+    #define EVICTION_POLICY "CLOCK"
+#elif defined(ANTICACHE_TIMESTAMPS)
+    #define EVICTION_POLICY "timestamps"
+#elif defined(ANTICACHE_REVERSIBLE_LRU)
+    #define EVICTION_POLICY "double-linked LRU"
+#else
+    #define EVICTION_POLICY "single-linked LRU"
+#endif
+
+/**
+ * Compares the eviction policies that the EE can be built with: the time it
+ * takes to track random reads of the table, and to pick the tuples of an
+ * eviction afterwards.
+ */
+TEST_F(AntiCacheEvictionManagerTest, AccessTrackingPerformance)
+{
+    int num_tuples = 50000;
+    int num_accesses = 500000;
+    int num_victims = 5000;
+
+    struct timeval start, end;
+
+    long  seconds, useconds;
+    double mtime; 
+
+    initTable(true); 
+
+    TableTuple tuple = m_table->tempTuple();
+
+    for(int i = 0; i < num_tuples; i++) // insert tuples
+    {
+        tuple.setNValue(0, ValueFactory::getIntegerValue(m_tuplesInserted++));
+        tuple.setNValue(1, ValueFactory::getIntegerValue(rand()));
+        m_table->insertTuple(tuple);
+    }
+
+    std::vector<char*> addresses;
+    TableIterator itr1(m_table);
+    while(itr1.hasNext())
+    {
+        itr1.next(tuple);
+        addresses.push_back(tuple.address());
+    }
+    ASSERT_EQ(num_tuples, (int)addresses.size());
+
+    // the executors call updateTuple() for every tuple they read
+    AntiCacheEvictionManager* eviction_manager = m_engine->getExecutorContext()->getAntiCacheEvictionManager();
+    srand(0);
+    gettimeofday(&start, NULL);
+    for(int i = 0; i < num_accesses; i++)
+    {
+        tuple.move(addresses[rand() % num_tuples]);
+        eviction_manager->updateTuple(m_table, &tuple, false);
+    }
+    gettimeofday(&end, NULL);
+
+    seconds  = end.tv_sec  - start.tv_sec;
+    useconds = end.tv_usec - start.tv_usec;
+    mtime = (double)seconds * 1000 + (double)useconds / 1000;
+
+    VOLT_INFO("%s: total time for %d tuple accesses: %f milliseconds", EVICTION_POLICY, num_accesses, mtime);
+
+    int picked = 0;
+    gettimeofday(&start, NULL);
+    {
+        EvictionIterator itr2(m_table);
+#if defined(ANTICACHE_TIMESTAMPS) || defined(ANTICACHE_CLOCK)
+        int tuple_size = m_tableSchema->tupleLength() + TUPLE_HEADER_SIZE;
+        itr2.reserve((int64_t)num_victims * tuple_size);
+#endif
+        while(picked < num_victims && itr2.hasNext())
+        {
+            itr2.next(tuple);
+            ++picked;
+        }
+    }
+    gettimeofday(&end, NULL);
+    ASSERT_EQ(num_victims, picked);
+
+    seconds  = end.tv_sec  - start.tv_sec;
+    useconds = end.tv_usec - start.tv_usec;
+    mtime = (double)seconds * 1000 + (double)useconds / 1000;
+
+    VOLT_INFO("%s: total time to pick %d tuples to evict: %f milliseconds", EVICTION_POLICY, num_victims, mtime);
+
+    cleanupTable();
+}
+
+#if !defined(ANTICACHE_TIMESTAMPS) && !defined(ANTICACHE_CLOCK)
 TEST_F(AntiCacheEvictionManagerTest, GetTupleID)
 {
     initTable(true); 
@@ -570,7 +787,7 @@ TEST_F(AntiCacheEvictionManagerTest, DeleteMultipleTuples)
 //     ASSERT_EQ(oldest_tuple_id, m_table->getNewestTupleID()); 
 //   
 // }
-#else
+#elif defined(ANTICACHE_TIMESTAMPS)
 TEST_F(AntiCacheEvictionManagerTest, GetTupleTimeStamp)
 {
     initTable(true); 
@@ -627,7 +844,97 @@ TEST_F(AntiCacheEvictionManagerTest, TestEvictionOrder)
     cleanupTable();
 }
 
+#else
+TEST_F(AntiCacheEvictionManagerTest, GetTupleReferenceBit)
+{
+    initTable(true); 
+    
+    TableTuple tuple = m_table->tempTuple();
+    int tuple_size = m_tableSchema->tupleLength() + TUPLE_HEADER_SIZE;
+    
+    tuple.setNValue(0, ValueFactory::getIntegerValue(m_tuplesInserted++));
+    tuple.setNValue(1, ValueFactory::getIntegerValue(rand()));
+    m_table->insertTuple(tuple);
+    
+    // get the tuple that was just inserted
+    tuple = m_table->lookupTuple(tuple); 
+    ASSERT_TRUE(tuple.isReferenced());
+
+    // the sweep clears the bit, and takes the tuple on its second chance
+    EvictionIterator itr(m_table); 
+    itr.reserve(tuple_size);
+    ASSERT_TRUE(itr.hasNext());
+    ASSERT_FALSE(tuple.isReferenced());
+
+    AntiCacheEvictionManager* eviction_manager = m_engine->getExecutorContext()->getAntiCacheEvictionManager();
+    eviction_manager->updateTuple(m_table, &tuple, false);
+    ASSERT_TRUE(tuple.isReferenced());
+    
+    cleanupTable(); 
+}
+
+TEST_F(AntiCacheEvictionManagerTest, TestEvictionOrder)
+{
+    int num_tuples = 100; 
+
+    initTable(true); 
+      
+    TableTuple tuple = m_table->tempTuple();
+    int tuple_size = m_tableSchema->tupleLength() + TUPLE_HEADER_SIZE;
+        
+    for(int i = 0; i < num_tuples; i++) // insert 100 tuples
+    {
+        tuple.setNValue(0, ValueFactory::getIntegerValue(m_tuplesInserted++));
+        tuple.setNValue(1, ValueFactory::getIntegerValue(rand()));
+        m_table->insertTuple(tuple);
+    }
+
+    // every tuple was just inserted, so a whole revolution only clears
+    // the reference bits and the first tuples are taken in slot order
+    {
+        EvictionIterator itr(m_table);
+        itr.reserve(20 * tuple_size);
+        for (int i = 0; i < 20; i++) {
+            ASSERT_TRUE(itr.hasNext());
+            itr.next(tuple);
+            ASSERT_EQ(i, m_table->getTupleID(tuple.address()));
+        }
+        ASSERT_FALSE(itr.hasNext());
+    }
+
+    // the tuples accessed since are passed over
+    AntiCacheEvictionManager* eviction_manager = m_engine->getExecutorContext()->getAntiCacheEvictionManager();
+    TableIterator itr1(m_table);
+    while(itr1.hasNext()) {
+        itr1.next(tuple);
+        if (m_table->getTupleID(tuple.address()) < 10)
+            eviction_manager->updateTuple(m_table, &tuple, false);
+    }
+    {
+        EvictionIterator itr(m_table);
+        itr.reserve(20 * tuple_size);
+        for (int i = 10; i < 30; i++) {
+            ASSERT_TRUE(itr.hasNext());
+            itr.next(tuple);
+            ASSERT_EQ(i, m_table->getTupleID(tuple.address()));
+        }
+        ASSERT_FALSE(itr.hasNext());
+    }
+
+    // and the next sweep goes on from where the hand stopped
+    {
+        EvictionIterator itr(m_table);
+        itr.reserve(20 * tuple_size);
+        ASSERT_TRUE(itr.hasNext());
+        itr.next(tuple);
+        ASSERT_EQ(30, m_table->getTupleID(tuple.address()));
+    }
+
+    cleanupTable();
+}
+
 #endif
+
 TEST_F(AntiCacheEvictionManagerTest, TestSetEntryToNewAddress)
 {
     int num_tuples = 20;
@@ -0,0 +1,202 @@
+/* Copyright (C) 2014 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <string>
+#include <cstring>
+#include <vector>
+#include "harness.h"
+#include "anticache/AntiCacheDB.h"
+#include "anticache/AntiCacheBlockReader.h"
+#include "anticache/LogAntiCacheDB.h"
+#include "anticache/UnknownBlockAccessException.h"
+#include "anticache/FullBackingStoreException.h"
+
+using namespace std;
+using namespace voltdb;
+using stupidunit::ChTempDir;
+
+#define BLOCK_SIZE 65536
+#define MAX_SIZE (BLOCK_SIZE * 64)
+
+/**
+ * LogAntiCacheDB Tests
+ */
+class LogAntiCacheDBTest : public Test {
+public:
+    LogAntiCacheDBTest() {
+
+    };
+
+    static string payload(uint32_t blockId, int length) {
+        string data;
+        while ((int)data.size() < length) {
+            data.append("Block ");
+            data.push_back(static_cast<char>('A' + blockId % 26));
+        }
+        data.resize(length);
+        return data;
+    }
+
+    static uint32_t writeBlock(AntiCacheDB *anticache, int length) {
+        uint32_t blockId = anticache->nextBlockId();
+        string data = payload(blockId, length);
+        anticache->writeBlock("FAKE", blockId, 1, data.c_str(), static_cast<long>(data.size()) + 1, 1);
+        return blockId;
+    }
+
+    void checkBlock(AntiCacheDB *anticache, uint32_t blockId, int length) {
+        AntiCacheBlock* block = anticache->readBlock(blockId, 1);
+        ASSERT_EQ(block->getTableName(), string("FAKE"));
+        ASSERT_EQ(block->getSize(), length + 1);
+        ASSERT_EQ(0, payload(blockId, length).compare(block->getData()));
+        ASSERT_FALSE(anticache->validateBlock(blockId));
+        delete block;
+    }
+};
+
+TEST_F(LogAntiCacheDBTest, WriteAndRead) {
+    ChTempDir tempdir;
+    LogAntiCacheDB* anticache = new LogAntiCacheDB(NULL, ".", BLOCK_SIZE, MAX_SIZE);
+
+    // the first block is still in the write buffer when it is read back
+    uint32_t buffered = writeBlock(anticache, 1000);
+    uint32_t flushed = writeBlock(anticache, BLOCK_SIZE - 1);
+    ASSERT_TRUE(anticache->validateBlock(buffered));
+    checkBlock(anticache, buffered, 1000);
+
+    anticache->flushBlocks();
+    checkBlock(anticache, flushed, BLOCK_SIZE - 1);
+    ASSERT_EQ(anticache->getNumBlocks(), 0);
+
+    // records are padded to the alignment of the log
+    ASSERT_EQ(0, anticache->getLogBytes() % LogAntiCacheDB::LOG_ALIGNMENT);
+
+    bool caught = false;
+    try {
+        anticache->readBlock(flushed, 1);
+    } catch (UnknownBlockAccessException &e) {
+        caught = true;
+    }
+    ASSERT_TRUE(caught);
+
+    delete anticache;
+}
+
+TEST_F(LogAntiCacheDBTest, CompactsDeadSegments) {
+    ChTempDir tempdir;
+    LogAntiCacheDB* anticache = new LogAntiCacheDB(NULL, ".", BLOCK_SIZE, MAX_SIZE);
+
+    vector<uint32_t> blockIds;
+    for (int i = 0; i < 40; i++) {
+        blockIds.push_back(writeBlock(anticache, BLOCK_SIZE / 2));
+    }
+    anticache->flushBlocks();
+    int segments = anticache->getNumSegments();
+    ASSERT_TRUE(segments > 2);
+    int64_t logBytes = anticache->getLogBytes();
+
+    // unevicting all but every fourth block leaves the segments mostly dead
+    for (size_t i = 0; i < blockIds.size(); i++) {
+        if (i % 4 != 0) {
+            checkBlock(anticache, blockIds[i], BLOCK_SIZE / 2);
+        }
+    }
+    anticache->compactSegments();
+    ASSERT_TRUE(anticache->getNumSegments() < segments);
+    ASSERT_TRUE(anticache->getLogBytes() < logBytes);
+    ASSERT_TRUE(anticache->getSegmentsCompacted() > 0);
+    ASSERT_TRUE(anticache->getBytesCompacted() > 0);
+
+    // the blocks that were moved are still there
+    for (size_t i = 0; i < blockIds.size(); i += 4) {
+        ASSERT_TRUE(anticache->validateBlock(blockIds[i]));
+        checkBlock(anticache, blockIds[i], BLOCK_SIZE / 2);
+    }
+    ASSERT_EQ(anticache->getNumBlocks(), 0);
+
+    delete anticache;
+}
+
+TEST_F(LogAntiCacheDBTest, FullBackingStore) {
+    ChTempDir tempdir;
+    LogAntiCacheDB* anticache = new LogAntiCacheDB(NULL, ".", BLOCK_SIZE, MAX_SIZE);
+
+    vector<uint32_t> blockIds;
+    bool full = false;
+    for (int i = 0; i < 128 && !full; i++) {
+        try {
+            blockIds.push_back(writeBlock(anticache, BLOCK_SIZE - 1));
+        } catch (FullBackingStoreException &e) {
+            full = true;
+        }
+    }
+    ASSERT_TRUE(full);
+    ASSERT_TRUE(anticache->getLogBytes() <= MAX_SIZE);
+
+    // once blocks are unevicted, compaction makes room for new ones
+    for (size_t i = 0; i < blockIds.size() / 2; i++) {
+        checkBlock(anticache, blockIds[i], BLOCK_SIZE - 1);
+    }
+    uint32_t blockId = writeBlock(anticache, BLOCK_SIZE - 1);
+    checkBlock(anticache, blockId, BLOCK_SIZE - 1);
+
+    delete anticache;
+}
+
+TEST_F(LogAntiCacheDBTest, FetchesCompressedBatch) {
+    ChTempDir tempdir;
+    LogAntiCacheDB* anticache = new LogAntiCacheDB(NULL, ".", BLOCK_SIZE, MAX_SIZE);
+    anticache->setCodec(ANTICACHE_CODEC_LZ);
+    AntiCacheBlockReader* reader = new AntiCacheBlockReader(4);
+
+    vector<AntiCacheBlockReader::Request> requests;
+    for (int i = 0; i < 16; i++) {
+        AntiCacheBlockReader::Request request;
+        request.antiCacheDB = anticache;
+        request.blockId = writeBlock(anticache, BLOCK_SIZE / 4);
+        request.block = NULL;
+        request.storedSize = 0;
+        requests.push_back(request);
+        if (i == 7) {
+            anticache->flushBlocks();
+        }
+    }
+    reader->fetchBlocks(requests);
+    for (size_t i = 0; i < requests.size(); i++) {
+        ASSERT_TRUE(requests[i].block != NULL);
+        ASSERT_EQ(0, payload(requests[i].blockId, BLOCK_SIZE / 4).compare(requests[i].block->getData()));
+        // the payload is compressed in the log
+        ASSERT_TRUE(requests[i].storedSize < BLOCK_SIZE / 4);
+        anticache->unevictBlock(requests[i].blockId, requests[i].storedSize, 1);
+        delete requests[i].block;
+    }
+    ASSERT_EQ(anticache->getNumBlocks(), 0);
+
+    delete reader;
+    delete anticache;
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
@@ -0,0 +1,155 @@
+/* Copyright (C) 2014 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "harness.h"
+#include "common/BlockAllocator.h"
+#include "common/TupleSchema.h"
+#include "common/ValueFactory.hpp"
+#include "common/tabletuple.h"
+#include "storage/temptable.h"
+#include "storage/tablefactory.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+using voltdb::BlockAllocator;
+
+static const size_t BLOCK_BYTES = 2097152;
+
+class BlockAllocatorTest : public Test {
+public:
+    BlockAllocatorTest() {}
+};
+
+TEST_F(BlockAllocatorTest, ReleasedBlocksAreReused) {
+    BlockAllocator allocator;
+    allocator.configure(false, false, 2);
+
+    char *first = allocator.allocate(BLOCK_BYTES);
+    char *second = allocator.allocate(BLOCK_BYTES);
+    char *third = allocator.allocate(BLOCK_BYTES);
+    memset(first, 1, BLOCK_BYTES);
+    ASSERT_TRUE(first != second && second != third);
+
+    allocator.release(first, BLOCK_BYTES);
+    allocator.release(second, BLOCK_BYTES);
+    // past the cache limit, the block goes back to the system
+    allocator.release(third, BLOCK_BYTES);
+    EXPECT_EQ(2, allocator.cachedBlocks());
+
+    // a block of another size does not take a cached one
+    char *small = allocator.allocate(131072);
+    EXPECT_EQ(2, allocator.cachedBlocks());
+    EXPECT_EQ(0, allocator.cacheHits());
+
+    char *reused = allocator.allocate(BLOCK_BYTES);
+    EXPECT_TRUE(reused == first || reused == second);
+    EXPECT_EQ(1, allocator.cachedBlocks());
+    EXPECT_EQ(1, allocator.cacheHits());
+
+    allocator.release(reused, BLOCK_BYTES);
+    allocator.release(small, 131072);
+    allocator.trim();
+    EXPECT_EQ(0, allocator.cachedBlocks());
+}
+
+TEST_F(BlockAllocatorTest, HugePagesFallBack) {
+    // whether or not the machine has reserved huge pages, every block is
+    // usable, and the ones that are not from the pool are 2 MB aligned
+    BlockAllocator allocator;
+    allocator.configure(true, true, 0);
+    ASSERT_TRUE(allocator.hugePagesEnabled());
+
+    char *blocks[4];
+    for (int i = 0; i < 4; i++) {
+        blocks[i] = allocator.allocate(BLOCK_BYTES);
+        memset(blocks[i], i, BLOCK_BYTES);
+        EXPECT_EQ(0, (int)((uintptr_t)blocks[i] % BLOCK_BYTES));
+    }
+    EXPECT_TRUE(allocator.hugePageBlocks() >= 0 && allocator.hugePageBlocks() <= 4);
+    for (int i = 0; i < 4; i++) {
+        EXPECT_EQ(i, blocks[i][BLOCK_BYTES - 1]);
+        allocator.release(blocks[i], BLOCK_BYTES);
+    }
+    EXPECT_EQ(0, allocator.cachedBlocks());
+
+    // temp table blocks are smaller than a huge page and stay on small pages
+    char *small = allocator.allocate(131072);
+    memset(small, 7, 131072);
+    allocator.release(small, 131072);
+    EXPECT_EQ(0, allocator.cacheHits());
+}
+
+static voltdb::TempTable* createTempTable() {
+    std::vector<voltdb::ValueType> columnTypes(1, voltdb::VALUE_TYPE_BIGINT);
+    std::vector<int32_t> columnLengths(1, voltdb::NValue::getTupleStorageSize(voltdb::VALUE_TYPE_BIGINT));
+    std::vector<bool> columnAllowNull(1, false);
+    voltdb::TupleSchema *schema =
+        voltdb::TupleSchema::createTupleSchema(columnTypes, columnLengths, columnAllowNull, true);
+    std::string columnNames[1] = { "ID" };
+    return voltdb::TableFactory::getTempTable(0, "temp", schema, columnNames, NULL);
+}
+
+static bool fillTempTable(voltdb::TempTable *table, int count) {
+    voltdb::TableTuple &tuple = table->tempTuple();
+    for (int i = 0; i < count; i++) {
+        tuple.setNValue(0, voltdb::ValueFactory::getBigIntValue(i));
+        if (!table->insertTuple(tuple)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+TEST_F(BlockAllocatorTest, TempTableBlocks) {
+    BlockAllocator allocator;
+    allocator.configure(false, false, 8);
+
+    // without an allocator the blocks come from new[]
+    voltdb::TempTable *plain = createTempTable();
+    ASSERT_TRUE(fillTempTable(plain, 100000));
+    plain->deleteAllTuples(true);
+    EXPECT_EQ(0, allocator.cachedBlocks());
+    delete plain;
+
+    // an executor's output table releases its blocks to the partition
+    voltdb::TempTable *table = createTempTable();
+    table->setBlockAllocator(&allocator);
+    ASSERT_TRUE(fillTempTable(table, 100000));
+    ASSERT_EQ(100000, table->activeTupleCount());
+    table->deleteAllTuples(true);
+    EXPECT_TRUE(allocator.cachedBlocks() > 0);
+
+    // and takes them back when it fills up again
+    ASSERT_TRUE(fillTempTable(table, 100000));
+    EXPECT_TRUE(allocator.cacheHits() > 0);
+    delete table;
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
@@ -0,0 +1,120 @@
+/* Copyright (C) 2014 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "harness.h"
+#include "common/CompactingStringStorage.h"
+#include "common/ThreadLocalPool.h"
+#include "common/NValue.hpp"
+#include "common/ValueFactory.hpp"
+#include "common/ValuePeeker.hpp"
+
+#include <string>
+#include <vector>
+#include <sstream>
+
+using namespace voltdb;
+
+class CompactingStringStorageTest : public Test {
+public:
+    CompactingStringStorageTest() {}
+
+    static std::string makeString(int i) {
+        std::ostringstream out;
+        out << "string #" << i << " ";
+        // spread the strings over a few size classes
+        return out.str() + std::string((size_t)(i % 7) * 30, (char)('a' + i % 26));
+    }
+
+    static std::string stringOf(const NValue &value) {
+        return std::string(static_cast<const char*>(ValuePeeker::peekObjectValue(value)),
+                           (size_t)ValuePeeker::peekObjectLength(value));
+    }
+};
+
+TEST_F(CompactingStringStorageTest, FreedStringsAreFilledFromTheEnd) {
+    CompactingStringStorage storage;
+    std::vector<NValue> values;
+    {
+        ThreadLocalPool::Scope strings(&storage);
+        for (int i = 0; i < 5000; i++) {
+            values.push_back(ValueFactory::getStringValue(makeString(i)));
+        }
+    }
+    EXPECT_EQ(5000, (int)storage.getStringCount());
+    const size_t fullBytes = storage.getBytesAllocated();
+    EXPECT_TRUE(fullBytes > 0);
+
+    // outside of the scope strings come from the heap
+    ASSERT_TRUE(ThreadLocalPool::getStringPool() == NULL);
+    NValue heapString = ValueFactory::getStringValue("on the heap");
+    EXPECT_EQ(5000, (int)storage.getStringCount());
+    heapString.free();
+
+    // freeing moves other strings around, which must still read the same
+    for (int i = 0; i < 5000; i += 2) {
+        values[i].free();
+    }
+    EXPECT_EQ(2500, (int)storage.getStringCount());
+    for (int i = 1; i < 5000; i += 2) {
+        EXPECT_EQ(makeString(i), stringOf(values[i]));
+    }
+    EXPECT_TRUE(storage.getBytesAllocated() < fullBytes);
+
+    for (int i = 1; i < 5000; i += 2) {
+        values[i].free();
+    }
+    EXPECT_EQ(0, (int)storage.getStringCount());
+    // at most the one spare buffer of each size class is left
+    EXPECT_TRUE(storage.getBytesAllocated() < fullBytes / 2);
+}
+
+TEST_F(CompactingStringStorageTest, ScopesNest) {
+    CompactingStringStorage outer;
+    CompactingStringStorage inner;
+    {
+        ThreadLocalPool::Scope first(&outer);
+        {
+            ThreadLocalPool::Scope second(&inner);
+            ValueFactory::getStringValue("inner").free();
+            NValue value = ValueFactory::getStringValue("inner");
+            EXPECT_EQ(1, (int)inner.getStringCount());
+            value.free();
+            {
+                ThreadLocalPool::Scope heap(NULL);
+                ASSERT_TRUE(ThreadLocalPool::getStringPool() == NULL);
+            }
+        }
+        ASSERT_TRUE(ThreadLocalPool::getStringPool() == &outer);
+        NValue value = ValueFactory::getStringValue("outer");
+        EXPECT_EQ(1, (int)outer.getStringCount());
+        EXPECT_EQ(0, (int)inner.getStringCount());
+        value.free();
+    }
+    EXPECT_EQ(0, (int)outer.getStringCount());
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
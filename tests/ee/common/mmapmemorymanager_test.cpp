@@ -0,0 +1,215 @@
+/* Copyright (C) 2014 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "harness.h"
+#include "common/MMAPMemoryManager.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sstream>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <vector>
+#include <stdint.h>
+
+using voltdb::MMAPMemoryManager;
+
+static const size_t SEGMENT_BYTES = 1048576;
+static const size_t CHUNK_BYTES = 307200;
+
+class MMAPMemoryManagerTest : public Test {
+public:
+    MMAPMemoryManagerTest() {
+        std::ostringstream name;
+        name << "/tmp/mmapmemorymanager_test_" << getpid();
+        m_fileName = name.str();
+    }
+
+    ~MMAPMemoryManagerTest() {
+        unlink((m_fileName + ".nvm").c_str());
+    }
+
+protected:
+    // fills every chunk with its own byte
+    std::vector<char*> allocateChunks(MMAPMemoryManager &manager, int count) {
+        std::vector<char*> chunks;
+        for (int i = 0; i < count; i++) {
+            char *chunk = static_cast<char*>(manager.allocate(CHUNK_BYTES));
+            memset(chunk, i + 1, CHUNK_BYTES);
+            chunks.push_back(chunk);
+        }
+        return chunks;
+    }
+
+    bool chunksIntact(const std::vector<char*> &chunks) {
+        for (size_t i = 0; i < chunks.size(); i++) {
+            for (size_t j = 0; j < CHUNK_BYTES; j += 4096) {
+                if (chunks[i][j] != (char)(i + 1) || chunks[i][CHUNK_BYTES - 1] != (char)(i + 1)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    off_t fileSize() {
+        struct stat st;
+        if (stat((m_fileName + ".nvm").c_str(), &st) != 0) {
+            return -1;
+        }
+        return st.st_size;
+    }
+
+    std::string m_fileName;
+};
+
+TEST_F(MMAPMemoryManagerTest, GrowsBySegments) {
+    MMAPMemoryManager manager(SEGMENT_BYTES, "", false);
+    EXPECT_EQ(1, manager.getSegmentCount());
+
+    // three chunks fit in a segment, the fourth one starts the next
+    std::vector<char*> chunks = allocateChunks(manager, 10);
+    EXPECT_EQ(4, manager.getSegmentCount());
+    EXPECT_EQ(4 * SEGMENT_BYTES, manager.getMappedSize());
+    EXPECT_EQ(10 * CHUNK_BYTES, manager.getAllocatedSize());
+    EXPECT_TRUE(chunksIntact(chunks));
+
+    // a chunk larger than a segment gets a segment of its own
+    char *large = static_cast<char*>(manager.allocate(3 * SEGMENT_BYTES + 1));
+    memset(large, 7, 3 * SEGMENT_BYTES + 1);
+    EXPECT_EQ(5, manager.getSegmentCount());
+    EXPECT_TRUE(manager.getMappedSize() > 7 * SEGMENT_BYTES);
+    EXPECT_TRUE(chunksIntact(chunks));
+}
+
+TEST_F(MMAPMemoryManagerTest, ExtendsTheFile) {
+    std::vector<char*> chunks;
+    {
+        MMAPMemoryManager manager(SEGMENT_BYTES, m_fileName, true);
+        EXPECT_EQ((off_t)SEGMENT_BYTES, fileSize());
+
+        manager.setAccessPattern(voltdb::MMAP_ACCESS_RANDOM);
+        chunks = allocateChunks(manager, 7);
+        EXPECT_EQ(3, manager.getSegmentCount());
+        EXPECT_EQ((off_t)manager.getMappedSize(), fileSize());
+        EXPECT_TRUE(chunksIntact(chunks));
+        manager.sync();
+    }
+
+    // every chunk landed at its offset in the file: three per segment
+    int fd = open((m_fileName + ".nvm").c_str(), O_RDONLY);
+    ASSERT_TRUE(fd >= 0);
+    for (size_t i = 0; i < chunks.size(); i++) {
+        char value = 0;
+        off_t offset = (off_t)((i / 3) * SEGMENT_BYTES + (i % 3) * CHUNK_BYTES + CHUNK_BYTES - 1);
+        ASSERT_EQ(1, pread(fd, &value, 1, offset));
+        EXPECT_EQ((char)(i + 1), value);
+    }
+    close(fd);
+}
+
+TEST_F(MMAPMemoryManagerTest, SyncsInBackground) {
+    MMAPMemoryManager *manager = new MMAPMemoryManager(SEGMENT_BYTES, m_fileName, true);
+    std::vector<char*> chunks = allocateChunks(*manager, 5);
+
+    // requests queued behind one another collapse into a single sync
+    for (int i = 0; i < 100; i++) {
+        manager->syncInBackground();
+    }
+    manager->waitForSync();
+    chunks = allocateChunks(*manager, 2);
+    manager->syncInBackground();
+    manager->waitForSync();
+    EXPECT_TRUE(chunksIntact(chunks));
+
+    // a manager can go away with a sync still queued
+    manager->syncInBackground();
+    delete manager;
+
+    MMAPMemoryManager other(SEGMENT_BYTES, "", false);
+    other.async();
+    other.syncInBackground();
+    other.waitForSync();
+}
+
+TEST_F(MMAPMemoryManagerTest, ReopensTheFile) {
+    std::vector<size_t> offsets;
+    {
+        MMAPMemoryManager manager(SEGMENT_BYTES, m_fileName, true);
+        std::vector<char*> chunks = allocateChunks(manager, 7);
+        for (size_t i = 0; i < chunks.size(); i++) {
+            offsets.push_back(manager.fileOffsetOf(chunks[i]));
+            EXPECT_TRUE(offsets[i] != MMAPMemoryManager::npos);
+            EXPECT_EQ(chunks[i], manager.addressAt(offsets[i], CHUNK_BYTES));
+        }
+        EXPECT_EQ(MMAPMemoryManager::npos, manager.fileOffsetOf(&offsets));
+        manager.sync();
+    }
+
+    // the whole file is mapped back, and allocation goes on after the reopened bytes
+    const size_t reopenBytes = offsets.back() + CHUNK_BYTES;
+    MMAPMemoryManager manager(SEGMENT_BYTES, m_fileName, true, reopenBytes);
+    EXPECT_EQ(reopenBytes, manager.getAllocatedSize());
+    std::vector<char*> chunks;
+    for (size_t i = 0; i < offsets.size(); i++) {
+        chunks.push_back(manager.addressAt(offsets[i], CHUNK_BYTES));
+        ASSERT_TRUE(chunks[i] != NULL);
+    }
+    EXPECT_TRUE(chunksIntact(chunks));
+    char *next = static_cast<char*>(manager.allocate(CHUNK_BYTES));
+    EXPECT_TRUE(manager.fileOffsetOf(next) >= reopenBytes);
+    EXPECT_TRUE(chunksIntact(chunks));
+}
+
+class RecordingListener : public voltdb::MMAPSyncListener {
+public:
+    RecordingListener() : m_token(-1), m_calls(0) {}
+    void synced(int64_t token) {
+        m_token = token;
+        m_calls++;
+    }
+    int64_t m_token;
+    int m_calls;
+};
+
+TEST_F(MMAPMemoryManagerTest, ToldWhenSynced) {
+    MMAPMemoryManager manager(SEGMENT_BYTES, m_fileName, true);
+    allocateChunks(manager, 2);
+    RecordingListener listener;
+    manager.syncInBackground(&listener, 5);
+    manager.waitForSync();
+    EXPECT_EQ(5, listener.m_token);
+    EXPECT_EQ(1, listener.m_calls);
+
+    // a plain request does not tell the listener
+    manager.syncInBackground();
+    manager.waitForSync();
+    EXPECT_EQ(1, listener.m_calls);
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
@@ -0,0 +1,364 @@
+/* Copyright (C) 2014 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include "harness.h"
+#include "common/common.h"
+#include "common/NValue.hpp"
+#include "common/ValueFactory.hpp"
+#include "common/ValuePeeker.hpp"
+#include "common/tabletuple.h"
+#include "indexes/indexkey.h"
+#include "indexes/tableindex.h"
+// the compact skip list indexes replace BinaryTreeUniqueIndex and
+// BinaryTreeMultiMapIndex when they are swapped into tableindexfactory.cpp
+#include "indexes/SkipListUniqueIndex_compact.h"
+#include "indexes/SkipListMultiMapIndex_compact.h"
+
+using namespace std;
+using namespace voltdb;
+
+// keys 0 .. NUM_OF_KEYS-1, enough entries that a merge driven by
+// mergeStep() takes several ticks of INDEX_IDLE_MERGE_STEP leaf nodes
+#define NUM_OF_KEYS 100000
+#define MERGE_INTERVAL 10
+
+namespace {
+
+// a key type of its own, so that the index templates instantiated here do
+// not collide with the ones of the tree indexes built into the library
+struct CompactKey : public IntsKey<1> {};
+typedef IntsComparator<1> CompactComparator;
+typedef IntsEqualityChecker<1> CompactEqualityChecker;
+
+class CompactUniqueIndex : public BinaryTreeUniqueIndex<CompactKey, CompactComparator, CompactEqualityChecker> {
+public:
+    CompactUniqueIndex(const TableIndexScheme &scheme)
+        : BinaryTreeUniqueIndex<CompactKey, CompactComparator, CompactEqualityChecker>(scheme) {}
+};
+
+class CompactMultiMapIndex : public BinaryTreeMultiMapIndex<CompactKey, CompactComparator, CompactEqualityChecker> {
+public:
+    CompactMultiMapIndex(const TableIndexScheme &scheme)
+        : BinaryTreeMultiMapIndex<CompactKey, CompactComparator, CompactEqualityChecker>(scheme) {}
+};
+
+}
+
+class CompactIndexTest : public Test {
+public:
+    CompactIndexTest() : m_tupleSchema(NULL), m_keySchema(NULL), m_data(NULL), m_keyData(NULL) {
+        vector<ValueType> types(2, VALUE_TYPE_BIGINT);
+        vector<int32_t> lengths(2, NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+        vector<bool> allowNull(2, false);
+        m_tupleSchema = TupleSchema::createTupleSchema(types, lengths, allowNull, true);
+
+        vector<ValueType> keyTypes(1, VALUE_TYPE_BIGINT);
+        vector<int32_t> keyLengths(1, NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+        vector<bool> keyAllowNull(1, false);
+        m_keySchema = TupleSchema::createTupleSchema(keyTypes, keyLengths, keyAllowNull, true);
+
+        m_key = TableTuple(m_keySchema);
+        m_keyData = new char[m_key.tupleLength()];
+        memset(m_keyData, 0, m_key.tupleLength());
+        m_key.move(m_keyData);
+    }
+
+    ~CompactIndexTest() {
+        delete[] m_data;
+        delete[] m_keyData;
+        TupleSchema::freeTupleSchema(m_tupleSchema);
+        TupleSchema::freeTupleSchema(m_keySchema);
+    }
+
+    /**
+     * An index on the first column that only merges when mergeStep() is
+     * called MERGE_INTERVAL ms after the last merge, the index takes over
+     * its own copy of the key schema.
+     */
+    TableIndexScheme tickScheme(bool unique) {
+        vector<int32_t> columnIndices(1, 0);
+        vector<ValueType> columnTypes(1, VALUE_TYPE_BIGINT);
+        TableIndexScheme scheme("compact", BALANCED_TREE_INDEX, columnIndices, columnTypes,
+                                unique, true, m_tupleSchema);
+        vector<ValueType> keyTypes(1, VALUE_TYPE_BIGINT);
+        vector<int32_t> keyLengths(1, NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+        vector<bool> keyAllowNull(1, false);
+        scheme.keySchema = TupleSchema::createTupleSchema(keyTypes, keyLengths, keyAllowNull, true);
+        scheme.mergePolicy.ratio = -1;
+        scheme.mergePolicy.intervalMillis = MERGE_INTERVAL;
+        return scheme;
+    }
+
+    /** count tuples of the table, copies tuples with the same key */
+    void initTuples(int count, int copies) {
+        m_tuples.clear();
+        delete[] m_data;
+        TableTuple tuple(m_tupleSchema);
+        m_data = new char[count * copies * tuple.tupleLength()];
+        memset(m_data, 0, count * copies * tuple.tupleLength());
+        for (int i = 0; i < count * copies; i++) {
+            tuple.move(m_data + i * tuple.tupleLength());
+            tuple.setNValue(0, ValueFactory::getBigIntValue(static_cast<int64_t>(i / copies)));
+            tuple.setNValue(1, ValueFactory::getBigIntValue(static_cast<int64_t>(i)));
+            m_tuples.push_back(tuple);
+        }
+    }
+
+    /** the number of entries of the index with the given key */
+    int countAtKey(TableIndex *index, int64_t key) {
+        m_key.setNValue(0, ValueFactory::getBigIntValue(key));
+        int count = 0;
+        if (index->moveToKey(&m_key)) {
+            while (!index->nextValueAtKey().isNullTuple()) {
+                ++count;
+            }
+        }
+        return count;
+    }
+
+    /** calls mergeStep() every MERGE_INTERVAL ms until a merge has run to its end */
+    int tickMerge(TableIndex *index, int64_t &now) {
+        int64_t merges = index->getMergeCount();
+        int ticks = 0;
+        while (index->getMergeCount() == merges) {
+            now += MERGE_INTERVAL;
+            index->mergeStep(now);
+            ++ticks;
+        }
+        return ticks;
+    }
+
+    TupleSchema *m_tupleSchema;
+    TupleSchema *m_keySchema;
+    char *m_data;
+    char *m_keyData;
+    TableTuple m_key;
+    vector<TableTuple> m_tuples;
+};
+
+TEST_F(CompactIndexTest, UniqueTickMerge) {
+    initTuples(NUM_OF_KEYS, 1);
+    CompactUniqueIndex index(tickScheme(true));
+
+    for (int i = 0; i < NUM_OF_KEYS; i++) {
+        EXPECT_TRUE(index.addEntry(&m_tuples[i]));
+    }
+    EXPECT_FALSE(index.addEntry(&m_tuples[7]));
+    // the ratio trigger is off, nothing merges before the first tick
+    EXPECT_EQ(0, index.getMergeCount());
+
+    // the first tick only starts the clock
+    int64_t now = 1000;
+    EXPECT_FALSE(index.mergeStep(now));
+    EXPECT_EQ(0, index.getMergeCount());
+
+    // a tick starts the merge and copies the first part of the keys
+    now += MERGE_INTERVAL;
+    EXPECT_TRUE(index.mergeStep(now));
+    EXPECT_EQ(0, index.getMergeCount());
+
+    // deletes behind and ahead of the merge cursor while it is running
+    EXPECT_TRUE(index.deleteEntry(&m_tuples[10]));
+    EXPECT_TRUE(index.deleteEntry(&m_tuples[NUM_OF_KEYS - 10]));
+    EXPECT_FALSE(index.deleteEntry(&m_tuples[10]));
+
+    EXPECT_TRUE(tickMerge(&index, now) > 0);
+    EXPECT_EQ(1, index.getMergeCount());
+    EXPECT_EQ(NUM_OF_KEYS - 2, index.getSize());
+
+    for (int i = 0; i < NUM_OF_KEYS; i++) {
+        bool deleted = (i == 10 || i == NUM_OF_KEYS - 10);
+        EXPECT_EQ(!deleted, index.exists(&m_tuples[i]));
+        EXPECT_EQ(deleted ? 0 : 1, countAtKey(&index, i));
+    }
+
+    // the keys are all in the static stage now, delete from it and put one
+    // key back into the dynamic stage
+    EXPECT_TRUE(index.deleteEntry(&m_tuples[20]));
+    EXPECT_TRUE(index.addEntry(&m_tuples[10]));
+    EXPECT_EQ(0, countAtKey(&index, 20));
+    EXPECT_EQ(1, countAtKey(&index, 10));
+
+    EXPECT_TRUE(tickMerge(&index, now) > 0);
+    EXPECT_EQ(2, index.getMergeCount());
+    EXPECT_EQ(NUM_OF_KEYS - 2, index.getSize());
+    EXPECT_FALSE(index.exists(&m_tuples[20]));
+    EXPECT_TRUE(index.exists(&m_tuples[10]));
+
+    // the ticks after a merge give back the replaced stages, then there is
+    // nothing to merge and they do not start another one
+    for (int i = 0; i < 100 && index.mergeStep(now); i++) {
+        now += MERGE_INTERVAL;
+    }
+    now += MERGE_INTERVAL;
+    EXPECT_FALSE(index.mergeStep(now));
+    now += MERGE_INTERVAL;
+    EXPECT_FALSE(index.mergeStep(now));
+    EXPECT_EQ(2, index.getMergeCount());
+}
+
+TEST_F(CompactIndexTest, MultiMapTickMerge) {
+    initTuples(NUM_OF_KEYS, 2);
+    CompactMultiMapIndex index(tickScheme(false));
+
+    for (int i = 0; i < NUM_OF_KEYS * 2; i++) {
+        EXPECT_TRUE(index.addEntry(&m_tuples[i]));
+    }
+    EXPECT_EQ(0, index.getMergeCount());
+    EXPECT_EQ(NUM_OF_KEYS * 2, index.getSize());
+
+    int64_t now = 1000;
+    EXPECT_FALSE(index.mergeStep(now));
+    now += MERGE_INTERVAL;
+    EXPECT_TRUE(index.mergeStep(now));
+    EXPECT_EQ(0, index.getMergeCount());
+
+    // one of the tuples of a key behind the merge cursor, both of a key
+    // ahead of it, and a new tuple for a key on either side
+    EXPECT_TRUE(index.deleteEntry(&m_tuples[2 * 10]));
+    EXPECT_TRUE(index.deleteEntry(&m_tuples[2 * (NUM_OF_KEYS - 10)]));
+    EXPECT_TRUE(index.deleteEntry(&m_tuples[2 * (NUM_OF_KEYS - 10) + 1]));
+    EXPECT_FALSE(index.deleteEntry(&m_tuples[2 * 10]));
+    EXPECT_TRUE(index.addEntry(&m_tuples[2 * 30]));
+    EXPECT_TRUE(index.addEntry(&m_tuples[2 * (NUM_OF_KEYS - 30)]));
+
+    EXPECT_TRUE(tickMerge(&index, now) > 0);
+    EXPECT_EQ(1, index.getMergeCount());
+    EXPECT_EQ(NUM_OF_KEYS * 2 - 1, index.getSize());
+
+    for (int i = 0; i < NUM_OF_KEYS; i++) {
+        int expected = 2;
+        if (i == 10) expected = 1;
+        if (i == NUM_OF_KEYS - 10) expected = 0;
+        if (i == 30 || i == NUM_OF_KEYS - 30) expected = 3;
+        EXPECT_EQ(expected, countAtKey(&index, i));
+    }
+
+    // delete the rest of a key from the static stage, the key is gone after
+    // the next merge as well
+    EXPECT_TRUE(index.deleteEntry(&m_tuples[2 * 10 + 1]));
+    EXPECT_EQ(0, countAtKey(&index, 10));
+    EXPECT_TRUE(index.addEntry(&m_tuples[2 * 40]));
+
+    EXPECT_TRUE(tickMerge(&index, now) > 0);
+    EXPECT_EQ(2, index.getMergeCount());
+    EXPECT_EQ(NUM_OF_KEYS * 2 - 1, index.getSize());
+    EXPECT_EQ(0, countAtKey(&index, 10));
+    EXPECT_EQ(3, countAtKey(&index, 40));
+    EXPECT_FALSE(index.exists(&m_tuples[2 * 10]));
+    EXPECT_TRUE(index.exists(&m_tuples[2 * 40]));
+}
+
+/*
+ * A large batch becomes the static stage in one pass together with the
+ * entries already there, a key of the batch already in the index is left
+ * out as with addEntry().
+ */
+TEST_F(CompactIndexTest, UniqueBulkLoad) {
+    initTuples(NUM_OF_KEYS + 100, 1);
+    CompactUniqueIndex index(tickScheme(true));
+
+    for (int i = 0; i < 100; i++) {
+        EXPECT_TRUE(index.addEntry(&m_tuples[i]));
+    }
+    EXPECT_TRUE(index.deleteEntry(&m_tuples[5]));
+
+    srand(1);
+    vector<TableTuple> batch(m_tuples.begin(), m_tuples.begin() + NUM_OF_KEYS);
+    random_shuffle(batch.begin(), batch.end());
+    EXPECT_EQ(NUM_OF_KEYS - 99, index.addEntries(batch));
+    EXPECT_EQ(1, index.getMergeCount());
+    EXPECT_EQ(NUM_OF_KEYS, index.getSize());
+
+    for (int i = 0; i < NUM_OF_KEYS; i++) {
+        EXPECT_TRUE(index.exists(&m_tuples[i]));
+        EXPECT_EQ(1, countAtKey(&index, i));
+    }
+    EXPECT_FALSE(index.exists(&m_tuples[NUM_OF_KEYS]));
+
+    // keys in order across the whole index
+    index.moveToEnd(true);
+    for (int i = 0; i < NUM_OF_KEYS; i++) {
+        TableTuple tuple = index.nextValue();
+        EXPECT_EQ(i, ValuePeeker::peekBigInt(tuple.getNValue(0)));
+    }
+    EXPECT_TRUE(index.nextValue().isNullTuple());
+
+    // a small batch goes in entry by entry
+    EXPECT_TRUE(index.deleteEntry(&m_tuples[7]));
+    batch.assign(m_tuples.begin() + NUM_OF_KEYS, m_tuples.end());
+    batch.push_back(m_tuples[7]);
+    batch.push_back(m_tuples[8]);
+    EXPECT_EQ(101, index.addEntries(batch));
+    EXPECT_EQ(1, index.getMergeCount());
+    EXPECT_EQ(NUM_OF_KEYS + 100, index.getSize());
+    EXPECT_EQ(1, countAtKey(&index, 7));
+    EXPECT_EQ(1, countAtKey(&index, NUM_OF_KEYS + 99));
+}
+
+TEST_F(CompactIndexTest, MultiMapBulkLoad) {
+    initTuples(NUM_OF_KEYS, 2);
+    CompactMultiMapIndex index(tickScheme(false));
+
+    // the first tuple of the lower half of the keys
+    for (int i = 0; i < NUM_OF_KEYS / 2; i++) {
+        EXPECT_TRUE(index.addEntry(&m_tuples[2 * i]));
+    }
+    EXPECT_TRUE(index.deleteEntry(&m_tuples[2 * 3]));
+
+    srand(1);
+    vector<TableTuple> batch;
+    for (int i = 0; i < NUM_OF_KEYS * 2; i++) {
+        if (i % 2 == 1 || i / 2 >= NUM_OF_KEYS / 2) {
+            batch.push_back(m_tuples[i]);
+        }
+    }
+    random_shuffle(batch.begin(), batch.end());
+    EXPECT_EQ(batch.size(), index.addEntries(batch));
+    EXPECT_EQ(1, index.getMergeCount());
+    EXPECT_EQ(NUM_OF_KEYS * 2 - 1, index.getSize());
+
+    for (int i = 0; i < NUM_OF_KEYS; i++) {
+        EXPECT_EQ(i == 3 ? 1 : 2, countAtKey(&index, i));
+    }
+
+    // deletes from the static stage, then a second large batch merges
+    // around them
+    EXPECT_TRUE(index.deleteEntry(&m_tuples[2 * 4]));
+    EXPECT_TRUE(index.deleteEntry(&m_tuples[2 * 4 + 1]));
+    batch.assign(m_tuples.begin(), m_tuples.end());
+    EXPECT_EQ(NUM_OF_KEYS * 2, index.addEntries(batch));
+    EXPECT_EQ(2, index.getMergeCount());
+    EXPECT_EQ(NUM_OF_KEYS * 4 - 3, index.getSize());
+    EXPECT_EQ(3, countAtKey(&index, 3));
+    EXPECT_EQ(2, countAtKey(&index, 4));
+    EXPECT_EQ(4, countAtKey(&index, 5));
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
@@ -468,6 +468,143 @@ TEST_F(IndexKeyTest, Int64Packing2Int32sWithSecondNull) {
     voltdb::TupleSchema::freeTupleSchema(keySchema);
 }
 
+TEST_F(IndexKeyTest, GenericKeyHashMixedColumns) {
+    std::vector<voltdb::ValueType> columnTypes;
+    std::vector<int32_t> columnLengths;
+    std::vector<bool> columnAllowNull(4, true);
+
+    // an inlined and an uninlined string around fixed-size columns
+    columnTypes.push_back(voltdb::VALUE_TYPE_INTEGER);
+    columnTypes.push_back(voltdb::VALUE_TYPE_VARCHAR);
+    columnTypes.push_back(voltdb::VALUE_TYPE_DOUBLE);
+    columnTypes.push_back(voltdb::VALUE_TYPE_VARCHAR);
+    columnLengths.push_back(NValue::getTupleStorageSize(voltdb::VALUE_TYPE_INTEGER));
+    columnLengths.push_back(16);
+    columnLengths.push_back(NValue::getTupleStorageSize(voltdb::VALUE_TYPE_DOUBLE));
+    columnLengths.push_back(100);
+
+    voltdb::TupleSchema *keySchema = voltdb::TupleSchema::createTupleSchema(columnTypes, columnLengths, columnAllowNull, true);
+    ASSERT_TRUE(keySchema->tupleLength() <= 64);
+
+    voltdb::GenericComparator<64> comparator(keySchema);
+    voltdb::GenericHasher<64> hasher(keySchema);
+    voltdb::GenericEqualityChecker<64> equality(keySchema);
+    cmu::bloom_key_hash<voltdb::GenericKey<64>, voltdb::GenericComparator<64> > bloomHash(comparator);
+
+    const char *names[] = { "alice", "bob", "alice" };
+    const char *addresses[] = { "a street name that is too long to be inlined",
+                                "a street name that is too long to be inlined",
+                                "a street name that is too long to be inlined" };
+    const double balances[] = { -0.0, 1.5, 0.0 };
+
+    voltdb::TableTuple tuples[3] = { voltdb::TableTuple(keySchema), voltdb::TableTuple(keySchema),
+                                     voltdb::TableTuple(keySchema) };
+    voltdb::GenericKey<64> keys[3];
+    for (int ii = 0; ii < 3; ii++) {
+        // different garbage after the inlined string of every key
+        char *storage = new char[tuples[ii].tupleLength()];
+        memset(storage, 0x11 * (ii + 1), tuples[ii].tupleLength());
+        tuples[ii].move(storage);
+        tuples[ii].setNValue(0, ValueFactory::getIntegerValue(42));
+        voltdb::NValue name = ValueFactory::getStringValue(names[ii]);
+        tuples[ii].setNValue(1, name);
+        name.free();
+        tuples[ii].setNValue(2, ValueFactory::getDoubleValue(balances[ii]));
+        // the tuple takes over the uninlined string
+        tuples[ii].setNValue(3, ValueFactory::getStringValue(addresses[ii]));
+        keys[ii].setFromKey(&tuples[ii]);
+    }
+
+    EXPECT_TRUE(equality(keys[0], keys[2]));
+    EXPECT_FALSE(equality(keys[0], keys[1]));
+    EXPECT_EQ(hasher(keys[0]), hasher(keys[2]));
+    EXPECT_NE(hasher(keys[0]), hasher(keys[1]));
+    EXPECT_EQ(bloomHash(keys[0]), bloomHash(keys[2]));
+    EXPECT_FALSE(comparator(keys[0], keys[2]) || comparator(keys[2], keys[0]));
+
+    // NULL strings are equal to each other only
+    for (int ii = 0; ii < 3; ii += 2) {
+        tuples[ii].freeObjectColumns();
+        tuples[ii].setNValue(3, ValueFactory::getNullStringValue());
+        keys[ii].setFromKey(&tuples[ii]);
+    }
+    EXPECT_TRUE(equality(keys[0], keys[2]));
+    EXPECT_EQ(hasher(keys[0]), hasher(keys[2]));
+    EXPECT_FALSE(equality(keys[0], keys[1]));
+
+    for (int ii = 0; ii < 3; ii++) {
+        tuples[ii].freeObjectColumns();
+        delete [] tuples[ii].address();
+    }
+    voltdb::TupleSchema::freeTupleSchema(keySchema);
+}
+
+TEST_F(IndexKeyTest, GenericKeyOrderMixedColumns) {
+    std::vector<voltdb::ValueType> columnTypes;
+    std::vector<int32_t> columnLengths;
+    std::vector<bool> columnAllowNull(7, true);
+
+    columnTypes.push_back(voltdb::VALUE_TYPE_TINYINT);
+    columnTypes.push_back(voltdb::VALUE_TYPE_VARCHAR);
+    columnTypes.push_back(voltdb::VALUE_TYPE_INTEGER);
+    columnTypes.push_back(voltdb::VALUE_TYPE_DECIMAL);
+    columnTypes.push_back(voltdb::VALUE_TYPE_DOUBLE);
+    columnTypes.push_back(voltdb::VALUE_TYPE_TIMESTAMP);
+    columnTypes.push_back(voltdb::VALUE_TYPE_VARCHAR);
+    columnLengths.push_back(NValue::getTupleStorageSize(voltdb::VALUE_TYPE_TINYINT));
+    columnLengths.push_back(100);
+    columnLengths.push_back(NValue::getTupleStorageSize(voltdb::VALUE_TYPE_INTEGER));
+    columnLengths.push_back(NValue::getTupleStorageSize(voltdb::VALUE_TYPE_DECIMAL));
+    columnLengths.push_back(NValue::getTupleStorageSize(voltdb::VALUE_TYPE_DOUBLE));
+    columnLengths.push_back(NValue::getTupleStorageSize(voltdb::VALUE_TYPE_TIMESTAMP));
+    columnLengths.push_back(12);
+
+    voltdb::TupleSchema *keySchema = voltdb::TupleSchema::createTupleSchema(columnTypes, columnLengths, columnAllowNull, true);
+    ASSERT_TRUE(keySchema->tupleLength() <= 96);
+    voltdb::GenericComparator<96> comparator(keySchema);
+
+    // few distinct values per column, so that keys often tie on a prefix
+    const char *strings[] = { "", "a", "ab", "abc", "b" };
+    const char *decimals[] = { "-1.5", "0", "2.25" };
+    const int count = 60;
+    std::vector<voltdb::TableTuple> tuples;
+    std::vector<voltdb::GenericKey<96> > keys(count);
+    srand(17);
+    for (int ii = 0; ii < count; ii++) {
+        voltdb::TableTuple tuple(keySchema);
+        tuple.move(new char[tuple.tupleLength()]);
+        tuple.setNValue(0, ValueFactory::getTinyIntValue(static_cast<int8_t>(rand() % 3 - 1)));
+        // the tuple takes over the uninlined string
+        tuple.setNValue(1, rand() % 6 == 0 ? ValueFactory::getNullStringValue()
+                                           : ValueFactory::getStringValue(strings[rand() % 5]));
+        tuple.setNValue(2, ValueFactory::getIntegerValue(rand() % 3 - 1));
+        tuple.setNValue(3, ValueFactory::getDecimalValueFromString(decimals[rand() % 3]));
+        tuple.setNValue(4, ValueFactory::getDoubleValue((rand() % 3 - 1) * 0.5));
+        tuple.setNValue(5, ValueFactory::getTimestampValue(rand() % 2));
+        voltdb::NValue shortString = rand() % 6 == 0 ? ValueFactory::getNullStringValue()
+                                                     : ValueFactory::getStringValue(strings[rand() % 5]);
+        tuple.setNValue(6, shortString);
+        shortString.free();
+        keys[ii].setFromKey(&tuple);
+        tuples.push_back(tuple);
+    }
+
+    // the same order as comparing the key tuples column by column
+    for (int ii = 0; ii < count; ii++) {
+        for (int jj = 0; jj < count; jj++) {
+            const int expected = tuples[ii].compare(tuples[jj]);
+            EXPECT_EQ(expected < 0, comparator(keys[ii], keys[jj]));
+            EXPECT_EQ(expected > 0, comparator(keys[jj], keys[ii]));
+        }
+    }
+
+    for (int ii = 0; ii < count; ii++) {
+        tuples[ii].freeObjectColumns();
+        delete [] tuples[ii].address();
+    }
+    voltdb::TupleSchema::freeTupleSchema(keySchema);
+}
+
 int main() {
     return TestSuite::globalInstance()->runAll();
 }
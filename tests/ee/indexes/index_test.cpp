@@ -55,6 +55,7 @@
 #include "common/ValueFactory.hpp"
 #include "common/debuglog.h"
 #include "common/SerializableEEException.h"
+#include "common/serializeio.h"
 #include "common/tabletuple.h"
 #include "storage/table.h"
 #include "storage/temptable.h"
@@ -903,6 +904,344 @@ TEST_F(IndexTest, TupleKeyUnique) {
 }
 
 
+/*
+ * A 66 column key (528 bytes) is too wide for GenericKey. Only the last
+ * key column differs between the rows, so every lookup has to compare
+ * past the inline prefix of the keys.
+ */
+TEST_F(IndexTest, WideKeyUnique) {
+    const int num_of_columns = 70;
+    const int indexWidth = 66;
+    CatalogId database_id = 1000;
+    string *columnNames = new string[num_of_columns];
+    char buffer[32];
+    for (int ctr = 0; ctr < num_of_columns; ctr++) {
+        snprintf(buffer, 32, "column%02d", ctr);
+        columnNames[ctr] = buffer;
+    }
+    vector<ValueType> columnTypes(num_of_columns, VALUE_TYPE_BIGINT);
+    vector<int32_t> columnLengths(num_of_columns, NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+    vector<bool> columnAllowNull(num_of_columns, false);
+    TupleSchema *schema = TupleSchema::createTupleSchema(columnTypes, columnLengths, columnAllowNull, true);
+
+    vector<int> pkey_column_indices(1, num_of_columns - 1);
+    vector<ValueType> pkey_column_types(1, VALUE_TYPE_BIGINT);
+    TableIndexScheme pkey("idx_pkey", BALANCED_TREE_INDEX,
+                          pkey_column_indices, pkey_column_types, true, true, schema);
+    vector<int> wide_column_indices;
+    for (int i = 0; i < indexWidth; i++) {
+        wide_column_indices.push_back(i);
+    }
+    vector<ValueType> wide_column_types(indexWidth, VALUE_TYPE_BIGINT);
+    vector<TableIndexScheme> indexes;
+    indexes.push_back(TableIndexScheme("ixu_wider", BALANCED_TREE_INDEX,
+                                       wide_column_indices, wide_column_types, true, true, schema));
+
+    m_engine = new VoltDBEngine();
+    m_exceptionBuffer = new char[4096];
+    m_engine->setBuffers(NULL, 0, NULL, 0, m_exceptionBuffer, 4096);
+    m_engine->initialize(0, 0, 0, 0, "");
+    m_engine->setUndoToken(1);
+    m_engine->getExecutorContext()->setupForPlanFragments(m_engine->getCurrentUndoQuantum(), 0, 0);
+    table = dynamic_cast<PersistentTable*>
+        (TableFactory::getPersistentTable(database_id, m_engine->getExecutorContext(),
+                                          "test_table", schema,
+                                          columnNames, pkey, indexes, -1, false, false));
+    delete[] columnNames;
+
+    TableIndex* index = table->index("ixu_wider");
+    EXPECT_EQ(true, index != NULL);
+    EXPECT_EQ("BinaryTreeUniqueIndex", index->getTypeName());
+    EXPECT_TRUE(index->keysReferenceTuples());
+
+    for (int64_t row = 0; row < 100; row++) {
+        TableTuple &tuple = table->tempTuple();
+        for (int i = 0; i < num_of_columns; i++) {
+            tuple.setNValue(i, ValueFactory::getBigIntValue(static_cast<int64_t>(i)));
+        }
+        tuple.setNValue(indexWidth - 1, ValueFactory::getBigIntValue(row * 2));
+        tuple.setNValue(num_of_columns - 1, ValueFactory::getBigIntValue(row));
+        EXPECT_TRUE(table->insertTuple(tuple));
+    }
+    EXPECT_EQ(100, index->getSize());
+
+    vector<bool> keyColumnAllowNull(indexWidth, true);
+    vector<int32_t> keyColumnLengths(indexWidth, NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+    TupleSchema *keySchema = TupleSchema::createTupleSchema(wide_column_types, keyColumnLengths,
+                                                            keyColumnAllowNull, true);
+    TableTuple searchkey(keySchema);
+    searchkey.move(new char[searchkey.tupleLength()]);
+    for (int i = 0; i < indexWidth; i++) {
+        searchkey.setNValue(i, ValueFactory::getBigIntValue(static_cast<int64_t>(i)));
+    }
+
+    TableTuple tuple(table->schema());
+    for (int64_t row = 0; row < 100; row++) {
+        searchkey.setNValue(indexWidth - 1, ValueFactory::getBigIntValue(row * 2));
+        EXPECT_TRUE(index->moveToKey(&searchkey));
+        tuple = index->nextValueAtKey();
+        EXPECT_TRUE(ValueFactory::getBigIntValue(row).
+                    op_equals(tuple.getNValue(num_of_columns - 1)).isTrue());
+        EXPECT_TRUE(index->nextValueAtKey().isNullTuple());
+
+        searchkey.setNValue(indexWidth - 1, ValueFactory::getBigIntValue(row * 2 + 1));
+        EXPECT_FALSE(index->moveToKey(&searchkey));
+    }
+
+    // the key scan visits the rows in key order
+    searchkey.setNValue(indexWidth - 1, ValueFactory::getBigIntValue(static_cast<int64_t>(41)));
+    index->moveToKeyOrGreater(&searchkey);
+    for (int64_t row = 21; row < 100; row++) {
+        tuple = index->nextValue();
+        EXPECT_TRUE(ValueFactory::getBigIntValue(row).
+                    op_equals(tuple.getNValue(num_of_columns - 1)).isTrue());
+    }
+    EXPECT_TRUE(index->nextValue().isNullTuple());
+
+    // change the last key column of row 10 in place, then undo it
+    m_engine->setUndoToken(2);
+    m_engine->getExecutorContext()->setupForPlanFragments(m_engine->getCurrentUndoQuantum(), 0, 0);
+    searchkey.setNValue(indexWidth - 1, ValueFactory::getBigIntValue(static_cast<int64_t>(20)));
+    EXPECT_TRUE(index->moveToKey(&searchkey));
+    tuple = index->nextValueAtKey();
+    TableTuple &update = table->tempTuple();
+    update.copy(tuple);
+    update.setNValue(indexWidth - 1, ValueFactory::getBigIntValue(static_cast<int64_t>(21)));
+    EXPECT_TRUE(table->updateTuple(update, tuple, true));
+    EXPECT_FALSE(index->moveToKey(&searchkey));
+    searchkey.setNValue(indexWidth - 1, ValueFactory::getBigIntValue(static_cast<int64_t>(21)));
+    EXPECT_TRUE(index->moveToKey(&searchkey));
+    EXPECT_EQ(100, index->getSize());
+
+    m_engine->undoUndoToken(2);
+    EXPECT_FALSE(index->moveToKey(&searchkey));
+    searchkey.setNValue(indexWidth - 1, ValueFactory::getBigIntValue(static_cast<int64_t>(20)));
+    EXPECT_TRUE(index->moveToKey(&searchkey));
+    EXPECT_EQ(100, index->getSize());
+
+    TupleSchema::freeTupleSchema(keySchema);
+    delete[] searchkey.address();
+}
+
+TEST_F(IndexTest, HashUnique) {
+    vector<int> hu_column_indices;
+    vector<ValueType> hu_column_types;
+    hu_column_indices.push_back(4);
+    hu_column_types.push_back(VALUE_TYPE_BIGINT);
+    init(TableIndexScheme("hu",
+                          HASH_TABLE_INDEX,
+                          hu_column_indices,
+                          hu_column_types,
+                          true, true, NULL));
+
+    TableIndex* index = table->index("hu");
+    EXPECT_EQ(true, index != NULL);
+    EXPECT_EQ("CompactHashTableUniqueIndex", index->getTypeName());
+    // the default merge policy has moved most entries to the static stage
+    EXPECT_TRUE(index->getMergeCount() > 0);
+    EXPECT_EQ(NUM_OF_TUPLES, index->getSize());
+    EXPECT_TRUE(index->getMemoryEstimate() > 0);
+
+    TableTuple tuple(table->schema());
+    vector<ValueType> keyColumnTypes(1, VALUE_TYPE_BIGINT);
+    vector<int32_t>
+        keyColumnLengths(1, NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+    vector<bool> keyColumnAllowNull(1, true);
+    TupleSchema* keySchema =
+        TupleSchema::createTupleSchema(keyColumnTypes,
+                                       keyColumnLengths,
+                                       keyColumnAllowNull,
+                                       true);
+    TableTuple searchkey(keySchema);
+    searchkey.move(new char[searchkey.tupleLength()]);
+    for (int64_t i = 1; i <= NUM_OF_TUPLES; ++i)
+    {
+        searchkey.setNValue(0, ValueFactory::getBigIntValue(i * 11));
+        EXPECT_TRUE(index->moveToKey(&searchkey));
+        tuple = index->nextValueAtKey();
+        EXPECT_TRUE(ValueFactory::getBigIntValue(i).
+                    op_equals(tuple.getNValue(0)).isTrue());
+        EXPECT_TRUE(index->nextValueAtKey().isNullTuple());
+
+        searchkey.setNValue(0, ValueFactory::getBigIntValue(i * 11 + 1));
+        EXPECT_FALSE(index->moveToKey(&searchkey));
+    }
+
+    // delete a row from the static stage and insert it again
+    searchkey.setNValue(0, ValueFactory::getBigIntValue(static_cast<int64_t>(550)));
+    index->moveToKey(&searchkey);
+    tuple = index->nextValueAtKey();
+    EXPECT_TRUE(table->deleteTuple(tuple, true));
+    EXPECT_FALSE(index->moveToKey(&searchkey));
+    EXPECT_EQ(NUM_OF_TUPLES - 1, index->getSize());
+
+    TableTuple &temp = table->tempTuple();
+    temp.setNValue(0, ValueFactory::getBigIntValue(50));
+    temp.setNValue(1, ValueFactory::getBigIntValue(50 % 2));
+    temp.setNValue(2, ValueFactory::getBigIntValue(50 % 3));
+    temp.setNValue(3, ValueFactory::getBigIntValue(50 + 20));
+    temp.setNValue(4, ValueFactory::getBigIntValue(50 * 11));
+    EXPECT_TRUE(table->insertTuple(temp));
+    EXPECT_TRUE(index->moveToKey(&searchkey));
+    EXPECT_EQ(NUM_OF_TUPLES, index->getSize());
+
+    TupleSchema::freeTupleSchema(keySchema);
+    delete[] searchkey.address();
+}
+
+TEST_F(IndexTest, BulkLoad) {
+    vector<int> hu_column_indices;
+    vector<ValueType> hu_column_types;
+    hu_column_indices.push_back(4);
+    hu_column_types.push_back(VALUE_TYPE_BIGINT);
+    init(TableIndexScheme("hu",
+                          HASH_TABLE_INDEX,
+                          hu_column_indices,
+                          hu_column_types,
+                          true, true, NULL));
+
+    // reload the rows the way loadTable and recovery do, in one batch
+    CopySerializeOutput serialize_out;
+    table->serializeTo(serialize_out);
+    table->deleteAllTuples(true);
+    TableIndex* index = table->index("hu");
+    TableIndex* pkey = table->primaryKeyIndex();
+    EXPECT_EQ(0, index->getSize());
+    EXPECT_EQ(0, pkey->getSize());
+    int64_t merges = index->getMergeCount();
+
+    ReferenceSerializeInput serialize_in(serialize_out.data() + sizeof(int32_t),
+                                         serialize_out.size() - sizeof(int32_t));
+    table->loadTuplesFrom(false, serialize_in, NULL);
+    EXPECT_EQ(NUM_OF_TUPLES, table->activeTupleCount());
+    EXPECT_EQ(NUM_OF_TUPLES, index->getSize());
+    EXPECT_EQ(NUM_OF_TUPLES, pkey->getSize());
+    // the batch became the static stage in a single rebuild
+    EXPECT_EQ(merges + 1, index->getMergeCount());
+
+    vector<ValueType> keyColumnTypes(2, VALUE_TYPE_BIGINT);
+    vector<int32_t>
+        keyColumnLengths(2, NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+    vector<bool> keyColumnAllowNull(2, true);
+    TupleSchema* pkeySchema =
+        TupleSchema::createTupleSchema(keyColumnTypes,
+                                       keyColumnLengths,
+                                       keyColumnAllowNull,
+                                       true);
+    keyColumnTypes.pop_back();
+    keyColumnLengths.pop_back();
+    keyColumnAllowNull.pop_back();
+    TupleSchema* keySchema =
+        TupleSchema::createTupleSchema(keyColumnTypes,
+                                       keyColumnLengths,
+                                       keyColumnAllowNull,
+                                       true);
+    TableTuple searchkey(keySchema);
+    searchkey.move(new char[searchkey.tupleLength()]);
+    TableTuple pkeySearchkey(pkeySchema);
+    pkeySearchkey.move(new char[pkeySearchkey.tupleLength()]);
+    TableTuple tuple(table->schema());
+    for (int64_t i = 1; i <= NUM_OF_TUPLES; ++i)
+    {
+        searchkey.setNValue(0, ValueFactory::getBigIntValue(i * 11));
+        EXPECT_TRUE(index->moveToKey(&searchkey));
+        tuple = index->nextValueAtKey();
+        EXPECT_TRUE(ValueFactory::getBigIntValue(i).
+                    op_equals(tuple.getNValue(0)).isTrue());
+
+        pkeySearchkey.setNValue(0, ValueFactory::getBigIntValue(i));
+        pkeySearchkey.setNValue(1, ValueFactory::getBigIntValue(i % 2));
+        EXPECT_TRUE(pkey->moveToKey(&pkeySearchkey));
+        tuple = pkey->nextValueAtKey();
+        EXPECT_TRUE(ValueFactory::getBigIntValue(i * 11).
+                    op_equals(tuple.getNValue(4)).isTrue());
+    }
+
+    // the tree index hands its entries out in key order
+    pkey->moveToEnd(true);
+    for (int64_t i = 1; i <= NUM_OF_TUPLES; ++i)
+    {
+        tuple = pkey->nextValue();
+        EXPECT_TRUE(ValueFactory::getBigIntValue(i).
+                    op_equals(tuple.getNValue(0)).isTrue());
+    }
+    EXPECT_TRUE(pkey->nextValue().isNullTuple());
+
+    TupleSchema::freeTupleSchema(keySchema);
+    TupleSchema::freeTupleSchema(pkeySchema);
+    delete[] searchkey.address();
+    delete[] pkeySearchkey.address();
+}
+
+TEST_F(IndexTest, HashMulti) {
+    vector<int> hm_column_indices;
+    vector<ValueType> hm_column_types;
+    hm_column_indices.push_back(2);
+    hm_column_types.push_back(VALUE_TYPE_BIGINT);
+    init(TableIndexScheme("hm",
+                          HASH_TABLE_INDEX,
+                          hm_column_indices,
+                          hm_column_types,
+                          false, true, NULL));
+
+    TableIndex* index = table->index("hm");
+    EXPECT_EQ(true, index != NULL);
+    EXPECT_EQ("CompactHashTableMultiMapIndex", index->getTypeName());
+    EXPECT_TRUE(index->getMergeCount() > 0);
+
+    TableTuple tuple(table->schema());
+    vector<ValueType> keyColumnTypes(1, VALUE_TYPE_BIGINT);
+    vector<int32_t>
+        keyColumnLengths(1, NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+    vector<bool> keyColumnAllowNull(1, true);
+    TupleSchema* keySchema =
+        TupleSchema::createTupleSchema(keyColumnTypes,
+                                       keyColumnLengths,
+                                       keyColumnAllowNull,
+                                       true);
+    TableTuple searchkey(keySchema);
+    searchkey.move(new char[searchkey.tupleLength()]);
+
+    // column 2 is i % 3, the rows of every key span both stages
+    int expected[3] = { 0, 0, 0 };
+    for (int64_t i = 1; i <= NUM_OF_TUPLES; ++i)
+    {
+        ++expected[i % 3];
+    }
+    for (int64_t key = 0; key < 3; ++key)
+    {
+        searchkey.setNValue(0, ValueFactory::getBigIntValue(key));
+        index->moveToKey(&searchkey);
+        int count = 0;
+        while (!(tuple = index->nextValueAtKey()).isNullTuple())
+        {
+            ++count;
+            EXPECT_TRUE(ValueFactory::getBigIntValue(key).
+                        op_equals(tuple.getNValue(2)).isTrue());
+        }
+        EXPECT_EQ(expected[key], count);
+    }
+
+    // delete one row of key 1
+    searchkey.setNValue(0, ValueFactory::getBigIntValue(static_cast<int64_t>(1)));
+    index->moveToKey(&searchkey);
+    tuple = index->nextValueAtKey();
+    EXPECT_TRUE(table->deleteTuple(tuple, true));
+    index->moveToKey(&searchkey);
+    int count = 0;
+    while (!(tuple = index->nextValueAtKey()).isNullTuple())
+    {
+        ++count;
+    }
+    EXPECT_EQ(expected[1] - 1, count);
+
+    searchkey.setNValue(0, ValueFactory::getBigIntValue(static_cast<int64_t>(3)));
+    EXPECT_FALSE(index->moveToKey(&searchkey));
+
+    TupleSchema::freeTupleSchema(keySchema);
+    delete[] searchkey.address();
+}
+
 int main()
 {
     return TestSuite::globalInstance()->runAll();
@@ -26,16 +26,19 @@
 #include "common/types.h"
 #include "common/NValue.hpp"
 #include "common/ValueFactory.hpp"
+#include "common/ValuePeeker.hpp"
 #include "execution/VoltDBEngine.h"
 #include "storage/persistenttable.h"
 #include "storage/mmap_persistenttable.h"
 #include "storage/tablefactory.h"
 #include "storage/tableutil.h"
+#include "storage/tableiterator.h"
 #include "indexes/tableindex.h"
 #include <vector>
 #include <string>
 #include <time.h>
 #include <stdint.h>
+#include <unistd.h>
 
 using namespace voltdb;
 
@@ -177,6 +180,40 @@ public:
 
   }
 
+  // a table whose columns are all inlined, so that its file can be reattached
+  voltdb::PersistentTable* createInlineTable(const std::string &name, voltdb::TupleSchema **keySchema) {
+    std::vector<voltdb::ValueType> types(3, voltdb::VALUE_TYPE_BIGINT);
+    types[1] = voltdb::VALUE_TYPE_INTEGER;
+    std::vector<int32_t> sizes;
+    for (int i = 0; i < 3; i++) {
+      sizes.push_back(NValue::getTupleStorageSize(types[i]));
+    }
+    std::vector<bool> allowNull(3, false);
+    voltdb::TupleSchema *schema = voltdb::TupleSchema::createTupleSchema(types, sizes, allowNull, true);
+    *keySchema = voltdb::TupleSchema::createTupleSchema(std::vector<voltdb::ValueType>(1, voltdb::VALUE_TYPE_BIGINT),
+                                                        std::vector<int32_t>(1, sizes[0]),
+                                                        std::vector<bool>(1, false), true);
+    voltdb::TableIndexScheme indexScheme = voltdb::TableIndexScheme("primaryKeyIndex",
+                                                                    voltdb::BALANCED_TREE_INDEX,
+                                                                    std::vector<int>(1, 0),
+                                                                    std::vector<voltdb::ValueType>(1, voltdb::VALUE_TYPE_BIGINT),
+                                                                    true, false, schema);
+    indexScheme.keySchema = *keySchema;
+    std::vector<voltdb::TableIndexScheme> indexes;
+    std::string columnNames[3] = { "ID", "VAL", "CNT" };
+    return dynamic_cast<voltdb::PersistentTable*>(voltdb::TableFactory::getPersistentTable
+    (0, m_engine->getExecutorContext(), name, schema, columnNames, indexScheme, indexes, 0,
+     false, false));
+  }
+
+  void insertInlineTuple(voltdb::PersistentTable *table, int64_t id) {
+    voltdb::TableTuple &tuple = table->tempTuple();
+    tuple.setNValue(0, ValueFactory::getBigIntValue(id));
+    tuple.setNValue(1, ValueFactory::getIntegerValue(static_cast<int32_t>(id % 1000)));
+    tuple.setNValue(2, ValueFactory::getBigIntValue(id * 3));
+    ASSERT_TRUE(table->insertTuple(tuple));
+  }
+
   voltdb::VoltDBEngine *m_engine;
   voltdb::TupleSchema *m_tableSchema;
   voltdb::TupleSchema *m_primaryKeyIndexSchema;
@@ -214,6 +251,100 @@ TEST_F(MMAP_PersistentTableTest, TableAllocationTest) {
   //ASSERT_EQ( m_table->activeTupleCount(), 0);
 }
 
+TEST_F(MMAP_PersistentTableTest, TableGrowsPastFirstSegment) {
+  initTable(true);
+  // a few blocks worth of tuples, each block in the next segment of the file
+  tableutil::addRandomTuples(m_table, 100000);
+  ASSERT_EQ( m_table->activeTupleCount(), 100000);
+#ifdef STORAGE_MMAP
+  MMAPMemoryManager* manager = m_table->getDataManager();
+  ASSERT_TRUE(manager != NULL);
+  ASSERT_TRUE(manager->getSegmentCount() > 1);
+  ASSERT_TRUE(manager->getAllocatedSize() <= manager->getMappedSize());
+  manager->syncInBackground();
+  manager->waitForSync();
+#endif
+}
+
+#ifdef STORAGE_MMAP
+TEST_F(MMAP_PersistentTableTest, ReattachesCheckpointedTable) {
+  initTable(true);
+  const std::string name = genRandomString(32);
+  voltdb::TupleSchema *firstKeySchema;
+  voltdb::TupleSchema *keySchema;
+  voltdb::PersistentTable *table = createInlineTable(name, &firstKeySchema);
+  m_engine->getExecutorContext()->setupForPlanFragments(m_engine->getCurrentUndoQuantum(), 0, 0);
+  for (int64_t id = 0; id < 20000; id++) {
+    insertInlineTuple(table, id);
+  }
+  // deleted tuples leave holes behind in the file
+  voltdb::TableTuple tuple(table->schema());
+  voltdb::TableIterator iterator = table->tableIterator();
+  std::vector<voltdb::TableTuple> deleted;
+  while (iterator.next(tuple)) {
+    if (ValuePeeker::peekAsBigInt(tuple.getNValue(0)) % 7 == 0) {
+      deleted.push_back(tuple);
+    }
+  }
+  for (size_t i = 0; i < deleted.size(); i++) {
+    ASSERT_TRUE(table->deleteTuple(deleted[i], true));
+  }
+  m_engine->releaseUndoToken(INT64_MIN + 1);
+  const int64_t expected = table->activeTupleCount();
+
+  voltdb::MMAP_PersistentTable *mmapTable = dynamic_cast<voltdb::MMAP_PersistentTable*>(table);
+  ASSERT_TRUE(mmapTable != NULL);
+  ASSERT_EQ(-1, mmapTable->getCheckpointEpoch());
+  mmapTable->checkpoint(42);
+  ASSERT_EQ(42, mmapTable->getCheckpointEpoch());
+  delete table;
+  voltdb::TupleSchema::freeTupleSchema(firstKeySchema);
+
+  table = createInlineTable(name, &keySchema);
+  mmapTable = dynamic_cast<voltdb::MMAP_PersistentTable*>(table);
+  ASSERT_TRUE(mmapTable->hasDataFile());
+  ASSERT_TRUE(mmapTable->canReattach());
+  ASSERT_TRUE(mmapTable->reattach());
+  ASSERT_EQ(42, mmapTable->getCheckpointEpoch());
+  ASSERT_EQ(expected, table->activeTupleCount());
+
+  voltdb::TableIndex *index = table->primaryKeyIndex();
+  voltdb::TableTuple key(keySchema);
+  key.move(new char[key.tupleLength()]);
+  for (int64_t id = 0; id < 20000; id++) {
+    key.setNValue(0, ValueFactory::getBigIntValue(id));
+    if (id % 7 == 0) {
+      ASSERT_FALSE(index->moveToKey(&key));
+      continue;
+    }
+    ASSERT_TRUE(index->moveToKey(&key));
+    voltdb::TableTuple found = index->nextValueAtKey();
+    ASSERT_EQ(id * 3, ValuePeeker::peekAsBigInt(found.getNValue(2)));
+  }
+  delete[] key.address();
+
+  // the first write drops the checkpoint, and refills a hole
+  const int64_t allocated = table->allocatedTupleCount();
+  m_engine->setUndoToken(INT64_MIN + 2);
+  m_engine->getExecutorContext()->setupForPlanFragments(m_engine->getCurrentUndoQuantum(), 0, 0);
+  insertInlineTuple(table, 7);
+  ASSERT_EQ(-1, mmapTable->getCheckpointEpoch());
+  ASSERT_EQ(allocated, table->allocatedTupleCount());
+  ASSERT_EQ(expected + 1, table->activeTupleCount());
+  m_engine->releaseUndoToken(INT64_MIN + 2);
+  delete table;
+
+  table = createInlineTable(name, &firstKeySchema);
+  mmapTable = dynamic_cast<voltdb::MMAP_PersistentTable*>(table);
+  ASSERT_TRUE(mmapTable->hasDataFile());
+  ASSERT_FALSE(mmapTable->canReattach());
+  delete table;
+  voltdb::TupleSchema::freeTupleSchema(firstKeySchema);
+  voltdb::TupleSchema::freeTupleSchema(keySchema);
+  unlink(("/tmp/" + name + "_Data.nvm").c_str());
+}
+#endif
+
 int main() {
   return TestSuite::globalInstance()->runAll();
 }
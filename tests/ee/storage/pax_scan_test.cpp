@@ -0,0 +1,176 @@
+/* Copyright (C) 2014 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <string>
+#include <vector>
+#include "common/ValuePeeker.hpp"
+#include "common/valuevector.h"
+#include "expressions/parametervalueexpression.h"
+#include "storage/PaxMinipages.h"
+#include "storage/PaxScanIterator.h"
+#include "storage/predicate_scan_test.h"
+
+using namespace voltdb;
+using namespace std;
+
+#define NUM_OF_TUPLES 20000
+
+class PaxScanTest : public PredicateScanTest {
+public:
+    PaxScanTest() {
+        vector<ValueType> columnTypes;
+        vector<int32_t> columnLengths;
+        columnTypes.push_back(VALUE_TYPE_BIGINT); columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+        columnTypes.push_back(VALUE_TYPE_TINYINT); columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_TINYINT));
+        columnTypes.push_back(VALUE_TYPE_INTEGER); columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_INTEGER));
+        columnTypes.push_back(VALUE_TYPE_DOUBLE); columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_DOUBLE));
+        columnTypes.push_back(VALUE_TYPE_VARCHAR); columnLengths.push_back(8);
+        columnTypes.push_back(VALUE_TYPE_TIMESTAMP); columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_TIMESTAMP));
+        string columnNames[6] = { "ID", "SMALL", "MEDIUM", "REAL", "NAME", "CREATED" };
+        createTable("REPORT", columnTypes, columnLengths, columnNames);
+        table->setPaxLayout(true);
+
+        TableTuple &tuple = table->tempTuple();
+        for (int64_t id = 0; id < NUM_OF_TUPLES; id++) {
+            tuple.setNValue(0, ValueFactory::getBigIntValue(id));
+            tuple.setNValue(1, id % 11 == 0 ? NValue::getNullValue(VALUE_TYPE_TINYINT) :
+                               ValueFactory::getTinyIntValue(static_cast<int8_t>(id % 100 - 50)));
+            tuple.setNValue(2, ValueFactory::getIntegerValue(static_cast<int32_t>(id % 1000)));
+            tuple.setNValue(3, id % 13 == 0 ? NValue::getNullValue(VALUE_TYPE_DOUBLE) :
+                               ValueFactory::getDoubleValue(static_cast<double>(id % 97) / 97.0));
+            NValue name = ValueFactory::getStringValue(id % 3 == 0 ? "fizz" : "buzz");
+            tuple.setNValue(4, name);
+            name.free();
+            tuple.setNValue(5, ValueFactory::getTimestampValue(1000000 + id));
+            ASSERT_TRUE(table->insertTuple(tuple));
+        }
+    }
+
+protected:
+    vector<const void*> paxMatches(AbstractExpression *predicate) {
+        vector<const void*> matches;
+        TableTuple tuple(table->schema());
+        PaxScanIterator iterator(table, predicate);
+        while (iterator.next(tuple)) {
+            matches.push_back(tuple.address());
+        }
+        return matches;
+    }
+};
+
+TEST_F(PaxScanTest, MatchesRowScan) {
+    vector<AbstractExpression*> predicates;
+    // nulls of the narrower integer types compare as the smallest BIGINT
+    predicates.push_back(compare<CmpLt>(EXPRESSION_TYPE_COMPARE_LESSTHAN,
+                                        column(1), constant(ValueFactory::getBigIntValue(-20))));
+    predicates.push_back(compare<CmpGte>(EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO,
+                                         constant(ValueFactory::getIntegerValue(10)), column(1)));
+    predicates.push_back(compare<CmpNe>(EXPRESSION_TYPE_COMPARE_NOTEQUAL,
+                                        column(2), constant(ValueFactory::getSmallIntValue(7))));
+    predicates.push_back(both(compare<CmpGt>(EXPRESSION_TYPE_COMPARE_GREATERTHAN,
+                                             column(3), constant(ValueFactory::getDoubleValue(0.5))),
+                              compare<CmpLte>(EXPRESSION_TYPE_COMPARE_LESSTHANOREQUALTO,
+                                              column(5), constant(ValueFactory::getTimestampValue(1015000)))));
+    // a string comparison and a double compared with an integer are evaluated on the rows
+    NValue fizz = ValueFactory::getStringValue("fizz");
+    predicates.push_back(both(compare<CmpEq>(EXPRESSION_TYPE_COMPARE_EQUAL, column(4), constant(fizz)),
+                              both(compare<CmpLt>(EXPRESSION_TYPE_COMPARE_LESSTHAN,
+                                                  column(3), constant(ValueFactory::getIntegerValue(1))),
+                                   compare<CmpEq>(EXPRESSION_TYPE_COMPARE_EQUAL,
+                                                  column(2), constant(ValueFactory::getIntegerValue(99))))));
+
+    for (size_t i = 0; i < predicates.size(); i++) {
+        vector<const void*> expected = rowMatches(predicates[i]);
+        EXPECT_TRUE(expected.size() > 0);
+        EXPECT_TRUE(expected == paxMatches(predicates[i]));
+        delete predicates[i];
+    }
+    EXPECT_TRUE(table->paxMinipages()->getBytesAllocated() > 0);
+}
+
+TEST_F(PaxScanTest, Parameters) {
+    AbstractExpression *predicate =
+        compare<CmpEq>(EXPRESSION_TYPE_COMPARE_EQUAL, column(2), new ParameterValueExpression(0));
+    NValueArray params(1);
+    for (int32_t value = 0; value < 1000; value += 250) {
+        params[0] = ValueFactory::getIntegerValue(value);
+        predicate->substitute(params);
+        vector<const void*> expected = rowMatches(predicate);
+        EXPECT_EQ(NUM_OF_TUPLES / 1000, expected.size());
+        EXPECT_TRUE(expected == paxMatches(predicate));
+    }
+    delete predicate;
+}
+
+TEST_F(PaxScanTest, FollowsWrites) {
+    AbstractExpression *predicate =
+        compare<CmpLt>(EXPRESSION_TYPE_COMPARE_LESSTHAN, column(2), constant(ValueFactory::getIntegerValue(100)));
+    ASSERT_EQ(NUM_OF_TUPLES, table->activeTupleCount());
+    vector<const void*> expected = rowMatches(predicate);
+    ASSERT_TRUE(expected == paxMatches(predicate));
+
+    // delete every other match and move the rest out of range
+    TableTuple tuple(table->schema());
+    for (size_t i = 0; i < expected.size(); i++) {
+        tuple.move(const_cast<void*>(expected[i]));
+        if (i % 2 == 0) {
+            ASSERT_TRUE(table->deleteTuple(tuple, true));
+        } else if (i % 3 == 0) {
+            TableTuple &update = table->tempTuple();
+            update.copy(tuple);
+            update.setNValue(2, ValueFactory::getIntegerValue(500));
+            ASSERT_TRUE(table->updateTuple(update, tuple, false));
+        }
+    }
+    vector<const void*> remaining = rowMatches(predicate);
+    EXPECT_TRUE(remaining.size() < expected.size() / 2);
+    EXPECT_TRUE(remaining == paxMatches(predicate));
+
+    // new tuples fill the holes the deletes left
+    TableTuple &insert = table->tempTuple();
+    for (int64_t id = NUM_OF_TUPLES; id < NUM_OF_TUPLES + 100; id++) {
+        insert.setNValue(0, ValueFactory::getBigIntValue(id));
+        insert.setNValue(1, ValueFactory::getTinyIntValue(1));
+        insert.setNValue(2, ValueFactory::getIntegerValue(static_cast<int32_t>(id % 200)));
+        insert.setNValue(3, ValueFactory::getDoubleValue(0.25));
+        NValue name = ValueFactory::getStringValue("new");
+        insert.setNValue(4, name);
+        name.free();
+        insert.setNValue(5, ValueFactory::getTimestampValue(id));
+        ASSERT_TRUE(table->insertTuple(insert));
+    }
+    remaining = rowMatches(predicate);
+    EXPECT_TRUE(remaining == paxMatches(predicate));
+
+    // and tuples moved by compaction are found at their new address
+    table->compact(NUM_OF_TUPLES);
+    remaining = rowMatches(predicate);
+    EXPECT_TRUE(remaining == paxMatches(predicate));
+    delete predicate;
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
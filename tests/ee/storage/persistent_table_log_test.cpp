@@ -214,6 +214,29 @@ TEST_F(PersistentTableLogTest, TupleIds) {
     ASSERT_EQ(num_tuples, tupleIds.size());
 }
 
+TEST_F(PersistentTableLogTest, TupleIdsAcrossBlocks) {
+    initTable(true);
+    voltdb::TableTuple tuple(m_tableSchema);
+
+    // enough tuples to fill a few blocks
+    int num_tuples = 50000;
+    tableutil::addRandomTuples(m_table, num_tuples);
+    ASSERT_TRUE(static_cast<voltdb::Table*>(m_table)->allocatedBlockCount() > 2);
+
+    // ids follow the scan order of the table, across the blocks
+    voltdb::TableIterator iterator = m_table->tableIterator();
+    int expected = 0;
+    while (iterator.next(tuple)) {
+        ASSERT_EQ(expected, m_table->getTupleID(tuple.address()));
+        // addresses inside a tuple or outside of the table have no id
+        ASSERT_EQ(-1, m_table->getTupleID(tuple.address() + 1));
+        expected++;
+    } // WHILE
+    ASSERT_EQ(num_tuples, expected);
+    char outside[8];
+    ASSERT_EQ(-1, m_table->getTupleID(outside));
+}
+
 TEST_F(PersistentTableLogTest, InsertUpdateThenUndoOneTest) {
     initTable(true);
     tableutil::addRandomTuples(m_table, 1);
@@ -0,0 +1,113 @@
+/* Copyright (C) 2014 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+// The fixture the scan tests share: a persistent table and the expressions
+// to build predicates on it, with a plain row scan to compare scans with.
+
+#ifndef PREDICATE_SCAN_TEST_H__
+#define PREDICATE_SCAN_TEST_H__
+
+#include "harness.h"
+#include <string>
+#include <vector>
+#include "common/executorcontext.hpp"
+#include "common/TupleSchema.h"
+#include "common/types.h"
+#include "common/NValue.hpp"
+#include "common/ValueFactory.hpp"
+#include "common/tabletuple.h"
+#include "common/DummyUndoQuantum.hpp"
+#include "expressions/abstractexpression.h"
+#include "expressions/comparisonexpression.h"
+#include "expressions/conjunctionexpression.h"
+#include "expressions/constantvalueexpression.h"
+#include "expressions/tuplevalueexpression.h"
+#include "storage/persistenttable.h"
+#include "storage/tablefactory.h"
+#include "storage/tableiterator.h"
+
+class PredicateScanTest : public Test {
+public:
+    PredicateScanTest() : table(NULL) {
+        dummyUndo = new voltdb::DummyUndoQuantum();
+        engine = new voltdb::ExecutorContext(0, 0, dummyUndo, NULL, false, 0, "", 0);
+    }
+
+    ~PredicateScanTest() {
+        delete table;
+        delete engine;
+        delete dummyUndo;
+    }
+
+protected:
+    // every column but the first one is nullable
+    void createTable(const std::string &name, const std::vector<voltdb::ValueType> &columnTypes,
+                     const std::vector<int32_t> &columnLengths, const std::string *columnNames) {
+        std::vector<bool> columnAllowNull(columnTypes.size(), true);
+        columnAllowNull[0] = false;
+        voltdb::TupleSchema *schema =
+            voltdb::TupleSchema::createTupleSchema(columnTypes, columnLengths, columnAllowNull, true);
+        table = dynamic_cast<voltdb::PersistentTable*>(
+            voltdb::TableFactory::getPersistentTable(0, engine, name, schema, columnNames, -1, false, false));
+    }
+
+    // the tuples a plain scan evaluating the predicate on every row finds
+    std::vector<const void*> rowMatches(voltdb::AbstractExpression *predicate) {
+        std::vector<const void*> matches;
+        voltdb::TableTuple tuple(table->schema());
+        voltdb::TableIterator iterator(table);
+        while (iterator.next(tuple)) {
+            if (predicate->eval(&tuple, NULL).isTrue()) {
+                matches.push_back(tuple.address());
+            }
+        }
+        return matches;
+    }
+
+    voltdb::AbstractExpression* column(int index) {
+        return new voltdb::TupleValueExpression(index, table->name(), table->columnName(index));
+    }
+
+    voltdb::AbstractExpression* constant(voltdb::NValue value) {
+        return new voltdb::ConstantValueExpression(value);
+    }
+
+    template <typename C>
+    voltdb::AbstractExpression* compare(voltdb::ExpressionType type, voltdb::AbstractExpression *left,
+                                        voltdb::AbstractExpression *right) {
+        return new voltdb::ComparisonExpression<C>(type, left, right);
+    }
+
+    voltdb::AbstractExpression* both(voltdb::AbstractExpression *left, voltdb::AbstractExpression *right) {
+        return new voltdb::ConjunctionExpression<voltdb::ConjunctionAnd>(
+            voltdb::EXPRESSION_TYPE_CONJUNCTION_AND, left, right);
+    }
+
+    voltdb::DummyUndoQuantum *dummyUndo;
+    voltdb::ExecutorContext *engine;
+    voltdb::PersistentTable *table;
+};
+
+#endif  // PREDICATE_SCAN_TEST_H__
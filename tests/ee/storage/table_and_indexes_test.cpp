@@ -29,10 +29,12 @@
 #include "common/types.h"
 #include "common/NValue.hpp"
 #include "common/ValueFactory.hpp"
+#include "common/ValuePeeker.hpp"
 #include "common/tabletuple.h"
 #include "common/DummyUndoQuantum.hpp"
 #include "storage/table.h"
 #include "storage/temptable.h"
+#include "storage/persistenttable.h"
 #include "storage/tablefactory.h"
 #include "storage/tableiterator.h"
 #include "indexes/tableindex.h"
@@ -402,6 +404,121 @@ TEST_F(TableAndIndexTest, BigTest) {
     }
 }
 
+/*
+ * Fill in a customer of warehouse 3 and district id % 10, with one
+ * uninlined column. The strings are appended to strings for the caller
+ * to free.
+ */
+static void setCustomer(TableTuple *tuple, const TupleSchema *schema, int32_t id, vector<NValue> &strings) {
+    char buffer[32];
+    for (int i = 0; i < schema->columnCount(); i++) {
+        tuple->setNValue(i, NValue::getNullValue(schema->columnType(i)));
+    }
+    tuple->setNValue(0, ValueFactory::getIntegerValue(id));
+    tuple->setNValue(1, ValueFactory::getTinyIntValue(static_cast<int8_t>(id % 10)));
+    tuple->setNValue(2, ValueFactory::getTinyIntValue(static_cast<int8_t>(3)));
+    snprintf(buffer, sizeof(buffer), "first%d", id);
+    strings.push_back(ValueFactory::getStringValue(buffer));
+    tuple->setNValue(3, strings.back());
+    snprintf(buffer, sizeof(buffer), "last%d", id % 50);
+    strings.push_back(ValueFactory::getStringValue(buffer));
+    tuple->setNValue(5, strings.back());
+    snprintf(buffer, sizeof(buffer), "history of %d", id);
+    strings.push_back(ValueFactory::getStringValue(buffer));
+    tuple->setNValue(20, strings.back());
+}
+
+TEST_F(TableAndIndexTest, CompactAfterDeletes) {
+    PersistentTable *table = dynamic_cast<PersistentTable*>(customerTable);
+    TableIndex *pkeyIndex = table->primaryKeyIndex();
+    TableIndex *nameIndex = table->index("Customer index 1");
+    ASSERT_TRUE(pkeyIndex != NULL && nameIndex != NULL);
+    vector<NValue> strings;
+    const int32_t rows = 40000;
+
+    TableTuple *tuple = &customerTempTable->tempTuple();
+    for (int32_t id = 0; id < rows; id++) {
+        setCustomer(tuple, customerTupleSchema, id, strings);
+        ASSERT_TRUE(table->insertTuple(*tuple));
+    }
+    const int64_t allocatedBefore = table->allocatedTupleMemory();
+    const int64_t tuplesPerBlock = customerTable->allocatedTupleCount() / (int64_t)customerTable->allocatedBlockCount();
+    // nothing to give back yet
+    EXPECT_EQ(0, table->compact(1000));
+
+    // delete three out of four customers, all over the table
+    TableTuple pkey(pkeyIndex->getKeySchema());
+    pkey.move(new char[pkey.tupleLength()]);
+    for (int32_t id = 0; id < rows; id++) {
+        if (id % 4 == 0) continue;
+        pkey.setNValue(0, ValueFactory::getTinyIntValue(static_cast<int8_t>(3)));
+        pkey.setNValue(1, ValueFactory::getTinyIntValue(static_cast<int8_t>(id % 10)));
+        pkey.setNValue(2, ValueFactory::getIntegerValue(id));
+        ASSERT_TRUE(pkeyIndex->moveToKey(&pkey));
+        TableTuple found = pkeyIndex->nextValueAtKey();
+        ASSERT_TRUE(table->deleteTuple(found, true));
+    }
+    ASSERT_EQ(rows / 4, table->activeTupleCount());
+    EXPECT_EQ(allocatedBefore, table->allocatedTupleMemory());
+
+    // a bounded step at a time, as from VoltDBEngine::tick()
+    int64_t reclaimed = 0;
+    for (int step = 0; step < 100; step++) {
+        reclaimed += table->compact(500);
+    }
+    EXPECT_TRUE(reclaimed > 0);
+    EXPECT_EQ(reclaimed, table->reclaimedTupleMemory());
+    EXPECT_EQ(allocatedBefore - reclaimed, table->allocatedTupleMemory());
+    EXPECT_TRUE(table->allocatedTupleCount() - table->activeTupleCount() < tuplesPerBlock);
+
+    // every customer left is found through both indexes, at the tuple scanned
+    TableTuple nameKey(nameIndex->getKeySchema());
+    nameKey.move(new char[nameKey.tupleLength()]);
+    int32_t scanned = 0;
+    TableTuple row(customerTupleSchema);
+    TableIterator iterator = table->tableIterator();
+    while (iterator.next(row)) {
+        const int32_t id = ValuePeeker::peekAsInteger(row.getNValue(0));
+        ASSERT_EQ(0, id % 4);
+        pkey.setNValue(0, row.getNValue(2));
+        pkey.setNValue(1, row.getNValue(1));
+        pkey.setNValue(2, row.getNValue(0));
+        ASSERT_TRUE(pkeyIndex->moveToKey(&pkey));
+        EXPECT_EQ(row.address(), pkeyIndex->nextValueAtKey().address());
+        nameKey.setNValue(0, row.getNValue(2));
+        nameKey.setNValue(1, row.getNValue(1));
+        nameKey.setNValue(2, row.getNValue(5));
+        nameKey.setNValue(3, row.getNValue(3));
+        ASSERT_TRUE(nameIndex->moveToKey(&nameKey));
+        EXPECT_EQ(row.address(), nameIndex->nextValueAtKey().address());
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), "history of %d", id);
+        NValue history = ValueFactory::getStringValue(buffer);
+        EXPECT_EQ(0, history.compare(row.getNValue(20)));
+        history.free();
+        scanned++;
+    }
+    EXPECT_EQ(rows / 4, scanned);
+
+    // the freed slots are handed out again
+    for (int32_t id = rows; id < rows + 1000; id++) {
+        setCustomer(tuple, customerTupleSchema, id, strings);
+        ASSERT_TRUE(table->insertTuple(*tuple));
+    }
+    scanned = 0;
+    iterator = table->tableIterator();
+    while (iterator.next(row)) {
+        scanned++;
+    }
+    EXPECT_EQ(rows / 4 + 1000, scanned);
+
+    delete[] pkey.address();
+    delete[] nameKey.address();
+    for (vector<NValue>::const_iterator i = strings.begin(); i != strings.end(); i++) {
+        (*i).free();
+    }
+}
+
 int main() {
     return TestSuite::globalInstance()->runAll();
 }
@@ -0,0 +1,197 @@
+/* Copyright (C) 2014 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "harness.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "common/executorcontext.hpp"
+#include "common/TupleSchema.h"
+#include "common/types.h"
+#include "common/NValue.hpp"
+#include "common/ValueFactory.hpp"
+#include "common/ValuePeeker.hpp"
+#include "common/serializeio.h"
+#include "common/tabletuple.h"
+#include "common/DummyUndoQuantum.hpp"
+#include "storage/persistenttable.h"
+#include "storage/tablefactory.h"
+#include "storage/tableiterator.h"
+
+using namespace voltdb;
+using namespace std;
+
+// enough for a few blocks
+#define NUM_OF_TUPLES 100000
+
+class TableIteratorTest : public Test {
+public:
+    TableIteratorTest() {
+        dummyUndo = new DummyUndoQuantum();
+        engine = new ExecutorContext(0, 0, dummyUndo, NULL, false, 0, "", 0);
+        table = createTable("ITEMS");
+        for (int64_t id = 0; id < NUM_OF_TUPLES; id++) {
+            insert(table, id);
+        }
+    }
+
+    ~TableIteratorTest() {
+        delete table;
+        delete engine;
+        delete dummyUndo;
+    }
+
+protected:
+    PersistentTable* createTable(const string &name) {
+        vector<ValueType> columnTypes;
+        vector<int32_t> columnLengths;
+        vector<bool> columnAllowNull(2, false);
+        columnTypes.push_back(VALUE_TYPE_BIGINT); columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+        columnTypes.push_back(VALUE_TYPE_VARCHAR); columnLengths.push_back(60);
+        TupleSchema *schema = TupleSchema::createTupleSchema(columnTypes, columnLengths, columnAllowNull, true);
+        string columnNames[2] = { "ID", "NAME" };
+        return dynamic_cast<PersistentTable*>(
+            TableFactory::getPersistentTable(0, engine, name, schema, columnNames, -1, false, false));
+    }
+
+    void insert(PersistentTable *target, int64_t id) {
+        TableTuple &tuple = target->tempTuple();
+        tuple.setNValue(0, ValueFactory::getBigIntValue(id));
+        NValue name = ValueFactory::getStringValue("item");
+        tuple.setNValue(1, name);
+        name.free();
+        ASSERT_TRUE(target->insertTuple(tuple));
+    }
+
+    // deletes the tuples the filter picks, returns the ids left in table order
+    template <typename Filter>
+    vector<int64_t> deleteWhere(Filter filter) {
+        vector<int64_t> kept;
+        TableTuple tuple(table->schema());
+        TableIterator iterator(table, true);
+        while (iterator.next(tuple)) {
+            const int64_t id = ValuePeeker::peekBigInt(tuple.getNValue(0));
+            if (filter(id)) {
+                EXPECT_TRUE(table->deleteTuple(tuple, true));
+            } else {
+                kept.push_back(id);
+            }
+        }
+        return kept;
+    }
+
+    vector<int64_t> scan(PersistentTable *target, bool scanAllBlocks = false) {
+        vector<int64_t> ids;
+        TableTuple tuple(target->schema());
+        TableIterator iterator(target, scanAllBlocks);
+        while (iterator.next(tuple)) {
+            ids.push_back(ValuePeeker::peekBigInt(tuple.getNValue(0)));
+        }
+        return ids;
+    }
+
+    DummyUndoQuantum *dummyUndo;
+    ExecutorContext *engine;
+    PersistentTable *table;
+};
+
+// all but every 97th tuple, and every tuple of a range that covers a whole block
+struct SparseFilter {
+    bool operator()(int64_t id) const {
+        return id % 97 != 0 || (id >= NUM_OF_TUPLES / 4 && id < NUM_OF_TUPLES * 3 / 4);
+    }
+};
+
+struct AllFilter {
+    bool operator()(int64_t) const { return true; }
+};
+
+TEST_F(TableIteratorTest, SkipsDeletedSlots) {
+    vector<int64_t> kept = deleteWhere(SparseFilter());
+    EXPECT_EQ(kept.size(), table->activeTupleCount());
+    EXPECT_TRUE(kept == scan(table));
+    EXPECT_TRUE(kept == scan(table, true));
+
+    // down to nothing
+    kept = deleteWhere(AllFilter());
+    EXPECT_TRUE(kept.empty());
+    EXPECT_TRUE(scan(table).empty());
+    EXPECT_TRUE(scan(table, true).empty());
+}
+
+TEST_F(TableIteratorTest, FindsRefilledAndMovedSlots) {
+    vector<int64_t> kept = deleteWhere(SparseFilter());
+
+    // new tuples go into the holes the deletes left
+    for (int64_t id = NUM_OF_TUPLES; id < NUM_OF_TUPLES + 5000; id++) {
+        insert(table, id);
+        kept.push_back(id);
+    }
+    vector<int64_t> found = scan(table);
+    EXPECT_EQ(kept.size(), found.size());
+    sort(found.begin(), found.end());
+    EXPECT_TRUE(kept == found);
+
+    // and compaction moves tuples from the end into the rest of them
+    table->compact(NUM_OF_TUPLES);
+    found = scan(table);
+    EXPECT_EQ(kept.size(), found.size());
+    sort(found.begin(), found.end());
+    EXPECT_TRUE(kept == found);
+    EXPECT_TRUE(table->allocatedTupleCount() < NUM_OF_TUPLES);
+}
+
+TEST_F(TableIteratorTest, SerializesLiveTuples) {
+    vector<int64_t> kept = deleteWhere(SparseFilter());
+    CopySerializeOutput out;
+    table->serializeTo(out);
+
+    PersistentTable *copy = createTable("COPY");
+    ReferenceSerializeInput in(out.data() + sizeof(int32_t), out.size() - sizeof(int32_t));
+    copy->loadTuplesFrom(false, in, NULL);
+    EXPECT_EQ(kept.size(), copy->activeTupleCount());
+    EXPECT_TRUE(kept == scan(copy));
+
+    // the loaded tuples are tracked like inserted ones
+    TableTuple tuple(copy->schema());
+    TableIterator iterator(copy, true);
+    while (iterator.next(tuple)) {
+        if (ValuePeeker::peekBigInt(tuple.getNValue(0)) % 2 == 0) {
+            ASSERT_TRUE(copy->deleteTuple(tuple, true));
+        }
+    }
+    vector<int64_t> odd;
+    for (size_t i = 0; i < kept.size(); i++) {
+        if (kept[i] % 2 != 0) {
+            odd.push_back(kept[i]);
+        }
+    }
+    EXPECT_TRUE(odd == scan(copy));
+    delete copy;
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
@@ -0,0 +1,236 @@
+/* Copyright (C) 2014 by H-Store Project
+ * Brown University
+ * Massachusetts Institute of Technology
+ * Yale University
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT
+ * IN NO EVENT SHALL THE AUTHORS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <string>
+#include <vector>
+#include "common/ValuePeeker.hpp"
+#include "storage/PaxScanIterator.h"
+#include "storage/ZoneMaps.h"
+#include "storage/ZoneMapScanIterator.h"
+#include "storage/predicate_scan_test.h"
+
+using namespace voltdb;
+using namespace std;
+
+// enough for a few blocks
+#define NUM_OF_TUPLES 200000
+
+class ZoneMapTest : public PredicateScanTest {
+public:
+    ZoneMapTest() {
+        vector<ValueType> columnTypes;
+        vector<int32_t> columnLengths;
+        columnTypes.push_back(VALUE_TYPE_BIGINT); columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_BIGINT));
+        columnTypes.push_back(VALUE_TYPE_TIMESTAMP); columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_TIMESTAMP));
+        columnTypes.push_back(VALUE_TYPE_TINYINT); columnLengths.push_back(NValue::getTupleStorageSize(VALUE_TYPE_TINYINT));
+        columnTypes.push_back(VALUE_TYPE_VARCHAR); columnLengths.push_back(60);
+        string columnNames[4] = { "ID", "CREATED", "BUCKET", "NAME" };
+        createTable("HISTORY", columnTypes, columnLengths, columnNames);
+
+        for (int64_t id = 0; id < NUM_OF_TUPLES; id++) {
+            insert(id, 1000000 + id);
+        }
+        // the tuples already there are summarized when the zone maps come
+        vector<string> zoneMapColumns;
+        zoneMapColumns.push_back("CREATED");
+        zoneMapColumns.push_back("BUCKET");
+        zoneMapColumns.push_back("NAME");
+        table->setZoneMapColumns(zoneMapColumns);
+    }
+
+protected:
+    void insert(int64_t id, int64_t created) {
+        TableTuple &tuple = table->tempTuple();
+        tuple.setNValue(0, ValueFactory::getBigIntValue(id));
+        tuple.setNValue(1, ValueFactory::getTimestampValue(created));
+        // buckets go round, with a null every 7 tuples early in the table
+        tuple.setNValue(2, id < 5000 && id % 7 == 0 ? NValue::getNullValue(VALUE_TYPE_TINYINT) :
+                           ValueFactory::getTinyIntValue(static_cast<int8_t>(id / 10000)));
+        NValue name = ValueFactory::getStringValue(id % 2 == 0 ? "even" : "odd");
+        tuple.setNValue(3, name);
+        name.free();
+        ASSERT_TRUE(table->insertTuple(tuple));
+    }
+
+    vector<const void*> zoneMatches(AbstractExpression *predicate, int *visited = NULL) {
+        vector<const void*> matches;
+        TableTuple tuple(table->schema());
+        ZoneMapScanIterator iterator(table, predicate);
+        int count = 0;
+        while (iterator.next(tuple)) {
+            count++;
+            if (predicate->eval(&tuple, NULL).isTrue()) {
+                matches.push_back(tuple.address());
+            }
+        }
+        if (visited != NULL) {
+            *visited = count;
+        }
+        return matches;
+    }
+
+    AbstractExpression* createdBetween(int64_t from, int64_t to) {
+        return both(compare<CmpGte>(EXPRESSION_TYPE_COMPARE_GREATERTHANOREQUALTO,
+                                    column(1), constant(ValueFactory::getTimestampValue(from))),
+                    compare<CmpLt>(EXPRESSION_TYPE_COMPARE_LESSTHAN,
+                                   column(1), constant(ValueFactory::getTimestampValue(to))));
+    }
+};
+
+TEST_F(ZoneMapTest, SkipsBlocks) {
+    ASSERT_EQ(NUM_OF_TUPLES, table->activeTupleCount());
+    // the string column was left out
+    ASSERT_TRUE(table->zoneMaps() != NULL);
+    EXPECT_EQ(2, table->zoneMaps()->columns().size());
+
+    // a time range only visits the blocks filled within it
+    AbstractExpression *predicate = createdBetween(1010000, 1010500);
+    int visited = 0;
+    vector<const void*> expected = rowMatches(predicate);
+    EXPECT_EQ(500, expected.size());
+    EXPECT_TRUE(expected == zoneMatches(predicate, &visited));
+    EXPECT_TRUE(visited < NUM_OF_TUPLES / 4);
+    delete predicate;
+
+    // with the value on the left
+    predicate = compare<CmpGt>(EXPRESSION_TYPE_COMPARE_GREATERTHAN,
+                               constant(ValueFactory::getBigIntValue(1000100)), column(1));
+    expected = rowMatches(predicate);
+    EXPECT_EQ(100, expected.size());
+    EXPECT_TRUE(expected == zoneMatches(predicate, &visited));
+    EXPECT_TRUE(visited < NUM_OF_TUPLES / 4);
+    delete predicate;
+
+    // nulls compare as the smallest value, only the early blocks have them
+    predicate = compare<CmpLt>(EXPRESSION_TYPE_COMPARE_LESSTHAN,
+                               column(2), constant(ValueFactory::getIntegerValue(0)));
+    expected = rowMatches(predicate);
+    EXPECT_TRUE(expected.size() > 0);
+    EXPECT_TRUE(expected == zoneMatches(predicate, &visited));
+    EXPECT_TRUE(visited < NUM_OF_TUPLES / 4);
+    delete predicate;
+
+    // nothing can match
+    predicate = compare<CmpEq>(EXPRESSION_TYPE_COMPARE_EQUAL,
+                               column(1), constant(ValueFactory::getTimestampValue(5)));
+    EXPECT_TRUE(zoneMatches(predicate, &visited).empty());
+    EXPECT_EQ(0, visited);
+    delete predicate;
+
+    // comparisons without a zone map keep every block
+    NValue odd = ValueFactory::getStringValue("odd");
+    predicate = compare<CmpEq>(EXPRESSION_TYPE_COMPARE_EQUAL, column(3), constant(odd));
+    expected = rowMatches(predicate);
+    EXPECT_EQ(NUM_OF_TUPLES / 2, expected.size());
+    EXPECT_TRUE(expected == zoneMatches(predicate, &visited));
+    EXPECT_EQ(NUM_OF_TUPLES, visited);
+    delete predicate;
+}
+
+TEST_F(ZoneMapTest, FollowsWrites) {
+    AbstractExpression *predicate = createdBetween(2000000, 2000100);
+    EXPECT_TRUE(zoneMatches(predicate).empty());
+
+    // tuples updated into the range are found where they are
+    TableTuple tuple(table->schema());
+    TableIterator iterator(table, true);
+    while (iterator.next(tuple)) {
+        const int64_t id = ValuePeeker::peekBigInt(tuple.getNValue(0));
+        if (id % 10000 == 0) {
+            TableTuple &update = table->tempTuple();
+            update.copy(tuple);
+            update.setNValue(1, ValueFactory::getTimestampValue(2000000 + id / 10000));
+            ASSERT_TRUE(table->updateTuple(update, tuple, false));
+        } else if (id % 3 != 0) {
+            ASSERT_TRUE(table->deleteTuple(tuple, true));
+        }
+    }
+    vector<const void*> expected = rowMatches(predicate);
+    EXPECT_EQ(NUM_OF_TUPLES / 10000, expected.size());
+    EXPECT_TRUE(expected == zoneMatches(predicate));
+
+    // new tuples fill the holes the deletes left
+    for (int64_t id = NUM_OF_TUPLES; id < NUM_OF_TUPLES + 1000; id++) {
+        insert(id, 2000000 + id % 200);
+    }
+    expected = rowMatches(predicate);
+    EXPECT_EQ(NUM_OF_TUPLES / 10000 + 500, expected.size());
+    EXPECT_TRUE(expected == zoneMatches(predicate));
+
+    // and tuples moved by compaction are found at their new address
+    table->compact(NUM_OF_TUPLES);
+    expected = rowMatches(predicate);
+    EXPECT_EQ(NUM_OF_TUPLES / 10000 + 500, expected.size());
+    EXPECT_TRUE(expected == zoneMatches(predicate));
+    delete predicate;
+}
+
+TEST_F(ZoneMapTest, EmptiedBlocks) {
+    // the first blocks run empty
+    TableTuple tuple(table->schema());
+    TableIterator iterator(table, true);
+    while (iterator.next(tuple)) {
+        if (ValuePeeker::peekBigInt(tuple.getNValue(0)) < NUM_OF_TUPLES / 2) {
+            ASSERT_TRUE(table->deleteTuple(tuple, true));
+        }
+    }
+    AbstractExpression *predicate = createdBetween(1000000, 1000000 + NUM_OF_TUPLES / 4);
+    int visited = 0;
+    EXPECT_TRUE(zoneMatches(predicate, &visited).empty());
+    EXPECT_EQ(0, visited);
+
+    // and start over with the tuples that refill them
+    for (int64_t id = NUM_OF_TUPLES; id < NUM_OF_TUPLES + NUM_OF_TUPLES / 2; id++) {
+        insert(id, 3000000 + id);
+    }
+    EXPECT_TRUE(zoneMatches(predicate, &visited).empty());
+    EXPECT_EQ(0, visited);
+    delete predicate;
+}
+
+TEST_F(ZoneMapTest, PaxLayout) {
+    // the minipages of the blocks the zone maps rule out are never looked at
+    table->setPaxLayout(true);
+    NValue even = ValueFactory::getStringValue("even");
+    AbstractExpression *predicate =
+        both(createdBetween(1060000, 1062000),
+             compare<CmpEq>(EXPRESSION_TYPE_COMPARE_EQUAL, column(3), constant(even)));
+    vector<const void*> expected = rowMatches(predicate);
+    EXPECT_EQ(1000, expected.size());
+
+    vector<const void*> matches;
+    TableTuple tuple(table->schema());
+    PaxScanIterator iterator(table, predicate);
+    while (iterator.next(tuple)) {
+        matches.push_back(tuple.address());
+    }
+    EXPECT_TRUE(expected == matches);
+    EXPECT_TRUE(table->getTupleAccessCount() < NUM_OF_TUPLES / 4);
+    delete predicate;
+}
+
+int main() {
+    return TestSuite::globalInstance()->runAll();
+}
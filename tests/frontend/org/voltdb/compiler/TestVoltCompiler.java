@@ -770,6 +770,49 @@ public class TestVoltCompiler extends BaseTestCase {
         jar.delete();
     }
 
+    public void testIndexMergePolicy() {
+        final String simpleSchema =
+            "create table books (cash integer default 23, title varchar(32) default 'foo', PRIMARY KEY(cash));\n" +
+            "create index tree_title on books (title);";
+
+        final File schemaFile = VoltProjectBuilder.writeStringToTempFile(simpleSchema);
+        final String schemaPath = schemaFile.getPath();
+
+        String simpleProject =
+            "<?xml version=\"1.0\"?>\n" +
+            "<project>" +
+            "<database name='database'>" +
+            "<schemas><schema path='" + schemaPath + "' /></schemas>" +
+            "<procedures><procedure class='org.voltdb.compiler.procedures.AddBook' /></procedures>" +
+            "<indexmergepolicies>" +
+            "<indexmergepolicy table='books' index='tree_title' mergeratio='4' mergeinterval='500' bloombits='12' />" +
+            "</indexmergepolicies>" +
+            "</database>" +
+            "</project>";
+
+        File projectFile = VoltProjectBuilder.writeStringToTempFile(simpleProject);
+        final ClusterConfig cluster_config = new ClusterConfig(1, 1, 0, "localhost");
+        Catalog catalog = new VoltCompiler().compileCatalog(projectFile.getPath(), cluster_config);
+        assertNotNull(catalog);
+
+        Table catalog_tbl = CatalogUtil.getDatabase(catalog).getTables().getIgnoreCase("books");
+        assertNotNull(catalog_tbl);
+        Index catalog_idx = catalog_tbl.getIndexes().getIgnoreCase("tree_title");
+        assertNotNull(catalog_idx);
+        assertEquals(4, catalog_idx.getMergeratio());
+        assertEquals(0, catalog_idx.getMergethreshold());
+        assertEquals(0, catalog_idx.getMergememory());
+        assertEquals(500, catalog_idx.getMergeinterval());
+        assertEquals(12, catalog_idx.getBloombits());
+        assertEquals(0, catalog_idx.getBloomhashes());
+
+        // a policy for an index that does not exist is an error
+        simpleProject = simpleProject.replace("index='tree_title'", "index='tree_cash'");
+        projectFile = VoltProjectBuilder.writeStringToTempFile(simpleProject);
+        catalog = new VoltCompiler().compileCatalog(projectFile.getPath(), cluster_config);
+        assertNull(catalog);
+    }
+
     public void testForeignKeys() {
         String schemaPath = "";
         try {
@@ -4,17 +4,98 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
+#include <algorithm>
 
 namespace cmu {
 
+// final mixer of murmur3, spreads every input bit over the whole hash
+inline uint64_t bloom_mix64(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+// 64-bit hash of a key for the bloom filter. Hashes the raw bytes of the
+// key by default; key types with a cheaper hash specialize this.
+template <typename Key>
+struct bloom_hash
+{
+    inline uint64_t operator()(const Key& key) const
+    {
+        const char *data = reinterpret_cast<const char*>(&key);
+        const char *limit = data + sizeof(Key);
+        uint64_t h = sizeof(Key) * 0x9e3779b97f4a7c15ULL;
+
+        // Pick up eight bytes at a time
+        while (data + 8 <= limit) {
+            uint64_t w;
+            memcpy(&w, data, sizeof(w));  // gcc optimizes this to a plain load
+            data += 8;
+            h = (h ^ w) * 0x9e3779b97f4a7c15ULL;
+            h ^= h >> 32;
+        }
+        // Pick up remaining bytes
+        if (data < limit) {
+            uint64_t w = 0;
+            memcpy(&w, data, limit - data);
+            h = (h ^ w) * 0x9e3779b97f4a7c15ULL;
+        }
+        return bloom_mix64(h);
+    }
+};
+
+template <> struct bloom_hash<uint64_t>
+{
+    inline uint64_t operator()(uint64_t key) const { return bloom_mix64(key); }
+};
+
+template <> struct bloom_hash<int64_t>
+{
+    inline uint64_t operator()(int64_t key) const { return bloom_mix64(static_cast<uint64_t>(key)); }
+};
+
+template <> struct bloom_hash<uint32_t>
+{
+    inline uint64_t operator()(uint32_t key) const { return bloom_mix64(key); }
+};
+
+template <> struct bloom_hash<int32_t>
+{
+    inline uint64_t operator()(int32_t key) const { return bloom_mix64(static_cast<uint32_t>(key)); }
+};
+
+// Bloom filter hash of a map key, built from the key comparator of the
+// map. Keys the comparator finds equal must hash the same, which the raw
+// bytes of bloom_hash do not guarantee for keys with padding or pointers;
+// such key types specialize this with a hash that follows the comparator.
+template <typename Key, typename Compare>
+struct bloom_key_hash
+{
+    explicit bloom_key_hash(const Compare&) { }
+
+    inline uint64_t operator()(const Key& key) const { return bloom_hash<Key>()(key); }
+};
+
+// Blocked bloom filter: the high half of the hash picks one 64-byte block
+// (one cache line), the low half derives all k probes inside that block,
+// so a lookup costs a single cache miss whatever k is.
 class bloomfilter {
 private:
+    static const size_t BLOCK_BYTES = 64;
+    static const size_t BLOCK_WORDS = BLOCK_BYTES / sizeof(uint64_t);
+    static const uint32_t BLOCK_BIT_MASK = BLOCK_BYTES * 8 - 1;
+
     bool little_endian;
-    size_t bits_per_key;
     size_t k;
+    size_t bits_per_key;
 
-    size_t bits;
-    char *array;
+    size_t capacity_keys;   // key count the filter was sized for
+    size_t blocks;
+    uint64_t *array;
 
     inline uint32_t decode_fixed_32(const char *ptr) const
     {
@@ -65,17 +146,18 @@ private:
         return h;
     }
 
-    uint32_t bloom_hash(const char *data, size_t n) const
+    uint64_t bloom_hash_bytes(const char *data, size_t n) const
     {
-        return hash(data, n, 0xbc9f1d34);
+        return (static_cast<uint64_t>(hash(data, n, 0xbc9f1d34)) << 32) | hash(data, n, 0x5bd1e995);
     }
 
-public:
-    explicit inline bloomfilter(bool little_endian, int k, int bits_per_key)
-        : little_endian(little_endian), k(k), bits_per_key(bits_per_key), bits(0), array(NULL)
-    { }
+    inline const uint64_t *block_of(uint64_t h) const
+    {
+        // multiply-shift maps the high half onto [0, blocks) without a division
+        return array + ((h >> 32) * blocks >> 32) * BLOCK_WORDS;
+    }
 
-    inline ~bloomfilter()
+    void free_array()
     {
         if (array != NULL) {
             free(array);
@@ -83,47 +165,112 @@ public:
         }
     }
 
-    void reallocate(int key_count)
+public:
+    explicit inline bloomfilter(bool little_endian, size_t k, size_t bits_per_key)
+        : little_endian(little_endian), k(k), bits_per_key(bits_per_key),
+          capacity_keys(0), blocks(0), array(NULL)
+    { }
+
+    inline ~bloomfilter()
+    {
+        free_array();
+    }
+
+    // change the filter parameters, the filter is empty until reallocate()
+    void configure(size_t k, size_t bits_per_key)
     {
-        if (array != NULL) {
-            free(array);
-            array = NULL;
-        }
+        free_array();
+        this->k = k;
+        this->bits_per_key = bits_per_key;
+        capacity_keys = 0;
+        blocks = 0;
+    }
+
+    void swap(bloomfilter &from)
+    {
+        std::swap(little_endian, from.little_endian);
+        std::swap(k, from.k);
+        std::swap(bits_per_key, from.bits_per_key);
+        std::swap(capacity_keys, from.capacity_keys);
+        std::swap(blocks, from.blocks);
+        std::swap(array, from.array);
+    }
+
+    // size and clear the filter for key_count keys
+    void reallocate(size_t key_count)
+    {
+        free_array();
 
         size_t bytes = (key_count * bits_per_key + 7) / 8;
-        bits = bytes * 8;
-        array = (char *)malloc(bytes);
-        memset(array, 0, bytes);
+        blocks = std::max((bytes + BLOCK_BYTES - 1) / BLOCK_BYTES, size_t(1));
+        capacity_keys = key_count;
+        void *ptr = NULL;
+        if (posix_memalign(&ptr, BLOCK_BYTES, blocks * BLOCK_BYTES) != 0) {
+            ptr = malloc(blocks * BLOCK_BYTES);
+        }
+        array = static_cast<uint64_t *>(ptr);
+        memset(array, 0, blocks * BLOCK_BYTES);
     }
 
     size_t size() const
     {
-        return bits / 8;
+        return blocks * BLOCK_BYTES;
     }
 
-    void insert(const char *data, size_t n)
+    // key count the filter was sized for, past it the false positive rate
+    // climbs and the owner should reallocate
+    size_t capacity() const
     {
-        uint32_t h = bloom_hash(data, n);
-        const uint32_t delta = (h >> 17) | (h << 15);
+        return capacity_keys;
+    }
+
+    inline void insert_hash(uint64_t h)
+    {
+        uint64_t *block = const_cast<uint64_t *>(block_of(h));
+        uint32_t bitpos = static_cast<uint32_t>(h);
+        const uint32_t delta = (bitpos >> 17) | (bitpos << 15) | 1;
         for (size_t j = 0; j < k; j++) {
-            const uint32_t bitpos = h % bits;
-            array[bitpos / 8] |= (1 << (bitpos % 8));
-            h += delta;
+            const uint32_t bit = bitpos & BLOCK_BIT_MASK;
+            block[bit >> 6] |= uint64_t(1) << (bit & 63);
+            bitpos += delta;
         }
     }
 
-    bool key_may_match(const char *data, size_t n) const
+    inline bool hash_may_match(uint64_t h) const
     {
-        uint32_t h = bloom_hash(data, n);
-        const uint32_t delta = (h >> 17) | (h << 15);
+        const uint64_t *block = block_of(h);
+        uint32_t bitpos = static_cast<uint32_t>(h);
+        const uint32_t delta = (bitpos >> 17) | (bitpos << 15) | 1;
+        // accumulate the probes without branching on each of them
+        uint64_t miss = 0;
         for (size_t j = 0; j < k; j++) {
-            const uint32_t bitpos = h % bits;
-            if ((array[bitpos / 8] & (1 << (bitpos % 8))) == 0) {
-                return false;
-            }
-            h += delta;
+            const uint32_t bit = bitpos & BLOCK_BIT_MASK;
+            miss |= ~block[bit >> 6] & (uint64_t(1) << (bit & 63));
+            bitpos += delta;
         }
-        return true;
+        return miss == 0;
+    }
+
+    template <typename Key>
+    inline void insert_key(const Key& key)
+    {
+        insert_hash(bloom_hash<Key>()(key));
+    }
+
+    template <typename Key>
+    inline bool key_may_match(const Key& key) const
+    {
+        return hash_may_match(bloom_hash<Key>()(key));
+    }
+
+    void insert(const char *data, size_t n)
+    {
+        insert_hash(bloom_hash_bytes(data, n));
+    }
+
+    bool key_may_match(const char *data, size_t n) const
+    {
+        return hash_may_match(bloom_hash_bytes(data, n));
     }
 };
 
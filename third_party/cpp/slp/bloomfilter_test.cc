@@ -1,6 +1,111 @@
 #include "bloomfilter.h"
 
+#include <cassert>
 #include <iostream>
+#include <iomanip>
+#include <time.h>
+
+static const size_t NUM_KEYS = 1 << 20;
+
+static inline uint64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// the unblocked filter the compact skip lists used before, probing k bits
+// anywhere in the array, kept as the baseline of the benchmark
+class classic_bloomfilter {
+public:
+    classic_bloomfilter(size_t k, size_t bits_per_key, size_t key_count)
+        : k(k), bits((key_count * bits_per_key + 7) / 8 * 8), array(new char[bits / 8]())
+    { }
+
+    ~classic_bloomfilter() { delete [] array; }
+
+    void insert(uint64_t key) {
+        uint32_t h = hash(key);
+        const uint32_t delta = (h >> 17) | (h << 15);
+        for (size_t j = 0; j < k; j++) {
+            const uint32_t bitpos = h % bits;
+            array[bitpos / 8] |= (1 << (bitpos % 8));
+            h += delta;
+        }
+    }
+
+    bool key_may_match(uint64_t key) const {
+        uint32_t h = hash(key);
+        const uint32_t delta = (h >> 17) | (h << 15);
+        for (size_t j = 0; j < k; j++) {
+            const uint32_t bitpos = h % bits;
+            if ((array[bitpos / 8] & (1 << (bitpos % 8))) == 0) {
+                return false;
+            }
+            h += delta;
+        }
+        return true;
+    }
+
+private:
+    uint32_t hash(uint64_t key) const {
+        const uint32_t m = 0xc6a4a793;
+        uint32_t h = 0xbc9f1d34 ^ (8 * m);
+        for (int i = 0; i < 2; i++) {
+            h += static_cast<uint32_t>(key >> (32 * i));
+            h *= m;
+            h ^= (h >> 16);
+        }
+        return h;
+    }
+
+    size_t k;
+    size_t bits;
+    char *array;
+};
+
+// keys spread over the whole 64-bit space, absent keys are odd
+static inline uint64_t key_at(size_t i) {
+    return (i * 0x9e3779b97f4a7c15ULL) & ~1ULL;
+}
+
+template <typename Filter>
+static void probe(const char *name, const Filter& bf, size_t k, size_t bits_per_key) {
+    // keys that were inserted
+    uint64_t start = now_ns();
+    size_t hits = 0;
+    for (size_t i = 0; i < NUM_KEYS; i++) {
+        hits += bf.key_may_match(key_at(i)) ? 1 : 0;
+    }
+    uint64_t hit_ns = now_ns() - start;
+    assert(hits == NUM_KEYS);
+
+    // keys that were not
+    start = now_ns();
+    size_t false_positives = 0;
+    for (size_t i = 0; i < NUM_KEYS; i++) {
+        false_positives += bf.key_may_match(key_at(i) | 1) ? 1 : 0;
+    }
+    uint64_t miss_ns = now_ns() - start;
+
+    std::cout << std::setw(8) << name << "  bits/key " << std::setw(2) << bits_per_key
+              << "  k " << k
+              << "  fp " << std::fixed << std::setprecision(3) << std::setw(6)
+              << (100.0 * false_positives / NUM_KEYS) << "%"
+              << "  hit " << std::setprecision(1) << std::setw(5) << ((double)hit_ns / NUM_KEYS) << " ns/probe"
+              << "  miss " << std::setw(5) << ((double)miss_ns / NUM_KEYS) << " ns/probe" << std::endl;
+}
+
+static void benchmark(size_t k, size_t bits_per_key) {
+    cmu::bloomfilter blocked(true, k, bits_per_key);
+    blocked.reallocate(NUM_KEYS);
+    classic_bloomfilter classic(k, bits_per_key, NUM_KEYS);
+    for (size_t i = 0; i < NUM_KEYS; i++) {
+        blocked.insert_key(key_at(i));
+        classic.insert(key_at(i));
+    }
+    probe("blocked", blocked, k, bits_per_key);
+    probe("classic", classic, k, bits_per_key);
+}
 
 int main() {
     cmu::bloomfilter bf(true, 2, 8);
@@ -14,4 +119,24 @@ int main() {
     std::cout << bf.key_may_match(reinterpret_cast<const char*>(&c), sizeof(uint64_t)) << std::endl;
 
     std::cout << bf.size() << std::endl;
+
+    // no false negatives through the typed interface either
+    bf.insert_key(a);
+    assert(bf.key_may_match(a));
+    assert(bf.key_may_match(reinterpret_cast<const char*>(&b), sizeof(uint64_t)));
+
+    // one 64-byte block at least, rounded up to whole blocks
+    assert(bf.size() == 64);
+    bf.reallocate(64);
+    assert(bf.size() == 64);
+    bf.reallocate(65);
+    assert(bf.size() == 128);
+    bf.reallocate(1000);
+    assert(bf.size() == 1024);
+    assert(bf.capacity() == 1000);
+
+    benchmark(2, 8);
+    benchmark(3, 8);
+    benchmark(4, 10);
+    benchmark(6, 16);
 }
@@ -0,0 +1,381 @@
+#ifndef HASH_MAP_COMPACT_H_HEADER
+#define HASH_MAP_COMPACT_H_HEADER
+
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <cstddef>
+#include <cassert>
+#include <stdint.h>
+#include "boost/unordered_map.hpp"
+#include "hash_map_static.h"
+#include "skiplist_merge_policy.h"
+
+namespace cmu {
+
+// the dynamic stage of hash_map_compact
+template <typename _Key, typename _Data, typename _Hash, typename _Equal,
+          typename _Alloc, bool _Multi>
+struct hash_map_compact_dyna
+{
+    typedef boost::unordered_map<_Key, _Data, _Hash, _Equal, _Alloc> type;
+};
+
+template <typename _Key, typename _Data, typename _Hash, typename _Equal,
+          typename _Alloc>
+struct hash_map_compact_dyna<_Key, _Data, _Hash, _Equal, _Alloc, true>
+{
+    typedef boost::unordered_multimap<_Key, _Data, _Hash, _Equal, _Alloc> type;
+};
+
+// Dual-stage hash map for the hash indexes: a small boost::unordered map
+// takes the writes and is merged into a dense hash_map_static when the
+// merge policy says so. Deletes of static entries are lazy, the data of
+// the entry is set to 0, so data 0 cannot be stored. A key is unique
+// across both stages unless _Multi is set. Merges rebuild the static
+// stage in one go, merge_policy::step is ignored.
+template <typename _Key, typename _Data,
+          typename _Hash, typename _Equal,
+          typename _Alloc = std::allocator<std::pair<const _Key, _Data> >,
+          bool _Multi = false>
+class hash_map_compact
+{
+public:
+    typedef _Key key_type;
+    typedef _Data data_type;
+    typedef _Hash hasher;
+    typedef _Equal key_equal;
+    typedef _Alloc allocator_type;
+    typedef size_t size_type;
+    typedef hash_map_compact<key_type, data_type, hasher, key_equal,
+                             allocator_type, _Multi> self_type;
+
+private:
+    typedef typename hash_map_compact_dyna<key_type, data_type, hasher, key_equal,
+                                           allocator_type, _Multi>::type dyna_type;
+    typedef hash_map_static<key_type, data_type, hasher, key_equal,
+                            allocator_type> static_type;
+    typedef typename dyna_type::const_iterator dyna_iterator;
+
+public:
+    // The entries with one key, those of the dynamic stage first.
+    // Lazily deleted static entries are skipped.
+    class const_range {
+    public:
+        const_range() : d_iter(), d_end(), s_map(NULL), s_pos(0), s_end(0) { }
+
+        inline bool is_end() const
+        {
+            return d_iter == d_end && s_pos == s_end;
+        }
+
+        inline const key_type& key() const
+        {
+            return d_iter != d_end ? d_iter->first : s_map->key_at(s_pos);
+        }
+
+        inline const data_type& data() const
+        {
+            return d_iter != d_end ? d_iter->second : s_map->data_at(s_pos);
+        }
+
+        inline const_range& operator++()
+        {
+            if (d_iter != d_end) {
+                ++d_iter;
+            }
+            else {
+                ++s_pos;
+            }
+            skip_deleted();
+            return *this;
+        }
+
+    private:
+        friend class hash_map_compact<key_type, data_type, hasher, key_equal,
+                                      allocator_type, _Multi>;
+
+        const_range(dyna_iterator d_first, dyna_iterator d_last, const static_type *s_map,
+                    std::pair<size_type, size_type> s_range)
+            : d_iter(d_first), d_end(d_last), s_map(s_map),
+              s_pos(s_range.first), s_end(s_range.second)
+        {
+            skip_deleted();
+        }
+
+        inline void skip_deleted()
+        {
+            if (d_iter == d_end) {
+                while (s_pos != s_end && s_map->is_lazy_deleted(s_pos)) {
+                    ++s_pos;
+                }
+            }
+        }
+
+        dyna_iterator d_iter;
+        dyna_iterator d_end;
+        const static_type *s_map;
+        size_type s_pos;
+        size_type s_end;
+    };
+
+private:
+    dyna_type *dyna_map;
+    static_type *static_map;
+
+    merge_policy m_policy;
+    uint64_t m_last_merge_ms;   // 0 until merge_due() has seen the clock
+    size_type m_merge_count;
+
+public:
+    explicit hash_map_compact(const hasher& hf, const key_equal& eq,
+                              const allocator_type& alloc = allocator_type())
+        : dyna_map(new dyna_type(policy_buckets(merge_policy()), hf, eq, alloc)),
+          static_map(new static_type(hf, eq, alloc)),
+          m_last_merge_ms(0), m_merge_count(0)
+    {
+        dyna_map->max_load_factor(.75f);
+    }
+
+    ~hash_map_compact()
+    {
+        delete dyna_map;
+        delete static_map;
+    }
+
+    // *** Sizes and statistics
+
+    inline size_type size() const
+    {
+        return dyna_map->size() + static_map->size();
+    }
+
+    inline bool empty() const
+    {
+        return size() == 0;
+    }
+
+    inline size_type dyna_size() const
+    {
+        return dyna_map->size();
+    }
+
+    inline size_type static_size() const
+    {
+        return static_map->size();
+    }
+
+    // bytes of the static stage, all of them held through the allocator
+    inline size_type static_memory_size() const
+    {
+        return static_map->memory_size();
+    }
+
+    inline float load_factor() const
+    {
+        return dyna_map->load_factor();
+    }
+
+    // *** Lookups
+
+    const_range find(const key_type& key) const
+    {
+        if (!_Multi) {
+            dyna_iterator d_iter = dyna_map->find(key);
+            if (d_iter != dyna_map->end()) {
+                dyna_iterator d_last = d_iter;
+                return const_range(d_iter, ++d_last, static_map, std::make_pair(size_type(0), size_type(0)));
+            }
+            return const_range(dyna_map->end(), dyna_map->end(), static_map, static_map->equal_range(key));
+        }
+        return equal_range(key);
+    }
+
+    const_range equal_range(const key_type& key) const
+    {
+        std::pair<dyna_iterator, dyna_iterator> d_range = dyna_map->equal_range(key);
+        return const_range(d_range.first, d_range.second, static_map, static_map->equal_range(key));
+    }
+
+    inline bool exists(const key_type& key) const
+    {
+        return dyna_map->find(key) != dyna_map->end() || static_map->exists(key);
+    }
+
+    // *** Insertion and erase
+
+    // false if the map is unique and already holds the key
+    bool insert(const key_type& key, const data_type& data)
+    {
+        if (m_policy.should_merge(dyna_map->size(), static_map->size(), dyna_bytes())) {
+            merge_dtos();
+        }
+        if (!_Multi && static_map->exists(key)) {
+            return false;
+        }
+        return insert_dyna(key, data);
+    }
+
+    // the entry with the key, the first one of the multimap
+    bool erase_one(const key_type& key)
+    {
+        typename dyna_type::iterator d_iter = dyna_map->find(key);
+        if (d_iter != dyna_map->end()) {
+            dyna_map->erase(d_iter);
+            return true;
+        }
+        return static_map->lazy_erase_one(key);
+    }
+
+    // the entry with both the key and the data
+    bool erase_one(const key_type& key, const data_type& data)
+    {
+        std::pair<typename dyna_type::iterator, typename dyna_type::iterator> d_range = dyna_map->equal_range(key);
+        for (; d_range.first != d_range.second; ++d_range.first) {
+            if (d_range.first->second == data) {
+                dyna_map->erase(d_range.first);
+                return true;
+            }
+        }
+        return static_map->lazy_erase_one(key, data);
+    }
+
+    // Inserts a run of (key, data) pairs. A run that is large against
+    // the map rebuilds the static stage in one go from the run, the
+    // static stage and the dynamic stage, which is left empty; a small
+    // one is inserted pair by pair. In a unique map an entry already
+    // there, or the first of equal keys in the run, wins as with
+    // insert(). Returns the number of pairs inserted.
+    template <typename ForwardIterator>
+    size_type insert_bulk(ForwardIterator first, ForwardIterator last)
+    {
+        size_type count = static_cast<size_type>(std::distance(first, last));
+        if (count == 0 || count < size() / 4) {
+            size_type inserted = 0;
+            for (; first != last; ++first) {
+                if (insert(first->first, first->second)) {
+                    inserted++;
+                }
+            }
+            return inserted;
+        }
+
+        static_type *merged = new static_type(static_map->hash_function(), static_map->key_eq(),
+                                              static_map->get_allocator());
+        merged->bulk_begin(static_map->size() + dyna_map->size() + count);
+        append_stages(merged);
+        for (; first != last; ++first) {
+            merged->bulk_append(first->first, first->second);
+        }
+        size_type dropped = merged->bulk_end(!_Multi);
+
+        delete static_map;
+        static_map = merged;
+        dyna_map->clear();
+        m_merge_count++;
+        m_last_merge_ms = 0;
+        return count - dropped;
+    }
+
+    // prepares the dynamic stage for this many more entries
+    void reserve(size_type count)
+    {
+        size_type expected = m_policy.expected_dyna_size(static_map->size() + count);
+        dyna_map->rehash(static_cast<size_type>((count < expected ? count : expected) / dyna_map->max_load_factor()) + 1);
+    }
+
+    // *** Merge
+
+    inline const merge_policy& get_merge_policy() const
+    {
+        return m_policy;
+    }
+
+    void set_merge_policy(const merge_policy& policy)
+    {
+        m_policy = policy;
+    }
+
+    // number of completed dynamic-to-static merges
+    inline size_type merge_count() const
+    {
+        return m_merge_count;
+    }
+
+    // bytes taken by the entries of the dynamic stage
+    inline size_type dyna_bytes() const
+    {
+        return dyna_map->size() * (sizeof(key_type) + sizeof(data_type));
+    }
+
+    // time-based trigger of the merge policy, to be called periodically
+    // with a millisecond clock. Returns true if the dynamic stage has not
+    // been merged for the policy interval.
+    bool merge_due(uint64_t now_ms)
+    {
+        if (m_last_merge_ms == 0 || now_ms < m_last_merge_ms) {
+            m_last_merge_ms = now_ms;
+            return false;
+        }
+        return m_policy.interval_ms != 0 && dyna_map->size() != 0 &&
+               now_ms - m_last_merge_ms >= m_policy.interval_ms;
+    }
+
+    // rebuilds the static stage from its live entries and the dynamic stage
+    void merge_dtos()
+    {
+        static_type *merged = new static_type(static_map->hash_function(), static_map->key_eq(),
+                                              static_map->get_allocator());
+        merged->bulk_begin(static_map->size() + dyna_map->size());
+        append_stages(merged);
+        merged->bulk_end();
+
+        delete static_map;
+        static_map = merged;
+        dyna_map->clear();
+        m_merge_count++;
+        m_last_merge_ms = 0;
+    }
+
+private:
+    // the live entries of both stages, for a rebuild of the static stage
+    void append_stages(static_type *merged) const
+    {
+        for (size_type pos = 0; pos < static_map->slot_count(); pos++) {
+            if (!static_map->is_lazy_deleted(pos)) {
+                merged->bulk_append(static_map->key_at(pos), static_map->data_at(pos));
+            }
+        }
+        for (dyna_iterator d_iter = dyna_map->begin(); d_iter != dyna_map->end(); ++d_iter) {
+            merged->bulk_append(d_iter->first, d_iter->second);
+        }
+    }
+
+    inline bool insert_dyna(const key_type& key, const data_type& data)
+    {
+        return insert_result(dyna_map->insert(std::make_pair(key, data)));
+    }
+
+    static inline bool insert_result(const std::pair<typename dyna_type::iterator, bool>& result)
+    {
+        return result.second;
+    }
+
+    static inline bool insert_result(const typename dyna_type::iterator&)
+    {
+        return true;
+    }
+
+    static inline size_type policy_buckets(const merge_policy& policy)
+    {
+        return policy.threshold > 0 ? policy.threshold : 16;
+    }
+
+    // not copyable, the stages are owned
+    hash_map_compact(const self_type&);
+    self_type& operator=(const self_type&);
+};
+
+} // namespace cmu
+
+#endif // HASH_MAP_COMPACT_H_HEADER
@@ -0,0 +1,225 @@
+#include "hash_map_compact.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <map>
+#include <vector>
+
+// counts the bytes held through it, like the index allocator of the EE
+static int64_t allocated_bytes = 0;
+
+template <typename T>
+class counting_allocator : public std::allocator<T> {
+public:
+    typedef typename std::allocator<T>::pointer pointer;
+    typedef typename std::allocator<T>::size_type size_type;
+
+    template <typename U> struct rebind {
+        typedef counting_allocator<U> other;
+    };
+
+    counting_allocator() throw() { }
+    counting_allocator(const counting_allocator& other) throw() : std::allocator<T>(other) { }
+    template <typename U> counting_allocator(const counting_allocator<U>& other) throw() : std::allocator<T>(other) { }
+
+    pointer allocate(size_type n, const void *hint = 0) {
+        allocated_bytes += n * sizeof(T);
+        return std::allocator<T>::allocate(n);
+    }
+
+    void deallocate(pointer p, size_type n) {
+        allocated_bytes -= n * sizeof(T);
+        std::allocator<T>::deallocate(p, n);
+    }
+};
+
+// as weak as boost::hash_combine over a single integer
+struct weak_hash {
+    size_t operator()(uint64_t key) const { return static_cast<size_t>(key + 0x9e3779b9); }
+};
+
+typedef counting_allocator<std::pair<const uint64_t, uint64_t> > AllocType;
+typedef cmu::hash_map_compact<uint64_t, uint64_t, weak_hash, std::equal_to<uint64_t>, AllocType> HashType;
+typedef cmu::hash_map_compact<uint64_t, uint64_t, weak_hash, std::equal_to<uint64_t>, AllocType, true> MultiHashType;
+typedef boost::unordered_map<uint64_t, uint64_t, weak_hash, std::equal_to<uint64_t>, AllocType> PlainHashType;
+
+// used like the unique hash index, against a std::map
+static void test_unique_random() {
+    std::map<uint64_t, uint64_t> expected;
+    HashType map((weak_hash()), std::equal_to<uint64_t>());
+    cmu::merge_policy policy;
+    policy.ratio = 4;
+    policy.threshold = 200;
+    map.set_merge_policy(policy);
+    srand(42);
+
+    for (int i = 0; i < 50000; i++) {
+        uint64_t key = static_cast<uint64_t>(rand() % 20000);
+        if (rand() % 4 == 0) {
+            assert(map.erase_one(key) == (expected.erase(key) == 1));
+        }
+        else {
+            uint64_t data = static_cast<uint64_t>(i + 1);
+            bool fresh = expected.count(key) == 0;
+            assert(map.insert(key, data) == fresh);
+            if (!fresh) {
+                // as the unique index updates an entry
+                assert(map.erase_one(key));
+                assert(map.insert(key, data));
+            }
+            expected[key] = data;
+        }
+    }
+    assert(map.merge_count() > 0);
+    assert(map.size() == expected.size());
+
+    for (uint64_t key = 0; key < 20000; key++) {
+        HashType::const_range range = map.find(key);
+        std::map<uint64_t, uint64_t>::iterator e = expected.find(key);
+        assert(map.exists(key) == (e != expected.end()));
+        assert(range.is_end() == (e == expected.end()));
+        if (e != expected.end()) {
+            assert(range.key() == key && range.data() == e->second);
+            ++range;
+            assert(range.is_end());
+        }
+    }
+}
+
+// used like the multimap hash index, against a std::multimap
+static void test_multi_random() {
+    std::multimap<uint64_t, uint64_t> expected;
+    MultiHashType map((weak_hash()), std::equal_to<uint64_t>());
+    cmu::merge_policy policy;
+    policy.ratio = 4;
+    policy.threshold = 200;
+    map.set_merge_policy(policy);
+    srand(7);
+
+    for (int i = 0; i < 50000; i++) {
+        uint64_t key = static_cast<uint64_t>(rand() % 2000);
+        if (rand() % 3 == 0) {
+            std::pair<std::multimap<uint64_t, uint64_t>::iterator,
+                      std::multimap<uint64_t, uint64_t>::iterator> range = expected.equal_range(key);
+            if (range.first != range.second) {
+                assert(map.erase_one(key, range.first->second));
+                expected.erase(range.first);
+            }
+            else {
+                assert(!map.erase_one(key, 1));
+            }
+        }
+        else {
+            uint64_t data = static_cast<uint64_t>(i + 1);
+            assert(map.insert(key, data));
+            expected.insert(std::make_pair(key, data));
+        }
+    }
+    assert(map.merge_count() > 0);
+    assert(map.size() == expected.size());
+
+    for (uint64_t key = 0; key < 2000; key++) {
+        std::multimap<uint64_t, uint64_t> found;
+        for (MultiHashType::const_range range = map.equal_range(key); !range.is_end(); ++range) {
+            assert(range.key() == key);
+            found.insert(std::make_pair(key, range.data()));
+        }
+        std::pair<std::multimap<uint64_t, uint64_t>::iterator,
+                  std::multimap<uint64_t, uint64_t>::iterator> range = expected.equal_range(key);
+        assert(found.size() == static_cast<size_t>(std::distance(range.first, range.second)));
+        for (; range.first != range.second; ++range.first) {
+            bool match = false;
+            for (std::multimap<uint64_t, uint64_t>::iterator f = found.begin(); f != found.end(); ++f) {
+                match = match || f->second == range.first->second;
+            }
+            assert(match);
+        }
+    }
+}
+
+// loaded like a table, in runs of tuples
+static void test_bulk() {
+    HashType map((weak_hash()), std::equal_to<uint64_t>());
+    std::vector<std::pair<uint64_t, uint64_t> > run;
+    for (uint64_t i = 0; i < 10000; i++) {
+        run.push_back(std::make_pair(i, i + 1));
+    }
+    // a key repeated in the run and one already in the map are skipped
+    run.push_back(std::make_pair(uint64_t(5), uint64_t(99)));
+    assert(map.insert(20000, 1));
+    assert(map.insert_bulk(run.begin(), run.end()) == 10000);
+    assert(map.insert(0, 7) == false);
+    run.clear();
+    run.push_back(std::make_pair(uint64_t(20000), uint64_t(2)));
+    for (uint64_t i = 10000; i < 14000; i++) {
+        run.push_back(std::make_pair(i, i + 1));
+    }
+    assert(map.insert_bulk(run.begin(), run.end()) == 4000);
+    assert(map.dyna_size() == 0 && map.size() == 14001);
+    for (uint64_t i = 0; i < 14000; i++) {
+        HashType::const_range range = map.find(i);
+        assert(!range.is_end() && range.data() == i + 1);
+    }
+    assert(map.find(20000).data() == 1);
+
+    // a small run goes through the dynamic stage
+    run.clear();
+    run.push_back(std::make_pair(uint64_t(30000), uint64_t(3)));
+    assert(map.insert_bulk(run.begin(), run.end()) == 1);
+    assert(map.dyna_size() == 1);
+
+    MultiHashType multi((weak_hash()), std::equal_to<uint64_t>());
+    run.clear();
+    for (uint64_t i = 0; i < 3000; i++) {
+        run.push_back(std::make_pair(i / 3, i + 1));
+    }
+    assert(multi.insert_bulk(run.begin(), run.end()) == 3000);
+    size_t found = 0;
+    for (MultiHashType::const_range range = multi.equal_range(500); !range.is_end(); ++range) {
+        assert(range.data() >= 1501 && range.data() <= 1503);
+        found++;
+    }
+    assert(found == 3);
+}
+
+// bytes per entry of the merged map against a plain boost::unordered_map
+static void compare_memory(size_t count) {
+    int64_t before = allocated_bytes;
+    PlainHashType *plain = new PlainHashType(100, weak_hash(), std::equal_to<uint64_t>(), AllocType());
+    plain->max_load_factor(.75f);
+    for (size_t i = 0; i < count; i++) {
+        plain->insert(std::make_pair(static_cast<uint64_t>(i * 7), static_cast<uint64_t>(i + 1)));
+    }
+    int64_t plain_bytes = allocated_bytes - before;
+
+    before = allocated_bytes;
+    HashType *compact = new HashType(weak_hash(), std::equal_to<uint64_t>(), AllocType());
+    for (size_t i = 0; i < count; i++) {
+        compact->insert(static_cast<uint64_t>(i * 7), static_cast<uint64_t>(i + 1));
+    }
+    compact->merge_dtos();
+    int64_t compact_bytes = allocated_bytes - before;
+    assert(compact->size() == count && compact->dyna_size() == 0);
+    for (size_t i = 0; i < count; i++) {
+        assert(compact->find(static_cast<uint64_t>(i * 7)).data() == i + 1);
+        assert(!compact->exists(static_cast<uint64_t>(i * 7 + 1)));
+    }
+
+    std::cout << "uint64_t  boost::unordered_map " << std::fixed << std::setprecision(1) << std::setw(6)
+              << (double)plain_bytes / count << "  compact " << std::setw(6)
+              << (double)compact_bytes / count << " bytes/entry" << std::endl;
+    assert(compact_bytes * 2 < plain_bytes);
+
+    delete plain;
+    delete compact;
+}
+
+int main() {
+    test_unique_random();
+    test_multi_random();
+    test_bulk();
+    compare_memory(100000);
+    assert(allocated_bytes == 0);
+    std::cout << "compact hash map tests passed" << std::endl;
+}
@@ -0,0 +1,369 @@
+#ifndef HASH_MAP_STATIC_H_HEADER
+#define HASH_MAP_STATIC_H_HEADER
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <cstddef>
+#include <cassert>
+#include <vector>
+#include <stdint.h>
+
+namespace cmu {
+
+// Read-optimized static stage of the compact hash maps. The entries are
+// stored densely, without empty slots or per-entry nodes, ordered by
+// their hash bucket; a bucket is the run of entries between two offsets
+// of a bucket array that is about half as long as the map. A lookup
+// scans the one-byte tags of its bucket, two entries on average, and
+// compares keys only on a tag match. Equal keys are kept next to each
+// other within their bucket. Data value 0 marks lazily deleted entries,
+// as in the static stage of the compact skip lists. The map is built
+// with the bulk functions and is read-only otherwise, except for lazy
+// deletes. Keys are copied as plain data.
+template <typename _Key, typename _Data,
+          typename _Hash, typename _Equal,
+          typename _Alloc = std::allocator<std::pair<_Key, _Data> > >
+class hash_map_static
+{
+public:
+    typedef _Key key_type;
+    typedef _Data data_type;
+    typedef _Hash hasher;
+    typedef _Equal key_equal;
+    typedef _Alloc allocator_type;
+    typedef size_t size_type;
+    typedef hash_map_static<key_type, data_type, hasher, key_equal,
+                            allocator_type> self_type;
+
+    // average entries per bucket
+    static const size_type bucket_order = 2;
+
+    static const size_type npos = size_type(-1);
+
+private:
+    typedef typename _Alloc::template rebind<key_type>::other key_alloc_type;
+    typedef typename _Alloc::template rebind<data_type>::other data_alloc_type;
+    typedef typename _Alloc::template rebind<uint32_t>::other offset_alloc_type;
+    typedef typename _Alloc::template rebind<unsigned char>::other tag_alloc_type;
+
+    typedef std::vector<key_type, key_alloc_type> key_vector;
+    typedef std::vector<data_type, data_alloc_type> data_vector;
+    typedef std::vector<uint32_t, offset_alloc_type> offset_vector;
+    typedef std::vector<unsigned char, tag_alloc_type> tag_vector;
+
+    key_vector m_keys;
+    data_vector m_data;
+    tag_vector m_tags;
+    offset_vector m_offsets;    // bucket b holds [m_offsets[b], m_offsets[b + 1])
+
+    // hash bucket of every entry while the map is built
+    offset_vector m_build_buckets;
+
+    size_type m_size;           // live entries
+    hasher m_hash;
+    key_equal m_key_equal;
+    allocator_type m_allocator;
+
+    // the hashers of the EE are weak in the low bits (boost::hash_combine
+    // of small integers), so the bucket and the tag are taken from the
+    // high bits of a multiplicative mix
+    static inline uint64_t mix(size_t h)
+    {
+        return static_cast<uint64_t>(h) * 0x9e3779b97f4a7c15ULL;
+    }
+
+    static inline unsigned char tag_of(uint64_t m)
+    {
+        return static_cast<unsigned char>(0x80 | ((m >> 25) & 0x7f));
+    }
+
+    inline uint32_t bucket_of(uint64_t m) const
+    {
+        return static_cast<uint32_t>(((m >> 32) * (m_offsets.size() - 1)) >> 32);
+    }
+
+public:
+    explicit hash_map_static(const hasher& hf, const key_equal& eq,
+                             const allocator_type& alloc = allocator_type())
+        : m_keys(key_alloc_type(alloc)), m_data(data_alloc_type(alloc)),
+          m_tags(tag_alloc_type(alloc)), m_offsets(offset_alloc_type(alloc)),
+          m_build_buckets(offset_alloc_type(alloc)),
+          m_size(0), m_hash(hf), m_key_equal(eq), m_allocator(alloc)
+    { }
+
+    void swap(self_type& from)
+    {
+        m_keys.swap(from.m_keys);
+        m_data.swap(from.m_data);
+        m_tags.swap(from.m_tags);
+        m_offsets.swap(from.m_offsets);
+        m_build_buckets.swap(from.m_build_buckets);
+        std::swap(m_size, from.m_size);
+        std::swap(m_hash, from.m_hash);
+        std::swap(m_key_equal, from.m_key_equal);
+        std::swap(m_allocator, from.m_allocator);
+    }
+
+    void clear()
+    {
+        key_vector(key_alloc_type(m_allocator)).swap(m_keys);
+        data_vector(data_alloc_type(m_allocator)).swap(m_data);
+        tag_vector(tag_alloc_type(m_allocator)).swap(m_tags);
+        offset_vector(offset_alloc_type(m_allocator)).swap(m_offsets);
+        offset_vector(offset_alloc_type(m_allocator)).swap(m_build_buckets);
+        m_size = 0;
+    }
+
+    inline hasher hash_function() const
+    {
+        return m_hash;
+    }
+
+    inline key_equal key_eq() const
+    {
+        return m_key_equal;
+    }
+
+    inline allocator_type get_allocator() const
+    {
+        return m_allocator;
+    }
+
+    // *** Access
+
+    // live entries, lazily deleted ones excluded
+    inline size_type size() const
+    {
+        return m_size;
+    }
+
+    // entries including the lazily deleted ones
+    inline size_type slot_count() const
+    {
+        return m_keys.size();
+    }
+
+    inline size_type bucket_count() const
+    {
+        return m_offsets.empty() ? 0 : m_offsets.size() - 1;
+    }
+
+    inline const key_type& key_at(size_type pos) const
+    {
+        return m_keys[pos];
+    }
+
+    inline const data_type& data_at(size_type pos) const
+    {
+        return m_data[pos];
+    }
+
+    inline bool is_lazy_deleted(size_type pos) const
+    {
+        return m_data[pos] == data_type();
+    }
+
+    // bytes held through the allocator
+    inline size_type memory_size() const
+    {
+        return m_keys.capacity() * sizeof(key_type) +
+               m_data.capacity() * sizeof(data_type) +
+               m_tags.capacity() +
+               (m_offsets.capacity() + m_build_buckets.capacity()) * sizeof(uint32_t);
+    }
+
+    // The run of entries with the given key as [first, last), lazily
+    // deleted ones included. first == last if the key is not there.
+    std::pair<size_type, size_type> equal_range(const key_type& key) const
+    {
+        if (m_keys.empty()) {
+            return std::make_pair(size_type(0), size_type(0));
+        }
+
+        const uint64_t m = mix(m_hash(key));
+        const uint32_t b = bucket_of(m);
+        const unsigned char tag = tag_of(m);
+        const size_type end = m_offsets[b + 1];
+        for (size_type pos = m_offsets[b]; pos < end; pos++) {
+            if (m_tags[pos] == tag && m_key_equal(m_keys[pos], key)) {
+                size_type last = pos + 1;
+                while (last < end && m_tags[last] == tag && m_key_equal(m_keys[last], key)) {
+                    last++;
+                }
+                return std::make_pair(pos, last);
+            }
+        }
+        return std::make_pair(size_type(0), size_type(0));
+    }
+
+    // position of the first live entry with the key, npos if there is none
+    size_type find(const key_type& key) const
+    {
+        std::pair<size_type, size_type> range = equal_range(key);
+        for (size_type pos = range.first; pos < range.second; pos++) {
+            if (!is_lazy_deleted(pos)) {
+                return pos;
+            }
+        }
+        return npos;
+    }
+
+    inline bool exists(const key_type& key) const
+    {
+        return find(key) != npos;
+    }
+
+    // *** Lazy deletes
+
+    void lazy_erase(size_type pos)
+    {
+        assert(pos < m_data.size() && !is_lazy_deleted(pos));
+        m_data[pos] = data_type();
+        m_size--;
+    }
+
+    bool lazy_erase_one(const key_type& key)
+    {
+        size_type pos = find(key);
+        if (pos == npos) {
+            return false;
+        }
+        lazy_erase(pos);
+        return true;
+    }
+
+    // the entry with both the key and the data, for the multimap
+    bool lazy_erase_one(const key_type& key, const data_type& data)
+    {
+        std::pair<size_type, size_type> range = equal_range(key);
+        for (size_type pos = range.first; pos < range.second; pos++) {
+            if (m_data[pos] == data && !is_lazy_deleted(pos)) {
+                lazy_erase(pos);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // *** Bulk build
+
+    // Starts building the map from scratch with the expected number of
+    // entries. Entries are appended in any order with non-zero data, and
+    // the map cannot be read until bulk_end().
+    void bulk_begin(size_type count)
+    {
+        clear();
+        m_keys.reserve(count);
+        m_data.reserve(count);
+        m_build_buckets.reserve(count);
+        m_tags.reserve(count);
+        size_type buckets = (count + bucket_order - 1) / bucket_order;
+        m_offsets.assign((buckets > 0 ? buckets : 1) + 1, 0);
+    }
+
+    inline void bulk_append(const key_type& key, const data_type& data)
+    {
+        const uint64_t m = mix(m_hash(key));
+        const uint32_t b = bucket_of(m);
+        m_keys.push_back(key);
+        m_data.push_back(data);
+        m_tags.push_back(tag_of(m));
+        m_build_buckets.push_back(b);
+        m_offsets[b + 1]++;
+    }
+
+    // Sorts the appended entries into their buckets with a counting sort
+    // and groups equal keys within every bucket. With unique set, only the
+    // first appended of equal keys is kept. Returns the entries dropped.
+    size_type bulk_end(bool unique = false)
+    {
+        const size_type count = m_keys.size();
+        assert(count < size_type(0xffffffffu));
+        const size_type buckets = m_offsets.size() - 1;
+        for (size_type b = 0; b < buckets; b++) {
+            m_offsets[b + 1] += m_offsets[b];
+        }
+
+        key_vector keys(m_keys.begin(), m_keys.end(), key_alloc_type(m_allocator));
+        data_vector data(count, data_type(), data_alloc_type(m_allocator));
+        tag_vector tags(count, 0, tag_alloc_type(m_allocator));
+        {
+            offset_vector next(m_offsets.begin(), m_offsets.end() - 1, offset_alloc_type(m_allocator));
+            for (size_type i = 0; i < count; i++) {
+                uint32_t pos = next[m_build_buckets[i]]++;
+                keys[pos] = m_keys[i];
+                data[pos] = m_data[i];
+                tags[pos] = m_tags[i];
+            }
+        }
+        offset_vector(offset_alloc_type(m_allocator)).swap(m_build_buckets);
+        m_keys.swap(keys);
+        m_data.swap(data);
+        m_tags.swap(tags);
+
+        m_size = 0;
+        for (size_type b = 0; b < buckets; b++) {
+            group_bucket(m_offsets[b], m_offsets[b + 1]);
+        }
+        size_type dropped = unique ? drop_duplicates() : 0;
+        for (size_type pos = 0; pos < m_keys.size(); pos++) {
+            if (!is_lazy_deleted(pos)) {
+                m_size++;
+            }
+        }
+        return dropped;
+    }
+
+private:
+    // keeps the first entry of every run of equal keys and closes the gaps
+    size_type drop_duplicates()
+    {
+        const size_type buckets = m_offsets.size() - 1;
+        size_type kept = 0;
+        for (size_type b = 0; b < buckets; b++) {
+            const size_type first = m_offsets[b];
+            const size_type last = m_offsets[b + 1];
+            m_offsets[b] = static_cast<uint32_t>(kept);
+            for (size_type pos = first; pos < last; pos++) {
+                if (pos > first && m_tags[pos] == m_tags[kept - 1] &&
+                    m_key_equal(m_keys[pos], m_keys[kept - 1])) {
+                    continue;
+                }
+                if (pos != kept) {
+                    m_keys[kept] = m_keys[pos];
+                    m_data[kept] = m_data[pos];
+                    m_tags[kept] = m_tags[pos];
+                }
+                kept++;
+            }
+        }
+        const size_type dropped = m_keys.size() - kept;
+        m_offsets[buckets] = static_cast<uint32_t>(kept);
+        m_keys.resize(kept);
+        m_data.resize(kept);
+        m_tags.resize(kept);
+        return dropped;
+    }
+
+    // buckets hold a couple of entries, so a selection pass is cheap
+    void group_bucket(size_type first, size_type last)
+    {
+        for (size_type i = first; i + 1 < last; i++) {
+            for (size_type j = i + 1; j < last; j++) {
+                if (m_tags[j] == m_tags[i] && m_key_equal(m_keys[j], m_keys[i])) {
+                    i++;
+                    if (j != i) {
+                        std::swap(m_keys[i], m_keys[j]);
+                        std::swap(m_data[i], m_data[j]);
+                        std::swap(m_tags[i], m_tags[j]);
+                    }
+                }
+            }
+        }
+    }
+};
+
+} // namespace cmu
+
+#endif // HASH_MAP_STATIC_H_HEADER
@@ -4,10 +4,12 @@
 #include <algorithm>
 #include <functional>
 #include <istream>
+#include <iterator>
 #include <ostream>
 #include <memory>
 #include <cstddef>
 #include <cassert>
+#include <vector>
 #include "skiplist_traits.h"
 
 #ifdef SL_DEBUG
@@ -785,6 +787,9 @@ private:
 
     typename leaf_node::alloc_type m_leaf_allocator;
 
+    // leftmost and rightmost inner node of every level during a bulk build
+    std::vector<std::pair<inner_node *, inner_node *> > m_bulk_levels;
+
 public:
     explicit inline skiplist_map(const allocator_type& alloc = allocator_type())
         : m_allocator(alloc)
@@ -863,6 +868,11 @@ public:
         return m_key_less;
     }
 
+    inline value_compare value_comp() const
+    {
+        return value_compare(m_key_less);
+    }
+
     allocator_type get_allocator() const
     {
         return m_allocator;
@@ -1480,6 +1490,54 @@ public:
         return i.data();
     }
 
+    // *** Bulk Insertion
+    // Inserts a run of pairs sorted by key. As with insert(), an entry
+    // already there wins over a run pair with the same key, and so does
+    // the first of equal keys within the run. A run that is large against
+    // the skip list rebuilds it in one pass over both, a small one is
+    // inserted pair by pair. Returns the number of pairs inserted.
+    template <typename ForwardIterator>
+    size_type insert_sorted(ForwardIterator first, ForwardIterator last)
+    {
+        size_type count = static_cast<size_type>(std::distance(first, last));
+        size_type inserted = 0;
+        if (count == 0 || count < m_size / 4) {
+            for (; first != last; ++first) {
+                if (insert_common(first->first, first->second).second) {
+                    inserted++;
+                }
+            }
+            return inserted;
+        }
+
+        std::vector<pair_type> entries;
+        entries.reserve(m_size);
+        for (const_iterator i = begin(); !i.is_end(); ++i) {
+            if (!i.is_lazy_deleted()) {
+                entries.push_back(pair_type(i.key(), i.data()));
+            }
+        }
+
+        bulk_begin();
+        typename std::vector<pair_type>::const_iterator e = entries.begin();
+        while (e != entries.end() || first != last) {
+            if (first == last || (e != entries.end() && !key_less(first->first, e->first))) {
+                bulk_append(e->first, e->second);
+                ++e;
+            }
+            else {
+                // compare with the last key appended
+                if (m_size == 0 || !key_equal(m_tail_leaf->key[m_tail_leaf->count - 1], first->first)) {
+                    bulk_append(first->first, first->second);
+                    inserted++;
+                }
+                ++first;
+            }
+        }
+        bulk_end();
+        return inserted;
+    }
+
 private:
     inline void inner_shift_right(inner_node *n, short i)
     {
@@ -1536,6 +1594,9 @@ private:
             if (r->right == NULL) {
                 m_tail_leaf = r;
             }
+            else {
+                r->right->left = r;
+            }
 
             for (short i = l_order - 1; i >= l_half_order; i--) {
                 r->key[i - l_half_order] = l->key[i];
@@ -1720,6 +1781,7 @@ private:
 
         // leaf node
         leaf_node *ln = static_cast<leaf_node *>(n);
+        bool found = false;
         if (ln->right == NULL) {
             short count = ln->count - 1;
             for (i = 0; i < count; i++) {
@@ -1728,15 +1790,23 @@ private:
                 }
             }
             if (i != count && key_equal(key, ln->key[i])) {
-                return std::pair<iterator, bool>(iterator(ln, i), false);
+                found = true;
             }
         }
         else {
             for (i = 0; key_greater(key, ln->key[i]); i++);
 
             if (key_equal(key, ln->key[i])) {
-                return std::pair<iterator, bool>(iterator(ln, i), false);
+                found = true;
+            }
+        }
+        if (found) {
+            // the splits on the way down may have filled up the head, the
+            // next insert relies on a head with room for one more child
+            if (!m_head->is_leaf && m_head->count == i_order) {
+                split_head();
             }
+            return std::pair<iterator, bool>(iterator(ln, i), false);
         }
 
         // add the new key and data
@@ -1748,28 +1818,43 @@ private:
         // check if m_head needs to be split
         if (m_head->count == ((m_head->is_leaf) ? l_order : i_order)) {
             node *child = m_head;
-            node *new_child = split_node(child);
-
-            m_head = allocate_inner();
-            inner_node *head = static_cast<inner_node *>(m_head);
-            m_level++;
-            head->count = 2;
+            node *new_child = split_head();
 
-            if (child->is_leaf) {
-                head->key[0] = (static_cast<leaf_node *>(child))->key[l_half_order - 1];
-                head->key[1] = (static_cast<leaf_node *>(new_child))->key[l_order - l_half_order - 1];
+            // the new entry may have moved to the right half of the old head
+            if (child == ln && i >= l_half_order) {
+                ln = static_cast<leaf_node *>(new_child);
+                i -= l_half_order;
             }
-            else {
-                head->key[0] = (static_cast<inner_node *>(child))->key[i_half_order - 1];
-                head->key[1] = (static_cast<inner_node *>(new_child))->key[i_order - i_half_order - 1];
-            }
-            head->down[0] = child;
-            head->down[1] = new_child;
         }
 
         return std::pair<iterator, bool>(iterator(ln, i), true);
     }
 
+    // put a new head above the two halves of the full one, returns the
+    // right half
+    node *split_head()
+    {
+        node *child = m_head;
+        node *new_child = split_node(child);
+
+        m_head = allocate_inner();
+        inner_node *head = static_cast<inner_node *>(m_head);
+        m_level++;
+        head->count = 2;
+
+        if (child->is_leaf) {
+            head->key[0] = (static_cast<leaf_node *>(child))->key[l_half_order - 1];
+            head->key[1] = (static_cast<leaf_node *>(new_child))->key[l_order - l_half_order - 1];
+        }
+        else {
+            head->key[0] = (static_cast<inner_node *>(child))->key[i_half_order - 1];
+            head->key[1] = (static_cast<inner_node *>(new_child))->key[i_order - i_half_order - 1];
+        }
+        head->down[0] = child;
+        head->down[1] = new_child;
+        return new_child;
+    }
+
     bool is_valid_iterator(iterator iter)
     {
         if (NULL == iter.currnode ||
@@ -2240,6 +2325,106 @@ private:
         }
     }
 
+    // *** Bulk Build Functions
+    // rebuild the skip list entry by entry in key order; inner nodes are
+    // filled in as leaf nodes close so that bulk_end() only has to close the
+    // rightmost node of every level. The skip list must not be read between
+    // bulk_begin() and bulk_end().
+
+    void bulk_begin()
+    {
+        clear();
+        m_tail_leaf->count = 0;
+        m_bulk_levels.clear();
+    }
+
+    // key must be greater than every key appended before
+    inline void bulk_append(const key_type& key, const data_type& data)
+    {
+        leaf_node *ln = m_tail_leaf;
+        if (ln->count == l_order) {
+            leaf_node *new_ln = allocate_leaf();
+            ln->right = new_ln;
+            new_ln->left = ln;
+            m_tail_leaf = new_ln;
+            bulk_push(0, ln->key[l_order - 1], ln);
+            ln = new_ln;
+        }
+        ln->key[ln->count] = key;
+        ln->data[ln->count] = data;
+        ln->count++;
+        m_size++;
+    }
+
+    void bulk_end()
+    {
+        // placeholder for virtual max key, not counted in m_size
+        bulk_append(key_type(), data_type());
+        m_size--;
+
+        if (m_head_leaf == m_tail_leaf) {
+            m_head = m_head_leaf;
+            m_level = 0;
+            return;
+        }
+
+        bulk_push(0, m_tail_leaf->key[m_tail_leaf->count - 1], m_tail_leaf);
+        size_t level = 0;
+        while (m_bulk_levels[level].first != m_bulk_levels[level].second) {
+            inner_node *in = m_bulk_levels[level].second;
+            bulk_push(level + 1, in->key[in->count - 1], in);
+            level++;
+        }
+        m_head = m_bulk_levels[level].first;
+        m_level = level + 1;
+        m_bulk_levels.clear();
+    }
+
+    // link a closed node of the level below into the inner level
+    void bulk_push(size_t level, const key_type& key, node *n)
+    {
+        if (level == m_bulk_levels.size()) {
+            inner_node *in = allocate_inner();
+            m_bulk_levels.push_back(std::make_pair(in, in));
+        }
+        inner_node *in = m_bulk_levels[level].second;
+        if (in->count == i_order) {
+            inner_node *new_in = allocate_inner();
+            in->right = new_in;
+            m_bulk_levels[level].second = new_in;
+            bulk_push(level + 1, in->key[i_order - 1], in);
+            in = new_in;
+        }
+        in->key[in->count] = key;
+        in->down[in->count] = n;
+        in->count++;
+    }
+
+    // free up to leaves leaf nodes of a skip list that is being torn down,
+    // returns true once all nodes are freed
+    bool release_step(size_t leaves)
+    {
+        if (m_head == NULL) {
+            return true;
+        }
+        clear_inner();
+
+        leaf_node *ln = m_head_leaf;
+        for (size_t i = 0; ln != NULL && i < leaves; i++) {
+            leaf_node *tmp = ln->right;
+            free_node(ln);
+            ln = tmp;
+        }
+        m_head = m_head_leaf = ln;
+        if (ln == NULL) {
+            m_tail_leaf = NULL;
+            m_size = 0;
+            return true;
+        }
+        ln->left = NULL;
+        return false;
+    }
+
 #ifdef SL_DEBUG
 
 public:
@@ -2302,4 +2487,6 @@ public:
 
 }
 
+#undef SL_FRIENDS
+
 #endif
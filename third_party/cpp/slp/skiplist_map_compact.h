@@ -8,17 +8,14 @@
 #include <memory>
 #include <cstddef>
 #include <cassert>
+#include <vector>
 #include "bloomfilter.h"
 #include "skiplist_map.h"
-
-#define SL_MERGE 1
-#define SL_MERGE_THRESHOLD 100
-#define SL_MERGE_RATIO 10
+#include "skiplist_map_packed.h"
+#include "skiplist_merge_policy.h"
 
 #define USE_BLOOM_FILTER 1
 #define LITTLEENDIAN 1
-#define BITS_PER_KEY 8
-#define K 2
 
 namespace cmu {
 
@@ -43,6 +40,8 @@ public:
 private:
     typedef skiplist_map<key_type, data_type, key_compare, traits,
                          allocator_type> sl_type;
+    typedef skiplist_map_packed<key_type, data_type, key_compare,
+                                packed_key_codec<key_type>, allocator_type> static_type;
 
 public:
     class iterator;
@@ -67,7 +66,7 @@ public:
     private:
         bool in_dyna;
         typename sl_type::iterator d_iter;
-        typename sl_type::iterator s_iter;
+        typename static_type::iterator s_iter;
         key_compare key_less;
 
         friend class const_iterator;
@@ -103,7 +102,7 @@ public:
         }
 
     public:
-        inline iterator(bool in_dyna, typename sl_type::iterator d_iter, typename sl_type::iterator s_iter, key_compare key_less)
+        inline iterator(bool in_dyna, typename sl_type::iterator d_iter, typename static_type::iterator s_iter, key_compare key_less)
             : in_dyna(in_dyna), d_iter(d_iter), s_iter(s_iter), key_less(key_less)
         { }
 
@@ -200,7 +199,7 @@ public:
     private:
         bool in_dyna;
         typename sl_type::const_iterator d_iter;
-        typename sl_type::const_iterator s_iter;
+        typename static_type::const_iterator s_iter;
         key_compare key_less;
 
         friend class skiplist_map_compact<key_type, data_type, key_compare, traits,
@@ -235,7 +234,7 @@ public:
         }
 
     public:
-        inline const_iterator(bool in_dyna, typename sl_type::const_iterator d_iter, typename sl_type::const_iterator s_iter, key_compare key_less)
+        inline const_iterator(bool in_dyna, typename sl_type::const_iterator d_iter, typename static_type::const_iterator s_iter, key_compare key_less)
             : in_dyna(in_dyna), d_iter(d_iter), s_iter(s_iter), key_less(key_less)
         { }
 
@@ -336,7 +335,7 @@ public:
     private:
         bool in_dyna;
         typename sl_type::reverse_iterator d_iter;
-        typename sl_type::reverse_iterator s_iter;
+        typename static_type::reverse_iterator s_iter;
         key_compare key_less;
 
         friend class const_reverse_iterator;
@@ -372,7 +371,7 @@ public:
         }
 
     public:
-        inline reverse_iterator(bool in_dyna, typename sl_type::reverse_iterator d_iter, typename sl_type::reverse_iterator s_iter, key_compare key_less)
+        inline reverse_iterator(bool in_dyna, typename sl_type::reverse_iterator d_iter, typename static_type::reverse_iterator s_iter, key_compare key_less)
             : in_dyna(in_dyna), d_iter(d_iter), s_iter(s_iter), key_less(key_less)
         { }
 
@@ -469,7 +468,7 @@ public:
     private:
         bool in_dyna;
         typename sl_type::const_reverse_iterator d_iter;
-        typename sl_type::const_reverse_iterator s_iter;
+        typename static_type::const_reverse_iterator s_iter;
         key_compare key_less;
 
         friend class skiplist_map_compact<key_type, data_type, key_compare, traits,
@@ -504,7 +503,7 @@ public:
         }
 
     public:
-        inline const_reverse_iterator(bool in_dyna, typename sl_type::const_reverse_iterator d_iter, typename sl_type::const_reverse_iterator s_iter, key_compare key_less)
+        inline const_reverse_iterator(bool in_dyna, typename sl_type::const_reverse_iterator d_iter, typename static_type::const_reverse_iterator s_iter, key_compare key_less)
             : in_dyna(in_dyna), d_iter(d_iter), s_iter(s_iter), key_less(key_less)
         { }
 
@@ -590,33 +589,61 @@ public:
 
 private:
     sl_type *dyna_sl;
-    sl_type *static_sl;
+    static_type *static_sl;
     bloomfilter bf;
 
     key_compare m_key_less;
+    bloom_key_hash<key_type, key_compare> m_bloom_hash;  // follows m_key_less
     allocator_type m_allocator;
 
+    merge_policy m_policy;
+    uint64_t m_last_merge_ms;   // 0 until merge_due() has seen the clock
+    size_type m_merge_count;
+
+    // point lookups that the bloom filter kept out of the dynamic stage,
+    // that found the key there, and that searched it in vain
+    mutable size_type m_bf_skips;
+    mutable size_type m_bf_hits;
+    mutable size_type m_bf_false_positives;
+
+    // incremental merge state, the next stages are built aside in merge_sl
+    // and late_sl while dyna_sl and static_sl keep serving all operations
+    static_type *merge_sl;              // next static stage
+    sl_type *late_sl;                   // next dynamic stage, once merge_sl is built
+    bool merge_has_cursor;
+    key_type merge_cursor;              // last key copied into merge_sl
+    std::vector<key_type> merge_late;   // written at or below the cursor
+    std::vector<key_type> merge_erased; // erased at or below the cursor
+    std::vector<sl_type *> merge_retired; // replaced dynamic stages, freed step by step
+    std::vector<static_type *> merge_retired_static; // replaced static stages, freed array by array
+
 public:
     explicit inline skiplist_map_compact(const allocator_type& alloc = allocator_type())
-        : bf(LITTLEENDIAN, K, BITS_PER_KEY), m_allocator(alloc)
+        : bf(LITTLEENDIAN, merge_policy().k, merge_policy().bits_per_key), m_bloom_hash(m_key_less), m_allocator(alloc),
+          m_last_merge_ms(0), m_merge_count(0),
+          m_bf_skips(0), m_bf_hits(0), m_bf_false_positives(0),
+          merge_sl(NULL), late_sl(NULL), merge_has_cursor(false)
     {
         dyna_sl = new sl_type(alloc);
-        static_sl = new sl_type(alloc);
+        static_sl = new static_type(alloc);
 
         if (USE_BLOOM_FILTER) {
-            bf.reallocate(SL_MERGE_THRESHOLD);
+            bf.reallocate(m_policy.expected_dyna_size(0));
         }
     }
 
     explicit inline skiplist_map_compact(const key_compare& kcf,
                                  const allocator_type& alloc = allocator_type())
-        : bf(LITTLEENDIAN, K, BITS_PER_KEY), m_key_less(kcf), m_allocator(alloc)
+        : bf(LITTLEENDIAN, merge_policy().k, merge_policy().bits_per_key), m_key_less(kcf), m_bloom_hash(m_key_less), m_allocator(alloc),
+          m_last_merge_ms(0), m_merge_count(0),
+          m_bf_skips(0), m_bf_hits(0), m_bf_false_positives(0),
+          merge_sl(NULL), late_sl(NULL), merge_has_cursor(false)
     {
         dyna_sl = new sl_type(kcf, alloc);
-        static_sl = new sl_type(kcf, alloc);
+        static_sl = new static_type(kcf, alloc);
 
         if (USE_BLOOM_FILTER) {
-            bf.reallocate(SL_MERGE_THRESHOLD);
+            bf.reallocate(m_policy.expected_dyna_size(0));
         }
     }
 
@@ -624,15 +651,31 @@ public:
     {
         delete dyna_sl;
         delete static_sl;
+        merge_abort();
     }
 
     void swap(self_type &from)
     {
         std::swap(dyna_sl, from.dyna_sl);
         std::swap(static_sl, from.static_sl);
-        std::swap(bf, from.bf);
+        bf.swap(from.bf);
         std::swap(m_key_less, from.m_key_less);
+        std::swap(m_bloom_hash, from.m_bloom_hash);
         std::swap(m_allocator, from.m_allocator);
+        std::swap(m_policy, from.m_policy);
+        std::swap(m_last_merge_ms, from.m_last_merge_ms);
+        std::swap(m_merge_count, from.m_merge_count);
+        std::swap(m_bf_skips, from.m_bf_skips);
+        std::swap(m_bf_hits, from.m_bf_hits);
+        std::swap(m_bf_false_positives, from.m_bf_false_positives);
+        std::swap(merge_sl, from.merge_sl);
+        std::swap(late_sl, from.late_sl);
+        std::swap(merge_has_cursor, from.merge_has_cursor);
+        std::swap(merge_cursor, from.merge_cursor);
+        merge_late.swap(from.merge_late);
+        merge_erased.swap(from.merge_erased);
+        merge_retired.swap(from.merge_retired);
+        merge_retired_static.swap(from.merge_retired_static);
     }
 
     class value_compare
@@ -663,6 +706,11 @@ public:
         return m_key_less;
     }
 
+    inline value_compare value_comp() const
+    {
+        return value_compare(m_key_less);
+    }
+
     allocator_type get_allocator() const
     {
         return m_allocator;
@@ -706,6 +754,7 @@ public:
     // clear all nodes except the starting leaf node for empty skip list
     void clear()
     {
+        merge_abort();
         dyna_sl->clear();
         static_sl->clear();
     }
@@ -714,7 +763,7 @@ public:
     inline iterator begin()
     {
         typename sl_type::iterator dbegin = dyna_sl->begin();
-        typename sl_type::iterator sbegin = static_sl->begin();
+        typename static_type::iterator sbegin = static_sl->begin();
         if (sbegin.is_end() || dbegin.is_end()) {
             if (!sbegin.is_end()) {
                 while (!sbegin.is_end() && sbegin.is_lazy_deleted()) {
@@ -739,18 +788,18 @@ public:
 
     inline const_iterator begin() const
     {
-        return const_iterator(begin());
+        return const_iterator(const_cast<self_type*>(this)->begin());
     }
 
     inline const_iterator end() const
     {
-        return const_iterator(end());
+        return const_iterator(const_cast<self_type*>(this)->end());
     }
 
     inline reverse_iterator rbegin()
     {
         typename sl_type::reverse_iterator dbegin = dyna_sl->rbegin();
-        typename sl_type::reverse_iterator sbegin = static_sl->rbegin();
+        typename static_type::reverse_iterator sbegin = static_sl->rbegin();
         if (sbegin.is_end() || dbegin.is_end()) {
             if (!sbegin.is_end()) {
                 while (!sbegin.is_end() && sbegin.is_lazy_deleted()) {
@@ -775,12 +824,12 @@ public:
 
     inline const_reverse_iterator rbegin() const
     {
-        return const_reverse_iterator(rbegin());
+        return const_reverse_iterator(const_cast<self_type*>(this)->rbegin());
     }
 
     inline const_reverse_iterator rend() const
     {
-        return const_reverse_iterator(rend());
+        return const_reverse_iterator(const_cast<self_type*>(this)->rend());
     }
 
 public:
@@ -806,6 +855,79 @@ public:
         return bf.size();
     }
 
+    inline size_type bloomfilter_skips() const
+    {
+        return m_bf_skips;
+    }
+
+    inline size_type bloomfilter_hits() const
+    {
+        return m_bf_hits;
+    }
+
+    inline size_type bloomfilter_false_positives() const
+    {
+        return m_bf_false_positives;
+    }
+
+    inline bool is_merging() const
+    {
+        return merge_sl != NULL;
+    }
+
+    inline size_type merge_step_size() const
+    {
+        return m_policy.step;
+    }
+
+    // number of leaf nodes built per incremental merge step,
+    // 0 rebuilds the whole static stage inline when the merge triggers
+    inline void set_merge_step_size(size_type leaves)
+    {
+        m_policy.step = leaves;
+    }
+
+    inline const merge_policy& get_merge_policy() const
+    {
+        return m_policy;
+    }
+
+    // the bloom filter is rebuilt if its parameters change
+    void set_merge_policy(const merge_policy& policy)
+    {
+        bool rebuild = (policy.k != m_policy.k || policy.bits_per_key != m_policy.bits_per_key);
+        m_policy = policy;
+        if (USE_BLOOM_FILTER && rebuild) {
+            bf.configure(m_policy.k, m_policy.bits_per_key);
+            rebuild_bloomfilter();
+        }
+    }
+
+    // number of completed dynamic-to-static merges
+    inline size_type merge_count() const
+    {
+        return m_merge_count;
+    }
+
+    // bytes taken by the entries of the dynamic stage
+    inline size_type dyna_bytes() const
+    {
+        return dyna_sl->size() * (sizeof(key_type) + sizeof(data_type));
+    }
+
+    // time-based trigger of the merge policy, to be called periodically
+    // with a millisecond clock. Returns true if the dynamic stage has not
+    // been merged for the policy interval.
+    bool merge_due(uint64_t now_ms)
+    {
+        if (m_last_merge_ms == 0 || now_ms < m_last_merge_ms) {
+            m_last_merge_ms = now_ms;
+            return false;
+        }
+        return m_policy.interval_ms != 0 && !is_merging() && dyna_sl->size() != 0 &&
+               now_ms - m_last_merge_ms >= m_policy.interval_ms;
+    }
+
     inline bool empty() const
     {
         return (size() == size_type(0));
@@ -851,72 +973,106 @@ public:
 
     bool exists(const key_type& key) const
     {
-        return (find(key) != end());
+        if (!USE_BLOOM_FILTER || (dyna_sl->size() != 0 && bf.hash_may_match(m_bloom_hash(key)))) {
+            bool found = dyna_sl->exists(key);
+            count_dyna_probe(found);
+            if (found) {
+                return true;
+            }
+        }
+        else {
+            m_bf_skips++;
+        }
+
+        typename static_type::const_iterator it = static_sl->find(key);
+        return !it.is_end() && !it.is_lazy_deleted();
     }
 
     iterator find(const key_type& key)
     {
         typename sl_type::iterator it;
+        typename static_type::iterator s_it;
         SL_PRINT("finding " << key);
         if (USE_BLOOM_FILTER) {
-            if (dyna_sl->size() == 0 || !bf.key_may_match(reinterpret_cast<const char*>(&key), sizeof(key_type))) {
+            if (dyna_sl->size() == 0 || !bf.hash_may_match(m_bloom_hash(key))) {
                 SL_PRINT("shortcut by bloomfilter");
-                it = static_sl->find(key);
-                if (!it.is_end() && !it.is_lazy_deleted()) {
+                m_bf_skips++;
+                s_it = static_sl->find(key);
+                if (!s_it.is_end() && !s_it.is_lazy_deleted()) {
                     // NOTE incomplete iterator
-                    return iterator(false, typename sl_type::iterator(), it, m_key_less);
+                    return iterator(false, typename sl_type::iterator(), s_it, m_key_less);
                 }
                 return end();
             }
         }
 
         it = dyna_sl->find(key);
+        count_dyna_probe(!it.is_end());
         if (it.is_end()) {
-            it = static_sl->find(key);
-            if (!it.is_end() && !it.is_lazy_deleted()) {
+            s_it = static_sl->find(key);
+            if (!s_it.is_end() && !s_it.is_lazy_deleted()) {
                 // NOTE incomplete iterator
-                return iterator(false, typename sl_type::iterator(), it, m_key_less);
+                return iterator(false, typename sl_type::iterator(), s_it, m_key_less);
             }
             return end();
         }
         // NOTE incomplete iterator
-        return iterator(true, it, typename sl_type::iterator(), m_key_less);
+        return iterator(true, it, typename static_type::iterator(), m_key_less);
     }
 
     const_iterator find(const key_type& key) const
     {
         typename sl_type::const_iterator it;
+        typename static_type::const_iterator s_it;
         SL_PRINT("finding " << key);
         if (USE_BLOOM_FILTER) {
-            if (dyna_sl->size() == 0 || !bf.key_may_match(reinterpret_cast<const char*>(&key), sizeof(key_type))) {
+            if (dyna_sl->size() == 0 || !bf.hash_may_match(m_bloom_hash(key))) {
                 SL_PRINT("shortcut by bloomfilter");
-                it = static_sl->find(key);
-                if (!it.is_end() && !it.is_lazy_deleted()) {
+                m_bf_skips++;
+                s_it = static_sl->find(key);
+                if (!s_it.is_end() && !s_it.is_lazy_deleted()) {
                     // NOTE incomplete iterator
-                    return const_iterator(false, typename sl_type::const_iterator(), it, m_key_less);
+                    return const_iterator(false, typename sl_type::const_iterator(), s_it, m_key_less);
                 }
                 return end();
             }
         }
 
         it = dyna_sl->find(key);
+        count_dyna_probe(!it.is_end());
         if (it.is_end()) {
-            it = static_sl->find(key);
-            if (!it.is_end() && !it.is_lazy_deleted()) {
+            s_it = static_sl->find(key);
+            if (!s_it.is_end() && !s_it.is_lazy_deleted()) {
                 // NOTE incomplete iterator
-                return const_iterator(false, typename sl_type::const_iterator(), it, m_key_less);
+                return const_iterator(false, typename sl_type::const_iterator(), s_it, m_key_less);
             }
             return end();
         }
         // NOTE incomplete iterator
-        return const_iterator(true, it, typename sl_type::const_iterator(), m_key_less);
+        return const_iterator(true, it, typename static_type::const_iterator(), m_key_less);
     }
 
+private:
+    // a point lookup searched the dynamic stage after the bloom filter
+    // could not rule the key out
+    inline void count_dyna_probe(bool found) const
+    {
+        if (USE_BLOOM_FILTER) {
+            if (found) {
+                m_bf_hits++;
+            }
+            else {
+                m_bf_false_positives++;
+            }
+        }
+    }
+
+public:
     void make_iter_complete(iterator& it)
     {
         if (it.in_dyna) {
             key_type key = it.d_iter.key();
-            typename sl_type::iterator s_iter = static_sl->upper_bound(key);
+            typename static_type::iterator s_iter = static_sl->upper_bound(key);
             while (!s_iter.is_end() && s_iter.is_lazy_deleted()) {
                 ++s_iter;
             }
@@ -932,7 +1088,7 @@ public:
     {
         if (it.in_dyna) {
             key_type key = it.d_iter.key();
-            typename sl_type::iterator s_iter = static_sl->upper_bound(key);
+            typename static_type::iterator s_iter = static_sl->upper_bound(key);
             while (!s_iter.is_end() && s_iter.is_lazy_deleted()) {
                 ++s_iter;
             }
@@ -952,7 +1108,7 @@ public:
     iterator lower_bound(const key_type& key)
     {
         typename sl_type::iterator dyna_it = dyna_sl->lower_bound(key);
-        typename sl_type::iterator static_it = static_sl->lower_bound(key);
+        typename static_type::iterator static_it = static_sl->lower_bound(key);
 
         // NOTE skip deleted entries in static stage
         while (!static_it.is_end() && static_it.is_lazy_deleted()) {
@@ -988,7 +1144,7 @@ public:
     const_iterator lower_bound(const key_type& key) const
     {
         typename sl_type::const_iterator dyna_it = dyna_sl->lower_bound(key);
-        typename sl_type::const_iterator static_it = static_sl->lower_bound(key);
+        typename static_type::const_iterator static_it = static_sl->lower_bound(key);
 
         // NOTE skip deleted entries in static stage
         while (!static_it.is_end() && static_it.is_lazy_deleted()) {
@@ -1024,7 +1180,7 @@ public:
     iterator upper_bound(const key_type& key)
     {
         typename sl_type::iterator dyna_it = dyna_sl->upper_bound(key);
-        typename sl_type::iterator static_it = static_sl->upper_bound(key);
+        typename static_type::iterator static_it = static_sl->upper_bound(key);
 
         // NOTE skip deleted entries in static stage
         while (!static_it.is_end() && static_it.is_lazy_deleted()) {
@@ -1060,7 +1216,7 @@ public:
     const_iterator upper_bound(const key_type& key) const
     {
         typename sl_type::const_iterator dyna_it = dyna_sl->upper_bound(key);
-        typename sl_type::const_iterator static_it = static_sl->upper_bound(key);
+        typename static_type::const_iterator static_it = static_sl->upper_bound(key);
 
         // NOTE skip deleted entries in static stage
         while (!static_it.is_end() && static_it.is_lazy_deleted()) {
@@ -1133,27 +1289,17 @@ public:
 
     inline std::pair<iterator, bool> upsert(const pair_type& x)
     {
-        if ((SL_MERGE == 1) &&
-            ((dyna_sl->size() * SL_MERGE_RATIO) >= static_sl->size()) &&
-            (dyna_sl->size() >= SL_MERGE_THRESHOLD))
-        {
-            merge_dtos();
-        }
+        merge_if_needed();
 
         return insert_common(x.first, x.second);
     }
 
     inline std::pair<iterator, bool> insert(const key_type& key, const data_type& data)
     {
-        if ((SL_MERGE == 1) &&
-            ((dyna_sl->size() * SL_MERGE_RATIO) >= static_sl->size()) &&
-            (dyna_sl->size() >= SL_MERGE_THRESHOLD))
-        {
-            merge_dtos();
-        }
+        merge_if_needed();
 
-        typename sl_type::iterator static_iter = static_sl->find(key);
-        if (!static_iter.is_end()) {
+        typename static_type::iterator static_iter = static_sl->find(key);
+        if (!static_iter.is_end() && !static_iter.is_lazy_deleted()) {
             // NOTE incomplete iterator
             return std::pair<iterator, bool>(iterator(false, typename sl_type::iterator(), static_iter, m_key_less), false);
         }
@@ -1167,15 +1313,145 @@ public:
         return i.data();
     }
 
+    // *** Bulk Insertion
+    // Inserts a run of pairs sorted by key. As with insert(), an entry
+    // already there wins over a run pair with the same key, and so does
+    // the first of equal keys within the run. A run that is large against
+    // the skip list goes straight into a new static stage, built in one
+    // pass over both stages and the run, and leaves the dynamic stage
+    // empty; a small one is inserted pair by pair. Returns the number of
+    // pairs inserted.
+    template <typename ForwardIterator>
+    size_type insert_sorted(ForwardIterator first, ForwardIterator last)
+    {
+        size_type count = static_cast<size_type>(std::distance(first, last));
+        size_type inserted = 0;
+        if (count == 0 || count < size() / 4) {
+            for (; first != last; ++first) {
+                if (insert(first->first, first->second).second) {
+                    inserted++;
+                }
+            }
+            return inserted;
+        }
+
+        // finish a running merge, the stages it leaves are the ones merged
+        merge_step(0);
+
+        static_type *merged = new static_type(m_key_less, m_allocator);
+        merged->bulk_begin(size() + count, static_sl);
+        typename sl_type::iterator d_iter = dyna_sl->begin();
+        typename static_type::iterator s_iter = static_sl->begin();
+        bool appended = false;
+        key_type last_key = key_type();
+        for (;;) {
+            while (!s_iter.is_end() && s_iter.is_lazy_deleted()) {
+                ++s_iter;
+            }
+            bool d_end = d_iter.is_end();
+            bool s_end = s_iter.is_end();
+            if (d_end && s_end && first == last) {
+                break;
+            }
+
+            // the next entry already there, dynamic stage entries shadow
+            // static stage entries
+            bool in_dyna = !d_end && (s_end || key_lessequal(d_iter.key(), s_iter.key()));
+            if (!(d_end && s_end) &&
+                (first == last || !key_less(first->first, in_dyna ? d_iter.key() : s_iter.key()))) {
+                if (in_dyna) {
+                    if (!s_end && key_equal(d_iter.key(), s_iter.key())) {
+                        ++s_iter;
+                    }
+                    merged->bulk_append(d_iter.key(), d_iter.data());
+                    last_key = d_iter.key();
+                    ++d_iter;
+                }
+                else {
+                    merged->bulk_append(s_iter.key(), s_iter.data());
+                    last_key = s_iter.key();
+                    ++s_iter;
+                }
+                appended = true;
+            }
+            else {
+                if (!appended || !key_equal(last_key, first->first)) {
+                    merged->bulk_append(first->first, first->second);
+                    last_key = first->first;
+                    appended = true;
+                    inserted++;
+                }
+                ++first;
+            }
+        }
+        merged->bulk_end();
+
+        delete static_sl;
+        static_sl = merged;
+        dyna_sl->clear();
+        m_merge_count++;
+        m_last_merge_ms = 0;
+
+        if (USE_BLOOM_FILTER) {
+            rebuild_bloomfilter();
+        }
+        return inserted;
+    }
+
 private:
+    inline void merge_if_needed()
+    {
+        if ((merge_sl == NULL) &&
+            m_policy.should_merge(dyna_sl->size(), static_sl->size(), dyna_bytes()))
+        {
+            if (m_policy.step == 0) {
+                merge_dtos();
+                return;
+            }
+            merge_begin();
+        }
+
+        if (merge_sl != NULL || !merge_retired.empty() || !merge_retired_static.empty()) {
+            merge_step(m_policy.step);
+        }
+    }
+
+    // true if key has already been passed by the merge cursor, so changes
+    // to it are not picked up by the copy and must be replayed
+    inline bool merge_passed(const key_type& key) const
+    {
+        return merge_sl != NULL &&
+               (late_sl != NULL || (merge_has_cursor && !key_less(merge_cursor, key)));
+    }
+
+    inline void merge_note_erase(const key_type& key)
+    {
+        if (merge_passed(key)) {
+            merge_erased.push_back(key);
+            if (late_sl != NULL) {
+                late_sl->erase_one(key);
+            }
+        }
+    }
+
     inline std::pair<iterator, bool> insert_common(const key_type& key, const data_type& data)
     {
+        if (merge_passed(key)) {
+            merge_late.push_back(key);
+        }
+
         std::pair<typename sl_type::iterator, bool> dyna_retval = dyna_sl->insert_common(key, data);
         // NOTE incomplete iterator
-        std::pair<iterator, bool> retval = std::pair<iterator, bool>(iterator(true, dyna_retval.first, typename sl_type::iterator(), m_key_less), dyna_retval.second);
+        std::pair<iterator, bool> retval = std::pair<iterator, bool>(iterator(true, dyna_retval.first, typename static_type::iterator(), m_key_less), dyna_retval.second);
 
         if (USE_BLOOM_FILTER) {
-            bf.insert(reinterpret_cast<const char*>(&key), sizeof(key_type));
+            if (dyna_sl->size() > bf.capacity()) {
+                // outgrown, e.g. with the ratio trigger disabled
+                rebuild_bloomfilter();
+            }
+            else {
+                bf.insert_hash(m_bloom_hash(key));
+            }
         }
 
         return retval;
@@ -1186,8 +1462,10 @@ public:
 
     bool erase_one(const key_type& key)
     {
+        merge_note_erase(key);
+
         if (USE_BLOOM_FILTER) {
-            if (dyna_sl->size() == 0 || !bf.key_may_match(reinterpret_cast<const char*>(&key), sizeof(key_type))) {
+            if (dyna_sl->size() == 0 || !bf.hash_may_match(m_bloom_hash(key))) {
                 return static_sl->lazy_erase_one(key);
             }
         }
@@ -1216,6 +1494,8 @@ public:
 
     void erase(iterator iter)
     {
+        merge_note_erase(iter.key());
+
         if (iter.in_dyna) {
             dyna_sl->erase(iter.d_iter);
         }
@@ -1226,6 +1506,8 @@ public:
 
     void erase(reverse_iterator iter)
     {
+        merge_note_erase(iter.key());
+
         if (iter.in_dyna) {
             dyna_sl->erase(iter.d_iter);
         }
@@ -1238,13 +1520,201 @@ public:
 public:
     void merge_dtos()
     {
+        if (merge_sl != NULL) {
+            merge_step(0);
+            return;
+        }
+
         static_sl->merge(*dyna_sl);
+        m_merge_count++;
+        m_last_merge_ms = 0;
 
         if (USE_BLOOM_FILTER) {
-            bf.reallocate(static_sl->size() / SL_MERGE_RATIO);
+            rebuild_bloomfilter();
         }
     }
 
+public:
+    // *** Incremental Merge
+    // The next static stage is built aside by copying dyna_sl and static_sl
+    // in key order, a bounded number of leaf nodes per step. Both stages stay
+    // authoritative for lookups and iterators until a step swaps the new
+    // stages in, so only the write paths need to know about the cursor:
+    // writes to keys the cursor has passed are recorded and replayed onto
+    // the new stages before the swap. The replaced dynamic stage is freed
+    // in the steps after the swap.
+
+    void merge_begin()
+    {
+        if (merge_sl != NULL) {
+            return;
+        }
+        merge_sl = new static_type(m_key_less, m_allocator);
+        // reserved for the entries there are now and for the keys inserted
+        // ahead of the cursor until the copy is done, at most one per step
+        // of the inserts, so that the arrays are not copied as they grow
+        size_type expected = static_sl->size() + dyna_sl->size();
+        if (m_policy.step != 0) {
+            expected += expected / (m_policy.step * sl_type::l_order) + 1;
+        }
+        merge_sl->bulk_begin(expected, static_sl);
+        merge_has_cursor = false;
+    }
+
+    // do up to leaves leaf nodes worth of merge work (0 means all of it),
+    // returns true while the merge still has work left
+    bool merge_step(size_type leaves)
+    {
+        size_type budget = leaves * sl_type::l_order;
+        size_type done = 0;
+
+        if (merge_sl != NULL && late_sl == NULL) {
+            // re-seek every step, writes since the last step may have split
+            // or concatenated nodes under the previous position
+            typename sl_type::iterator d_iter = merge_has_cursor ? dyna_sl->upper_bound(merge_cursor) : dyna_sl->begin();
+            typename static_type::iterator s_iter = merge_has_cursor ? static_sl->upper_bound(merge_cursor) : static_sl->begin();
+
+            for (; leaves == 0 || done < budget; done++) {
+                while (!s_iter.is_end() && s_iter.is_lazy_deleted()) {
+                    ++s_iter;
+                }
+                bool d_end = d_iter.is_end();
+                bool s_end = s_iter.is_end();
+                if (d_end && s_end) {
+                    merge_sl->bulk_end(leaves == 0);
+                    late_sl = new sl_type(m_key_less, m_allocator);
+                    break;
+                }
+
+                // dynamic stage entries shadow static stage entries
+                if (s_end || (!d_end && key_lessequal(d_iter.key(), s_iter.key()))) {
+                    if (!s_end && key_equal(d_iter.key(), s_iter.key())) {
+                        ++s_iter;
+                    }
+                    merge_sl->bulk_append(d_iter.key(), d_iter.data());
+                    merge_cursor = d_iter.key();
+                    ++d_iter;
+                }
+                else {
+                    merge_sl->bulk_append(s_iter.key(), s_iter.data());
+                    merge_cursor = s_iter.key();
+                    ++s_iter;
+                }
+                merge_has_cursor = true;
+            }
+        }
+
+        if (late_sl != NULL) {
+            for (; leaves == 0 || done < budget; done++) {
+                if (!merge_erased.empty()) {
+                    merge_sl->lazy_erase_one(merge_erased.back());
+                    merge_erased.pop_back();
+                }
+                else if (!merge_late.empty()) {
+                    merge_replay(merge_late.back());
+                    merge_late.pop_back();
+                }
+                else {
+                    merge_swap();
+                    break;
+                }
+            }
+        }
+
+        if (merge_sl == NULL) {
+            // a static stage gives back one array per step
+            while (!merge_retired_static.empty()) {
+                if (merge_retired_static.back()->release_step(leaves)) {
+                    delete merge_retired_static.back();
+                    merge_retired_static.pop_back();
+                }
+                if (leaves != 0) {
+                    break;
+                }
+            }
+            while (!merge_retired.empty() && (leaves == 0 || done < budget)) {
+                if (!merge_retired.back()->release_step(leaves == 0 ? size_type(-1) : leaves)) {
+                    break;
+                }
+                delete merge_retired.back();
+                merge_retired.pop_back();
+            }
+        }
+
+        return merge_sl != NULL || !merge_retired.empty() || !merge_retired_static.empty();
+    }
+
+private:
+    // bring the next stages up to date with the live ones for a key
+    // written after the cursor passed it. A key the copy already put into
+    // the next static stage gets the live data there, so that it is not
+    // counted in both of the next stages.
+    void merge_replay(const key_type& key)
+    {
+        typename sl_type::iterator it = dyna_sl->find(key);
+        if (it.is_end()) {
+            late_sl->erase_one(key);
+            return;
+        }
+        typename static_type::iterator s_it = merge_sl->find(key);
+        if (!s_it.is_end() && !s_it.is_lazy_deleted()) {
+            s_it.data() = it.data();
+            late_sl->erase_one(key);
+            return;
+        }
+        std::pair<typename sl_type::iterator, bool> retval = late_sl->insert_common(key, it.data());
+        if (!retval.second) {
+            retval.first.data() = it.data();
+        }
+    }
+
+    void merge_swap()
+    {
+        merge_retired.push_back(dyna_sl);
+        merge_retired_static.push_back(static_sl);
+        dyna_sl = late_sl;
+        static_sl = merge_sl;
+        late_sl = NULL;
+        merge_sl = NULL;
+        merge_has_cursor = false;
+        m_merge_count++;
+        m_last_merge_ms = 0;
+
+        if (USE_BLOOM_FILTER) {
+            rebuild_bloomfilter();
+        }
+    }
+
+    // size the bloom filter for the dynamic stage it covers until the next
+    // merge, and fill it with the entries already there
+    void rebuild_bloomfilter()
+    {
+        bf.reallocate(std::max(m_policy.expected_dyna_size(static_sl->size()), 2 * dyna_sl->size()));
+        for (typename sl_type::iterator it = dyna_sl->begin(); !it.is_end(); ++it) {
+            bf.insert_hash(m_bloom_hash(it.key()));
+        }
+    }
+
+    void merge_abort()
+    {
+        delete merge_sl;
+        delete late_sl;
+        merge_sl = NULL;
+        late_sl = NULL;
+        merge_has_cursor = false;
+        merge_late.clear();
+        merge_erased.clear();
+        for (size_t i = 0; i < merge_retired.size(); i++) {
+            delete merge_retired[i];
+        }
+        merge_retired.clear();
+        for (size_t i = 0; i < merge_retired_static.size(); i++) {
+            delete merge_retired_static[i];
+        }
+        merge_retired_static.clear();
+    }
+
+public:
 #ifdef SL_DEBUG
 
 public:
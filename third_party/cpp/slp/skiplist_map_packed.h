@@ -0,0 +1,1197 @@
+#ifndef SKIPLIST_MAP_PACKED_H_HEADER
+#define SKIPLIST_MAP_PACKED_H_HEADER
+
+#include <algorithm>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <memory>
+#include <cstddef>
+#include <cstring>
+#include <cassert>
+#include <vector>
+#include <stdint.h>
+
+#ifdef SL_DEBUG
+#include <iostream>
+#include <iomanip>
+#endif
+
+namespace cmu {
+
+inline void packed_store_be64(uint64_t v, unsigned char *bytes)
+{
+    for (int i = 7; i >= 0; i--) {
+        bytes[i] = static_cast<unsigned char>(v);
+        v >>= 8;
+    }
+}
+
+inline uint64_t packed_load_be64(const unsigned char *bytes)
+{
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) {
+        v = (v << 8) | bytes[i];
+    }
+    return v;
+}
+
+// Byte image of a key in the packed static stage. Every key is stored as
+// the bytes it shares with the image of the key before it plus the rest
+// up to its last non-zero byte, so the image should put the bytes that
+// vary least between neighbouring keys first. Raw bytes by default, which
+// suits padded keys like GenericKey; integer keys are stored big-endian.
+template <typename Key>
+struct packed_key_codec
+{
+    static const size_t size = sizeof(Key);
+
+    static inline void encode(const Key& key, unsigned char *bytes)
+    {
+        memcpy(bytes, &key, sizeof(Key));
+    }
+
+    static inline void decode(const unsigned char *bytes, Key& key)
+    {
+        memcpy(&key, bytes, sizeof(Key));
+    }
+};
+
+template <> struct packed_key_codec<uint64_t>
+{
+    static const size_t size = 8;
+    static inline void encode(uint64_t key, unsigned char *bytes) { packed_store_be64(key, bytes); }
+    static inline void decode(const unsigned char *bytes, uint64_t& key) { key = packed_load_be64(bytes); }
+};
+
+template <> struct packed_key_codec<int64_t>
+{
+    static const size_t size = 8;
+    static inline void encode(int64_t key, unsigned char *bytes) { packed_store_be64(static_cast<uint64_t>(key), bytes); }
+    static inline void decode(const unsigned char *bytes, int64_t& key) { key = static_cast<int64_t>(packed_load_be64(bytes)); }
+};
+
+template <> struct packed_key_codec<uint32_t>
+{
+    static const size_t size = 4;
+    static inline void encode(uint32_t key, unsigned char *bytes)
+    {
+        unsigned char tmp[8];
+        packed_store_be64(key, tmp);
+        memcpy(bytes, tmp + 4, 4);
+    }
+    static inline void decode(const unsigned char *bytes, uint32_t& key)
+    {
+        key = (static_cast<uint32_t>(bytes[0]) << 24) | (static_cast<uint32_t>(bytes[1]) << 16) |
+              (static_cast<uint32_t>(bytes[2]) << 8) | static_cast<uint32_t>(bytes[3]);
+    }
+};
+
+template <> struct packed_key_codec<int32_t>
+{
+    static const size_t size = 4;
+    static inline void encode(int32_t key, unsigned char *bytes)
+    {
+        packed_key_codec<uint32_t>::encode(static_cast<uint32_t>(key), bytes);
+    }
+    static inline void decode(const unsigned char *bytes, int32_t& key)
+    {
+        uint32_t v;
+        packed_key_codec<uint32_t>::decode(bytes, v);
+        key = static_cast<int32_t>(v);
+    }
+};
+
+// Read-optimized static stage of the compact skip list map. Entries live
+// in blocks of block_order in key order: the first key of every block is
+// kept whole in a dense fence array that lookups binary search, the other
+// keys are front coded against their predecessor in one byte stream, and
+// data stays uncompressed so that data() can hand out references and a
+// data value of 0 still marks a lazily deleted entry. The map is built
+// with the bulk functions or merge() and is read-only otherwise, except
+// for lazy deletes.
+template <typename _Key, typename _Data,
+          typename _Compare = std::less<_Key>,
+          typename _Codec = packed_key_codec<_Key>,
+          typename _Alloc = std::allocator<std::pair<_Key, _Data> > >
+class skiplist_map_packed
+{
+public:
+    typedef _Key key_type;
+    typedef _Data data_type;
+    typedef _Compare key_compare;
+    typedef _Codec codec;
+    typedef _Alloc allocator_type;
+    typedef std::pair<key_type, data_type> value_type;
+    typedef std::pair<key_type, data_type> pair_type;
+    typedef size_t size_type;
+    typedef skiplist_map_packed<key_type, data_type, key_compare, codec,
+                                allocator_type> self_type;
+
+    static const size_type block_order = 16;
+
+private:
+    static const size_type npos = size_type(-1);
+    static const size_t image_size = codec::size;
+
+    typedef typename _Alloc::template rebind<key_type>::other key_alloc_type;
+    typedef typename _Alloc::template rebind<data_type>::other data_alloc_type;
+    typedef typename _Alloc::template rebind<size_t>::other offset_alloc_type;
+    typedef typename _Alloc::template rebind<unsigned char>::other byte_alloc_type;
+
+    std::vector<key_type, key_alloc_type> m_fence;          // first key of every block
+    std::vector<size_t, offset_alloc_type> m_offsets;      // where the second key of every block starts
+    std::vector<unsigned char, byte_alloc_type> m_bytes;    // front coded keys
+    std::vector<data_type, data_alloc_type> m_data;         // one per entry, lazily deleted ones included
+
+    size_type m_size;                       // live entries
+    unsigned char m_last[image_size];       // image of the last key appended
+    key_compare m_key_less;
+    allocator_type m_allocator;
+
+public:
+    class iterator;
+    class const_iterator;
+    class reverse_iterator;
+    class const_reverse_iterator;
+
+private:
+    // position shared by all iterators: an entry index and, for entries
+    // before end(), the decoded key and where the next key of the block is
+    class cursor {
+    protected:
+        self_type *map;
+        size_type entry;
+        size_t pos;
+        key_type curr_key;
+
+        friend class skiplist_map_packed<key_type, data_type, key_compare, codec,
+                                         allocator_type>;
+
+        inline cursor()
+            : map(NULL), entry(0), pos(0), curr_key()
+        { }
+
+        inline cursor(self_type *map, size_type entry)
+            : map(map), entry(entry), pos(0), curr_key()
+        {
+            if (map != NULL && entry < map->m_data.size()) {
+                map->seek(entry, pos, curr_key);
+            }
+        }
+
+        inline cursor(self_type *map, size_type entry, size_t pos, const key_type& key)
+            : map(map), entry(entry), pos(pos), curr_key(key)
+        { }
+
+        inline void next()
+        {
+            if (entry >= map->m_data.size()) {
+                return;
+            }
+            entry++;
+            if (entry == map->m_data.size()) {
+                return;
+            }
+            if (entry % block_order == 0) {
+                pos = map->m_offsets[entry / block_order];
+                curr_key = map->m_fence[entry / block_order];
+            }
+            else {
+                map->step(pos, curr_key);
+            }
+        }
+
+        inline void prev()
+        {
+            if (entry > 0 && entry != npos) {
+                entry--;
+                map->seek(entry, pos, curr_key);
+            }
+        }
+
+        // the moves of reverse iterators, npos is before the first entry
+        inline void move_back()
+        {
+            if (entry == 0) {
+                entry = npos;
+            }
+            else {
+                prev();
+            }
+        }
+
+        inline void move_ahead()
+        {
+            if (entry == npos) {
+                if (at(0)) {
+                    entry = 0;
+                    map->seek(0, pos, curr_key);
+                }
+            }
+            else if (at(entry + 1)) {
+                next();
+            }
+        }
+
+        inline bool at(size_type e) const
+        {
+            return map != NULL && e < map->m_data.size();
+        }
+
+        inline data_type& entry_data() const
+        {
+            return map->m_data[entry];
+        }
+    };
+
+public:
+    class iterator : public cursor {
+    public:
+        typedef typename skiplist_map_packed::key_type key_type;
+        typedef typename skiplist_map_packed::data_type data_type;
+        typedef typename skiplist_map_packed::value_type value_type;
+        typedef value_type& reference;
+        typedef value_type* pointer;
+
+        /// STL-magic iterator category
+        typedef std::bidirectional_iterator_tag iterator_category;
+
+        /// STL-magic
+        typedef ptrdiff_t difference_type;
+
+    private:
+        mutable value_type temp_value;
+
+        friend class skiplist_map_packed<key_type, data_type, key_compare, codec,
+                                         allocator_type>;
+
+        inline iterator(const cursor& c)
+            : cursor(c)
+        { }
+
+    public:
+        inline iterator()
+            : cursor()
+        { }
+
+        inline reference operator * () const
+        {
+            temp_value = value_type(key(), data());
+            return temp_value;
+        }
+
+        inline pointer operator -> () const
+        {
+            temp_value = value_type(key(), data());
+            return &temp_value;
+        }
+
+        inline const key_type& key() const
+        {
+            return this->curr_key;
+        }
+
+        inline data_type& data() const
+        {
+            return this->entry_data();
+        }
+
+        inline iterator& operator ++ ()
+        {
+            this->next();
+            return *this;
+        }
+
+        inline iterator operator ++ (int)
+        {
+            iterator tmp = *this;
+            this->next();
+            return tmp;
+        }
+
+        inline iterator& operator -- ()
+        {
+            this->prev();
+            return *this;
+        }
+
+        inline iterator operator -- (int)
+        {
+            iterator tmp = *this;
+            this->prev();
+            return tmp;
+        }
+
+        inline bool operator == (const iterator &x) const
+        {
+            return (x.map == this->map && x.entry == this->entry);
+        }
+
+        inline bool operator != (const iterator &x) const
+        {
+            return (x.map != this->map || x.entry != this->entry);
+        }
+
+        inline bool is_invalid() const
+        {
+            return this->map == NULL;
+        }
+
+        inline bool is_end() const
+        {
+            return !this->at(this->entry);
+        }
+
+        inline bool is_lazy_deleted() const
+        {
+            return data() == (data_type)0;
+        }
+
+        inline void lazy_delete()
+        {
+            data() = (data_type)0;
+        }
+    };
+
+    class const_iterator : public cursor {
+    public:
+        typedef typename skiplist_map_packed::key_type key_type;
+        typedef typename skiplist_map_packed::data_type data_type;
+        typedef typename skiplist_map_packed::value_type value_type;
+        typedef const value_type& reference;
+        typedef const value_type* pointer;
+
+        /// STL-magic iterator category
+        typedef std::bidirectional_iterator_tag iterator_category;
+
+        /// STL-magic
+        typedef ptrdiff_t difference_type;
+
+    private:
+        mutable value_type temp_value;
+
+        friend class skiplist_map_packed<key_type, data_type, key_compare, codec,
+                                         allocator_type>;
+
+        inline const_iterator(const cursor& c)
+            : cursor(c)
+        { }
+
+    public:
+        inline const_iterator()
+            : cursor()
+        { }
+
+        inline const_iterator(const iterator& it)
+            : cursor(it)
+        { }
+
+        inline reference operator * () const
+        {
+            temp_value = value_type(key(), data());
+            return temp_value;
+        }
+
+        inline pointer operator -> () const
+        {
+            temp_value = value_type(key(), data());
+            return &temp_value;
+        }
+
+        inline const key_type& key() const
+        {
+            return this->curr_key;
+        }
+
+        inline const data_type& data() const
+        {
+            return this->entry_data();
+        }
+
+        inline const_iterator& operator ++ ()
+        {
+            this->next();
+            return *this;
+        }
+
+        inline const_iterator operator ++ (int)
+        {
+            const_iterator tmp = *this;
+            this->next();
+            return tmp;
+        }
+
+        inline const_iterator& operator -- ()
+        {
+            this->prev();
+            return *this;
+        }
+
+        inline const_iterator operator -- (int)
+        {
+            const_iterator tmp = *this;
+            this->prev();
+            return tmp;
+        }
+
+        inline bool operator == (const const_iterator &x) const
+        {
+            return (x.map == this->map && x.entry == this->entry);
+        }
+
+        inline bool operator != (const const_iterator &x) const
+        {
+            return (x.map != this->map || x.entry != this->entry);
+        }
+
+        inline bool is_invalid() const
+        {
+            return this->map == NULL;
+        }
+
+        inline bool is_end() const
+        {
+            return !this->at(this->entry);
+        }
+
+        inline bool is_lazy_deleted() const
+        {
+            return data() == (data_type)0;
+        }
+    };
+
+    // reverse iterators stand on the entry they return, rend() is before
+    // the first entry
+    class reverse_iterator : public cursor {
+    public:
+        typedef typename skiplist_map_packed::key_type key_type;
+        typedef typename skiplist_map_packed::data_type data_type;
+        typedef typename skiplist_map_packed::value_type value_type;
+        typedef value_type& reference;
+        typedef value_type* pointer;
+
+        /// STL-magic iterator category
+        typedef std::bidirectional_iterator_tag iterator_category;
+
+        /// STL-magic
+        typedef ptrdiff_t difference_type;
+
+    private:
+        mutable value_type temp_value;
+
+        friend class skiplist_map_packed<key_type, data_type, key_compare, codec,
+                                         allocator_type>;
+
+        inline reverse_iterator(const cursor& c)
+            : cursor(c)
+        { }
+
+    public:
+        inline reverse_iterator()
+            : cursor()
+        { }
+
+        // the entry before it, like std::reverse_iterator
+        inline explicit reverse_iterator(const iterator& it)
+            : cursor(it.map, it.entry == 0 ? npos : it.entry - 1)
+        { }
+
+        inline reference operator * () const
+        {
+            temp_value = value_type(key(), data());
+            return temp_value;
+        }
+
+        inline pointer operator -> () const
+        {
+            temp_value = value_type(key(), data());
+            return &temp_value;
+        }
+
+        inline const key_type& key() const
+        {
+            return this->curr_key;
+        }
+
+        inline data_type& data() const
+        {
+            return this->entry_data();
+        }
+
+        inline reverse_iterator& operator ++ ()
+        {
+            this->move_back();
+            return *this;
+        }
+
+        inline reverse_iterator operator ++ (int)
+        {
+            reverse_iterator tmp = *this;
+            this->move_back();
+            return tmp;
+        }
+
+        inline reverse_iterator& operator -- ()
+        {
+            this->move_ahead();
+            return *this;
+        }
+
+        inline reverse_iterator operator -- (int)
+        {
+            reverse_iterator tmp = *this;
+            this->move_ahead();
+            return tmp;
+        }
+
+        inline bool operator == (const reverse_iterator &x) const
+        {
+            return (x.map == this->map && x.entry == this->entry);
+        }
+
+        inline bool operator != (const reverse_iterator &x) const
+        {
+            return (x.map != this->map || x.entry != this->entry);
+        }
+
+        inline bool is_invalid() const
+        {
+            return this->map == NULL;
+        }
+
+        inline bool is_end() const
+        {
+            return !this->at(this->entry);
+        }
+
+        inline bool is_lazy_deleted() const
+        {
+            return data() == (data_type)0;
+        }
+
+        inline void lazy_delete()
+        {
+            data() = (data_type)0;
+        }
+    };
+
+    class const_reverse_iterator : public cursor {
+    public:
+        typedef typename skiplist_map_packed::key_type key_type;
+        typedef typename skiplist_map_packed::data_type data_type;
+        typedef typename skiplist_map_packed::value_type value_type;
+        typedef const value_type& reference;
+        typedef const value_type* pointer;
+
+        /// STL-magic iterator category
+        typedef std::bidirectional_iterator_tag iterator_category;
+
+        /// STL-magic
+        typedef ptrdiff_t difference_type;
+
+    private:
+        mutable value_type temp_value;
+
+        friend class skiplist_map_packed<key_type, data_type, key_compare, codec,
+                                         allocator_type>;
+
+    public:
+        inline const_reverse_iterator()
+            : cursor()
+        { }
+
+        inline const_reverse_iterator(const reverse_iterator& it)
+            : cursor(it)
+        { }
+
+        inline reference operator * () const
+        {
+            temp_value = value_type(key(), data());
+            return temp_value;
+        }
+
+        inline pointer operator -> () const
+        {
+            temp_value = value_type(key(), data());
+            return &temp_value;
+        }
+
+        inline const key_type& key() const
+        {
+            return this->curr_key;
+        }
+
+        inline const data_type& data() const
+        {
+            return this->entry_data();
+        }
+
+        inline const_reverse_iterator& operator ++ ()
+        {
+            this->move_back();
+            return *this;
+        }
+
+        inline const_reverse_iterator operator ++ (int)
+        {
+            const_reverse_iterator tmp = *this;
+            this->move_back();
+            return tmp;
+        }
+
+        inline const_reverse_iterator& operator -- ()
+        {
+            this->move_ahead();
+            return *this;
+        }
+
+        inline const_reverse_iterator operator -- (int)
+        {
+            const_reverse_iterator tmp = *this;
+            this->move_ahead();
+            return tmp;
+        }
+
+        inline bool operator == (const const_reverse_iterator &x) const
+        {
+            return (x.map == this->map && x.entry == this->entry);
+        }
+
+        inline bool operator != (const const_reverse_iterator &x) const
+        {
+            return (x.map != this->map || x.entry != this->entry);
+        }
+
+        inline bool is_invalid() const
+        {
+            return this->map == NULL;
+        }
+
+        inline bool is_end() const
+        {
+            return !this->at(this->entry);
+        }
+
+        inline bool is_lazy_deleted() const
+        {
+            return data() == (data_type)0;
+        }
+    };
+
+public:
+    explicit inline skiplist_map_packed(const allocator_type& alloc = allocator_type())
+        : m_fence(key_alloc_type(alloc)), m_offsets(offset_alloc_type(alloc)),
+          m_bytes(byte_alloc_type(alloc)), m_data(data_alloc_type(alloc)),
+          m_size(0), m_allocator(alloc)
+    { }
+
+    explicit inline skiplist_map_packed(const key_compare& kcf,
+                                        const allocator_type& alloc = allocator_type())
+        : m_fence(key_alloc_type(alloc)), m_offsets(offset_alloc_type(alloc)),
+          m_bytes(byte_alloc_type(alloc)), m_data(data_alloc_type(alloc)),
+          m_size(0), m_key_less(kcf), m_allocator(alloc)
+    { }
+
+    void swap(self_type& from)
+    {
+        m_fence.swap(from.m_fence);
+        m_offsets.swap(from.m_offsets);
+        m_bytes.swap(from.m_bytes);
+        m_data.swap(from.m_data);
+        std::swap(m_size, from.m_size);
+        std::swap_ranges(m_last, m_last + image_size, from.m_last);
+        std::swap(m_key_less, from.m_key_less);
+        std::swap(m_allocator, from.m_allocator);
+    }
+
+    inline key_compare key_comp() const
+    {
+        return m_key_less;
+    }
+
+    allocator_type get_allocator() const
+    {
+        return m_allocator;
+    }
+
+private:
+    inline bool key_less(const key_type& a, const key_type& b) const
+    {
+        return m_key_less(a, b);
+    }
+
+    inline bool key_equal(const key_type& a, const key_type& b) const
+    {
+        return !m_key_less(a, b) && !m_key_less(b, a);
+    }
+
+    // *** Front Coding
+    // every key but the first of a block is stored as two varints, the
+    // length of the prefix it shares with the image of the key before it
+    // and the length of the rest up to its last non-zero byte, followed by
+    // the rest; bytes past the rest are zero
+
+    inline void put_varint(size_t v)
+    {
+        while (v >= 0x80) {
+            m_bytes.push_back(static_cast<unsigned char>(v | 0x80));
+            v >>= 7;
+        }
+        m_bytes.push_back(static_cast<unsigned char>(v));
+    }
+
+    inline size_t get_varint(size_t& pos) const
+    {
+        size_t v = 0;
+        for (int shift = 0; ; shift += 7) {
+            unsigned char b = m_bytes[pos++];
+            v |= static_cast<size_t>(b & 0x7f) << shift;
+            if (b < 0x80) {
+                return v;
+            }
+        }
+    }
+
+    inline void put_image(const unsigned char *image)
+    {
+        size_t shared = 0;
+        while (shared < image_size && image[shared] == m_last[shared]) {
+            shared++;
+        }
+        size_t end = image_size;
+        while (end > shared && image[end - 1] == 0) {
+            end--;
+        }
+        put_varint(shared);
+        put_varint(end - shared);
+        m_bytes.insert(m_bytes.end(), image + shared, image + end);
+    }
+
+    // turn image into the image of the key at pos, and move pos past it
+    inline void get_image(size_t& pos, unsigned char *image) const
+    {
+        size_t shared = get_varint(pos);
+        size_t rest = get_varint(pos);
+        memcpy(image + shared, &m_bytes[pos], rest);
+        memset(image + shared + rest, 0, image_size - shared - rest);
+        pos += rest;
+    }
+
+    // decode the key after key, which is stored at pos
+    inline void step(size_t& pos, key_type& key) const
+    {
+        unsigned char image[image_size];
+        codec::encode(key, image);
+        get_image(pos, image);
+        codec::decode(image, key);
+    }
+
+    // decode the key of entry, from the first key of its block on
+    void seek(size_type entry, size_t& pos, key_type& key) const
+    {
+        size_type block = entry / block_order;
+        pos = m_offsets[block];
+        key = m_fence[block];
+        if (entry % block_order == 0) {
+            return;
+        }
+        unsigned char image[image_size];
+        codec::encode(key, image);
+        for (size_type i = 0; i < entry % block_order; i++) {
+            get_image(pos, image);
+        }
+        codec::decode(image, key);
+    }
+
+    // first entry not less than key, or greater than key with upper
+    cursor search(const key_type& key, bool upper) const
+    {
+        self_type *self = const_cast<self_type *>(this);
+        size_type block = upper
+            ? std::upper_bound(m_fence.begin(), m_fence.end(), key, m_key_less) - m_fence.begin()
+            : std::lower_bound(m_fence.begin(), m_fence.end(), key, m_key_less) - m_fence.begin();
+
+        if (block > 0) {
+            // the key falls after the first key of the block before
+            size_type entry = (block - 1) * block_order;
+            size_type last = std::min(entry + block_order, m_data.size());
+            size_t pos = m_offsets[block - 1];
+            key_type curr = m_fence[block - 1];
+            unsigned char image[image_size];
+            codec::encode(curr, image);
+            for (entry++; entry < last; entry++) {
+                get_image(pos, image);
+                codec::decode(image, curr);
+                if (upper ? key_less(key, curr) : !key_less(curr, key)) {
+                    return cursor(self, entry, pos, curr);
+                }
+            }
+        }
+        if (block == m_fence.size()) {
+            return cursor(self, m_data.size());
+        }
+        return cursor(self, block * block_order, m_offsets[block], m_fence[block]);
+    }
+
+public:
+    void clear()
+    {
+        std::vector<key_type, key_alloc_type>(key_alloc_type(m_allocator)).swap(m_fence);
+        std::vector<size_t, offset_alloc_type>(offset_alloc_type(m_allocator)).swap(m_offsets);
+        std::vector<unsigned char, byte_alloc_type>(byte_alloc_type(m_allocator)).swap(m_bytes);
+        std::vector<data_type, data_alloc_type>(data_alloc_type(m_allocator)).swap(m_data);
+        m_size = 0;
+    }
+
+    inline iterator begin()
+    {
+        return iterator(cursor(this, 0));
+    }
+
+    inline iterator end()
+    {
+        return iterator(cursor(this, m_data.size()));
+    }
+
+    inline const_iterator begin() const
+    {
+        return const_iterator(cursor(const_cast<self_type *>(this), 0));
+    }
+
+    inline const_iterator end() const
+    {
+        return const_iterator(cursor(const_cast<self_type *>(this), m_data.size()));
+    }
+
+    inline reverse_iterator rbegin()
+    {
+        return reverse_iterator(end());
+    }
+
+    inline reverse_iterator rend()
+    {
+        return reverse_iterator(begin());
+    }
+
+    inline const_reverse_iterator rbegin() const
+    {
+        return const_reverse_iterator(const_cast<self_type *>(this)->rbegin());
+    }
+
+    inline const_reverse_iterator rend() const
+    {
+        return const_reverse_iterator(const_cast<self_type *>(this)->rend());
+    }
+
+public:
+    // *** Access Functions to the basic stats
+
+    inline size_type size() const
+    {
+        return m_size;
+    }
+
+    inline bool empty() const
+    {
+        return (size() == size_type(0));
+    }
+
+    inline size_type max_size() const
+    {
+        return size_type(-1);
+    }
+
+    // the fence array is the only index level above the blocks
+    inline size_type level() const
+    {
+        return m_fence.empty() ? 0 : 1;
+    }
+
+    inline size_type inner_count() const
+    {
+        return m_fence.empty() ? 0 : 1;
+    }
+
+    inline size_type leaf_count() const
+    {
+        return m_fence.size();
+    }
+
+    // bytes held by the arrays of the stage
+    inline size_type memory_size() const
+    {
+        return m_fence.capacity() * sizeof(key_type) +
+               m_offsets.capacity() * sizeof(size_t) +
+               m_bytes.capacity() +
+               m_data.capacity() * sizeof(data_type);
+    }
+
+public:
+    // *** Standard Access Functions
+
+    bool exists(const key_type& key) const
+    {
+        const_iterator it = find(key);
+        return !it.is_end() && !it.is_lazy_deleted();
+    }
+
+    iterator find(const key_type& key)
+    {
+        cursor c = search(key, false);
+        if (c.at(c.entry) && key_less(key, c.curr_key)) {
+            return end();
+        }
+        return iterator(c);
+    }
+
+    const_iterator find(const key_type& key) const
+    {
+        return const_iterator(const_cast<self_type *>(this)->find(key));
+    }
+
+    iterator lower_bound(const key_type& key)
+    {
+        return iterator(search(key, false));
+    }
+
+    const_iterator lower_bound(const key_type& key) const
+    {
+        return const_iterator(search(key, false));
+    }
+
+    iterator upper_bound(const key_type& key)
+    {
+        return iterator(search(key, true));
+    }
+
+    const_iterator upper_bound(const key_type& key) const
+    {
+        return const_iterator(search(key, true));
+    }
+
+public:
+    // *** Insertion
+    // only for building a stage by hand: keys after the last one are
+    // appended, anything else rebuilds the whole stage
+
+    std::pair<iterator, bool> insert(const key_type& key, const data_type& data)
+    {
+        iterator it = find(key);
+        if (!it.is_end()) {
+            if (!it.is_lazy_deleted()) {
+                return std::pair<iterator, bool>(it, false);
+            }
+            it.data() = data;
+            m_size++;
+            return std::pair<iterator, bool>(it, true);
+        }
+
+        if (m_data.empty() || key_less(rbegin().key(), key)) {
+            bulk_append(key, data);
+        }
+        else {
+            self_type rebuilt(m_key_less, m_allocator);
+            bool placed = false;
+            for (iterator i = begin(); !i.is_end(); ++i) {
+                if (!placed && key_less(key, i.key())) {
+                    rebuilt.bulk_append(key, data);
+                    placed = true;
+                }
+                rebuilt.bulk_append(i.key(), i.data());
+            }
+            rebuilt.m_size = m_size + 1;
+            swap(rebuilt);
+        }
+        return std::pair<iterator, bool>(find(key), true);
+    }
+
+public:
+    // *** Lazy Erase Functions
+    // entries stay in place with data 0 until the next merge drops them
+
+    bool lazy_erase_one(const key_type& key)
+    {
+        iterator it = find(key);
+        if (!it.is_end() && !it.is_lazy_deleted()) {
+            it.lazy_delete();
+            --m_size;
+            return true;
+        }
+        return false;
+    }
+
+    size_type lazy_erase(const key_type& key)
+    {
+        return lazy_erase_one(key) ? 1 : 0;
+    }
+
+    void lazy_erase(iterator iter)
+    {
+        if (iter.map == this && !iter.is_end() && !iter.is_lazy_deleted()) {
+            iter.lazy_delete();
+            --m_size;
+        }
+    }
+
+    void lazy_erase(reverse_iterator iter)
+    {
+        if (iter.map == this && !iter.is_end() && !iter.is_lazy_deleted()) {
+            iter.lazy_delete();
+            --m_size;
+        }
+    }
+
+public:
+    // *** Merge
+    // rebuild the stage from the entries of a writable skip list and its
+    // own live entries, those of from shadowing equal keys; from is
+    // cleared
+
+    template <typename _Writable>
+    void merge(_Writable& from)
+    {
+        if (from.size() == 0) {
+            return;
+        }
+
+        self_type merged(m_key_less, m_allocator);
+        merged.bulk_begin(m_size + from.size(), this);
+        typename _Writable::iterator d_iter = from.begin();
+        iterator s_iter = begin();
+        for (;;) {
+            while (!s_iter.is_end() && s_iter.is_lazy_deleted()) {
+                ++s_iter;
+            }
+            bool d_end = d_iter.is_end();
+            bool s_end = s_iter.is_end();
+            if (d_end && s_end) {
+                break;
+            }
+            if (s_end || (!d_end && !key_less(s_iter.key(), d_iter.key()))) {
+                if (!s_end && key_equal(d_iter.key(), s_iter.key())) {
+                    ++s_iter;
+                }
+                merged.bulk_append(d_iter.key(), d_iter.data());
+                ++d_iter;
+            }
+            else {
+                merged.bulk_append(s_iter.key(), s_iter.data());
+                ++s_iter;
+            }
+        }
+        merged.bulk_end();
+        swap(merged);
+        from.clear();
+    }
+
+    // *** Bulk Build Functions
+    // rebuild the stage entry by entry in key order. The stage must not
+    // be read between bulk_begin() and bulk_end().
+
+    // expected is the number of entries about to be appended. The arrays
+    // are reserved for it, so that neither appending nor bulk_end() has to
+    // copy them; the bytes per key are estimated from like, a stage of the
+    // same keys, if there is one.
+    void bulk_begin(size_type expected = 0, const self_type *like = NULL)
+    {
+        clear();
+        if (expected == 0) {
+            return;
+        }
+
+        size_type blocks = expected / block_order + 1;
+        size_type bytes = expected * (image_size + 2);
+        if (like != NULL && !like->m_data.empty()) {
+            bytes = expected * like->m_bytes.size() / like->m_data.size() + expected / 8 + image_size;
+        }
+        m_fence.reserve(blocks);
+        m_offsets.reserve(blocks);
+        m_bytes.reserve(bytes);
+        m_data.reserve(expected);
+    }
+
+    // key must be greater than every key appended before
+    inline void bulk_append(const key_type& key, const data_type& data)
+    {
+        if (m_data.size() % block_order == 0) {
+            m_fence.push_back(key);
+            m_offsets.push_back(m_bytes.size());
+            codec::encode(key, m_last);
+        }
+        else {
+            unsigned char image[image_size];
+            codec::encode(key, image);
+            put_image(image);
+            memcpy(m_last, image, image_size);
+        }
+        m_data.push_back(data);
+        m_size++;
+    }
+
+    // give back what the arrays reserved for growth. The copy stalls the
+    // step that ends an incremental merge, which keeps the slack of the
+    // reservation instead.
+    void bulk_end(bool shrink = true)
+    {
+        if (!shrink) {
+            return;
+        }
+        std::vector<key_type, key_alloc_type>(m_fence.begin(), m_fence.end(), key_alloc_type(m_allocator)).swap(m_fence);
+        std::vector<size_t, offset_alloc_type>(m_offsets.begin(), m_offsets.end(), offset_alloc_type(m_allocator)).swap(m_offsets);
+        std::vector<unsigned char, byte_alloc_type>(m_bytes.begin(), m_bytes.end(), byte_alloc_type(m_allocator)).swap(m_bytes);
+        std::vector<data_type, data_alloc_type>(m_data.begin(), m_data.end(), data_alloc_type(m_allocator)).swap(m_data);
+    }
+
+    // free one array of a stage that is being torn down per call, the
+    // stage cannot be read after the first one. Returns true once all
+    // arrays are freed.
+    bool release_step(size_t leaves)
+    {
+        if (m_data.capacity() != 0) {
+            std::vector<data_type, data_alloc_type>(data_alloc_type(m_allocator)).swap(m_data);
+        }
+        else if (m_bytes.capacity() != 0) {
+            std::vector<unsigned char, byte_alloc_type>(byte_alloc_type(m_allocator)).swap(m_bytes);
+        }
+        else if (m_offsets.capacity() != 0) {
+            std::vector<size_t, offset_alloc_type>(offset_alloc_type(m_allocator)).swap(m_offsets);
+        }
+        else {
+            std::vector<key_type, key_alloc_type>(key_alloc_type(m_allocator)).swap(m_fence);
+        }
+        m_size = 0;
+        return m_data.capacity() == 0 && m_bytes.capacity() == 0 &&
+               m_offsets.capacity() == 0 && m_fence.capacity() == 0;
+    }
+
+#ifdef SL_DEBUG
+
+public:
+    // *** Debug Printing
+
+    void print(std::ostream& os) const
+    {
+        os << "Size: " << m_size << std::endl;
+        os << "Entries: " << m_data.size() << std::endl;
+        os << "Block count: " << m_fence.size() << std::endl;
+        os << "Key bytes: " << m_bytes.size() << std::endl;
+
+        size_type entry = 0;
+        for (const_iterator it = begin(); !it.is_end(); ++it, ++entry) {
+            if (entry % block_order == 0) {
+                os << (entry == 0 ? "[" : "] [");
+            }
+            os << std::setw(6) << it.key();
+            if (it.is_lazy_deleted()) {
+                os << "*";
+            }
+        }
+        os << "]" << std::endl << std::endl;
+    }
+#endif
+};
+
+}
+
+#endif
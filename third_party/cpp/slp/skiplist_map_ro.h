@@ -1784,4 +1784,6 @@ public:
 
 }
 
+#undef SL_FRIENDS
+
 #endif
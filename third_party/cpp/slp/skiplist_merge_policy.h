@@ -0,0 +1,62 @@
+#ifndef SKIPLIST_MERGE_POLICY_H_HEADER
+#define SKIPLIST_MERGE_POLICY_H_HEADER
+
+#include <cstddef>
+#include <stdint.h>
+
+namespace cmu {
+
+// When the dynamic stage of a compact skip list is merged into its static
+// stage, and how the bloom filter over the dynamic stage is sized. Every
+// trigger can be disabled by setting it to 0; the merge starts as soon as
+// any enabled trigger fires.
+struct merge_policy
+{
+    // merge once dynamic size * ratio >= static size ...
+    size_t ratio;
+    // ... and the dynamic stage holds at least this many entries
+    size_t threshold;
+    // merge once the entries of the dynamic stage take this many bytes
+    size_t memory_budget;
+    // merge a non-empty dynamic stage at least this often, the owner of
+    // the skip list checks this through merge_due()
+    uint64_t interval_ms;
+
+    // leaf nodes built per incremental merge step, 0 merges inline in one
+    // go (only skiplist_map_compact merges incrementally)
+    size_t step;
+
+    // bloom filter over the dynamic stage
+    size_t bits_per_key;
+    size_t k;
+
+    merge_policy()
+        : ratio(10), threshold(100), memory_budget(0), interval_ms(0), step(0),
+          bits_per_key(8), k(2)
+    { }
+
+    inline bool should_merge(size_t dyna_size, size_t static_size, size_t dyna_bytes) const
+    {
+        if (ratio != 0 && dyna_size * ratio >= static_size && dyna_size >= threshold) {
+            return true;
+        }
+        if (memory_budget != 0 && dyna_bytes >= memory_budget) {
+            return true;
+        }
+        return false;
+    }
+
+    // expected size of the dynamic stage before the next merge
+    inline size_t expected_dyna_size(size_t static_size) const
+    {
+        size_t expected = (ratio != 0) ? static_size / ratio : 0;
+        if (expected < threshold) {
+            expected = threshold;
+        }
+        return expected > 0 ? expected : 1;
+    }
+};
+
+} // namespace cmu
+
+#endif // SKIPLIST_MERGE_POLICY_H_HEADER
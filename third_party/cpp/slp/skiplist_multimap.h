@@ -4,11 +4,13 @@
 #include <algorithm>
 #include <functional>
 #include <istream>
+#include <iterator>
 #include <ostream>
 #include <memory>
 #include <cstddef>
 #include <cassert>
 #include <deque>
+#include <vector>
 #include "skiplist_traits.h"
 
 #ifdef SL_DEBUG
@@ -764,6 +766,9 @@ private:
 
     typename leaf_node::alloc_type m_leaf_allocator;
 
+    // leftmost and rightmost inner node of every level during a bulk build
+    std::vector<std::pair<inner_node *, inner_node *> > m_bulk_levels;
+
 public:
     explicit inline skiplist_multimap(const allocator_type& alloc = allocator_type())
         : m_allocator(alloc)
@@ -842,6 +847,11 @@ public:
         return m_key_less;
     }
 
+    inline value_compare value_comp() const
+    {
+        return value_compare(m_key_less);
+    }
+
     allocator_type get_allocator() const
     {
         return m_allocator;
@@ -1231,39 +1241,13 @@ public:
         if (m_size == 0) {
             return 0;
         }
-        if (key_less(key, m_head_leaf->key[0])) {
-            return 0;
-        }
-        if (m_tail_leaf->count > 1) {
-            if (key_greater(key, m_tail_leaf->key[m_tail_leaf->count - 2])) {
-                return 0;
-            }
-        }
-        else if (m_tail_leaf->left != NULL) {
-            leaf_node *prev_leaf = m_tail_leaf->left;
-            if (key_greater(key, prev_leaf->key[prev_leaf->count - 1])) {
-                return 0;
-            }
-        }
 
-        const node *n = m_head;
-        short i;
-
-        while (!n->is_leaf) {
-            const inner_node *in = static_cast<const inner_node *>(n);
-            short count = in->count - 1;
-            for (i = 0; i < count; i++) {
-                if (key_lessequal(key, in->key[i])) {
-                    break;
-                }
-            }
-            n = in->down[i];
+        // the duplicates of a key may span several leaf nodes
+        size_type c = 0;
+        for (const_iterator it = lower_bound(key); !it.is_end() && key_equal(it.key(), key); ++it) {
+            c++;
         }
-
-        const leaf_node *ln = static_cast<const leaf_node *>(n);
-        for (i = 0; key_greater(key, ln->key[i]); i++);
-
-        return key_equal(key, ln->key[i]) ? 1 : 0;
+        return c;
     }
 
     iterator lower_bound(const key_type& key)
@@ -1463,6 +1447,44 @@ public:
         return insert_common(key, data);
     }
 
+    // *** Bulk Insertion
+    // Inserts a run of pairs sorted by key, after the entries already
+    // there with the same key. A run that is large against the skip list
+    // rebuilds it in one pass over both, a small one is inserted pair by
+    // pair. Returns the number of pairs inserted.
+    template <typename ForwardIterator>
+    size_type insert_sorted(ForwardIterator first, ForwardIterator last)
+    {
+        size_type count = static_cast<size_type>(std::distance(first, last));
+        if (count == 0 || count < m_size / 4) {
+            for (; first != last; ++first) {
+                insert_common(first->first, first->second);
+            }
+            return count;
+        }
+
+        std::vector<pair_type> entries;
+        entries.reserve(m_size);
+        for (const_iterator i = begin(); !i.is_end(); ++i) {
+            entries.push_back(pair_type(i.key(), i.data()));
+        }
+
+        bulk_begin();
+        typename std::vector<pair_type>::const_iterator e = entries.begin();
+        while (e != entries.end() || first != last) {
+            if (first == last || (e != entries.end() && !key_less(first->first, e->first))) {
+                bulk_append(e->first, e->second);
+                ++e;
+            }
+            else {
+                bulk_append(first->first, first->second);
+                ++first;
+            }
+        }
+        bulk_end();
+        return count;
+    }
+
 private:
     inline void inner_shift_right(inner_node *n, short i)
     {
@@ -1519,6 +1541,9 @@ private:
             if (r->right == NULL) {
                 m_tail_leaf = r;
             }
+            else {
+                r->right->left = r;
+            }
 
             for (short i = l_order - 1; i >= l_half_order; i--) {
                 r->key[i - l_half_order] = l->key[i];
@@ -1741,6 +1766,12 @@ private:
             }
             head->down[0] = child;
             head->down[1] = new_child;
+
+            // the new entry may have moved to the right half of the old head
+            if (child == ln && i >= l_half_order) {
+                ln = static_cast<leaf_node *>(new_child);
+                i -= l_half_order;
+            }
         }
 
         return std::pair<iterator, bool>(iterator(ln, i), true);
@@ -1961,7 +1992,8 @@ public:
             }
         }
         inner_indexes[0] = i;
-        inner_counts[0] = count;
+        // the search skips the virtual max key, the walk covers every child
+        inner_counts[0] = head->count;
         ++path_size;
 
         while (path_size != 0) {
@@ -2017,7 +2049,7 @@ public:
                 }
                 inner_nodes[path_size] = in;
                 inner_indexes[path_size] = i;
-                inner_counts[path_size] = count;
+                inner_counts[path_size] = in->count;
                 ++path_size;
             }
         }
@@ -2026,7 +2058,8 @@ public:
         inner_node *adjust_inner_nodes[m_level];
         short adjust_inner_indexes[m_level];
         int adjust_path_size = 0;
-        node *child;
+        // path_size is at least one, the walk always moves child below the head
+        node *child = m_head;
         short leaf_erase_index = iter.currindex;
         for (int j = 0;j < path_size; j++) {
             inner_node *in = inner_nodes[j];
@@ -2119,6 +2152,107 @@ public:
         erase(iterator(iter.currnode, iter.currindex - 1));
     }
 
+private:
+    // *** Bulk Build Functions
+    // rebuild the skip list entry by entry in key order; inner nodes are
+    // filled in as leaf nodes close so that bulk_end() only has to close the
+    // rightmost node of every level. The skip list must not be read between
+    // bulk_begin() and bulk_end().
+
+    void bulk_begin()
+    {
+        clear();
+        m_tail_leaf->count = 0;
+        m_bulk_levels.clear();
+    }
+
+    // key must not be less than any key appended before
+    inline void bulk_append(const key_type& key, const data_type& data)
+    {
+        leaf_node *ln = m_tail_leaf;
+        if (ln->count == l_order) {
+            leaf_node *new_ln = allocate_leaf();
+            ln->right = new_ln;
+            new_ln->left = ln;
+            m_tail_leaf = new_ln;
+            bulk_push(0, ln->key[l_order - 1], ln);
+            ln = new_ln;
+        }
+        ln->key[ln->count] = key;
+        ln->data[ln->count] = data;
+        ln->count++;
+        m_size++;
+    }
+
+    void bulk_end()
+    {
+        // placeholder for virtual max key, not counted in m_size
+        bulk_append(key_type(), data_type());
+        m_size--;
+
+        if (m_head_leaf == m_tail_leaf) {
+            m_head = m_head_leaf;
+            m_level = 0;
+            return;
+        }
+
+        bulk_push(0, m_tail_leaf->key[m_tail_leaf->count - 1], m_tail_leaf);
+        size_t level = 0;
+        while (m_bulk_levels[level].first != m_bulk_levels[level].second) {
+            inner_node *in = m_bulk_levels[level].second;
+            bulk_push(level + 1, in->key[in->count - 1], in);
+            level++;
+        }
+        m_head = m_bulk_levels[level].first;
+        m_level = level + 1;
+        m_bulk_levels.clear();
+    }
+
+    // link a closed node of the level below into the inner level
+    void bulk_push(size_t level, const key_type& key, node *n)
+    {
+        if (level == m_bulk_levels.size()) {
+            inner_node *in = allocate_inner();
+            m_bulk_levels.push_back(std::make_pair(in, in));
+        }
+        inner_node *in = m_bulk_levels[level].second;
+        if (in->count == i_order) {
+            inner_node *new_in = allocate_inner();
+            in->right = new_in;
+            m_bulk_levels[level].second = new_in;
+            bulk_push(level + 1, in->key[i_order - 1], in);
+            in = new_in;
+        }
+        in->key[in->count] = key;
+        in->down[in->count] = n;
+        in->count++;
+    }
+
+    // free up to leaves leaf nodes of a skip list that is being torn down,
+    // returns true once all nodes are freed
+    bool release_step(size_t leaves)
+    {
+        if (m_head == NULL) {
+            return true;
+        }
+        clear_inner();
+
+        leaf_node *ln = m_head_leaf;
+        for (size_t i = 0; ln != NULL && i < leaves; i++) {
+            leaf_node *tmp = ln->right;
+            free_node(ln);
+            ln = tmp;
+        }
+        m_head = m_head_leaf = ln;
+        if (ln == NULL) {
+            m_tail_leaf = NULL;
+            m_size = 0;
+            return true;
+        }
+        ln->left = NULL;
+        return false;
+    }
+
 #ifdef SL_DEBUG
 
 public:
@@ -2181,4 +2315,6 @@ public:
 
 }
 
+#undef SL_FRIENDS
+
 #endif
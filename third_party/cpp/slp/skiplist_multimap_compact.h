@@ -8,18 +8,14 @@
 #include <memory>
 #include <cstddef>
 #include <cassert>
+#include <vector>
 #include "bloomfilter.h"
 #include "skiplist_multimap.h"
 #include "skiplist_multimap_ro.h"
-
-#define SL_MERGE 1
-#define SL_MERGE_THRESHOLD 100
-#define SL_MERGE_RATIO 10
+#include "skiplist_merge_policy.h"
 
 #define USE_BLOOM_FILTER 1
 #define LITTLEENDIAN 1
-#define BITS_PER_KEY 8
-#define K 2
 
 namespace cmu {
 
@@ -565,29 +561,56 @@ private:
     bloomfilter bf;
 
     key_compare m_key_less;
+    bloom_key_hash<key_type, key_compare> m_bloom_hash;  // follows m_key_less
     allocator_type m_allocator;
 
+    merge_policy m_policy;
+    uint64_t m_last_merge_ms;   // 0 until merge_due() has seen the clock
+    size_type m_merge_count;
+
+    // point lookups that the bloom filter kept out of the dynamic stage,
+    // that found the key there, and that searched it in vain
+    mutable size_type m_bf_skips;
+    mutable size_type m_bf_hits;
+    mutable size_type m_bf_false_positives;
+
+    // incremental merge state, the next stages are built aside in merge_sl
+    // and late_sl while dyna_sl and static_sl keep serving all operations
+    sl_ro_type *merge_sl;               // next static stage
+    sl_type *late_sl;                   // next dynamic stage, once merge_sl is built
+    bool merge_has_cursor;
+    key_type merge_cursor;              // last key copied into merge_sl
+    std::vector<key_type> merge_late;   // written at or below the cursor
+    std::vector<sl_type *> merge_retired; // replaced dynamic stages, freed step by step
+    std::vector<sl_ro_type *> merge_retired_static; // replaced static stages, freed step by step
+
 public:
     explicit inline skiplist_multimap_compact(const allocator_type& alloc = allocator_type())
-        : bf(LITTLEENDIAN, K, BITS_PER_KEY), m_allocator(alloc)
+        : bf(LITTLEENDIAN, merge_policy().k, merge_policy().bits_per_key), m_bloom_hash(m_key_less), m_allocator(alloc),
+          m_last_merge_ms(0), m_merge_count(0),
+          m_bf_skips(0), m_bf_hits(0), m_bf_false_positives(0),
+          merge_sl(NULL), late_sl(NULL), merge_has_cursor(false)
     {
         dyna_sl = new sl_type(alloc);
         static_sl = new sl_ro_type(alloc);
 
         if (USE_BLOOM_FILTER) {
-            bf.reallocate(SL_MERGE_THRESHOLD);
+            bf.reallocate(m_policy.expected_dyna_size(0));
         }
     }
 
     explicit inline skiplist_multimap_compact(const key_compare& kcf,
                                  const allocator_type& alloc = allocator_type())
-        : bf(LITTLEENDIAN, K, BITS_PER_KEY), m_key_less(kcf), m_allocator(alloc)
+        : bf(LITTLEENDIAN, merge_policy().k, merge_policy().bits_per_key), m_key_less(kcf), m_bloom_hash(m_key_less), m_allocator(alloc),
+          m_last_merge_ms(0), m_merge_count(0),
+          m_bf_skips(0), m_bf_hits(0), m_bf_false_positives(0),
+          merge_sl(NULL), late_sl(NULL), merge_has_cursor(false)
     {
         dyna_sl = new sl_type(kcf, alloc);
         static_sl = new sl_ro_type(kcf, alloc);
 
         if (USE_BLOOM_FILTER) {
-            bf.reallocate(SL_MERGE_THRESHOLD);
+            bf.reallocate(m_policy.expected_dyna_size(0));
         }
     }
 
@@ -595,15 +618,30 @@ public:
     {
         delete dyna_sl;
         delete static_sl;
+        merge_abort();
     }
 
     void swap(self_type &from)
     {
         std::swap(dyna_sl, from.dyna_sl);
         std::swap(static_sl, from.static_sl);
-        std::swap(bf, from.bf);
+        bf.swap(from.bf);
         std::swap(m_key_less, from.m_key_less);
+        std::swap(m_bloom_hash, from.m_bloom_hash);
         std::swap(m_allocator, from.m_allocator);
+        std::swap(m_policy, from.m_policy);
+        std::swap(m_last_merge_ms, from.m_last_merge_ms);
+        std::swap(m_merge_count, from.m_merge_count);
+        std::swap(m_bf_skips, from.m_bf_skips);
+        std::swap(m_bf_hits, from.m_bf_hits);
+        std::swap(m_bf_false_positives, from.m_bf_false_positives);
+        std::swap(merge_sl, from.merge_sl);
+        std::swap(late_sl, from.late_sl);
+        std::swap(merge_has_cursor, from.merge_has_cursor);
+        std::swap(merge_cursor, from.merge_cursor);
+        merge_late.swap(from.merge_late);
+        merge_retired.swap(from.merge_retired);
+        merge_retired_static.swap(from.merge_retired_static);
     }
 
     class value_compare
@@ -634,6 +672,11 @@ public:
         return m_key_less;
     }
 
+    inline value_compare value_comp() const
+    {
+        return value_compare(m_key_less);
+    }
+
     allocator_type get_allocator() const
     {
         return m_allocator;
@@ -677,6 +720,7 @@ public:
     // clear all nodes except the starting leaf node for empty skip list
     void clear()
     {
+        merge_abort();
         dyna_sl->clear();
         static_sl->clear();
     }
@@ -777,6 +821,79 @@ public:
         return bf.size();
     }
 
+    inline size_type bloomfilter_skips() const
+    {
+        return m_bf_skips;
+    }
+
+    inline size_type bloomfilter_hits() const
+    {
+        return m_bf_hits;
+    }
+
+    inline size_type bloomfilter_false_positives() const
+    {
+        return m_bf_false_positives;
+    }
+
+    inline bool is_merging() const
+    {
+        return merge_sl != NULL;
+    }
+
+    inline size_type merge_step_size() const
+    {
+        return m_policy.step;
+    }
+
+    // number of leaf nodes built per incremental merge step,
+    // 0 rebuilds the whole static stage inline when the merge triggers
+    inline void set_merge_step_size(size_type leaves)
+    {
+        m_policy.step = leaves;
+    }
+
+    inline const merge_policy& get_merge_policy() const
+    {
+        return m_policy;
+    }
+
+    // the bloom filter is rebuilt if its parameters change
+    void set_merge_policy(const merge_policy& policy)
+    {
+        bool rebuild = (policy.k != m_policy.k || policy.bits_per_key != m_policy.bits_per_key);
+        m_policy = policy;
+        if (USE_BLOOM_FILTER && rebuild) {
+            bf.configure(m_policy.k, m_policy.bits_per_key);
+            rebuild_bloomfilter();
+        }
+    }
+
+    // number of completed dynamic-to-static merges
+    inline size_type merge_count() const
+    {
+        return m_merge_count;
+    }
+
+    // bytes taken by the entries of the dynamic stage
+    inline size_type dyna_bytes() const
+    {
+        return dyna_sl->size() * (sizeof(key_type) + sizeof(data_type));
+    }
+
+    // time-based trigger of the merge policy, to be called periodically
+    // with a millisecond clock. Returns true if the dynamic stage has not
+    // been merged for the policy interval.
+    bool merge_due(uint64_t now_ms)
+    {
+        if (m_last_merge_ms == 0 || now_ms < m_last_merge_ms) {
+            m_last_merge_ms = now_ms;
+            return false;
+        }
+        return m_policy.interval_ms != 0 && !is_merging() && dyna_sl->size() != 0 &&
+               now_ms - m_last_merge_ms >= m_policy.interval_ms;
+    }
+
     inline bool empty() const
     {
         return (size() == size_type(0));
@@ -822,7 +939,18 @@ public:
 
     bool exists(const key_type& key) const
     {
-        return (find(key) != end());
+        if (!USE_BLOOM_FILTER || (dyna_sl->size() != 0 && bf.hash_may_match(m_bloom_hash(key)))) {
+            bool found = dyna_sl->exists(key);
+            count_dyna_probe(found);
+            if (found) {
+                return true;
+            }
+        }
+        else {
+            m_bf_skips++;
+        }
+
+        return !static_sl->find(key).is_end();
     }
 
     iterator find(const key_type& key)
@@ -831,8 +959,9 @@ public:
         typename sl_ro_type::iterator s_it;
         SL_PRINT("finding " << key);
         if (USE_BLOOM_FILTER) {
-            if (dyna_sl->size() == 0 || !bf.key_may_match(reinterpret_cast<const char*>(&key), sizeof(key_type))) {
+            if (dyna_sl->size() == 0 || !bf.hash_may_match(m_bloom_hash(key))) {
                 SL_PRINT("shortcut by bloomfilter");
+                m_bf_skips++;
                 s_it = static_sl->find(key);
                 if (!s_it.is_end()) {
                     // NOTE incomplete iterator
@@ -843,6 +972,7 @@ public:
         }
 
         d_it = dyna_sl->find(key);
+        count_dyna_probe(!d_it.is_end());
         if (d_it.is_end()) {
             s_it = static_sl->find(key);
             if (!s_it.is_end()) {
@@ -861,8 +991,9 @@ public:
         typename sl_ro_type::const_iterator s_it;
         SL_PRINT("finding " << key);
         if (USE_BLOOM_FILTER) {
-            if (dyna_sl->size() == 0 || !bf.key_may_match(reinterpret_cast<const char*>(&key), sizeof(key_type))) {
+            if (dyna_sl->size() == 0 || !bf.hash_may_match(m_bloom_hash(key))) {
                 SL_PRINT("shortcut by bloomfilter");
+                m_bf_skips++;
                 s_it = static_sl->find(key);
                 if (!s_it.is_end()) {
                     // NOTE incomplete iterator
@@ -873,6 +1004,7 @@ public:
         }
 
         d_it = dyna_sl->find(key);
+        count_dyna_probe(!d_it.is_end());
         if (d_it.is_end()) {
             s_it = static_sl->find(key);
             if (!s_it.is_end()) {
@@ -885,6 +1017,22 @@ public:
         return const_iterator(true, d_it, typename sl_ro_type::iterator(), m_key_less);
     }
 
+private:
+    // a point lookup searched the dynamic stage after the bloom filter
+    // could not rule the key out
+    inline void count_dyna_probe(bool found) const
+    {
+        if (USE_BLOOM_FILTER) {
+            if (found) {
+                m_bf_hits++;
+            }
+            else {
+                m_bf_false_positives++;
+            }
+        }
+    }
+
+public:
     void make_iter_complete(iterator& it)
     {
         if (it.in_dyna) {
@@ -1014,15 +1162,37 @@ public:
         }
     }
 
+private:
+    // equal range of a key that is not in the dynamic stage. An iterator
+    // past the static stage counts as in_dyna like after move_forward(),
+    // so that it compares equal to the end of the range.
+    template <typename iterator_type>
+    std::pair<iterator_type, iterator_type> static_range(const key_type& key) const
+    {
+        typename sl_ro_type::iterator lower = static_sl->lower_bound(key);
+        typename sl_ro_type::iterator upper = static_sl->upper_bound(key);
+        return std::pair<iterator_type, iterator_type>(
+            iterator_type(lower.is_end(), dyna_sl->end(), lower, m_key_less),
+            iterator_type(upper.is_end(), dyna_sl->end(), upper, m_key_less));
+    }
+
+public:
     std::pair<iterator, iterator> equal_range(const key_type& key)
     {
         if (USE_BLOOM_FILTER) {
-            if (dyna_sl->size() == 0 || !bf.key_may_match(reinterpret_cast<const char*>(&key), sizeof(key_type))) {
+            if (dyna_sl->size() == 0 || !bf.hash_may_match(m_bloom_hash(key))) {
                 SL_PRINT("equal_range shortcut");
+                m_bf_skips++;
                 // NOTE result iterator valid for moving forward, which is good enough
-                return std::pair<iterator, iterator>(
-                    iterator(false, dyna_sl->end(), static_sl->lower_bound(key), m_key_less),
-                    iterator(false, dyna_sl->end(), static_sl->upper_bound(key), m_key_less));
+                return static_range<iterator>(key);
+            }
+
+            // a false positive only costs the dynamic stage probe, the
+            // range comes from the static stage alone like above
+            bool found = dyna_sl->exists(key);
+            count_dyna_probe(found);
+            if (!found) {
+                return static_range<iterator>(key);
             }
         }
 
@@ -1032,12 +1202,19 @@ public:
     std::pair<const_iterator, const_iterator> equal_range(const key_type& key) const
     {
         if (USE_BLOOM_FILTER) {
-            if (dyna_sl->size() == 0 || !bf.key_may_match(reinterpret_cast<const char*>(&key), sizeof(key_type))) {
+            if (dyna_sl->size() == 0 || !bf.hash_may_match(m_bloom_hash(key))) {
                 SL_PRINT("equal_range shortcut");
+                m_bf_skips++;
                 // NOTE result iterator valid for moving forward, which is good enough
-                return std::pair<const_iterator, const_iterator>(
-                    const_iterator(false, dyna_sl->end(), static_sl->lower_bound(key), m_key_less),
-                    const_iterator(false, dyna_sl->end(), static_sl->upper_bound(key), m_key_less));
+                return static_range<const_iterator>(key);
+            }
+
+            // a false positive only costs the dynamic stage probe, the
+            // range comes from the static stage alone like above
+            bool found = dyna_sl->exists(key);
+            count_dyna_probe(found);
+            if (!found) {
+                return static_range<const_iterator>(key);
             }
         }
 
@@ -1075,37 +1252,136 @@ public:
 
     inline std::pair<iterator, bool> insert(const pair_type& x)
     {
-        if ((SL_MERGE == 1) &&
-            ((dyna_sl->size() * SL_MERGE_RATIO) >= static_sl->size()) &&
-            (dyna_sl->size() >= SL_MERGE_THRESHOLD))
-        {
-            merge_dtos();
-        }
+        merge_if_needed();
 
         return insert_common(x.first, x.second);
     }
 
     inline std::pair<iterator, bool> insert(const key_type& key, const data_type& data)
     {
-        if ((SL_MERGE == 1) &&
-            ((dyna_sl->size() * SL_MERGE_RATIO) >= static_sl->size()) &&
-            (dyna_sl->size() >= SL_MERGE_THRESHOLD))
-        {
-            merge_dtos();
-        }
+        merge_if_needed();
 
         return insert_common(key, data);
     }
 
+    // *** Bulk Insertion
+    // Inserts a run of pairs sorted by key, after the entries already
+    // there with the same key. A run that is large against the skip list
+    // goes straight into a new static stage, built in one pass over both
+    // stages and the run, and leaves the dynamic stage empty; a small one
+    // is inserted pair by pair. Returns the number of pairs inserted.
+    template <typename ForwardIterator>
+    size_type insert_sorted(ForwardIterator first, ForwardIterator last)
+    {
+        size_type count = static_cast<size_type>(std::distance(first, last));
+        if (count == 0 || count < size() / 4) {
+            for (; first != last; ++first) {
+                insert(first->first, first->second);
+            }
+            return count;
+        }
+
+        // finish a running merge, the stages it leaves are the ones merged
+        merge_step(0);
+
+        // an empty static stage is not searched, its only slot is the
+        // virtual key
+        sl_ro_type *merged = new sl_ro_type(m_key_less, m_allocator);
+        merged->bulk_begin();
+        typename sl_type::iterator d_iter = dyna_sl->begin();
+        bool s_live = static_sl->size() != 0;
+        typename sl_ro_type::iterator s_iter;
+        if (s_live) {
+            s_iter = static_sl->begin();
+        }
+        for (;;) {
+            while (s_live && !s_iter.is_end() && s_iter.is_lazy_deleted()) {
+                ++s_iter;
+            }
+            bool d_end = d_iter.is_end();
+            bool s_end = !s_live || s_iter.is_end();
+            if (d_end && s_end && first == last) {
+                break;
+            }
+
+            if (!d_end && (s_end || key_lessequal(d_iter.key(), s_iter.key())) &&
+                (first == last || !key_less(first->first, d_iter.key()))) {
+                merged->bulk_append(d_iter.key(), d_iter.data());
+                ++d_iter;
+            }
+            else if (!s_end && (first == last || !key_less(first->first, s_iter.key()))) {
+                merged->bulk_append(s_iter.key(), s_iter.data());
+                ++s_iter;
+            }
+            else {
+                merged->bulk_append(first->first, first->second);
+                ++first;
+            }
+        }
+        merged->bulk_end();
+
+        delete static_sl;
+        static_sl = merged;
+        dyna_sl->clear();
+        m_merge_count++;
+        m_last_merge_ms = 0;
+
+        if (USE_BLOOM_FILTER) {
+            rebuild_bloomfilter();
+        }
+        return count;
+    }
+
 private:
+    inline void merge_if_needed()
+    {
+        if ((merge_sl == NULL) &&
+            m_policy.should_merge(dyna_sl->size(), static_sl->size(), dyna_bytes()))
+        {
+            if (m_policy.step == 0) {
+                merge_dtos();
+                return;
+            }
+            merge_begin();
+        }
+
+        if (merge_sl != NULL || !merge_retired.empty() || !merge_retired_static.empty()) {
+            merge_step(m_policy.step);
+        }
+    }
+
+    // true if key has already been passed by the merge cursor, so changes
+    // to it are not picked up by the copy and must be replayed
+    inline bool merge_passed(const key_type& key) const
+    {
+        return merge_sl != NULL &&
+               (late_sl != NULL || (merge_has_cursor && !key_less(merge_cursor, key)));
+    }
+
+    inline void merge_note_write(const key_type& key)
+    {
+        // a replay rebuilds all entries of the key, once is enough for a run
+        if (merge_passed(key) && (merge_late.empty() || !key_equal(merge_late.back(), key))) {
+            merge_late.push_back(key);
+        }
+    }
+
     inline std::pair<iterator, bool> insert_common(const key_type& key, const data_type& data)
     {
+        merge_note_write(key);
+
         std::pair<typename sl_type::iterator, bool> dyna_retval = dyna_sl->insert_common(key, data);
         // NOTE incomplete iterator
         std::pair<iterator, bool> retval = std::pair<iterator, bool>(iterator(true, dyna_retval.first, typename sl_ro_type::iterator(), m_key_less), dyna_retval.second);
 
         if (USE_BLOOM_FILTER) {
-            bf.insert(reinterpret_cast<const char*>(&key), sizeof(key_type));
+            if (dyna_sl->size() > bf.capacity()) {
+                // outgrown, e.g. with the ratio trigger disabled
+                rebuild_bloomfilter();
+            }
+            else {
+                bf.insert_hash(m_bloom_hash(key));
+            }
         }
 
         return retval;
@@ -1116,8 +1392,10 @@ public:
 
     bool erase_one(const key_type& key)
     {
+        merge_note_write(key);
+
         if (USE_BLOOM_FILTER) {
-            if (dyna_sl->size() == 0 || !bf.key_may_match(reinterpret_cast<const char*>(&key), sizeof(key_type))) {
+            if (dyna_sl->size() == 0 || !bf.hash_may_match(m_bloom_hash(key))) {
                 return static_sl->lazy_erase_one(key);
             }
         }
@@ -1138,6 +1416,8 @@ public:
 
     void erase(iterator iter)
     {
+        merge_note_write(iter.key());
+
         if (iter.in_dyna) {
             dyna_sl->erase(iter.d_iter);
         }
@@ -1148,6 +1428,8 @@ public:
 
     void erase(reverse_iterator iter)
     {
+        merge_note_write(iter.key());
+
         if (iter.in_dyna) {
             dyna_sl->erase(iter.d_iter);
         }
@@ -1159,13 +1441,196 @@ public:
 public:
     void merge_dtos()
     {
+        if (merge_sl != NULL) {
+            merge_step(0);
+            return;
+        }
+
         static_sl->merge(*dyna_sl);
+        m_merge_count++;
+        m_last_merge_ms = 0;
 
         if (USE_BLOOM_FILTER) {
-            bf.reallocate(static_sl->size() / SL_MERGE_RATIO);
+            rebuild_bloomfilter();
         }
     }
 
+public:
+    // *** Incremental Merge
+    // The next static stage is built aside by copying dyna_sl and static_sl
+    // in key order, a bounded number of leaf nodes per step. A step only
+    // stops between keys, so the cursor always sits on a key whose entries
+    // are all copied. Both stages stay authoritative for lookups and
+    // iterators until a step swaps the new stages in, so only the write
+    // paths need to know about the cursor: keys written after the cursor
+    // passed them are recorded, and their live entries are copied again
+    // into the new stages before the swap. The replaced stages are freed in
+    // the steps after the swap.
+
+    void merge_begin()
+    {
+        if (merge_sl != NULL) {
+            return;
+        }
+        merge_sl = new sl_ro_type(m_key_less, m_allocator);
+        merge_sl->bulk_begin();
+        merge_has_cursor = false;
+    }
+
+    // do up to leaves leaf nodes worth of merge work (0 means all of it),
+    // returns true while the merge still has work left
+    bool merge_step(size_type leaves)
+    {
+        size_type budget = leaves * sl_type::l_order;
+        size_type done = 0;
+
+        if (merge_sl != NULL && late_sl == NULL) {
+            // re-seek every step, writes since the last step may have split
+            // or concatenated nodes under the previous position. An empty
+            // static stage is not searched, its only slot is the virtual key.
+            typename sl_type::iterator d_iter = merge_has_cursor ? dyna_sl->upper_bound(merge_cursor) : dyna_sl->begin();
+            bool s_live = static_sl->size() != 0;
+            typename sl_ro_type::iterator s_iter;
+            if (s_live) {
+                s_iter = merge_has_cursor ? static_sl->upper_bound(merge_cursor) : static_sl->begin();
+            }
+
+            while (leaves == 0 || done < budget) {
+                while (s_live && !s_iter.is_end() && s_iter.is_lazy_deleted()) {
+                    ++s_iter;
+                }
+                bool d_end = d_iter.is_end();
+                bool s_end = !s_live || s_iter.is_end();
+                if (d_end && s_end) {
+                    merge_sl->bulk_end();
+                    late_sl = new sl_type(m_key_less, m_allocator);
+                    break;
+                }
+
+                key_type key = (s_end || (!d_end && key_lessequal(d_iter.key(), s_iter.key()))) ?
+                               d_iter.key() : s_iter.key();
+                for (; !d_iter.is_end() && key_equal(d_iter.key(), key); ++d_iter, done++) {
+                    merge_sl->bulk_append(key, d_iter.data());
+                }
+                for (; !s_end && !s_iter.is_end() && key_equal(s_iter.key(), key); ++s_iter) {
+                    if (!s_iter.is_lazy_deleted()) {
+                        merge_sl->bulk_append(key, s_iter.data());
+                        done++;
+                    }
+                }
+                merge_cursor = key;
+                merge_has_cursor = true;
+            }
+        }
+
+        if (late_sl != NULL) {
+            while (leaves == 0 || done < budget) {
+                if (merge_late.empty()) {
+                    merge_swap();
+                    break;
+                }
+                done += merge_replay(merge_late.back());
+                merge_late.pop_back();
+            }
+        }
+
+        if (merge_sl == NULL) {
+            while (!merge_retired_static.empty() && (leaves == 0 || done < budget)) {
+                if (!merge_retired_static.back()->release_step(leaves == 0 ? size_type(-1) : leaves)) {
+                    break;
+                }
+                delete merge_retired_static.back();
+                merge_retired_static.pop_back();
+            }
+            while (!merge_retired.empty() && (leaves == 0 || done < budget)) {
+                if (!merge_retired.back()->release_step(leaves == 0 ? size_type(-1) : leaves)) {
+                    break;
+                }
+                delete merge_retired.back();
+                merge_retired.pop_back();
+            }
+        }
+
+        return merge_sl != NULL || !merge_retired.empty() || !merge_retired_static.empty();
+    }
+
+private:
+    // make the next stages hold the live entries of a key written after the
+    // cursor passed it, returns the number of entries copied
+    size_type merge_replay(const key_type& key)
+    {
+        if (merge_sl->size() != 0) {
+            for (typename sl_ro_type::iterator it = merge_sl->lower_bound(key);
+                 !it.is_end() && key_equal(it.key(), key); ++it) {
+                merge_sl->lazy_erase(it);
+            }
+        }
+        late_sl->erase(key);
+
+        size_type copied = 0;
+        for (typename sl_type::iterator it = dyna_sl->lower_bound(key);
+             !it.is_end() && key_equal(it.key(), key); ++it, copied++) {
+            late_sl->insert_common(key, it.data());
+        }
+        if (static_sl->size() != 0) {
+            for (typename sl_ro_type::iterator it = static_sl->lower_bound(key);
+                 !it.is_end() && key_equal(it.key(), key); ++it) {
+                if (!it.is_lazy_deleted()) {
+                    late_sl->insert_common(key, it.data());
+                    copied++;
+                }
+            }
+        }
+        return copied + 1;
+    }
+
+    void merge_swap()
+    {
+        merge_retired.push_back(dyna_sl);
+        merge_retired_static.push_back(static_sl);
+        dyna_sl = late_sl;
+        static_sl = merge_sl;
+        late_sl = NULL;
+        merge_sl = NULL;
+        merge_has_cursor = false;
+        m_merge_count++;
+        m_last_merge_ms = 0;
+
+        if (USE_BLOOM_FILTER) {
+            rebuild_bloomfilter();
+        }
+    }
+
+    void merge_abort()
+    {
+        delete merge_sl;
+        delete late_sl;
+        merge_sl = NULL;
+        late_sl = NULL;
+        merge_has_cursor = false;
+        merge_late.clear();
+        for (size_t i = 0; i < merge_retired.size(); i++) {
+            delete merge_retired[i];
+        }
+        merge_retired.clear();
+        for (size_t i = 0; i < merge_retired_static.size(); i++) {
+            delete merge_retired_static[i];
+        }
+        merge_retired_static.clear();
+    }
+
+    // size the bloom filter for the dynamic stage it covers until the next
+    // merge, and fill it with the entries already there
+    void rebuild_bloomfilter()
+    {
+        bf.reallocate(std::max(m_policy.expected_dyna_size(static_sl->size()), 2 * dyna_sl->size()));
+        for (typename sl_type::iterator it = dyna_sl->begin(); !it.is_end(); ++it) {
+            bf.insert_hash(m_bloom_hash(it.key()));
+        }
+    }
+
+public:
+
 #ifdef SL_DEBUG
 
 public:
@@ -9,6 +9,7 @@
 #include <cstddef>
 #include <cassert>
 #include <cstring>
+#include <vector>
 #include "skiplist_traits.h"
 #include "skiplist_multimap.h"
 
@@ -964,6 +965,13 @@ private:
 
     data_alloc_type m_data_allocator;
 
+    // leftmost and rightmost inner node of every level during a bulk build
+    std::vector<std::pair<inner_node *, inner_node *> > m_bulk_levels;
+
+    // entries of the key last appended during a bulk build
+    key_type m_bulk_key;
+    std::vector<data_type> m_bulk_data;
+
 public:
     explicit inline skiplist_multimap_ro(const allocator_type& alloc = allocator_type())
         : m_allocator(alloc)
@@ -1249,7 +1257,11 @@ public:
 
     inline iterator end()
     {
-        if (m_tail_leaf->count == 1 && m_tail_leaf->left != NULL) {
+        // an empty skip list only has the virtual max key, end is begin
+        if (m_tail_leaf->count < 2 && m_tail_leaf->left == NULL) {
+            return iterator(m_tail_leaf, 0, 0);
+        }
+        if (m_tail_leaf->count < 2) {
             return iterator(m_tail_leaf->left,
                             m_tail_leaf->left->count - 1,
                             m_tail_leaf->left->data_count[m_tail_leaf->left->count - 1]);
@@ -1266,7 +1278,10 @@ public:
 
     inline const_iterator end() const
     {
-        if (m_tail_leaf->count == 1 && m_tail_leaf->left != NULL) {
+        if (m_tail_leaf->count < 2 && m_tail_leaf->left == NULL) {
+            return const_iterator(m_tail_leaf, 0, 0);
+        }
+        if (m_tail_leaf->count < 2) {
             return const_iterator(m_tail_leaf->left,
                                   m_tail_leaf->left->count - 1,
                                   m_tail_leaf->left->data_count[m_tail_leaf->left->count - 1]);
@@ -1334,6 +1349,9 @@ public:
 
     bool exists(const key_type& key) const
     {
+        if (m_size == 0) {
+            return false;
+        }
         if (m_head_leaf->count > 1 && key_less(key, m_head_leaf->key[0])) {
             return false;
         }
@@ -1382,6 +1400,9 @@ public:
 
     iterator find(const key_type& key)
     {
+        if (m_size == 0) {
+            return end();
+        }
         if (m_head_leaf->count > 1 && key_less(key, m_head_leaf->key[0])) {
             return end();
         }
@@ -1430,6 +1451,9 @@ public:
 
     const_iterator find(const key_type& key) const
     {
+        if (m_size == 0) {
+            return end();
+        }
         if (m_head_leaf->count > 1 && key_less(key, m_head_leaf->key[0])) {
             return end();
         }
@@ -1478,6 +1502,9 @@ public:
 
     size_type count(const key_type& key) const
     {
+        if (m_size == 0) {
+            return 0;
+        }
         if (m_head_leaf->count > 1 && key_less(key, m_head_leaf->key[0])) {
             return 0;
         }
@@ -1527,6 +1554,9 @@ public:
 
     iterator lower_bound(const key_type& key)
     {
+        if (m_size == 0) {
+            return end();
+        }
         if (m_tail_leaf->count > 1) {
             if (key_greater(key, m_tail_leaf->key[m_tail_leaf->count - 2])) {
                 return end();
@@ -1565,6 +1595,9 @@ public:
 
     const_iterator lower_bound(const key_type& key) const
     {
+        if (m_size == 0) {
+            return end();
+        }
         if (m_tail_leaf->count > 1) {
             if (key_greater(key, m_tail_leaf->key[m_tail_leaf->count - 2])) {
                 return end();
@@ -1603,6 +1636,9 @@ public:
 
     iterator upper_bound(const key_type& key)
     {
+        if (m_size == 0) {
+            return end();
+        }
         if (m_tail_leaf->count > 1) {
             if (key_greaterequal(key, m_tail_leaf->key[m_tail_leaf->count - 2])) {
                 return end();
@@ -1641,6 +1677,9 @@ public:
 
     const_iterator upper_bound(const key_type& key) const
     {
+        if (m_size == 0) {
+            return end();
+        }
         if (m_tail_leaf->count > 1) {
             if (key_greaterequal(key, m_tail_leaf->key[m_tail_leaf->count - 2])) {
                 return end();
@@ -1923,12 +1962,14 @@ public:
 
                     if (key_lessequal(dyna_ln->key[dyna_index], static_ln->key[static_index])) {
                         if (!key_equal(cur_key, dyna_ln->key[dyna_index])) {
-                            new_static_ln->key[new_index] = cur_key;
-                            new_static_ln->data_array[new_index] = allocate_data_array(data_count);
-                            memcpy(new_static_ln->data_array[new_index], data_buf, data_count * sizeof(data_type));
-                            new_static_ln->data_count[new_index] = data_count;
-
-                            new_index++;
+                            // a static key whose entries were all erased is dropped
+                            if (data_count != 0) {
+                                new_static_ln->key[new_index] = cur_key;
+                                new_static_ln->data_array[new_index] = allocate_data_array(data_count);
+                                memcpy(new_static_ln->data_array[new_index], data_buf, data_count * sizeof(data_type));
+                                new_static_ln->data_count[new_index] = data_count;
+                                new_index++;
+                            }
                             cur_key = dyna_ln->key[dyna_index];
                             data_count = 0;
                         }
@@ -1939,12 +1980,13 @@ public:
                     }
                     else {
                         if (!key_equal(cur_key, static_ln->key[static_index])) {
-                            new_static_ln->key[new_index] = cur_key;
-                            new_static_ln->data_array[new_index] = allocate_data_array(data_count);
-                            memcpy(new_static_ln->data_array[new_index], data_buf, data_count * sizeof(data_type));
-                            new_static_ln->data_count[new_index] = data_count;
-
-                            new_index++;
+                            if (data_count != 0) {
+                                new_static_ln->key[new_index] = cur_key;
+                                new_static_ln->data_array[new_index] = allocate_data_array(data_count);
+                                memcpy(new_static_ln->data_array[new_index], data_buf, data_count * sizeof(data_type));
+                                new_static_ln->data_count[new_index] = data_count;
+                                new_index++;
+                            }
                             cur_key = static_ln->key[static_index];
                             data_count = 0;
                         }
@@ -1996,12 +2038,13 @@ public:
                     }
 
                     if (!key_equal(cur_key, dyna_ln->key[dyna_index])) {
-                        new_static_ln->key[new_index] = cur_key;
-                        new_static_ln->data_array[new_index] = allocate_data_array(data_count);
-                        memcpy(new_static_ln->data_array[new_index], data_buf, data_count * sizeof(data_type));
-                        new_static_ln->data_count[new_index] = data_count;
-
-                        new_index++;
+                        if (data_count != 0) {
+                            new_static_ln->key[new_index] = cur_key;
+                            new_static_ln->data_array[new_index] = allocate_data_array(data_count);
+                            memcpy(new_static_ln->data_array[new_index], data_buf, data_count * sizeof(data_type));
+                            new_static_ln->data_count[new_index] = data_count;
+                            new_index++;
+                        }
                         cur_key = dyna_ln->key[dyna_index];
                         data_count = 0;
                     }
@@ -2037,12 +2080,13 @@ public:
                     }
 
                     if (!key_equal(cur_key, static_ln->key[static_index])) {
-                        new_static_ln->key[new_index] = cur_key;
-                        new_static_ln->data_array[new_index] = allocate_data_array(data_count);
-                        memcpy(new_static_ln->data_array[new_index], data_buf, data_count * sizeof(data_type));
-                        new_static_ln->data_count[new_index] = data_count;
-
-                        new_index++;
+                        if (data_count != 0) {
+                            new_static_ln->key[new_index] = cur_key;
+                            new_static_ln->data_array[new_index] = allocate_data_array(data_count);
+                            memcpy(new_static_ln->data_array[new_index], data_buf, data_count * sizeof(data_type));
+                            new_static_ln->data_count[new_index] = data_count;
+                            new_index++;
+                        }
                         cur_key = static_ln->key[static_index];
                         data_count = 0;
                     }
@@ -2079,11 +2123,13 @@ public:
             }
 
             // allocate data array for the last key
-            new_static_ln->key[new_index] = cur_key;
-            new_static_ln->data_array[new_index] = allocate_data_array(data_count);
-            memcpy(new_static_ln->data_array[new_index], data_buf, data_count * sizeof(data_type));
-            new_static_ln->data_count[new_index] = data_count;
-            new_index++;
+            if (data_count != 0) {
+                new_static_ln->key[new_index] = cur_key;
+                new_static_ln->data_array[new_index] = allocate_data_array(data_count);
+                memcpy(new_static_ln->data_array[new_index], data_buf, data_count * sizeof(data_type));
+                new_static_ln->data_count[new_index] = data_count;
+                new_index++;
+            }
 
             // add the virtual max key, possibly allocate one more leaf node
             if (new_index == l_order) {
@@ -2166,6 +2212,141 @@ public:
         }
     }
 
+private:
+    // *** Bulk Build Functions
+    // build the skip list entry by entry in key order, the entries of a key
+    // are gathered until the next key starts and then stored in one data
+    // array. Inner nodes are filled in as leaf nodes close so that bulk_end()
+    // only has to close the rightmost node of every level. The skip list
+    // must not be read between bulk_begin() and bulk_end().
+
+    void bulk_begin()
+    {
+        clear();
+        m_tail_leaf->count = 0;
+        m_bulk_levels.clear();
+        m_bulk_data.clear();
+    }
+
+    // key must not be less than any key appended before
+    inline void bulk_append(const key_type& key, const data_type& data)
+    {
+        if (!m_bulk_data.empty() && !key_equal(m_bulk_key, key)) {
+            bulk_flush();
+        }
+        if (m_bulk_data.empty()) {
+            m_bulk_key = key;
+        }
+        m_bulk_data.push_back(data);
+    }
+
+    void bulk_end()
+    {
+        bulk_flush();
+
+        // placeholder for virtual max key, not counted in m_size
+        leaf_node *ln = bulk_slot();
+        ln->key[ln->count] = key_type();
+        ln->data_count[ln->count] = 0;
+        ln->data_array[ln->count] = NULL;
+        ln->count++;
+
+        if (m_head_leaf == m_tail_leaf) {
+            m_head = m_head_leaf;
+            m_level = 0;
+            return;
+        }
+
+        bulk_push(0, m_tail_leaf->key[m_tail_leaf->count - 1], m_tail_leaf);
+        size_t level = 0;
+        while (m_bulk_levels[level].first != m_bulk_levels[level].second) {
+            inner_node *in = m_bulk_levels[level].second;
+            bulk_push(level + 1, in->key[in->count - 1], in);
+            level++;
+        }
+        m_head = m_bulk_levels[level].first;
+        m_level = level + 1;
+        m_bulk_levels.clear();
+    }
+
+    // the tail leaf node, after closing it if it is full
+    inline leaf_node *bulk_slot()
+    {
+        leaf_node *ln = m_tail_leaf;
+        if (ln->count == l_order) {
+            leaf_node *new_ln = allocate_leaf();
+            ln->right = new_ln;
+            new_ln->left = ln;
+            m_tail_leaf = new_ln;
+            bulk_push(0, ln->key[l_order - 1], ln);
+            ln = new_ln;
+        }
+        return ln;
+    }
+
+    // store the gathered entries of the last key
+    void bulk_flush()
+    {
+        if (m_bulk_data.empty()) {
+            return;
+        }
+        assert(m_bulk_data.size() <= 0xffff);
+        unsigned short count = static_cast<unsigned short>(m_bulk_data.size());
+        leaf_node *ln = bulk_slot();
+        ln->key[ln->count] = m_bulk_key;
+        ln->data_array[ln->count] = allocate_data_array(count);
+        std::copy(m_bulk_data.begin(), m_bulk_data.end(), ln->data_array[ln->count]);
+        ln->data_count[ln->count] = count;
+        ln->count++;
+        m_size += count;
+        m_bulk_data.clear();
+    }
+
+    // link a closed node of the level below into the inner level
+    void bulk_push(size_t level, const key_type& key, node *n)
+    {
+        if (level == m_bulk_levels.size()) {
+            inner_node *in = allocate_inner();
+            m_bulk_levels.push_back(std::make_pair(in, in));
+        }
+        inner_node *in = m_bulk_levels[level].second;
+        if (in->count == i_order) {
+            inner_node *new_in = allocate_inner();
+            in->right = new_in;
+            m_bulk_levels[level].second = new_in;
+            bulk_push(level + 1, in->key[i_order - 1], in);
+            in = new_in;
+        }
+        in->key[in->count] = key;
+        in->down[in->count] = n;
+        in->count++;
+    }
+
+    // free up to leaves leaf nodes of a skip list that is being torn down,
+    // returns true once all nodes are freed
+    bool release_step(size_t leaves)
+    {
+        if (m_head == NULL) {
+            return true;
+        }
+        clear_inner();
+
+        leaf_node *ln = m_head_leaf;
+        for (size_t i = 0; ln != NULL && i < leaves; i++) {
+            leaf_node *tmp = ln->right;
+            free_node(ln);
+            ln = tmp;
+        }
+        m_head = m_head_leaf = ln;
+        if (ln == NULL) {
+            m_tail_leaf = NULL;
+            m_size = 0;
+            return true;
+        }
+        ln->left = NULL;
+        return false;
+    }
+
 #ifdef SL_DEBUG
 
 public:
@@ -2238,4 +2419,6 @@ public:
 
 }
 
+#undef SL_FRIENDS
+
 #endif
@@ -0,0 +1,114 @@
+#undef SL_DEBUG
+#include "skiplist_map_compact.h"
+#include "skiplist_multimap_compact.h"
+
+#include <iostream>
+
+typedef cmu::skiplist_map_compact<uint64_t, uint64_t> SkiplistType;
+typedef cmu::skiplist_multimap_compact<uint64_t, uint64_t> MultiSkiplistType;
+
+static const uint64_t NUM_STATIC = 10000;
+static const uint64_t NUM_DYNA = 500;
+
+// even keys end up in the static stage, odd keys stay in the dynamic one;
+// data 0 marks lazily deleted static entries, so data is i + 1
+template <typename MapType>
+static void fill(MapType& slmap) {
+    cmu::merge_policy policy;
+    policy.threshold = NUM_STATIC;
+    slmap.set_merge_policy(policy);
+    for (uint64_t i = 0; i < NUM_STATIC; i++) {
+        slmap.insert(i * 2, i + 1);
+    }
+    slmap.merge_dtos();
+    for (uint64_t i = 0; i < NUM_DYNA; i++) {
+        slmap.insert(i * 2 + 1, i + 1);
+    }
+    assert(slmap.static_size() == NUM_STATIC);
+    assert(slmap.dyna_size() == NUM_DYNA);
+}
+
+template <typename MapType>
+static void check_counters(const MapType& slmap, uint64_t lookups, uint64_t dyna_hits) {
+    std::cout << "  skips " << slmap.bloomfilter_skips()
+              << ", hits " << slmap.bloomfilter_hits()
+              << ", false positives " << slmap.bloomfilter_false_positives() << std::endl;
+    assert(slmap.bloomfilter_hits() == dyna_hits);
+    assert(slmap.bloomfilter_skips() + slmap.bloomfilter_hits() + slmap.bloomfilter_false_positives() == lookups);
+    // the filter is sized for at least the default 8 bits per key
+    assert(slmap.bloomfilter_false_positives() * 10 < lookups);
+}
+
+static void test_map() {
+    std::cout << "skiplist_map_compact" << std::endl;
+    SkiplistType slmap;
+    fill(slmap);
+
+    uint64_t lookups = 0;
+    for (uint64_t i = 0; i < NUM_STATIC; i++) {
+        assert(slmap.exists(i * 2));
+        SkiplistType::iterator it = slmap.find(i * 2);
+        assert(it != slmap.end() && it.data() == i + 1);
+        lookups += 2;
+    }
+    for (uint64_t i = 0; i < NUM_DYNA; i++) {
+        assert(slmap.exists(i * 2 + 1));
+        lookups++;
+    }
+    // absent keys, beyond the dynamic stage and in between
+    for (uint64_t i = NUM_DYNA; i < NUM_STATIC; i++) {
+        assert(!slmap.exists(i * 2 + 1));
+        assert(slmap.find(i * 2 + 1) == slmap.end());
+        lookups += 2;
+    }
+    check_counters(slmap, lookups, NUM_DYNA);
+
+    // erased from the static stage, re-inserted into the dynamic one
+    slmap.erase(0);
+    assert(!slmap.exists(0));
+    slmap.insert(0, 42);
+    assert(slmap.exists(0));
+    assert(slmap.find(0).data() == 42);
+}
+
+static void test_multimap() {
+    std::cout << "skiplist_multimap_compact" << std::endl;
+    MultiSkiplistType slmap;
+    fill(slmap);
+
+    uint64_t lookups = 0;
+    for (uint64_t i = 0; i < NUM_STATIC; i++) {
+        assert(slmap.exists(i * 2));
+        std::pair<MultiSkiplistType::iterator, MultiSkiplistType::iterator> range = slmap.equal_range(i * 2);
+        assert(range.first != range.second && range.first.data() == i + 1);
+        ++range.first;
+        assert(range.first == range.second);
+        lookups += 2;
+    }
+    for (uint64_t i = 0; i < NUM_DYNA; i++) {
+        std::pair<MultiSkiplistType::iterator, MultiSkiplistType::iterator> range = slmap.equal_range(i * 2 + 1);
+        assert(range.first != range.second && range.first.data() == i + 1);
+        lookups++;
+    }
+    for (uint64_t i = NUM_DYNA; i < NUM_STATIC; i++) {
+        assert(!slmap.exists(i * 2 + 1));
+        std::pair<MultiSkiplistType::iterator, MultiSkiplistType::iterator> range = slmap.equal_range(i * 2 + 1);
+        assert(range.first == range.second);
+        lookups += 2;
+    }
+    check_counters(slmap, lookups, NUM_DYNA);
+
+    // a duplicate in the dynamic stage joins the static entry in the range
+    slmap.insert(4, 100);
+    std::pair<MultiSkiplistType::iterator, MultiSkiplistType::iterator> range = slmap.equal_range(4);
+    size_t count = 0;
+    for (; range.first != range.second; ++range.first) {
+        count++;
+    }
+    assert(count == 2);
+}
+
+int main() {
+    test_map();
+    test_multimap();
+}
@@ -0,0 +1,131 @@
+// SL_PRINT on every lookup would dominate the measured latencies
+#undef SL_DEBUG
+#include "skiplist_map_compact.h"
+
+#include <iostream>
+#include <iomanip>
+#include <map>
+#include <time.h>
+
+typedef cmu::skiplist_map_compact<uint64_t, uint64_t> SkiplistType;
+typedef std::map<uint64_t, uint64_t> MapType;
+
+static const int NUM_KEYS = 1000000;
+static const int NUM_BUCKETS = 24;
+
+static inline uint64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// scatter the keys so that both stages see inserts all over the key space
+static inline uint64_t key_at(int i) {
+    return ((uint64_t)i * 2654435761ULL) % 4294967311ULL;
+}
+
+static void check(SkiplistType& slmap, MapType& ref) {
+    assert(slmap.size() == ref.size());
+    SkiplistType::iterator slmap_iter = slmap.begin();
+    for (MapType::iterator ref_iter = ref.begin(); ref_iter != ref.end(); ++ref_iter) {
+        assert(slmap_iter != slmap.end());
+        assert(slmap_iter.key() == ref_iter->first);
+        assert(slmap_iter.data() == ref_iter->second);
+        ++slmap_iter;
+    }
+    assert(slmap_iter == slmap.end());
+}
+
+// insert NUM_KEYS keys, erasing and overwriting some of them on the way,
+// and record a log2 histogram of the per-insert latency in nanoseconds.
+// Returns the latency of the slowest insert.
+static uint64_t run(const char *name, size_t merge_step) {
+    SkiplistType slmap;
+    MapType ref;
+    uint64_t histogram[NUM_BUCKETS] = { 0 };
+    uint64_t max_ns = 0, total_ns = 0;
+    size_t merges = 0;
+
+    slmap.set_merge_step_size(merge_step);
+
+    for (int i = 0; i < NUM_KEYS; i++) {
+        uint64_t key = key_at(i);
+
+        bool was_merging = slmap.is_merging();
+        size_t static_size = slmap.static_size();
+        uint64_t start = now_ns();
+        std::pair<SkiplistType::iterator, bool> retval = slmap.insert(key, i + 1);
+        uint64_t elapsed = now_ns() - start;
+        assert(retval.second == true);
+        ref[key] = i + 1;
+        if ((was_merging && !slmap.is_merging()) || (!was_merging && slmap.static_size() != static_size)) {
+            merges++;
+        }
+
+        int bucket = 0;
+        while ((1ULL << (bucket + 1)) <= elapsed && bucket < NUM_BUCKETS - 1) {
+            bucket++;
+        }
+        histogram[bucket]++;
+        total_ns += elapsed;
+        max_ns = std::max(max_ns, elapsed);
+
+        // writes behind and ahead of a running merge cursor
+        if (i % 7 == 0) {
+            uint64_t victim = key_at(i / 2);
+            assert(slmap.erase(victim) == ref.erase(victim));
+        }
+        if (i % 11 == 0) {
+            uint64_t victim = key_at(i / 3);
+            if (ref.find(victim) != ref.end()) {
+                slmap.erase(victim);
+                slmap.insert(victim, i + 2);
+                ref[victim] = i + 2;
+            }
+        }
+        if (i % 17 == 0) {
+            // a key already there, possibly copied by the cursor already
+            uint64_t again = key_at(i / 4);
+            bool inserted = slmap.insert(again, i + 3).second;
+            assert(inserted == (ref.find(again) == ref.end()));
+            if (inserted) {
+                ref[again] = i + 3;
+            }
+        }
+        assert(slmap.size() == ref.size());
+        if (i % 13 == 0) {
+            uint64_t probe = key_at(i / 5);
+            assert(slmap.exists(probe) == (ref.find(probe) != ref.end()));
+        }
+        if (i % 100000 == 0) {
+            check(slmap, ref);
+        }
+    }
+
+    slmap.merge_dtos();
+    assert(!slmap.is_merging());
+    check(slmap, ref);
+
+    std::cout << name << " (merge step " << merge_step << " leaves): "
+              << merges << " merges, avg " << (total_ns / NUM_KEYS) << " ns, max "
+              << (max_ns / 1000) << " us" << std::endl;
+    for (int b = 0; b < NUM_BUCKETS; b++) {
+        if (histogram[b] != 0) {
+            std::cout << "  < " << std::setw(10) << (1ULL << (b + 1)) << " ns: "
+                      << std::setw(8) << histogram[b] << std::endl;
+        }
+    }
+    return max_ns;
+}
+
+int main() {
+    uint64_t blocking_max_ns = run("blocking merge", 0);
+    uint64_t small_step_max_ns = run("incremental merge", 4);
+    uint64_t large_step_max_ns = run("incremental merge", 64);
+
+    // no insert may pay for a whole merge. The bound is relative to the
+    // blocking merge, since any insert can be held up by the scheduler.
+    assert(small_step_max_ns * 4 < blocking_max_ns);
+    assert(large_step_max_ns * 4 < blocking_max_ns);
+    return 0;
+}
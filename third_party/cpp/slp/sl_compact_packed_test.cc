@@ -0,0 +1,213 @@
+#undef SL_DEBUG
+#include "skiplist_map_compact.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <map>
+
+// counts the bytes held through it, like the index allocator of the EE
+static int64_t allocated_bytes = 0;
+
+template <typename T>
+class counting_allocator : public std::allocator<T> {
+public:
+    typedef typename std::allocator<T>::pointer pointer;
+    typedef typename std::allocator<T>::size_type size_type;
+
+    template <typename U> struct rebind {
+        typedef counting_allocator<U> other;
+    };
+
+    counting_allocator() throw() { }
+    counting_allocator(const counting_allocator& other) throw() : std::allocator<T>(other) { }
+    template <typename U> counting_allocator(const counting_allocator<U>& other) throw() : std::allocator<T>(other) { }
+
+    pointer allocate(size_type n, const void *hint = 0) {
+        allocated_bytes += n * sizeof(T);
+        return std::allocator<T>::allocate(n);
+    }
+
+    void deallocate(pointer p, size_type n) {
+        allocated_bytes -= n * sizeof(T);
+        std::allocator<T>::deallocate(p, n);
+    }
+};
+
+// a padded string key like GenericKey, compared as a C string
+struct string_key {
+    char data[64];
+};
+
+struct string_key_less {
+    bool operator()(const string_key& a, const string_key& b) const {
+        return strcmp(a.data, b.data) < 0;
+    }
+};
+
+static string_key make_string_key(uint64_t i) {
+    string_key key;
+    memset(&key, 0, sizeof(key));
+    snprintf(key.data, sizeof(key.data), "customer-%012llu", static_cast<unsigned long long>(i));
+    return key;
+}
+
+typedef cmu::skiplist_map_packed<uint64_t, uint64_t> PackedType;
+typedef cmu::skiplist_map_compact<uint64_t, uint64_t> SkiplistType;
+
+// every iterator of the packed stage against a std::map with the same entries
+static void test_packed_iterators() {
+    std::map<uint64_t, uint64_t> expected;
+    PackedType packed;
+    packed.bulk_begin();
+    uint64_t key = 0;
+    for (uint64_t i = 0; i < 5000; i++) {
+        // mostly dense, with some wide gaps so that keys share fewer bytes
+        key += (i % 100 == 0) ? (1ULL << (i % 48)) : 1 + i % 3;
+        packed.bulk_append(key, i + 1);
+        expected[key] = i + 1;
+    }
+    packed.bulk_end();
+    assert(packed.size() == expected.size());
+
+    std::map<uint64_t, uint64_t>::iterator e = expected.begin();
+    for (PackedType::iterator it = packed.begin(); !it.is_end(); ++it, ++e) {
+        assert(it.key() == e->first && it.data() == e->second);
+    }
+    assert(e == expected.end());
+
+    std::map<uint64_t, uint64_t>::reverse_iterator r = expected.rbegin();
+    for (PackedType::const_reverse_iterator it = packed.rbegin(); !it.is_end(); ++it, ++r) {
+        assert(it.key() == r->first && it.data() == r->second);
+    }
+    assert(r == expected.rend());
+
+    PackedType::iterator last = packed.end();
+    --last;
+    assert(last.key() == expected.rbegin()->first);
+
+    for (e = expected.begin(); e != expected.end(); ++e) {
+        assert(packed.find(e->first).data() == e->second);
+        assert(packed.find(e->first + 1).is_end() == (expected.count(e->first + 1) == 0));
+
+        PackedType::iterator lb = packed.lower_bound(e->first - 1);
+        assert(lb.key() == expected.lower_bound(e->first - 1)->first);
+        PackedType::iterator ub = packed.upper_bound(e->first);
+        std::map<uint64_t, uint64_t>::iterator eub = expected.upper_bound(e->first);
+        assert(eub == expected.end() ? ub.is_end() : ub.key() == eub->first);
+    }
+
+    // lazy deletes keep the entry in place
+    assert(packed.lazy_erase_one(expected.begin()->first));
+    assert(!packed.lazy_erase_one(expected.begin()->first));
+    assert(packed.find(expected.begin()->first).is_lazy_deleted());
+    assert(packed.size() == expected.size() - 1);
+}
+
+// a compact map used like an index, against a std::map
+static void test_compact_random() {
+    std::map<uint64_t, uint64_t> expected;
+    SkiplistType slmap;
+    cmu::merge_policy policy;
+    policy.ratio = 4;
+    policy.threshold = 200;
+    slmap.set_merge_policy(policy);
+    srand(42);
+
+    for (int i = 0; i < 50000; i++) {
+        uint64_t key = static_cast<uint64_t>(rand() % 20000);
+        if (rand() % 4 == 0) {
+            assert(slmap.erase(key) == expected.erase(key));
+        }
+        else {
+            // as the unique index does it: updates erase and upsert
+            uint64_t data = static_cast<uint64_t>(i + 1);
+            if (expected.count(key) == 1) {
+                slmap.erase(key);
+                slmap.upsert(std::make_pair(key, data));
+            }
+            else {
+                assert(slmap.insert(key, data).second);
+            }
+            expected[key] = data;
+        }
+        if (i % 1000 == 0) {
+            slmap.merge_step(4);
+        }
+    }
+    assert(slmap.merge_count() > 0);
+    assert(slmap.size() == expected.size());
+
+    std::map<uint64_t, uint64_t>::iterator e = expected.begin();
+    for (SkiplistType::const_iterator it = slmap.begin(); it != slmap.end(); ++it, ++e) {
+        assert(it.key() == e->first && it.data() == e->second);
+    }
+    assert(e == expected.end());
+
+    std::map<uint64_t, uint64_t>::reverse_iterator r = expected.rbegin();
+    for (SkiplistType::const_reverse_iterator it = slmap.rbegin(); it != slmap.rend(); ++it, ++r) {
+        assert(it.key() == r->first && it.data() == r->second);
+    }
+    assert(r == expected.rend());
+
+    for (uint64_t key = 0; key < 20000; key++) {
+        assert(slmap.exists(key) == (expected.count(key) == 1));
+        SkiplistType::iterator lb = slmap.lower_bound(key);
+        std::map<uint64_t, uint64_t>::iterator elb = expected.lower_bound(key);
+        assert(elb == expected.end() ? lb == slmap.end() : lb.key() == elb->first);
+    }
+}
+
+// bytes per entry of the packed stage against the dynamic stage it is
+// built from and against plain key and data arrays, the least the
+// previous static stage needed with its full leaf nodes
+template <typename Key, typename Compare, typename MakeKey>
+static void compare_memory(const char *name, MakeKey make_key, size_t count, double max_ratio) {
+    typedef counting_allocator<std::pair<Key, uint64_t> > alloc_type;
+    typedef cmu::skiplist_map<Key, uint64_t, Compare, cmu::skiplist_default_map_traits<Key, uint64_t>, alloc_type> sl_type;
+    typedef cmu::skiplist_map_packed<Key, uint64_t, Compare, cmu::packed_key_codec<Key>, alloc_type> packed_type;
+
+    int64_t before = allocated_bytes;
+    sl_type *dyna = new sl_type();
+    for (size_t i = 0; i < count; i++) {
+        dyna->insert(make_key(i), i + 1);
+    }
+    int64_t dyna_bytes = allocated_bytes - before;
+    int64_t plain_bytes = static_cast<int64_t>(count * (sizeof(Key) + sizeof(uint64_t)));
+
+    before = allocated_bytes;
+    packed_type *packed = new packed_type();
+    packed->bulk_begin();
+    for (typename sl_type::iterator it = dyna->begin(); !it.is_end(); ++it) {
+        packed->bulk_append(it.key(), it.data());
+    }
+    packed->bulk_end();
+    int64_t packed_bytes = allocated_bytes - before;
+    assert(packed->size() == count);
+    assert(static_cast<int64_t>(packed->memory_size()) == packed_bytes);
+    for (size_t i = 0; i < count; i++) {
+        assert(packed->find(make_key(i)).data() == i + 1);
+    }
+
+    std::cout << std::setw(10) << name << std::fixed << std::setprecision(1)
+              << "  dynamic " << std::setw(6) << (double)dyna_bytes / count
+              << "  plain arrays " << std::setw(6) << (double)plain_bytes / count
+              << "  packed " << std::setw(6) << (double)packed_bytes / count << " bytes/entry" << std::endl;
+    assert(packed_bytes < plain_bytes * max_ratio);
+
+    delete dyna;
+    delete packed;
+}
+
+static uint64_t make_int_key(size_t i) {
+    return 1000000 + i * 7;
+}
+
+int main() {
+    test_packed_iterators();
+    test_compact_random();
+    compare_memory<uint64_t, std::less<uint64_t> >("uint64_t", make_int_key, 100000, 0.8);
+    compare_memory<string_key, string_key_less>("char[64]", make_string_key, 100000, 0.3);
+    assert(allocated_bytes == 0);
+    std::cout << "packed static stage tests passed" << std::endl;
+}
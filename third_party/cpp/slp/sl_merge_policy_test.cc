@@ -0,0 +1,118 @@
+#include "skiplist_map_compact.h"
+#include "skiplist_multimap_compact.h"
+
+typedef cmu::skiplist_map_compact<uint64_t, uint64_t> SkiplistType;
+typedef cmu::skiplist_multimap_compact<uint64_t, uint64_t> MultiSkiplistType;
+
+template <typename MapType>
+static void fill(MapType& slmap, uint64_t from, uint64_t to) {
+    for (uint64_t i = from; i < to; i++) {
+        slmap.insert(i, i + 1);
+    }
+}
+
+template <typename MapType>
+static void test_ratio_threshold() {
+    MapType slmap;
+    cmu::merge_policy policy;
+    policy.ratio = 2;
+    policy.threshold = 500;
+    slmap.set_merge_policy(policy);
+
+    // nothing is merged below the absolute threshold
+    fill(slmap, 0, 500);
+    assert(slmap.merge_count() == 0);
+    assert(slmap.dyna_size() == 500);
+
+    // the next insert merges into the empty static stage
+    fill(slmap, 500, 501);
+    assert(slmap.merge_count() == 1);
+    assert(slmap.static_size() == 500);
+
+    // 1 / ratio of the static stage is below the threshold, so it rules
+    fill(slmap, 501, 1000);
+    assert(slmap.merge_count() == 1);
+    fill(slmap, 1000, 1001);
+    assert(slmap.merge_count() == 2);
+    assert(slmap.static_size() == 1000);
+    assert(slmap.size() == 1001);
+}
+
+template <typename MapType>
+static void test_memory_budget() {
+    MapType slmap;
+    cmu::merge_policy policy;
+    policy.ratio = 0;
+    policy.memory_budget = 100 * (sizeof(uint64_t) * 2);
+    slmap.set_merge_policy(policy);
+
+    fill(slmap, 0, 100);
+    assert(slmap.merge_count() == 0);
+    fill(slmap, 100, 101);
+    assert(slmap.merge_count() == 1);
+    fill(slmap, 101, 200);
+    assert(slmap.merge_count() == 1);
+    fill(slmap, 200, 201);
+    assert(slmap.merge_count() == 2);
+    assert(slmap.size() == 201);
+}
+
+template <typename MapType>
+static void test_interval() {
+    MapType slmap;
+    cmu::merge_policy policy;
+    policy.ratio = 0;
+    policy.interval_ms = 1000;
+    slmap.set_merge_policy(policy);
+
+    // the first call only starts the clock, an empty stage is never due
+    assert(!slmap.merge_due(5000));
+    assert(!slmap.merge_due(7000));
+    fill(slmap, 0, 10);
+    assert(!slmap.merge_due(5500));
+    assert(slmap.merge_due(6000));
+
+    slmap.merge_dtos();
+    assert(slmap.merge_count() == 1);
+    // a merge restarts the clock
+    fill(slmap, 10, 20);
+    assert(!slmap.merge_due(6500));
+    assert(!slmap.merge_due(7000));
+    assert(slmap.merge_due(7500));
+
+    // without an interval the stage is never due
+    policy.interval_ms = 0;
+    slmap.set_merge_policy(policy);
+    assert(!slmap.merge_due(100000));
+}
+
+template <typename MapType>
+static void test_bloomfilter_parameters() {
+    MapType slmap;
+    cmu::merge_policy policy;
+    policy.threshold = 1000;
+    slmap.set_merge_policy(policy);
+    fill(slmap, 0, 100);
+
+    // a rebuilt filter still covers the entries of the dynamic stage
+    policy.bits_per_key = 16;
+    policy.k = 4;
+    slmap.set_merge_policy(policy);
+    // rounded up to whole 64-byte blocks
+    assert(slmap.bloomfilter_size() == (1000 * 16 / 8 + 63) / 64 * 64);
+    for (uint64_t i = 0; i < 100; i++) {
+        assert(slmap.find(i) != slmap.end());
+    }
+}
+
+int main() {
+    test_ratio_threshold<SkiplistType>();
+    test_ratio_threshold<MultiSkiplistType>();
+    test_memory_budget<SkiplistType>();
+    test_memory_budget<MultiSkiplistType>();
+    test_interval<SkiplistType>();
+    test_interval<MultiSkiplistType>();
+    test_bloomfilter_parameters<SkiplistType>();
+    test_bloomfilter_parameters<MultiSkiplistType>();
+    std::cout << "merge policy tests passed" << std::endl;
+}
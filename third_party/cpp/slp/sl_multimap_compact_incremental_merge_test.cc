@@ -0,0 +1,144 @@
+#undef SL_DEBUG
+#include "skiplist_multimap_compact.h"
+
+#include <iostream>
+#include <algorithm>
+#include <map>
+#include <vector>
+#include <iterator>
+#include <cstdlib>
+
+typedef cmu::skiplist_multimap_compact<uint64_t, uint64_t> SkiplistType;
+typedef std::multimap<uint64_t, uint64_t> MapType;
+typedef std::vector<std::pair<uint64_t, uint64_t> > EntryList;
+
+static const int NUM_OPS = 200000;
+static const uint64_t NUM_KEYS = 5000;
+
+// the entries of a key come out of the two stages in no particular order,
+// so both sides are compared as sorted lists of pairs
+static void check(SkiplistType& slmap, MapType& ref) {
+    assert(slmap.size() == ref.size());
+    EntryList got, want;
+    uint64_t last = 0;
+    for (SkiplistType::iterator it = slmap.begin(); it != slmap.end(); ++it) {
+        assert(it.key() >= last);
+        last = it.key();
+        got.push_back(std::make_pair(it.key(), it.data()));
+    }
+    for (MapType::iterator it = ref.begin(); it != ref.end(); ++it) {
+        want.push_back(*it);
+    }
+    std::sort(got.begin(), got.end());
+    assert(got == want);
+
+    for (uint64_t key = 0; key < NUM_KEYS; key += 97) {
+        assert(slmap.count(key) == ref.count(key));
+    }
+}
+
+// erase the entry of key with the given data from the reference
+static void ref_erase(MapType& ref, uint64_t key, uint64_t data) {
+    std::pair<MapType::iterator, MapType::iterator> range = ref.equal_range(key);
+    for (MapType::iterator it = range.first; it != range.second; ++it) {
+        if (it->second == data) {
+            ref.erase(it);
+            return;
+        }
+    }
+    assert(false);
+}
+
+// sorted data of the entries of key
+static std::vector<uint64_t> entries_of(SkiplistType& slmap, uint64_t key) {
+    std::vector<uint64_t> data;
+    std::pair<SkiplistType::iterator, SkiplistType::iterator> range = slmap.equal_range(key);
+    for (SkiplistType::iterator it = range.first; it != range.second; ++it) {
+        data.push_back(it.data());
+    }
+    std::sort(data.begin(), data.end());
+    return data;
+}
+
+// random inserts and erases of keys with many duplicates, all three erase
+// paths hit keys on both sides of the merge cursor while merges run
+static void run(size_t merge_step) {
+    SkiplistType slmap;
+    MapType ref;
+    size_t merges = 0;
+    bool saw_merging = false;
+
+    slmap.set_merge_step_size(merge_step);
+    srand(merge_step + 1);
+
+    for (int i = 0; i < NUM_OPS; i++) {
+        uint64_t key = rand() % NUM_KEYS;
+        int op = rand() % 8;
+
+        if (op < 5 || ref.empty()) {
+            // data 0 marks a lazily erased entry of the static stage
+            slmap.insert(key, i + 1);
+            ref.insert(std::make_pair(key, (uint64_t)(i + 1)));
+        }
+        else if (op == 5) {
+            std::vector<uint64_t> before = entries_of(slmap, key);
+            bool erased = slmap.erase_one(key);
+            assert(erased == (ref.count(key) != 0));
+            if (erased) {
+                std::vector<uint64_t> after = entries_of(slmap, key);
+                assert(after.size() + 1 == before.size());
+                std::vector<uint64_t> gone;
+                std::set_difference(before.begin(), before.end(), after.begin(), after.end(),
+                                    std::back_inserter(gone));
+                assert(gone.size() == 1);
+                ref_erase(ref, key, gone[0]);
+            }
+        }
+        else if (op == 6) {
+            SkiplistType::iterator it = slmap.find(key);
+            if (it != slmap.end()) {
+                ref_erase(ref, key, it.data());
+                slmap.erase(it);
+            }
+        }
+        else {
+            size_t erased = slmap.erase(key);
+            assert(erased == ref.erase(key));
+        }
+
+        saw_merging = saw_merging || slmap.is_merging();
+        if (slmap.merge_count() != merges) {
+            merges = slmap.merge_count();
+            check(slmap, ref);
+        }
+    }
+
+    // a merge spans many inserts unless it is done inline
+    assert(saw_merging == (merge_step != 0));
+
+    // finish the running merge with tick-sized steps
+    if (slmap.is_merging()) {
+        while (slmap.merge_step(16)) {
+        }
+        assert(!slmap.is_merging());
+    }
+    check(slmap, ref);
+
+    // a merge started from the timer copies the rest into the static stage
+    slmap.merge_begin();
+    while (slmap.merge_step(16)) {
+    }
+    assert(slmap.dyna_size() == 0);
+    check(slmap, ref);
+
+    std::cout << "step " << merge_step << ": " << slmap.merge_count()
+              << " merges, " << slmap.size() << " entries" << std::endl;
+}
+
+int main() {
+    run(0);
+    run(1);
+    run(4);
+    run(64);
+    return 0;
+}
@@ -127,4 +127,28 @@ int main() {
     }
 
     slmap.print(std::cout);
+
+    // sorted bulk insert test: run pairs go after the entries already
+    // there with the same key
+    std::vector<std::pair<uint64_t, uint64_t> > run;
+    for (uint64_t i = 0; i < 3000; i++) {
+        run.push_back(std::make_pair(i / 3, i + 1000));
+    }
+    size_t before = slmap.size();
+    size_t first_data = slmap.find(7).data();
+    assert(slmap.insert_sorted(run.begin(), run.end()) == run.size());
+    assert(slmap.size() == before + run.size());
+    assert(slmap.find(7).data() == first_data);
+    SkiplistType::iterator found = slmap.find(500);
+    for (uint64_t i = 1500; i < 1503; i++, ++found) {
+        assert(found.key() == 500 && found.data() == i + 1000);
+    }
+    assert(found.key() == 501);
+    uint64_t prev = 0;
+    size_t count = 0;
+    for (slmap_keyIter = slmap.begin(); slmap_keyIter != slmap.end(); ++slmap_keyIter, ++count) {
+        assert(count == 0 || slmap_keyIter.key() >= prev);
+        prev = slmap_keyIter.key();
+    }
+    assert(count == slmap.size());
 }
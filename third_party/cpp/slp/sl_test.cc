@@ -88,4 +88,36 @@ int main() {
     assert(slmap_nonconst_keyIter == slmap.end());
 
     slmap.print(std::cout);
+
+    // sorted bulk insert test: a large run rebuilds the skip list, the
+    // entries already there and the first of equal keys in the run win
+    std::vector<std::pair<uint64_t, uint64_t> > run;
+    for (uint64_t i = 0; i < 5000; i++) {
+        run.push_back(std::make_pair(i * 2, i + 1000));
+        if (i % 100 == 0) {
+            run.push_back(std::make_pair(i * 2, i + 9000));
+        }
+    }
+    size_t before = slmap.size();
+    size_t inserted = slmap.insert_sorted(run.begin(), run.end());
+    assert(slmap.size() == before + inserted);
+    uint64_t prev = 0;
+    size_t count = 0;
+    for (slmap_keyIter = slmap.begin(); slmap_keyIter != slmap.end(); ++slmap_keyIter, ++count) {
+        assert(count == 0 || slmap_keyIter.key() > prev);
+        prev = slmap_keyIter.key();
+    }
+    assert(count == slmap.size());
+    assert(slmap.find(4).data() == 4);
+    assert(slmap.find(200).data() == 1100);
+    assert(slmap.find(9998).data() == 5999);
+    assert(slmap.find(9999) == slmap.end());
+
+    // a small run is inserted pair by pair
+    run.clear();
+    run.push_back(std::make_pair(uint64_t(9998), uint64_t(1)));
+    run.push_back(std::make_pair(uint64_t(9999), uint64_t(1)));
+    assert(slmap.insert_sorted(run.begin(), run.end()) == 1);
+    assert(slmap.find(9998).data() == 5999);
+    assert(slmap.find(9999).data() == 1);
 }